@@ -36,6 +36,18 @@ public:
         return p;
     }
 
+    /// Add distortion to all the points, one per column (see addDistortion)
+    virtual void addDistortionPoints(const Mat2X& points, Mat2X& distorted) const
+    {
+        transformPoints(points, distorted, [this](const Vec2& p) { return addDistortion(p); });
+    }
+
+    /// Remove distortion of all the points, one per column (see removeDistortion)
+    virtual void removeDistortionPoints(const Mat2X& points, Mat2X& undistorted) const
+    {
+        transformPoints(points, undistorted, [this](const Vec2& p) { return removeDistortion(p); });
+    }
+
     virtual double getUndistortedRadius(double r) const
     {
         return r;
@@ -64,6 +76,21 @@ public:
     virtual ~Distortion() = default;
 
 protected:
+    /**
+     * @brief Apply a function to all the points, one per column.
+     * Derived classes give a function calling their own implementation, without virtual call per point.
+     * @note points and out can be the same matrix
+     */
+    template <class Function>
+    static void transformPoints(const Mat2X& points, Mat2X& out, Function function)
+    {
+        out.resize(2, points.cols());
+        for(Mat2X::Index i = 0; i < points.cols(); ++i)
+        {
+            out.col(i) = function(Vec2(points.col(i)));
+        }
+    }
+
     std::vector<double> _distortionParams{};
 };
 
@@ -65,6 +65,16 @@ public:
         return d;
     }
 
+    void addDistortionPoints(const Mat2X& points, Mat2X& distorted) const override
+    {
+      transformPoints(points, distorted, [this](const Vec2& p) { return DistortionBrown::addDistortion(p); });
+    }
+
+    void removeDistortionPoints(const Mat2X& points, Mat2X& undistorted) const override
+    {
+      transformPoints(points, undistorted, [this](const Vec2& p) { return DistortionBrown::removeDistortion(p); });
+    }
+
     ~DistortionBrown() override = default;
 };
 
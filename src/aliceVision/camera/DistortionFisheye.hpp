@@ -223,6 +223,16 @@ public:
     return ret;
   }
 
+  void addDistortionPoints(const Mat2X& points, Mat2X& distorted) const override
+  {
+    transformPoints(points, distorted, [this](const Vec2& p) { return DistortionFisheye::addDistortion(p); });
+  }
+
+  void removeDistortionPoints(const Mat2X& points, Mat2X& undistorted) const override
+  {
+    transformPoints(points, undistorted, [this](const Vec2& p) { return DistortionFisheye::removeDistortion(p); });
+  }
+
   ~DistortionFisheye() override = default;
 };
 
@@ -45,6 +45,16 @@ public:
     return  p * coef;
   }
 
+  void addDistortionPoints(const Mat2X& points, Mat2X& distorted) const override
+  {
+    transformPoints(points, distorted, [this](const Vec2& p) { return DistortionFisheye1::addDistortion(p); });
+  }
+
+  void removeDistortionPoints(const Mat2X& points, Mat2X& undistorted) const override
+  {
+    transformPoints(points, undistorted, [this](const Vec2& p) { return DistortionFisheye1::removeDistortion(p); });
+  }
+
   ~DistortionFisheye1() override  = default;
 };
 
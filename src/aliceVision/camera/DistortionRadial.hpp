@@ -199,6 +199,16 @@ public:
     return r2 * Square(1.+r2*k1);
   }
 
+  void addDistortionPoints(const Mat2X& points, Mat2X& distorted) const override
+  {
+    transformPoints(points, distorted, [this](const Vec2& p) { return DistortionRadialK1::addDistortion(p); });
+  }
+
+  void removeDistortionPoints(const Mat2X& points, Mat2X& undistorted) const override
+  {
+    transformPoints(points, undistorted, [this](const Vec2& p) { return DistortionRadialK1::removeDistortion(p); });
+  }
+
   ~DistortionRadialK1() override = default;
 };
 
@@ -385,6 +395,16 @@ public:
     return r2 * Square(1.+r2*(k1+r2*(k2+r2*k3)));
   }
 
+  void addDistortionPoints(const Mat2X& points, Mat2X& distorted) const override
+  {
+    transformPoints(points, distorted, [this](const Vec2& p) { return DistortionRadialK3::addDistortion(p); });
+  }
+
+  void removeDistortionPoints(const Mat2X& points, Mat2X& undistorted) const override
+  {
+    transformPoints(points, undistorted, [this](const Vec2& p) { return DistortionRadialK3::removeDistortion(p); });
+  }
+
   ~DistortionRadialK3() override = default;
 };
 
@@ -589,6 +609,16 @@ public:
     return r2 * Square(r_coeff);
   }
 
+  void addDistortionPoints(const Mat2X& points, Mat2X& distorted) const override
+  {
+    transformPoints(points, distorted, [this](const Vec2& p) { return DistortionRadialK3PT::addDistortion(p); });
+  }
+
+  void removeDistortionPoints(const Mat2X& points, Mat2X& undistorted) const override
+  {
+    transformPoints(points, undistorted, [this](const Vec2& p) { return DistortionRadialK3PT::removeDistortion(p); });
+  }
+
   ~DistortionRadialK3PT() override = default;
 };
 
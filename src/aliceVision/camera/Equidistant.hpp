@@ -390,6 +390,11 @@ public:
     return _circleRadius * p  + _offset;
   }
 
+  void cam2imaPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    out = (_circleRadius * p).colwise() + _offset;
+  }
+
   Eigen::Matrix2d getDerivativeCam2ImaWrtPoint() const override
   {
     return Eigen::Matrix2d::Identity() * _circleRadius;
@@ -401,6 +406,11 @@ public:
     return (p - _offset) / _circleRadius;
   }
 
+  void ima2camPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    out = (p.colwise() - _offset) / _circleRadius;
+  }
+
   Eigen::Matrix2d getDerivativeIma2CamWrtPoint() const override
   {
     return Eigen::Matrix2d::Identity() * (1.0 / _circleRadius);
@@ -141,6 +141,45 @@ public:
       return output;
   }
 
+  /**
+   * @brief Projection of several 3D points into the camera plane, see project()
+   * @param[in] pose The pose
+   * @param[in] pts3D The 3d points, one per column
+   * @param[out] pts2D The 2d projections in the camera plane, one per column
+   * @param[in] applyDistortion If true apply distrortion if any
+   */
+  virtual void projectPoints(const geometry::Pose3& pose, const Mat3X& pts3D, Mat2X& pts2D, bool applyDistortion = true) const
+  {
+    pts2D.resize(2, pts3D.cols());
+    for(Mat3X::Index i = 0; i < pts3D.cols(); ++i)
+    {
+      pts2D.col(i) = project(pose, pts3D.col(i), applyDistortion);
+    }
+  }
+
+  /**
+   * @brief Back-projection of several 2D points at a specific depth, see backproject()
+   * @param[in] pts2D The 2d points, one per column
+   * @param[out] pts3D The 3d points, one per column
+   * @param[in] applyUndistortion If true remove distortion if any
+   * @param[in] pose The camera pose
+   * @param[in] depth The depth
+   */
+  void backprojectPoints(const Mat2X& pts2D, Mat3X& pts3D, bool applyUndistortion = true, const geometry::Pose3& pose = geometry::Pose3(), double depth = 1.0) const
+  {
+    Mat2X pts2D_cam;
+    ima2camPoints(pts2D, pts2D_cam);
+    if(applyUndistortion)
+      removeDistortionPoints(pts2D_cam, pts2D_cam);
+
+    const geometry::Pose3 poseInverse = pose.inverse();
+    pts3D.resize(3, pts2D.cols());
+    for(Mat2X::Index i = 0; i < pts2D.cols(); ++i)
+    {
+      pts3D.col(i) = poseInverse(depth * toUnitSphere(pts2D_cam.col(i)));
+    }
+  }
+
   /**
    * @brief get derivative of a projection of a 3D point into the camera plane
    * @param[in] pose The pose
@@ -361,6 +400,46 @@ public:
    */
   virtual Vec2 get_d_pixel(const Vec2& p) const = 0;
 
+  // Batched versions of the above transformations, on points stored one per column.
+  // The output matrix can be the input one. Derived classes override them to avoid
+  // a virtual call per point.
+
+  /// Transform several points from the camera plane to the image plane, see cam2ima()
+  virtual void cam2imaPoints(const Mat2X& p, Mat2X& out) const
+  {
+    transformPoints(p, out, [this](const Vec2& pt) { return cam2ima(pt); });
+  }
+
+  /// Transform several points from the image plane to the camera plane, see ima2cam()
+  virtual void ima2camPoints(const Mat2X& p, Mat2X& out) const
+  {
+    transformPoints(p, out, [this](const Vec2& pt) { return ima2cam(pt); });
+  }
+
+  /// Add distortion to several points in the camera plane, see addDistortion()
+  virtual void addDistortionPoints(const Mat2X& p, Mat2X& out) const
+  {
+    transformPoints(p, out, [this](const Vec2& pt) { return addDistortion(pt); });
+  }
+
+  /// Remove distortion of several points in the camera plane, see removeDistortion()
+  virtual void removeDistortionPoints(const Mat2X& p, Mat2X& out) const
+  {
+    transformPoints(p, out, [this](const Vec2& pt) { return removeDistortion(pt); });
+  }
+
+  /// Return the un-distorted pixels of several distorted pixels, see get_ud_pixel()
+  virtual void get_ud_pixels(const Mat2X& p, Mat2X& out) const
+  {
+    transformPoints(p, out, [this](const Vec2& pt) { return get_ud_pixel(pt); });
+  }
+
+  /// Return the distorted pixels of several undistorted pixels, see get_d_pixel()
+  virtual void get_d_pixels(const Mat2X& p, Mat2X& out) const
+  {
+    transformPoints(p, out, [this](const Vec2& pt) { return get_d_pixel(pt); });
+  }
+
   /**
    * @brief Normalize a given unit pixel error to the camera plane
    * @param[in] value Given unit pixel error
@@ -452,6 +531,17 @@ public:
 
 protected:
 
+  /// apply a point-wise function to all the columns of p
+  template <class Function>
+  static void transformPoints(const Mat2X& p, Mat2X& out, Function function)
+  {
+    out.resize(2, p.cols());
+    for(Mat2X::Index i = 0; i < p.cols(); ++i)
+    {
+      out.col(i) = function(Vec2(p.col(i)));
+    }
+  }
+
   /// initialization mode
   EIntrinsicInitMode _initializationMode = EIntrinsicInitMode::NONE;
   /// intrinsic lock
@@ -68,6 +68,40 @@ public:
     return cam2ima(addDistortion(ima2cam(p)));
   }
 
+  void addDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    if (_pDistortion == nullptr)
+    {
+      out = p;
+      return;
+    }
+    _pDistortion->addDistortionPoints(p, out);
+  }
+
+  void removeDistortionPoints(const Mat2X& p, Mat2X& out) const override
+  {
+    if (_pDistortion == nullptr)
+    {
+      out = p;
+      return;
+    }
+    _pDistortion->removeDistortionPoints(p, out);
+  }
+
+  void get_ud_pixels(const Mat2X& p, Mat2X& out) const override
+  {
+    ima2camPoints(p, out);
+    removeDistortionPoints(out, out);
+    cam2imaPoints(out, out);
+  }
+
+  void get_d_pixels(const Mat2X& p, Mat2X& out) const override
+  {
+    ima2camPoints(p, out);
+    addDistortionPoints(out, out);
+    cam2imaPoints(out, out);
+  }
+
   std::vector<double> getDistortionParams() const
   {
     if (!hasDistortion()) {
@@ -99,6 +99,14 @@ public:
     return impt;
   }
 
+  void projectPoints(const geometry::Pose3& pose, const Mat3X& pts3D, Mat2X& pts2D, bool applyDistortion = true) const override
+  {
+    pts2D = pose(pts3D).colwise().hnormalized(); // apply pose
+
+    this->addDistortionPoints(pts2D, pts2D);
+    this->cam2imaPoints(pts2D, pts2D);
+  }
+
   Eigen::Matrix<double, 2, 9> getDerivativeProjectWrtRotation(const geometry::Pose3& pose, const Vec3 & pt)
   {
     const Vec3 X = pose(pt); // apply pose
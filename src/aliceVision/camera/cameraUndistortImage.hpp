@@ -14,6 +14,7 @@
 #include <aliceVision/camera/cameraCommon.hpp>
 #include <aliceVision/camera/IntrinsicBase.hpp>
 #include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/camera/cameraUndistortMap.hpp>
 
 #include <memory>
 
@@ -35,34 +36,31 @@ void UndistortImage(
   }
   else // There is distortion
   {
-    const Vec2 center(imageIn.Width() * 0.5, imageIn.Height() * 0.5);
-    Vec2 ppCorrection(0.0, 0.0);
-
-    if(correctPrincipalPoint)
-    {
-      if(camera::isPinhole(intrinsicPtr->getType()))
-      {
-        const camera::Pinhole* pinholePtr = dynamic_cast<const camera::Pinhole*>(intrinsicPtr);
-        ppCorrection = pinholePtr->getPrincipalPoint() - center;
-      }
-    }
-
-    image_ud.resize(imageIn.Width(), imageIn.Height(), true, fillcolor);
-    const image::Sampler2d<image::SamplerLinear> sampler;
-
-    #pragma omp parallel for
-    for (int j = 0; j < imageIn.Height(); ++j)
-      for (int i = 0; i < imageIn.Width(); ++i)
-      {
-        const Vec2 undisto_pix(i,j);
-
-        // compute coordinates with distortion
-        const Vec2 disto_pix = intrinsicPtr->get_d_pixel(undisto_pix) + ppCorrection;
+    const UndistortMap undistortMap(*intrinsicPtr, imageIn.Width(), imageIn.Height(), correctPrincipalPoint);
+    undistortMap.apply(imageIn, image_ud, fillcolor);
+  }
+}
 
-        // pick pixel if it is in the image domain
-        if ( imageIn.Contains(disto_pix(1), disto_pix(0)) )
-          image_ud( j, i ) = sampler(imageIn, disto_pix(1), disto_pix(0));
-      }
+/**
+ * @brief Undistort an image according a given camera and its distortion model,
+ * reusing the undistortion map of the camera from the cache
+ */
+template <typename T>
+void UndistortImage(
+  const image::Image<T>& imageIn,
+  const camera::IntrinsicBase* intrinsicPtr,
+  image::Image<T>& image_ud,
+  T fillcolor,
+  UndistortMapCache& cache,
+  bool correctPrincipalPoint = false)
+{
+  if (!intrinsicPtr->hasDistortion()) // no distortion, perform a direct copy
+  {
+    image_ud = imageIn;
+  }
+  else // There is distortion
+  {
+    cache.get(*intrinsicPtr, imageIn.Width(), imageIn.Height(), correctPrincipalPoint)->apply(imageIn, image_ud, fillcolor);
   }
 }
 
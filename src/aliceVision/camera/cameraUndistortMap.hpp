@@ -0,0 +1,266 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/Sampler.hpp>
+#include <aliceVision/camera/cameraCommon.hpp>
+#include <aliceVision/camera/IntrinsicBase.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+
+#include <cmath>
+#include <future>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace aliceVision {
+namespace camera {
+
+/**
+ * @brief Position of the distorted pixel for each pixel of an undistorted image.
+ * It only depends on the intrinsic and the image size, so it can be computed once
+ * and applied to all the images of a camera.
+ * The positions are stored in float to halve the size of the map: the undistorted
+ * images are the same as sampling the double precision positions up to the float precision.
+ */
+class UndistortMap
+{
+public:
+  /**
+   * @brief Compute the undistortion map
+   * @param[in] intrinsic The camera intrinsic
+   * @param[in] width The image width
+   * @param[in] height The image height
+   * @param[in] correctPrincipalPoint If true, move the principal point to the image center
+   */
+  UndistortMap(const IntrinsicBase& intrinsic, int width, int height, bool correctPrincipalPoint = false)
+    : _width(width)
+    , _height(height)
+    , _positions(static_cast<std::size_t>(width) * height)
+  {
+    Vec2 ppCorrection(0.0, 0.0);
+    if(correctPrincipalPoint && camera::isPinhole(intrinsic.getType()))
+    {
+      const Vec2 center(width * 0.5, height * 0.5);
+      const camera::Pinhole& pinhole = dynamic_cast<const camera::Pinhole&>(intrinsic);
+      ppCorrection = pinhole.getPrincipalPoint() - center;
+    }
+
+    #pragma omp parallel for
+    for(int j = 0; j < height; ++j)
+    {
+      Mat2X undistoPix(2, width);
+      for(int i = 0; i < width; ++i)
+        undistoPix.col(i) = Vec2(i, j);
+
+      // compute coordinates with distortion for the whole row
+      Mat2X distoPix;
+      intrinsic.get_d_pixels(undistoPix, distoPix);
+
+      Eigen::Vector2f* positions = &_positions[static_cast<std::size_t>(j) * width];
+      for(int i = 0; i < width; ++i)
+      {
+        const Vec2 pix = distoPix.col(i) + ppCorrection;
+
+        // keep the pixels in the image domain
+        if(pix(0) > -1.0 && pix(0) < width && pix(1) > -1.0 && pix(1) < height)
+          positions[i] = pix.cast<float>();
+        else
+          positions[i].fill(std::numeric_limits<float>::quiet_NaN());
+      }
+    }
+  }
+
+  int width() const { return _width; }
+  int height() const { return _height; }
+
+  /**
+   * @brief Undistort an image with bilinear interpolation, same as image::Sampler2d<image::SamplerLinear>
+   * at the float positions of the map
+   * @param[in] imageIn The distorted image, of the size of the map
+   * @param[out] imageOut The undistorted image
+   * @param[in] fillcolor The color of the pixels outside of the distorted image
+   */
+  template <typename T>
+  void apply(const image::Image<T>& imageIn, image::Image<T>& imageOut, T fillcolor) const
+  {
+    if(imageIn.Width() != _width || imageIn.Height() != _height)
+      throw std::invalid_argument("The image size does not match the undistortion map size.");
+
+    imageOut.resize(_width, _height, true, fillcolor);
+    const image::Sampler2d<image::SamplerLinear> sampler;
+
+    #pragma omp parallel for
+    for(int j = 0; j < _height; ++j)
+    {
+      const Eigen::Vector2f* positions = &_positions[static_cast<std::size_t>(j) * _width];
+      for(int i = 0; i < _width; ++i)
+      {
+        const float x = positions[i](0);
+        const float y = positions[i](1);
+        if(std::isnan(x))
+          continue;
+
+        const int gridX = static_cast<int>(std::floor(x));
+        const int gridY = static_cast<int>(std::floor(y));
+
+        if(gridX >= 0 && gridY >= 0 && gridX + 1 < _width && gridY + 1 < _height)
+          imageOut(j, i) = sampleInside(imageIn, gridX, gridY, x, y);
+        else
+          imageOut(j, i) = sampler(imageIn, y, x); // handle the image borders
+      }
+    }
+  }
+
+private:
+  /// bilinear interpolation when the 4 neighbors are inside the image, without bounds check
+  template <typename T>
+  static T sampleInside(const image::Image<T>& src, int gridX, int gridY, float x, float y)
+  {
+    using RealPixel = image::RealPixel<T>;
+
+    const double dx = static_cast<double>(x) - std::floor(x);
+    const double dy = static_cast<double>(y) - std::floor(y);
+    const double coefsX[2] = {1.0 - dx, dx};
+    const double coefsY[2] = {1.0 - dy, dy};
+
+    typename RealPixel::real_type res{};
+    double totalWeight = 0.0;
+    for(int i = 0; i < 2; ++i)
+    {
+      for(int j = 0; j < 2; ++j)
+      {
+        const double w = coefsX[j] * coefsY[i];
+        const typename RealPixel::real_type pix = RealPixel::convert_to_real(src(gridY + i, gridX + j));
+        const typename RealPixel::real_type wp = pix * w;
+        res += wp;
+        totalWeight += w;
+      }
+    }
+
+    if(totalWeight != 1.0)
+      res /= totalWeight;
+
+    return RealPixel::convert_from_real(res);
+  }
+
+  int _width;
+  int _height;
+  /// distorted pixel position per pixel, NaN if outside of the image
+  std::vector<Eigen::Vector2f> _positions;
+};
+
+/**
+ * @brief Thread-safe cache of undistortion maps, keyed by intrinsic hash and image size.
+ * When several threads request the same map, it is computed once.
+ */
+class UndistortMapCache
+{
+public:
+  using MapPtr = std::shared_ptr<const UndistortMap>;
+
+  /**
+   * @param[in] maxSize The maximum number of maps kept, the least recently used are removed
+   */
+  explicit UndistortMapCache(std::size_t maxSize = 8)
+    : _maxSize(std::max<std::size_t>(maxSize, 1))
+  {}
+
+  /**
+   * @brief Get the undistortion map of an intrinsic, compute it if needed
+   * @see UndistortMap
+   */
+  MapPtr get(const IntrinsicBase& intrinsic, int width, int height, bool correctPrincipalPoint = false)
+  {
+    const Key key(intrinsic.hashValue(), width, height, correctPrincipalPoint);
+
+    std::promise<MapPtr> promise;
+    std::shared_future<MapPtr> future;
+    bool compute = false;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _maps.find(key);
+      if(it != _maps.end())
+      {
+        // move to the front of the least recently used list
+        _lru.splice(_lru.begin(), _lru, it->second.lruIt);
+        future = it->second.future;
+      }
+      else
+      {
+        future = promise.get_future().share();
+        _lru.push_front(key);
+        _maps[key] = Entry{future, _lru.begin()};
+        compute = true;
+
+        if(_maps.size() > _maxSize)
+        {
+          _maps.erase(_lru.back());
+          _lru.pop_back();
+        }
+      }
+    }
+
+    if(compute)
+    {
+      try
+      {
+        promise.set_value(std::make_shared<const UndistortMap>(intrinsic, width, height, correctPrincipalPoint));
+      }
+      catch(...)
+      {
+        promise.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _maps.find(key);
+        if(it != _maps.end())
+        {
+          _lru.erase(it->second.lruIt);
+          _maps.erase(it);
+        }
+      }
+    }
+    return future.get();
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _maps.size();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maps.clear();
+    _lru.clear();
+  }
+
+private:
+  /// intrinsic hash, width, height, principal point correction
+  using Key = std::tuple<std::size_t, int, int, bool>;
+
+  struct Entry
+  {
+    std::shared_future<MapPtr> future;
+    std::list<Key>::iterator lruIt;
+  };
+
+  const std::size_t _maxSize;
+  mutable std::mutex _mutex;
+  std::map<Key, Entry> _maps;
+  /// keys from the most to the least recently used
+  std::list<Key> _lru;
+};
+
+} // namespace camera
+} // namespace aliceVision
@@ -0,0 +1,162 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/camera/camera.hpp>
+
+#define BOOST_TEST_MODULE undistortMap
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/tools/floating_point_comparison.hpp>
+#include <aliceVision/unitTest.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+
+namespace {
+
+std::vector<std::shared_ptr<IntrinsicBase>> createIntrinsics()
+{
+  return {
+    std::make_shared<PinholeRadialK3>(320, 240, 300.0, 162.0, 118.0, -0.2, 0.05, -0.01),
+    std::make_shared<PinholeBrownT2>(320, 240, 300.0, 158.0, 121.0, -0.1, 0.02, 0.0, 0.001, -0.002),
+    std::make_shared<PinholeFisheye>(320, 240, 250.0, 160.0, 120.0, 0.02, -0.01, 0.005, -0.001),
+    std::make_shared<EquiDistantRadialK3>(320, 240, 180.0, 160.0, 120.0, 150.0, 0.01, -0.02, 0.003)
+  };
+}
+
+} // namespace
+
+//-----------------
+// Test summary:
+//-----------------
+// - Generate random points in the image domain
+// - Assert that the batched functions give the same results as the point by point ones
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortMap_batchedProjections)
+{
+  const int nbPoints = 50;
+  const double epsilon = 1e-9;
+
+  for(const auto& intrinsic : createIntrinsics())
+  {
+    const Mat2X pixels = (Mat2X::Random(2, nbPoints) * 100.0).colwise() + Vec2(160.0, 120.0);
+
+    Mat2X distorted;
+    intrinsic->get_d_pixels(pixels, distorted);
+    Mat2X undistorted;
+    intrinsic->get_ud_pixels(pixels, undistorted);
+
+    // in place
+    Mat2X inPlace = pixels;
+    intrinsic->get_d_pixels(inPlace, inPlace);
+    EXPECT_MATRIX_NEAR(distorted, inPlace, epsilon);
+
+    const geometry::Pose3 pose(RotationAroundY(0.1) * RotationAroundX(-0.05), Vec3(0.1, -0.2, 0.3));
+    Mat3X points3D;
+    intrinsic->backprojectPoints(pixels, points3D, true, pose, 3.0);
+    Mat2X projected;
+    intrinsic->projectPoints(pose, points3D, projected);
+
+    for(int i = 0; i < nbPoints; ++i)
+    {
+      const Vec2 pixel = pixels.col(i);
+      EXPECT_MATRIX_NEAR(intrinsic->get_d_pixel(pixel), distorted.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(intrinsic->get_ud_pixel(pixel), undistorted.col(i), epsilon);
+
+      const Vec3 point3D = intrinsic->backproject(pixel, true, pose, 3.0);
+      EXPECT_MATRIX_NEAR(point3D, points3D.col(i), epsilon);
+      EXPECT_MATRIX_NEAR(intrinsic->project(pose, point3D), projected.col(i), epsilon);
+    }
+
+    // back-projected points are projected back to the original pixels
+    EXPECT_MATRIX_NEAR(pixels, projected, 1e-4);
+  }
+}
+
+//-----------------
+// Test summary:
+//-----------------
+// - Undistort a random image with an undistortion map
+// - Assert that the result is the same as sampling each distorted pixel,
+//   up to the float precision of the positions stored in the map
+//-----------------
+BOOST_AUTO_TEST_CASE(undistortMap_apply)
+{
+  for(const auto& intrinsic : createIntrinsics())
+  {
+    const int width = intrinsic->w();
+    const int height = intrinsic->h();
+
+    image::Image<image::RGBfColor> imageIn(width, height);
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < width; ++x)
+        imageIn(y, x) = image::RGBfColor(float(x) / width, float(y) / height, float((x * 7 + y * 13) % 17) / 17.f);
+
+    const image::RGBfColor fillcolor(-1.f);
+
+    // the positions are rounded to float: the bilinear weights differ by up to the position
+    // rounding error, and the neighbor pixels values differ by less than 1
+    const float tolerance = 2.f * std::max(width, height) * std::numeric_limits<float>::epsilon();
+
+    image::Image<image::RGBfColor> imageOut;
+    const UndistortMap undistortMap(*intrinsic, width, height);
+    undistortMap.apply(imageIn, imageOut, fillcolor);
+
+    BOOST_REQUIRE_EQUAL(imageOut.Width(), width);
+    BOOST_REQUIRE_EQUAL(imageOut.Height(), height);
+
+    const image::Sampler2d<image::SamplerLinear> sampler;
+    for(int y = 0; y < height; ++y)
+    {
+      for(int x = 0; x < width; ++x)
+      {
+        const Vec2 distoPix = intrinsic->get_d_pixel(Vec2(x, y));
+        const image::RGBfColor expected = imageIn.Contains(distoPix(1), distoPix(0)) ? sampler(imageIn, distoPix(1), distoPix(0)) : fillcolor;
+        for(int c = 0; c < 3; ++c)
+          BOOST_CHECK_SMALL(imageOut(y, x)(c) - expected(c), tolerance);
+      }
+    }
+
+    // wrong image size
+    image::Image<image::RGBfColor> smallImage(width / 2, height / 2);
+    BOOST_CHECK_THROW(undistortMap.apply(smallImage, imageOut, fillcolor), std::invalid_argument);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(undistortMap_cache)
+{
+  const auto intrinsics = createIntrinsics();
+  UndistortMapCache cache(2);
+
+  const auto map0 = cache.get(*intrinsics[0], 320, 240);
+  BOOST_CHECK_EQUAL(map0->width(), 320);
+  BOOST_CHECK_EQUAL(map0->height(), 240);
+
+  // same intrinsic and size: the map is reused
+  BOOST_CHECK_EQUAL(cache.get(*intrinsics[0], 320, 240), map0);
+  // different size or intrinsic: new map
+  BOOST_CHECK_NE(cache.get(*intrinsics[0], 160, 120), map0);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  cache.get(*intrinsics[1], 320, 240);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+
+  // the least recently used map has been removed
+  BOOST_CHECK_NE(cache.get(*intrinsics[0], 320, 240), map0);
+
+  // concurrent requests share the same map
+  cache.clear();
+  std::vector<std::shared_ptr<const UndistortMap>> maps(16);
+  #pragma omp parallel for
+  for(int i = 0; i < 16; ++i)
+    maps[i] = cache.get(*intrinsics[2], 320, 240);
+  for(const auto& map : maps)
+    BOOST_CHECK_EQUAL(map, maps.front());
+}
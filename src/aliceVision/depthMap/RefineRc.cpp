@@ -44,8 +44,7 @@ RefineRc::~RefineRc()
 
 void RefineRc::preloadSgmTcams_async()
 {
-  for(int tc : _sgmTCams.getData())
-    _sp->cps._ic.refreshData_async(tc);
+  _sp->cps._ic.prefetch(_sgmTCams.getData());
 }
 
 DepthSimMap* RefineRc::getDepthPixSizeMapFromSGM()
@@ -286,7 +285,24 @@ void RefineRc::writeDepthMap()
   _depthSimMapOpt->save(_rc, _refineTCams);
 }
 
-void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs)
+mvsUtils::DepthSimMapsCache::MapsSharedPtr RefineRc::getDepthSimMaps() const
+{
+  if(_depthSimMapOpt == nullptr)
+    return nullptr;
+
+  std::shared_ptr<mvsUtils::DepthSimMapsCache::DepthSimMaps> maps = std::make_shared<mvsUtils::DepthSimMapsCache::DepthSimMaps>();
+  maps->width = _sp->mp->getWidth(_rc);
+  maps->height = _sp->mp->getHeight(_rc);
+
+  std::unique_ptr<StaticVector<float>> depthMap(_depthSimMapOpt->getDepthMapStep1());
+  std::unique_ptr<StaticVector<float>> simMap(_depthSimMapOpt->getSimMapStep1());
+  maps->depthMap.swap(depthMap->getDataWritable());
+  maps->simMap.swap(simMap->getDataWritable());
+  return maps;
+}
+
+void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs,
+                                mvsUtils::DepthSimMapsCache* depthSimMapsCache)
 {
   const int numGpus = listCUDADevices(true);
   const int numCpuThreads = omp_get_num_procs();
@@ -302,7 +318,7 @@ void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector
       // the GPU sorting is determined by an environment variable named CUDA_DEVICE_ORDER
       // possible values: FASTEST_FIRST (default) or PCI_BUS_ID
       const int cudaDeviceNo = 0;
-      estimateAndRefineDepthMaps(cudaDeviceNo, mp, cams);
+      estimateAndRefineDepthMaps(cudaDeviceNo, mp, cams, depthSimMapsCache);
   }
   else
   {
@@ -325,12 +341,13 @@ void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector
           for(int rc = rcFrom; rc < rcTo; rc++)
               subcams.push_back(cams[rc]);
 
-          estimateAndRefineDepthMaps(cpuThreadId, mp, subcams);
+          estimateAndRefineDepthMaps(cpuThreadId, mp, subcams, depthSimMapsCache);
       }
   }
 }
 
-void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp, const std::vector<int>& cams)
+void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp, const std::vector<int>& cams,
+                                mvsUtils::DepthSimMapsCache* depthSimMapsCache)
 {
   const int fileScale = 1; // input images scale (should be one)
   int sgmScale = mp->userParams.get<int>("semiGlobalMatching.scale", -1);
@@ -359,20 +376,28 @@ void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp,
   // init plane sweeping parameters
   SemiGlobalMatchingParams sp(mp, cps);
 
-  for(const int rc : cams)
+  for(int i = 0; i < cams.size(); ++i)
   {
+      const int rc = cams[i];
       RefineRc sgmRefineRc(rc, sgmScale, sgmStep, &sp);
 
       sgmRefineRc.preloadSgmTcams_async();
 
+      // the next reference camera is loaded while this one is processed
+      if(i + 1 < cams.size())
+        ic.prefetch(cams[i + 1]);
+
       ALICEVISION_LOG_INFO("Estimate depth map, view id: " << mp->getViewId(rc));
       sgmRefineRc.sgmrc();
 
       ALICEVISION_LOG_INFO("Refine depth map, view id: " << mp->getViewId(rc));
-      sgmRefineRc.refinerc();
+      if(!sgmRefineRc.refinerc())
+        continue;
 
-      // write results
-      sgmRefineRc.writeDepthMap();
+      // hand the results over to the filtering in memory, or write them if they do not fit
+      const bool published = (depthSimMapsCache != nullptr) && depthSimMapsCache->publish(rc, 1, sgmRefineRc.getDepthSimMaps());
+      if(!published || sp.exportIntermediateResults)
+        sgmRefineRc.writeDepthMap();
   }
 }
 
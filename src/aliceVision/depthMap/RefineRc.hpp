@@ -8,6 +8,7 @@
 
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/depthMap/SemiGlobalMatchingRc.hpp>
+#include <aliceVision/mvsUtils/DepthSimMapsCache.hpp>
 
 namespace aliceVision {
 namespace depthMap {
@@ -24,6 +25,9 @@ public:
 
     void writeDepthMap();
 
+    /// @return the refined depth and sim maps at full resolution (scale 1), nullptr if they have not been computed
+    mvsUtils::DepthSimMapsCache::MapsSharedPtr getDepthSimMaps() const;
+
 private:
     StaticVector<int> _refineTCams;
     float _refineSigma;
@@ -42,8 +46,18 @@ private:
     DepthSimMap* optimizeDepthSimMapCUDA(DepthSimMap* depthPixSizeMapVis, DepthSimMap* depthSimMapPhoto);
 };
 
-void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs);
-void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp, const std::vector<int>& cams);
+/**
+ * @brief Estimate and refine the depth maps of the given cameras
+ * @param[in] mp the multi-view parameters
+ * @param[in] cams the reference cameras
+ * @param[in] nbGPUs the number of GPUs to use, 0 to use all of them
+ * @param[in] depthSimMapsCache if not null, the refined maps are kept in memory for the filtering in the same
+ *            process instead of being written to disk (when they fit in its budget)
+ */
+void estimateAndRefineDepthMaps(mvsUtils::MultiViewParams* mp, const std::vector<int>& cams, int nbGPUs,
+                                mvsUtils::DepthSimMapsCache* depthSimMapsCache = nullptr);
+void estimateAndRefineDepthMaps(int cudaDeviceNo, mvsUtils::MultiViewParams* mp, const std::vector<int>& cams,
+                                mvsUtils::DepthSimMapsCache* depthSimMapsCache = nullptr);
 
 void computeNormalMaps(int CUDADeviceNo, mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams);
 void computeNormalMaps(mvsUtils::MultiViewParams* mp, const StaticVector<int>& cams);
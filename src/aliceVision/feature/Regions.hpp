@@ -125,6 +125,10 @@ public:
   // - Binary: Hamming
   virtual double SquaredDescriptorDistance(std::size_t i, const Regions *, std::size_t j) const = 0;
 
+  /// Return the squared distances between the Inth descriptor and several descriptors of another Regions
+  // Same metric as SquaredDescriptorDistance, with one virtual call for all the candidates
+  virtual void SquaredDescriptorDistances(std::size_t i, const Regions *, const std::vector<IndexT>& candidates, std::vector<double>& distances) const = 0;
+
   /// Add the Inth region to another Region container
   virtual void CopyRegion(std::size_t i, Regions *) const = 0;
 
@@ -238,6 +242,23 @@ public:
     return metric(this->_vec_descs[i].getData(), regionsT->_vec_descs[j].getData(), DescriptorT::static_size);
   }
 
+  // Return the distances between one descriptor and several descriptors
+  void SquaredDescriptorDistances(std::size_t i, const Regions * genericRegions, const std::vector<IndexT>& candidates, std::vector<double>& distances) const override
+  {
+    assert(i < this->_vec_descs.size());
+    assert(genericRegions);
+
+    const This * regionsT = dynamic_cast<const This*>(genericRegions);
+    typename SquaredMetric<T, regionType>::Metric metric;
+    const T* descI = this->_vec_descs[i].getData();
+    distances.resize(candidates.size());
+    for(std::size_t k = 0; k < candidates.size(); ++k)
+    {
+      assert(candidates[k] < regionsT->_vec_descs.size());
+      distances[k] = metric(descI, regionsT->_vec_descs[candidates[k]].getData(), DescriptorT::static_size);
+    }
+  }
+
   /**
    * @brief Add the Inth region to another Region container
    * @param[in] i: index of the region to copy
@@ -0,0 +1,96 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CellsVotes.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace fuseCut {
+
+int getCellsVotesBlockShift(std::size_t nbCells, int nbThreads)
+{
+    // a few blocks per thread to balance the work, blocks of 1024 cells at least
+    const std::size_t minNbBlocks = 16 * static_cast<std::size_t>(std::max(nbThreads, 1));
+    int shift = 10;
+    while((nbCells >> (shift + 1)) >= minNbBlocks)
+        ++shift;
+    return shift;
+}
+
+std::size_t CellsVotesBuffer::getCapacity() const
+{
+    std::size_t capacity = 0;
+    for(const std::vector<Vote>& votes : _votesPerBlock)
+        capacity += votes.capacity();
+    return capacity;
+}
+
+void CellsVotesBuffer::shrink()
+{
+    std::size_t capacity = getCapacity();
+    if(capacity <= _maxKeptVotes)
+        return;
+
+    // the blocks keep their capacity after being cleared: the footprint of the buffer would be
+    // the union of the peaks of each block over all the batches of votes
+    std::vector<std::size_t> blocks(_votesPerBlock.size());
+    for(std::size_t b = 0; b < blocks.size(); ++b)
+        blocks[b] = b;
+    std::sort(blocks.begin(), blocks.end(), [&](std::size_t a, std::size_t b) {
+        return _votesPerBlock[a].capacity() > _votesPerBlock[b].capacity();
+    });
+
+    for(std::size_t i = 0; i < blocks.size() && capacity > _maxKeptVotes; ++i)
+    {
+        std::vector<Vote>& votes = _votesPerBlock[blocks[i]];
+        capacity -= votes.capacity();
+        std::vector<Vote>().swap(votes);
+    }
+}
+
+void applyCellsVotes(std::vector<CellsVotesBuffer>& buffers, std::vector<GC_cellInfo>& cellsAttr)
+{
+    if(buffers.empty())
+        return;
+
+    const int nbBlocks = static_cast<int>(buffers.front()._votesPerBlock.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int block = 0; block < nbBlocks; ++block)
+    {
+        for(CellsVotesBuffer& buffer : buffers)
+        {
+            std::vector<CellsVotesBuffer::Vote>& votes = buffer._votesPerBlock[block];
+            for(const CellsVotesBuffer::Vote& vote : votes)
+            {
+                GC_cellInfo& c = cellsAttr[vote.cellIndex];
+                switch(vote.attribute)
+                {
+                    case ECellAttribute::EMPTINESS: c.emptinessScore += vote.value; break;
+                    case ECellAttribute::FULLNESS:  c.fullnessScore += vote.value; break;
+                    case ECellAttribute::ON:        c.on += vote.value; break;
+                    case ECellAttribute::T_WEIGHT:  c.cellTWeight += vote.value; break;
+                    case ECellAttribute::S_WEIGHT:  c.cellSWeight = vote.value; break;
+                    default:
+                        c.gEdgeVisWeight[static_cast<std::uint8_t>(vote.attribute) - static_cast<std::uint8_t>(ECellAttribute::EDGE_VIS_WEIGHT)] += vote.value;
+                }
+            }
+            votes.clear();
+        }
+    }
+
+    #pragma omp parallel for
+    for(int i = 0; i < buffers.size(); ++i)
+    {
+        buffers[i]._nbVotes = 0;
+        buffers[i].shrink();
+    }
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -0,0 +1,113 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/fuseCut/delaunayGraphCutTypes.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Attribute of a cell (see GC_cellInfo) updated by a vote
+ */
+enum class ECellAttribute : std::uint8_t
+{
+    EMPTINESS = 0,
+    FULLNESS,
+    ON,
+    T_WEIGHT,
+    /// the vote value is written instead of added
+    S_WEIGHT,
+    /// gEdgeVisWeight[0], the next attributes are the 3 other facets
+    EDGE_VIS_WEIGHT
+};
+
+/**
+ * @brief Votes of the rays of one thread on the cells, stored per block of consecutive cells.
+ *
+ * The rays are traced in parallel without updating the cells: each thread appends its votes
+ * to its own buffer, then all the buffers are applied to the cells block per block
+ * (see applyCellsVotes), so that a cell is only updated by one thread, without atomic operations.
+ */
+class CellsVotesBuffer
+{
+public:
+    /**
+     * @param[in] nbCells The number of cells
+     * @param[in] cellsPerBlockShift log2 of the number of cells per block
+     * @param[in] maxKeptVotes The number of votes the buffer keeps allocated once the votes are applied,
+     *            the largest blocks are released beyond it
+     */
+    CellsVotesBuffer(std::size_t nbCells, int cellsPerBlockShift, std::size_t maxKeptVotes)
+        : _cellsPerBlockShift(cellsPerBlockShift)
+        , _maxKeptVotes(maxKeptVotes)
+        , _votesPerBlock((nbCells >> cellsPerBlockShift) + 1)
+    {}
+
+    inline void add(std::uint32_t cellIndex, ECellAttribute attribute, float value)
+    {
+        _votesPerBlock[cellIndex >> _cellsPerBlockShift].push_back({cellIndex, attribute, value});
+        ++_nbVotes;
+    }
+
+    inline void addEdgeVisWeight(std::uint32_t cellIndex, std::uint32_t localVertexIndex, float value)
+    {
+        add(cellIndex, static_cast<ECellAttribute>(static_cast<std::uint8_t>(ECellAttribute::EDGE_VIS_WEIGHT) + localVertexIndex), value);
+    }
+
+    /// @return the number of votes not applied yet
+    std::size_t getNbVotes() const { return _nbVotes; }
+
+    /// @return the number of votes allocated in the blocks
+    std::size_t getCapacity() const;
+
+    /// @return the memory used by one vote
+    static std::size_t getVoteBytes() { return sizeof(Vote); }
+
+private:
+    friend void applyCellsVotes(std::vector<CellsVotesBuffer>& buffers, std::vector<GC_cellInfo>& cellsAttr);
+
+    struct Vote
+    {
+        std::uint32_t cellIndex;
+        ECellAttribute attribute;
+        float value;
+    };
+
+    /// release the largest empty blocks until the allocated votes fit in _maxKeptVotes
+    void shrink();
+
+    int _cellsPerBlockShift;
+    std::size_t _maxKeptVotes;
+    std::vector<std::vector<Vote>> _votesPerBlock;
+    std::size_t _nbVotes = 0;
+};
+
+/**
+ * @brief Get log2 of the number of cells per block of the votes buffers,
+ *        so that there are enough blocks to apply the votes with all the threads.
+ * @param[in] nbCells The number of cells
+ * @param[in] nbThreads The number of threads
+ */
+int getCellsVotesBlockShift(std::size_t nbCells, int nbThreads);
+
+/**
+ * @brief Apply the votes of the buffers to the cells, in parallel over the blocks of cells, and empty the buffers
+ *        (each buffer then keeps at most its maxKeptVotes votes allocated).
+ * The votes on a cell are applied in the order of the buffers, then in the order of the votes,
+ * so the result does not depend on the number of threads used to apply them.
+ * @param[in,out] buffers The votes buffers, one per thread
+ * @param[in,out] cellsAttr The cells attributes
+ */
+void applyCellsVotes(std::vector<CellsVotesBuffer>& buffers, std::vector<GC_cellInfo>& cellsAttr);
+
+} // namespace fuseCut
+} // namespace aliceVision
@@ -7,6 +7,7 @@
 #include "DelaunayGraphCut.hpp"
 // #include <aliceVision/fuseCut/MaxFlow_CSR.hpp>
 #include <aliceVision/fuseCut/MaxFlow_AdjList.hpp>
+#include <aliceVision/fuseCut/mortonOrder.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/jetColorMap.hpp>
@@ -17,6 +18,9 @@
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/imageAlgo.hpp>
 #include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #include "nanoflann.hpp"
 
@@ -391,6 +395,113 @@ void createVerticesWithVisibilities(const StaticVector<int>& cams, std::vector<P
     ALICEVISION_LOG_INFO("Visibilities created.");
 }
 
+/// Ray from a vertex to one of its cameras
+struct VertexCameraRay
+{
+    GEO::index_t vertexIndex;
+    int cam;
+};
+
+/// Statistics of the rays traced in the tetrahedralization
+struct RaysStatistics
+{
+    std::int64_t nbRays = 0;
+    std::int64_t nbStepsFront = 0;
+    std::int64_t nbStepsBehind = 0;
+};
+
+/**
+ * @brief Trace the rays from the vertices to their cameras, and apply their votes to the cells.
+ *
+ * The vertices are sorted spatially (see DelaunayGraphCut::sortVerticesSpatially), the rays are traced by batches
+ * of consecutive vertices and sorted per camera in a batch, so that consecutive rays visit the same cells.
+ * The rays of a batch are traced in parallel, each thread appending its votes to its own buffer,
+ * then the votes are applied to the cells.
+ *
+ * The memory of the votes is bounded by sizing the batches from the number of votes per ray:
+ * it is measured on a first small batch sized for long rays, then the batches use the largest number of votes per ray seen so far
+ * and grow at most 4 times from one batch to the next. The buffers keep their share of the memory between two batches.
+ *
+ * @param[in] verticesAttr The vertices attributes
+ * @param[in] isUsedVertex Predicate on a vertex index, true to trace the rays of the vertex
+ * @param[in] traceRay Function (vertexIndex, cam, votes, nbStepsFront, nbStepsBehind) tracing a ray
+ * @param[in,out] cellsAttr The cells attributes, updated with the votes
+ * @return the statistics of the traced rays
+ */
+template<typename IsUsedVertexFunc, typename TraceRayFunc>
+RaysStatistics traceRaysByBatch(const std::vector<GC_vertexInfo>& verticesAttr, IsUsedVertexFunc isUsedVertex,
+                                TraceRayFunc traceRay, std::vector<GC_cellInfo>& cellsAttr)
+{
+    const int nbThreads = omp_get_max_threads();
+    const int cellsPerBlockShift = getCellsVotesBlockShift(cellsAttr.size(), nbThreads);
+
+    // votes kept in memory before being applied to the cells
+    const std::size_t voteBytes = CellsVotesBuffer::getVoteBytes();
+    const std::size_t maxVotes = std::max<std::size_t>(1 << 20, std::min<std::size_t>(1 << 28, system::MemoryBudget::get().getAvailableMemory() / 4 / voteBytes));
+    const system::MemoryReservation votesMemory = system::MemoryBudget::get().reserve("meshing::cellsVotes", maxVotes * voteBytes);
+    // half of the votes per batch, the blocks of the buffers grow by doubling their capacity
+    const std::size_t maxVotesPerBatch = maxVotes / 2;
+    const std::size_t maxRaysPerBatch = 1 << 24;
+    // the first batch measures the number of votes per ray of the scene, assuming a long ray (4096 votes)
+    const std::size_t nbProbeRays = std::max<std::size_t>(nbThreads, maxVotesPerBatch / 4096);
+
+    std::vector<CellsVotesBuffer> buffers(nbThreads, CellsVotesBuffer(cellsAttr.size(), cellsPerBlockShift, maxVotes / nbThreads));
+
+    RaysStatistics statistics;
+    // largest number of votes per ray of the previous batches, 0 before the first batch
+    double votesPerRay = 0.0;
+    std::size_t nbRaysMax = nbProbeRays;
+    std::vector<VertexCameraRay> rays;
+    GEO::index_t vertexIndex = 0;
+
+    while(vertexIndex < verticesAttr.size())
+    {
+        // rays of the next vertices, sorted per camera
+        rays.clear();
+        for(; vertexIndex < verticesAttr.size() && rays.size() < nbRaysMax; ++vertexIndex)
+        {
+            if(!isUsedVertex(vertexIndex))
+                continue;
+            const GC_vertexInfo& v = verticesAttr[vertexIndex];
+            for(int c = 0; c < v.cams.size(); ++c)
+            {
+                assert(v.cams[c] >= 0);
+                rays.push_back({vertexIndex, v.cams[c]});
+            }
+        }
+        std::stable_sort(rays.begin(), rays.end(), [](const VertexCameraRay& a, const VertexCameraRay& b) { return a.cam < b.cam; });
+
+        std::int64_t nbStepsFront = 0;
+        std::int64_t nbStepsBehind = 0;
+
+        // small chunks of consecutive rays per thread, the result only depends on the number of threads
+        #pragma omp parallel for schedule(static, 64) reduction(+:nbStepsFront,nbStepsBehind)
+        for(int i = 0; i < rays.size(); ++i)
+        {
+            int rayStepsFront = 0;
+            int rayStepsBehind = 0;
+            traceRay(rays[i].vertexIndex, rays[i].cam, buffers[omp_get_thread_num()], rayStepsFront, rayStepsBehind);
+            nbStepsFront += rayStepsFront;
+            nbStepsBehind += rayStepsBehind;
+        }
+
+        std::size_t nbVotes = 0;
+        for(const CellsVotesBuffer& buffer : buffers)
+            nbVotes += buffer.getNbVotes();
+        applyCellsVotes(buffers, cellsAttr);
+
+        if(!rays.empty())
+        {
+            votesPerRay = std::max({votesPerRay, 1.0, static_cast<double>(nbVotes) / rays.size()});
+            nbRaysMax = std::min({static_cast<std::size_t>(maxVotesPerBatch / votesPerRay) + 1, 4 * rays.size(), maxRaysPerBatch});
+        }
+
+        statistics.nbRays += rays.size();
+        statistics.nbStepsFront += nbStepsFront;
+        statistics.nbStepsBehind += nbStepsBehind;
+    }
+    return statistics;
+}
 
 DelaunayGraphCut::DelaunayGraphCut(mvsUtils::MultiViewParams* _mp)
 {
@@ -462,12 +573,24 @@ void DelaunayGraphCut::initVertices()
     ALICEVISION_LOG_DEBUG("initVertices done\n");
 }
 
+void DelaunayGraphCut::sortVerticesSpatially()
+{
+    ALICEVISION_TRACE_ZONE("meshing::sortVerticesSpatially");
+    assert(_verticesCoords.size() == _verticesAttr.size());
+
+    const std::vector<std::size_t> order = computeMortonOrder(_verticesCoords);
+    reorderVertices(order, _verticesCoords, _verticesAttr, _camsVertexes);
+}
+
 void DelaunayGraphCut::computeDelaunay()
 {
+    ALICEVISION_TRACE_ZONE("meshing::computeDelaunay");
     ALICEVISION_LOG_DEBUG("computeDelaunay GEOGRAM ...\n");
 
     assert(_verticesCoords.size() == _verticesAttr.size());
 
+    sortVerticesSpatially();
+
     long tall = clock();
     _tetrahedralization->set_vertices(_verticesCoords.size(), _verticesCoords.front().m);
     mvsUtils::printfElapsedTime(tall, "GEOGRAM Delaunay tetrahedralization ");
@@ -843,6 +966,7 @@ void DelaunayGraphCut::addHelperPoints(int nGridHelperVolumePointsDim, const Poi
 
 void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Point3d voxel[8], const FuseParams& params)
 {
+    ALICEVISION_TRACE_ZONE("meshing::fuseFromDepthMaps");
     ALICEVISION_LOG_INFO("fuseFromDepthMaps, maxVertices: " << params.maxPoints);
 
     std::vector<Point3d> verticesCoordsPrepare;
@@ -868,10 +992,17 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
         startIndex[i] = realMaxVertices;
         realMaxVertices += std::ceil(imgParams.width / step) * std::ceil(imgParams.height / step);
     }
+    // the prepared points are kept during the whole fusion
+    system::MemoryReservation pointsMemory("meshing");
+    pointsMemory.grow(realMaxVertices * (sizeof(Point3d) + sizeof(double) + sizeof(float)));
     verticesCoordsPrepare.resize(realMaxVertices);
     std::vector<double> pixSizePrepare(realMaxVertices);
     std::vector<float> simScorePrepare(realMaxVertices);
 
+    // depth map, sim map (and its convolution) and nmod map loaded by each thread
+    const std::size_t depthMapBytes = std::size_t(mp->getMaxImageWidth()) * mp->getMaxImageHeight() * (3 * sizeof(float) + sizeof(unsigned char));
+    const int nbLoadingThreads = system::MemoryBudget::get().getMaxParallelJobs(depthMapBytes, 3);
+
     ALICEVISION_LOG_INFO("simFactor: " << params.simFactor);
     ALICEVISION_LOG_INFO("nbPixels: " << nbPixels);
     ALICEVISION_LOG_INFO("maxVertices: " << params.maxPoints);
@@ -881,9 +1012,10 @@ void DelaunayGraphCut::fuseFromDepthMaps(const StaticVector<int>& cams, const Po
     ALICEVISION_LOG_INFO("Load depth maps and add points.");
     {
         omp_set_nested(1);
-        #pragma omp parallel for num_threads(3)
+        #pragma omp parallel for num_threads(nbLoadingThreads)
         for(int c = 0; c < cams.size(); c++)
         {
+            const system::MemoryReservation depthMapMemory = system::MemoryBudget::get().reserve("meshing::loadDepthMaps", depthMapBytes);
             std::vector<float> depthMap;
             std::vector<float> simMap;
             std::vector<unsigned char> numOfModalsMap;
@@ -1520,6 +1652,7 @@ float DelaunayGraphCut::weightFcn(float nrc, bool labatutWeights, int  /*ncams*/
 void DelaunayGraphCut::fillGraph(bool fixesSigma, float nPixelSizeBehind,
                                bool labatutWeights, bool fillOut, float distFcnHeight) // fixesSigma=true nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 labatutWeights=0 fillOut=1 distFcnHeight=0
 {
+    ALICEVISION_TRACE_ZONE("meshing::fillGraph");
     ALICEVISION_LOG_INFO("Computing s-t graph weights.");
     long t1 = clock();
 
@@ -1539,52 +1672,42 @@ void DelaunayGraphCut::fillGraph(bool fixesSigma, float nPixelSizeBehind,
         }
     }
 
-    // choose random order to prevent waiting
-    const unsigned int seed = (unsigned int)mp->userParams.get<unsigned int>("delaunaycut.seed", 0);
-    const std::vector<int> verticesRandIds = mvsUtils::createRandomArrayOfIntegers(_verticesAttr.size(), seed);
-
-    int64_t avStepsFront = 0;
-    int64_t aAvStepsFront = 0;
-    int64_t avStepsBehind = 0;
-    int64_t nAvStepsBehind = 0;
     int avCams = 0;
     int nAvCams = 0;
-
-#pragma omp parallel for reduction(+:avStepsFront,aAvStepsFront,avStepsBehind,nAvStepsBehind,avCams,nAvCams)
-    for(int i = 0; i < verticesRandIds.size(); i++)
+    for(const GC_vertexInfo& v : _verticesAttr)
     {
-        int vertexIndex = verticesRandIds[i];
-        const GC_vertexInfo& v = _verticesAttr[vertexIndex];
-
         if(v.isReal() && (v.nrc > 0))
         {
-            // "weight" is called alpha(p) in the paper
-            const float weight = weightFcn((float)v.nrc, labatutWeights, v.getNbCameras()); // number of cameras
-
-            for(int c = 0; c < v.cams.size(); c++)
-            {
-                assert(v.cams[c] >= 0);
-                assert(v.cams[c] < mp->ncams);
-
-                int nstepsFront = 0;
-                int nstepsBehind = 0;
-                fillGraphPartPtRc(nstepsFront, nstepsBehind, vertexIndex, v.cams[c], weight, fixesSigma, nPixelSizeBehind,
-                                  fillOut, distFcnHeight);
-
-                avStepsFront += nstepsFront;
-                aAvStepsFront += 1;
-                avStepsBehind += nstepsBehind;
-                nAvStepsBehind += 1;
-            } // for c
-
             avCams += v.cams.size();
             nAvCams += 1;
         }
     }
 
-    ALICEVISION_LOG_DEBUG("avStepsFront " << avStepsFront);
-    ALICEVISION_LOG_DEBUG("avStepsFront = " << mvsUtils::num2str(avStepsFront) << " // " << mvsUtils::num2str(aAvStepsFront));
-    ALICEVISION_LOG_DEBUG("avStepsBehind = " << mvsUtils::num2str(avStepsBehind) << " // " << mvsUtils::num2str(nAvStepsBehind));
+    const system::Timer timer;
+    const RaysStatistics statistics = traceRaysByBatch(_verticesAttr,
+        [&](VertexIndex vertexIndex)
+        {
+            const GC_vertexInfo& v = _verticesAttr[vertexIndex];
+            return v.isReal() && (v.nrc > 0);
+        },
+        [&](VertexIndex vertexIndex, int cam, CellsVotesBuffer& votes, int& nstepsFront, int& nstepsBehind)
+        {
+            const GC_vertexInfo& v = _verticesAttr[vertexIndex];
+            assert(cam < mp->ncams);
+
+            // "weight" is called alpha(p) in the paper
+            const float weight = weightFcn((float)v.nrc, labatutWeights, v.getNbCameras()); // number of cameras
+
+            fillGraphPartPtRc(nstepsFront, nstepsBehind, vertexIndex, cam, weight, fixesSigma, nPixelSizeBehind,
+                              fillOut, distFcnHeight, votes);
+        },
+        _cellsAttr);
+    const double elapsed = timer.elapsed();
+
+    ALICEVISION_LOG_INFO(statistics.nbRays << " rays traced in " << elapsed << " s ("
+                         << static_cast<std::int64_t>(statistics.nbRays / std::max(elapsed, 1e-6)) << " rays/s).");
+    ALICEVISION_LOG_DEBUG("avStepsFront = " << mvsUtils::num2str(statistics.nbStepsFront) << " // " << mvsUtils::num2str(statistics.nbRays));
+    ALICEVISION_LOG_DEBUG("avStepsBehind = " << mvsUtils::num2str(statistics.nbStepsBehind) << " // " << mvsUtils::num2str(statistics.nbRays));
     ALICEVISION_LOG_DEBUG("avCams = " << mvsUtils::num2str(avCams) << " // " << mvsUtils::num2str(nAvCams));
 
     mvsUtils::printfElapsedTime(t1, "s-t graph weights computed : ");
@@ -1592,7 +1715,7 @@ void DelaunayGraphCut::fillGraph(bool fixesSigma, float nPixelSizeBehind,
 
 void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBehind, int vertexIndex, int cam,
                                        float weight, bool fixesSigma, float nPixelSizeBehind,
-                                       bool fillOut, float distFcnHeight)  // fixesSigma=true nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 fillOut=1 distFcnHeight=0
+                                       bool fillOut, float distFcnHeight, CellsVotesBuffer& votes)  // fixesSigma=true nPixelSizeBehind=2*spaceSteps allPoints=1 behind=0 fillOut=1 distFcnHeight=0
 {
     out_nstepsFront = 0;
     out_nstepsBehind = 0;
@@ -1626,10 +1749,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
         bool ok = facet.cellIndex != GEO::NO_CELL;
         while(ok)
         {
-            {
-#pragma OMP_ATOMIC_UPDATE
-                _cellsAttr[facet.cellIndex].emptinessScore += weight;
-            }
+            votes.add(facet.cellIndex, ECellAttribute::EMPTINESS, weight);
 
             ++out_nstepsFront;
             ++nsteps;
@@ -1649,8 +1769,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
             {
                 {
                     const float dist = distFcn(maxDist, (originPt - p).size(), distFcnHeight);
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[outFacet.cellIndex].gEdgeVisWeight[outFacet.localVertexIndex] += weight * dist;
+                    votes.addEdgeVisWeight(outFacet.cellIndex, outFacet.localVertexIndex, weight * dist);
                 }
 
                 // Take the mirror facet to iterate over the next cell
@@ -1665,8 +1784,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
         // get the outer tetrahedron of camera c for the ray to p = the last tetrahedron
         if(facet.cellIndex != GEO::NO_CELL)
         {
-#pragma OMP_ATOMIC_WRITE
-            _cellsAttr[facet.cellIndex].cellSWeight = (float)maxint;
+            votes.add(facet.cellIndex, ECellAttribute::S_WEIGHT, (float)maxint);
         }
     }
 
@@ -1680,8 +1798,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
 
         if(facet.cellIndex != GEO::NO_CELL)
         {
-#pragma OMP_ATOMIC_UPDATE
-            _cellsAttr[facet.cellIndex].on += weight;
+            votes.add(facet.cellIndex, ECellAttribute::ON, weight);
         }
 
         Point3d p = originPt; // HAS TO BE HERE !!!
@@ -1689,11 +1806,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
         bool ok = (facet.cellIndex != GEO::NO_CELL);
         while(ok)
         {
-            GC_cellInfo& c = _cellsAttr[facet.cellIndex];
-            {
-#pragma OMP_ATOMIC_UPDATE
-                c.fullnessScore += weight;
-            }
+            votes.add(facet.cellIndex, ECellAttribute::FULLNESS, weight);
 
             ++out_nstepsBehind;
             ++nsteps;
@@ -1727,8 +1840,7 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
                 else
                 {
                     const float dist = distFcn(maxDist, (originPt - p).size(), distFcnHeight);
-#pragma OMP_ATOMIC_UPDATE
-                    _cellsAttr[facet.cellIndex].gEdgeVisWeight[facet.localVertexIndex] += weight * dist;
+                    votes.addEdgeVisWeight(facet.cellIndex, facet.localVertexIndex, weight * dist);
                 }
                 p = intersectPt;
             }
@@ -1738,14 +1850,14 @@ void DelaunayGraphCut::fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBe
 
         if(facet.cellIndex != GEO::NO_CELL)
         {
-#pragma OMP_ATOMIC_UPDATE
-            _cellsAttr[facet.cellIndex].cellTWeight += weight;
+            votes.add(facet.cellIndex, ECellAttribute::T_WEIGHT, weight);
         }
     }
 }
 
 void DelaunayGraphCut::forceTedgesByGradientIJCV(bool fixesSigma, float nPixelSizeBehind)
 {
+    ALICEVISION_TRACE_ZONE("meshing::forceTedgesByGradient");
     ALICEVISION_LOG_INFO("Forcing t-edges");
     long t2 = clock();
 
@@ -1775,30 +1887,16 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(bool fixesSigma, float nPixelSi
         // c.out = c.gEdgeVisWeight[0] + c.gEdgeVisWeight[1] + c.gEdgeVisWeight[2] + c.gEdgeVisWeight[3];
     }
 
-    // choose random order to prevent waiting
-    const unsigned int seed = (unsigned int)mp->userParams.get<unsigned int>("delaunaycut.seed", 0);
-    const std::vector<int> verticesRandIds = mvsUtils::createRandomArrayOfIntegers(_verticesAttr.size(), seed);
-
-    int64_t avStepsFront = 0;
-    int64_t aAvStepsFront = 0;
-    int64_t avStepsBehind = 0;
-    int64_t nAvStepsBehind = 0;
-
-#pragma omp parallel for reduction(+:avStepsFront,aAvStepsFront,avStepsBehind,nAvStepsBehind)
-    for(int i = 0; i < verticesRandIds.size(); ++i)
-    {
-        const int vertexIndex = verticesRandIds[i];
-        GC_vertexInfo& v = _verticesAttr[vertexIndex];
-        if(v.isVirtual())
-            continue;
-
-        const Point3d& originPt = _verticesCoords[vertexIndex];
-        for(int c = 0; c < v.cams.size(); ++c)
+    const system::Timer timer;
+    const RaysStatistics statistics = traceRaysByBatch(_verticesAttr,
+        [&](VertexIndex vertexIndex)
+        {
+            return _verticesAttr[vertexIndex].isReal();
+        },
+        [&](VertexIndex vertexIndex, int cam, CellsVotesBuffer& votes, int& nstepsFront, int& nstepsBehind)
         {
-            int nstepsFront = 0;
-            int nstepsBehind = 0;
+            const Point3d& originPt = _verticesCoords[vertexIndex];
 
-            int cam = v.cams[c];
             float maxDist = 0.0f;
             if(fixesSigma)
             {
@@ -1922,18 +2020,16 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(bool fixesSigma, float nPixelSi
                        (maxSilent < maxSilentPartRange)) // g < k_outl                  //// k_outl=100  // 400 in the paper
                         //(maxSilent-minSilent<maxSilentPartRange))
                     {
-#pragma OMP_ATOMIC_UPDATE
-                        _cellsAttr[facet.cellIndex].on += (maxJump - midSilent);
+                        votes.add(facet.cellIndex, ECellAttribute::ON, maxJump - midSilent);
                     }
                 }
             }
+        },
+        _cellsAttr);
+    const double elapsed = timer.elapsed();
 
-            avStepsFront += nstepsFront;
-            aAvStepsFront += 1;
-            avStepsBehind += nstepsBehind;
-            nAvStepsBehind += 1;
-        }
-    }
+    ALICEVISION_LOG_INFO(statistics.nbRays << " rays traced in " << elapsed << " s ("
+                         << static_cast<std::int64_t>(statistics.nbRays / std::max(elapsed, 1e-6)) << " rays/s).");
 
     for(GC_cellInfo& c: _cellsAttr)
     {
@@ -1944,10 +2040,8 @@ void DelaunayGraphCut::forceTedgesByGradientIJCV(bool fixesSigma, float nPixelSi
         // c.cellTWeight = std::max(c.cellTWeight,fit->info().on);
     }
 
-    {
-        ALICEVISION_LOG_DEBUG("avStepsFront = " << avStepsFront << " // " << aAvStepsFront);
-        ALICEVISION_LOG_DEBUG("avStepsBehind = " << avStepsBehind << " // " << nAvStepsBehind);
-    }
+    ALICEVISION_LOG_DEBUG("avStepsFront = " << statistics.nbStepsFront << " // " << statistics.nbRays);
+    ALICEVISION_LOG_DEBUG("avStepsBehind = " << statistics.nbStepsBehind << " // " << statistics.nbRays);
     mvsUtils::printfElapsedTime(t2, "t-edges forced: ");
 }
 
@@ -1995,6 +2089,7 @@ int DelaunayGraphCut::setIsOnSurface()
 
 void DelaunayGraphCut::graphCutPostProcessing()
 {
+    ALICEVISION_TRACE_ZONE("meshing::graphCutPostProcessing");
     long timer = std::clock();
     ALICEVISION_LOG_INFO("Graph cut post-processing.");
     invertFullStatusForSmallLabels();
@@ -2166,6 +2261,7 @@ void DelaunayGraphCut::invertFullStatusForSmallLabels()
 
 void DelaunayGraphCut::createDensePointCloud(Point3d hexah[8], const StaticVector<int>& cams, const sfmData::SfMData* sfmData, const FuseParams* depthMapsFuseParams)
 {
+  ALICEVISION_TRACE_ZONE("meshing::createDensePointCloud");
   assert(sfmData != nullptr || depthMapsFuseParams != nullptr);
 
   ALICEVISION_LOG_INFO("Creating dense point cloud.");
@@ -2194,6 +2290,7 @@ void DelaunayGraphCut::createDensePointCloud(Point3d hexah[8], const StaticVecto
 
 void DelaunayGraphCut::createGraphCut(Point3d hexah[8], const StaticVector<int>& cams, const std::string& folderName, const std::string& tmpCamsPtsFolderName, bool removeSmallSegments)
 {
+  ALICEVISION_TRACE_ZONE("meshing::createGraphCut");
   initVertices();
 
   // Create tetrahedralization
@@ -2242,6 +2339,7 @@ void DelaunayGraphCut::addToInfiniteSw(float sW)
 
 void DelaunayGraphCut::reconstructGC(const Point3d* hexah)
 {
+    ALICEVISION_TRACE_ZONE("meshing::maxflow");
     ALICEVISION_LOG_INFO("reconstructGC start.");
 
     maxflow();
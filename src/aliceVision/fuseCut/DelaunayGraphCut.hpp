@@ -14,6 +14,7 @@
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mesh/Mesh.hpp>
 #include <aliceVision/fuseCut/delaunayGraphCutTypes.hpp>
+#include <aliceVision/fuseCut/CellsVotes.hpp>
 #include <aliceVision/fuseCut/VoxelsGrid.hpp>
 
 #include <geogram/delaunay/delaunay.h>
@@ -266,6 +267,14 @@ public:
     }
 
     void initVertices();
+
+    /**
+     * @brief Renumber the vertices along a Morton curve, so that close vertices have close indexes
+     * and the rays of neighboring vertices visit the same memory.
+     * Must be called before the tetrahedralization.
+     */
+    void sortVerticesSpatially();
+
     void computeDelaunay();
     void initCells();
     void displayStatistics();
@@ -314,7 +323,7 @@ public:
                            bool fillOut, float distFcnHeight = 0.0f);
     void fillGraphPartPtRc(int& out_nstepsFront, int& out_nstepsBehind, int vertexIndex, int cam, float weight,
                            bool fixesSigma, float nPixelSizeBehind, bool fillOut,
-                           float distFcnHeight);
+                           float distFcnHeight, CellsVotesBuffer& votes);
 
     void forceTedgesByGradientIJCV(bool fixesSigma, float nPixelSizeBehind);
 
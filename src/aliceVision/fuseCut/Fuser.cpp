@@ -6,6 +6,7 @@
 
 #include "Fuser.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
 #include <aliceVision/mvsData/Pixel.hpp>
@@ -58,9 +59,16 @@ unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams* mp, int
     return npts;
 }
 
-Fuser::Fuser(const mvsUtils::MultiViewParams* _mp)
+Fuser::Fuser(const mvsUtils::MultiViewParams* _mp, mvsUtils::DepthSimMapsCache* depthSimMapsCache)
   : mp(_mp)
-{}
+  , _depthSimMapsCache(depthSimMapsCache)
+{
+    if(_depthSimMapsCache == nullptr)
+    {
+        _ownedDepthSimMapsCache.reset(new mvsUtils::DepthSimMapsCache(mp, mvsUtils::DepthSimMapsCache::getDefaultMaxMemory(mp)));
+        _depthSimMapsCache = _ownedDepthSimMapsCache.get();
+    }
+}
 
 Fuser::~Fuser()
 {
@@ -81,7 +89,7 @@ Fuser::~Fuser()
  * @param[in] scale
  */
 bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc,
-                           StaticVector<int>* numOfPtsMap, StaticVector<float>* depthMap, StaticVector<float>* simMap,
+                           StaticVector<int>* numOfPtsMap, const std::vector<float>& depthMap, const std::vector<float>& simMap,
                            int scale)
 {
     int w = mp->getWidth(rc) / scale;
@@ -102,7 +110,7 @@ bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc
 
     int d = pixSizeBall;
 
-    float sim = (*simMap)[cell.y * w + cell.x];
+    float sim = simMap[cell.y * w + cell.x];
     if(sim >= 1.0f)
     {
         d = pixSizeBallWSP;
@@ -117,7 +125,7 @@ bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc
         for(ncell.y = std::max(0, cell.y - d); ncell.y <= std::min(h - 1, cell.y + d); ncell.y++)
         {
             // printf("%i %i %i %i %i %i %i %i\n",ncell.x,ncell.y,w,h,w*h,depthMap->size(),cam,scale);
-            float depth = (*depthMap)[ncell.y * w + ncell.x];
+            float depth = depthMap[ncell.y * w + ncell.x];
             // Point3d p1 = mp->CArr[rc] +
             // (mp->iCamArr[rc]*Point2d((float)ncell.x*(float)scale,(float)ncell.y*(float)scale)).normalize()*depth;
             // if ( (p1-p).size() < pixSize ) {
@@ -134,6 +142,7 @@ bool Fuser::updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc
 // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,...
 void Fuser::filterGroups(const StaticVector<int>& cams, int pixSizeBall, int pixSizeBallWSP, int nNearestCams)
 {
+    ALICEVISION_TRACE_ZONE("fusion::filterGroups");
     ALICEVISION_LOG_INFO("Precomputing groups.");
     long t1 = clock();
 #pragma omp parallel for
@@ -158,15 +167,10 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
     int w = mp->getWidth(rc);
     int h = mp->getHeight(rc);
 
-    StaticVector<float> depthMap;
-    StaticVector<float> simMap;
-
-    {
-        int width, height;
-
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 1), width, height, depthMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
-    }
+    // the maps are read once from the cache, the neighbor depth maps are shared with the other cameras
+    const mvsUtils::DepthSimMapsCache::MapsSharedPtr rcMaps = _depthSimMapsCache->get(rc, 1);
+    const std::vector<float>& depthMap = rcMaps->depthMap;
+    const std::vector<float>& simMap = rcMaps->simMap;
 
     std::vector<unsigned char> numOfModalsMap(w * h, 0);
 
@@ -189,10 +193,10 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
         numOfPtsMap->resize_with(w * h, 0);
         int tc = tcams[c];
 
-        StaticVector<float> tcdepthMap;
-
-        int tcWidth, tcHeight;
-        imageIO::readImage(getFileNameFromIndex(mp, tc, mvsUtils::EFileType::depthMap, 1), tcWidth, tcHeight, tcdepthMap.getDataWritable(), imageIO::EImageColorSpace::NO_CONVERSION);
+        const mvsUtils::DepthSimMapsCache::MapsSharedPtr tcMaps = _depthSimMapsCache->get(tc, 1, false);
+        const std::vector<float>& tcdepthMap = tcMaps->depthMap;
+        const int tcWidth = tcMaps->width;
+        const int tcHeight = tcMaps->height;
 
         if(!tcdepthMap.empty())
         {
@@ -204,7 +208,7 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
                     if(depth > 0.0f)
                     {
                       Point3d p = mp->CArr[tc] + (mp->iCamArr[tc] * Point2d((float)x, (float)y)).normalize() * depth;
-                      updateInSurr(pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, &depthMap, &simMap, 1);
+                      updateInSurr(pixSizeBall, pixSizeBallWSP, p, rc, tc, numOfPtsMap, depthMap, simMap, 1);
                     }
                 }
             }
@@ -235,6 +239,7 @@ bool Fuser::filterGroupsRC(int rc, int pixSizeBall, int pixSizeBallWSP, int nNea
 // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,...
 void Fuser::filterDepthMaps(const StaticVector<int>& cams, int minNumOfModals, int minNumOfModalsWSP2SSP)
 {
+    ALICEVISION_TRACE_ZONE("fusion::filterDepthMaps");
     ALICEVISION_LOG_INFO("Filtering depth maps.");
     long t1 = clock();
 
@@ -260,10 +265,12 @@ bool Fuser::filterDepthMapsRC(int rc, int minNumOfModals, int minNumOfModalsWSP2
     std::vector<unsigned char> numOfModalsMap;
 
     {
-        int width, height;
+        // copy, the maps are modified
+        const mvsUtils::DepthSimMapsCache::MapsSharedPtr rcMaps = _depthSimMapsCache->get(rc, 1);
+        depthMap = rcMaps->depthMap;
+        simMap = rcMaps->simMap;
 
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::depthMap, 1), width, height, depthMap, imageIO::EImageColorSpace::NO_CONVERSION);
-        imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::simMap, 1), width, height, simMap, imageIO::EImageColorSpace::NO_CONVERSION);
+        int width, height;
         imageIO::readImage(getFileNameFromIndex(mp, rc, mvsUtils::EFileType::nmodMap), width, height, numOfModalsMap, imageIO::EImageColorSpace::NO_CONVERSION);
     }
 
@@ -425,6 +432,7 @@ float Fuser::computeAveragePixelSizeInHexahedron(Point3d* hexah, const sfmData::
  */
 void Fuser::divideSpaceFromDepthMaps(Point3d* hexah, float& minPixSize)
 {
+    ALICEVISION_TRACE_ZONE("fusion::divideSpaceFromDepthMaps");
     ALICEVISION_LOG_INFO("Estimate space from depth maps.");
     int scale = 0;
 
@@ -589,6 +597,7 @@ bool checkLandmarkMinObservationAngle(const sfmData::SfMData& sfmData, const sfm
 
 void Fuser::divideSpaceFromSfM(const sfmData::SfMData& sfmData, Point3d* hexah, std::size_t minObservations, float minObservationAngle) const
 {
+  ALICEVISION_TRACE_ZONE("fusion::divideSpaceFromSfM");
   ALICEVISION_LOG_INFO("Estimate space from SfM.");
 
   const std::size_t cacheSize =  10000;
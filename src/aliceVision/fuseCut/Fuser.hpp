@@ -7,11 +7,15 @@
 #pragma once
 
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/DepthSimMapsCache.hpp>
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsData/Universe.hpp>
 #include <aliceVision/mvsData/Voxel.hpp>
 
+#include <memory>
+#include <vector>
+
 namespace aliceVision {
 
 namespace sfmData {
@@ -25,7 +29,12 @@ class Fuser
 public:
     const mvsUtils::MultiViewParams* mp;
 
-    Fuser(const mvsUtils::MultiViewParams* _mp);
+    /**
+     * @param[in] _mp the multi-view parameters
+     * @param[in] depthSimMapsCache the depth/sim maps of the cameras, shared with the depth map estimation
+     *            running in the same process. If null, the maps are read from disk through a cache owned by the Fuser.
+     */
+    Fuser(const mvsUtils::MultiViewParams* _mp, mvsUtils::DepthSimMapsCache* depthSimMapsCache = nullptr);
     ~Fuser(void);
 
     // minNumOfModals number of other cams including this cam ... minNumOfModals /in 2,3,... default 3
@@ -46,7 +55,10 @@ public:
 
 private:
     bool updateInSurr(int pixSizeBall, int pixSizeBallWSP, Point3d& p, int rc, int tc, StaticVector<int>* numOfPtsMap,
-                      StaticVector<float>* depthMap, StaticVector<float>* simMap, int scale);
+                      const std::vector<float>& depthMap, const std::vector<float>& simMap, int scale);
+
+    std::unique_ptr<mvsUtils::DepthSimMapsCache> _ownedDepthSimMapsCache;
+    mvsUtils::DepthSimMapsCache* _depthSimMapsCache;
 };
 
 unsigned long computeNumberOfAllPoints(const mvsUtils::MultiViewParams* mp, int scale);
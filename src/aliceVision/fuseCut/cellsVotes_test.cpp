@@ -0,0 +1,195 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/fuseCut/CellsVotes.hpp>
+#include <aliceVision/fuseCut/mortonOrder.hpp>
+
+#define BOOST_TEST_MODULE cellsVotes
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::fuseCut;
+
+namespace {
+
+struct TestVote
+{
+    std::uint32_t cellIndex;
+    int attribute;
+    float value;
+};
+
+bool sameCell(const GC_cellInfo& a, const GC_cellInfo& b)
+{
+    return a.cellSWeight == b.cellSWeight && a.cellTWeight == b.cellTWeight && a.gEdgeVisWeight == b.gEdgeVisWeight &&
+           a.fullnessScore == b.fullnessScore && a.emptinessScore == b.emptinessScore && a.on == b.on;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(cellsVotes_applySerialEquivalence)
+{
+    const std::size_t nbCells = 50000;
+    const int nbBuffers = 4;
+    const int nbAttributes = static_cast<int>(ECellAttribute::EDGE_VIS_WEIGHT) + 4;
+    const int cellsPerBlockShift = getCellsVotesBlockShift(nbCells, nbBuffers);
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<std::uint32_t> cellDistribution(0, nbCells - 1);
+    std::uniform_int_distribution<int> attributeDistribution(0, nbAttributes - 1);
+    std::uniform_real_distribution<float> valueDistribution(0.0f, 1.0f);
+
+    std::vector<GC_cellInfo> cells(nbCells);
+    std::vector<GC_cellInfo> cellsSerial(nbCells);
+    std::vector<CellsVotesBuffer> buffers(nbBuffers, CellsVotesBuffer(nbCells, cellsPerBlockShift, 1000));
+
+    // several batches of votes, applied in the order of the buffers then in the order of the votes
+    for(int batch = 0; batch < 3; ++batch)
+    {
+        std::vector<std::vector<TestVote>> votesPerBuffer(nbBuffers);
+        for(int b = 0; b < nbBuffers; ++b)
+        {
+            for(int i = 0; i < 20000; ++i)
+            {
+                // votes concentrated on a few cells, so that the order of the additions matters
+                const std::uint32_t cellIndex = (i % 3 == 0) ? (i % 7) : cellDistribution(generator);
+                votesPerBuffer[b].push_back({cellIndex, attributeDistribution(generator), valueDistribution(generator)});
+            }
+        }
+
+        for(int b = 0; b < nbBuffers; ++b)
+        {
+            for(const TestVote& vote : votesPerBuffer[b])
+            {
+                if(vote.attribute >= static_cast<int>(ECellAttribute::EDGE_VIS_WEIGHT))
+                    buffers[b].addEdgeVisWeight(vote.cellIndex, vote.attribute - static_cast<int>(ECellAttribute::EDGE_VIS_WEIGHT), vote.value);
+                else
+                    buffers[b].add(vote.cellIndex, static_cast<ECellAttribute>(vote.attribute), vote.value);
+            }
+            BOOST_CHECK_EQUAL(buffers[b].getNbVotes(), votesPerBuffer[b].size());
+        }
+
+        // serial accumulation
+        for(int b = 0; b < nbBuffers; ++b)
+        {
+            for(const TestVote& vote : votesPerBuffer[b])
+            {
+                GC_cellInfo& c = cellsSerial[vote.cellIndex];
+                switch(static_cast<ECellAttribute>(vote.attribute))
+                {
+                    case ECellAttribute::EMPTINESS: c.emptinessScore += vote.value; break;
+                    case ECellAttribute::FULLNESS:  c.fullnessScore += vote.value; break;
+                    case ECellAttribute::ON:        c.on += vote.value; break;
+                    case ECellAttribute::T_WEIGHT:  c.cellTWeight += vote.value; break;
+                    case ECellAttribute::S_WEIGHT:  c.cellSWeight = vote.value; break;
+                    default:
+                        c.gEdgeVisWeight[vote.attribute - static_cast<int>(ECellAttribute::EDGE_VIS_WEIGHT)] += vote.value;
+                }
+            }
+        }
+
+        applyCellsVotes(buffers, cells);
+
+        for(const CellsVotesBuffer& buffer : buffers)
+        {
+            BOOST_CHECK_EQUAL(buffer.getNbVotes(), 0);
+            // the blocks which grew past the share of the buffer are released
+            BOOST_CHECK_LE(buffer.getCapacity(), 1000);
+        }
+
+        std::size_t nbDifferentCells = 0;
+        for(std::size_t i = 0; i < nbCells; ++i)
+        {
+            if(!sameCell(cells[i], cellsSerial[i]))
+                ++nbDifferentCells;
+        }
+        BOOST_CHECK_EQUAL(nbDifferentCells, 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cellsVotes_mortonOrder)
+{
+    // corners of a cube: the Morton code interleaves x, y and z from the lowest bit
+    std::vector<Point3d> corners;
+    for(int z = 1; z >= 0; --z)
+        for(int y = 1; y >= 0; --y)
+            for(int x = 1; x >= 0; --x)
+                corners.push_back(Point3d(x, y, z));
+
+    const std::vector<std::size_t> cornersOrder = computeMortonOrder(corners);
+    BOOST_REQUIRE_EQUAL(cornersOrder.size(), corners.size());
+    for(std::size_t i = 0; i < cornersOrder.size(); ++i)
+    {
+        const Point3d& p = corners[cornersOrder[i]];
+        BOOST_CHECK_EQUAL(static_cast<std::size_t>(p.x + 2 * p.y + 4 * p.z), i);
+    }
+
+    // random points: the order is a permutation
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<double> distribution(-10.0, 10.0);
+    std::vector<Point3d> points(10000);
+    for(Point3d& p : points)
+        p = Point3d(distribution(generator), distribution(generator), distribution(generator));
+
+    std::vector<std::size_t> order = computeMortonOrder(points);
+    BOOST_REQUIRE_EQUAL(order.size(), points.size());
+    std::sort(order.begin(), order.end());
+    for(std::size_t i = 0; i < order.size(); ++i)
+        BOOST_CHECK_EQUAL(order[i], i);
+
+    BOOST_CHECK(computeMortonOrder(std::vector<Point3d>()).empty());
+}
+
+BOOST_AUTO_TEST_CASE(cellsVotes_reorderVertices)
+{
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+    const int nbVertices = 1000;
+    std::vector<Point3d> verticesCoords(nbVertices);
+    std::vector<GC_vertexInfo> verticesAttr(nbVertices);
+    for(int i = 0; i < nbVertices; ++i)
+    {
+        verticesCoords[i] = Point3d(distribution(generator), distribution(generator), distribution(generator));
+        verticesAttr[i].nrc = i;
+        verticesAttr[i].cams.push_back(i % 10);
+    }
+    // vertexes of the cameras, -1 for the cameras without vertex
+    std::vector<int> camsVertexes = {10, -1, 999, 0, -1, 500};
+
+    const std::vector<Point3d> initialCoords = verticesCoords;
+    const std::vector<int> initialCamsVertexes = camsVertexes;
+
+    const std::vector<std::size_t> order = computeMortonOrder(verticesCoords);
+    reorderVertices(order, verticesCoords, verticesAttr, camsVertexes);
+
+    BOOST_REQUIRE_EQUAL(verticesCoords.size(), nbVertices);
+    BOOST_REQUIRE_EQUAL(verticesAttr.size(), nbVertices);
+    for(int i = 0; i < nbVertices; ++i)
+    {
+        BOOST_CHECK(verticesCoords[i] == initialCoords[order[i]]);
+        BOOST_CHECK_EQUAL(verticesAttr[i].nrc, order[i]);
+        BOOST_REQUIRE_EQUAL(verticesAttr[i].cams.size(), 1);
+        BOOST_CHECK_EQUAL(verticesAttr[i].cams[0], order[i] % 10);
+    }
+
+    BOOST_REQUIRE_EQUAL(camsVertexes.size(), initialCamsVertexes.size());
+    for(std::size_t c = 0; c < camsVertexes.size(); ++c)
+    {
+        if(initialCamsVertexes[c] < 0)
+        {
+            BOOST_CHECK_EQUAL(camsVertexes[c], -1);
+            continue;
+        }
+        BOOST_REQUIRE_GE(camsVertexes[c], 0);
+        BOOST_CHECK_EQUAL(order[camsVertexes[c]], initialCamsVertexes[c]);
+        BOOST_CHECK(verticesCoords[camsVertexes[c]] == initialCoords[initialCamsVertexes[c]]);
+    }
+}
@@ -0,0 +1,96 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "mortonOrder.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace aliceVision {
+namespace fuseCut {
+
+namespace {
+
+/// Interleave the 21 lower bits of v with two zero bits between each bit
+inline std::uint64_t spreadBitsBy3(std::uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffff;
+    v = (v | v << 16) & 0x1f0000ff0000ff;
+    v = (v | v << 8) & 0x100f00f00f00f00f;
+    v = (v | v << 4) & 0x10c30c30c30c30c3;
+    v = (v | v << 2) & 0x1249249249249249;
+    return v;
+}
+
+} // namespace
+
+std::vector<std::size_t> computeMortonOrder(const std::vector<Point3d>& points)
+{
+    Point3d minPoint(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d maxPoint(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+    for(const Point3d& p : points)
+    {
+        for(int i = 0; i < 3; ++i)
+        {
+            minPoint.m[i] = std::min(minPoint.m[i], p.m[i]);
+            maxPoint.m[i] = std::max(maxPoint.m[i], p.m[i]);
+        }
+    }
+
+    // 21 bits per axis
+    const double extent = std::max({maxPoint.x - minPoint.x, maxPoint.y - minPoint.y, maxPoint.z - minPoint.z, std::numeric_limits<double>::min()});
+    const double scale = double(0x1fffff) / extent;
+
+    std::vector<std::pair<std::uint64_t, std::size_t>> codes(points.size());
+    #pragma omp parallel for
+    for(int i = 0; i < points.size(); ++i)
+    {
+        const Point3d& p = points[i];
+        codes[i].first = spreadBitsBy3(static_cast<std::uint64_t>((p.x - minPoint.x) * scale)) |
+                         spreadBitsBy3(static_cast<std::uint64_t>((p.y - minPoint.y) * scale)) << 1 |
+                         spreadBitsBy3(static_cast<std::uint64_t>((p.z - minPoint.z) * scale)) << 2;
+        codes[i].second = i;
+    }
+    std::sort(codes.begin(), codes.end());
+
+    std::vector<std::size_t> order(points.size());
+    for(std::size_t i = 0; i < codes.size(); ++i)
+        order[i] = codes[i].second;
+    return order;
+}
+
+void reorderVertices(const std::vector<std::size_t>& order, std::vector<Point3d>& verticesCoords,
+                     std::vector<GC_vertexInfo>& verticesAttr, std::vector<int>& camsVertexes)
+{
+    assert(order.size() == verticesCoords.size());
+    assert(order.size() == verticesAttr.size());
+
+    std::vector<Point3d> newVerticesCoords(order.size());
+    std::vector<GC_vertexInfo> newVerticesAttr(order.size());
+    std::vector<int> newIndexes(order.size());
+    for(std::size_t vi = 0; vi < order.size(); ++vi)
+    {
+        newVerticesCoords[vi] = verticesCoords[order[vi]];
+        newVerticesAttr[vi] = std::move(verticesAttr[order[vi]]);
+        newIndexes[order[vi]] = vi;
+    }
+    verticesCoords.swap(newVerticesCoords);
+    verticesAttr.swap(newVerticesAttr);
+
+    for(int& camVertex : camsVertexes)
+    {
+        if(camVertex >= 0)
+            camVertex = newIndexes[camVertex];
+    }
+}
+
+} // namespace fuseCut
+} // namespace aliceVision
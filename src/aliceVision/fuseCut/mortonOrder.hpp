@@ -0,0 +1,36 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/fuseCut/delaunayGraphCutTypes.hpp>
+#include <aliceVision/mvsData/Point3d.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace fuseCut {
+
+/**
+ * @brief Get the order of the points along the Morton curve of their bounding box
+ * @param[in] points The points
+ * @return order[i] is the index of the i-th point on the curve
+ */
+std::vector<std::size_t> computeMortonOrder(const std::vector<Point3d>& points);
+
+/**
+ * @brief Renumber the vertices: the new vertex i is the previous vertex order[i]
+ * @param[in] order The permutation of the vertices (see computeMortonOrder)
+ * @param[in,out] verticesCoords The vertices coordinates
+ * @param[in,out] verticesAttr The vertices attributes
+ * @param[in,out] camsVertexes The vertex index of each camera (or -1), remapped to the new numbering
+ */
+void reorderVertices(const std::vector<std::size_t>& order, std::vector<Point3d>& verticesCoords,
+                     std::vector<GC_vertexInfo>& verticesAttr, std::vector<int>& camsVertexes);
+
+} // namespace fuseCut
+} // namespace aliceVision
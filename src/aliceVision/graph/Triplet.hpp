@@ -9,10 +9,13 @@
 
 #include <aliceVision/types.hpp>
 #include <aliceVision/graph/graph.hpp>
+#include <aliceVision/stl/parallelSort.hpp>
 
 #include <lemon/list_graph.h>
 
 #include <algorithm>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace aliceVision {
@@ -119,29 +122,137 @@ bool List_Triplets(const GraphT & g, std::vector< Triplet > & vec_triplets)
   return (!vec_triplets.empty());
 }
 
-/// Return triplets contained in the graph build from IterablePairs
+/**
+ * @brief Return the triplets contained in the graph built from IterablePairs.
+ *
+ * The graph is stored in a compact form (CSR) where each edge is oriented from its node of
+ * lowest degree to its node of highest degree. Each triangle is then found exactly once,
+ * from its lowest node, by intersecting two sorted adjacency lists, which bounds the work
+ * to O(E^1.5) whatever the degree distribution. The nodes are processed in parallel.
+ *
+ * @param[in] pairs the edges of the graph, as pairs of node ids (duplicates and both
+ *            orientations of an edge are allowed)
+ * @return the triplets of node ids, each one sorted (i < j < k), in lexicographic order
+ */
 template <typename IterablePairs>
 inline std::vector< graph::Triplet > tripletListing(
   const IterablePairs & pairs)
 {
-  std::vector< graph::Triplet > vec_triplets;
+  // compact node indexes
+  std::vector<IndexT> nodeIds;
+  for(const auto& pair : pairs)
+  {
+    nodeIds.push_back(pair.first);
+    nodeIds.push_back(pair.second);
+  }
+  std::sort(nodeIds.begin(), nodeIds.end());
+  nodeIds.erase(std::unique(nodeIds.begin(), nodeIds.end()), nodeIds.end());
 
-  indexedGraph putativeGraph(pairs);
+  const auto nodeIndex = [&nodeIds](IndexT id)
+  {
+    return static_cast<int>(std::lower_bound(nodeIds.begin(), nodeIds.end(), id) - nodeIds.begin());
+  };
 
-  graph::List_Triplets<indexedGraph::GraphT>(putativeGraph.g, vec_triplets);
+  // unique undirected edges
+  std::vector<std::pair<int, int>> edges;
+  for(const auto& pair : pairs)
+  {
+    const int a = nodeIndex(pair.first);
+    const int b = nodeIndex(pair.second);
+    if(a != b)
+      edges.emplace_back(std::min(a, b), std::max(a, b));
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
 
-  //Change triplets to ImageIds
-  for (size_t i = 0; i < vec_triplets.size(); ++i)
+  // rank the nodes by degree, ties broken by index
+  const int nbNodes = static_cast<int>(nodeIds.size());
+  std::vector<int> degrees(nbNodes, 0);
+  for(const auto& edge : edges)
   {
-    graph::Triplet & triplet = vec_triplets[i];
-    IndexT I = triplet.i, J = triplet.j , K = triplet.k;
-    I = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(I)];
-    J = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(J)];
-    K = (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(K)];
-    IndexT triplet_[3] = { I, J, K };
-    std::sort(&triplet_[0], &triplet_[3]);
-    triplet = graph::Triplet(triplet_[0],triplet_[1],triplet_[2]);
+    ++degrees[edge.first];
+    ++degrees[edge.second];
   }
+  std::vector<int> nodesByRank(nbNodes);
+  for(int i = 0; i < nbNodes; ++i)
+    nodesByRank[i] = i;
+  std::sort(nodesByRank.begin(), nodesByRank.end(), [&degrees](int a, int b)
+  {
+    return degrees[a] < degrees[b] || (degrees[a] == degrees[b] && a < b);
+  });
+  std::vector<int> ranks(nbNodes);
+  for(int r = 0; r < nbNodes; ++r)
+    ranks[nodesByRank[r]] = r;
+
+  // CSR adjacency of the edges oriented by increasing rank, neighbors sorted by rank
+  std::vector<std::size_t> offsets(nbNodes + 1, 0);
+  for(const auto& edge : edges)
+    ++offsets[std::min(ranks[edge.first], ranks[edge.second]) + 1];
+  for(int r = 0; r < nbNodes; ++r)
+    offsets[r + 1] += offsets[r];
+
+  std::vector<int> neighbors(edges.size());
+  {
+    std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+    for(const auto& edge : edges)
+    {
+      const int ra = ranks[edge.first];
+      const int rb = ranks[edge.second];
+      neighbors[fill[std::min(ra, rb)]++] = std::max(ra, rb);
+    }
+  }
+  #pragma omp parallel for schedule(dynamic, 256)
+  for(int r = 0; r < nbNodes; ++r)
+    std::sort(neighbors.begin() + offsets[r], neighbors.begin() + offsets[r + 1]);
+
+  std::vector< graph::Triplet > vec_triplets;
+
+  #pragma omp parallel
+  {
+    std::vector< graph::Triplet > threadTriplets;
+
+    #pragma omp for schedule(dynamic, 64)
+    for(int u = 0; u < nbNodes; ++u)
+    {
+      const int* uBegin = neighbors.data() + offsets[u];
+      const int* uEnd = neighbors.data() + offsets[u + 1];
+
+      for(const int* v = uBegin; v != uEnd; ++v)
+      {
+        // common neighbors of u and v, of higher rank than v
+        const int* a = v + 1;
+        const int* b = neighbors.data() + offsets[*v];
+        const int* bEnd = neighbors.data() + offsets[*v + 1];
+        while(a != uEnd && b != bEnd)
+        {
+          if(*a < *b)
+            ++a;
+          else if(*b < *a)
+            ++b;
+          else
+          {
+            IndexT triplet[3] = {
+              nodeIds[nodesByRank[u]],
+              nodeIds[nodesByRank[*v]],
+              nodeIds[nodesByRank[*a]]};
+            std::sort(&triplet[0], &triplet[3]);
+            threadTriplets.emplace_back(triplet[0], triplet[1], triplet[2]);
+            ++a;
+            ++b;
+          }
+        }
+      }
+    }
+
+    #pragma omp critical
+    vec_triplets.insert(vec_triplets.end(), threadTriplets.begin(), threadTriplets.end());
+  }
+
+  // the order does not depend on the number of threads
+  stl::parallel_stable_sort(vec_triplets.begin(), vec_triplets.end(), [](const graph::Triplet& a, const graph::Triplet& b)
+  {
+    return std::tie(a.i, a.j, a.k) < std::tie(b.i, b.j, b.k);
+  });
   return vec_triplets;
 }
 
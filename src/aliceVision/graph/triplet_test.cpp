@@ -7,7 +7,10 @@
 
 #include "aliceVision/graph/Triplet.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <random>
+#include <tuple>
 #include <vector>
 
 #define BOOST_TEST_MODULE tripletFinder
@@ -269,3 +272,52 @@ BOOST_AUTO_TEST_CASE(test_for_triplet) {
     BOOST_CHECK_EQUAL(4, vec_triplets.size());
   }
 }
+
+BOOST_AUTO_TEST_CASE(test_tripletListing_sameAsListTriplets) {
+
+  std::mt19937 generator(42);
+
+  for(const int nbNodes : {10, 50, 200})
+  {
+    // random graph with a few high degree nodes, as in a view graph
+    std::uniform_int_distribution<int> node(0, nbNodes - 1);
+    std::uniform_int_distribution<int> hub(0, 4);
+    aliceVision::PairSet pairs;
+    for(int e = 0; e < nbNodes * 4; ++e)
+    {
+      const int a = (e % 3 == 0) ? hub(generator) : node(generator);
+      const int b = node(generator);
+      if(a != b)
+        pairs.insert(std::make_pair(std::min(a, b) * 10 + 3, std::max(a, b) * 10 + 3));
+    }
+
+    std::vector< Triplet > expected;
+    {
+      indexedGraph putativeGraph(pairs);
+      List_Triplets<indexedGraph::GraphT>(putativeGraph.g, expected);
+      for(Triplet& triplet : expected)
+      {
+        aliceVision::IndexT ids[3] = {
+          (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(triplet.i)],
+          (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(triplet.j)],
+          (*putativeGraph.map_nodeMapIndex)[putativeGraph.g.nodeFromId(triplet.k)]};
+        std::sort(&ids[0], &ids[3]);
+        triplet = Triplet(ids[0], ids[1], ids[2]);
+      }
+      std::sort(expected.begin(), expected.end(), [](const Triplet& a, const Triplet& b)
+      {
+        return std::tie(a.i, a.j, a.k) < std::tie(b.i, b.j, b.k);
+      });
+    }
+
+    const std::vector< Triplet > triplets = tripletListing(pairs);
+    BOOST_CHECK(!triplets.empty());
+    BOOST_REQUIRE_EQUAL(expected.size(), triplets.size());
+    for(std::size_t i = 0; i < triplets.size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(expected[i].i, triplets[i].i);
+      BOOST_CHECK_EQUAL(expected[i].j, triplets[i].j);
+      BOOST_CHECK_EQUAL(expected[i].k, triplets[i].k);
+    }
+  }
+}
@@ -5,11 +5,15 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "hdrMerge.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <stdexcept>
 
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
@@ -42,6 +46,201 @@ inline float sigmoidInv(float zeroVal, float endVal, float sigwidth, float sigMi
     return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + expf(10.0f * ((sigMid - xval) / sigwidth))));
 }
 
+namespace {
+
+/**
+ * @brief Curve lookup tables of the merge, shared by the in-memory and the streaming merge.
+ */
+struct MergeCurves
+{
+  MergeCurves(const std::vector<float>& times, const rgbCurve& weight, const rgbCurve& response)
+    : weightShortestExposure(weight)
+    , weightLongestExposure(weight)
+    , response(response)
+  {
+    weightShortestExposure.freezeSecondPartValues();
+    weightLongestExposure.freezeFirstPartValues();
+
+    // Contributions are summed in the following order, as in the original merge:
+    //
+    // weightShortestExposure:          _______
+    //                          _______/
+    //                                0      1
+    // weight:          ____
+    //          _______/    \________
+    //                0      1
+    // weightLongestExposure:  ____________
+    //                                      \_______
+    //                                0      1
+    const std::size_t nbImages = times.size();
+    terms.push_back({0, &weightShortestExposure, times.front()});
+    for(std::size_t i = 1; i < nbImages - 1; ++i)
+      terms.push_back({i, &weight, times[i]});
+    terms.push_back({nbImages - 1, &weightLongestExposure, times.back()});
+  }
+
+  struct Term
+  {
+    std::size_t imageIndex;
+    const rgbCurve* weight;
+    double time;
+  };
+
+  rgbCurve weightShortestExposure;
+  rgbCurve weightLongestExposure;
+  const rgbCurve& response;
+  std::vector<Term> terms;
+};
+
+/**
+ * @brief Linear interpolation in a curve, same result as rgbCurve::operator() without the
+ * function call and the branch on the last value, so that it can be inlined in the pixel loop.
+ */
+inline float interpolate(const float* curve, std::size_t lastIndex, float sample)
+{
+  const float valueScaled = std::max(0.f, std::min(1.f, sample)) * static_cast<float>(lastIndex);
+  const std::size_t infIndex = static_cast<std::size_t>(valueScaled);
+  const float fractionalPart = valueScaled - static_cast<float>(infIndex);
+  // for the last value, fractionalPart is 0 so it gives the value itself
+  const std::size_t supIndex = std::min(infIndex + 1, lastIndex);
+  return (1.0f - fractionalPart) * curve[infIndex] + fractionalPart * curve[supIndex];
+}
+
+/**
+ * @brief Merge one row of all the images.
+ * @param[in] rows The row of each image
+ * @param[in] curves The merge curves
+ * @param[in] width The number of pixels of the row
+ * @param[in] targetCameraExposure The target exposure
+ * @param[in,out] wsum Scratch buffer of 3 * width values
+ * @param[in,out] wdiv Scratch buffer of 3 * width values
+ * @param[out] radianceRow The merged row
+ */
+void mergeRow(const std::vector<const image::RGBfColor*>& rows,
+              const MergeCurves& curves,
+              std::size_t width,
+              float targetCameraExposure,
+              std::vector<double>& wsum,
+              std::vector<double>& wdiv,
+              image::RGBfColor* radianceRow)
+{
+  const std::size_t nbValues = 3 * width;
+  const std::size_t lastIndex = curves.response.getSize() - 1;
+
+  std::fill(wsum.begin(), wsum.begin() + nbValues, 0.0);
+  std::fill(wdiv.begin(), wdiv.begin() + nbValues, 0.0);
+
+  // accumulate image by image: each value keeps the same summation order as the
+  // per-pixel merge, while the inner loop runs over contiguous values
+  for(const MergeCurves::Term& term : curves.terms)
+  {
+    const float* values = rows[term.imageIndex]->data();
+    for(std::size_t channel = 0; channel < 3; ++channel)
+    {
+      const float* weightCurve = term.weight->getCurve(channel).data();
+      const float* responseCurve = curves.response.getCurve(channel).data();
+      for(std::size_t i = channel; i < nbValues; i += 3)
+      {
+        const float value = values[i];
+        const double w = std::max(0.001f, interpolate(weightCurve, lastIndex, value));
+        const double r = interpolate(responseCurve, lastIndex, value);
+        wsum[i] += w * r / term.time;
+        wdiv[i] += w;
+      }
+    }
+  }
+
+  float* radiance = radianceRow->data();
+  for(std::size_t i = 0; i < nbValues; ++i)
+    radiance[i] = wsum[i] / std::max(0.001, wdiv[i]) * targetCameraExposure;
+}
+
+/**
+ * @brief Compute the clamping mask of the shortest exposure rows, used by the highlight correction.
+ * @param[in] image The first row of the shortest exposure
+ * @param[in] width The image width
+ * @param[in] height The number of rows
+ * @param[out] isPixelClamped The clamping mask of the rows
+ */
+void computeClampedMask(const image::RGBfColor* image, int width, int height, image::Image<float>& isPixelClamped)
+{
+  isPixelClamped.resize(width, height);
+
+  #pragma omp parallel for
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const image::RGBfColor& color = image[std::size_t(y) * width + x];
+      float& isClamped = isPixelClamped(y, x);
+      isClamped = 0.0f;
+
+      for(std::size_t channel = 0; channel < 3; ++channel)
+      {
+        const float value = color(channel);
+
+        // https://www.desmos.com/calculator/vpvzmidy1a
+        //                       ____
+        // sigmoid inv:  _______/
+        //                  0    1
+        const float isChannelClamped = sigmoidInv(0.0f, 1.0f, /*sigWidth=*/0.08f,  /*sigMid=*/0.95f, value);
+        isClamped += isChannelClamped;
+      }
+      isPixelClamped(y, x) /= 3.0;
+    }
+  }
+}
+
+/**
+ * @brief Apply the highlight correction on radiance rows.
+ * @param[in] isPixelClamped_g The blurred clamping mask, starting at row maskRowOffset
+ * @param[in] maskRowOffset The mask row of the first radiance row
+ * @param[in] width The image width
+ * @param[in] height The number of radiance rows
+ * @param[in] highlightCorrectionFactor The highlight correction factor
+ * @param[in] highlightTarget The highlight target radiance
+ * @param[in,out] radiance The radiance rows
+ */
+void applyHighlightCorrection(const image::Image<float>& isPixelClamped_g,
+                              int maskRowOffset,
+                              int width,
+                              int height,
+                              float highlightCorrectionFactor,
+                              float highlightTarget,
+                              image::RGBfColor* radiance)
+{
+  #pragma omp parallel for
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      image::RGBfColor& radianceColor = radiance[std::size_t(y) * width + x];
+
+      double clampingCompensation = highlightCorrectionFactor * isPixelClamped_g(y + maskRowOffset, x);
+      double clampingCompensationInv = (1.0 - clampingCompensation);
+      assert(clampingCompensation <= 1.0);
+
+      for(std::size_t channel = 0; channel < 3; ++channel)
+      {
+        if(highlightTarget > radianceColor(channel))
+        {
+          radianceColor(channel) = float(clampingCompensation * highlightTarget + clampingCompensationInv * radianceColor(channel));
+        }
+      }
+    }
+  }
+}
+
+/// number of rows around a strip needed by the highlight correction blur
+const int highlightBlurRadius = 1;
+
+void blurClampedMask(const image::Image<float>& isPixelClamped, image::Image<float>& isPixelClamped_g)
+{
+  image::ImageGaussianFilter(isPixelClamped, 1.0f, isPixelClamped_g, 2 * highlightBlurRadius + 1, 2 * highlightBlurRadius + 1);
+}
+
+} // namespace
+
 void hdrMerge::process(const std::vector< image::Image<image::RGBfColor> > &images,
                         const std::vector<float> &times,
                         const rgbCurve &weight,
@@ -58,8 +257,8 @@ void hdrMerge::process(const std::vector< image::Image<image::RGBfColor> > &imag
   const std::size_t width = images.front().Width();
   const std::size_t height = images.front().Height();
 
-  // resize and reset radiance image to 0.0
-  radiance.resize(width, height, true, image::RGBfColor(0.f, 0.f, 0.f));
+  // resize radiance image
+  radiance.resize(width, height, false);
 
   ALICEVISION_LOG_TRACE("[hdrMerge] Images to fuse:");
   for(int i = 0; i < images.size(); ++i)
@@ -67,78 +266,20 @@ void hdrMerge::process(const std::vector< image::Image<image::RGBfColor> > &imag
     ALICEVISION_LOG_TRACE(images[i].Width() << "x" << images[i].Height() << ", time: " << times[i]);
   }
 
-  rgbCurve weightShortestExposure = weight;
-  weightShortestExposure.freezeSecondPartValues();
-  rgbCurve weightLongestExposure = weight;
-  weightLongestExposure.freezeFirstPartValues();
+  const MergeCurves curves(times, weight, response);
 
-  #pragma omp parallel for
-  for(int y = 0; y < height; ++y)
+  #pragma omp parallel
   {
-    for(int x = 0; x < width; ++x)
-    {
-      //for each pixels
-      image::RGBfColor &radianceColor = radiance(y, x);
+    std::vector<const image::RGBfColor*> rows(images.size());
+    std::vector<double> wsum(3 * width);
+    std::vector<double> wdiv(3 * width);
 
-      for(std::size_t channel = 0; channel < 3; ++channel)
-      {
-        double wsum = 0.0;
-        double wdiv = 0.0;
-
-        // Merge shortest exposure
-        {
-            int exposureIndex = 0;
-
-            // for each image
-            const double value = images[exposureIndex](y, x)(channel);
-            const double time = times[exposureIndex];
-            //
-            // weightShortestExposure:          _______
-            //                          _______/
-            //                                0      1
-            double w = std::max(0.001f, weightShortestExposure(value, channel));
-
-            const double r = response(value, channel);
-
-            wsum += w * r / time;
-            wdiv += w;
-        }
-        // Merge intermediate exposures
-        for(std::size_t i = 1; i < images.size() - 1; ++i)
-        {
-          // for each image
-          const double value = images[i](y, x)(channel);
-          const double time = times[i];
-          //
-          // weight:          ____
-          //          _______/    \________
-          //                0      1
-          double w = std::max(0.001f, weight(value, channel));
-
-          const double r = response(value, channel);
-          wsum += w * r / time;
-          wdiv += w;
-        }
-        // Merge longest exposure
-        {
-            int exposureIndex = images.size() - 1;
-
-            // for each image
-            const double value = images[exposureIndex](y, x)(channel);
-            const double time = times[exposureIndex];
-            //
-            // weightLongestExposure:  ____________
-            //                                      \_______
-            //                                0      1
-            double w = std::max(0.001f, weightLongestExposure(value, channel));
-
-            const double r = response(value, channel);
-
-            wsum += w * r / time;
-            wdiv += w;
-        }
-        radianceColor(channel) = wsum / std::max(0.001, wdiv) * targetCameraExposure;
-      }
+    #pragma omp for
+    for(int y = 0; y < height; ++y)
+    {
+      for(std::size_t i = 0; i < images.size(); ++i)
+        rows[i] = &images[i](y, 0);
+      mergeRow(rows, curves, width, targetCameraExposure, wsum, wdiv, &radiance(y, 0));
     }
   }
 }
@@ -157,7 +298,7 @@ void hdrMerge::postProcessHighlight(const std::vector< image::Image<image::RGBfC
     assert(!images.empty());
     assert(images.size() == times.size());
 
-    if (highlightCorrectionFactor == 0.0f)
+    if(!isHighlightCorrectionEnabled(highlightCorrectionFactor))
         return;
 
     const image::Image<image::RGBfColor>& inputImage = images.front();
@@ -168,57 +309,112 @@ void hdrMerge::postProcessHighlight(const std::vector< image::Image<image::RGBfC
     const std::size_t width = inputImage.Width();
     const std::size_t height = inputImage.Height();
 
-    image::Image<float> isPixelClamped(width, height);
+    image::Image<float> isPixelClamped;
+    computeClampedMask(inputImage.data(), width, height, isPixelClamped);
+
+    image::Image<float> isPixelClamped_g;
+    blurClampedMask(isPixelClamped, isPixelClamped_g);
 
-#pragma omp parallel for
-    for (int y = 0; y < height; ++y)
+    applyHighlightCorrection(isPixelClamped_g, 0, width, height, highlightCorrectionFactor, highlightTarget, radiance.data());
+}
+
+void hdrMerge::processStreaming(const std::vector<std::string> &imagePaths,
+                                const std::vector<float> &times,
+                                const rgbCurve &weight,
+                                const rgbCurve &response,
+                                const std::string &radiancePath,
+                                const oiio::ParamValueList &metadata,
+                                float targetCameraExposure,
+                                float highlightCorrectionFactor,
+                                float highlightTargetLux,
+                                int stripHeight)
+{
+  //checks
+  assert(!response.isEmpty());
+  assert(!imagePaths.empty());
+  assert(imagePaths.size() == times.size());
+  assert(stripHeight > 0);
+
+  std::vector<std::unique_ptr<image::ImageStripReader>> readers;
+  for(const std::string& imagePath : imagePaths)
+    readers.emplace_back(new image::ImageStripReader(imagePath, image::EImageColorSpace::SRGB));
+
+  const int width = readers.front()->width();
+  const int height = readers.front()->height();
+  for(std::size_t i = 1; i < readers.size(); ++i)
+  {
+    if(readers[i]->width() != width || readers[i]->height() != height)
+      throw std::runtime_error("[hdrMerge] Image '" + imagePaths[i] + "' does not have the same size as '" + imagePaths.front() + "'.");
+  }
+
+  ALICEVISION_LOG_TRACE("[hdrMerge] Stream " << imagePaths.size() << " images of " << width << "x" << height << " by strips of " << stripHeight << " rows.");
+
+  const MergeCurves curves(times, weight, response);
+
+  // the highlight correction blurs a mask, so a strip needs its neighbor rows
+  const bool highlightCorrection = isHighlightCorrectionEnabled(highlightCorrectionFactor);
+  const int margin = highlightCorrection ? highlightBlurRadius : 0;
+  // Target Camera Exposure = 1 for EV-0 (iso=100, shutter=1, fnumber=1) => 2.5 lux
+  const float highlightTarget = highlightTargetLux * targetCameraExposure * 2.5;
+
+  // rows [loadedBegin, loadedEnd) of each image, stored from the first row of its buffer
+  std::vector<image::Image<image::RGBfColor>> strips(readers.size(), image::Image<image::RGBfColor>(width, stripHeight + 2 * margin));
+  int loadedBegin = 0;
+  int loadedEnd = 0;
+
+  image::Image<image::RGBfColor> radiance(width, stripHeight);
+  image::Image<float> isPixelClamped;
+  image::Image<float> isPixelClamped_g;
+
+  image::ImageStripWriter writer(radiancePath, width, height, image::EImageColorSpace::AUTO, metadata);
+
+  for(int yBegin = 0; yBegin < height; yBegin += stripHeight)
+  {
+    const int yEnd = std::min(height, yBegin + stripHeight);
+    const int neededBegin = std::max(0, yBegin - margin);
+    const int neededEnd = std::min(height, yEnd + margin);
+
+    // keep the rows already loaded and still needed, then read the next ones
+    const int nbKeptRows = std::max(0, loadedEnd - neededBegin);
+
+    #pragma omp parallel for
+    for(int i = 0; i < static_cast<int>(readers.size()); ++i)
     {
-        for (int x = 0; x < width; ++x)
-        {
-            //for each pixels
-            image::RGBfColor &radianceColor = radiance(y, x);
-
-            float& isClamped = isPixelClamped(y, x);
-            isClamped = 0.0f;
-
-            for (std::size_t channel = 0; channel < 3; ++channel)
-            {
-                const float value = inputImage(y, x)(channel);
-
-                // https://www.desmos.com/calculator/vpvzmidy1a
-                //                       ____
-                // sigmoid inv:  _______/
-                //                  0    1
-                const float isChannelClamped = sigmoidInv(0.0f, 1.0f, /*sigWidth=*/0.08f,  /*sigMid=*/0.95f, value);
-                isClamped += isChannelClamped;
-            }
-            isPixelClamped(y, x) /= 3.0;
-        }
+      image::RGBfColor* strip = strips[i].data();
+      if(nbKeptRows > 0)
+        std::memmove(strip, strip + std::size_t(neededBegin - loadedBegin) * width, sizeof(image::RGBfColor) * std::size_t(nbKeptRows) * width);
+      readers[i]->read(neededBegin + nbKeptRows, neededEnd, strip + std::size_t(nbKeptRows) * width);
     }
+    loadedBegin = neededBegin;
+    loadedEnd = neededEnd;
 
-    image::Image<float> isPixelClamped_g(width, height);
-    image::ImageGaussianFilter(isPixelClamped, 1.0f, isPixelClamped_g, 3, 3);
+    // merge the rows of the strip
+    #pragma omp parallel
+    {
+      std::vector<const image::RGBfColor*> rows(strips.size());
+      std::vector<double> wsum(3 * width);
+      std::vector<double> wdiv(3 * width);
 
-#pragma omp parallel for
-    for (int y = 0; y < height; ++y)
+      #pragma omp for
+      for(int y = yBegin; y < yEnd; ++y)
+      {
+        for(std::size_t i = 0; i < strips.size(); ++i)
+          rows[i] = &strips[i](y - loadedBegin, 0);
+        mergeRow(rows, curves, width, targetCameraExposure, wsum, wdiv, &radiance(y - yBegin, 0));
+      }
+    }
+
+    if(highlightCorrection)
     {
-        for (int x = 0; x < width; ++x)
-        {
-            image::RGBfColor& radianceColor = radiance(y, x);
-
-            double clampingCompensation = highlightCorrectionFactor * isPixelClamped_g(y, x);
-            double clampingCompensationInv = (1.0 - clampingCompensation);
-            assert(clampingCompensation <= 1.0);
-
-            for (std::size_t channel = 0; channel < 3; ++channel)
-            {
-                if(highlightTarget > radianceColor(channel))
-                {
-                    radianceColor(channel) = float(clampingCompensation * highlightTarget + clampingCompensationInv * radianceColor(channel));
-                }
-            }
-        }
+      computeClampedMask(strips.front().data(), width, loadedEnd - loadedBegin, isPixelClamped);
+      blurClampedMask(isPixelClamped, isPixelClamped_g);
+      applyHighlightCorrection(isPixelClamped_g, yBegin - loadedBegin, width, yEnd - yBegin, highlightCorrectionFactor, highlightTarget, radiance.data());
     }
+
+    writer.write(radiance.data(), yEnd - yBegin);
+  }
+
+  writer.close();
 }
 
 } // namespace hdr
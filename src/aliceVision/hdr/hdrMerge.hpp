@@ -8,6 +8,8 @@
 #include "rgbCurve.hpp"
 #include <aliceVision/image/all.hpp>
 #include <cmath>
+#include <string>
+#include <vector>
 
 
 namespace aliceVision {
@@ -31,14 +33,51 @@ public:
                 image::Image<image::RGBfColor> &radiance,
                 float targetCameraExposure);
 
+  /**
+   * @brief Is the highlight correction applied for the given factor.
+   * Shared by the in-memory and the streaming merge, so that they give the same result
+   * for any factor (the correction is disabled for 0, negative or NaN factors).
+   * @param[in] highlightCorrectionFactor The highlight correction factor
+   */
+  static bool isHighlightCorrectionEnabled(float highlightCorrectionFactor)
+  {
+    return highlightCorrectionFactor > 0.0f;
+  }
+
   void postProcessHighlight(const std::vector< image::Image<image::RGBfColor> > &images,
       const std::vector<float> &times,
       const rgbCurve &weight,
       const rgbCurve &response,
       image::Image<image::RGBfColor> &radiance,
-      float clampedValueCorrection,
       float targetCameraExposure,
-      float highlightMaxLumimance);
+      float highlightCorrectionFactor,
+      float highlightTargetLux);
+
+  /**
+   * @brief Merge LDR image files into an HDR image file strip by strip, so that the memory
+   * does not depend on the image height. The result is the same as process() followed by
+   * postProcessHighlight() on the images read with image::readImage.
+   * @param[in] imagePaths The LDR images, from the shortest to the longest exposure
+   * @param[in] times The exposure of each image
+   * @param[in] weight The fusion weight curve
+   * @param[in] response The camera response curve
+   * @param[in] radiancePath The output HDR image file
+   * @param[in] metadata The output HDR image metadata
+   * @param[in] targetCameraExposure The exposure of the output image
+   * @param[in] highlightCorrectionFactor The highlight correction factor (see isHighlightCorrectionEnabled)
+   * @param[in] highlightTargetLux The highlights maximum luminance
+   * @param[in] stripHeight The number of rows merged at once
+   */
+  void processStreaming(const std::vector<std::string> &imagePaths,
+                        const std::vector<float> &times,
+                        const rgbCurve &weight,
+                        const rgbCurve &response,
+                        const std::string &radiancePath,
+                        const oiio::ParamValueList &metadata,
+                        float targetCameraExposure,
+                        float highlightCorrectionFactor,
+                        float highlightTargetLux,
+                        int stripHeight = 256);
 
 };
 
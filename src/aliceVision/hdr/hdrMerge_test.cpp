@@ -0,0 +1,162 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#define BOOST_TEST_MODULE hdrMerge
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <aliceVision/image/all.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include "hdrMerge.hpp"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace aliceVision;
+namespace fs = boost::filesystem;
+
+namespace {
+
+const int width = 640;
+const int height = 421;
+const std::vector<float> times = {0.01f, 0.04f, 0.16f};
+
+/// write brackets with random values, some of them clamped
+std::vector<std::string> writeBrackets(const fs::path& folder, const oiio::ParamValueList& metadata)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(0.0f, 1.2f);
+
+  std::vector<std::string> paths;
+  for(std::size_t i = 0; i < times.size(); ++i)
+  {
+    image::Image<image::RGBfColor> bracket(width, height);
+    for(int y = 0; y < height; ++y)
+      for(int x = 0; x < width; ++x)
+        for(int c = 0; c < 3; ++c)
+          bracket(y, x)(c) = std::min(1.0f, distribution(generator) * (i + 1) / times.size());
+
+    paths.push_back((folder / ("bracket_" + std::to_string(i) + ".exr")).string());
+    image::writeImage(paths.back(), bracket, image::EImageColorSpace::NO_CONVERSION, metadata);
+  }
+  return paths;
+}
+
+/// maximum relative difference between two images
+double maxRelativeError(const image::Image<image::RGBfColor>& image, const image::Image<image::RGBfColor>& reference)
+{
+  double maxError = 0.0;
+  for(int y = 0; y < reference.Height(); ++y)
+    for(int x = 0; x < reference.Width(); ++x)
+      for(int c = 0; c < 3; ++c)
+        maxError = std::max(maxError, std::abs(double(image(y, x)(c)) - reference(y, x)(c)) / std::max(1.0, std::abs(double(reference(y, x)(c)))));
+  return maxError;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(hdrMerge_streaming)
+{
+  const fs::path tmpFolder = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directory(tmpFolder);
+
+  oiio::ParamValueList metadata;
+  metadata.push_back(oiio::ParamValue("AliceVision:storageDataType", image::EStorageDataType_enumToString(image::EStorageDataType::Float)));
+
+  const std::vector<std::string> paths = writeBrackets(tmpFolder, metadata);
+
+  hdr::rgbCurve weight(1024);
+  weight.setFunction(hdr::EFunctionType::GAUSSIAN);
+  hdr::rgbCurve response(1024);
+  response.setFunction(hdr::EFunctionType::LINEAR);
+
+  const float targetCameraExposure = 0.04f;
+  const float highlightCorrectionFactor = 1.0f;
+  const float highlightTargetLux = 120000.0f;
+
+  // reference: in-memory merge
+  std::vector<image::Image<image::RGBfColor>> images(paths.size());
+  for(std::size_t i = 0; i < paths.size(); ++i)
+    image::readImage(paths[i], images[i], image::EImageColorSpace::SRGB);
+
+  hdr::hdrMerge merge;
+  image::Image<image::RGBfColor> reference;
+  merge.process(images, times, weight, response, reference, targetCameraExposure);
+  merge.postProcessHighlight(images, times, weight, response, reference, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux);
+
+  // streaming merge, with strips not dividing the image height
+  for(int stripHeight : {1, 64, height})
+  {
+    const std::string hdrPath = (tmpFolder / ("hdr_" + std::to_string(stripHeight) + ".exr")).string();
+
+    system::Timer timer;
+    merge.processStreaming(paths, times, weight, response, hdrPath, metadata, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux, stripHeight);
+    const double elapsed = timer.elapsed();
+    ALICEVISION_LOG_INFO("Streaming merge by strips of " << stripHeight << " rows: "
+                         << (width * height * times.size()) / (1e6 * elapsed) << " input Mpixels/s");
+
+    image::Image<image::RGBfColor> radiance;
+    image::readImage(hdrPath, radiance, image::EImageColorSpace::NO_CONVERSION);
+
+    BOOST_REQUIRE_EQUAL(radiance.Width(), width);
+    BOOST_REQUIRE_EQUAL(radiance.Height(), height);
+    BOOST_CHECK_SMALL(maxRelativeError(radiance, reference), 1e-5);
+  }
+
+  fs::remove_all(tmpFolder);
+}
+
+BOOST_AUTO_TEST_CASE(hdrMerge_streamingHighlightCorrectionFactors)
+{
+  const fs::path tmpFolder = fs::temp_directory_path() / fs::unique_path();
+  fs::create_directory(tmpFolder);
+
+  oiio::ParamValueList metadata;
+  metadata.push_back(oiio::ParamValue("AliceVision:storageDataType", image::EStorageDataType_enumToString(image::EStorageDataType::Float)));
+
+  const std::vector<std::string> paths = writeBrackets(tmpFolder, metadata);
+
+  hdr::rgbCurve weight(1024);
+  weight.setFunction(hdr::EFunctionType::GAUSSIAN);
+  hdr::rgbCurve response(1024);
+  response.setFunction(hdr::EFunctionType::LINEAR);
+
+  const float targetCameraExposure = 0.04f;
+  const float highlightTargetLux = 120000.0f;
+
+  std::vector<image::Image<image::RGBfColor>> images(paths.size());
+  for(std::size_t i = 0; i < paths.size(); ++i)
+    image::readImage(paths[i], images[i], image::EImageColorSpace::SRGB);
+
+  hdr::hdrMerge merge;
+  image::Image<image::RGBfColor> merged;
+  merge.process(images, times, weight, response, merged, targetCameraExposure);
+
+  // the disabled (0, negative, NaN) and partial factors give the same result in both paths
+  for(float highlightCorrectionFactor : {0.0f, -0.5f, std::numeric_limits<float>::quiet_NaN(), 0.5f})
+  {
+    image::Image<image::RGBfColor> reference = merged;
+    merge.postProcessHighlight(images, times, weight, response, reference, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux);
+
+    const std::string hdrPath = (tmpFolder / "hdr.exr").string();
+    merge.processStreaming(paths, times, weight, response, hdrPath, metadata, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux, 64);
+
+    image::Image<image::RGBfColor> radiance;
+    image::readImage(hdrPath, radiance, image::EImageColorSpace::NO_CONVERSION);
+
+    BOOST_REQUIRE_EQUAL(radiance.Width(), width);
+    BOOST_REQUIRE_EQUAL(radiance.Height(), height);
+    BOOST_CHECK_SMALL(maxRelativeError(radiance, reference), 1e-5);
+
+    // the correction is only applied for a positive factor
+    BOOST_CHECK_EQUAL(maxRelativeError(reference, merged) > 0.0, hdr::hdrMerge::isHighlightCorrectionEnabled(highlightCorrectionFactor));
+  }
+
+  fs::remove_all(tmpFolder);
+}
@@ -17,6 +17,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 #include <iostream>
@@ -471,6 +472,208 @@ void writeImage(const std::string& path,
   fs::rename(tmpPath, path);
 }
 
+ImageStripReader::ImageStripReader(const std::string& path, EImageColorSpace imageColorSpace)
+  : _path(path)
+{
+  oiio::ImageSpec configSpec;
+
+  // libRAW configuration, same as readImage
+  configSpec.attribute("raw:auto_bright", 0);
+  configSpec.attribute("raw:use_camera_wb", 1);
+  configSpec.attribute("raw:use_camera_matrix", 3);
+#if OIIO_VERSION <= (10000 * 2 + 100 * 0 + 8) // OIIO_VERSION <= 2.0.8
+  configSpec.attribute("raw:ColorSpace", "sRGB");
+#else
+  configSpec.attribute("raw:ColorSpace", "Linear");
+#endif
+
+  std::unique_ptr<oiio::ImageInput> input(oiio::ImageInput::open(path, &configSpec));
+  _input = std::move(input);
+  if(!_input)
+    throw std::runtime_error("Cannot find/open image file '" + path + "'.");
+
+  const oiio::ImageSpec& inSpec = _input->spec();
+
+  // check picture channels number
+  if(inSpec.nchannels != 1 && inSpec.nchannels < 3)
+    throw std::runtime_error("Can't load channels of image file '" + path + "'.");
+
+  if(imageColorSpace == EImageColorSpace::AUTO)
+    throw std::runtime_error("You must specify a requested color space for image file '" + path + "'.");
+
+  _width = inSpec.width;
+  _height = inSpec.height;
+  _nchannels = std::min(inSpec.nchannels, 3);
+
+  _colorSpace = inSpec.get_string_attribute("oiio:ColorSpace", "sRGB"); // default image color space is sRGB
+#if OIIO_VERSION <= (10000 * 2 + 100 * 0 + 8) // OIIO_VERSION <= 2.0.8
+  // Workaround for bug in RAW colorspace management in previous versions of OIIO (see readImage)
+  if(_colorSpace == "sRGB" && std::string(_input->format_name()) == "raw")
+    _colorSpace = "Linear";
+#endif
+
+  if(imageColorSpace == EImageColorSpace::SRGB)
+    _targetColorSpace = "sRGB";
+  else if(imageColorSpace == EImageColorSpace::LINEAR)
+    _targetColorSpace = "Linear";
+
+  if(_targetColorSpace == _colorSpace)
+    _targetColorSpace.clear();
+}
+
+ImageStripReader::~ImageStripReader()
+{
+  if(_input)
+    _input->close();
+}
+
+void ImageStripReader::read(int yBegin, int yEnd, RGBfColor* data)
+{
+  assert(yBegin >= 0 && yBegin <= yEnd && yEnd <= _height);
+  const int nbRows = yEnd - yBegin;
+  if(nbRows == 0)
+    return;
+
+  const oiio::ImageSpec& inSpec = _input->spec();
+  float* rgb = reinterpret_cast<float*>(data);
+
+  if(_nchannels == 3)
+  {
+    // read the first 3 channels directly in the output buffer
+    if(!_input->read_scanlines(inSpec.y + yBegin, inSpec.y + yEnd, inSpec.z, 0, 3, oiio::TypeDesc::FLOAT, rgb))
+      throw std::runtime_error("Can't read rows [" + std::to_string(yBegin) + ", " + std::to_string(yEnd) + ") of image file '" + _path + "'.");
+  }
+  else
+  {
+    // duplicate the single channel for RGB
+    _buffer.resize(static_cast<std::size_t>(_width) * nbRows);
+    if(!_input->read_scanlines(inSpec.y + yBegin, inSpec.y + yEnd, inSpec.z, 0, 1, oiio::TypeDesc::FLOAT, _buffer.data()))
+      throw std::runtime_error("Can't read rows [" + std::to_string(yBegin) + ", " + std::to_string(yEnd) + ") of image file '" + _path + "'.");
+
+    for(std::size_t i = 0; i < _buffer.size(); ++i)
+      data[i] = RGBfColor(_buffer[i]);
+  }
+
+  // color conversion (pixel-wise, so it gives the same result on a strip as on the whole image)
+  if(!_targetColorSpace.empty())
+  {
+    oiio::ImageBuf stripBuf(oiio::ImageSpec(_width, nbRows, 3, oiio::TypeDesc::FLOAT), rgb);
+    oiio::ImageBufAlgo::colorconvert(stripBuf, stripBuf, _colorSpace, _targetColorSpace);
+  }
+}
+
+ImageStripWriter::ImageStripWriter(const std::string& path,
+                                   int width,
+                                   int height,
+                                   EImageColorSpace imageColorSpace,
+                                   const oiio::ParamValueList& metadata)
+  : _path(path)
+  , _width(width)
+  , _height(height)
+{
+  const fs::path bPath = fs::path(path);
+  const std::string extension = boost::to_lower_copy(bPath.extension().string());
+  _tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + extension;
+  const bool isEXR = (extension == ".exr");
+  const bool isJPG = (extension == ".jpg");
+  const bool isPNG = (extension == ".png");
+
+  if(imageColorSpace == EImageColorSpace::AUTO)
+    imageColorSpace = (isJPG || isPNG) ? EImageColorSpace::SRGB : EImageColorSpace::LINEAR;
+  _convertToSRGB = (imageColorSpace == EImageColorSpace::SRGB);
+
+  oiio::TypeDesc typeDesc = oiio::TypeDesc::FLOAT;
+  oiio::ImageSpec imageSpec(width, height, 3, typeDesc);
+  imageSpec.extra_attribs = metadata; // add custom metadata
+
+  imageSpec.attribute("jpeg:subsampling", "4:4:4");           // if possible, always subsampling 4:4:4 for jpeg
+  imageSpec.attribute("CompressionQuality", 100);             // if possible, best compression quality
+  imageSpec.attribute("compression", isEXR ? "piz" : "none"); // if possible, set compression (piz for EXR, none for the other)
+
+  if(isEXR)
+  {
+    const std::string storageDataTypeStr = imageSpec.get_string_attribute("AliceVision:storageDataType", EStorageDataType_enumToString(EStorageDataType::HalfFinite));
+    const EStorageDataType storageDataType = EStorageDataType_stringToEnum(storageDataTypeStr);
+
+    // Auto would need the whole image to detect half float overflows, use float
+    if(storageDataType == EStorageDataType::Half || storageDataType == EStorageDataType::HalfFinite)
+      imageSpec.set_format(oiio::TypeDesc::HALF);
+    _clampHalf = (storageDataType == EStorageDataType::HalfFinite);
+  }
+
+  std::unique_ptr<oiio::ImageOutput> output(oiio::ImageOutput::create(_tmpPath));
+  _output = std::move(output);
+  if(!_output)
+    throw std::runtime_error("Can't create output image file '" + path + "'.");
+
+  if(!_output->open(_tmpPath, imageSpec))
+    throw std::runtime_error("Can't open output image file '" + path + "'.");
+}
+
+ImageStripWriter::~ImageStripWriter()
+{
+  if(_output)
+  {
+    _output->close();
+    _output.reset();
+    boost::system::error_code ec;
+    fs::remove(_tmpPath, ec);
+  }
+}
+
+void ImageStripWriter::write(const RGBfColor* data, int nbRows)
+{
+  assert(_output);
+  assert(_nextRow + nbRows <= _height);
+  if(nbRows == 0)
+    return;
+
+  const std::size_t nbValues = static_cast<std::size_t>(_width) * nbRows * 3;
+  const float* rgb = reinterpret_cast<const float*>(data);
+
+  if(_convertToSRGB || _clampHalf)
+  {
+    _buffer.assign(rgb, rgb + nbValues);
+    if(_convertToSRGB)
+    {
+      oiio::ImageBuf stripBuf(oiio::ImageSpec(_width, nbRows, 3, oiio::TypeDesc::FLOAT), _buffer.data());
+      oiio::ImageBufAlgo::colorconvert(stripBuf, stripBuf, "Linear", "sRGB");
+    }
+    if(_clampHalf)
+    {
+      for(float& value : _buffer)
+        value = std::max(-HALF_MAX, std::min(HALF_MAX, value));
+    }
+    rgb = _buffer.data();
+  }
+
+  const oiio::ImageSpec& spec = _output->spec();
+  if(!_output->write_scanlines(spec.y + _nextRow, spec.y + _nextRow + nbRows, spec.z, oiio::TypeDesc::FLOAT, rgb))
+    throw std::runtime_error("Can't write output image file '" + _path + "'.");
+
+  _nextRow += nbRows;
+}
+
+void ImageStripWriter::close()
+{
+  assert(_output);
+  if(_nextRow != _height)
+    throw std::runtime_error("Incomplete output image file '" + _path + "'.");
+
+  const bool closed = _output->close();
+  _output.reset();
+
+  if(!closed)
+  {
+    boost::system::error_code ec;
+    fs::remove(_tmpPath, ec);
+    throw std::runtime_error("Can't write output image file '" + _path + "'.");
+  }
+
+  // rename temporay filename
+  fs::rename(_tmpPath, _path);
+}
+
 void readImage(const std::string& path, Image<float>& image, EImageColorSpace imageColorSpace)
 {
   readImage(path, oiio::TypeDesc::FLOAT, 1, image, imageColorSpace);
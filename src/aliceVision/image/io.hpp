@@ -13,6 +13,7 @@
 #include <OpenImageIO/paramlist.h>
 #include <OpenImageIO/imagebuf.h>
 
+#include <memory>
 #include <string>
 
 namespace oiio = OIIO;
@@ -180,5 +181,92 @@ void writeImage(const std::string& path, const Image<RGBAColor>& image, EImageCo
 void writeImage(const std::string& path, const Image<RGBfColor>& image, EImageColorSpace imageColorSpace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 void writeImage(const std::string& path, const Image<RGBColor>& image, EImageColorSpace imageColorSpace, const oiio::ParamValueList& metadata = oiio::ParamValueList());
 
+/**
+ * @brief Read an RGB image strip by strip, to process large images with a bounded memory.
+ *
+ * The pixels are converted in the same way as readImage does for an Image<RGBfColor>.
+ * Scanline and tiled formats are read incrementally, the rows must be read from top to bottom.
+ * Formats without partial access (like RAW files) are decoded by OpenImageIO when opened.
+ */
+class ImageStripReader
+{
+public:
+  /**
+   * @param[in] path The given path to the image
+   * @param[in] imageColorSpace The color space of the read pixels
+   */
+  ImageStripReader(const std::string& path, EImageColorSpace imageColorSpace);
+  ~ImageStripReader();
+
+  int width() const { return _width; }
+  int height() const { return _height; }
+
+  /**
+   * @brief Read the rows [yBegin, yEnd) of the image.
+   * @param[in] yBegin The first row to read
+   * @param[in] yEnd The row after the last row to read
+   * @param[out] data The output buffer of width * (yEnd - yBegin) pixels
+   */
+  void read(int yBegin, int yEnd, RGBfColor* data);
+
+private:
+  std::string _path;
+  std::unique_ptr<oiio::ImageInput> _input;
+  int _width = 0;
+  int _height = 0;
+  int _nchannels = 0;
+  std::string _colorSpace;
+  std::string _targetColorSpace;
+  std::vector<float> _buffer;
+};
+
+/**
+ * @brief Write an RGB image strip by strip, to produce large images with a bounded memory.
+ *
+ * The image is written in a temporary file which is renamed on close(), as writeImage does.
+ * As the whole image is not known in advance, the Auto storage data type of EXR files is
+ * stored in float.
+ */
+class ImageStripWriter
+{
+public:
+  /**
+   * @param[in] path The given path to the image
+   * @param[in] width The image width
+   * @param[in] height The image height
+   * @param[in] imageColorSpace The color space of the written file, the pixels are linear
+   * @param[in] metadata The image metadata
+   */
+  ImageStripWriter(const std::string& path,
+                   int width,
+                   int height,
+                   EImageColorSpace imageColorSpace,
+                   const oiio::ParamValueList& metadata = oiio::ParamValueList());
+
+  /// remove the temporary file if the image has not been closed
+  ~ImageStripWriter();
+
+  /**
+   * @brief Write the next rows of the image.
+   * @param[in] data The buffer of width * nbRows pixels
+   * @param[in] nbRows The number of rows to write
+   */
+  void write(const RGBfColor* data, int nbRows);
+
+  /// finish the image, all the rows must have been written
+  void close();
+
+private:
+  std::string _path;
+  std::string _tmpPath;
+  std::unique_ptr<oiio::ImageOutput> _output;
+  int _width = 0;
+  int _height = 0;
+  int _nextRow = 0;
+  bool _convertToSRGB = false;
+  bool _clampHalf = false;
+  std::vector<float> _buffer;
+};
+
 }  // namespace image
 }  // namespace aliceVision
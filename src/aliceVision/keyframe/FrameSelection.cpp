@@ -0,0 +1,174 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "FrameSelection.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace aliceVision {
+namespace keyframe {
+
+FrameSelection::FrameSelection(const FrameSelectionParams& params, std::size_t nbFrames)
+  : _params(params)
+  , _framesData(nbFrames)
+{}
+
+void FrameSelection::select(const std::function<std::vector<MediaData>(std::size_t)>& getMediasData,
+                            const std::function<void(std::size_t)>& releaseFramesBefore)
+{
+  const unsigned int frameStep = _params.maxFrameStep - _params.minFrameStep;
+
+  // iteration process
+  _keyframeIndexes.clear();
+  std::size_t currentFrameStep = _params.minFrameStep + 1; // start directly (dont skip minFrameStep first frames)
+
+  for(std::size_t frameIndex = 0; frameIndex < _framesData.size(); ++frameIndex)
+  {
+    ALICEVISION_LOG_INFO("frame : " << frameIndex);
+
+    // compute sharpness and sparse distance
+    if(evaluateFrame(frameIndex, getMediasData(frameIndex)))
+      ALICEVISION_LOG_INFO(" > selected" << std::endl);
+    else
+      ALICEVISION_LOG_INFO(" > skipped" << std::endl);
+
+    // selection process
+    if(currentFrameStep >= _params.maxFrameStep)
+    {
+      currentFrameStep = _params.minFrameStep;
+      bool hasKeyframe = false;
+      std::size_t keyframeIndex = 0;
+      float maxSharpness = 0;
+      float minDistScore = std::numeric_limits<float>::max();
+
+      // find the best selected frame
+      if(_params.hasSharpnessSelection)
+      {
+        // find the sharpest selected frame
+        for(std::size_t index = frameIndex - (frameStep - 1); index <= frameIndex; ++index)
+        {
+          if(_framesData[index].selected && (_framesData[index].avgSharpness > maxSharpness))
+          {
+            hasKeyframe = true;
+            keyframeIndex = index;
+            maxSharpness = _framesData[index].avgSharpness;
+          }
+        }
+      }
+      else if(_params.hasSparseDistanceSelection)
+      {
+        // find the smallest sparseDistance selected frame
+        for(std::size_t index = frameIndex - (frameStep - 1); index <= frameIndex; ++index)
+        {
+          if(_framesData[index].selected && (_framesData[index].maxDistScore < minDistScore))
+          {
+            hasKeyframe = true;
+            keyframeIndex = index;
+            minDistScore = _framesData[index].maxDistScore;
+          }
+        }
+      }
+      else
+      {
+        // use the first frame of the step
+        hasKeyframe = true;
+        keyframeIndex = frameIndex - (frameStep - 1);
+      }
+
+      // save keyframe
+      if(hasKeyframe)
+      {
+        ALICEVISION_LOG_INFO("keyframe choice : " << keyframeIndex << std::endl);
+
+        _framesData[keyframeIndex].keyframe = true;
+        _keyframeIndexes.push_back(keyframeIndex);
+
+        frameIndex = keyframeIndex + _params.minFrameStep - 1;
+      }
+      else
+      {
+        ALICEVISION_LOG_INFO("keyframe choice : none" << std::endl);
+      }
+
+      // the next evaluated frames are after the keyframe or after the current step
+      releaseFramesBefore(frameIndex + 1);
+    }
+    ++currentFrameStep;
+  }
+}
+
+bool FrameSelection::evaluateFrame(std::size_t frameIndex, std::vector<MediaData> mediasData)
+{
+  auto& currframeData = _framesData.at(frameIndex);
+
+  // a frame can be evaluated again after a keyframe choice
+  currframeData.avgSharpness = 0;
+  currframeData.maxDistScore = 0;
+  currframeData.selected = false;
+  currframeData.mediasData = std::move(mediasData);
+
+  bool frameSelected = true;
+
+  if(needsMediasData())
+  {
+    const bool noKeyframe = (_keyframeIndexes.empty());
+
+    for(std::size_t mediaIndex = 0; mediaIndex < currframeData.mediasData.size(); ++mediaIndex)
+    {
+      ALICEVISION_LOG_DEBUG("media : " << mediaIndex);
+      auto& currMediaData = currframeData.mediasData.at(mediaIndex);
+
+      if(_params.hasSharpnessSelection)
+      {
+        ALICEVISION_LOG_DEBUG( " - sharpness : " << currMediaData.sharpness);
+        if(!(currMediaData.sharpness > _params.sharpnessThreshold))
+        {
+          frameSelected = false; // a camera of a rig is not selected
+          break;
+        }
+      }
+
+      // compute sparseDistance
+      if(!noKeyframe && _params.hasSparseDistanceSelection)
+      {
+        unsigned int nbKeyframetoCompare = (_keyframeIndexes.size() < _params.nbKeyFrameDist)? _keyframeIndexes.size() : _params.nbKeyFrameDist;
+
+        for(std::size_t i = _keyframeIndexes.size() - nbKeyframetoCompare; i < _keyframeIndexes.size(); ++i)
+        {
+          for(auto& media : _framesData.at(_keyframeIndexes.at(i)).mediasData)
+          {
+            currMediaData.distScore = std::max(currMediaData.distScore, std::abs(voctree::sparseDistance(media.histogram, currMediaData.histogram, "strongCommonPoints")));
+          }
+        }
+        currframeData.maxDistScore = std::max(currframeData.maxDistScore, currMediaData.distScore);
+        ALICEVISION_LOG_DEBUG(" - distScore : " << currMediaData.distScore);
+      }
+
+      if(!noKeyframe && !(currMediaData.distScore < _params.distScoreMax))
+      {
+        frameSelected = false; // a camera of a rig is not selected
+        break;
+      }
+    }
+  }
+
+  if(frameSelected)
+  {
+    currframeData.selected = true;
+    if(_params.hasSharpnessSelection)
+      currframeData.computeAvgSharpness();
+  }
+  else
+  {
+    currframeData.mediasData.clear(); // remove unselected mediasData
+  }
+  return frameSelected;
+}
+
+} // namespace keyframe
+} // namespace aliceVision
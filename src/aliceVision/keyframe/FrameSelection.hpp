@@ -0,0 +1,321 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/voctree/VocabularyTree.hpp>
+#include <aliceVision/system/BoundedQueue.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aliceVision {
+namespace keyframe {
+
+/**
+ * @brief Process media informations at a specific frame
+ */
+struct MediaData
+{
+  /// sharpness score
+  float sharpness = 0;
+  /// maximum distance score with keyframe media histograms
+  float distScore = 0;
+  /// sparseHistogram
+  voctree::SparseHistogram histogram;
+};
+
+/**
+ * @brief Process frame (or set of frames) informations
+ */
+struct FrameData
+{
+  /// average sharpness score of all media
+  float avgSharpness = 0;
+  /// maximum voctree distance score of all media
+  float maxDistScore = 0;
+  /// frame (or set of frames) selected for evaluation
+  bool selected = false;
+  /// frame is a keyframe
+  bool keyframe = false;
+  /// medias process data
+  std::vector<MediaData> mediasData;
+
+  /**
+   * @brief Compute average sharpness score
+   */
+  void computeAvgSharpness()
+  {
+    for(const auto& media : mediasData)
+      avgSharpness += media.sharpness;
+    avgSharpness /= mediasData.size();
+  }
+};
+
+/**
+ * @brief Parameters of the keyframe selection rules
+ */
+struct FrameSelectionParams
+{
+  /// Minimum number of frame between two keyframes
+  unsigned int minFrameStep = 12;
+  /// Maximum number of frame for evaluation
+  unsigned int maxFrameStep = 36;
+  /// Number of previous keyframe distances in order to evaluate distance score
+  unsigned int nbKeyFrameDist = 10;
+  /// Sharpness threshold (image with higher sharpness will be selected)
+  float sharpnessThreshold = 15.0f;
+  /// Distance max score (image with smallest distance from the last keyframe will be selected)
+  float distScoreMax = 100.0f;
+  /// Use sharpness selection
+  bool hasSharpnessSelection = true;
+  /// Use sparseDistance selection
+  bool hasSparseDistanceSelection = true;
+};
+
+/**
+ * @brief Keyframe selection rules, applied on the frames in order.
+ * The medias data of a frame only depend on its images and can be computed ahead,
+ * the distance to the previous keyframes and the keyframe choice depend on the previous choices.
+ */
+class FrameSelection
+{
+public:
+  /**
+   * @param[in] params the selection rules parameters
+   * @param[in] nbFrames the number of frames of the medias
+   */
+  FrameSelection(const FrameSelectionParams& params, std::size_t nbFrames);
+
+  /**
+   * @brief True if the selection uses the sharpness or the sparse histogram of the medias
+   */
+  bool needsMediasData() const
+  {
+    return _params.hasSharpnessSelection || _params.hasSparseDistanceSelection;
+  }
+
+  /**
+   * @brief Select the keyframes, one frame after the other
+   * @param[in] getMediasData gives the medias data of a frame, it can wait for them to be computed
+   * @param[in] releaseFramesBefore tells that the frames before the given index will not be evaluated anymore
+   */
+  void select(const std::function<std::vector<MediaData>(std::size_t)>& getMediasData,
+              const std::function<void(std::size_t)>& releaseFramesBefore);
+
+  /// FrameData structure per frame
+  const std::vector<FrameData>& getFramesData() const { return _framesData; }
+  /// Keyframe indexes, in the order of their choice
+  const std::vector<std::size_t>& getKeyframeIndexes() const { return _keyframeIndexes; }
+
+private:
+  /**
+   * @brief Compute distance score with the previous keyframes and select a frame
+   * @param[in] frameIndex the frame index in the media sequence
+   * @param[in] mediasData the media data of all the medias at this frame
+   * @return true if the frame is selected
+   */
+  bool evaluateFrame(std::size_t frameIndex, std::vector<MediaData> mediasData);
+
+  const FrameSelectionParams _params;
+  /// FrameData structure per frame
+  std::vector<FrameData> _framesData;
+  /// Keyframe indexes container
+  std::vector<std::size_t> _keyframeIndexes;
+};
+
+/**
+ * @brief Select the keyframes while the medias data of the next frames are computed concurrently:
+ *  - a reader thread reads the image of each media of each frame, in frame order: read(frameIndex, mediaIndex, image),
+ *    the frames discarded by a keyframe choice are not read;
+ *  - nbWorkers threads compute the medias data: computeMediaData(image, mediaIndex, workerIndex, mediaData);
+ *  - the selection runs in frame order on the calling thread.
+ * The result only depends on the medias data of each frame, not on the number of workers.
+ * An exception thrown by any stage stops the selection, the first one is rethrown by this function.
+ */
+template<class ImageT, class ReadFunc, class ComputeFunc>
+void selectFramesConcurrently(FrameSelection& selection, std::size_t nbMedias, std::size_t nbWorkers,
+                              ReadFunc read, ComputeFunc computeMediaData)
+{
+  const std::size_t nbFrames = selection.getFramesData().size();
+
+  if(!selection.needsMediasData())
+  {
+    selection.select([&](std::size_t) { return std::vector<MediaData>(nbMedias); }, [](std::size_t) {});
+    return;
+  }
+
+  struct MediaImage
+  {
+    std::size_t frameIndex = 0;
+    std::size_t mediaIndex = 0;
+    ImageT image;
+  };
+
+  struct MediaResult
+  {
+    std::size_t frameIndex = 0;
+    std::size_t mediaIndex = 0;
+    MediaData data;
+  };
+
+  nbWorkers = std::max<std::size_t>(nbWorkers, 1);
+  const std::size_t queueSize = 2 * nbWorkers;
+
+  system::BoundedQueue<MediaImage> mediaImages(queueSize);
+  system::BoundedQueue<MediaResult> mediaResults(queueSize);
+
+  // first frame still needed by the selection, the reader skips the frames before it
+  std::atomic<std::size_t> firstNeededFrame(0);
+  std::atomic<std::size_t> nbActiveWorkers(nbWorkers);
+
+  std::mutex errorMutex;
+  std::exception_ptr error;
+
+  // stop all the stages and keep the first error
+  const auto stopOnError = [&](std::exception_ptr e)
+  {
+    {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if(!error)
+        error = e;
+    }
+    mediaImages.close();
+    mediaResults.close();
+  };
+
+  std::vector<std::thread> threads;
+
+  // decode stage
+  threads.emplace_back([&]()
+  {
+    try
+    {
+      std::size_t frameIndex = 0;
+      while(true)
+      {
+        // skip the frames discarded by the selection
+        frameIndex = std::max(frameIndex, firstNeededFrame.load());
+
+        if(frameIndex >= nbFrames)
+          break;
+
+        for(std::size_t mediaIndex = 0; mediaIndex < nbMedias; ++mediaIndex)
+        {
+          MediaImage mediaImage;
+          mediaImage.frameIndex = frameIndex;
+          mediaImage.mediaIndex = mediaIndex;
+          read(frameIndex, mediaIndex, mediaImage.image);
+
+          if(!mediaImages.push(std::move(mediaImage)))
+            return;
+        }
+        ++frameIndex;
+      }
+      mediaImages.close();
+    }
+    catch(...)
+    {
+      stopOnError(std::current_exception());
+    }
+  });
+
+  // medias data stage
+  for(std::size_t i = 0; i < nbWorkers; ++i)
+  {
+    threads.emplace_back([&, i]()
+    {
+      try
+      {
+        MediaImage mediaImage;
+        while(mediaImages.pop(mediaImage))
+        {
+          MediaResult mediaResult;
+          mediaResult.frameIndex = mediaImage.frameIndex;
+          mediaResult.mediaIndex = mediaImage.mediaIndex;
+          computeMediaData(mediaImage.image, mediaImage.mediaIndex, i, mediaResult.data);
+
+          if(!mediaResults.push(std::move(mediaResult)))
+            break;
+        }
+      }
+      catch(...)
+      {
+        stopOnError(std::current_exception());
+      }
+
+      // the last worker tells the selection that no more result will come
+      if(--nbActiveWorkers == 0)
+        mediaResults.close();
+    });
+  }
+
+  // selection stage
+  try
+  {
+    // medias data computed by the workers and not yet used by the selection
+    std::map<std::size_t, std::vector<MediaData>> computedFrames;
+    std::map<std::size_t, std::size_t> nbComputedMedias;
+
+    // wait until all the medias of the given frame have been computed
+    const auto getMediasData = [&](std::size_t frameIndex)
+    {
+      while(nbComputedMedias[frameIndex] < nbMedias)
+      {
+        MediaResult mediaResult;
+        if(!mediaResults.pop(mediaResult))
+          throw std::runtime_error("Keyframe selection stopped before frame " + std::to_string(frameIndex));
+
+        // frame decoded ahead and then discarded by a keyframe choice
+        if(mediaResult.frameIndex < firstNeededFrame.load())
+          continue;
+
+        std::vector<MediaData>& resultMediasData = computedFrames[mediaResult.frameIndex];
+        resultMediasData.resize(nbMedias);
+        resultMediasData.at(mediaResult.mediaIndex) = std::move(mediaResult.data);
+        ++nbComputedMedias[mediaResult.frameIndex];
+      }
+      // a frame can be evaluated again after a keyframe choice, its data are kept until released
+      return computedFrames.at(frameIndex);
+    };
+
+    // release the data of the frames that will not be evaluated anymore
+    const auto releaseFramesBefore = [&](std::size_t frameIndex)
+    {
+      computedFrames.erase(computedFrames.begin(), computedFrames.lower_bound(frameIndex));
+      nbComputedMedias.erase(nbComputedMedias.begin(), nbComputedMedias.lower_bound(frameIndex));
+      if(firstNeededFrame.load() < frameIndex)
+        firstNeededFrame.store(frameIndex);
+    };
+
+    selection.select(getMediasData, releaseFramesBefore);
+  }
+  catch(...)
+  {
+    stopOnError(std::current_exception());
+  }
+
+  // stop the reader and the workers, they may have decoded frames ahead
+  mediaImages.close();
+  mediaResults.close();
+  for(std::thread& thread : threads)
+    thread.join();
+
+  if(error)
+    std::rethrow_exception(error);
+}
+
+} // namespace keyframe
+} // namespace aliceVision
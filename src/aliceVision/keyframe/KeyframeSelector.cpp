@@ -16,6 +16,7 @@
 #include <tuple>
 #include <cassert>
 #include <cstdlib>
+#include <thread>
 
 namespace fs = boost::filesystem;
 
@@ -71,9 +72,6 @@ KeyframeSelector::KeyframeSelector(const std::vector<std::string>& mediaPaths,
 
   // resize mediasInfo container
   _mediasInfo.resize(mediaPaths.size());
-
-  // create SIFT image describer
-  _imageDescriber.reset(new feature::ImageDescriber_SIFT());
 }
 
 void KeyframeSelector::process()
@@ -107,9 +105,6 @@ void KeyframeSelector::process()
     throw std::invalid_argument("One or multiple medias can't be found or empty !");
   }
 
-  // resize selection data vector
-  _framesData.resize(nbFrames);
-
   // feed provider variables
   image::Image< image::RGBColor> image;    // original image
   camera::PinholeRadialK3 queryIntrinsics; // image associated camera intrinsics
@@ -117,7 +112,6 @@ void KeyframeSelector::process()
   std::string currentImgName;              // current image name
 
   // process variables
-  const unsigned int frameStep = _maxFrameStep - _minFrameStep;
   const unsigned int tileSharpSubset = (_nbTileSide * _nbTileSide) / _sharpSubset;
 
   // create output folders
@@ -167,131 +161,62 @@ void KeyframeSelector::process()
     mediaInfo.spec.attribute("Exif:FocalLength", _cameraInfos[mediaIndex].focalLength);
   }
 
-  // iteration process
-  _keyframeIndexes.clear();
-  std::size_t currentFrameStep = _minFrameStep + 1; // start directly (dont skip minFrameStep first frames)
-  
-  for(std::size_t frameIndex = 0; frameIndex < _framesData.size(); ++frameIndex)
-  {
-    ALICEVISION_LOG_INFO("frame : " << frameIndex);
-    bool frameSelected = true;
-    auto& frameData = _framesData.at(frameIndex);
-    frameData.mediasData.resize(_feeds.size());
+  FrameSelectionParams params;
+  params.minFrameStep = _minFrameStep;
+  params.maxFrameStep = _maxFrameStep;
+  params.nbKeyFrameDist = _nbKeyFrameDist;
+  params.sharpnessThreshold = _sharpnessThreshold;
+  params.distScoreMax = _distScoreMax;
+  params.hasSharpnessSelection = _hasSharpnessSelection;
+  params.hasSparseDistanceSelection = _hasSparseDistanceSelection;
 
-    for(std::size_t mediaIndex = 0; mediaIndex < _feeds.size(); ++mediaIndex)
-    {
-      ALICEVISION_LOG_DEBUG("media : " << _mediaPaths.at(mediaIndex));
-      auto& feed = *_feeds.at(mediaIndex);
+  FrameSelection selection(params, nbFrames);
 
-      if(frameSelected) // false if a camera of a rig is not selected
-      {
-        if(!feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics))
-        {
-          ALICEVISION_LOG_ERROR("Cannot read frame '" << currentImgName << "' !");
-          throw std::invalid_argument("Cannot read frame '" + currentImgName + "' !");
-        }
-
-        // compute sharpness and sparse distance
-        if(!computeFrameData(image, frameIndex, mediaIndex, tileSharpSubset))
-        {
-          frameSelected = false;
-        }
-      }
+  // the frames are decoded ahead by a reader thread and their medias are scored by worker threads,
+  // the selection itself depends on the previous keyframes and is done in frame order on this thread
+  const std::size_t nbWorkers = (_nbWorkers > 0) ? _nbWorkers : std::max(1u, std::thread::hardware_concurrency());
 
-      feed.goToNextFrame();
-    }
+  // image describers are not thread-safe, each worker has its own
+  std::vector<std::unique_ptr<feature::ImageDescriber_SIFT>> imageDescribers;
+  if(selection.needsMediasData())
+  {
+    ALICEVISION_LOG_INFO("Keyframe selection with " << nbWorkers << " worker(s).");
+    for(std::size_t i = 0; i < nbWorkers; ++i)
+      imageDescribers.emplace_back(new feature::ImageDescriber_SIFT());
+  }
 
-    {
-      if(frameSelected)
-      {
-        ALICEVISION_LOG_INFO(" > selected" << std::endl);
-        frameData.selected = true;
-        if(_hasSharpnessSelection)
-          frameData.computeAvgSharpness();
-      }
-      else
-      {
-        ALICEVISION_LOG_INFO(" > skipped" << std::endl);
-        frameData.mediasData.clear(); // remove unselected mediasData
-      }
-    }
+  // next frame of each feed, the feeds are moved when the reader skips frames
+  std::vector<std::size_t> feedsFrameIndex(_feeds.size(), 0);
 
-    // selection process
-    if(currentFrameStep >= _maxFrameStep)
+  selectFramesConcurrently<image::Image<image::RGBColor>>(selection, _feeds.size(), nbWorkers,
+    [&](std::size_t frameIndex, std::size_t mediaIndex, image::Image<image::RGBColor>& mediaImage)
     {
-      currentFrameStep = _minFrameStep;
-      bool hasKeyframe = false;
-      std::size_t keyframeIndex = 0;
-      float maxSharpness = 0;
-      float minDistScore = std::numeric_limits<float>::max();
-
-      // find the best selected frame
-      if(_hasSharpnessSelection)
-      {
-        // find the sharpest selected frame
-        for(std::size_t index = frameIndex - (frameStep - 1); index <= frameIndex; ++index)
-        {
-          if(_framesData[index].selected && (_framesData[index].avgSharpness > maxSharpness))
-          {
-            hasKeyframe = true;
-            keyframeIndex = index;
-            maxSharpness = _framesData[index].avgSharpness;
-          }
-        }
-      }
-      else if(_hasSparseDistanceSelection)
-      {
-        // find the smallest sparseDistance selected frame
-        for(std::size_t index = frameIndex - (frameStep - 1); index <= frameIndex; ++index)
-        {
-          if(_framesData[index].selected && (_framesData[index].maxDistScore < minDistScore))
-          {
-            hasKeyframe = true;
-            keyframeIndex = index;
-            minDistScore = _framesData[index].maxDistScore;
-          }
-        }
-      }
-      else
-      {
-        // use the first frame of the step
-        hasKeyframe = true;
-        keyframeIndex = frameIndex - (frameStep - 1);
-      }
-
-      // save keyframe
-      if(hasKeyframe)
-      {
-        ALICEVISION_LOG_INFO("keyframe choice : " << keyframeIndex << std::endl);
-
-        // write keyframe
-        for(std::size_t mediaIndex = 0; mediaIndex < _feeds.size(); ++mediaIndex)
-        {
-          auto& feed = *_feeds.at(mediaIndex);
-
-          feed.goToFrame(keyframeIndex + _cameraInfos.at(mediaIndex).frameOffset);
+      auto& feed = *_feeds.at(mediaIndex);
+      if(feedsFrameIndex.at(mediaIndex) != frameIndex)
+        feed.goToFrame(frameIndex + _cameraInfos.at(mediaIndex).frameOffset);
 
-          if(_maxOutFrame == 0) // no limit of keyframes (direct evaluation)
-          {
-            feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics);
-            writeKeyframe(image, keyframeIndex, mediaIndex);
-          }
-        }
-        _framesData[keyframeIndex].keyframe = true;
-        _keyframeIndexes.push_back(keyframeIndex);
+      camera::PinholeRadialK3 frameIntrinsics;
+      bool frameHasIntrinsics = false;
+      std::string frameName;
 
-        frameIndex = keyframeIndex + _minFrameStep - 1;
-      }
-      else
+      if(!feed.readImage(mediaImage, frameIntrinsics, frameName, frameHasIntrinsics))
       {
-        ALICEVISION_LOG_INFO("keyframe choice : none" << std::endl);
+        ALICEVISION_LOG_ERROR("Cannot read frame '" << frameName << "' !");
+        throw std::invalid_argument("Cannot read frame '" + frameName + "' !");
       }
-    }
-    ++currentFrameStep;
-  }
+      feed.goToNextFrame();
+      feedsFrameIndex.at(mediaIndex) = frameIndex + 1;
+    },
+    [&](const image::Image<image::RGBColor>& mediaImage, std::size_t mediaIndex, std::size_t workerIndex, MediaData& mediaData)
+    {
+      computeMediaData(mediaImage, mediaIndex, tileSharpSubset, *imageDescribers.at(workerIndex), mediaData);
+    });
 
-  if(_maxOutFrame == 0) // no limit of keyframes (evaluation and write already done)
+  const std::vector<FrameData>& framesData = selection.getFramesData();
+
+  if(_maxOutFrame == 0) // no limit of keyframes
   {
+    writeKeyframes(selection.getKeyframeIndexes());
     return;
   }
 
@@ -299,28 +224,22 @@ void KeyframeSelector::process()
   {
     std::vector< std::tuple<float, float, std::size_t> > keyframes;
 
-    for(std::size_t i = 0; i < _framesData.size(); ++i)
+    for(std::size_t i = 0; i < framesData.size(); ++i)
     {
-      if(_framesData[i].keyframe)
+      if(framesData[i].keyframe)
       {
-        keyframes.emplace_back(_framesData[i].maxDistScore, 1 / _framesData[i].avgSharpness, i);
+        keyframes.emplace_back(framesData[i].maxDistScore, 1 / framesData[i].avgSharpness, i);
       }
     }
     std::sort(keyframes.begin(), keyframes.end());
 
     const std::size_t nbOutFrames = std::min(static_cast<std::size_t>(_maxOutFrame), keyframes.size());
 
+    std::vector<std::size_t> outFrameIndexes;
     for(std::size_t i = 0; i < nbOutFrames; ++i)
-    {
-      const std::size_t frameIndex = std::get<2>(keyframes.at(i));
-      for(std::size_t mediaIndex = 0; mediaIndex < _feeds.size(); ++mediaIndex)
-      {
-        auto& feed = *_feeds.at(mediaIndex);
-        feed.goToFrame(frameIndex + _cameraInfos.at(mediaIndex).frameOffset);
-        feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics);
-        writeKeyframe(image, frameIndex, mediaIndex);
-      }
-    }
+      outFrameIndexes.push_back(std::get<2>(keyframes.at(i)));
+
+    writeKeyframes(outFrameIndexes);
   }
 }
 
@@ -359,20 +278,16 @@ float KeyframeSelector::computeSharpness(const image::Image<float>& imageGray,
 }
 
 
-bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& image,
-                                        std::size_t frameIndex,
+void KeyframeSelector::computeMediaData(const image::Image<image::RGBColor>& image,
                                         std::size_t mediaIndex,
-                                        unsigned int tileSharpSubset)
+                                        unsigned int tileSharpSubset,
+                                        feature::ImageDescriber& imageDescriber,
+                                        MediaData& mediaData) const
 {
-  if(!_hasSharpnessSelection && !_hasSparseDistanceSelection)
-    return true; // nothing to do
-
   image::Image<float> imageGray;           // grayscale image
   image::Image<float> imageGrayHalfSample; // half resolution grayscale image
-  
+
   const auto& currMediaInfo = _mediasInfo.at(mediaIndex);
-  auto& currframeData = _framesData.at(frameIndex);
-  auto& currMediaData = currframeData.mediasData.at(mediaIndex);
 
   // get grayscale image and resize
   image::ConvertPixelType(image, &imageGray);
@@ -381,44 +296,40 @@ bool KeyframeSelector::computeFrameData(const image::Image<image::RGBColor>& ima
   // compute sharpness
   if(_hasSharpnessSelection)
   {
-    currMediaData.sharpness = computeSharpness(imageGrayHalfSample,
-                                               currMediaInfo.tileHeight,
-                                               currMediaInfo.tileWidth,
-                                               tileSharpSubset);
-    ALICEVISION_LOG_DEBUG( " - sharpness : " << currMediaData.sharpness);
+    mediaData.sharpness = computeSharpness(imageGrayHalfSample,
+                                           currMediaInfo.tileHeight,
+                                           currMediaInfo.tileWidth,
+                                           tileSharpSubset);
   }
 
-  if((currMediaData.sharpness > _sharpnessThreshold) || !_hasSharpnessSelection)
+  // compute sparse histogram, only used by the sparse distance of the frames passing the sharpness threshold
+  if(_hasSparseDistanceSelection && ((mediaData.sharpness > _sharpnessThreshold) || !_hasSharpnessSelection))
   {
-    bool noKeyframe = (_keyframeIndexes.empty());
-
-    // compute current frame sparse histogram
     std::unique_ptr<feature::Regions> regions;
-    _imageDescriber->describe(imageGrayHalfSample, regions);
-    currMediaData.histogram = voctree::SparseHistogram(_voctree->quantizeToSparse(dynamic_cast<feature::SIFT_Regions*>(regions.get())->Descriptors()));
-
-    // compute sparseDistance
-    if(!noKeyframe && _hasSparseDistanceSelection)
-    {
-      unsigned int nbKeyframetoCompare = (_keyframeIndexes.size() < _nbKeyFrameDist)? _keyframeIndexes.size() : _nbKeyFrameDist;
+    imageDescriber.describe(imageGrayHalfSample, regions);
+    mediaData.histogram = voctree::SparseHistogram(_voctree->quantizeToSparse(dynamic_cast<feature::SIFT_Regions*>(regions.get())->Descriptors()));
+  }
+}
 
-      for(std::size_t i = _keyframeIndexes.size() - nbKeyframetoCompare; i < _keyframeIndexes.size(); ++i)
-      {
-        for(auto& media : _framesData.at(_keyframeIndexes.at(i)).mediasData)
-        {
-          currMediaData.distScore = std::max(currMediaData.distScore, std::abs(voctree::sparseDistance(media.histogram, currMediaData.histogram, "strongCommonPoints")));
-        }
-      }
-      currframeData.maxDistScore = std::max(currframeData.maxDistScore, currMediaData.distScore);
-      ALICEVISION_LOG_DEBUG(" - distScore : " << currMediaData.distScore);
-    }
+void KeyframeSelector::writeKeyframes(const std::vector<std::size_t>& frameIndexes)
+{
+  // each media has its own feed and output spec
+  #pragma omp parallel for
+  for(int mediaIndex = 0; mediaIndex < static_cast<int>(_feeds.size()); ++mediaIndex)
+  {
+    auto& feed = *_feeds.at(mediaIndex);
+    image::Image< image::RGBColor> image;
+    camera::PinholeRadialK3 queryIntrinsics;
+    bool hasIntrinsics = false;
+    std::string currentImgName;
 
-    if(noKeyframe || (currMediaData.distScore < _distScoreMax))
+    for(std::size_t frameIndex : frameIndexes)
     {
-      return true;
+      feed.goToFrame(frameIndex + _cameraInfos.at(mediaIndex).frameOffset);
+      feed.readImage(image, queryIntrinsics, currentImgName, hasIntrinsics);
+      writeKeyframe(image, frameIndex, mediaIndex);
     }
-  } 
-  return false;
+  }
 }
 
 void KeyframeSelector::writeKeyframe(const image::Image<image::RGBColor>& image, 
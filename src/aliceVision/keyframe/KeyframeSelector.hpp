@@ -7,6 +7,7 @@
 #pragma once
 
 #include <aliceVision/keyframe/SharpnessSelectionPreset.hpp>
+#include <aliceVision/keyframe/FrameSelection.hpp>
 #include <aliceVision/feature/feature.hpp>
 #include <aliceVision/dataio/FeedProvider.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
@@ -170,6 +171,15 @@ public:
       _maxOutFrame = nbFrame;
   }
 
+  /**
+   * @brief Set the number of threads scoring the frames
+   * @param[in] nbWorkers number of worker threads (if 0, number of available cores)
+   */
+  void setNbWorkers(unsigned int nbWorkers)
+  {
+      _nbWorkers = nbWorkers;
+  }
+
   /**
    * @brief Get sharp subset size for process algorithm
    * @return sharp part of the image (1 = all, 2 = size/2, ...)
@@ -243,14 +253,14 @@ private:
   bool _hasSharpnessSelection = true;
   /// Use sparseDistance selection
   bool _hasSparseDistanceSelection = true;
+  /// Number of threads scoring the frames (0 = number of available cores)
+  unsigned int _nbWorkers = 0;
 
   /// Camera metadatas
   std::vector<CameraInfo> _cameraInfos;
 
   // Tools
 
-  /// Image describer in order to extract describer
-  std::unique_ptr<feature::ImageDescriber> _imageDescriber;
   /// Voctree in order to compute sparseHistogram
   std::unique_ptr< aliceVision::voctree::VocabularyTree<DescriptorFloat> > _voctree;
   /// Feed provider for media paths images extraction
@@ -271,52 +281,8 @@ private:
     oiio::ImageSpec spec;
   };
 
-  /**
-   * @brief Process media informations at a specific frame
-   */
-  struct MediaData
-  {
-    /// sharpness score
-    float sharpness = 0;
-    /// maximum distance score with keyframe media histograms
-    float distScore = 0;
-    /// sparseHistogram
-    voctree::SparseHistogram histogram;
-  };
-
-  /**
-   * @brief Process frame (or set of frames) informations
-   */
-  struct FrameData
-  {
-    /// average sharpness score of all media
-    float avgSharpness = 0;
-    /// maximum voctree distance score of all media
-    float maxDistScore = 0;
-    /// frame (or set of frames) selected for evaluation
-    bool selected = false;
-    /// frame is a keyframe
-    bool keyframe = false;
-    /// medias process data
-    std::vector<MediaData> mediasData;
-
-    /**
-     * @brief Compute average sharpness score
-     */
-    void computeAvgSharpness()
-    {
-      for(const auto& media : mediasData)
-        avgSharpness += media.sharpness;
-      avgSharpness /= mediasData.size();
-    }
-  };
-
   /// MediaInfo structure per input medias
   std::vector<MediaInfo> _mediasInfo;
-  /// FrameData structure per frame
-  std::vector<FrameData> _framesData;
-  /// Keyframe indexes container
-  std::vector<std::size_t> _keyframeIndexes;
 
   /**
    * @brief Compute sharpness score of a given image
@@ -332,17 +298,26 @@ private:
                          const unsigned int tileSharpSubset) const;
 
   /**
-   * @brief Compute sharpness and distance score for a given image
+   * @brief Compute sharpness and sparse histogram for a given image,
+   * the histogram is only computed if the image passes the sharpness threshold
+   * @note thread-safe if each thread uses its own image describer
    * @param[in] image an image of the media
-   * @param[in] frameIndex the image index in the media sequence
    * @param[in] mediaIndex the media index
    * @param[in] tileSharpSubset number of sharp tiles
-   * @return true if the frame is selected
+   * @param[in] imageDescriber the SIFT image describer
+   * @param[out] mediaData the media data of the image
    */
-  bool computeFrameData(const image::Image<image::RGBColor>& image,
-                        std::size_t frameIndex,
+  void computeMediaData(const image::Image<image::RGBColor>& image,
                         std::size_t mediaIndex,
-                        unsigned int tileSharpSubset);
+                        unsigned int tileSharpSubset,
+                        feature::ImageDescriber& imageDescriber,
+                        MediaData& mediaData) const;
+
+  /**
+   * @brief Read and write the given keyframes of all the medias
+   * @param[in] frameIndexes the keyframe indexes in the media sequence
+   */
+  void writeKeyframes(const std::vector<std::size_t>& frameIndexes);
 
   /**
    * @brief Write a keyframe and metadata
@@ -0,0 +1,305 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/keyframe/FrameSelection.hpp>
+
+#define BOOST_TEST_MODULE frameSelection
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::keyframe;
+
+namespace {
+
+/// synthetic image of a media: only its frame index
+struct FakeImage
+{
+  std::size_t frameIndex = 0;
+};
+
+/**
+ * @brief Synthetic scores of a media at a frame:
+ *  - a pseudo-random sharpness around the threshold,
+ *  - a histogram sharing (40 - 2 * frames distance) single-feature words with the other frames.
+ */
+MediaData getMediaData(std::size_t frameIndex, std::size_t mediaIndex)
+{
+  std::mt19937 generator(static_cast<unsigned int>(frameIndex * 7 + mediaIndex));
+  std::uniform_real_distribution<float> sharpness(10.0f, 20.0f);
+
+  MediaData mediaData;
+  mediaData.sharpness = sharpness(generator);
+  for(std::size_t word = 2 * frameIndex; word < 2 * frameIndex + 40; ++word)
+    mediaData.histogram[static_cast<voctree::Word>(word * 8 + mediaIndex)].push_back(0);
+  return mediaData;
+}
+
+struct ReferenceFrame
+{
+  bool selected = false;
+  float avgSharpness = 0;
+  float maxDistScore = 0;
+};
+
+/**
+ * @brief Serial keyframe selection, each frame scored when it is evaluated
+ * as it was done before the scoring was moved to worker threads.
+ */
+std::vector<std::size_t> referenceSelection(const FrameSelectionParams& params, std::size_t nbFrames, std::size_t nbMedias, std::vector<ReferenceFrame>& frames)
+{
+  frames.assign(nbFrames, ReferenceFrame());
+  std::vector<std::vector<MediaData>> framesMedias(nbFrames);
+  std::vector<std::size_t> keyframes;
+  const unsigned int frameStep = params.maxFrameStep - params.minFrameStep;
+  const bool computeData = params.hasSharpnessSelection || params.hasSparseDistanceSelection;
+  std::size_t currentFrameStep = params.minFrameStep + 1;
+
+  for(std::size_t frameIndex = 0; frameIndex < nbFrames; ++frameIndex)
+  {
+    ReferenceFrame& frame = frames[frameIndex];
+    frame = ReferenceFrame();
+    framesMedias[frameIndex].clear();
+    bool frameSelected = true;
+
+    for(std::size_t mediaIndex = 0; computeData && frameSelected && mediaIndex < nbMedias; ++mediaIndex)
+    {
+      MediaData mediaData = getMediaData(frameIndex, mediaIndex);
+      if(params.hasSharpnessSelection && !(mediaData.sharpness > params.sharpnessThreshold))
+      {
+        frameSelected = false;
+        break;
+      }
+      if(!keyframes.empty() && params.hasSparseDistanceSelection)
+      {
+        const std::size_t nbKeyframes = std::min<std::size_t>(keyframes.size(), params.nbKeyFrameDist);
+        for(std::size_t i = keyframes.size() - nbKeyframes; i < keyframes.size(); ++i)
+          for(const MediaData& keyframeMedia : framesMedias[keyframes[i]])
+            mediaData.distScore = std::max(mediaData.distScore, std::abs(voctree::sparseDistance(keyframeMedia.histogram, mediaData.histogram, "strongCommonPoints")));
+        frame.maxDistScore = std::max(frame.maxDistScore, mediaData.distScore);
+      }
+      if(!keyframes.empty() && !(mediaData.distScore < params.distScoreMax))
+        frameSelected = false;
+      framesMedias[frameIndex].push_back(mediaData);
+    }
+
+    if(frameSelected)
+    {
+      frame.selected = true;
+      if(!computeData)
+        framesMedias[frameIndex].resize(nbMedias);
+      if(params.hasSharpnessSelection)
+      {
+        for(const MediaData& mediaData : framesMedias[frameIndex])
+          frame.avgSharpness += mediaData.sharpness;
+        frame.avgSharpness /= nbMedias;
+      }
+    }
+    else
+      framesMedias[frameIndex].clear();
+
+    if(currentFrameStep >= params.maxFrameStep)
+    {
+      currentFrameStep = params.minFrameStep;
+      bool hasKeyframe = false;
+      std::size_t keyframeIndex = 0;
+      float maxSharpness = 0;
+      float minDistScore = std::numeric_limits<float>::max();
+
+      for(std::size_t index = frameIndex - (frameStep - 1); index <= frameIndex; ++index)
+      {
+        if(!frames[index].selected)
+          continue;
+        if(params.hasSharpnessSelection && frames[index].avgSharpness > maxSharpness)
+        {
+          hasKeyframe = true;
+          keyframeIndex = index;
+          maxSharpness = frames[index].avgSharpness;
+        }
+        else if(!params.hasSharpnessSelection && params.hasSparseDistanceSelection && frames[index].maxDistScore < minDistScore)
+        {
+          hasKeyframe = true;
+          keyframeIndex = index;
+          minDistScore = frames[index].maxDistScore;
+        }
+      }
+      if(!computeData)
+      {
+        hasKeyframe = true;
+        keyframeIndex = frameIndex - (frameStep - 1);
+      }
+
+      if(hasKeyframe)
+      {
+        keyframes.push_back(keyframeIndex);
+        frameIndex = keyframeIndex + params.minFrameStep - 1;
+      }
+    }
+    ++currentFrameStep;
+  }
+  return keyframes;
+}
+
+std::vector<FrameSelectionParams> getTestParams()
+{
+  std::vector<FrameSelectionParams> paramsList;
+  for(int selectionMode = 0; selectionMode < 4; ++selectionMode)
+  {
+    for(unsigned int minFrameStep : {1, 3, 12})
+    {
+      FrameSelectionParams params;
+      params.hasSharpnessSelection = (selectionMode & 1);
+      params.hasSparseDistanceSelection = (selectionMode & 2);
+      params.minFrameStep = minFrameStep;
+      params.maxFrameStep = 3 * minFrameStep + 1;
+      params.nbKeyFrameDist = 3;
+      params.sharpnessThreshold = 14.0f;
+      params.distScoreMax = 25.0f;
+      paramsList.push_back(params);
+    }
+  }
+  return paramsList;
+}
+
+void checkSameSelection(const FrameSelection& selection, const std::vector<std::size_t>& referenceKeyframes, const std::vector<ReferenceFrame>& referenceFrames)
+{
+  BOOST_REQUIRE_EQUAL(selection.getKeyframeIndexes().size(), referenceKeyframes.size());
+  for(std::size_t i = 0; i < referenceKeyframes.size(); ++i)
+    BOOST_CHECK_EQUAL(selection.getKeyframeIndexes()[i], referenceKeyframes[i]);
+
+  const std::vector<FrameData>& framesData = selection.getFramesData();
+  BOOST_REQUIRE_EQUAL(framesData.size(), referenceFrames.size());
+  for(std::size_t i = 0; i < framesData.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(framesData[i].selected, referenceFrames[i].selected);
+    BOOST_CHECK_EQUAL(framesData[i].avgSharpness, referenceFrames[i].avgSharpness);
+    BOOST_CHECK_EQUAL(framesData[i].maxDistScore, referenceFrames[i].maxDistScore);
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(frameSelection_serial)
+{
+  const std::size_t nbFrames = 300;
+
+  for(const FrameSelectionParams& params : getTestParams())
+  {
+    for(std::size_t nbMedias : {1, 3})
+    {
+      std::vector<ReferenceFrame> referenceFrames;
+      const std::vector<std::size_t> referenceKeyframes = referenceSelection(params, nbFrames, nbMedias, referenceFrames);
+      BOOST_CHECK(!referenceKeyframes.empty());
+
+      // medias data computed on demand, in frame order
+      FrameSelection selection(params, nbFrames);
+      selection.select([&](std::size_t frameIndex)
+      {
+        std::vector<MediaData> mediasData(nbMedias);
+        for(std::size_t mediaIndex = 0; selection.needsMediasData() && mediaIndex < nbMedias; ++mediaIndex)
+          mediasData[mediaIndex] = getMediaData(frameIndex, mediaIndex);
+        return mediasData;
+      }, [](std::size_t) {});
+
+      checkSameSelection(selection, referenceKeyframes, referenceFrames);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(frameSelection_concurrent)
+{
+  const std::size_t nbFrames = 300;
+
+  for(const FrameSelectionParams& params : getTestParams())
+  {
+    for(std::size_t nbMedias : {1, 3})
+    {
+      std::vector<ReferenceFrame> referenceFrames;
+      const std::vector<std::size_t> referenceKeyframes = referenceSelection(params, nbFrames, nbMedias, referenceFrames);
+
+      for(std::size_t nbWorkers : {1, 2, 5})
+      {
+        std::vector<std::size_t> readFrames;
+        std::atomic<std::size_t> nbInvalidReads(0);
+        std::atomic<std::size_t> nbInvalidWorkers(0);
+
+        FrameSelection selection(params, nbFrames);
+        selectFramesConcurrently<FakeImage>(selection, nbMedias, nbWorkers,
+          [&](std::size_t frameIndex, std::size_t mediaIndex, FakeImage& image)
+          {
+            // the frames are read in order, each media once per frame
+            if(mediaIndex == 0)
+            {
+              if(!readFrames.empty() && readFrames.back() >= frameIndex)
+                ++nbInvalidReads;
+              readFrames.push_back(frameIndex);
+            }
+            image.frameIndex = frameIndex;
+          },
+          [&](const FakeImage& image, std::size_t mediaIndex, std::size_t workerIndex, MediaData& mediaData)
+          {
+            if(workerIndex >= nbWorkers)
+              ++nbInvalidWorkers;
+            // uneven scoring times, so that the medias are scored out of order
+            std::this_thread::sleep_for(std::chrono::microseconds((image.frameIndex * 7919 + mediaIndex * 31) % 200));
+            mediaData = getMediaData(image.frameIndex, mediaIndex);
+          });
+
+        BOOST_CHECK_EQUAL(nbInvalidReads, 0);
+        BOOST_CHECK_EQUAL(nbInvalidWorkers, 0);
+        if(selection.needsMediasData())
+          BOOST_CHECK_LE(readFrames.size(), nbFrames);
+        checkSameSelection(selection, referenceKeyframes, referenceFrames);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(frameSelection_concurrentErrors)
+{
+  FrameSelectionParams params;
+  params.minFrameStep = 3;
+  params.maxFrameStep = 10;
+
+  // error while reading a frame
+  {
+    FrameSelection selection(params, 100);
+    BOOST_CHECK_THROW(selectFramesConcurrently<FakeImage>(selection, 2, 3,
+      [](std::size_t frameIndex, std::size_t, FakeImage& image)
+      {
+        if(frameIndex == 40)
+          throw std::invalid_argument("Cannot read frame");
+        image.frameIndex = frameIndex;
+      },
+      [](const FakeImage& image, std::size_t mediaIndex, std::size_t, MediaData& mediaData)
+      {
+        mediaData = getMediaData(image.frameIndex, mediaIndex);
+      }), std::invalid_argument);
+  }
+
+  // error while scoring a media
+  {
+    FrameSelection selection(params, 100);
+    BOOST_CHECK_THROW(selectFramesConcurrently<FakeImage>(selection, 2, 3,
+      [](std::size_t frameIndex, std::size_t, FakeImage& image) { image.frameIndex = frameIndex; },
+      [](const FakeImage& image, std::size_t mediaIndex, std::size_t, MediaData& mediaData)
+      {
+        if(image.frameIndex == 25 && mediaIndex == 1)
+          throw std::runtime_error("Cannot describe frame");
+        mediaData = getMediaData(image.frameIndex, mediaIndex);
+      }), std::runtime_error);
+  }
+}
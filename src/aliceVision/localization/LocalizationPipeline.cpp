@@ -0,0 +1,145 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LocalizationPipeline.hpp"
+
+#include <aliceVision/dataio/FeedProvider.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/OrderedPipeline.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace aliceVision {
+namespace localization {
+
+struct LocalizationPipeline::Frame
+{
+  std::size_t id = 0;
+  std::string mediaPath;
+  image::Image<float> imageGrey;
+  camera::PinholeRadialK3 intrinsics;
+  bool hasIntrinsics = false;
+
+  std::pair<std::size_t, std::size_t> imageSize;
+  feature::MapRegionsPerDesc regions;
+  /// built on regions, which must not move while it is alive
+  std::unique_ptr<matching::RegionsDatabaseMatcherPerDesc> matchers;
+  OccurenceMap occurences;
+  std::vector<voctree::DocMatch> matchedImages;
+
+  LocalizationResult result;
+};
+
+LocalizationPipeline::LocalizationPipeline(VoctreeLocalizer& localizer,
+                                           const VoctreeLocalizer::Parameters& param,
+                                           std::size_t nbWorkers,
+                                           std::size_t queueSize)
+  : _localizer(localizer)
+  , _param(param)
+  , _nbWorkers(nbWorkers)
+  , _queueSize(queueSize)
+{
+  if(_nbWorkers == 0)
+    _nbWorkers = std::max(1u, std::thread::hardware_concurrency());
+  if(_queueSize == 0)
+    _queueSize = 2 * _nbWorkers;
+}
+
+bool LocalizationPipeline::useFrameBuffer() const
+{
+  return _param._algorithm == VoctreeLocalizer::Algorithm::AllResults && _param._nbFrameBufferMatching > 0;
+}
+
+void LocalizationPipeline::processFrame(Frame& frame, std::vector<std::unique_ptr<feature::ImageDescriber>>& imageDescribers) const
+{
+  _localizer.describeQueryImage(frame.imageGrey, _param, imageDescribers, frame.regions, frame.mediaPath);
+  frame.imageSize = std::make_pair(frame.imageGrey.Width(), frame.imageGrey.Height());
+  // the image is not needed anymore, release it while the frame waits for the next stages
+  frame.imageGrey = image::Image<float>();
+
+  if(!useFrameBuffer())
+  {
+    // the localization does not depend on the previous frames
+    _localizer.localize(frame.regions,
+                        frame.imageSize,
+                        &_param,
+                        frame.hasIntrinsics,
+                        frame.intrinsics,
+                        frame.result,
+                        frame.mediaPath);
+    return;
+  }
+
+  frame.matchers.reset(new matching::RegionsDatabaseMatcherPerDesc(_localizer._matcherType, frame.regions));
+  _localizer.matchAllResults(frame.regions,
+                             frame.imageSize,
+                             _param,
+                             frame.hasIntrinsics,
+                             frame.intrinsics,
+                             *frame.matchers,
+                             frame.occurences,
+                             frame.matchedImages,
+                             frame.mediaPath);
+}
+
+void LocalizationPipeline::finalizeFrame(Frame& frame)
+{
+  if(!useFrameBuffer())
+    return;
+
+  _localizer.resectAllResults(frame.regions,
+                              frame.imageSize,
+                              _param,
+                              frame.hasIntrinsics,
+                              frame.intrinsics,
+                              *frame.matchers,
+                              frame.occurences,
+                              frame.matchedImages,
+                              frame.result,
+                              frame.mediaPath);
+}
+
+std::size_t LocalizationPipeline::run(dataio::FeedProvider& feed, const ResultCallback& callback)
+{
+  typedef std::unique_ptr<Frame> FramePtr;
+
+  ALICEVISION_LOG_INFO("Localization pipeline with " << _nbWorkers << " worker(s).");
+
+  // image describers are not thread-safe, each worker has its own
+  std::vector<std::vector<std::unique_ptr<feature::ImageDescriber>>> imageDescribersPerWorker(_nbWorkers);
+  for(auto& imageDescribers : imageDescribersPerWorker)
+  {
+    for(const auto& imageDescriber : _localizer._imageDescribers)
+      imageDescribers.push_back(feature::createImageDescriber(imageDescriber->getDescriberType()));
+  }
+
+  return system::runOrderedPipeline<FramePtr>(_nbWorkers, _queueSize,
+    // decode stage
+    [&](std::size_t frameId, FramePtr& frame)
+    {
+      frame.reset(new Frame());
+      if(!feed.readImage(frame->imageGrey, frame->intrinsics, frame->mediaPath, frame->hasIntrinsics))
+        return false;
+      feed.goToNextFrame();
+      frame->id = frameId;
+      return true;
+    },
+    // describe / retrieve / match stages
+    [&](FramePtr& frame, std::size_t workerIndex)
+    {
+      processFrame(*frame, imageDescribersPerWorker[workerIndex]);
+    },
+    // in-order stage, on the calling thread
+    [&](std::size_t frameId, FramePtr& frame)
+    {
+      finalizeFrame(*frame);
+      callback(frame->id, frame->mediaPath, frame->result);
+    });
+}
+
+} // namespace localization
+} // namespace aliceVision
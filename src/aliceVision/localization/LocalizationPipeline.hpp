@@ -0,0 +1,98 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/localization/VoctreeLocalizer.hpp>
+#include <aliceVision/localization/LocalizationResult.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+
+namespace dataio {
+class FeedProvider;
+}
+
+namespace localization {
+
+/**
+ * @brief Localize all the frames of a feed with a VoctreeLocalizer, overlapping the
+ * processing of consecutive frames.
+ *
+ * The frames go through the following stages, connected by bounded queues:
+ *  - a reader thread decodes the frames from the feed;
+ *  - several worker threads extract the features (each one with its own image describers),
+ *    query the vocabulary tree and match the frame with the retrieved database images;
+ *  - the calling thread receives the frames in order, and for the AllResults algorithm with
+ *    frame buffer matching, it matches the frame with the previous ones and estimates the pose,
+ *    as these steps depend on the results of the previous frames.
+ * Otherwise the localization of a frame does not depend on the other frames and it is fully
+ * done by the workers.
+ *
+ * The results are given in the order of the feed, and they are the same as the ones obtained
+ * by calling VoctreeLocalizer::localize on each frame.
+ */
+class LocalizationPipeline
+{
+public:
+  /**
+   * @brief Callback called for each frame, in the order of the feed.
+   * @param[in] frameId The index of the frame in the feed.
+   * @param[in] mediaPath The path of the frame given by the feed.
+   * @param[in] localizationResult The localization result of the frame.
+   */
+  using ResultCallback = std::function<void(std::size_t frameId,
+                                            const std::string& mediaPath,
+                                            const LocalizationResult& localizationResult)>;
+
+  /**
+   * @param[in] localizer An initialized localizer, its frame buffer is updated as by localize().
+   * @param[in] param The parameters for the localization.
+   * @param[in] nbWorkers The number of worker threads, 0 to use the number of available cores.
+   * @param[in] queueSize The maximum number of frames waiting between two stages,
+   * 0 to use twice the number of workers.
+   */
+  LocalizationPipeline(VoctreeLocalizer& localizer,
+                       const VoctreeLocalizer::Parameters& param,
+                       std::size_t nbWorkers = 0,
+                       std::size_t queueSize = 0);
+
+  /**
+   * @brief Localize all the remaining frames of the feed.
+   * Exceptions thrown by any stage stop the pipeline and are rethrown by this function.
+   * @param[in,out] feed The feed providing the frames.
+   * @param[in] callback Called on the calling thread for each frame, in order.
+   * @return the number of processed frames.
+   */
+  std::size_t run(dataio::FeedProvider& feed, const ResultCallback& callback);
+
+  std::size_t getNbWorkers() const { return _nbWorkers; }
+
+private:
+  struct Frame;
+
+  /// process a frame in a worker thread, as far as it does not depend on the previous frames
+  void processFrame(Frame& frame, std::vector<std::unique_ptr<feature::ImageDescriber>>& imageDescribers) const;
+
+  /// end the processing of a frame in the calling thread, in frame order
+  void finalizeFrame(Frame& frame);
+
+  /// true if the end of the localization depends on the previous frames
+  bool useFrameBuffer() const;
+
+  VoctreeLocalizer& _localizer;
+  const VoctreeLocalizer::Parameters& _param;
+  std::size_t _nbWorkers;
+  std::size_t _queueSize;
+};
+
+} // namespace localization
+} // namespace aliceVision
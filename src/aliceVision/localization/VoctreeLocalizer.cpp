@@ -192,12 +192,31 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
                                 const std::string& imagePath /* = std::string() */)
 {
   // A. extract descriptors and features from image
-  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
   feature::MapRegionsPerDesc queryRegionsPerDesc;
+  describeQueryImage(imageGrey, *param, _imageDescribers, queryRegionsPerDesc, imagePath);
+
+  const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
+
+  return localize(queryRegionsPerDesc,
+                  queryImageSize,
+                  param,
+                  useInputIntrinsics,
+                  queryIntrinsics,
+                  localizationResult,
+                  imagePath);
+}
+
+void VoctreeLocalizer::describeQueryImage(const image::Image<float>& imageGrey,
+                                          const LocalizerParameters& param,
+                                          std::vector<std::unique_ptr<feature::ImageDescriber>>& imageDescribers,
+                                          feature::MapRegionsPerDesc& queryRegionsPerDesc,
+                                          const std::string& imagePath) const
+{
+  ALICEVISION_LOG_DEBUG("[features]\tExtract Regions from query image");
 
   image::Image<unsigned char> imageGrayUChar; // uchar image copy for uchar image describer
 
-  for(const auto& imageDescriber : _imageDescribers)
+  for(const auto& imageDescriber : imageDescribers)
   {
     const auto descType = imageDescriber->getDescriberType();
     auto & queryRegions = queryRegionsPerDesc[descType];
@@ -206,7 +225,7 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
 
     system::Timer timer;
     imageDescriber->setCudaPipe(_cudaPipe);
-    imageDescriber->setConfigurationPreset(param->_featurePreset);
+    imageDescriber->setConfigurationPreset(param._featurePreset);
 
     if(imageDescriber->useFloatImage())
     {
@@ -223,14 +242,13 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
     ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(descType) << " done: found " << queryRegions->RegionCount() << " features in " << timer.elapsedMs() << " [ms]");
   }
 
-  const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
-
   // if debugging is enable save the svg image with the extracted features
-  if(!param->_visualDebug.empty() && !imagePath.empty())
+  if(!param._visualDebug.empty() && !imagePath.empty())
   {
+    const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
     feature::MapFeaturesPerDesc extractedFeatures;
 
-    for(const auto& imageDescriber : _imageDescribers)
+    for(const auto& imageDescriber : imageDescribers)
     {
       const auto descType = imageDescriber->getDescriberType();
       extractedFeatures[descType] = queryRegionsPerDesc.at(descType)->GetRegionsPositions();
@@ -240,16 +258,8 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
     matching::saveFeatures2SVG(imagePath,
                      queryImageSize,
                      extractedFeatures,
-                     param->_visualDebug + "/" + bfs::path(imagePath).stem().string() + ".svg");
+                     param._visualDebug + "/" + bfs::path(imagePath).stem().string() + ".svg");
   }
-
-  return localize(queryRegionsPerDesc,
-                  queryImageSize,
-                  param,
-                  useInputIntrinsics,
-                  queryIntrinsics,
-                  localizationResult,
-                  imagePath);
 }
 
 bool VoctreeLocalizer::loadReconstructionDescriptors(const sfmData::SfMData & sfm_data,
@@ -612,25 +622,61 @@ bool VoctreeLocalizer::localizeAllResults(const feature::MapRegionsPerDesc &quer
                                           LocalizationResult &localizationResult,
                                           const std::string& imagePath)
 {
-  
-  sfm::ImageLocalizerMatchData resectionData;
+  ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
+  matching::RegionsDatabaseMatcherPerDesc matchers(_matcherType, queryRegions);
+
   // a map containing for each pair <pt3D_id, pt2D_id> the number of times that 
   // the association has been seen
   OccurenceMap occurences;
-  
-  // get all the association from the database images
   std::vector<voctree::DocMatch> matchedImages;
-  getAllAssociations(queryRegions,
-                     queryImageSize,
-                     param,
-                     useInputIntrinsics,
-                     queryIntrinsics,
-                     occurences,
-                     resectionData.pt2D,
-                     resectionData.pt3D,
-                     resectionData.vec_descType,
-                     matchedImages,
-                     imagePath);
+
+  matchAllResults(queryRegions,
+                  queryImageSize,
+                  param,
+                  useInputIntrinsics,
+                  queryIntrinsics,
+                  matchers,
+                  occurences,
+                  matchedImages,
+                  imagePath);
+
+  return resectAllResults(queryRegions,
+                          queryImageSize,
+                          param,
+                          useInputIntrinsics,
+                          queryIntrinsics,
+                          matchers,
+                          occurences,
+                          matchedImages,
+                          localizationResult,
+                          imagePath);
+}
+
+bool VoctreeLocalizer::resectAllResults(const feature::MapRegionsPerDesc &queryRegions,
+                                        const std::pair<std::size_t, std::size_t> & queryImageSize,
+                                        const Parameters &param,
+                                        bool useInputIntrinsics,
+                                        camera::PinholeRadialK3 &queryIntrinsics,
+                                        matching::RegionsDatabaseMatcherPerDesc& matchers,
+                                        OccurenceMap& occurences,
+                                        const std::vector<voctree::DocMatch>& matchedImages,
+                                        LocalizationResult &localizationResult,
+                                        const std::string& imagePath)
+{
+  sfm::ImageLocalizerMatchData resectionData;
+
+  // add the associations with the last frames and get the 2D-3D points
+  collectAssociations(queryRegions,
+                      queryImageSize,
+                      param,
+                      useInputIntrinsics,
+                      queryIntrinsics,
+                      matchers,
+                      occurences,
+                      resectionData.pt2D,
+                      resectionData.pt3D,
+                      resectionData.vec_descType,
+                      imagePath);
 
   const std::size_t numCollectedPts = occurences.size();
   std::vector<IndMatch3D2D> associationIDs;
@@ -752,8 +798,42 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
                                           std::vector<voctree::DocMatch>& out_matchedImages,
                                           const std::string& imagePath) const
 {
-  assert(out_descTypes.size() == 0);
+  ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
+  matching::RegionsDatabaseMatcherPerDesc matchers(_matcherType, queryRegions);
 
+  matchAllResults(queryRegions,
+                  imageSize,
+                  param,
+                  useInputIntrinsics,
+                  queryIntrinsics,
+                  matchers,
+                  out_occurences,
+                  out_matchedImages,
+                  imagePath);
+
+  collectAssociations(queryRegions,
+                      imageSize,
+                      param,
+                      useInputIntrinsics,
+                      queryIntrinsics,
+                      matchers,
+                      out_occurences,
+                      out_pt2D,
+                      out_pt3D,
+                      out_descTypes,
+                      imagePath);
+}
+
+void VoctreeLocalizer::matchAllResults(const feature::MapRegionsPerDesc &queryRegions,
+                                       const std::pair<std::size_t, std::size_t> &imageSize,
+                                       const Parameters &param,
+                                       bool useInputIntrinsics,
+                                       const camera::PinholeRadialK3 &queryIntrinsics,
+                                       matching::RegionsDatabaseMatcherPerDesc& matchers,
+                                       OccurenceMap &out_occurences,
+                                       std::vector<voctree::DocMatch>& out_matchedImages,
+                                       const std::string& imagePath) const
+{
   // A. Find the (visually) similar images in the database 
   // pass the descriptors through the vocabulary tree to get the visual words
   // associated to each feature
@@ -781,9 +861,6 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
 //            << " features with 3D points");
 //  }
 
-  ALICEVISION_LOG_DEBUG("[matching]\tBuilding the matcher");
-  matching::RegionsDatabaseMatcherPerDesc matchers(_matcherType, queryRegions);
-
   std::map< std::pair<IndexT, IndexT>, std::size_t > repeated;
   
   // B. for each found similar image, try to find the correspondences between the 
@@ -921,7 +998,22 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc &quer
       break;
     }
   }
-  
+}
+
+void VoctreeLocalizer::collectAssociations(const feature::MapRegionsPerDesc &queryRegions,
+                                           const std::pair<std::size_t, std::size_t> &imageSize,
+                                           const Parameters &param,
+                                           bool useInputIntrinsics,
+                                           const camera::PinholeRadialK3 &queryIntrinsics,
+                                           matching::RegionsDatabaseMatcherPerDesc& matchers,
+                                           OccurenceMap &out_occurences,
+                                           Mat &out_pt2D,
+                                           Mat &out_pt3D,
+                                           std::vector<feature::EImageDescriberType>& out_descTypes,
+                                           const std::string& imagePath) const
+{
+  assert(out_descTypes.size() == 0);
+
   if(param._nbFrameBufferMatching > 0)
   {
     ALICEVISION_LOG_DEBUG("[matching]\tUsing frameBuffer matching: matching with the past " 
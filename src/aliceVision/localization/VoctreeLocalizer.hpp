@@ -264,6 +264,78 @@ public:
                           std::vector<voctree::DocMatch>& out_matchedImages,
                           const std::string& imagePath = std::string()) const;
 
+  /**
+   * @brief Extract the features of the query image with the given describers.
+   * It does not modify the localizer, so it can be called concurrently on different
+   * images as long as each thread uses its own set of describers.
+   *
+   * @param[in] imageGrey The input greyscale image.
+   * @param[in] param The parameters for the localization.
+   * @param[in,out] imageDescribers The describers used to extract the features.
+   * @param[out] queryRegionsPerDesc The extracted features for each describer type.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   */
+  void describeQueryImage(const image::Image<float>& imageGrey,
+                          const LocalizerParameters& param,
+                          std::vector<std::unique_ptr<feature::ImageDescriber>>& imageDescribers,
+                          feature::MapRegionsPerDesc& queryRegionsPerDesc,
+                          const std::string& imagePath = std::string()) const;
+
+  /**
+   * @brief First stage of localizeAllResults: query the database and match the
+   * query image with the retrieved images to collect the 2D-3D associations.
+   * It only reads the database, so it can be called concurrently on different frames.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the input image
+   * @param[in] param The parameters for the localization
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in] queryIntrinsics Intrinsic parameters of the camera
+   * @param[in,out] matchers The matchers built on \p queryRegions
+   * @param[out] out_occurences The 2D-3D associations and their number of occurrences
+   * @param[out] out_matchedImages The images retrieved from the database
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   */
+  void matchAllResults(const feature::MapRegionsPerDesc& queryRegions,
+                       const std::pair<std::size_t, std::size_t>& imageSize,
+                       const Parameters& param,
+                       bool useInputIntrinsics,
+                       const camera::PinholeRadialK3& queryIntrinsics,
+                       matching::RegionsDatabaseMatcherPerDesc& matchers,
+                       OccurenceMap& out_occurences,
+                       std::vector<voctree::DocMatch>& out_matchedImages,
+                       const std::string& imagePath = std::string()) const;
+
+  /**
+   * @brief Second stage of localizeAllResults: match with the frame buffer, estimate
+   * and refine the pose from the associations found by matchAllResults, then add the
+   * frame to the buffer. As it reads and updates the frame buffer, it must be called
+   * in frame order.
+   *
+   * @param[in] queryRegions The input features of the query image
+   * @param[in] imageSize The size of the input image
+   * @param[in] param The parameters for the localization
+   * @param[in] useInputIntrinsics Uses the \p queryIntrinsics as known calibration
+   * @param[in,out] queryIntrinsics Intrinsic parameters of the camera, they are used if the
+   * flag useInputIntrinsics is set to true, otherwise they are estimated from the correspondences.
+   * @param[in,out] matchers The matchers built on \p queryRegions
+   * @param[in,out] occurences The associations given by matchAllResults
+   * @param[in] matchedImages The images retrieved by matchAllResults
+   * @param[out] localizationResult The localization result containing the pose and the associations.
+   * @param[in] imagePath Optional complete path to the image, used only for debugging purposes.
+   * @return true if the localization is successful
+   */
+  bool resectAllResults(const feature::MapRegionsPerDesc& queryRegions,
+                        const std::pair<std::size_t, std::size_t>& imageSize,
+                        const Parameters& param,
+                        bool useInputIntrinsics,
+                        camera::PinholeRadialK3& queryIntrinsics,
+                        matching::RegionsDatabaseMatcherPerDesc& matchers,
+                        OccurenceMap& occurences,
+                        const std::vector<voctree::DocMatch>& matchedImages,
+                        LocalizationResult& localizationResult,
+                        const std::string& imagePath = std::string());
+
 private:
   /**
    * @brief Load the vocabulary tree.
@@ -311,6 +383,22 @@ private:
                       matching::MatchesPerDescType & out_featureMatches,
                       robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC) const;
   
+  /**
+   * @brief Add the associations with the frame buffer and fill the 2D-3D points
+   * from all the collected associations.
+   */
+  void collectAssociations(const feature::MapRegionsPerDesc& queryRegions,
+                           const std::pair<std::size_t, std::size_t>& imageSize,
+                           const Parameters& param,
+                           bool useInputIntrinsics,
+                           const camera::PinholeRadialK3& queryIntrinsics,
+                           matching::RegionsDatabaseMatcherPerDesc& matchers,
+                           OccurenceMap& out_occurences,
+                           Mat& out_pt2D,
+                           Mat& out_pt3D,
+                           std::vector<feature::EImageDescriberType>& out_descTypes,
+                           const std::string& imagePath = std::string()) const;
+
   void getAssociationsFromBuffer(matching::RegionsDatabaseMatcherPerDesc& matchers,
                                  const std::pair<std::size_t, std::size_t> & imageSize,
                                  const Parameters &param,
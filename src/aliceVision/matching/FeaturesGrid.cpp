@@ -0,0 +1,182 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "FeaturesGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace aliceVision {
+namespace matching {
+
+namespace {
+
+/// average number of features per cell
+const double featuresPerCell = 8.0;
+/// maximal number of cells along one side, for the degenerated features distributions
+const double maxCellsPerSide = 4096.0;
+
+} // namespace
+
+FeaturesGrid::FeaturesGrid(const camera::IntrinsicBase* cam, const feature::Regions& regions)
+{
+  Mat2X positions;
+  feature::PointsToMat(regions.Features(), positions);
+
+  if(cam && cam->isValid())
+  {
+    Mat2X undistortedPositions;
+    cam->get_ud_pixels(positions, undistortedPositions);
+    build(undistortedPositions);
+  }
+  else
+  {
+    build(positions);
+  }
+}
+
+void FeaturesGrid::build(const Mat2X& positions)
+{
+  _positions = positions;
+  _cellOffsets.assign(1, 0);
+  _cellFeatures.clear();
+  _nbCols = 0;
+  _nbRows = 0;
+
+  // bounding box of the valid positions
+  Vec2 minPosition = Vec2::Constant(std::numeric_limits<double>::max());
+  Vec2 maxPosition = Vec2::Constant(std::numeric_limits<double>::lowest());
+  std::size_t nbValid = 0;
+  for(Mat2X::Index i = 0; i < _positions.cols(); ++i)
+  {
+    if(!_positions.col(i).allFinite())
+      continue;
+    minPosition = minPosition.cwiseMin(_positions.col(i));
+    maxPosition = maxPosition.cwiseMax(_positions.col(i));
+    ++nbValid;
+  }
+  if(nbValid == 0)
+    return;
+
+  const Vec2 extent = maxPosition - minPosition;
+  _origin = minPosition;
+  _cellSize = std::max({std::sqrt(extent(0) * extent(1) * featuresPerCell / nbValid),
+                        extent.maxCoeff() / maxCellsPerSide,
+                        1.0});
+  _nbCols = static_cast<int>(extent(0) / _cellSize) + 1;
+  _nbRows = static_cast<int>(extent(1) / _cellSize) + 1;
+
+  // features per cell, in increasing order
+  std::vector<int> cellPerFeature(_positions.cols(), -1);
+  _cellOffsets.assign(_nbCols * _nbRows + 1, 0);
+  for(Mat2X::Index i = 0; i < _positions.cols(); ++i)
+  {
+    if(!_positions.col(i).allFinite())
+      continue;
+    const int col = std::min(static_cast<int>((_positions(0, i) - _origin(0)) / _cellSize), _nbCols - 1);
+    const int row = std::min(static_cast<int>((_positions(1, i) - _origin(1)) / _cellSize), _nbRows - 1);
+    cellPerFeature[i] = row * _nbCols + col;
+    ++_cellOffsets[cellPerFeature[i] + 1];
+  }
+  for(std::size_t cell = 1; cell < _cellOffsets.size(); ++cell)
+    _cellOffsets[cell] += _cellOffsets[cell - 1];
+
+  _cellFeatures.resize(nbValid);
+  std::vector<IndexT> cellCursors(_cellOffsets.begin(), _cellOffsets.end() - 1);
+  for(std::size_t i = 0; i < cellPerFeature.size(); ++i)
+  {
+    if(cellPerFeature[i] >= 0)
+      _cellFeatures[cellCursors[cellPerFeature[i]]++] = static_cast<IndexT>(i);
+  }
+}
+
+void FeaturesGrid::getAllFeatures(std::vector<IndexT>& candidates) const
+{
+  candidates.resize(_positions.cols());
+  for(std::size_t i = 0; i < candidates.size(); ++i)
+    candidates[i] = static_cast<IndexT>(i);
+}
+
+void FeaturesGrid::getFeaturesNearLine(const Vec3& line, double maxDistance, std::vector<IndexT>& candidates) const
+{
+  candidates.clear();
+
+  const double norm = line.head<2>().norm();
+  if(norm == 0.0 || !line.allFinite())
+    return;
+
+  const double a = line(0) / norm;
+  const double b = line(1) / norm;
+  const double c = line(2) / norm;
+
+  // visit the cells along the main direction of the line,
+  // the band is |a.x + b.y + c| <= maxDistance once the line is normalized
+  if(std::abs(b) >= std::abs(a))
+  {
+    const double halfWidth = maxDistance / std::abs(b);
+    for(int col = 0; col < _nbCols; ++col)
+    {
+      const double x0 = _origin(0) + col * _cellSize;
+      const double y0 = -(a * x0 + c) / b;
+      const double y1 = -(a * (x0 + _cellSize) + c) / b;
+      appendCells(col, col,
+                  (std::min(y0, y1) - halfWidth - _origin(1)) / _cellSize,
+                  (std::max(y0, y1) + halfWidth - _origin(1)) / _cellSize,
+                  candidates);
+    }
+  }
+  else
+  {
+    const double halfWidth = maxDistance / std::abs(a);
+    for(int row = 0; row < _nbRows; ++row)
+    {
+      const double y0 = _origin(1) + row * _cellSize;
+      const double x0 = -(b * y0 + c) / a;
+      const double x1 = -(b * (y0 + _cellSize) + c) / a;
+      appendCells((std::min(x0, x1) - halfWidth - _origin(0)) / _cellSize,
+                  (std::max(x0, x1) + halfWidth - _origin(0)) / _cellSize,
+                  row, row,
+                  candidates);
+    }
+  }
+}
+
+void FeaturesGrid::getFeaturesNearPoint(const Vec2& point, double maxDistance, std::vector<IndexT>& candidates) const
+{
+  candidates.clear();
+
+  if(!point.allFinite())
+    return;
+
+  appendCells((point(0) - maxDistance - _origin(0)) / _cellSize,
+              (point(0) + maxDistance - _origin(0)) / _cellSize,
+              (point(1) - maxDistance - _origin(1)) / _cellSize,
+              (point(1) + maxDistance - _origin(1)) / _cellSize,
+              candidates);
+}
+
+void FeaturesGrid::appendCells(double colBegin, double colEnd, double rowBegin, double rowEnd, std::vector<IndexT>& candidates) const
+{
+  // clamp before the conversion, the bounds may be far outside of the grid
+  if(colEnd < 0.0 || rowEnd < 0.0 || colBegin >= _nbCols || rowBegin >= _nbRows)
+    return;
+
+  const int firstCol = static_cast<int>(std::max(colBegin, 0.0));
+  const int lastCol = static_cast<int>(std::min(colEnd, _nbCols - 1.0));
+  const int firstRow = static_cast<int>(std::max(rowBegin, 0.0));
+  const int lastRow = static_cast<int>(std::min(rowEnd, _nbRows - 1.0));
+
+  for(int row = firstRow; row <= lastRow; ++row)
+  {
+    const int rowCell = row * _nbCols;
+    candidates.insert(candidates.end(),
+                      _cellFeatures.begin() + _cellOffsets[rowCell + firstCol],
+                      _cellFeatures.begin() + _cellOffsets[rowCell + lastCol + 1]);
+  }
+}
+
+} // namespace matching
+} // namespace aliceVision
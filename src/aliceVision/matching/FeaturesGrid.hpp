@@ -0,0 +1,98 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/feature/Regions.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/camera/IntrinsicBase.hpp>
+
+#include <map>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Uniform grid of the (undistorted) features positions of one image.
+ *
+ * The grid covers the bounding box of the features with square cells holding a few features each,
+ * stored in compressed sparse rows. It answers the guided matching queries: the features close to an
+ * epipolar line and the features close to a point, without testing all the features of the image.
+ */
+class FeaturesGrid
+{
+public:
+  FeaturesGrid() = default;
+
+  /**
+   * @brief Build the grid of the given positions
+   * @param[in] positions The features positions, one column per feature
+   */
+  explicit FeaturesGrid(const Mat2X& positions) { build(positions); }
+
+  /**
+   * @brief Build the grid of the regions positions
+   * @param[in] cam Optional camera (in order to undistort the positions once, can be NULL)
+   * @param[in] regions The regions of the image
+   */
+  FeaturesGrid(const camera::IntrinsicBase* cam, const feature::Regions& regions);
+
+  /**
+   * @brief Fill the grid with the given positions
+   * @param[in] positions The features positions, one column per feature
+   */
+  void build(const Mat2X& positions);
+
+  /// @return the number of features
+  std::size_t size() const { return _positions.cols(); }
+
+  /// @return the features positions, one column per feature
+  const Mat2X& getPositions() const { return _positions; }
+
+  /**
+   * @brief Get all the features
+   * @param[out] candidates The sorted features indexes
+   */
+  void getAllFeatures(std::vector<IndexT>& candidates) const;
+
+  /**
+   * @brief Get the features of the cells crossed by a band around a line
+   * @param[in] line The line (a, b, c): a.x + b.y + c = 0
+   * @param[in] maxDistance The half width of the band
+   * @param[out] candidates The features indexes (in the cells order), a superset of the features closer than maxDistance to the line
+   */
+  void getFeaturesNearLine(const Vec3& line, double maxDistance, std::vector<IndexT>& candidates) const;
+
+  /**
+   * @brief Get the features of the cells crossed by a square around a point
+   * @param[in] point The center of the square
+   * @param[in] maxDistance The half size of the square
+   * @param[out] candidates The features indexes (in the cells order), a superset of the features closer than maxDistance to the point
+   */
+  void getFeaturesNearPoint(const Vec2& point, double maxDistance, std::vector<IndexT>& candidates) const;
+
+private:
+  /// append the features of the cells [colBegin, colEnd] x [rowBegin, rowEnd], clamped to the grid
+  void appendCells(double colBegin, double colEnd, double rowBegin, double rowEnd, std::vector<IndexT>& candidates) const;
+
+  Mat2X _positions;
+  Vec2 _origin = Vec2::Zero();
+  double _cellSize = 1.0;
+  int _nbCols = 0;
+  int _nbRows = 0;
+  /// features of each cell: _cellFeatures[_cellOffsets[cell] ... _cellOffsets[cell + 1][, sorted
+  std::vector<IndexT> _cellOffsets;
+  std::vector<IndexT> _cellFeatures;
+};
+
+using FeaturesGridPerDesc = std::map<feature::EImageDescriberType, FeaturesGrid>;
+using FeaturesGridPerView = std::map<IndexT, FeaturesGridPerDesc>;
+
+} // namespace matching
+} // namespace aliceVision
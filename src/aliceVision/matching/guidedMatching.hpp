@@ -12,10 +12,21 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/feature/Regions.hpp>
 #include <aliceVision/camera/IntrinsicBase.hpp>
+#include <aliceVision/matching/FeaturesGrid.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
+#include <algorithm>
 #include <vector>
 
 namespace aliceVision {
+
+namespace multiview {
+namespace relativePose {
+struct FundamentalEpipolarDistanceError;
+struct HomographyAsymmetricError;
+} // namespace relativePose
+} // namespace multiview
+
 namespace matching {
 
 /**
@@ -192,19 +203,67 @@ void guidedMatching(const ModelT& mod,
   matching::IndMatch::getDeduplicated(vec_corresponding_index);
 }
 
+/**
+ * @brief Select in the grid of the right features the candidates that may satisfy the geometric threshold
+ *        for a left feature, before the exact error test.
+ *        By default all the right features are candidates.
+ *
+ * @tparam ErrorT The metric to compute distance to the model
+ */
+template<typename ErrorT>
+struct GuidedMatchingCandidates
+{
+  template<typename ModelT>
+  static void get(const ModelT& mod, const Vec2& xLeft, const FeaturesGrid& rGrid, double errorTh, std::vector<IndexT>& candidates)
+  {
+    rGrid.getAllFeatures(candidates);
+  }
+};
+
+/**
+ * @brief The squared distance to the epipolar line is below the threshold in the band around the line
+ */
+template<>
+struct GuidedMatchingCandidates<multiview::relativePose::FundamentalEpipolarDistanceError>
+{
+  template<typename ModelT>
+  static void get(const ModelT& mod, const Vec2& xLeft, const FeaturesGrid& rGrid, double errorTh, std::vector<IndexT>& candidates)
+  {
+    rGrid.getFeaturesNearLine(mod.getMatrix() * xLeft.homogeneous(), std::sqrt(errorTh), candidates);
+  }
+};
+
+/**
+ * @brief The squared transfer error is below the threshold around the transferred point
+ */
+template<>
+struct GuidedMatchingCandidates<multiview::relativePose::HomographyAsymmetricError>
+{
+  template<typename ModelT>
+  static void get(const ModelT& mod, const Vec2& xLeft, const FeaturesGrid& rGrid, double errorTh, std::vector<IndexT>& candidates)
+  {
+    const Vec3 xRight = mod.getMatrix() * xLeft.homogeneous();
+    rGrid.getFeaturesNearPoint(xRight.head<2>() / xRight(2), std::sqrt(errorTh), candidates);
+  }
+};
+
 /**
  * @brief Guided Matching (features + descriptors with distance ratio):
  *        Use a model to find valid correspondences:
  *        Keep the best corresponding points for the given model under the
  *        user specified distance ratio.
  *
+ * Only the right features of the grid cells compatible with the model are tested for each left feature,
+ * their descriptors distances are computed in one batch, and the left features are processed in parallel.
+ * The matches are the same as the ones of the exhaustive search.
+ *
  * @tparam ModelT The used model type
  * @tparam ErrorT The metric to compute distance to the model
  *
  * @param[in] mod The model
- * @param[in] camL Optional camera (in order to undistord on the fly feature positions, can be NULL)
+ * @param[in] lGrid grid of the (undistorted) left regions positions
  * @param[in] lRegions regions (point features & corresponding descriptors)
- * @param[in] camR Optional camera (in order to undistord on the fly feature positions, can be NULL)
+ * @param[in] rGrid grid of the (undistorted) right regions positions
  * @param[in] rRegions regions (point features & corresponding descriptors)
  * @param[in] errorTh Maximal authorized error threshold
  * @param[in] distRatio Maximal authorized distance ratio
@@ -212,71 +271,149 @@ void guidedMatching(const ModelT& mod,
  */
 template<typename ModelT, typename ErrorT>
 void guidedMatching(const ModelT& mod,
-                    const camera::IntrinsicBase* camL,
+                    const FeaturesGrid& lGrid,
                     const feature::Regions& lRegions,
-                    const camera::IntrinsicBase* camR,
+                    const FeaturesGrid& rGrid,
                     const feature::Regions& rRegions,
                     double errorTh,
                     double distRatio,
                     matching::IndMatches& out_matches)
 {
+  assert(lGrid.size() == lRegions.RegionCount());
+  assert(rGrid.size() == rRegions.RegionCount());
+
   // looking for the corresponding points that have to satisfy:
   //   1. a geometric distance below the provided Threshold
   //   2. a distance ratio between descriptors of valid geometric correspondencess
 
   const ErrorT errorEstimator = ErrorT();
+  const Mat2X& lPositions = lGrid.getPositions();
+  const Mat2X& rPositions = rGrid.getPositions();
+  const int nbLeft = static_cast<int>(lRegions.RegionCount());
 
-  // build region positions arrays (in order to un-distord on-demand point position once)
-  std::vector<Vec2> lRegionsPos(lRegions.RegionCount());
-  std::vector<Vec2> rRegionsPos(rRegions.RegionCount());
+  // best right feature of each left feature
+  std::vector<IndexT> matchPerLeft(nbLeft, UndefinedIndexT);
 
-  if(camL && camL->isValid())
-  {
-    for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
-      lRegionsPos[i] = camL->get_ud_pixel(lRegions.GetRegionPosition(i));
-  }
-  else
-  {
-    for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
-      lRegionsPos[i] = lRegions.GetRegionPosition(i);
-  }
-  if(camR && camR->isValid())
-  {
-    for(std::size_t i = 0; i < rRegions.RegionCount(); ++i)
-      rRegionsPos[i] = camR->get_ud_pixel(rRegions.GetRegionPosition(i));
-  }
-  else
+  // small pairs are not worth the threads
+  #pragma omp parallel if(nbLeft > 1000)
   {
-    for(std::size_t i = 0; i < rRegions.RegionCount(); ++i)
-      rRegionsPos[i] = rRegions.GetRegionPosition(i);
-  }
+    std::vector<IndexT> candidates;
+    std::vector<double> distances;
 
-  for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
-  {
-    distanceRatio<double> dR;
-    for(std::size_t j = 0; j < rRegions.RegionCount(); ++j)
+    #pragma omp for schedule(dynamic, 64)
+    for(int i = 0; i < nbLeft; ++i)
     {
-      // compute the geometric error: error to the model
-      const double geomErr = errorEstimator.error(mod, lRegionsPos[i], rRegionsPos[j]);
+      const Vec2 xLeft = lPositions.col(i);
+      GuidedMatchingCandidates<ErrorT>::get(mod, xLeft, rGrid, errorTh, candidates);
 
-      if(geomErr < errorTh)
+      // compute the geometric error: error to the model
+      candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](IndexT j)
       {
-        // update the corresponding points & distance (if required)
-        dR.update(j, lRegions.SquaredDescriptorDistance(i, &rRegions, j));
-      }
-    }
-    // add correspondence only iff the distance ratio is valid
-    if(dR.isValid(distRatio))
-    {
-      // save the best corresponding index
-      out_matches.emplace_back(i, dR.idx);
+        return !(errorEstimator.error(mod, xLeft, Vec2(rPositions.col(j))) < errorTh);
+      }), candidates.end());
+
+      // the distance ratio needs two candidates
+      if(candidates.size() < 2)
+        continue;
+
+      // same order as the exhaustive search, for the ties of the distance ratio
+      std::sort(candidates.begin(), candidates.end());
+      lRegions.SquaredDescriptorDistances(i, &rRegions, candidates, distances);
+
+      // update the corresponding points & distance
+      distanceRatio<double> dR;
+      for(std::size_t k = 0; k < candidates.size(); ++k)
+        dR.update(candidates[k], distances[k]);
+
+      // add correspondence only iff the distance ratio is valid
+      if(dR.isValid(distRatio))
+        matchPerLeft[i] = static_cast<IndexT>(dR.idx);
     }
   }
 
+  for(int i = 0; i < nbLeft; ++i)
+  {
+    if(matchPerLeft[i] != UndefinedIndexT)
+      out_matches.emplace_back(i, matchPerLeft[i]);
+  }
+
   // remove duplicates (when multiple points at same position exist)
   matching::IndMatch::getDeduplicated(out_matches);
 }
 
+/**
+ * @brief Guided Matching (features + descriptors with distance ratio):
+ *        Use a model to find valid correspondences:
+ *        Keep the best corresponding points for the given model under the
+ *        user specified distance ratio.
+ *
+ * @tparam ModelT The used model type
+ * @tparam ErrorT The metric to compute distance to the model
+ *
+ * @param[in] mod The model
+ * @param[in] camL Optional camera (in order to undistord on the fly feature positions, can be NULL)
+ * @param[in] lRegions regions (point features & corresponding descriptors)
+ * @param[in] camR Optional camera (in order to undistord on the fly feature positions, can be NULL)
+ * @param[in] rRegions regions (point features & corresponding descriptors)
+ * @param[in] errorTh Maximal authorized error threshold
+ * @param[in] distRatio Maximal authorized distance ratio
+ * @param[out] out_matches Ouput corresponding index
+ */
+template<typename ModelT, typename ErrorT>
+void guidedMatching(const ModelT& mod,
+                    const camera::IntrinsicBase* camL,
+                    const feature::Regions& lRegions,
+                    const camera::IntrinsicBase* camR,
+                    const feature::Regions& rRegions,
+                    double errorTh,
+                    double distRatio,
+                    matching::IndMatches& out_matches)
+{
+  // build region positions grids (in order to un-distord on-demand point position once)
+  const FeaturesGrid lGrid(camL, lRegions);
+  const FeaturesGrid rGrid(camR, rRegions);
+
+  guidedMatching<ModelT, ErrorT>(mod, lGrid, lRegions, rGrid, rRegions, errorTh, distRatio, out_matches);
+}
+
+/**
+ * @brief Guided Matching (features + descriptors with distance ratio):
+ *        Use a model to find valid correspondences:
+ *        Keep the best corresponding points for the given model under the
+ *        user specified distance ratio.
+ *
+ * @tparam ModelT The used model type
+ * @tparam ErrorT The metric to compute distance to the model
+ *
+ * @param[in] mod The model
+ * @param[in] lGrids grids of the (undistorted) left regions positions, per describer type
+ * @param[in] lRegions regions (point features & corresponding descriptors)
+ * @param[in] rGrids grids of the (undistorted) right regions positions, per describer type
+ * @param[in] rRegions regions (point features & corresponding descriptors)
+ * @param[in] errorTh Maximal authorized error threshold
+ * @param[in] distRatio Maximal authorized distance ratio
+ * @param[out] out_matchesPerDesc Ouput corresponding index
+ */
+template<typename ModelT, typename ErrorT>
+void guidedMatching(const ModelT& mod,
+                    const FeaturesGridPerDesc& lGrids,
+                    const feature::MapRegionsPerDesc& lRegions,
+                    const FeaturesGridPerDesc& rGrids,
+                    const feature::MapRegionsPerDesc& rRegions,
+                    double errorTh,
+                    double distRatio,
+                    matching::MatchesPerDescType& out_matchesPerDesc)
+{
+  const std::vector<feature::EImageDescriberType> descTypes = getCommonDescTypes(lRegions, rRegions);
+  if(descTypes.empty())
+    return;
+
+  for(const feature::EImageDescriberType descType: descTypes)
+  {
+    guidedMatching<ModelT, ErrorT>(mod, lGrids.at(descType), *lRegions.at(descType), rGrids.at(descType), *rRegions.at(descType), errorTh, distRatio, out_matchesPerDesc[descType]);
+  }
+}
+
 /**
  * @brief Guided Matching (features + descriptors with distance ratio):
  *        Use a model to find valid correspondences:
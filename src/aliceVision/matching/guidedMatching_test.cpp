@@ -0,0 +1,210 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matching/guidedMatching.hpp>
+#include <aliceVision/multiview/relativePose/FundamentalError.hpp>
+#include <aliceVision/multiview/relativePose/HomographyError.hpp>
+#include <aliceVision/robustEstimation/ISolver.hpp>
+
+#define BOOST_TEST_MODULE matchingGuidedMatching
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::matching;
+
+namespace {
+
+using RegionsT = feature::ScalarRegions<unsigned char, 128>;
+
+const double width = 2000.0;
+const double height = 1500.0;
+
+/// random regions in the image, with random descriptors
+void addRandomRegions(std::mt19937& generator, std::size_t nbRegions, RegionsT& regions)
+{
+  std::uniform_real_distribution<float> x(0.f, width);
+  std::uniform_real_distribution<float> y(0.f, height);
+  std::uniform_int_distribution<int> value(0, 255);
+
+  for(std::size_t i = 0; i < nbRegions; ++i)
+  {
+    regions.Features().emplace_back(x(generator), y(generator), 1.f, 0.f);
+    RegionsT::DescriptorT descriptor;
+    for(std::size_t d = 0; d < RegionsT::DescriptorT::static_size; ++d)
+      descriptor[d] = value(generator);
+    regions.Descriptors().push_back(descriptor);
+  }
+}
+
+/**
+ * @brief Left and right regions: the first half of the left regions are seen in the right image at the
+ * position given by transfer(), with a noisy copy of their descriptor, the others regions are random.
+ */
+template<typename TransferT>
+void generatePair(std::size_t nbRegions, TransferT transfer, RegionsT& lRegions, RegionsT& rRegions)
+{
+  std::mt19937 generator(42);
+  std::normal_distribution<float> noise(0.f, 0.3f);
+  std::uniform_int_distribution<int> descNoise(-5, 5);
+
+  addRandomRegions(generator, nbRegions, lRegions);
+  for(std::size_t i = 0; i < nbRegions / 2; ++i)
+  {
+    const Vec2 x = transfer(lRegions.GetRegionPosition(i), generator);
+    rRegions.Features().emplace_back(x(0) + noise(generator), x(1) + noise(generator), 1.f, 0.f);
+    RegionsT::DescriptorT descriptor = lRegions.Descriptors()[i];
+    for(std::size_t d = 0; d < RegionsT::DescriptorT::static_size; ++d)
+      descriptor[d] = std::min(255, std::max(0, descriptor[d] + descNoise(generator)));
+    rRegions.Descriptors().push_back(descriptor);
+  }
+  addRandomRegions(generator, nbRegions - nbRegions / 2, rRegions);
+}
+
+/// exhaustive search: all the right regions are tested for each left region
+template<typename ErrorT>
+void exhaustiveGuidedMatching(const robustEstimation::Mat3Model& mod, const feature::Regions& lRegions, const feature::Regions& rRegions,
+                              double errorTh, double distRatio, IndMatches& out_matches)
+{
+  const ErrorT errorEstimator = ErrorT();
+  for(std::size_t i = 0; i < lRegions.RegionCount(); ++i)
+  {
+    distanceRatio<double> dR;
+    for(std::size_t j = 0; j < rRegions.RegionCount(); ++j)
+    {
+      if(errorEstimator.error(mod, lRegions.GetRegionPosition(i), rRegions.GetRegionPosition(j)) < errorTh)
+        dR.update(j, lRegions.SquaredDescriptorDistance(i, &rRegions, j));
+    }
+    if(dR.isValid(distRatio))
+      out_matches.emplace_back(i, dR.idx);
+  }
+  IndMatch::getDeduplicated(out_matches);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(FeaturesGrid_queries)
+{
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> x(-100.0, width);
+  std::uniform_real_distribution<double> y(-100.0, height);
+  std::uniform_real_distribution<double> angle(0.0, M_PI);
+
+  Mat2X positions(2, 5000);
+  for(Mat2X::Index i = 0; i < positions.cols(); ++i)
+    positions.col(i) = Vec2(x(generator), y(generator));
+
+  const FeaturesGrid grid(positions);
+  BOOST_CHECK_EQUAL(grid.size(), positions.cols());
+
+  std::vector<IndexT> candidates;
+  for(int test = 0; test < 100; ++test)
+  {
+    const double maxDistance = 1.0 + test % 10;
+
+    // the candidates contain all the features close to the line
+    const double theta = angle(generator);
+    const Vec2 point(x(generator), y(generator));
+    const Vec3 line(std::cos(theta), std::sin(theta), -std::cos(theta) * point(0) - std::sin(theta) * point(1));
+    grid.getFeaturesNearLine(3.0 * line, maxDistance, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    BOOST_CHECK(std::adjacent_find(candidates.begin(), candidates.end()) == candidates.end());
+    BOOST_CHECK(candidates.size() < positions.cols() / 4);
+    for(Mat2X::Index i = 0; i < positions.cols(); ++i)
+    {
+      if(std::abs(line.dot(positions.col(i).homogeneous())) <= maxDistance)
+        BOOST_CHECK(std::binary_search(candidates.begin(), candidates.end(), i));
+    }
+
+    // the candidates contain all the features close to the point
+    grid.getFeaturesNearPoint(point, maxDistance, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    BOOST_CHECK(std::adjacent_find(candidates.begin(), candidates.end()) == candidates.end());
+    for(Mat2X::Index i = 0; i < positions.cols(); ++i)
+    {
+      if((positions.col(i) - point).norm() <= maxDistance)
+        BOOST_CHECK(std::binary_search(candidates.begin(), candidates.end(), i));
+    }
+  }
+
+  // degenerated inputs
+  grid.getFeaturesNearLine(Vec3(0.0, 0.0, 1.0), 1.0, candidates);
+  BOOST_CHECK(candidates.empty());
+  grid.getFeaturesNearPoint(Vec2(std::numeric_limits<double>::infinity(), 0.0), 1.0, candidates);
+  BOOST_CHECK(candidates.empty());
+
+  const FeaturesGrid emptyGrid((Mat2X(2, 0)));
+  emptyGrid.getFeaturesNearPoint(Vec2(0.0, 0.0), 10.0, candidates);
+  BOOST_CHECK(candidates.empty());
+}
+
+BOOST_AUTO_TEST_CASE(guidedMatching_fundamental)
+{
+  // F = [e2]x.H: the transfer of x by H is on its epipolar line
+  Mat3 H;
+  H << 1.05, 0.02, 30.0,
+      -0.01, 0.98, -20.0,
+       1e-5, 2e-5, 1.0;
+  const Vec3 e2(-500.0, 700.0, 1.0);
+  const robustEstimation::Mat3Model model(CrossProductMatrix(e2) * H);
+
+  RegionsT lRegions, rRegions;
+  generatePair(4000, [&](const Vec2& x, std::mt19937& generator)
+  {
+    // anywhere on the epipolar line
+    std::uniform_real_distribution<double> t(-0.2, 0.2);
+    const Vec2 xH = (H * x.homogeneous()).hnormalized();
+    return Vec2(xH + t(generator) * (xH - e2.head<2>()));
+  }, lRegions, rRegions);
+
+  const double errorTh = Square(2.0);
+  const double distRatio = Square(0.8);
+
+  IndMatches expectedMatches;
+  exhaustiveGuidedMatching<multiview::relativePose::FundamentalEpipolarDistanceError>(model, lRegions, rRegions, errorTh, distRatio, expectedMatches);
+
+  IndMatches matches;
+  guidedMatching<robustEstimation::Mat3Model, multiview::relativePose::FundamentalEpipolarDistanceError>(
+        model, nullptr, lRegions, nullptr, rRegions, errorTh, distRatio, matches);
+
+  BOOST_CHECK_GT(expectedMatches.size(), 1000);
+  BOOST_CHECK(matches == expectedMatches);
+}
+
+BOOST_AUTO_TEST_CASE(guidedMatching_homography)
+{
+  Mat3 H;
+  H << 0.95, -0.1, 50.0,
+       0.1, 0.95, -30.0,
+       -1e-5, 1e-5, 1.0;
+  const robustEstimation::Mat3Model model(H);
+
+  RegionsT lRegions, rRegions;
+  generatePair(4000, [&](const Vec2& x, std::mt19937&)
+  {
+    return Vec2((H * x.homogeneous()).hnormalized());
+  }, lRegions, rRegions);
+
+  const double errorTh = Square(30.0);
+  const double distRatio = Square(0.8);
+
+  IndMatches expectedMatches;
+  exhaustiveGuidedMatching<multiview::relativePose::HomographyAsymmetricError>(model, lRegions, rRegions, errorTh, distRatio, expectedMatches);
+
+  // grids built once, as done per view by the geometric filter
+  const FeaturesGrid lGrid(nullptr, lRegions);
+  const FeaturesGrid rGrid(nullptr, rRegions);
+
+  IndMatches matches;
+  guidedMatching<robustEstimation::Mat3Model, multiview::relativePose::HomographyAsymmetricError>(
+        model, lGrid, lRegions, rGrid, rRegions, errorTh, distRatio, matches);
+
+  BOOST_CHECK_GT(expectedMatches.size(), 1000);
+  BOOST_CHECK(matches == expectedMatches);
+}
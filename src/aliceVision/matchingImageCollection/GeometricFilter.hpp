@@ -12,6 +12,8 @@
 #include <aliceVision/feature/RegionsPerView.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
+#include <aliceVision/matchingImageCollection/geometricFilterUtils.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #include <boost/progress.hpp>
 
@@ -46,8 +48,14 @@ void robustModelEstimation(
   const bool guidedMatching = false,
   const double distanceRatio = 0.6)
 {
+  ALICEVISION_TRACE_ZONE("matching::geometricFilter");
   out_geometricMatches.clear();
 
+  // undistort the features and build their grids once per view, rather than for each pair
+  matching::FeaturesGridPerView featuresGrids;
+  if(guidedMatching)
+    buildFeaturesGrids(sfmData, regionsPerView, putativeMatches, featuresGrids);
+
   boost::progress_display progressBar(putativeMatches.size(), std::cout, "Robust Model Estimation\n");
   
 #pragma omp parallel for schedule(dynamic)
@@ -70,7 +78,7 @@ void robustModelEstimation(
         if(guidedMatching)
         {
           MatchesPerDescType guidedGeometricInliers;
-          geometricFilter.Geometry_guided_matching(sfmData, regionsPerView, imagePair, distanceRatio, guidedGeometricInliers);
+          geometricFilter.Geometry_guided_matching(sfmData, regionsPerView, featuresGrids, imagePair, distanceRatio, guidedGeometricInliers);
           //ALICEVISION_LOG_DEBUG("#before/#after: " << putative_inliers.size() << "/" << guided_geometric_inliers.size());
           std::swap(inliers, guidedGeometricInliers);
         }
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <aliceVision/matching/FeaturesGrid.hpp>
+
 namespace aliceVision {
 
 
@@ -40,6 +42,7 @@ struct GeometricFilterMatrix
    * @brief Geometry_guided_matching
    * @param sfm_data
    * @param regionsPerView
+   * @param featuresGrids grids of the undistorted features of the views, built once per view
    * @param pairIndex
    * @param dDistanceRatio
    * @param matches
@@ -49,6 +52,7 @@ struct GeometricFilterMatrix
   (
     const sfmData::SfMData * sfmData,
     const feature::RegionsPerView& regionsPerView,
+    const matching::FeaturesGridPerView& featuresGrids,
     const Pair imageIdsPair,
     const double dDistanceRatio,
     matching::MatchesPerDescType & matches
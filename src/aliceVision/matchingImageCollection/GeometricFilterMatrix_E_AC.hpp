@@ -120,6 +120,7 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
    * @brief Geometry_guided_matching
    * @param sfmData
    * @param regionsPerView
+   * @param featuresGrids
    * @param imageIdsPair
    * @param dDistanceRatio
    * @param matches
@@ -127,6 +128,7 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
    */
   bool Geometry_guided_matching(const sfmData::SfMData* sfmData,
                                 const feature::RegionsPerView& regionsPerView,
+                                const matching::FeaturesGridPerView& featuresGrids,
                                 const Pair imageIdsPair,
                                 const double dDistanceRatio,
                                 matching::MatchesPerDescType& matches) override
@@ -161,8 +163,8 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
       // multiview::relativePose::FundamentalSymmetricEpipolarDistanceError
       matching::guidedMatching<robustEstimation::Mat3Model, multiview::relativePose::FundamentalEpipolarDistanceError>(
             model,
-            camI, regionsPerView.getAllRegions(I),
-            camJ, regionsPerView.getAllRegions(J),
+            featuresGrids.at(I), regionsPerView.getAllRegions(I),
+            featuresGrids.at(J), regionsPerView.getAllRegions(J),
             Square(m_dPrecision_robust), Square(dDistanceRatio),
             matches);
     }
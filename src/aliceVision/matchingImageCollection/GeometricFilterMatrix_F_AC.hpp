@@ -338,6 +338,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
    * @brief Geometry_guided_matching
    * @param sfmData
    * @param regionsPerView
+   * @param featuresGrids
    * @param imagesPair
    * @param dDistanceRatio
    * @param matches
@@ -345,6 +346,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
    */
   bool Geometry_guided_matching(const sfmData::SfMData* sfmData,
                                 const feature::RegionsPerView& regionsPerView,
+                                const matching::FeaturesGridPerView& featuresGrids,
                                 const Pair imageIdsPair,
                                 const double dDistanceRatio,
                                 matching::MatchesPerDescType& matches) override
@@ -355,23 +357,15 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
       const IndexT I = imageIdsPair.first;
       const IndexT J = imageIdsPair.second;
 
-      const sfmData::View& viewI = sfmData->getView(I);
-      const sfmData::View& viewJ = sfmData->getView(J);
-
-      // retrieve corresponding pair camera intrinsic if any
-      const camera::IntrinsicBase* camI = sfmData->getIntrinsics().count(viewI.getIntrinsicId()) ?
-                                          sfmData->getIntrinsics().at(viewI.getIntrinsicId()).get() : nullptr;
-      const camera::IntrinsicBase* camJ = sfmData->getIntrinsics().count(viewJ.getIntrinsicId()) ?
-                                          sfmData->getIntrinsics().at(viewJ.getIntrinsicId()).get() : nullptr;
-
+      // the features positions are undistorted once per view in the grids
       robustEstimation::Mat3Model model(m_F);
 
       // check the features correspondences that agree in the geometric and photometric domain
       matching::guidedMatching<robustEstimation::Mat3Model, multiview::relativePose::FundamentalEpipolarDistanceError>(
         model,
-        camI,                            // camera::IntrinsicBase
+        featuresGrids.at(I),             // matching::FeaturesGridPerDesc
         regionsPerView.getAllRegions(I), // feature::Regions
-        camJ,                            // camera::IntrinsicBase
+        featuresGrids.at(J),             // matching::FeaturesGridPerDesc
         regionsPerView.getAllRegions(J), // feature::Regions
         Square(m_dPrecision_robust), Square(dDistanceRatio),
         matches);
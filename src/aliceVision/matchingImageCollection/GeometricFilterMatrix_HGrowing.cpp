@@ -6,10 +6,24 @@
 
 #include <aliceVision/matching/svgVisualization.hpp>
 #include "GeometricFilterMatrix_HGrowing.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
 
 namespace aliceVision {
 namespace matchingImageCollection {
 
+namespace {
+
+/// Result of the homography growing from one seed match
+struct SeedGrowth
+{
+  bool grown = false;
+  std::vector<IndexT> planarMatchesId;
+  Mat3 homography;
+};
+
+} // namespace
 
 bool GeometricFilterMatrix_HGrowing::getMatches(const feature::EImageDescriberType &descType,
                                                 const IndexT homographyId, matching::IndMatches &matches) const
@@ -65,7 +79,7 @@ bool growHomography(const std::vector<feature::PointFeature> &featuresI,
                     const std::vector<feature::PointFeature> &featuresJ,
                     const matching::IndMatches &matches,
                     const IndexT &seedMatchId,
-                    std::set<IndexT> &planarMatchesIndices, Mat3 &transformation,
+                    std::vector<IndexT> &planarMatchesIndices, Mat3 &transformation,
                     const GrowParameters& param)
 {
   assert(seedMatchId <= matches.size());
@@ -123,49 +137,64 @@ void filterMatchesByHGrowing(const std::vector<feature::PointFeature>& siofeatur
   using namespace aliceVision::matching;
 
   IndMatches remainingMatches = putativeMatches;
-  GeometricFilterMatrix_HGrowing dummy;
+
+  // the seeds are grown by rounds of a few seeds per thread
+  const int nbSeedsPerRound = 4 * omp_get_max_threads();
+  std::vector<SeedGrowth> roundGrowths(nbSeedsPerRound);
 
   for(IndexT iH = 0; iH < param._maxNbHomographies; ++iH)
   {
-    std::set<IndexT> usedMatchesId, bestMatchesId;
+    // one flag per remaining match
+    std::vector<char> usedMatches(remainingMatches.size(), 0);
+    std::vector<IndexT> bestMatchesId;
     Mat3 bestHomography;
 
     // -- Estimate H using homography-growing approach
-    #pragma omp parallel for // (huge optimization but modify results a little)
-    for(int iMatch = 0; iMatch < remainingMatches.size(); ++iMatch)
+    for(int roundBegin = 0; roundBegin < remainingMatches.size(); roundBegin += nbSeedsPerRound)
     {
-      // Growing a homography from one match ([F.Srajer, 2016] algo. 1, p. 20)
-      // each match is used once only per homography estimation (increases computation time) [1st improvement ([F.Srajer, 2016] p. 20) ]
-      if (usedMatchesId.find(iMatch) != usedMatchesId.end())
-        continue;
-      std::set<IndexT> planarMatchesId; // be careful: it contains the id. in the 'remainingMatches' vector not 'putativeMatches' vector.
-      Mat3 homography;
-
-      if (!growHomography(siofeatures_I,
-                          siofeatures_J,
-                          remainingMatches,
-                          iMatch,
-                          planarMatchesId,
-                          homography,
-                          param._growParam))
+      const int roundEnd = std::min(roundBegin + nbSeedsPerRound, static_cast<int>(remainingMatches.size()));
+
+      #pragma omp parallel for schedule(dynamic)
+      for(int iMatch = roundBegin; iMatch < roundEnd; ++iMatch)
       {
-        continue;
+        SeedGrowth& growth = roundGrowths[iMatch - roundBegin];
+        // each match is used once only per homography estimation (increases computation time) [1st improvement ([F.Srajer, 2016] p. 20) ]
+        // usedMatches is only written between the rounds
+        growth.grown = !usedMatches[iMatch] &&
+                       // Growing a homography from one match ([F.Srajer, 2016] algo. 1, p. 20)
+                       // be careful: planarMatchesId contains the id. in the 'remainingMatches' vector not 'putativeMatches' vector.
+                       growHomography(siofeatures_I,
+                                      siofeatures_J,
+                                      remainingMatches,
+                                      iMatch,
+                                      growth.planarMatchesId,
+                                      growth.homography,
+                                      param._growParam);
       }
 
-      #pragma omp critical
-      usedMatchesId.insert(planarMatchesId.begin(), planarMatchesId.end());
-
-      if (planarMatchesId.size() > bestMatchesId.size())
+      // merge the round in the seeds order, as the sequential loop does:
+      // a seed used by a previous seed of the same round is discarded
+      for(int iMatch = roundBegin; iMatch < roundEnd; ++iMatch)
       {
-        #pragma omp critical
+        SeedGrowth& growth = roundGrowths[iMatch - roundBegin];
+        if(!growth.grown || usedMatches[iMatch])
+          continue;
+
+        for(IndexT id : growth.planarMatchesId)
+          usedMatches[id] = 1;
+
+        if(growth.planarMatchesId.size() > bestMatchesId.size())
         {
-          // if(iH == 3) { std::cout << "best iMatch" << iMatch << std::endl; }
-          bestMatchesId = planarMatchesId; // be careful: it contains the id. in the 'remainingMatches' vector not 'putativeMatches' vector.
-          bestHomography = homography;
+          bestMatchesId.swap(growth.planarMatchesId);
+          bestHomography = growth.homography;
         }
       }
     } // 'iMatch'
 
+    // no homography found
+    if(bestMatchesId.empty())
+      break;
+
     // -- Refine H using Ceres minimizer
     refineHomography(siofeatures_I, siofeatures_J, remainingMatches, bestHomography, bestMatchesId, param._growParam._homographyTolerance);
 
@@ -191,11 +220,18 @@ void filterMatchesByHGrowing(const std::vector<feature::PointFeature>& siofeatur
     }
 
     // update remaining matches (/!\ Keep ordering)
-    std::size_t cpt = 0;
-    for (IndexT id : bestMatchesId)
     {
-      remainingMatches.erase(remainingMatches.begin() + id - cpt);
-      ++cpt;
+      std::vector<char> isBestMatch(remainingMatches.size(), 0);
+      for (IndexT id : bestMatchesId)
+        isBestMatch[id] = 1;
+
+      std::size_t cpt = 0;
+      for (std::size_t id = 0; id < remainingMatches.size(); ++id)
+      {
+        if (!isBestMatch[id])
+          remainingMatches[cpt++] = remainingMatches[id];
+      }
+      remainingMatches.resize(cpt);
     }
 
     // stop when the number of remaining matches is too small
@@ -76,7 +76,7 @@ struct GrowParameters
  * @param[in] featuresJ The features of the second view.
  * @param[in] matches All the putative planar matches.
  * @param[in] seedMatchId The match used to estimate the plane and the corresponding matches.
- * @param[out] planarMatchesIndices The indices (in the \c matches vector) of the really planar matches.
+ * @param[out] planarMatchesIndices The sorted indices (in the \c matches vector) of the really planar matches.
  * @param[out] transformation The homography associated to the plane.
  * @param[in] param The parameters of the algorihm.
  * @return true if the \c transformation is different than the identity matrix.
@@ -85,7 +85,7 @@ bool growHomography(const std::vector<feature::PointFeature> &featuresI,
                     const std::vector<feature::PointFeature> &featuresJ,
                     const matching::IndMatches &matches,
                     const IndexT &seedMatchId,
-                    std::set<IndexT> &planarMatchesIndices,
+                    std::vector<IndexT> &planarMatchesIndices,
                     Mat3 &transformation,
                     const GrowParameters& param);
 
@@ -110,6 +110,9 @@ struct HGrowingFilteringParam
 
 /**
  * @brief Filter the matches between two images using a growing homography approach.
+ * @details The homographies are grown from the seed matches in parallel, by rounds of consecutive seeds,
+ * and the results of each round are merged in the seeds order: the output is the same as the one
+ * of the sequential algorithm, whatever the number of threads.
  * @param[in] featuresI The features of the first view.
  * @param[in] featuresJ The features of the second view.
  * @param[in] putativeMatches The putative matches.
@@ -274,6 +277,7 @@ struct GeometricFilterMatrix_HGrowing : public GeometricFilterMatrix
    * @brief Geometry_guided_matching
    * @param sfm_data
    * @param regionsPerView
+   * @param featuresGrids
    * @param pairIndex
    * @param dDistanceRatio
    * @param matches
@@ -281,6 +285,7 @@ struct GeometricFilterMatrix_HGrowing : public GeometricFilterMatrix
    */
   bool Geometry_guided_matching(const sfmData::SfMData *sfmData,
                                 const feature::RegionsPerView &regionsPerView,
+                                const matching::FeaturesGridPerView& featuresGrids,
                                 const Pair imageIdsPair,
                                 const double dDistanceRatio,
                                 matching::MatchesPerDescType &matches) override
@@ -154,6 +154,7 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
    * @brief Geometry_guided_matching
    * @param sfm_data
    * @param regionsPerView
+   * @param featuresGrids
    * @param pairIndex
    * @param dDistanceRatio
    * @param matches
@@ -161,6 +162,7 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
    */
   bool Geometry_guided_matching(const sfmData::SfMData* sfmData,
                                 const feature::RegionsPerView& regionsPerView,
+                                const matching::FeaturesGridPerView& featuresGrids,
                                 const Pair imageIdsPair,
                                 const double dDistanceRatio,
                                 matching::MatchesPerDescType& matches) override
@@ -216,8 +218,8 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
       {
         // filtering based on region positions and regions descriptors
         matching::guidedMatching<robustEstimation::Mat3Model, multiview::relativePose::HomographyAsymmetricError>(model,
-                                                                 camI, regionsPerView.getAllRegions(I),
-                                                                 camJ, regionsPerView.getAllRegions(J),
+                                                                 featuresGrids.at(I), regionsPerView.getAllRegions(I),
+                                                                 featuresGrids.at(J), regionsPerView.getAllRegions(J),
                                                                  Square(m_dPrecision_robust), Square(dDistanceRatio),
                                                                  matches);
       }
@@ -12,6 +12,7 @@
 #include <aliceVision/matching/RegionsMatcher.hpp>
 #include <aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp>
 #include <aliceVision/config.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #include <boost/progress.hpp>
 
@@ -35,6 +36,7 @@ void ImageCollectionMatcher_generic::Match(
   feature::EImageDescriberType descType,
   matching::PairwiseMatches & map_PutativesMatches)const // the pairwise photometric corresponding points
 {
+  ALICEVISION_TRACE_ZONE("matching::putativeMatching");
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_OPENMP)
   ALICEVISION_LOG_DEBUG("Using the OPENMP thread interface");
 #endif
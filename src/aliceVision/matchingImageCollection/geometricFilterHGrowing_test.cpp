@@ -0,0 +1,149 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_HGrowing.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#define BOOST_TEST_MODULE matchingImageCollectionHGrowing
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+/// matches between two views of two planes seen with a different similarity and a little perspective, and random outliers
+struct PlanarPair
+{
+  std::vector<feature::PointFeature> featuresI;
+  std::vector<feature::PointFeature> featuresJ;
+  matching::IndMatches matches;
+  /// plane of each match, -1 for the outliers
+  std::vector<int> planePerMatch;
+};
+
+PlanarPair generatePlanarPair(std::size_t nbMatchesPerPlane, std::size_t nbOutliers)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> coordinate(0.f, 500.f);
+  std::uniform_real_distribution<float> scale(1.f, 5.f);
+  std::uniform_real_distribution<float> orientation(-3.f, 3.f);
+  std::normal_distribution<float> noise(0.f, 0.3f);
+
+  const double angles[2] = {0.1, -0.2};
+  const double scales[2] = {1.1, 0.9};
+  const Vec2 translations[2] = {Vec2(30.0, -20.0), Vec2(-50.0, 40.0)};
+
+  PlanarPair pair;
+  for(int plane = 0; plane < 2; ++plane)
+  {
+    Mat3 H;
+    H << scales[plane] * std::cos(angles[plane]), -scales[plane] * std::sin(angles[plane]), translations[plane](0),
+         scales[plane] * std::sin(angles[plane]),  scales[plane] * std::cos(angles[plane]), translations[plane](1),
+         1e-5, -1e-5, 1.0;
+
+    for(std::size_t i = 0; i < nbMatchesPerPlane; ++i)
+    {
+      // the second plane is on the right side of the first image
+      const Vec2 x(coordinate(generator) + 500.f * plane, coordinate(generator));
+      const Vec2 y = (H * x.homogeneous()).hnormalized();
+      const float s = scale(generator);
+      const float o = orientation(generator);
+      pair.featuresI.emplace_back(x(0), x(1), s, o);
+      pair.featuresJ.emplace_back(y(0) + noise(generator), y(1) + noise(generator), s * scales[plane], o + angles[plane]);
+      pair.planePerMatch.push_back(plane);
+    }
+  }
+  for(std::size_t i = 0; i < nbOutliers; ++i)
+  {
+    pair.featuresI.emplace_back(2.f * coordinate(generator), coordinate(generator), scale(generator), orientation(generator));
+    pair.featuresJ.emplace_back(2.f * coordinate(generator), coordinate(generator), scale(generator), orientation(generator));
+    pair.planePerMatch.push_back(-1);
+  }
+
+  for(IndexT i = 0; i < pair.featuresI.size(); ++i)
+    pair.matches.emplace_back(i, i);
+
+  // mix the planes and the outliers
+  std::vector<std::size_t> order(pair.matches.size());
+  for(std::size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::shuffle(order.begin(), order.end(), generator);
+
+  matching::IndMatches matches;
+  std::vector<int> planePerMatch;
+  for(std::size_t i : order)
+  {
+    matches.push_back(pair.matches[i]);
+    planePerMatch.push_back(pair.planePerMatch[i]);
+  }
+  pair.matches.swap(matches);
+  pair.planePerMatch.swap(planePerMatch);
+  return pair;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_growHomography)
+{
+  const PlanarPair pair = generatePlanarPair(100, 40);
+
+  // a match of a plane finds the matches of its plane
+  const IndexT seed = std::find_if(pair.planePerMatch.begin(), pair.planePerMatch.end(), [](int plane) { return plane != -1; }) - pair.planePerMatch.begin();
+
+  std::vector<IndexT> planarMatchesId;
+  Mat3 H;
+  BOOST_REQUIRE(growHomography(pair.featuresI, pair.featuresJ, pair.matches, seed, planarMatchesId, H, GrowParameters()));
+  BOOST_CHECK(std::is_sorted(planarMatchesId.begin(), planarMatchesId.end()));
+
+  std::size_t nbSamePlane = 0;
+  for(IndexT id : planarMatchesId)
+    nbSamePlane += (pair.planePerMatch[id] == pair.planePerMatch[seed]);
+  BOOST_CHECK_GE(nbSamePlane, 95);
+  BOOST_CHECK_LE(planarMatchesId.size() - nbSamePlane, 5);
+}
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_filterMatchesByHGrowing)
+{
+  const PlanarPair pair = generatePlanarPair(100, 40);
+  const HGrowingFilteringParam param;
+
+  std::vector<std::pair<Mat3, matching::IndMatches>> homographiesAndMatches;
+  matching::IndMatches geometricInliers;
+  filterMatchesByHGrowing(pair.featuresI, pair.featuresJ, pair.matches, homographiesAndMatches, geometricInliers, param);
+
+  // one homography per plane
+  BOOST_REQUIRE_EQUAL(homographiesAndMatches.size(), 2);
+  for(const auto& HAndMatches : homographiesAndMatches)
+    BOOST_CHECK_GE(HAndMatches.second.size(), 95);
+  BOOST_CHECK_EQUAL(geometricInliers.size(), homographiesAndMatches[0].second.size() + homographiesAndMatches[1].second.size());
+
+  // the output does not depend on the number of threads
+  const int maxNbThreads = omp_get_max_threads();
+  for(int nbThreads : {1, 2, 3, 8})
+  {
+    omp_set_num_threads(nbThreads);
+
+    std::vector<std::pair<Mat3, matching::IndMatches>> threadsHomographiesAndMatches;
+    matching::IndMatches threadsGeometricInliers;
+    filterMatchesByHGrowing(pair.featuresI, pair.featuresJ, pair.matches, threadsHomographiesAndMatches, threadsGeometricInliers, param);
+
+    BOOST_CHECK(threadsGeometricInliers == geometricInliers);
+    BOOST_REQUIRE_EQUAL(threadsHomographiesAndMatches.size(), homographiesAndMatches.size());
+    for(std::size_t i = 0; i < homographiesAndMatches.size(); ++i)
+    {
+      BOOST_CHECK(threadsHomographiesAndMatches[i].first == homographiesAndMatches[i].first);
+      BOOST_CHECK(threadsHomographiesAndMatches[i].second == homographiesAndMatches[i].second);
+    }
+  }
+  omp_set_num_threads(maxNbThreads);
+}
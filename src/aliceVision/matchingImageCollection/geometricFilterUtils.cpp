@@ -10,6 +10,41 @@
 namespace aliceVision {
 namespace matchingImageCollection {
 
+namespace {
+
+/**
+ * @brief Call \c f(iMatch, matchId) on each match to use for an estimation.
+ * @param[in] nbMatches The number of matches.
+ * @param[in] usefulMatchesId The sorted indices of the matches to use, all the matches if empty.
+ */
+template<typename F>
+void forEachUsefulMatch(std::size_t nbMatches, const std::vector<IndexT>& usefulMatchesId, F f)
+{
+  if(usefulMatchesId.empty())
+  {
+    for(IndexT i = 0; i < nbMatches; ++i)
+      f(i, i);
+    return;
+  }
+  for(IndexT i = 0; i < usefulMatchesId.size(); ++i)
+    f(i, usefulMatchesId[i]);
+}
+
+/**
+ * @brief Get the sorted indices of the flagged matches.
+ */
+void flagsToIndices(const std::vector<char>& flags, std::vector<IndexT>& indices)
+{
+  indices.clear();
+  for(IndexT i = 0; i < flags.size(); ++i)
+  {
+    if(flags[i])
+      indices.push_back(i);
+  }
+}
+
+} // namespace
+
 void copyInlierMatches(const std::vector<size_t> &inliers,
                        const matching::MatchesPerDescType &putativeMatchesPerType,
                        const std::vector<feature::EImageDescriberType> &descTypes,
@@ -36,6 +71,41 @@ void copyInlierMatches(const std::vector<size_t> &inliers,
   }
 }
 
+void buildFeaturesGrids(const sfmData::SfMData* sfmData,
+                        const feature::RegionsPerView& regionsPerView,
+                        const matching::PairwiseMatches& pairs,
+                        matching::FeaturesGridPerView& out_featuresGrids)
+{
+  out_featuresGrids.clear();
+
+  // create the entries first, the grids are filled in parallel
+  for(const auto& pairMatches : pairs)
+  {
+    out_featuresGrids[pairMatches.first.first];
+    out_featuresGrids[pairMatches.first.second];
+  }
+  std::vector<std::pair<IndexT, matching::FeaturesGridPerDesc*>> gridsPerView;
+  for(auto& viewGrids : out_featuresGrids)
+    gridsPerView.emplace_back(viewGrids.first, &viewGrids.second);
+
+  const int nbViews = static_cast<int>(gridsPerView.size());
+
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < nbViews; ++i)
+  {
+    const IndexT viewId = gridsPerView[i].first;
+    const sfmData::View& view = sfmData->getView(viewId);
+
+    // retrieve corresponding camera intrinsic if any
+    const camera::IntrinsicBase* cam = sfmData->getIntrinsics().count(view.getIntrinsicId()) ?
+                                       sfmData->getIntrinsics().at(view.getIntrinsicId()).get() : nullptr;
+
+    matching::FeaturesGridPerDesc& grids = *gridsPerView[i].second;
+    for(const auto& regionsPerDesc : regionsPerView.getAllRegions(viewId))
+      grids[regionsPerDesc.first] = matching::FeaturesGrid(cam, *regionsPerDesc.second);
+  }
+}
+
 void centerMatrix(const Eigen::Matrix2Xf & points2d, Mat3 & t)
 {
   t = Mat3::Identity();
@@ -61,34 +131,23 @@ void centeringMatrices(const std::vector<feature::PointFeature> & featuresI,
                        const matching::IndMatches & matches,
                        Mat3 & cI,
                        Mat3 & cJ,
-                       const std::set<IndexT> & usefulMatchesId)
+                       const std::vector<IndexT> & usefulMatchesId)
 {
   assert(!featuresI.empty());
   assert(!featuresJ.empty());
   assert(!matches.empty());
   assert(*std::max_element(usefulMatchesId.begin(), usefulMatchesId.end()) <= matches.size()); // prevent segfault
 
-  std::set<IndexT> matchesId = usefulMatchesId; // duplicate
-  std::size_t nbMatches = usefulMatchesId.size();
-
-  if (usefulMatchesId.empty())
-  {
-    nbMatches = matches.size();
-    // set every match as useful for estimation
-    for (IndexT i = 0; i < nbMatches; ++i)
-      matchesId.insert(i);
-  }
+  const std::size_t nbMatches = usefulMatchesId.empty() ? matches.size() : usefulMatchesId.size();
 
-  int iMatch = 0;
   Matf ptsI(2, nbMatches);
   Matf ptsJ(2, nbMatches);
 
-  for (IndexT matchId : matchesId)
+  forEachUsefulMatch(matches.size(), usefulMatchesId, [&](IndexT iMatch, IndexT matchId)
   {
     ptsI.col(iMatch) = featuresI.at(matches.at(matchId)._i).coords();
     ptsJ.col(iMatch) = featuresJ.at(matches.at(matchId)._j).coords();
-    ++iMatch;
-  }
+  });
 
   centerMatrix(ptsI, cI);
   centerMatrix(ptsJ, cJ);
@@ -129,7 +188,7 @@ void estimateAffinity(const std::vector<feature::PointFeature> & featuresI,
                       const std::vector<feature::PointFeature> & featuresJ,
                       const matching::IndMatches & matches,
                       Mat3 & affineTransformation,
-                      const std::set<IndexT> & usefulMatchesId)
+                      const std::vector<IndexT> & usefulMatchesId)
 {
   assert(!featuresI.empty());
   assert(!featuresJ.empty());
@@ -138,22 +197,11 @@ void estimateAffinity(const std::vector<feature::PointFeature> & featuresI,
 
   affineTransformation = Mat3::Identity();
 
-  std::set<IndexT> matchesId = usefulMatchesId; // duplicate
-
-  std::size_t nbMatches = usefulMatchesId.size();
-
-  if (usefulMatchesId.empty())
-  {
-    nbMatches = matches.size();
-    // set every match as useful for estimation
-    for (IndexT i = 0; i < nbMatches; ++i)
-      matchesId.insert(i);
-  }
+  const std::size_t nbMatches = usefulMatchesId.empty() ? matches.size() : usefulMatchesId.size();
 
   Mat M(Mat::Zero(2*nbMatches,6));
   Vec b(2*nbMatches);
-  int iMatch = 0;
-  for (IndexT matchId : matchesId)
+  forEachUsefulMatch(matches.size(), usefulMatchesId, [&](IndexT iMatch, IndexT matchId)
   {
     const feature::PointFeature & featI = featuresI.at(matches.at(matchId)._i);
     const feature::PointFeature & featJ = featuresJ.at(matches.at(matchId)._j);
@@ -163,9 +211,7 @@ void estimateAffinity(const std::vector<feature::PointFeature> & featuresI,
     M.block(iMatch+nbMatches,3,1,3) = featICoords.homogeneous().transpose();
     b(iMatch) = featJ.x();
     b(iMatch+nbMatches) = featJ.y();
-
-    ++iMatch;
-  }
+  });
 
   const Vec a = M.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(b);
   affineTransformation.row(0) = a.topRows(3).transpose();
@@ -179,7 +225,7 @@ void estimateHomography(const std::vector<feature::PointFeature> &featuresI,
                         const std::vector<feature::PointFeature> &featuresJ,
                         const matching::IndMatches &matches,
                         Mat3 &H,
-                        const std::set<IndexT> &usefulMatchesId)
+                        const std::vector<IndexT> &usefulMatchesId)
 {
   assert(!featuresI.empty());
   assert(!featuresJ.empty());
@@ -188,25 +234,14 @@ void estimateHomography(const std::vector<feature::PointFeature> &featuresI,
 
   H = Mat3::Identity();
 
-  std::size_t nbMatches = usefulMatchesId.size();
-
-  std::set<IndexT> matchesId = usefulMatchesId; // duplicate
-
-  if (usefulMatchesId.empty())
-  {
-    nbMatches = matches.size();
-    // set every match as useful for estimation
-    for (IndexT i = 0; i < nbMatches; ++i)
-      matchesId.insert(i);
-  }
+  const std::size_t nbMatches = usefulMatchesId.empty() ? matches.size() : usefulMatchesId.size();
 
   Mat3 CI, CJ;
-  centeringMatrices(featuresI, featuresJ, matches, CI, CJ, matchesId);
+  centeringMatrices(featuresI, featuresJ, matches, CI, CJ, usefulMatchesId);
 
   Mat A(Mat::Zero(2*nbMatches,9));
 
-  IndexT iMatch = 0;
-  for(IndexT matchId : matchesId)
+  forEachUsefulMatch(matches.size(), usefulMatchesId, [&](IndexT iMatch, IndexT matchId)
   {
     const feature::PointFeature & featI = featuresI.at(matches.at(matchId)._i);
     const feature::PointFeature & featJ = featuresJ.at(matches.at(matchId)._j);
@@ -219,8 +254,7 @@ void estimateHomography(const std::vector<feature::PointFeature> &featuresI,
     A.block(iMatch,6,1,3) = -ptJ(0) * ptI.transpose();
     A.block(iMatch+nbMatches,3,1,3) = ptI.transpose();
     A.block(iMatch+nbMatches,6,1,3) = -ptJ(1) * ptI.transpose();
-    ++iMatch;
-  }
+  });
 
   Eigen::JacobiSVD<Mat> svd(A, Eigen::ComputeThinU | Eigen::ComputeFullV);
   Vec h = svd.matrixV().rightCols(1);
@@ -239,10 +273,11 @@ void findTransformationInliers(const std::vector<feature::PointFeature> &feature
                                const matching::IndMatches &matches,
                                const Mat3 &transformation,
                                double tolerance,
-                               std::set<IndexT> &inliersId)
+                               std::vector<IndexT> &inliersId)
 {
-  inliersId.clear();
   const double squaredTolerance = Square(tolerance);
+  // one flag per match: the inliers are listed in order whatever the number of threads
+  std::vector<char> isInlier(matches.size(), 0);
 
 #pragma omp parallel for
   for (int iMatch = 0; iMatch < matches.size(); ++iMatch)
@@ -257,12 +292,10 @@ void findTransformationInliers(const std::vector<feature::PointFeature> &feature
 
     const double dist = (ptJ - ptIp_hom.hnormalized()).squaredNorm();
 
-    if (dist < squaredTolerance)
-    {
-#pragma omp critical
-      inliersId.insert(iMatch);
-    }
+    isInlier[iMatch] = (dist < squaredTolerance);
   }
+
+  flagsToIndices(isInlier, inliersId);
 }
 
 void findTransformationInliers(const Mat2X& featuresI,
@@ -270,10 +303,11 @@ void findTransformationInliers(const Mat2X& featuresI,
                                const matching::IndMatches &matches,
                                const Mat3 &transformation,
                                double tolerance,
-                               std::set<IndexT> &inliersId)
+                               std::vector<IndexT> &inliersId)
 {
-  inliersId.clear();
   const double squaredTolerance = Square(tolerance);
+  // one flag per match: the inliers are listed in order whatever the number of threads
+  std::vector<char> isInlier(matches.size(), 0);
 
 #pragma omp parallel for
   for (int iMatch = 0; iMatch < matches.size(); ++iMatch)
@@ -286,12 +320,10 @@ void findTransformationInliers(const Mat2X& featuresI,
 
     const double dist = (ptJ - ptIp_hom.hnormalized()).squaredNorm();
 
-    if (dist < squaredTolerance)
-    {
-#pragma omp critical
-      inliersId.insert(iMatch);
-    }
+    isInlier[iMatch] = (dist < squaredTolerance);
   }
+
+  flagsToIndices(isInlier, inliersId);
 }
 
 /**
@@ -358,7 +390,7 @@ bool refineHomography(const std::vector<feature::PointFeature> &featuresI,
                       const std::vector<feature::PointFeature> &featuresJ,
                       const matching::IndMatches& remainingMatches,
                       Mat3& homography,
-                      std::set<IndexT>& bestMatchesId,
+                      std::vector<IndexT>& bestMatchesId,
                       double homographyTolerance)
 {
   Mat2X pointsI;
@@ -377,7 +409,7 @@ bool refineHomography(const Mat2X& features_I,
                       const Mat2X& features_J,
                       const matching::IndMatches& remainingMatches,
                       Mat3& homography,
-                      std::set<IndexT>& bestMatchesId,
+                      std::vector<IndexT>& bestMatchesId,
                       double homographyTolerance)
 {
   ceres::Problem problem;
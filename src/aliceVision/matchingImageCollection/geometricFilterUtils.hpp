@@ -8,6 +8,7 @@
 #pragma once
 
 #include <aliceVision/matching/IndMatch.hpp>
+#include <aliceVision/matching/FeaturesGrid.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
 #include <aliceVision/camera/IntrinsicBase.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
@@ -173,6 +174,18 @@ void copyInlierMatches(const std::vector<size_t> &inliers,
                        const std::vector<feature::EImageDescriberType> &descTypes,
                        matching::MatchesPerDescType &out_geometricInliersPerType);
 
+/**
+ * @brief Build the grids of the undistorted features of each view of the pairs, used by the guided matching.
+ * @param[in] sfmData The views and their intrinsics.
+ * @param[in] regionsPerView The regions of the views.
+ * @param[in] pairs The image pairs.
+ * @param[out] out_featuresGrids The grids of each view, per describer type.
+ */
+void buildFeaturesGrids(const sfmData::SfMData* sfmData,
+                        const feature::RegionsPerView& regionsPerView,
+                        const matching::PairwiseMatches& pairs,
+                        matching::FeaturesGridPerView& out_featuresGrids);
+
 /**
  * @brief Compute the transformation that standardize the input points so that
  * they are z-scores (i.e. zero mean and unit standard deviation).
@@ -189,14 +202,14 @@ void centerMatrix(const Eigen::Matrix2Xf & points2d, Mat3 & t);
  * @param[in] matches Indicate which feature is concerned about the returned matrices.
  * @param[out] cI The standardizing matrix to apply to (the subpart of) \c featuresI
  * @param[out] cJ The standardizing matrix to apply to (the subpart of) \c featuresJ
- * @param[in] usefulMatchesId To consider a subpart of \c matches only.
+ * @param[in] usefulMatchesId To consider a subpart of \c matches only (sorted indices in \c matches, all the matches if empty).
  */
 void centeringMatrices(const std::vector<feature::PointFeature> & featuresI,
                        const std::vector<feature::PointFeature> & featuresJ,
                        const matching::IndMatches & matches,
                        Mat3 & cI,
                        Mat3 & cJ,
-                       const std::set<IndexT> & usefulMatchesId = std::set<IndexT>());
+                       const std::vector<IndexT> & usefulMatchesId = std::vector<IndexT>());
 /**
  * @brief Compute the similarity transformation between 2 features (using their scale & orientation).
  * Based on: https://github.com/fsrajer/yasfm/blob/3a09bc0ee69b7021910d646386cd92deab504a2c/YASFM/relative_pose.cpp#L1649
@@ -215,13 +228,13 @@ void computeSimilarity(const feature::PointFeature & feat1,
  * @param[in] featuresJ
  * @param[in] matches The matches to consider for the estimation.
  * @param[out] affineTransformation The estimated Affine transformation.
- * @param[in] usefulMatchesId To consider a subpart of \c matches only.
+ * @param[in] usefulMatchesId To consider a subpart of \c matches only (sorted indices in \c matches, all the matches if empty).
  */
 void estimateAffinity(const std::vector<feature::PointFeature> & featuresI,
                       const std::vector<feature::PointFeature> & featuresJ,
                       const matching::IndMatches & matches,
                       Mat3 & affineTransformation,
-                      const std::set<IndexT> & usefulMatchesId = std::set<IndexT>());
+                      const std::vector<IndexT> & usefulMatchesId = std::vector<IndexT>());
 
 /**
  * @brief estimateHomography Estimate (using SVD) the Homography transformation from a set of matches.
@@ -230,13 +243,13 @@ void estimateAffinity(const std::vector<feature::PointFeature> & featuresI,
  * @param[in] featuresJ
  * @param[in] matches The matches to consider for the estimation.
  * @param[out] H The estimated Homography transformation.
- * @param[in] usefulMatchesId To consider a subpart of \c matches only.
+ * @param[in] usefulMatchesId To consider a subpart of \c matches only (sorted indices in \c matches, all the matches if empty).
  */
 void estimateHomography(const std::vector<feature::PointFeature> & featuresI,
                         const std::vector<feature::PointFeature> & featuresJ,
                         const matching::IndMatches & matches,
                         Mat3 &H,
-                        const std::set<IndexT> & usefulMatchesId = std::set<IndexT>());
+                        const std::vector<IndexT> & usefulMatchesId = std::vector<IndexT>());
 
 /**
  * @brief Return the id. of the matches with a reprojection error < to the desirered \c tolerance.
@@ -245,14 +258,14 @@ void estimateHomography(const std::vector<feature::PointFeature> & featuresI,
  * @param[in] matches The matches to test.
  * @param[in] transformation The 3x3 transformation matrix.
  * @param[in] tolerance The tolerated pixel error.
- * @param[in] inliersId The index in the \c matches vector.
+ * @param[out] inliersId The sorted indices in the \c matches vector.
  */
 void findTransformationInliers(const std::vector<feature::PointFeature> & featuresI,
                                const std::vector<feature::PointFeature> & featuresJ,
                                const matching::IndMatches & matches,
                                const Mat3 & transformation,
                                double tolerance,
-                               std::set<IndexT> & inliersId);
+                               std::vector<IndexT> & inliersId);
 /**
  * @brief Return the id. of the matches with a reprojection error < to the desirered \c tolerance.
  * @param[in] featuresI
@@ -260,28 +273,28 @@ void findTransformationInliers(const std::vector<feature::PointFeature> & featur
  * @param[in] matches The matches to test.
  * @param[in] transformation The 3x3 transformation matrix.
  * @param[in] tolerance The tolerated pixel error.
- * @param[in] inliersId The index in the \c matches vector.
+ * @param[out] inliersId The sorted indices in the \c matches vector.
  */
 void findTransformationInliers(const Mat2X& featuresI,
                                const Mat2X& featuresJ,
                                const matching::IndMatches &matches,
                                const Mat3 &transformation,
                                double tolerance,
-                               std::set<IndexT> &inliersId);
+                               std::vector<IndexT> &inliersId);
 
 
 bool refineHomography(const std::vector<feature::PointFeature> &featuresI,
                       const std::vector<feature::PointFeature> &featuresJ,
                       const matching::IndMatches& remainingMatches,
                       Mat3& homography,
-                      std::set<IndexT>& bestMatchesId,
+                      std::vector<IndexT>& bestMatchesId,
                       double homographyTolerance);
 
 bool refineHomography(const Mat2X& features_I,
                       const Mat2X& features_J,
                       const matching::IndMatches& remainingMatches,
                       Mat3& homography,
-                      std::set<IndexT>& bestMatchesId,
+                      std::vector<IndexT>& bestMatchesId,
                       double homographyTolerance);
 
 } // namespace aliceVision
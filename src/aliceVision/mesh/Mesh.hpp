@@ -128,7 +128,21 @@ public:
     Mesh();
     ~Mesh();
 
-    void saveToObj(const std::string& filename);
+    /**
+     * @brief Load a mesh file, the format is given by the file extension (.obj, .ply or .avmesh, see EMeshFileType)
+     * @param[in] filename the mesh file path
+     * @return false if the mesh has no point or no triangle
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * @brief Save the mesh, the format is given by the file extension (.obj, .ply or .avmesh, see EMeshFileType).
+     *        Only the AliceVision mesh file keeps the UVs, the normals and the points visibilities.
+     * @param[in] filename the mesh file path
+     */
+    void save(const std::string& filename) const;
+
+    void saveToObj(const std::string& filename) const;
 
     bool loadFromBin(const std::string& binFileName);
     void saveToBin(const std::string& binFileName);
@@ -0,0 +1,798 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MeshBVH.hpp"
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Tracer.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace {
+
+/// maximal number of triangles in a leaf when splitting is always cheaper
+const int minLeafSize = 4;
+/// maximal number of triangles in a leaf
+const int maxLeafSize = 16;
+const int nbBins = 16;
+/// beyond this depth, nodes are split at the median to bound the depth of the tree
+const int maxSahDepth = 40;
+const int stackSize = 128;
+
+struct BBox
+{
+    float bmin[3];
+    float bmax[3];
+
+    BBox()
+    {
+        for(int a = 0; a < 3; ++a)
+        {
+            bmin[a] = std::numeric_limits<float>::max();
+            bmax[a] = -std::numeric_limits<float>::max();
+        }
+    }
+
+    void extend(const float p[3])
+    {
+        for(int a = 0; a < 3; ++a)
+        {
+            bmin[a] = std::min(bmin[a], p[a]);
+            bmax[a] = std::max(bmax[a], p[a]);
+        }
+    }
+
+    void extend(const BBox& other)
+    {
+        for(int a = 0; a < 3; ++a)
+        {
+            bmin[a] = std::min(bmin[a], other.bmin[a]);
+            bmax[a] = std::max(bmax[a], other.bmax[a]);
+        }
+    }
+
+    float area() const
+    {
+        if(bmin[0] > bmax[0])
+            return 0.0f;
+        const float dx = bmax[0] - bmin[0];
+        const float dy = bmax[1] - bmin[1];
+        const float dz = bmax[2] - bmin[2];
+        return 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+};
+
+inline float safeInverse(float d)
+{
+    // avoid infinities (and NaN in the slab test) for axis-aligned rays
+    const float tiny = 1e-30f;
+    if(std::abs(d) < tiny)
+        return d < 0.0f ? -1.0f / tiny : 1.0f / tiny;
+    return 1.0f / d;
+}
+
+/// test if a surface is seen from its front side, the points without normal are never culled
+inline bool isFacing(const Point3d& normal, const Point3d& point, const Point3d& cameraCenter)
+{
+    if(normal.x == 0.0 && normal.y == 0.0 && normal.z == 0.0)
+        return true;
+    return dot(normal, cameraCenter - point) > 0.0;
+}
+
+} // namespace
+
+struct MeshBVH::BuildContext
+{
+    struct Reference
+    {
+        BBox bbox;
+        float centroid[3];
+        int triangle;
+    };
+    std::vector<Reference> references;
+};
+
+struct MeshBVH::Packet
+{
+    /// shared origin of the rays, in the BVH coordinate system
+    float origin[3];
+    float direction[3][packetSize];
+    float invDirection[3][packetSize];
+    float tMax[packetSize];
+    /// index of the closest triangle in the BVH, -1 if none
+    int triangle[packetSize];
+};
+
+MeshBVH::MeshBVH(const Mesh& mesh, bool backFaceCulling)
+    : _mesh(mesh)
+    , _backFaceCulling(backFaceCulling)
+{
+    ALICEVISION_TRACE_ZONE("meshBVH::build");
+    build();
+    ALICEVISION_LOG_DEBUG("Mesh BVH built: " << _triangles.size() << " triangles, " << _nodes.size() << " nodes.");
+}
+
+void MeshBVH::build()
+{
+    // center of the mesh, to keep the precision of the single precision coordinates
+    Point3d pmin(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+    Point3d pmax(-pmin.x, -pmin.y, -pmin.z);
+    for(int i = 0; i < _mesh.pts.size(); ++i)
+    {
+        const Point3d& p = _mesh.pts[i];
+        pmin = Point3d(std::min(pmin.x, p.x), std::min(pmin.y, p.y), std::min(pmin.z, p.z));
+        pmax = Point3d(std::max(pmax.x, p.x), std::max(pmax.y, p.y), std::max(pmax.z, p.z));
+    }
+    if(_mesh.pts.empty())
+        return;
+    _center = (pmin + pmax) * 0.5;
+    _epsilon = std::max((pmax - pmin).size() * 1e-5, std::numeric_limits<double>::min());
+
+    BuildContext context;
+    context.references.reserve(_mesh.tris.size());
+    std::vector<Triangle> triangles(_mesh.tris.size());
+    if(_backFaceCulling)
+    {
+        _triangleNormals.assign(_mesh.tris.size(), Point3d(0.0, 0.0, 0.0));
+        _vertexNormals.assign(_mesh.pts.size(), Point3d(0.0, 0.0, 0.0));
+    }
+    for(int i = 0; i < _mesh.tris.size(); ++i)
+    {
+        const Mesh::triangle& tri = _mesh.tris[i];
+        if(!tri.alive || tri.v[0] < 0 || tri.v[1] < 0 || tri.v[2] < 0)
+            continue;
+
+        float v[3][3];
+        for(int k = 0; k < 3; ++k)
+        {
+            const Point3d p = _mesh.pts[tri.v[k]] - _center;
+            v[k][0] = static_cast<float>(p.x);
+            v[k][1] = static_cast<float>(p.y);
+            v[k][2] = static_cast<float>(p.z);
+        }
+
+        Triangle& t = triangles[i];
+        for(int a = 0; a < 3; ++a)
+        {
+            t.v0[a] = v[0][a];
+            t.e1[a] = v[1][a] - v[0][a];
+            t.e2[a] = v[2][a] - v[0][a];
+        }
+        // degenerated triangles can't be hit
+        const float nx = t.e1[1] * t.e2[2] - t.e1[2] * t.e2[1];
+        const float ny = t.e1[2] * t.e2[0] - t.e1[0] * t.e2[2];
+        const float nz = t.e1[0] * t.e2[1] - t.e1[1] * t.e2[0];
+        if(nx == 0.0f && ny == 0.0f && nz == 0.0f)
+            continue;
+
+        if(_backFaceCulling)
+        {
+            // the norm of the cross product is twice the area of the triangle
+            const Point3d n = cross(_mesh.pts[tri.v[1]] - _mesh.pts[tri.v[0]], _mesh.pts[tri.v[2]] - _mesh.pts[tri.v[0]]);
+            _triangleNormals[i] = n;
+            for(int k = 0; k < 3; ++k)
+                _vertexNormals[tri.v[k]] = _vertexNormals[tri.v[k]] + n;
+        }
+
+        BuildContext::Reference ref;
+        for(int k = 0; k < 3; ++k)
+            ref.bbox.extend(v[k]);
+        for(int a = 0; a < 3; ++a)
+            ref.centroid[a] = 0.5f * (ref.bbox.bmin[a] + ref.bbox.bmax[a]);
+        ref.triangle = i;
+        context.references.push_back(ref);
+    }
+
+    if(context.references.empty())
+        return;
+
+    // a binary tree with at least one triangle per leaf, the nodes never move during the build
+    _nodes.reserve(2 * context.references.size());
+    _nodes.emplace_back();
+    buildNode(context, 0, 0, static_cast<int>(context.references.size()), 0);
+    _nodes.shrink_to_fit();
+
+    // store the triangles in the order of the leaves
+    _triangles.resize(context.references.size());
+    _triangleIndexes.resize(context.references.size());
+    for(std::size_t i = 0; i < context.references.size(); ++i)
+    {
+        _triangleIndexes[i] = context.references[i].triangle;
+        _triangles[i] = triangles[context.references[i].triangle];
+    }
+}
+
+void MeshBVH::buildNode(BuildContext& context, int nodeIndex, int begin, int end, int depth)
+{
+    using Reference = BuildContext::Reference;
+    std::vector<Reference>& refs = context.references;
+
+    BBox bbox;
+    BBox centroidBox;
+    for(int i = begin; i < end; ++i)
+    {
+        bbox.extend(refs[i].bbox);
+        centroidBox.extend(refs[i].centroid);
+    }
+
+    {
+        Node& node = _nodes[nodeIndex];
+        std::copy(bbox.bmin, bbox.bmin + 3, node.bmin);
+        std::copy(bbox.bmax, bbox.bmax + 3, node.bmax);
+        node.offset = begin;
+        node.count = static_cast<std::uint16_t>(end - begin);
+        node.axis = 0;
+    }
+
+    const int count = end - begin;
+    if(count <= minLeafSize)
+        return;
+
+    // largest extent of the centroids
+    int axis = 0;
+    for(int a = 1; a < 3; ++a)
+    {
+        if(centroidBox.bmax[a] - centroidBox.bmin[a] > centroidBox.bmax[axis] - centroidBox.bmin[axis])
+            axis = a;
+    }
+    const float extent = centroidBox.bmax[axis] - centroidBox.bmin[axis];
+
+    int middle = -1;
+    if(extent <= 0.0f)
+    {
+        // all the triangles have the same centroid
+        if(count <= maxLeafSize)
+            return;
+        middle = (begin + end) / 2;
+    }
+    else if(depth >= maxSahDepth)
+    {
+        middle = (begin + end) / 2;
+        std::nth_element(refs.begin() + begin, refs.begin() + middle, refs.begin() + end,
+                         [axis](const Reference& a, const Reference& b) { return a.centroid[axis] < b.centroid[axis]; });
+    }
+    else
+    {
+        // binned surface area heuristic on each axis
+        float bestCost = std::numeric_limits<float>::max();
+        int bestAxis = -1;
+        int bestSplit = -1;
+        for(int a = 0; a < 3; ++a)
+        {
+            const float axisExtent = centroidBox.bmax[a] - centroidBox.bmin[a];
+            if(axisExtent <= 0.0f)
+                continue;
+            const float binScale = nbBins / axisExtent;
+
+            BBox bins[nbBins];
+            int binCounts[nbBins] = {0};
+            for(int i = begin; i < end; ++i)
+            {
+                const int b = std::min(nbBins - 1, static_cast<int>((refs[i].centroid[a] - centroidBox.bmin[a]) * binScale));
+                bins[b].extend(refs[i].bbox);
+                ++binCounts[b];
+            }
+
+            // areas and counts on the right of each split
+            float rightAreas[nbBins];
+            int rightCounts[nbBins];
+            BBox right;
+            int rightCount = 0;
+            for(int b = nbBins - 1; b > 0; --b)
+            {
+                right.extend(bins[b]);
+                rightCount += binCounts[b];
+                rightAreas[b] = right.area();
+                rightCounts[b] = rightCount;
+            }
+
+            BBox left;
+            int leftCount = 0;
+            for(int b = 1; b < nbBins; ++b)
+            {
+                left.extend(bins[b - 1]);
+                leftCount += binCounts[b - 1];
+                if(leftCount == 0 || rightCounts[b] == 0)
+                    continue;
+                const float cost = left.area() * leftCount + rightAreas[b] * rightCounts[b];
+                if(cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = a;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        // compare with the cost of a leaf, with a traversal as expensive as a triangle test
+        const float leafCost = bbox.area() * count;
+        if(count <= maxLeafSize && bestCost + bbox.area() >= leafCost)
+            return;
+
+        if(bestAxis >= 0)
+        {
+            axis = bestAxis;
+            const float binScale = nbBins / (centroidBox.bmax[axis] - centroidBox.bmin[axis]);
+            const float axisMin = centroidBox.bmin[axis];
+            middle = static_cast<int>(std::partition(refs.begin() + begin, refs.begin() + end, [&](const Reference& r) {
+                return std::min(nbBins - 1, static_cast<int>((r.centroid[axis] - axisMin) * binScale)) < bestSplit;
+            }) - refs.begin());
+        }
+        if(middle <= begin || middle >= end)
+        {
+            middle = (begin + end) / 2;
+            std::nth_element(refs.begin() + begin, refs.begin() + middle, refs.begin() + end,
+                             [axis](const Reference& a, const Reference& b) { return a.centroid[axis] < b.centroid[axis]; });
+        }
+    }
+
+    // the first child is the next node, the second one follows the subtree of the first one
+    const int leftIndex = static_cast<int>(_nodes.size());
+    _nodes.emplace_back();
+    buildNode(context, leftIndex, begin, middle, depth + 1);
+
+    const int rightIndex = static_cast<int>(_nodes.size());
+    _nodes.emplace_back();
+    buildNode(context, rightIndex, middle, end, depth + 1);
+
+    Node& node = _nodes[nodeIndex];
+    node.offset = rightIndex;
+    node.count = 0;
+    node.axis = static_cast<std::uint16_t>(axis);
+}
+
+bool MeshBVH::intersect(const Point3d& origin, const Point3d& direction, double tMin, double tMax, Hit& hit) const
+{
+    hit = Hit();
+    if(_nodes.empty())
+        return false;
+
+    const Point3d o = origin - _center;
+    const float orig[3] = {static_cast<float>(o.x), static_cast<float>(o.y), static_cast<float>(o.z)};
+    const float dir[3] = {static_cast<float>(direction.x), static_cast<float>(direction.y), static_cast<float>(direction.z)};
+    const float invDir[3] = {safeInverse(dir[0]), safeInverse(dir[1]), safeInverse(dir[2])};
+    const float tNear = static_cast<float>(tMin);
+    float tFar = static_cast<float>(std::min(tMax, static_cast<double>(std::numeric_limits<float>::max())));
+
+    int closest = -1;
+    int stack[stackSize];
+    int stackPtr = 0;
+    stack[stackPtr++] = 0;
+    while(stackPtr > 0)
+    {
+        const Node& node = _nodes[stack[--stackPtr]];
+
+        float t0 = tNear;
+        float t1 = tFar;
+        for(int a = 0; a < 3; ++a)
+        {
+            float tA = (node.bmin[a] - orig[a]) * invDir[a];
+            float tB = (node.bmax[a] - orig[a]) * invDir[a];
+            if(tA > tB)
+                std::swap(tA, tB);
+            t0 = tA > t0 ? tA : t0;
+            t1 = tB < t1 ? tB : t1;
+        }
+        if(t0 > t1)
+            continue;
+
+        if(node.count == 0)
+        {
+            const int first = static_cast<int>(&node - _nodes.data()) + 1;
+            // visit the nearest child first
+            if(dir[node.axis] > 0.0f)
+            {
+                stack[stackPtr++] = node.offset;
+                stack[stackPtr++] = first;
+            }
+            else
+            {
+                stack[stackPtr++] = first;
+                stack[stackPtr++] = node.offset;
+            }
+            continue;
+        }
+
+        for(int i = node.offset; i < node.offset + node.count; ++i)
+        {
+            const Triangle& tri = _triangles[i];
+            // Moller-Trumbore
+            const float p[3] = {dir[1] * tri.e2[2] - dir[2] * tri.e2[1],
+                                dir[2] * tri.e2[0] - dir[0] * tri.e2[2],
+                                dir[0] * tri.e2[1] - dir[1] * tri.e2[0]};
+            const float det = tri.e1[0] * p[0] + tri.e1[1] * p[1] + tri.e1[2] * p[2];
+            if(det == 0.0f)
+                continue;
+            const float invDet = 1.0f / det;
+            const float s[3] = {orig[0] - tri.v0[0], orig[1] - tri.v0[1], orig[2] - tri.v0[2]};
+            const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+            if(u < 0.0f || u > 1.0f)
+                continue;
+            const float q[3] = {s[1] * tri.e1[2] - s[2] * tri.e1[1],
+                                s[2] * tri.e1[0] - s[0] * tri.e1[2],
+                                s[0] * tri.e1[1] - s[1] * tri.e1[0]};
+            const float v = (dir[0] * q[0] + dir[1] * q[1] + dir[2] * q[2]) * invDet;
+            if(v < 0.0f || u + v > 1.0f)
+                continue;
+            const float t = (tri.e2[0] * q[0] + tri.e2[1] * q[1] + tri.e2[2] * q[2]) * invDet;
+            if(t > tNear && t < tFar)
+            {
+                tFar = t;
+                closest = i;
+            }
+        }
+    }
+
+    if(closest < 0)
+        return false;
+    hit.triangle = _triangleIndexes[closest];
+    hit.t = tFar;
+    return true;
+}
+
+bool MeshBVH::occluded(const Point3d& origin, const Point3d& direction, double tMin, double tMax) const
+{
+    if(_nodes.empty() || tMax <= tMin)
+        return false;
+
+    const Point3d o = origin - _center;
+    const float orig[3] = {static_cast<float>(o.x), static_cast<float>(o.y), static_cast<float>(o.z)};
+    const float dir[3] = {static_cast<float>(direction.x), static_cast<float>(direction.y), static_cast<float>(direction.z)};
+    const float invDir[3] = {safeInverse(dir[0]), safeInverse(dir[1]), safeInverse(dir[2])};
+    const float tNear = static_cast<float>(tMin);
+    const float tFar = static_cast<float>(std::min(tMax, static_cast<double>(std::numeric_limits<float>::max())));
+
+    int stack[stackSize];
+    int stackPtr = 0;
+    stack[stackPtr++] = 0;
+    while(stackPtr > 0)
+    {
+        const int nodeIndex = stack[--stackPtr];
+        const Node& node = _nodes[nodeIndex];
+
+        float t0 = tNear;
+        float t1 = tFar;
+        for(int a = 0; a < 3; ++a)
+        {
+            float tA = (node.bmin[a] - orig[a]) * invDir[a];
+            float tB = (node.bmax[a] - orig[a]) * invDir[a];
+            if(tA > tB)
+                std::swap(tA, tB);
+            t0 = tA > t0 ? tA : t0;
+            t1 = tB < t1 ? tB : t1;
+        }
+        if(t0 > t1)
+            continue;
+
+        if(node.count == 0)
+        {
+            stack[stackPtr++] = node.offset;
+            stack[stackPtr++] = nodeIndex + 1;
+            continue;
+        }
+
+        for(int i = node.offset; i < node.offset + node.count; ++i)
+        {
+            const Triangle& tri = _triangles[i];
+            const float p[3] = {dir[1] * tri.e2[2] - dir[2] * tri.e2[1],
+                                dir[2] * tri.e2[0] - dir[0] * tri.e2[2],
+                                dir[0] * tri.e2[1] - dir[1] * tri.e2[0]};
+            const float det = tri.e1[0] * p[0] + tri.e1[1] * p[1] + tri.e1[2] * p[2];
+            if(det == 0.0f)
+                continue;
+            const float invDet = 1.0f / det;
+            const float s[3] = {orig[0] - tri.v0[0], orig[1] - tri.v0[1], orig[2] - tri.v0[2]};
+            const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+            if(u < 0.0f || u > 1.0f)
+                continue;
+            const float q[3] = {s[1] * tri.e1[2] - s[2] * tri.e1[1],
+                                s[2] * tri.e1[0] - s[0] * tri.e1[2],
+                                s[0] * tri.e1[1] - s[1] * tri.e1[0]};
+            const float v = (dir[0] * q[0] + dir[1] * q[1] + dir[2] * q[2]) * invDet;
+            if(v < 0.0f || u + v > 1.0f)
+                continue;
+            const float t = (tri.e2[0] * q[0] + tri.e2[1] * q[1] + tri.e2[2] * q[2]) * invDet;
+            if(t > tNear && t < tFar)
+                return true;
+        }
+    }
+    return false;
+}
+
+void MeshBVH::intersectPacket(Packet& packet) const
+{
+    for(int l = 0; l < packetSize; ++l)
+        packet.triangle[l] = -1;
+    if(_nodes.empty())
+        return;
+
+    const float* orig = packet.origin;
+    // all the rays of a packet go in nearly the same direction, the first one gives the traversal order
+    const float firstDir[3] = {packet.direction[0][0], packet.direction[1][0], packet.direction[2][0]};
+
+    int stack[stackSize];
+    int stackPtr = 0;
+    stack[stackPtr++] = 0;
+    while(stackPtr > 0)
+    {
+        const int nodeIndex = stack[--stackPtr];
+        const Node& node = _nodes[nodeIndex];
+
+        // slab test of the node box against all the rays of the packet
+        int active = 0;
+        for(int l = 0; l < packetSize; ++l)
+        {
+            const float tx0 = (node.bmin[0] - orig[0]) * packet.invDirection[0][l];
+            const float tx1 = (node.bmax[0] - orig[0]) * packet.invDirection[0][l];
+            const float ty0 = (node.bmin[1] - orig[1]) * packet.invDirection[1][l];
+            const float ty1 = (node.bmax[1] - orig[1]) * packet.invDirection[1][l];
+            const float tz0 = (node.bmin[2] - orig[2]) * packet.invDirection[2][l];
+            const float tz1 = (node.bmax[2] - orig[2]) * packet.invDirection[2][l];
+            const float txNear = tx0 < tx1 ? tx0 : tx1;
+            const float txFar = tx0 < tx1 ? tx1 : tx0;
+            const float tyNear = ty0 < ty1 ? ty0 : ty1;
+            const float tyFar = ty0 < ty1 ? ty1 : ty0;
+            const float tzNear = tz0 < tz1 ? tz0 : tz1;
+            const float tzFar = tz0 < tz1 ? tz1 : tz0;
+            float tNear = txNear > tyNear ? txNear : tyNear;
+            tNear = tzNear > tNear ? tzNear : tNear;
+            tNear = tNear > 0.0f ? tNear : 0.0f;
+            float tFar = txFar < tyFar ? txFar : tyFar;
+            tFar = tzFar < tFar ? tzFar : tFar;
+            tFar = packet.tMax[l] < tFar ? packet.tMax[l] : tFar;
+            active |= (tNear <= tFar);
+        }
+        if(!active)
+            continue;
+
+        if(node.count == 0)
+        {
+            if(firstDir[node.axis] > 0.0f)
+            {
+                stack[stackPtr++] = node.offset;
+                stack[stackPtr++] = nodeIndex + 1;
+            }
+            else
+            {
+                stack[stackPtr++] = nodeIndex + 1;
+                stack[stackPtr++] = node.offset;
+            }
+            continue;
+        }
+
+        for(int i = node.offset; i < node.offset + node.count; ++i)
+        {
+            const Triangle& tri = _triangles[i];
+            // with a shared origin, s and q do not depend on the ray
+            const float s[3] = {orig[0] - tri.v0[0], orig[1] - tri.v0[1], orig[2] - tri.v0[2]};
+            const float q[3] = {s[1] * tri.e1[2] - s[2] * tri.e1[1],
+                                s[2] * tri.e1[0] - s[0] * tri.e1[2],
+                                s[0] * tri.e1[1] - s[1] * tri.e1[0]};
+            const float qe2 = tri.e2[0] * q[0] + tri.e2[1] * q[1] + tri.e2[2] * q[2];
+
+            for(int l = 0; l < packetSize; ++l)
+            {
+                const float dx = packet.direction[0][l];
+                const float dy = packet.direction[1][l];
+                const float dz = packet.direction[2][l];
+                const float px = dy * tri.e2[2] - dz * tri.e2[1];
+                const float py = dz * tri.e2[0] - dx * tri.e2[2];
+                const float pz = dx * tri.e2[1] - dy * tri.e2[0];
+                const float det = tri.e1[0] * px + tri.e1[1] * py + tri.e1[2] * pz;
+                const float invDet = det != 0.0f ? 1.0f / det : 0.0f;
+                const float u = (s[0] * px + s[1] * py + s[2] * pz) * invDet;
+                const float v = (dx * q[0] + dy * q[1] + dz * q[2]) * invDet;
+                const float t = qe2 * invDet;
+                const bool hit = (det != 0.0f) & (u >= 0.0f) & (v >= 0.0f) & (u + v <= 1.0f) & (t > 0.0f) & (t < packet.tMax[l]);
+                packet.tMax[l] = hit ? t : packet.tMax[l];
+                packet.triangle[l] = hit ? i : packet.triangle[l];
+            }
+        }
+    }
+}
+
+bool MeshBVH::isInFrustum(const mvsUtils::MultiViewParams& mp, int cam, const Point3d& point) const
+{
+    // points behind the camera can be projected inside the image
+    if((mp.RArr[cam] * (point - mp.CArr[cam])).z <= 0.0)
+        return false;
+
+    Point2d pix;
+    mp.getPixelFor3DPoint(&pix, point, cam);
+    return mp.isPixelInImage(pix, cam);
+}
+
+bool MeshBVH::isVisible(const mvsUtils::MultiViewParams& mp, int cam, const Point3d& point, double tolerance) const
+{
+    if(!isInFrustum(mp, cam, point))
+        return false;
+
+    const Point3d& cameraCenter = mp.CArr[cam];
+    const Point3d v = point - cameraCenter;
+    const double distance = v.size();
+    const double tMax = distance - std::max(tolerance, _epsilon);
+    if(tMax <= 0.0)
+        return true;
+    return !occluded(cameraCenter, v / distance, 0.0, tMax);
+}
+
+void MeshBVH::renderDepthMap(const mvsUtils::MultiViewParams& mp, int rc, int scale, int w, int h,
+                             StaticVector<float>& depthMap, StaticVector<int>* trisMap) const
+{
+    ALICEVISION_TRACE_ZONE("meshBVH::renderDepthMap");
+
+    depthMap.resize(w * h);
+    if(trisMap != nullptr)
+        trisMap->resize(w * h);
+
+    // tiles of 4x4 pixels, traced as a packet
+    const int tileSide = 4;
+    const int nbTilesX = (w + tileSide - 1) / tileSide;
+    const int nbTilesY = (h + tileSide - 1) / tileSide;
+
+    const Point3d o = mp.CArr[rc] - _center;
+    const Matrix3x3& iCam = mp.iCamArr[rc];
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int tileY = 0; tileY < nbTilesY; ++tileY)
+    {
+        Packet packet;
+        packet.origin[0] = static_cast<float>(o.x);
+        packet.origin[1] = static_cast<float>(o.y);
+        packet.origin[2] = static_cast<float>(o.z);
+
+        for(int tileX = 0; tileX < nbTilesX; ++tileX)
+        {
+            for(int l = 0; l < packetSize; ++l)
+            {
+                // pixels outside of the map repeat the last row or column of the tile
+                const int x = std::min(tileX * tileSide + l % tileSide, w - 1);
+                const int y = std::min(tileY * tileSide + l / tileSide, h - 1);
+                const Point2d pix((x + 0.5) * scale, (y + 0.5) * scale);
+                const Point3d dir = (iCam * pix).normalize();
+                packet.direction[0][l] = static_cast<float>(dir.x);
+                packet.direction[1][l] = static_cast<float>(dir.y);
+                packet.direction[2][l] = static_cast<float>(dir.z);
+                packet.invDirection[0][l] = safeInverse(packet.direction[0][l]);
+                packet.invDirection[1][l] = safeInverse(packet.direction[1][l]);
+                packet.invDirection[2][l] = safeInverse(packet.direction[2][l]);
+                packet.tMax[l] = std::numeric_limits<float>::max();
+            }
+
+            intersectPacket(packet);
+
+            for(int l = 0; l < packetSize; ++l)
+            {
+                const int x = tileX * tileSide + l % tileSide;
+                const int y = tileY * tileSide + l / tileSide;
+                if(x >= w || y >= h)
+                    continue;
+                const bool hit = packet.triangle[l] >= 0;
+                depthMap[x * h + y] = hit ? packet.tMax[l] : -1.0f;
+                if(trisMap != nullptr)
+                    (*trisMap)[x * h + y] = hit ? _triangleIndexes[packet.triangle[l]] : -1;
+            }
+        }
+    }
+}
+
+void MeshBVH::getVisibleTriangles(const mvsUtils::MultiViewParams& mp, int rc, StaticVector<int>& out_visTri) const
+{
+    ALICEVISION_TRACE_ZONE("meshBVH::getVisibleTriangles");
+
+    std::vector<char> visible(_mesh.tris.size(), 0);
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for(int i = 0; i < static_cast<int>(_triangleIndexes.size()); ++i)
+    {
+        const int idTri = _triangleIndexes[i];
+        const Point3d cg = _mesh.computeTriangleCenterOfGravity(idTri);
+        visible[idTri] = isTriangleVisible(mp, rc, idTri, cg);
+    }
+
+    out_visTri.clear();
+    for(int i = 0; i < static_cast<int>(visible.size()); ++i)
+    {
+        if(visible[i])
+            out_visTri.push_back(i);
+    }
+}
+
+void MeshBVH::computeTrisCams(const mvsUtils::MultiViewParams& mp, StaticVector<StaticVector<int>>& trisCams) const
+{
+    ALICEVISION_TRACE_ZONE("meshBVH::computeTrisCams");
+
+    trisCams.clear();
+    trisCams.resize(_mesh.tris.size());
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for(int i = 0; i < static_cast<int>(_triangleIndexes.size()); ++i)
+    {
+        const int idTri = _triangleIndexes[i];
+        const Point3d cg = _mesh.computeTriangleCenterOfGravity(idTri);
+        StaticVector<int>& cams = trisCams[idTri];
+        for(int rc = 0; rc < mp.ncams; ++rc)
+        {
+            if(isTriangleVisible(mp, rc, idTri, cg))
+                cams.push_back(rc);
+        }
+    }
+}
+
+bool MeshBVH::isTriangleVisible(const mvsUtils::MultiViewParams& mp, int cam, int idTri, const Point3d& cg) const
+{
+    if(_backFaceCulling && !isFacing(_triangleNormals[idTri], cg, mp.CArr[cam]))
+        return false;
+    return isVisible(mp, cam, cg, mp.getCamPixelSize(cg, cam));
+}
+
+bool MeshBVH::isVertexVisible(const mvsUtils::MultiViewParams& mp, int cam, int idVertex) const
+{
+    const Point3d& vertex = _mesh.pts[idVertex];
+    if(!isInFrustum(mp, cam, vertex))
+        return false;
+    if(_backFaceCulling && !isFacing(_vertexNormals[idVertex], vertex, mp.CArr[cam]))
+        return false;
+
+    // from the vertex to the camera, the triangles around the vertex are only hit at its position
+    const Point3d v = mp.CArr[cam] - vertex;
+    const double distance = v.size();
+    return !occluded(vertex, v / distance, _epsilon, distance);
+}
+
+void MeshBVH::computePointsVisibilities(const mvsUtils::MultiViewParams& mp, PointsVisibility& pointsVisibilities) const
+{
+    ALICEVISION_TRACE_ZONE("meshBVH::computePointsVisibilities");
+
+    pointsVisibilities.clear();
+    pointsVisibilities.resize(_mesh.pts.size());
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for(int i = 0; i < _mesh.pts.size(); ++i)
+    {
+        PointVisibility& visibility = pointsVisibilities[i];
+        for(int rc = 0; rc < mp.ncams; ++rc)
+        {
+            if(isVertexVisible(mp, rc, i))
+                visibility.push_back(rc);
+        }
+    }
+}
+
+std::size_t MeshBVH::filterPointsVisibilities(const mvsUtils::MultiViewParams& mp, PointsVisibility& pointsVisibilities) const
+{
+    ALICEVISION_TRACE_ZONE("meshBVH::filterPointsVisibilities");
+
+    if(pointsVisibilities.size() != _mesh.pts.size())
+        throw std::invalid_argument("MeshBVH: the visibilities do not match the vertices of the mesh.");
+
+    std::size_t nbRemoved = 0;
+
+    #pragma omp parallel for schedule(dynamic, 256) reduction(+:nbRemoved)
+    for(int i = 0; i < _mesh.pts.size(); ++i)
+    {
+        PointVisibility& visibility = pointsVisibilities[i];
+        PointVisibility filtered;
+        filtered.reserve(visibility.size());
+        for(int c = 0; c < visibility.size(); ++c)
+        {
+            if(isVertexVisible(mp, visibility[c], i))
+                filtered.push_back(visibility[c]);
+        }
+        nbRemoved += visibility.size() - filtered.size();
+        visibility.swap(filtered);
+    }
+    return nbRemoved;
+}
+
+} // namespace mesh
+} // namespace aliceVision
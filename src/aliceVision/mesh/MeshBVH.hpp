@@ -0,0 +1,192 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/Point3d.hpp>
+#include <aliceVision/mvsData/StaticVector.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace aliceVision {
+
+namespace mvsUtils {
+class MultiViewParams;
+}
+
+namespace mesh {
+
+/**
+ * @brief Bounding volume hierarchy over the alive triangles of a mesh, for ray casting.
+ *
+ * The hierarchy is built with a binned surface area heuristic. Rays sharing the same origin
+ * (the pixels of a camera) are traced by packets: a node is visited if any ray of the packet
+ * hits its box, and the triangles of a leaf are tested against all the rays of the packet at
+ * once, which amortizes the traversal and lets the compiler vectorize the tests.
+ *
+ * The triangles are stored in single precision, relatively to the center of the mesh.
+ * The visibility queries only keep the points in front of the camera and inside its image.
+ * With back-face culling, a triangle (or a vertex, with the area weighted normal of its triangles)
+ * is not visible by the cameras behind it, the back faces still occlude the rays.
+ * The mesh must outlive the BVH and must not be modified while the BVH is used.
+ * All the queries are const and can be called concurrently.
+ */
+class MeshBVH
+{
+public:
+    /// number of rays traced together by the packet traversal (a tile of 4x4 pixels)
+    static const int packetSize = 16;
+
+    struct Hit
+    {
+        /// index of the intersected triangle in the mesh, -1 if none
+        int triangle = -1;
+        /// distance along the ray direction
+        double t = 0.0;
+    };
+
+    /**
+     * @param[in] mesh the mesh
+     * @param[in] backFaceCulling the faces seen from behind are not visible, the normals of the mesh must face the cameras
+     */
+    explicit MeshBVH(const Mesh& mesh, bool backFaceCulling = false);
+
+    const Mesh& mesh() const { return _mesh; }
+    std::size_t getNbNodes() const { return _nodes.size(); }
+    std::size_t getNbTriangles() const { return _triangles.size(); }
+
+    /**
+     * @brief Find the closest intersection of a ray with the mesh.
+     * @param[in] origin the origin of the ray
+     * @param[in] direction the direction of the ray, t is expressed in units of its norm
+     * @param[in] tMin the minimal distance of the intersection
+     * @param[in] tMax the maximal distance of the intersection
+     * @param[out] hit the closest intersection
+     * @return true if the ray intersects the mesh between tMin and tMax
+     */
+    bool intersect(const Point3d& origin, const Point3d& direction, double tMin, double tMax, Hit& hit) const;
+
+    /**
+     * @brief Test if a ray intersects the mesh, stop at the first found intersection.
+     * @see intersect
+     */
+    bool occluded(const Point3d& origin, const Point3d& direction, double tMin, double tMax) const;
+
+    /**
+     * @brief Test if a point is in front of a camera, inside its image and not occluded by the mesh.
+     * @param[in] mp the multi-view parameters
+     * @param[in] cam the camera index
+     * @param[in] point the point to test
+     * @param[in] tolerance occlusions closer than this distance to the point are ignored
+     */
+    bool isVisible(const mvsUtils::MultiViewParams& mp, int cam, const Point3d& point, double tolerance) const;
+
+    /**
+     * @brief Render the depth map of the mesh seen by a camera.
+     * Same layout and values as Mesh::getDepthMap: the map is indexed by [x * h + y] and
+     * stores the distance to the camera center, -1 where the mesh is not seen.
+     * @param[in] mp the multi-view parameters
+     * @param[in] rc the camera index
+     * @param[in] scale the downscale factor of the map
+     * @param[in] w the width of the map
+     * @param[in] h the height of the map
+     * @param[out] depthMap the depth map
+     * @param[out] trisMap if not null, the index of the visible triangle per pixel, -1 if none
+     */
+    void renderDepthMap(const mvsUtils::MultiViewParams& mp, int rc, int scale, int w, int h,
+                        StaticVector<float>& depthMap, StaticVector<int>* trisMap = nullptr) const;
+
+    /**
+     * @brief Get the triangles whose center of gravity is visible by a camera.
+     * @param[in] mp the multi-view parameters
+     * @param[in] rc the camera index
+     * @param[out] out_visTri the sorted indexes of the visible triangles
+     */
+    void getVisibleTriangles(const mvsUtils::MultiViewParams& mp, int rc, StaticVector<int>& out_visTri) const;
+
+    /**
+     * @brief Compute the cameras seeing the center of gravity of each triangle of the mesh.
+     * Occlusion-correct replacement of Mesh::computeTrisCamsFromPtsCams.
+     * @param[in] mp the multi-view parameters
+     * @param[out] trisCams the sorted camera indexes per triangle
+     */
+    void computeTrisCams(const mvsUtils::MultiViewParams& mp, StaticVector<StaticVector<int>>& trisCams) const;
+
+    /**
+     * @brief Compute the cameras seeing each vertex of the mesh.
+     * @param[in] mp the multi-view parameters
+     * @param[out] pointsVisibilities the sorted camera indexes per vertex
+     */
+    void computePointsVisibilities(const mvsUtils::MultiViewParams& mp, PointsVisibility& pointsVisibilities) const;
+
+    /**
+     * @brief Remove the cameras for which the vertex is behind the camera, outside of the image,
+     * occluded by the mesh or back-facing.
+     * @param[in] mp the multi-view parameters
+     * @param[in,out] pointsVisibilities the camera indexes per vertex, as many as the vertices of the mesh
+     * @return the number of removed visibilities
+     */
+    std::size_t filterPointsVisibilities(const mvsUtils::MultiViewParams& mp, PointsVisibility& pointsVisibilities) const;
+
+private:
+    struct Node
+    {
+        float bmin[3];
+        float bmax[3];
+        /// leaf: index of the first triangle, internal node: index of the second child
+        /// (the first child is the next node)
+        std::int32_t offset;
+        /// number of triangles, 0 for an internal node
+        std::uint16_t count;
+        /// split axis of an internal node
+        std::uint16_t axis;
+    };
+
+    /// triangle as first vertex and two edges, in the BVH coordinate system
+    struct Triangle
+    {
+        float v0[3];
+        float e1[3];
+        float e2[3];
+    };
+
+    struct Packet;
+    struct BuildContext;
+
+    void build();
+    void buildNode(BuildContext& context, int nodeIndex, int begin, int end, int depth);
+
+    void intersectPacket(Packet& packet) const;
+
+    /// test if a point is in front of a camera and inside its image
+    bool isInFrustum(const mvsUtils::MultiViewParams& mp, int cam, const Point3d& point) const;
+
+    /// test if the center of gravity of a triangle of the mesh is visible by a camera
+    bool isTriangleVisible(const mvsUtils::MultiViewParams& mp, int cam, int idTri, const Point3d& cg) const;
+
+    /// test if a vertex of the mesh is in the frustum of a camera, facing it and not occluded by the mesh
+    bool isVertexVisible(const mvsUtils::MultiViewParams& mp, int cam, int idVertex) const;
+
+    const Mesh& _mesh;
+    const bool _backFaceCulling;
+    /// normal of each triangle of the mesh, only with back-face culling
+    std::vector<Point3d> _triangleNormals;
+    /// area weighted normal of each vertex of the mesh, only with back-face culling
+    std::vector<Point3d> _vertexNormals;
+    /// center of the mesh, origin of the BVH coordinate system
+    Point3d _center;
+    /// distance under which two surfaces are considered as the same one
+    double _epsilon = 0.0;
+    std::vector<Node> _nodes;
+    std::vector<Triangle> _triangles;
+    /// index in the mesh of each triangle of the BVH
+    std::vector<int> _triangleIndexes;
+};
+
+} // namespace mesh
+} // namespace aliceVision
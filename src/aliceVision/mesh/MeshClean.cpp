@@ -6,10 +6,24 @@
 
 #include "MeshClean.hpp"
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <vector>
 
 namespace aliceVision {
 namespace mesh {
 
+namespace {
+
+/// order of the edges sharing the same highest point
+bool compareEdgesByMinPtAndTri(const Voxel& a, const Voxel& b)
+{
+    return (a.y < b.y) || ((a.y == b.y) && (a.z < b.z));
+}
+
+} // namespace
+
 MeshClean::path::path(MeshClean* mesh, int ptId)
 : meshClean(mesh)
 , _ptId(ptId)
@@ -302,12 +316,10 @@ int MeshClean::path::deployTriangles(StaticVector<int>& trisIds, bool isBoundary
         meshClean->changeTriPtId(trisIds[i], _ptId, newPtId);
     }
 
-    meshClean->edgesNeigTrisAlive.reserveAddIfNeeded(trisIds.size() * 3, 3000);
-    meshClean->edgesNeigTris.reserveAddIfNeeded(trisIds.size() * 3, 3000);
-    meshClean->edgesXStat.reserveAddIfNeeded(trisIds.size() * 3, 3000);
-    meshClean->edgesXYStat.reserveAddIfNeeded(trisIds.size() * 3, 3000);
+    meshClean->edgesNeigTrisAlive.reserveAddIfNeeded(trisIds.size() * 2, 3000);
+    meshClean->edgesNeigTris.reserveAddIfNeeded(trisIds.size() * 2, 3000);
 
-    int i0 = meshClean->edgesNeigTris.size();
+    const int i0 = meshClean->edgesNeigTris.size();
 
     // in the case when the apth is not cycle
     for(int i = 0; i < trisIds.size(); i++)
@@ -319,30 +331,9 @@ int MeshClean::path::deployTriangles(StaticVector<int>& trisIds, bool isBoundary
         meshClean->edgesNeigTrisAlive.push_back(true);
     }
 
-    {
-        int i = meshClean->edgesNeigTris.size() - 1;
-
-        if(i - i0 + 1 > 1)
-            qsort(&meshClean->edgesNeigTris[i0], i - i0 + 1, sizeof(Voxel), qSortCompareVoxelByYAsc);
-
-        int xyI0 = meshClean->edgesXYStat.size();
-
-        int j0 = i0;
-        for(int j = i0; j <= i; j++)
-        {
-            if((j == i) || (meshClean->edgesNeigTris[j].y != meshClean->edgesNeigTris[j + 1].y))
-            {
-                if(j - j0 + 1 > 1)
-                    qsort(&meshClean->edgesNeigTris[j0], j - j0 + 1, sizeof(Voxel), qSortCompareVoxelByZAsc);
-
-                meshClean->edgesXYStat.push_back(Voxel(meshClean->edgesNeigTris[j].y, j0, j));
-                j0 = j + 1;
-            }
-        }
-
-        int xyI = meshClean->edgesXYStat.size() - 1;
-        meshClean->edgesXStat.push_back(Voxel(meshClean->edgesNeigTris[i].x, xyI0, xyI));
-    }
+    // the new point has the highest id, so its edges are added at the end of the table
+    std::sort(meshClean->edgesNeigTris.begin() + i0, meshClean->edgesNeigTris.end(), compareEdgesByMinPtAndTri);
+    meshClean->edgesPtsBegin.push_back(meshClean->edgesNeigTris.size());
 
     return newPtId;
 }
@@ -389,19 +380,24 @@ void MeshClean::path::clearPointNeighbors(int ptId)
 void MeshClean::path::updatePtNeighPtsOrderedByPath(int ptId, StaticVector<MeshClean::path::pathPart>& path)
 {
     clearPointNeighbors(ptId);
+    getPtNeighPtsOrderedByPath(path, meshClean->ptsNeighPtsOrdered[ptId]);
+}
+
+void MeshClean::path::getPtNeighPtsOrderedByPath(StaticVector<MeshClean::path::pathPart>& path, StaticVector<int>& out_ptNeighPtsOrdered)
+{
+    out_ptNeighPtsOrdered.clear();
 
     if( !path.empty() )
     {
-        StaticVector<int>& ptNeighPtsOrderedByPath = meshClean->ptsNeighPtsOrdered[ptId];
-        ptNeighPtsOrderedByPath.reserve(path.size() + 1);
+        out_ptNeighPtsOrdered.reserve(path.size() + 1);
 
         if(!isClodePath(path))
         {
-            ptNeighPtsOrderedByPath.push_back(path[0].ptsIds[0]);
+            out_ptNeighPtsOrdered.push_back(path[0].ptsIds[0]);
         }
         for(int i = 0; i < path.size(); i++)
         {
-            ptNeighPtsOrderedByPath.push_back(path[i].ptsIds[1]);
+            out_ptNeighPtsOrdered.push_back(path[i].ptsIds[1]);
         }
     }
 }
@@ -556,6 +552,35 @@ bool MeshClean::path::isWrongPt()
     return (nNewPtsNeededToAdd > 0);
 }
 
+bool MeshClean::path::getPtNeighPtsOrdered(StaticVector<int>& out_ptNeighPtsOrdered, bool& out_isBoundaryPt)
+{
+    StaticVector<int> ptNeighTrisSortedAscToProcess;
+    ptNeighTrisSortedAscToProcess.reserve(sizeOfStaticVector<int>(meshClean->ptsNeighTrisSortedAsc[_ptId]));
+    ptNeighTrisSortedAscToProcess.push_back_arr(meshClean->ptsNeighTrisSortedAsc[_ptId]);
+
+    StaticVector<MeshClean::path::pathPart> path;
+    createPath(ptNeighTrisSortedAscToProcess, path);
+
+    // some triangles are not connected to the others
+    if(ptNeighTrisSortedAscToProcess.size() > 0)
+    {
+        return false;
+    }
+
+    StaticVector<MeshClean::path::pathPart> pathNew;
+    removeCycleFromPath(path, pathNew);
+
+    // the path contains several cycles
+    if(path.size() > 0)
+    {
+        return false;
+    }
+
+    out_isBoundaryPt = !isClodePath(pathNew);
+    getPtNeighPtsOrderedByPath(pathNew, out_ptNeighPtsOrdered);
+    return true;
+}
+
 MeshClean::MeshClean(mvsUtils::MultiViewParams* _mp)
     : Mesh()
 {
@@ -577,13 +602,9 @@ void MeshClean::deallocateCleaningAttributes()
     {
         edgesNeigTrisAlive.clear();
     }
-    if(!edgesXStat.empty())
+    if(!edgesPtsBegin.empty())
     {
-        edgesXStat.clear();
-    }
-    if(!edgesXYStat.empty())
-    {
-        edgesXYStat.clear();
+        edgesPtsBegin.clear();
     }
     if(!ptsBoundary.empty())
     {
@@ -611,23 +632,21 @@ bool MeshClean::getEdgeNeighTrisInterval(Pixel& itr, int _ptId1, int _ptId2)
     int ptId2 = std::min(_ptId1, _ptId2);
     itr = Pixel(-1, -1);
 
-    int i1 = indexOfSortedVoxelArrByX(ptId1, edgesXStat, 0, edgesXStat.size() - 1);
-    if(i1 > -1)
+    if((ptId2 < 0) || (ptId1 >= edgesPtsBegin.size() - 1))
     {
-        int i2 = indexOfSortedVoxelArrByX(ptId2, edgesXYStat, edgesXStat[i1].y, edgesXStat[i1].z);
-        if(i2 > -1)
-        {
-            itr = Pixel(edgesXYStat[i2].y, edgesXYStat[i2].z);
-        }
-        else
-        {
-            return false;
-        }
+        return false;
     }
-    else
+
+    const auto first = edgesNeigTris.begin() + edgesPtsBegin[ptId1];
+    const auto last = edgesNeigTris.begin() + edgesPtsBegin[ptId1 + 1];
+    const auto range = std::equal_range(first, last, Voxel(ptId1, ptId2, 0),
+                                        [](const Voxel& a, const Voxel& b) { return a.y < b.y; });
+    if(range.first == range.second)
     {
         return false;
     }
+
+    itr = Pixel(range.first - edgesNeigTris.begin(), range.second - edgesNeigTris.begin() - 1);
     return true;
 }
 
@@ -635,83 +654,85 @@ void MeshClean::init()
 {
     deallocateCleaningAttributes();
 
-    getPtsNeighborTriangles(ptsNeighTrisSortedAsc);
-    for(int i = 0; i < pts.size(); i++)
+    const int nbPts = pts.size();
+    const int nbTris = tris.size();
+
+    // neighbor triangles of each point, filled by increasing triangle id so they are already sorted
     {
-        StaticVector<int>& ptNeigTris = ptsNeighTrisSortedAsc[i];
-        if(sizeOfStaticVector<int>(ptNeigTris) > 1)
+        std::vector<int> nbPtsNeighTris(nbPts, 0);
+        for(int i = 0; i < nbTris; i++)
         {
-            qsort(&ptNeigTris[0], ptNeigTris.size(), sizeof(int), qSortCompareIntAsc);
+            for(int k = 0; k < 3; k++)
+            {
+                ++nbPtsNeighTris[tris[i].v[k]];
+            }
         }
-    }
 
-    ptsNeighPtsOrdered.reserve(pts.size());
-    ptsNeighPtsOrdered.resize(pts.size());
+        ptsNeighTrisSortedAsc.resize(nbPts);
+        #pragma omp parallel for
+        for(int i = 0; i < nbPts; i++)
+        {
+            ptsNeighTrisSortedAsc[i].reserve(nbPtsNeighTris[i]);
+        }
+
+        for(int i = 0; i < nbTris; i++)
+        {
+            for(int k = 0; k < 3; k++)
+            {
+                ptsNeighTrisSortedAsc[tris[i].v[k]].push_back(i);
+            }
+        }
+    }
 
-    ptsBoundary.reserve(pts.size());
-    ptsBoundary.resize_with(pts.size(), true);
+    ptsNeighPtsOrdered.reserve(nbPts);
+    ptsNeighPtsOrdered.resize(nbPts);
 
-    newPtsOldPtId.reserve(pts.size());
-    nPtsInit = pts.size();
+    ptsBoundary.reserve(nbPts);
+    ptsBoundary.resize_with(nbPts, true);
 
-    edgesNeigTrisAlive.reserve(tris.size() * 3);
-    edgesNeigTris.reserve(tris.size() * 3);
-    edgesXStat.reserve(pts.size());
-    edgesXYStat.reserve(tris.size() * 3);
+    newPtsOldPtId.reserve(nbPts);
+    nPtsInit = nbPts;
 
-    for(int i = 0; i < tris.size(); i++)
+    // edges of the triangles bucketed by their highest point with a counting sort,
+    // then each bucket is sorted by lowest point and triangle
+    edgesPtsBegin.reserve(nbPts + 1);
+    edgesPtsBegin.resize_with(nbPts + 1, 0);
+    for(int i = 0; i < nbTris; i++)
     {
-        int a = tris[i].v[0];
-        int b = tris[i].v[1];
-        int c = tris[i].v[2];
-        edgesNeigTris.push_back(Voxel(std::max(a, b), std::min(a, b), i));
-        edgesNeigTris.push_back(Voxel(std::max(b, c), std::min(b, c), i));
-        edgesNeigTris.push_back(Voxel(std::max(c, a), std::min(c, a), i));
-
-        edgesNeigTrisAlive.push_back(true);
-        edgesNeigTrisAlive.push_back(true);
-        edgesNeigTrisAlive.push_back(true);
+        for(int k = 0; k < 3; k++)
+        {
+            ++edgesPtsBegin[std::max(tris[i].v[k], tris[i].v[(k + 1) % 3]) + 1];
+        }
     }
-
-    qsort(&edgesNeigTris[0], edgesNeigTris.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
-
-    // sort
-    int i0 = 0;
-    long t1 = mvsUtils::initEstimate();
-    for(int i = 0; i < edgesNeigTris.size(); i++)
+    for(int i = 0; i < nbPts; i++)
     {
+        edgesPtsBegin[i + 1] += edgesPtsBegin[i];
+    }
 
-        if((i == edgesNeigTris.size() - 1) || (edgesNeigTris[i].x != edgesNeigTris[i + 1].x))
+    edgesNeigTris.reserve(nbTris * 3);
+    edgesNeigTris.resize(nbTris * 3);
+    {
+        std::vector<int> edgesPtsEnd(edgesPtsBegin.begin(), edgesPtsBegin.end() - 1);
+        for(int i = 0; i < nbTris; i++)
         {
-            if(i - i0 + 1 > 1)
-                qsort(&edgesNeigTris[i0], i - i0 + 1, sizeof(Voxel), qSortCompareVoxelByYAsc);
-
-            int xyI0 = edgesXYStat.size();
-
-            int j0 = i0;
-            for(int j = i0; j <= i; j++)
+            for(int k = 0; k < 3; k++)
             {
-                if((j == i) || (edgesNeigTris[j].y != edgesNeigTris[j + 1].y))
-                {
-                    if(j - j0 + 1 > 1)
-                        qsort(&edgesNeigTris[j0], j - j0 + 1, sizeof(Voxel), qSortCompareVoxelByZAsc);
-
-                    edgesXYStat.push_back(Voxel(edgesNeigTris[j].y, j0, j));
-                    j0 = j + 1;
-                }
+                const int a = tris[i].v[k];
+                const int b = tris[i].v[(k + 1) % 3];
+                const int ptId = std::max(a, b);
+                edgesNeigTris[edgesPtsEnd[ptId]++] = Voxel(ptId, std::min(a, b), i);
             }
-
-            int xyI = edgesXYStat.size() - 1;
-
-            // printf("%i of %i\n",edgesXStat->size(),edgesXStat->reserved());
-            edgesXStat.push_back(Voxel(edgesNeigTris[i].x, xyI0, xyI));
-
-            i0 = i + 1;
         }
+    }
 
-        mvsUtils::printfEstimate(i, edgesNeigTris.size(), t1);
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for(int i = 0; i < nbPts; i++)
+    {
+        std::sort(edgesNeigTris.begin() + edgesPtsBegin[i], edgesNeigTris.begin() + edgesPtsBegin[i + 1], compareEdgesByMinPtAndTri);
     }
-    mvsUtils::finishEstimate();
+
+    edgesNeigTrisAlive.reserve(nbTris * 3);
+    edgesNeigTrisAlive.resize_with(nbTris * 3, true);
 }
 
 void MeshClean::testPtsNeighTrisSortedAsc()
@@ -847,12 +868,68 @@ void MeshClean::testPtsNeighPtsOrdered()
 
 int MeshClean::cleanMesh()
 {
+    const int nv = pts.size();
+
+    // Most of the points do not need to be deployed, their ordered neighbors are computed concurrently
+    // from the current mesh. The other points are then processed sequentially in the same order as
+    // before, with the points whose neighborhood has been modified by a previous deployment,
+    // so the result does not depend on the number of threads.
+    std::vector<char> isPtReady(nv, 0);
+    std::vector<char> isPtReadyBoundary(nv, 0);
+    StaticVector<StaticVector<int>> ptsNeighPtsOrderedReady(nv);
+
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for(int i = 0; i < nv; i++)
+    {
+        try
+        {
+            path pth(this, i);
+            bool isBoundaryPt = true;
+            if(pth.getPtNeighPtsOrdered(ptsNeighPtsOrderedReady[i], isBoundaryPt))
+            {
+                isPtReady[i] = 1;
+                isPtReadyBoundary[i] = static_cast<char>(isBoundaryPt);
+            }
+        }
+        catch(const std::exception&)
+        {
+            // the point is processed sequentially, which reports the error
+        }
+    }
+
     int nWrongPts = 0;
-    int nv = pts.size();
+    std::vector<char> isPtModified(nv, 0);
     for(int i = 0; i < nv; i++)
     {
+        if(isPtReady[i] && !isPtModified[i])
+            continue;
+
+        isPtReady[i] = 0;
+        const StaticVector<int> ptNeighTris = ptsNeighTrisSortedAsc[i];
+
         path pth(this, i);
-        nWrongPts += static_cast<int>(pth.deployAll() > 0);
+        if(pth.deployAll() > 0)
+        {
+            ++nWrongPts;
+            for(int j = 0; j < ptNeighTris.size(); j++)
+            {
+                for(int k = 0; k < 3; k++)
+                {
+                    const int ptId = tris[ptNeighTris[j]].v[k];
+                    if((ptId > i) && (ptId < nv))
+                        isPtModified[ptId] = 1;
+                }
+            }
+        }
+    }
+
+    for(int i = 0; i < nv; i++)
+    {
+        // deployAll does not modify a point without triangles
+        if(!isPtReady[i] || ptsNeighTrisSortedAsc[i].empty())
+            continue;
+        ptsBoundary[i] = isPtReadyBoundary[i];
+        ptsNeighPtsOrdered[i].swap(ptsNeighPtsOrderedReady[i]);
     }
     // update vertex color data (if any) if points were modified
     if(_colors.size() > 0 && newPtsOldPtId.size() != 0)
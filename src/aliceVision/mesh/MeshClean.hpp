@@ -65,9 +65,17 @@ public:
         bool isClodePath(StaticVector<pathPart>& path);
         void clearPointNeighbors(int ptId);
         void updatePtNeighPtsOrderedByPath(int ptId, StaticVector<pathPart>& path);
+        void getPtNeighPtsOrderedByPath(StaticVector<pathPart>& path, StaticVector<int>& out_ptNeighPtsOrdered);
         void createPath(StaticVector<int>& ptNeighTrisSortedAscToProcess, StaticVector<pathPart>& out_path);
         int deployAll();
         bool isWrongPt();
+        /**
+         * @brief Read-only version of deployAll for a point which does not need to be deployed.
+         * @param[out] out_ptNeighPtsOrdered the ordered neighbor points that deployAll would set
+         * @param[out] out_isBoundaryPt the boundary flag that deployAll would set
+         * @return false if the point needs to be deployed (outputs are not set)
+         */
+        bool getPtNeighPtsOrdered(StaticVector<int>& out_ptNeighPtsOrdered, bool& out_isBoundaryPt);
     };
 
     mvsUtils::MultiViewParams* mp;
@@ -78,9 +86,11 @@ public:
     StaticVector<int> newPtsOldPtId;
 
     StaticVectorBool edgesNeigTrisAlive;
+    /// (x: max point id, y: min point id, z: triangle id) for each edge of each triangle,
+    /// sorted by x, then y, then z
     StaticVector<Voxel> edgesNeigTris;
-    StaticVector<Voxel> edgesXStat;
-    StaticVector<Voxel> edgesXYStat;
+    /// the edges whose highest point is p are edgesNeigTris[edgesPtsBegin[p]] to edgesNeigTris[edgesPtsBegin[p + 1] - 1]
+    StaticVector<int> edgesPtsBegin;
 
     int nPtsInit;
 
@@ -9,7 +9,7 @@
 #include "UVAtlas.hpp"
 
 #include <aliceVision/system/Logger.hpp>
-#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/mvsData/Color.hpp>
 #include <aliceVision/mvsData/geometry.hpp>
@@ -133,7 +133,7 @@ void Texturing::generateUVsBasicMethod(mvsUtils::MultiViewParams& mp)
 
     // automatic uv atlasing
     ALICEVISION_LOG_INFO("Generating UVs (textureSide: " << texParams.textureSide << "; padding: " << texParams.padding << ").");
-    UVAtlas mua(*mesh, mp, texParams.textureSide, texParams.padding);
+    UVAtlas mua(*mesh, mp, texParams.textureSide, texParams.padding, texParams.rayCastVisibility, texParams.rayCastBackFaceCulling);
 
     // create a new mesh to store data
     mesh->trisUvIds.reserve(mesh->tris.size());
@@ -263,13 +263,14 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
     ALICEVISION_LOG_INFO("Images loaded from cache with: " + imageCache.ECorrectEV_enumToString(texParams.correctEV));
 
     //calculate the maximum number of atlases in memory in MB
-    system::MemoryInfo memInfo = system::getMemoryInfo();
+    system::MemoryBudget& memoryBudget = system::MemoryBudget::get();
     const std::size_t imageMaxMemSize =  mp.getMaxImageWidth() * mp.getMaxImageHeight() * sizeof(Color) / std::pow(2,20); //MB
     const std::size_t imagePyramidMaxMemSize = texParams.nbBand * imageMaxMemSize;
     const std::size_t atlasContribMemSize = texParams.textureSide * texParams.textureSide * (sizeof(Color)+sizeof(float)) / std::pow(2,20); //MB
     const std::size_t atlasPyramidMaxMemSize = texParams.nbBand * atlasContribMemSize;
 
-    const int freeRam = int(memInfo.freeRam / std::pow(2,20));
+    // the budget is not limited if the free RAM is unknown
+    const int freeRam = static_cast<int>(std::min<std::size_t>(memoryBudget.getAvailableMemory() >> 20, std::numeric_limits<int>::max()));
     const int availableMem = freeRam - 2 * imageMaxMemSize - imagePyramidMaxMemSize; // keep some memory for the 2 input images in cache and one laplacian pyramid
 
     const int nbAtlas = _atlases.size();
@@ -279,7 +280,7 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
         nbAtlasMax -= 1;
     nbAtlasMax = std::max(1, nbAtlasMax); //if not enough memory, do it one by one
 
-    ALICEVISION_LOG_INFO("Total amount of free RAM  : " << freeRam << " MB.");
+    ALICEVISION_LOG_INFO("Total amount of free RAM in the memory budget : " << freeRam << " MB.");
     ALICEVISION_LOG_INFO("Total amount of memory available : " << availableMem << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an image in memory  : " << imageMaxMemSize << " MB.");
     ALICEVISION_LOG_INFO("Total amount of an atlas pyramid in memory: " << atlasPyramidMaxMemSize << " MB.");
@@ -301,6 +302,7 @@ void Texturing::generateTextures(const mvsUtils::MultiViewParams& mp,
             atlasIDs.push_back(atlasID);
         }
         ALICEVISION_LOG_INFO("Generating texture for atlases " << n*nbAtlasMax + 1 << " to " << n*nbAtlasMax+imax );
+        const system::MemoryReservation memoryReservation = memoryBudget.reserve("texturing", (imax * atlasPyramidMaxMemSize + imagePyramidMaxMemSize) << 20);
         generateTexturesSubSet(mp, atlasIDs, imageCache, outPath, textureFileType);
     }
 }
@@ -467,6 +469,16 @@ void Texturing::generateTexturesSubSet(const mvsUtils::MultiViewParams& mp,
 
         // Load camera image from cache
         mvsUtils::ImagesCache::ImgSharedPtr imgPtr = imageCache.getImg_sync(camId);
+
+        // the next contributing camera is loaded while this one is processed
+        for(int nextCamId = camId + 1; nextCamId < contributionsPerCamera.size(); ++nextCamId)
+        {
+            if(!contributionsPerCamera[nextCamId].empty())
+            {
+                imageCache.prefetch(nextCamId);
+                break;
+            }
+        }
         const Image& camImg = *imgPtr;
 
         // Calculate laplacianPyramid
@@ -827,11 +839,14 @@ void Texturing::loadOBJWithAtlas(const std::string& filename, bool flipNormals)
     // Clear internal data
     clear();
     mesh = new Mesh();
-    // Load .obj
-    if(!mesh->loadFromObjAscii(filename.c_str()))
+    // Load .obj, .ply or .avmesh
+    if(!mesh->load(filename))
     {
         throw std::runtime_error("Unable to load: " + filename);
     }
+    // The visibilities stored in a .avmesh file are not used: they are remapped from the reference mesh,
+    // so that a mesh is textured the same way whatever its file format
+    mesh->pointsVisibilities.clear();
 
     // Handle normals flipping
     if(flipNormals)
@@ -861,6 +876,11 @@ void Texturing::remapVisibilities(EVisibilityRemappingMethod remappingMethod, co
     throw std::runtime_error("No visibility after visibility remapping.");
 }
 
+void Texturing::removeOccludedVisibilities(const mvsUtils::MultiViewParams& mp)
+{
+    mesh::removeOccludedVisibilities(mp, *mesh, mesh->pointsVisibilities, texParams.rayCastBackFaceCulling);
+}
+
 void Texturing::replaceMesh(const std::string& otherMeshPath, bool flipNormals)
 {
     // keep previous mesh/visibilities as reference
@@ -84,6 +84,8 @@ struct TexturingParams
 
     bool forceVisibleByAllVertices = false; //< triangle visibility is based on the union of vertices visiblity
     EVisibilityRemappingMethod visibilityRemappingMethod = EVisibilityRemappingMethod::PullPush;
+    bool rayCastVisibility = false; //< check the visibilities against the occlusions by the mesh itself with ray casting
+    bool rayCastBackFaceCulling = false; //< with the ray casting check, also remove the cameras seeing the surface from behind
 
     float subdivisionTargetRatio = 0.8;
 };
@@ -106,7 +108,7 @@ public:
     /// Clear internal mesh data
     void clear();
 
-    /// Load a mesh from a .obj file and initialize internal structures
+    /// Load a mesh from a .obj, .ply or .avmesh file and initialize internal structures (the points visibilities of the file are not kept)
     void loadOBJWithAtlas(const std::string& filename, bool flipNormals=false);
 
     /**
@@ -118,6 +120,16 @@ public:
      */
     void remapVisibilities(EVisibilityRemappingMethod remappingMethod, const Mesh& refMesh);
 
+    /**
+     * @brief Remove the visibilities of the vertices occluded by the mesh itself, using ray casting.
+     * Visibilities remapped from the reconstruction ignore the occlusions, which are wrong
+     * after the filtering or the decimation of the mesh.
+     * The back-facing visibilities are also removed if texParams.rayCastBackFaceCulling is set.
+     *
+     * @param[in] mp the multi-view parameters
+     */
+    void removeOccludedVisibilities(const mvsUtils::MultiViewParams& mp);
+
     /**
      * @brief Replace inner mesh with the mesh loaded from 'otherMeshPath'
      *        and remap visibilities from the first to the second
@@ -5,8 +5,11 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "UVAtlas.hpp"
+#include <aliceVision/mesh/MeshBVH.hpp>
+#include <aliceVision/stl/parallelSort.hpp>
 #include <aliceVision/system/Logger.hpp>
 
+#include <atomic>
 #include <iostream>
 
 namespace aliceVision {
@@ -15,7 +18,8 @@ namespace mesh {
 using namespace std;
 
 UVAtlas::UVAtlas(const Mesh& mesh, mvsUtils::MultiViewParams& mp,
-                                 unsigned int textureSide, unsigned int gutterSize)
+                                 unsigned int textureSide, unsigned int gutterSize, bool rayCastVisibility,
+                                 bool backFaceCulling)
     : _textureSide(textureSide)
     , _gutterSize(gutterSize)
     , _mesh(mesh)
@@ -23,7 +27,7 @@ UVAtlas::UVAtlas(const Mesh& mesh, mvsUtils::MultiViewParams& mp,
     vector<Chart> charts;
 
     // create texture charts
-    createCharts(charts, mp);
+    createCharts(charts, mp, rayCastVisibility, backFaceCulling);
 
     // pack texture charts
     packCharts(charts, mp);
@@ -35,13 +39,21 @@ UVAtlas::UVAtlas(const Mesh& mesh, mvsUtils::MultiViewParams& mp,
     createTextureAtlases(charts, mp);
 }
 
-void UVAtlas::createCharts(vector<Chart>& charts, mvsUtils::MultiViewParams& mp)
+void UVAtlas::createCharts(vector<Chart>& charts, mvsUtils::MultiViewParams& mp, bool rayCastVisibility, bool backFaceCulling)
 {
     ALICEVISION_LOG_INFO("Creating texture charts.");
 
     // compute per cam triangle visibility
     StaticVector<StaticVector<int>> trisCams;
-    _mesh.computeTrisCamsFromPtsCams(trisCams);
+    if(rayCastVisibility)
+    {
+        const MeshBVH bvh(_mesh, backFaceCulling);
+        bvh.computeTrisCams(mp, trisCams);
+    }
+    else
+    {
+        _mesh.computeTrisCamsFromPtsCams(trisCams);
+    }
 
     // create one chart per triangle
     _triangleCameraIDs.resize(_mesh.tris.size());
@@ -52,7 +64,7 @@ void UVAtlas::createCharts(vector<Chart>& charts, mvsUtils::MultiViewParams& mp)
         std::vector<std::pair<float, int>> commonCameraIDs;
 
         // project triangle in all cams
-        auto cameras = trisCams[i];
+        const StaticVector<int>& cameras = trisCams[i];
         for(int c = 0; c < cameras.size(); ++c)
         {
             int cameraID = cameras[c];
@@ -92,91 +104,149 @@ void UVAtlas::packCharts(vector<Chart>& charts, mvsUtils::MultiViewParams& mp)
 {
     ALICEVISION_LOG_INFO("Packing texture charts (" <<  charts.size() << " charts).");
 
-    function<int(int)> findChart = [&](int cid)
+    const auto findChart = [&](int cid)
     {
-        Chart& c = charts[cid];
-        if(c.mergedWith >= 0)
+        int root = cid;
+        while(charts[root].mergedWith >= 0)
+            root = charts[root].mergedWith;
+        // path compression
+        while(charts[cid].mergedWith >= 0)
         {
-            int r = findChart(c.mergedWith);
-            c.mergedWith = r;
-            return r;
+            const int next = charts[cid].mergedWith;
+            charts[cid].mergedWith = root;
+            cid = next;
         }
-        return cid;
+        return root;
     };
 
     // list mesh edges (with duplicates)
-    vector<Edge> alledges;
-    for(int i = 0; i < _mesh.tris.size(); ++i)
+    const int nbTriangles = _mesh.tris.size();
+    vector<Edge> alledges(3 * static_cast<size_t>(nbTriangles));
+    #pragma omp parallel for
+    for(int i = 0; i < nbTriangles; ++i)
     {
-        int a = _mesh.tris[i].v[0];
-        int b = _mesh.tris[i].v[1];
-        int c = _mesh.tris[i].v[2];
-        Edge e1;
-        e1.pointIDs = make_pair(min(a, b), max(a, b));
-        e1.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e1);
-        Edge e2;
-        e2.pointIDs = make_pair(min(b, c), max(b, c));
-        e2.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e2);
-        Edge e3;
-        e3.pointIDs = make_pair(min(c, a), max(c, a));
-        e3.triangleIDs.emplace_back(i);
-        alledges.emplace_back(e3);
+        for(int k = 0; k < 3; ++k)
+        {
+            const std::uint32_t a = _mesh.tris[i].v[k];
+            const std::uint32_t b = _mesh.tris[i].v[(k + 1) % 3];
+            Edge& e = alledges[3 * static_cast<size_t>(i) + k];
+            e.pointIDs = (static_cast<std::uint64_t>(min(a, b)) << 32) | max(a, b);
+            e.triangleID = i;
+        }
     }
-    sort(alledges.begin(), alledges.end());
+    // stable: the triangles of an edge stay sorted
+    stl::parallel_stable_sort(alledges.begin(), alledges.end(), [](const Edge& a, const Edge& b)
+    {
+        return a.pointIDs < b.pointIDs;
+    });
 
-    // merge edges (no duplicate)
-    vector<Edge> edges;
-    auto eit = alledges.begin() + 1;
-    while(eit != alledges.end())
+    // pairs of triangles sharing an edge, in edges order
+    vector<pair<int, int>> adjacentTriangles;
+    for(size_t i = 1; i < alledges.size(); ++i)
     {
-        auto& a = *(eit-1);
-        auto& b = *eit;
-        if(a == b)
+        if(alledges[i - 1].pointIDs == alledges[i].pointIDs)
+            adjacentTriangles.emplace_back(alledges[i - 1].triangleID, alledges[i].triangleID);
+    }
+    vector<Edge>().swap(alledges);
+
+    // connected components of the triangles, with a concurrent union-find linking to the smallest index
+    vector<std::atomic<int>> parents(nbTriangles);
+    #pragma omp parallel for
+    for(int i = 0; i < nbTriangles; ++i)
+        parents[i].store(i, std::memory_order_relaxed);
+
+    const auto findComponent = [&](int i)
+    {
+        int parent = parents[i].load();
+        while(parent != i)
         {
-            a.triangleIDs.insert(a.triangleIDs.end(), b.triangleIDs.begin(), b.triangleIDs.end());
-            sort(a.triangleIDs.begin(), a.triangleIDs.end());
-            edges.push_back(a);
+            // path halving
+            const int grandParent = parents[parent].load();
+            if(grandParent != parent)
+                parents[i].compare_exchange_weak(parent, grandParent);
+            i = grandParent;
+            parent = parents[i].load();
         }
-        ++eit;
-    }
-    alledges.clear();
+        return i;
+    };
 
-    // merge charts
-    for(auto& e : edges)
+    #pragma omp parallel for
+    for(int i = 0; i < static_cast<int>(adjacentTriangles.size()); ++i)
     {
-        if(e.triangleIDs.size() != 2)
-            continue;
-        int chartIDA = findChart(e.triangleIDs[0]);
-        int chartIDB = findChart(e.triangleIDs[1]);
-        if(chartIDA == chartIDB)
-            continue;
-        Chart& a = charts[chartIDA];
-        Chart& b = charts[chartIDB];
-        vector<int> cameraIntersection;
-        set_intersection(
-                    a.commonCameraIDs.begin(), a.commonCameraIDs.end(),
-                    b.commonCameraIDs.begin(), b.commonCameraIDs.end(),
-                    back_inserter(cameraIntersection));
-        if(cameraIntersection.size() == 0) // need at least 1 camera in common
-            continue;
-        if(a.triangleIDs.size() > b.triangleIDs.size())
+        int a = adjacentTriangles[i].first;
+        int b = adjacentTriangles[i].second;
+        while(true)
         {
-            // merge b in a
-            a.commonCameraIDs = cameraIntersection;
-            a.triangleIDs.insert(a.triangleIDs.end(), b.triangleIDs.begin(), b.triangleIDs.end());
-            b.mergedWith = chartIDA;
+            a = findComponent(a);
+            b = findComponent(b);
+            if(a == b)
+                break;
+            if(a < b)
+                std::swap(a, b);
+            int expected = a;
+            if(parents[a].compare_exchange_strong(expected, b))
+                break;
         }
-        else
+    }
+
+    // group the pairs by component, keeping their order inside each component
+    vector<pair<int, int>> componentPairs(adjacentTriangles.size()); // <component, pair index>
+    #pragma omp parallel for
+    for(int i = 0; i < static_cast<int>(adjacentTriangles.size()); ++i)
+        componentPairs[i] = make_pair(findComponent(adjacentTriangles[i].first), i);
+    vector<std::atomic<int>>().swap(parents);
+    stl::parallel_stable_sort(componentPairs.begin(), componentPairs.end(), [](const pair<int, int>& a, const pair<int, int>& b)
+    {
+        return a.first < b.first;
+    });
+
+    vector<size_t> componentBegins;
+    for(size_t i = 0; i < componentPairs.size(); ++i)
+    {
+        if(i == 0 || componentPairs[i].first != componentPairs[i - 1].first)
+            componentBegins.push_back(i);
+    }
+    componentBegins.push_back(componentPairs.size());
+
+    // merge charts: the charts of different components are independent, and inside a component
+    // the pairs are processed in edges order, so the result does not depend on the number of threads
+    #pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < static_cast<int>(componentBegins.size()) - 1; ++c)
+    {
+        for(size_t p = componentBegins[c]; p < componentBegins[c + 1]; ++p)
         {
-            // merge a in b
-            b.commonCameraIDs = cameraIntersection;
-            b.triangleIDs.insert(b.triangleIDs.end(), a.triangleIDs.begin(), a.triangleIDs.end());
-            a.mergedWith = chartIDB;
+            const pair<int, int>& triangles = adjacentTriangles[componentPairs[p].second];
+            int chartIDA = findChart(triangles.first);
+            int chartIDB = findChart(triangles.second);
+            if(chartIDA == chartIDB)
+                continue;
+            Chart& a = charts[chartIDA];
+            Chart& b = charts[chartIDB];
+            vector<int> cameraIntersection;
+            set_intersection(
+                        a.commonCameraIDs.begin(), a.commonCameraIDs.end(),
+                        b.commonCameraIDs.begin(), b.commonCameraIDs.end(),
+                        back_inserter(cameraIntersection));
+            if(cameraIntersection.size() == 0) // need at least 1 camera in common
+                continue;
+            if(a.triangleIDs.size() > b.triangleIDs.size())
+            {
+                // merge b in a
+                a.commonCameraIDs = cameraIntersection;
+                a.triangleIDs.insert(a.triangleIDs.end(), b.triangleIDs.begin(), b.triangleIDs.end());
+                vector<int>().swap(b.triangleIDs);
+                b.mergedWith = chartIDA;
+            }
+            else
+            {
+                // merge a in b
+                b.commonCameraIDs = cameraIntersection;
+                b.triangleIDs.insert(b.triangleIDs.end(), a.triangleIDs.begin(), a.triangleIDs.end());
+                vector<int>().swap(a.triangleIDs);
+                a.mergedWith = chartIDB;
+            }
         }
     }
-    edges.clear();
 
     // remove merged charts
     charts.erase(remove_if(charts.begin(), charts.end(), [](Chart& c)
@@ -189,7 +259,8 @@ void UVAtlas::finalizeCharts(vector<Chart>& charts, mvsUtils::MultiViewParams& m
 {
     ALICEVISION_LOG_INFO("Finalize packed charts (" <<  charts.size() << " charts).");
 
-    #pragma omp parallel for
+    // the charts have very different sizes
+    #pragma omp parallel for schedule(dynamic)
     for(int i = 0; i < charts.size(); ++i)
     {
         auto& chart = charts[i];
@@ -311,7 +382,45 @@ void UVAtlas::ChartRect::clear()
     delete child[1];
 }
 
+void UVAtlas::ChartRect::updateFreeSpace()
+{
+    if(child[0] || child[1])
+    {
+        maxFreeWidth = 0;
+        maxFreeHeight = 0;
+        for(const ChartRect* rect : child)
+        {
+            if(!rect)
+                continue;
+            maxFreeWidth = max(maxFreeWidth, rect->maxFreeWidth);
+            maxFreeHeight = max(maxFreeHeight, rect->maxFreeHeight);
+        }
+    }
+    else if(c)
+    {
+        maxFreeWidth = 0;
+        maxFreeHeight = 0;
+    }
+    else
+    {
+        maxFreeWidth = RD.x - LU.x;
+        maxFreeHeight = RD.y - LU.y;
+    }
+}
+
 UVAtlas::ChartRect* UVAtlas::ChartRect::insert(Chart& chart, size_t gutter)
+{
+    // skip the subtrees without any free leaf large enough,
+    // it gives the same result as visiting them and is much faster on full atlases
+    if(chart.targetWidth() + gutter * 2 > maxFreeWidth || chart.targetHeight() + gutter * 2 > maxFreeHeight)
+        return nullptr;
+
+    ChartRect* rect = insertInSubtree(chart, gutter);
+    updateFreeSpace();
+    return rect;
+}
+
+UVAtlas::ChartRect* UVAtlas::ChartRect::insertInSubtree(Chart& chart, size_t gutter)
 {
     if(child[0] || child[1]) // not a leaf
     {
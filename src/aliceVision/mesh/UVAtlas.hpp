@@ -9,6 +9,8 @@
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mesh/Mesh.hpp>
 
+#include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace aliceVision {
@@ -17,12 +19,11 @@ namespace mesh {
 class UVAtlas
 {
 public:
+    /// edge of a triangle
     struct Edge
     {
-        std::pair<int, int> pointIDs;
-        std::vector<int> triangleIDs;
-        bool operator<(const Edge& other) const { return pointIDs < other.pointIDs; }
-        bool operator==(const Edge& other) const { return pointIDs == other.pointIDs; }
+        std::uint64_t pointIDs;                                 // sorted vertex IDs, packed in 64 bits
+        int triangleID;
     };
 
     struct Chart
@@ -52,13 +53,24 @@ public:
         ChartRect* child[2] {nullptr, nullptr};
         Pixel LU;
         Pixel RD;
+        // upper bounds of the size of the free leaves of this subtree
+        size_t maxFreeWidth = std::numeric_limits<size_t>::max();
+        size_t maxFreeHeight = std::numeric_limits<size_t>::max();
         void clear();
         ChartRect* insert(Chart& chart, size_t gutter);
+        ChartRect* insertInSubtree(Chart& chart, size_t gutter);
+        void updateFreeSpace();
     };
 
 public:
+    /**
+     * @param[in] rayCastVisibility compute the cameras seeing each triangle by ray casting on the mesh,
+     *            instead of using the visibilities of its vertices
+     * @param[in] backFaceCulling with rayCastVisibility, the cameras seeing a triangle from behind do not see it
+     */
     UVAtlas(const Mesh& mesh, mvsUtils::MultiViewParams& mp,
-                    unsigned int textureSide, unsigned int gutterSize);
+                    unsigned int textureSide, unsigned int gutterSize, bool rayCastVisibility = false,
+                    bool backFaceCulling = false);
 
 public:
     const std::vector<std::vector<Chart>>& atlases() const { return _atlases; }
@@ -68,7 +80,7 @@ public:
     inline int chartMaxSize() const { return (_textureSide - 1) - _gutterSize * 2; }
 
 private:
-    void createCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp);
+    void createCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp, bool rayCastVisibility, bool backFaceCulling);
     void packCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp);
     void finalizeCharts(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp);
     void createTextureAtlases(std::vector<Chart>& charts, mvsUtils::MultiViewParams& mp);
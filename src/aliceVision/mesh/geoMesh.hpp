@@ -1,9 +1,12 @@
 #pragma once
 
 #include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/meshIO.hpp>
 
 #include <geogram/mesh/mesh.h>
 
+#include <algorithm>
+
 
 namespace aliceVision {
 namespace mesh {
@@ -41,5 +44,53 @@ inline void toGeoMesh(const Mesh& src, GEO::Mesh& dst)
     assert(src.tris.size() == dst.facets.nb());
 }
 
+/**
+* @brief Create a Geogram GEO::Mesh from a mapped AliceVision mesh file
+*        (the indexes of the triangles are checked by the reader)
+*
+* @note only initialize vertices and facets
+* @param[in] the source mesh file
+* @param[out] the destination GEO::Mesh
+*/
+inline void toGeoMesh(const MeshFileReader& src, GEO::Mesh& dst)
+{
+    GEO::vector<double> vertices(src.getNbPoints() * 3);
+    std::copy(src.getPoints(), src.getPoints() + vertices.size(), vertices.begin());
+    GEO::vector<GEO::index_t> facets(src.getNbTriangles() * 3);
+    std::copy(src.getTriangles(), src.getTriangles() + facets.size(), facets.begin());
+
+    dst.facets.assign_triangle_mesh(3, vertices, facets, true);
+    dst.facets.connect();
+
+    assert(src.getNbPoints() == dst.vertices.nb());
+    assert(src.getNbTriangles() == dst.facets.nb());
+}
+
+/**
+* @brief Create an aliceVision::Mesh from a Geogram GEO::Mesh
+*
+* @note only initialize vertices and triangles, polygonal facets are split into triangles fans
+* @param[in] the source GEO::Mesh
+* @param[out] the destination aliceVision mesh
+*/
+inline void fromGeoMesh(const GEO::Mesh& src, Mesh& dst)
+{
+    dst = Mesh();
+    dst.pts.reserve(src.vertices.nb());
+    dst.tris.reserve(src.facets.nb());
+
+    for(GEO::index_t v = 0; v < src.vertices.nb(); ++v)
+    {
+        const double* point = src.vertices.point_ptr(v);
+        dst.pts.push_back(Point3d(point[0], point[1], point[2]));
+    }
+
+    for(GEO::index_t f = 0; f < src.facets.nb(); ++f)
+    {
+        for(GEO::index_t lv = 1; lv + 1 < src.facets.nb_vertices(f); ++lv)
+            dst.tris.push_back(Mesh::triangle(src.facets.vertex(f, 0), src.facets.vertex(f, lv), src.facets.vertex(f, lv + 1)));
+    }
+}
+
 }
 }
@@ -0,0 +1,244 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/MeshBVH.hpp>
+#include <aliceVision/mesh/meshVisibility.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+
+#define BOOST_TEST_MODULE meshBVH
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+/// closest intersection by testing all the triangles, in double precision
+bool bruteForceIntersect(const Mesh& mesh, const Point3d& o, const Point3d& d, double tMax, int& closest, double& closestT)
+{
+    closest = -1;
+    closestT = tMax;
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        if(!mesh.tris[i].alive)
+            continue;
+        const Point3d& v0 = mesh.pts[mesh.tris[i].v[0]];
+        const Point3d e1 = mesh.pts[mesh.tris[i].v[1]] - v0;
+        const Point3d e2 = mesh.pts[mesh.tris[i].v[2]] - v0;
+        const Point3d p = cross(d, e2);
+        const double det = dot(e1, p);
+        if(std::abs(det) < 1e-12)
+            continue;
+        const Point3d s = o - v0;
+        const double u = dot(s, p) / det;
+        const Point3d q = cross(s, e1);
+        const double v = dot(d, q) / det;
+        const double t = dot(e2, q) / det;
+        if(u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t > 0.0 && t < closestT)
+        {
+            closestT = t;
+            closest = i;
+        }
+    }
+    return closest >= 0;
+}
+
+/**
+ * @brief Pinhole cameras of 100x100 pixels on the z axis (no image file, the matrices come from the SfMData):
+ *  - camera 0 at z=0 looking toward +z,
+ *  - camera 1 at z=10 looking toward -z,
+ *  - camera 2 at z=10 looking toward +z.
+ */
+void addCameras(sfmData::SfMData& sfmData)
+{
+    sfmData.intrinsics[0] = std::make_shared<camera::Pinhole>(100, 100, 100.0, 50.0, 50.0);
+
+    const Mat3 flip = Vec3(1.0, -1.0, -1.0).asDiagonal();
+    const std::vector<std::pair<Mat3, Vec3>> poses = {{Mat3::Identity(), Vec3(0.0, 0.0, 0.0)},
+                                                      {flip, Vec3(0.0, 0.0, 10.0)},
+                                                      {Mat3::Identity(), Vec3(0.0, 0.0, 10.0)}};
+    for(IndexT i = 0; i < poses.size(); ++i)
+    {
+        sfmData.views[i] = std::make_shared<sfmData::View>("", i, 0, i, 100, 100);
+        sfmData.setPose(*sfmData.views[i], sfmData::CameraPose(geometry::Pose3(poses[i].first, poses[i].second)));
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshBVH_randomTriangles)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> position(-10.0, 10.0);
+    std::uniform_real_distribution<double> offset(-0.5, 0.5);
+
+    // random small triangles, with an offset as in a geo-referenced scene
+    const Point3d sceneOffset(1000.0, -2000.0, 500.0);
+    Mesh mesh;
+    const int nbTriangles = 2000;
+    for(int i = 0; i < nbTriangles; ++i)
+    {
+        const Point3d center = Point3d(position(generator), position(generator), position(generator)) + sceneOffset;
+        for(int k = 0; k < 3; ++k)
+            mesh.pts.push_back(center + Point3d(offset(generator), offset(generator), offset(generator)));
+        mesh.tris.push_back(Mesh::triangle(3 * i, 3 * i + 1, 3 * i + 2));
+    }
+    // dead triangles are ignored
+    for(int i = 0; i < nbTriangles; i += 10)
+        mesh.tris[i].alive = false;
+
+    const MeshBVH bvh(mesh);
+    BOOST_CHECK_EQUAL(bvh.getNbTriangles(), nbTriangles - nbTriangles / 10);
+    BOOST_CHECK(bvh.getNbNodes() > 1);
+
+    int nbHits = 0;
+    const int nbRays = 2000;
+    for(int r = 0; r < nbRays; ++r)
+    {
+        const Point3d origin = Point3d(position(generator), position(generator), position(generator)) * 1.5 + sceneOffset;
+        const Point3d target = Point3d(position(generator), position(generator), position(generator)) + sceneOffset;
+        const Point3d direction = (target - origin).normalize();
+
+        int expectedTriangle;
+        double expectedT;
+        const bool expectedHit = bruteForceIntersect(mesh, origin, direction, 1000.0, expectedTriangle, expectedT);
+
+        MeshBVH::Hit hit;
+        const bool isHit = bvh.intersect(origin, direction, 0.0, 1000.0, hit);
+        BOOST_CHECK_EQUAL(isHit, bvh.occluded(origin, direction, 0.0, 1000.0));
+
+        // rays grazing an edge may differ between single and double precision
+        if(isHit != expectedHit || (isHit && hit.triangle != expectedTriangle))
+        {
+            BOOST_CHECK(!isHit || !expectedHit || std::abs(hit.t - expectedT) < 1e-3);
+            continue;
+        }
+        if(isHit)
+        {
+            ++nbHits;
+            BOOST_CHECK_CLOSE(hit.t, expectedT, 1e-3);
+            // nothing before the closest hit
+            BOOST_CHECK(!bvh.occluded(origin, direction, 0.0, expectedT * 0.999));
+        }
+    }
+    BOOST_CHECK(nbHits > nbRays / 10);
+}
+
+BOOST_AUTO_TEST_CASE(meshBVH_occlusion)
+{
+    // two parallel squares, the first one hides the second one
+    Mesh mesh;
+    for(double z : {1.0, 2.0})
+    {
+        const int first = mesh.pts.size();
+        mesh.pts.push_back(Point3d(-1.0, -1.0, z));
+        mesh.pts.push_back(Point3d(1.0, -1.0, z));
+        mesh.pts.push_back(Point3d(1.0, 1.0, z));
+        mesh.pts.push_back(Point3d(-1.0, 1.0, z));
+        mesh.tris.push_back(Mesh::triangle(first, first + 1, first + 2));
+        mesh.tris.push_back(Mesh::triangle(first, first + 2, first + 3));
+    }
+    const MeshBVH bvh(mesh);
+
+    const Point3d origin(0.1, 0.2, 0.0);
+    const Point3d direction(0.0, 0.0, 1.0);
+
+    MeshBVH::Hit hit;
+    BOOST_CHECK(bvh.intersect(origin, direction, 0.0, 10.0, hit));
+    BOOST_CHECK_CLOSE(hit.t, 1.0, 1e-4);
+    BOOST_CHECK(hit.triangle == 0 || hit.triangle == 1);
+
+    // starting after the first square
+    BOOST_CHECK(bvh.intersect(origin, direction, 1.5, 10.0, hit));
+    BOOST_CHECK_CLOSE(hit.t, 2.0, 1e-4);
+    BOOST_CHECK(hit.triangle == 2 || hit.triangle == 3);
+
+    BOOST_CHECK(bvh.occluded(origin, direction, 0.0, 1.5));
+    BOOST_CHECK(!bvh.occluded(origin, direction, 0.0, 0.9));
+    BOOST_CHECK(!bvh.occluded(origin, direction, 1.1, 1.9));
+    BOOST_CHECK(!bvh.intersect(Point3d(1.5, 0.0, 0.0), direction, 0.0, 10.0, hit));
+    BOOST_CHECK_EQUAL(hit.triangle, -1);
+}
+
+BOOST_AUTO_TEST_CASE(meshBVH_culling)
+{
+    sfmData::SfMData sfmData;
+    addCameras(sfmData);
+    const mvsUtils::MultiViewParams mp(sfmData);
+    BOOST_REQUIRE_EQUAL(mp.ncams, 3);
+
+    // a square at z=5, its normal toward -z faces the camera 0
+    Mesh mesh;
+    mesh.pts.push_back(Point3d(-1.0, -1.0, 5.0));
+    mesh.pts.push_back(Point3d(1.0, -1.0, 5.0));
+    mesh.pts.push_back(Point3d(1.0, 1.0, 5.0));
+    mesh.pts.push_back(Point3d(-1.0, 1.0, 5.0));
+    mesh.tris.push_back(Mesh::triangle(0, 2, 1));
+    mesh.tris.push_back(Mesh::triangle(0, 3, 2));
+
+    const MeshBVH bvh(mesh);
+    const MeshBVH cullingBvh(mesh, true);
+
+    // the square is behind the camera 2
+    BOOST_CHECK(bvh.isVisible(mp, 0, Point3d(0.1, 0.2, 5.0), 0.01));
+    BOOST_CHECK(bvh.isVisible(mp, 1, Point3d(0.1, 0.2, 5.0), 0.01));
+    BOOST_CHECK(!bvh.isVisible(mp, 2, Point3d(0.1, 0.2, 5.0), 0.01));
+
+    StaticVector<int> visibleTriangles;
+    bvh.getVisibleTriangles(mp, 1, visibleTriangles);
+    BOOST_CHECK_EQUAL(visibleTriangles.size(), 2);
+    cullingBvh.getVisibleTriangles(mp, 1, visibleTriangles);
+    BOOST_CHECK_EQUAL(visibleTriangles.size(), 0);
+    cullingBvh.getVisibleTriangles(mp, 0, visibleTriangles);
+    BOOST_CHECK_EQUAL(visibleTriangles.size(), 2);
+
+    StaticVector<StaticVector<int>> trisCams;
+    cullingBvh.computeTrisCams(mp, trisCams);
+    BOOST_REQUIRE_EQUAL(trisCams.size(), 2);
+    for(const StaticVector<int>& cams : trisCams)
+    {
+        BOOST_REQUIRE_EQUAL(cams.size(), 1);
+        BOOST_CHECK_EQUAL(cams[0], 0);
+    }
+
+    PointsVisibility visibilities;
+    bvh.computePointsVisibilities(mp, visibilities);
+    BOOST_REQUIRE_EQUAL(visibilities.size(), 4);
+    for(const PointVisibility& visibility : visibilities)
+        BOOST_CHECK_EQUAL(visibility.size(), 2);
+
+    // all the cameras given to each vertex: the camera 2 is always removed, the camera 1 only with back-face culling
+    PointsVisibility allCams(mesh.pts.size());
+    for(PointVisibility& visibility : allCams)
+    {
+        for(int cam = 0; cam < mp.ncams; ++cam)
+            visibility.push_back(cam);
+    }
+
+    PointsVisibility filtered = allCams;
+    BOOST_CHECK_EQUAL(removeOccludedVisibilities(mp, mesh, filtered), 4);
+    for(const PointVisibility& visibility : filtered)
+    {
+        BOOST_REQUIRE_EQUAL(visibility.size(), 2);
+        BOOST_CHECK_EQUAL(visibility[0], 0);
+        BOOST_CHECK_EQUAL(visibility[1], 1);
+    }
+
+    filtered = allCams;
+    BOOST_CHECK_EQUAL(removeOccludedVisibilities(mp, mesh, filtered, true), 8);
+    for(const PointVisibility& visibility : filtered)
+    {
+        BOOST_REQUIRE_EQUAL(visibility.size(), 1);
+        BOOST_CHECK_EQUAL(visibility[0], 0);
+    }
+}
@@ -0,0 +1,256 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/MeshClean.hpp>
+#include <aliceVision/mvsData/structures.hpp>
+
+#define BOOST_TEST_MODULE meshClean
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+/**
+ * @brief Edge table as it was built before the bucketing by highest point:
+ * the edges sorted by highest point, lowest point and triangle with qsort,
+ * and the search tables of the intervals per highest point and per edge.
+ */
+struct ReferenceEdgeTable
+{
+    StaticVector<Voxel> edgesNeigTris;
+    StaticVector<Voxel> edgesXStat;
+    StaticVector<Voxel> edgesXYStat;
+
+    explicit ReferenceEdgeTable(const Mesh& mesh)
+    {
+        for(int i = 0; i < mesh.tris.size(); i++)
+        {
+            const int a = mesh.tris[i].v[0];
+            const int b = mesh.tris[i].v[1];
+            const int c = mesh.tris[i].v[2];
+            edgesNeigTris.push_back(Voxel(std::max(a, b), std::min(a, b), i));
+            edgesNeigTris.push_back(Voxel(std::max(b, c), std::min(b, c), i));
+            edgesNeigTris.push_back(Voxel(std::max(c, a), std::min(c, a), i));
+        }
+
+        qsort(&edgesNeigTris[0], edgesNeigTris.size(), sizeof(Voxel), qSortCompareVoxelByXAsc);
+
+        int i0 = 0;
+        for(int i = 0; i < edgesNeigTris.size(); i++)
+        {
+            if((i == edgesNeigTris.size() - 1) || (edgesNeigTris[i].x != edgesNeigTris[i + 1].x))
+            {
+                if(i - i0 + 1 > 1)
+                    qsort(&edgesNeigTris[i0], i - i0 + 1, sizeof(Voxel), qSortCompareVoxelByYAsc);
+
+                const int xyI0 = edgesXYStat.size();
+                int j0 = i0;
+                for(int j = i0; j <= i; j++)
+                {
+                    if((j == i) || (edgesNeigTris[j].y != edgesNeigTris[j + 1].y))
+                    {
+                        if(j - j0 + 1 > 1)
+                            qsort(&edgesNeigTris[j0], j - j0 + 1, sizeof(Voxel), qSortCompareVoxelByZAsc);
+
+                        edgesXYStat.push_back(Voxel(edgesNeigTris[j].y, j0, j));
+                        j0 = j + 1;
+                    }
+                }
+                edgesXStat.push_back(Voxel(edgesNeigTris[i].x, xyI0, edgesXYStat.size() - 1));
+                i0 = i + 1;
+            }
+        }
+    }
+
+    bool getEdgeNeighTrisInterval(Pixel& itr, int ptIdA, int ptIdB)
+    {
+        const int ptId1 = std::max(ptIdA, ptIdB);
+        const int ptId2 = std::min(ptIdA, ptIdB);
+        itr = Pixel(-1, -1);
+
+        const int i1 = indexOfSortedVoxelArrByX(ptId1, edgesXStat, 0, edgesXStat.size() - 1);
+        if(i1 < 0)
+            return false;
+        const int i2 = indexOfSortedVoxelArrByX(ptId2, edgesXYStat, edgesXStat[i1].y, edgesXStat[i1].z);
+        if(i2 < 0)
+            return false;
+        itr = Pixel(edgesXYStat[i2].y, edgesXYStat[i2].z);
+        return true;
+    }
+};
+
+/**
+ * @brief Small non-manifold mesh:
+ *  - two fans sharing the point 0, one closed around it and one open,
+ *  - three triangles sharing the edge 7-8,
+ *  - a point without triangle (12) and a point only used by the last triangle (13).
+ */
+void createNonManifoldMesh(Mesh& mesh)
+{
+    for(int i = 0; i < 14; ++i)
+        mesh.pts.push_back(Point3d(i % 3, (i * 7) % 5, (i * 3) % 4));
+
+    // closed fan around 0
+    mesh.tris.push_back(Mesh::triangle(0, 1, 2));
+    mesh.tris.push_back(Mesh::triangle(0, 2, 3));
+    mesh.tris.push_back(Mesh::triangle(0, 3, 1));
+    // open fan around 0
+    mesh.tris.push_back(Mesh::triangle(0, 4, 5));
+    mesh.tris.push_back(Mesh::triangle(0, 5, 6));
+    // non-manifold edge 7-8
+    mesh.tris.push_back(Mesh::triangle(7, 8, 9));
+    mesh.tris.push_back(Mesh::triangle(8, 7, 10));
+    mesh.tris.push_back(Mesh::triangle(7, 8, 11));
+    // the highest point in the middle of the triangle
+    mesh.tris.push_back(Mesh::triangle(9, 13, 2));
+}
+
+bool isTrianglePoint(const Mesh& mesh, int triId, int ptId)
+{
+    const Mesh::triangle& tri = mesh.tris[triId];
+    return (tri.v[0] == ptId) || (tri.v[1] == ptId) || (tri.v[2] == ptId);
+}
+
+/// check that the edges of the alive triangles are found, alive, in their interval of the edge table
+void checkEdgeTable(MeshClean& meshClean)
+{
+    // the buckets cover the table and are sorted by lowest point and triangle
+    BOOST_REQUIRE_EQUAL(meshClean.edgesPtsBegin.size(), meshClean.pts.size() + 1);
+    BOOST_REQUIRE_EQUAL(meshClean.edgesPtsBegin[meshClean.pts.size()], meshClean.edgesNeigTris.size());
+    BOOST_REQUIRE_EQUAL(meshClean.edgesNeigTrisAlive.size(), meshClean.edgesNeigTris.size());
+    for(int p = 0; p < meshClean.pts.size(); ++p)
+    {
+        for(int j = meshClean.edgesPtsBegin[p]; j < meshClean.edgesPtsBegin[p + 1]; ++j)
+        {
+            const Voxel& edge = meshClean.edgesNeigTris[j];
+            BOOST_CHECK_EQUAL(edge.x, p);
+            BOOST_CHECK_LT(edge.y, edge.x);
+            if(j > meshClean.edgesPtsBegin[p])
+            {
+                const Voxel& prev = meshClean.edgesNeigTris[j - 1];
+                BOOST_CHECK(prev.y < edge.y || (prev.y == edge.y && prev.z < edge.z));
+            }
+            // an alive edge belongs to its triangle
+            if(meshClean.edgesNeigTrisAlive[j])
+            {
+                BOOST_CHECK(isTrianglePoint(meshClean, edge.z, edge.x));
+                BOOST_CHECK(isTrianglePoint(meshClean, edge.z, edge.y));
+            }
+        }
+    }
+
+    for(int i = 0; i < meshClean.tris.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            Pixel itr;
+            BOOST_REQUIRE(meshClean.getEdgeNeighTrisInterval(itr, meshClean.tris[i].v[k], meshClean.tris[i].v[(k + 1) % 3]));
+            int nbFound = 0;
+            for(int j = itr.x; j <= itr.y; ++j)
+                nbFound += (meshClean.edgesNeigTrisAlive[j] && meshClean.edgesNeigTris[j].z == i);
+            BOOST_CHECK_EQUAL(nbFound, 1);
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshClean_edgeTable)
+{
+    MeshClean meshClean(nullptr);
+    createNonManifoldMesh(meshClean);
+    meshClean.init();
+
+    ReferenceEdgeTable reference(meshClean);
+
+    // same edges in the same order
+    BOOST_REQUIRE_EQUAL(meshClean.edgesNeigTris.size(), reference.edgesNeigTris.size());
+    for(int i = 0; i < reference.edgesNeigTris.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(meshClean.edgesNeigTris[i].x, reference.edgesNeigTris[i].x);
+        BOOST_CHECK_EQUAL(meshClean.edgesNeigTris[i].y, reference.edgesNeigTris[i].y);
+        BOOST_CHECK_EQUAL(meshClean.edgesNeigTris[i].z, reference.edgesNeigTris[i].z);
+        BOOST_CHECK(meshClean.edgesNeigTrisAlive[i]);
+    }
+
+    // same intervals for the edges of the triangles
+    for(int i = 0; i < meshClean.tris.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            const int a = meshClean.tris[i].v[k];
+            const int b = meshClean.tris[i].v[(k + 1) % 3];
+            Pixel itr;
+            Pixel referenceItr;
+            BOOST_REQUIRE(reference.getEdgeNeighTrisInterval(referenceItr, a, b));
+            BOOST_REQUIRE(meshClean.getEdgeNeighTrisInterval(itr, b, a));
+            BOOST_CHECK_EQUAL(itr.x, referenceItr.x);
+            BOOST_CHECK_EQUAL(itr.y, referenceItr.y);
+        }
+    }
+
+    // the other pairs of points, and the points out of range, are not edges
+    // (the previous search could return the interval of another edge of the lowest points)
+    for(int a = -1; a <= meshClean.pts.size(); ++a)
+    {
+        for(int b = -1; b <= meshClean.pts.size(); ++b)
+        {
+            bool isEdge = false;
+            for(int i = 0; i < meshClean.tris.size(); ++i)
+                isEdge = isEdge || (a != b && isTrianglePoint(meshClean, i, a) && isTrianglePoint(meshClean, i, b));
+            if(isEdge)
+                continue;
+            Pixel itr;
+            BOOST_CHECK(!meshClean.getEdgeNeighTrisInterval(itr, a, b));
+            BOOST_CHECK_EQUAL(itr.x, -1);
+            BOOST_CHECK_EQUAL(itr.y, -1);
+        }
+    }
+
+    // neighbor triangles of each point, sorted
+    for(int p = 0; p < meshClean.pts.size(); ++p)
+    {
+        StaticVector<int> expected;
+        for(int i = 0; i < meshClean.tris.size(); ++i)
+        {
+            if(isTrianglePoint(meshClean, i, p))
+                expected.push_back(i);
+        }
+        const StaticVector<int>& ptNeighTris = meshClean.ptsNeighTrisSortedAsc[p];
+        BOOST_REQUIRE_EQUAL(ptNeighTris.size(), expected.size());
+        for(int i = 0; i < expected.size(); ++i)
+            BOOST_CHECK_EQUAL(ptNeighTris[i], expected[i]);
+    }
+
+    checkEdgeTable(meshClean);
+}
+
+BOOST_AUTO_TEST_CASE(meshClean_edgeTableAfterCleaning)
+{
+    MeshClean meshClean(nullptr);
+    createNonManifoldMesh(meshClean);
+    const int nbPts = meshClean.pts.size();
+    meshClean.init();
+
+    // the point 0 is split in two, the points of the non-manifold edge are split too
+    const int nbNewPts = meshClean.cleanMesh();
+    BOOST_CHECK_GT(nbNewPts, 0);
+    BOOST_CHECK_EQUAL(meshClean.pts.size(), nbPts + nbNewPts);
+    BOOST_CHECK_EQUAL(meshClean.newPtsOldPtId.size(), nbNewPts);
+
+    // the edges of the new points are appended to the table, in their own buckets
+    checkEdgeTable(meshClean);
+
+    // a second pass has nothing left to split
+    BOOST_CHECK_EQUAL(meshClean.cleanMesh(), 0);
+    checkEdgeTable(meshClean);
+}
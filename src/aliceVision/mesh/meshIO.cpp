@@ -0,0 +1,1590 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "meshIO.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace mesh {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+// Mesh file layout (little endian):
+//  - header: magic, version, number of materials, number of sections
+//  - sections table: for each section, its offset in the file and its number of elements
+//  - sections: raw arrays, each one aligned on 64 bytes (see ESection), empty sections take no space
+
+const char meshFileMagic[4] = {'A', 'V', 'M', 'S'};
+const std::uint32_t meshFileVersion = 1;
+const std::size_t meshFileAlignment = 64;
+
+enum ESection
+{
+    POINTS = 0,            ///< 3 x float64 per point
+    TRIANGLES,             ///< 3 x int32 per triangle
+    COLORS,                ///< 3 x uint8 per point
+    TRIANGLES_MATERIALS,   ///< int32 per triangle
+    UV_COORDS,             ///< 2 x float64 per UV coordinate
+    TRIANGLES_UV_COORDS,   ///< 3 x int32 per triangle
+    NORMALS,               ///< 3 x float64 per normal
+    TRIANGLES_NORMALS,     ///< 3 x int32 per triangle
+    VISIBILITIES_OFFSETS,  ///< uint64 per point + 1, offsets of the points in the visibilities cameras
+    VISIBILITIES_CAMERAS,  ///< int32 per observation
+    NB_SECTIONS
+};
+
+const std::size_t sectionElementSize[NB_SECTIONS] = {24, 12, 3, 4, 16, 12, 24, 12, 8, 4};
+
+/// Entry of the sections table
+struct SectionEntry
+{
+    std::uint64_t offset = 0;
+    std::uint64_t count = 0;
+};
+
+const std::size_t meshFileHeaderSize = 16 + NB_SECTIONS * sizeof(SectionEntry);
+
+static_assert(sizeof(Point3d) == 3 * sizeof(double), "Point3d must be stored as 3 doubles");
+static_assert(sizeof(Point2d) == 2 * sizeof(double), "Point2d must be stored as 2 doubles");
+static_assert(sizeof(Voxel) == 3 * sizeof(std::int32_t), "Voxel must be stored as 3 int32");
+static_assert(sizeof(rgb) == 3, "rgb must be stored as 3 bytes");
+static_assert(sizeof(int) == sizeof(std::int32_t), "int must be stored on 32 bits");
+
+std::size_t alignOffset(std::size_t offset)
+{
+    return (offset + meshFileAlignment - 1) / meshFileAlignment * meshFileAlignment;
+}
+
+/// Read only memory mapping of a whole file, empty files are not mapped
+class MappedInputFile
+{
+public:
+    explicit MappedInputFile(const std::string& path)
+    {
+        namespace bip = boost::interprocess;
+
+        try
+        {
+            if(bfs::file_size(path) == 0)
+                return;
+            _mapping = bip::file_mapping(path.c_str(), bip::read_only);
+            _region = bip::mapped_region(_mapping, bip::read_only);
+        }
+        catch(const std::exception& e)
+        {
+            throw std::runtime_error("Can't map mesh file '" + path + "': " + e.what());
+        }
+    }
+
+    const char* data() const { return static_cast<const char*>(_region.get_address()); }
+    std::size_t size() const { return _region.get_size(); }
+
+private:
+    boost::interprocess::file_mapping _mapping;
+    boost::interprocess::mapped_region _region;
+};
+
+/// Write the elements of a container converted by blocks into a temporary buffer
+template<typename T, typename ConvertFunc>
+void writeConverted(std::ofstream& file, std::size_t nbElements, std::size_t nbValuesPerElement, ConvertFunc convert)
+{
+    const std::size_t blockSize = 1 << 16;
+    std::vector<T> buffer;
+    for(std::size_t begin = 0; begin < nbElements; begin += blockSize)
+    {
+        const std::size_t end = std::min(begin + blockSize, nbElements);
+        buffer.resize((end - begin) * nbValuesPerElement);
+        for(std::size_t i = begin; i < end; ++i)
+            convert(i, &buffer[(i - begin) * nbValuesPerElement]);
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(T));
+    }
+}
+
+/// Clear the mesh and allocate its points and triangles, without material
+void resetMesh(Mesh& mesh, std::size_t nbPoints, std::size_t nbTriangles)
+{
+    mesh.pts = StaticVector<Point3d>();
+    mesh.pts.resize(nbPoints);
+    mesh.tris = StaticVector<Mesh::triangle>();
+    mesh.tris.resize(nbTriangles);
+    mesh.colors().clear();
+    mesh.trisMtlIds().assign(nbTriangles, -1);
+    mesh.nmtls = 0;
+    mesh.uvCoords = StaticVector<Point2d>();
+    mesh.trisUvIds = StaticVector<Voxel>();
+    mesh.normals = StaticVector<Point3d>();
+    mesh.trisNormalsIds = StaticVector<Voxel>();
+    mesh.pointsVisibilities = PointsVisibility();
+}
+
+/**
+ * @brief Split a text into chunks of whole lines, for parallel parsing
+ * @return the chunks bounds, the chunk i is [bounds[i], bounds[i + 1][
+ */
+std::vector<std::size_t> splitLines(const char* data, std::size_t size)
+{
+    const std::size_t minChunkSize = 1 << 20;
+    const std::size_t nbChunks = std::max<std::size_t>(1, std::min<std::size_t>(size / minChunkSize, 8 * omp_get_max_threads()));
+
+    std::vector<std::size_t> bounds(1, 0);
+    for(std::size_t c = 1; c < nbChunks; ++c)
+    {
+        const std::size_t begin = std::max(bounds.back(), c * (size / nbChunks));
+        const void* eol = std::memchr(data + begin, '\n', size - begin);
+        if(eol == nullptr)
+            break;
+        const std::size_t bound = static_cast<const char*>(eol) - data + 1;
+        if(bound < size)
+            bounds.push_back(bound);
+    }
+    bounds.push_back(size);
+    return bounds;
+}
+
+/// Call f(lineBegin, lineEnd) on each line of the text, without the end of line characters
+template<typename LineFunc>
+void forEachLine(const char* begin, const char* end, LineFunc f)
+{
+    while(begin < end)
+    {
+        const char* eol = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        const char* lineEnd = eol ? eol : end;
+        f(begin, (lineEnd > begin && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd);
+        begin = eol ? eol + 1 : end;
+    }
+}
+
+/// Blank separated tokens of a line of text
+class LineTokenizer
+{
+public:
+    LineTokenizer(const char* begin, const char* end)
+        : _current(begin)
+        , _end(end)
+    {}
+
+    bool next(const char*& tokenBegin, const char*& tokenEnd)
+    {
+        while(_current < _end && (*_current == ' ' || *_current == '\t'))
+            ++_current;
+        if(_current == _end)
+            return false;
+        tokenBegin = _current;
+        while(_current < _end && *_current != ' ' && *_current != '\t')
+            ++_current;
+        tokenEnd = _current;
+        return true;
+    }
+
+    bool nextDouble(double& value)
+    {
+        const char* tokenBegin;
+        const char* tokenEnd;
+        if(!next(tokenBegin, tokenEnd))
+            return false;
+
+        // strtod needs a null terminated string, the mapped file is not
+        char buffer[64];
+        const std::size_t size = std::min<std::size_t>(tokenEnd - tokenBegin, sizeof(buffer) - 1);
+        std::memcpy(buffer, tokenBegin, size);
+        buffer[size] = '\0';
+        char* parsedEnd;
+        value = std::strtod(buffer, &parsedEnd);
+        return parsedEnd != buffer;
+    }
+
+    std::size_t countTokens()
+    {
+        std::size_t count = 0;
+        const char* tokenBegin;
+        const char* tokenEnd;
+        while(next(tokenBegin, tokenEnd))
+            ++count;
+        return count;
+    }
+
+private:
+    const char* _current;
+    const char* _end;
+};
+
+bool tokenEquals(const char* tokenBegin, const char* tokenEnd, const char* keyword)
+{
+    const std::size_t size = tokenEnd - tokenBegin;
+    return std::strlen(keyword) == size && std::memcmp(tokenBegin, keyword, size) == 0;
+}
+
+/// Parse a signed integer at the beginning of [begin, end[ and move begin after it
+bool parseInteger(const char*& begin, const char* end, long long& value)
+{
+    const char* p = begin;
+    const bool negative = (p < end && *p == '-');
+    if(p < end && (*p == '-' || *p == '+'))
+        ++p;
+    if(p == end || *p < '0' || *p > '9')
+        return false;
+    value = 0;
+    while(p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+    if(negative)
+        value = -value;
+    begin = p;
+    return true;
+}
+
+/// Run a parallel loop over the chunks, the first error (in the chunks order) is thrown after the loop
+template<typename ChunkFunc>
+void parallelForChunks(int nbChunks, ChunkFunc f)
+{
+    std::vector<std::string> errors(nbChunks);
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int c = 0; c < nbChunks; ++c)
+    {
+        try
+        {
+            f(c);
+        }
+        catch(const std::exception& e)
+        {
+            errors[c] = e.what();
+        }
+    }
+
+    for(const std::string& error : errors)
+    {
+        if(!error.empty())
+            throw std::runtime_error(error);
+    }
+}
+
+/// Format lines in parallel by blocks, then write the blocks in order
+template<typename FormatLineFunc>
+void writeFormattedLines(FILE* f, std::size_t nbLines, FormatLineFunc formatLine)
+{
+    const std::size_t linesPerBlock = 1 << 16;
+    const int nbBlocksPerBatch = 4 * omp_get_max_threads();
+    std::vector<std::string> blocks(nbBlocksPerBatch);
+
+    for(std::size_t batchBegin = 0; batchBegin < nbLines; batchBegin += linesPerBlock * nbBlocksPerBatch)
+    {
+        const int nbBlocks = static_cast<int>(std::min<std::size_t>(nbBlocksPerBatch, (nbLines - batchBegin + linesPerBlock - 1) / linesPerBlock));
+
+        #pragma omp parallel for
+        for(int b = 0; b < nbBlocks; ++b)
+        {
+            std::string& block = blocks[b];
+            block.clear();
+            char line[512];
+            const std::size_t begin = batchBegin + b * linesPerBlock;
+            const std::size_t end = std::min(begin + linesPerBlock, nbLines);
+            for(std::size_t i = begin; i < end; ++i)
+            {
+                const int size = formatLine(i, line, sizeof(line));
+                if(size < static_cast<int>(sizeof(line)))
+                {
+                    block.append(line, std::max(size, 0));
+                    continue;
+                }
+                // longer line (e.g. very large values with %f): format it again in a large enough buffer
+                std::vector<char> longLine(size + 1);
+                formatLine(i, longLine.data(), longLine.size());
+                block.append(longLine.data(), size);
+            }
+        }
+
+        for(int b = 0; b < nbBlocks; ++b)
+            std::fwrite(blocks[b].data(), 1, blocks[b].size(), f);
+    }
+}
+
+/// Triangles fan of a polygon, stored from the given triangle
+void setTrianglesFan(const std::vector<int>& polygon, std::size_t firstTriangle, StaticVector<Voxel>& triangles)
+{
+    for(std::size_t i = 1; i + 1 < polygon.size(); ++i)
+        triangles[firstTriangle + i - 1] = Voxel(polygon[0], polygon[i], polygon[i + 1]);
+}
+
+// OBJ
+
+/// Number of elements of an OBJ file, per chunk of lines
+struct ObjCounts
+{
+    std::size_t points = 0;
+    std::size_t normals = 0;
+    std::size_t uvCoords = 0;
+    std::size_t triangles = 0;
+    std::size_t trianglesUV = 0;
+    std::size_t trianglesNormals = 0;
+
+    ObjCounts& operator+=(const ObjCounts& other)
+    {
+        points += other.points;
+        normals += other.normals;
+        uvCoords += other.uvCoords;
+        triangles += other.triangles;
+        trianglesUV += other.trianglesUV;
+        trianglesNormals += other.trianglesNormals;
+        return *this;
+    }
+};
+
+struct ObjChunk
+{
+    ObjCounts counts;
+    /// number of elements in the previous chunks
+    ObjCounts offsets;
+    /// number of values of the first point of the chunk, -1 if there is no point
+    int firstPointNbValues = -1;
+    /// names and ids of the materials used in the chunk, in order
+    std::vector<std::string> materials;
+    std::vector<int> materialsIds;
+    /// material used at the beginning of the chunk
+    int firstMaterialId = -1;
+};
+
+/// Point, UV coordinate and normal indexes of a face vertex (v, v/vt, v/vt/vn or v//vn), 0 if not set
+struct ObjFaceVertex
+{
+    long long point = 0;
+    long long uvCoord = 0;
+    long long normal = 0;
+};
+
+bool parseObjFaceVertex(const char* begin, const char* end, ObjFaceVertex& vertex)
+{
+    vertex = ObjFaceVertex();
+    if(!parseInteger(begin, end, vertex.point))
+        return false;
+    if(begin < end && *begin == '/')
+    {
+        ++begin;
+        if(begin < end && *begin != '/' && !parseInteger(begin, end, vertex.uvCoord))
+            return false;
+        if(begin < end && *begin == '/')
+        {
+            ++begin;
+            if(!parseInteger(begin, end, vertex.normal))
+                return false;
+        }
+    }
+    return begin == end;
+}
+
+/// Convert a 1-based (or negative relative) OBJ index into a 0-based index
+int toObjIndex(long long index, std::size_t nbPrevious)
+{
+    if(index < 0)
+        return static_cast<int>(static_cast<long long>(nbPrevious) + index);
+    return static_cast<int>(index - 1);
+}
+
+// PLY
+
+enum class EPlyType
+{
+    INT8,
+    UINT8,
+    INT16,
+    UINT16,
+    INT32,
+    UINT32,
+    FLOAT32,
+    FLOAT64
+};
+
+EPlyType EPlyType_stringToEnum(const std::string& type)
+{
+    if(type == "char" || type == "int8") return EPlyType::INT8;
+    if(type == "uchar" || type == "uint8") return EPlyType::UINT8;
+    if(type == "short" || type == "int16") return EPlyType::INT16;
+    if(type == "ushort" || type == "uint16") return EPlyType::UINT16;
+    if(type == "int" || type == "int32") return EPlyType::INT32;
+    if(type == "uint" || type == "uint32") return EPlyType::UINT32;
+    if(type == "float" || type == "float32") return EPlyType::FLOAT32;
+    if(type == "double" || type == "float64") return EPlyType::FLOAT64;
+    throw std::runtime_error("Unknown PLY property type: " + type);
+}
+
+std::size_t plyTypeSize(EPlyType type)
+{
+    switch(type)
+    {
+        case EPlyType::INT8:
+        case EPlyType::UINT8:   return 1;
+        case EPlyType::INT16:
+        case EPlyType::UINT16:  return 2;
+        case EPlyType::INT32:
+        case EPlyType::UINT32:
+        case EPlyType::FLOAT32: return 4;
+        case EPlyType::FLOAT64: return 8;
+    }
+    throw std::out_of_range("Invalid PLY property type: " + std::to_string(int(type)));
+}
+
+template<typename S>
+double castPlyValue(const unsigned char* bytes)
+{
+    S value;
+    std::memcpy(&value, bytes, sizeof(S));
+    return static_cast<double>(value);
+}
+
+double readPlyValue(const unsigned char* data, EPlyType type, bool swapBytes)
+{
+    unsigned char bytes[8];
+    const std::size_t size = plyTypeSize(type);
+    std::memcpy(bytes, data, size);
+    if(swapBytes)
+        std::reverse(bytes, bytes + size);
+
+    switch(type)
+    {
+        case EPlyType::INT8:    return castPlyValue<std::int8_t>(bytes);
+        case EPlyType::UINT8:   return castPlyValue<std::uint8_t>(bytes);
+        case EPlyType::INT16:   return castPlyValue<std::int16_t>(bytes);
+        case EPlyType::UINT16:  return castPlyValue<std::uint16_t>(bytes);
+        case EPlyType::INT32:   return castPlyValue<std::int32_t>(bytes);
+        case EPlyType::UINT32:  return castPlyValue<std::uint32_t>(bytes);
+        case EPlyType::FLOAT32: return castPlyValue<float>(bytes);
+        case EPlyType::FLOAT64: return castPlyValue<double>(bytes);
+    }
+    throw std::out_of_range("Invalid PLY property type: " + std::to_string(int(type)));
+}
+
+/// Use of a PLY property by the mesh
+enum class EPlyRole
+{
+    NONE,
+    X, Y, Z,
+    RED, GREEN, BLUE,
+    INDICES
+};
+
+struct PlyProperty
+{
+    std::string name;
+    EPlyType type = EPlyType::FLOAT32;
+    bool isList = false;
+    EPlyType countType = EPlyType::UINT8;
+    EPlyRole role = EPlyRole::NONE;
+};
+
+struct PlyElement
+{
+    std::string name;
+    std::size_t count = 0;
+    std::vector<PlyProperty> properties;
+
+    /// @return the size of a binary record, 0 if the records have lists
+    std::size_t getFixedRecordSize() const
+    {
+        std::size_t size = 0;
+        for(const PlyProperty& property : properties)
+        {
+            if(property.isList)
+                return 0;
+            size += plyTypeSize(property.type);
+        }
+        return size;
+    }
+
+    bool hasRole(EPlyRole role) const
+    {
+        return std::any_of(properties.begin(), properties.end(), [&](const PlyProperty& p) { return p.role == role; });
+    }
+};
+
+enum class EPlyFormat
+{
+    ASCII,
+    BINARY_LITTLE_ENDIAN,
+    BINARY_BIG_ENDIAN
+};
+
+/// Values of a PLY record used by the mesh
+struct PlyRecord
+{
+    double position[3] = {0.0, 0.0, 0.0};
+    double color[3] = {0.0, 0.0, 0.0};
+    std::vector<int> indices;
+
+    void setValue(EPlyRole role, double value)
+    {
+        switch(role)
+        {
+            case EPlyRole::X:     position[0] = value; break;
+            case EPlyRole::Y:     position[1] = value; break;
+            case EPlyRole::Z:     position[2] = value; break;
+            case EPlyRole::RED:   color[0] = value; break;
+            case EPlyRole::GREEN: color[1] = value; break;
+            case EPlyRole::BLUE:  color[2] = value; break;
+            default: break;
+        }
+    }
+};
+
+/// Decode a binary PLY record and move data after it
+void decodePlyBinaryRecord(const PlyElement& element, bool swapBytes, const unsigned char*& data, const unsigned char* end, PlyRecord& record)
+{
+    record.indices.clear();
+    for(const PlyProperty& property : element.properties)
+    {
+        if(property.isList)
+        {
+            const std::size_t countSize = plyTypeSize(property.countType);
+            if(static_cast<std::size_t>(end - data) < countSize)
+                throw std::runtime_error("PLY file: unexpected end of data.");
+            const std::size_t count = static_cast<std::size_t>(readPlyValue(data, property.countType, swapBytes));
+            data += countSize;
+
+            const std::size_t itemSize = plyTypeSize(property.type);
+            if(static_cast<std::size_t>(end - data) / itemSize < count)
+                throw std::runtime_error("PLY file: unexpected end of data.");
+            if(property.role == EPlyRole::INDICES)
+            {
+                for(std::size_t k = 0; k < count; ++k)
+                    record.indices.push_back(static_cast<int>(readPlyValue(data + k * itemSize, property.type, swapBytes)));
+            }
+            data += count * itemSize;
+        }
+        else
+        {
+            const std::size_t size = plyTypeSize(property.type);
+            if(static_cast<std::size_t>(end - data) < size)
+                throw std::runtime_error("PLY file: unexpected end of data.");
+            if(property.role != EPlyRole::NONE)
+                record.setValue(property.role, readPlyValue(data, property.type, swapBytes));
+            data += size;
+        }
+    }
+}
+
+/// Decode an ascii PLY record (one line)
+void decodePlyAsciiRecord(const PlyElement& element, const char* begin, const char* end, PlyRecord& record)
+{
+    record.indices.clear();
+    LineTokenizer tokenizer(begin, end);
+    double value;
+    for(const PlyProperty& property : element.properties)
+    {
+        if(!tokenizer.nextDouble(value))
+            throw std::runtime_error("PLY file: invalid " + element.name + " line.");
+        if(property.isList)
+        {
+            const std::size_t count = static_cast<std::size_t>(value);
+            for(std::size_t k = 0; k < count; ++k)
+            {
+                if(!tokenizer.nextDouble(value))
+                    throw std::runtime_error("PLY file: invalid " + element.name + " line.");
+                if(property.role == EPlyRole::INDICES)
+                    record.indices.push_back(static_cast<int>(value));
+            }
+        }
+        else if(property.role != EPlyRole::NONE)
+        {
+            record.setValue(property.role, value);
+        }
+    }
+}
+
+/// Number of triangles of the first list of indices of an ascii face line
+std::size_t getPlyAsciiNbTriangles(const PlyElement& element, const char* begin, const char* end)
+{
+    LineTokenizer tokenizer(begin, end);
+    double value;
+    for(const PlyProperty& property : element.properties)
+    {
+        if(!tokenizer.nextDouble(value))
+            throw std::runtime_error("PLY file: invalid " + element.name + " line.");
+        if(property.isList)
+        {
+            if(property.role == EPlyRole::INDICES)
+                return value >= 3.0 ? static_cast<std::size_t>(value) - 2 : 0;
+            for(std::size_t k = 0; k < static_cast<std::size_t>(value); ++k)
+                tokenizer.nextDouble(value);
+        }
+    }
+    return 0;
+}
+
+/// Store a decoded PLY record in the mesh
+class PlyMeshFiller
+{
+public:
+    PlyMeshFiller(Mesh& mesh, bool hasColors, EPlyType colorType)
+        : _mesh(mesh)
+        , _hasColors(hasColors)
+        // integer colors are stored on [0, 255], floating point colors on [0, 1]
+        , _colorScale((colorType == EPlyType::FLOAT32 || colorType == EPlyType::FLOAT64) ? 255.0 : 1.0)
+    {}
+
+    void setPoint(std::size_t index, const PlyRecord& record)
+    {
+        _mesh.pts[index] = Point3d(record.position[0], record.position[1], record.position[2]);
+        if(_hasColors)
+        {
+            rgb& color = _mesh.colors()[index];
+            color.r = toColor(record.color[0]);
+            color.g = toColor(record.color[1]);
+            color.b = toColor(record.color[2]);
+        }
+    }
+
+    void setTriangles(std::size_t firstTriangle, const PlyRecord& record)
+    {
+        for(std::size_t i = 1; i + 1 < record.indices.size(); ++i)
+            _mesh.tris[firstTriangle + i - 1] = Mesh::triangle(record.indices[0], record.indices[i], record.indices[i + 1]);
+    }
+
+private:
+    unsigned char toColor(double value) const
+    {
+        return static_cast<unsigned char>(std::min(std::max(value * _colorScale, 0.0), 255.0));
+    }
+
+    Mesh& _mesh;
+    const bool _hasColors;
+    const double _colorScale;
+};
+
+} // namespace
+
+EMeshFileType getMeshFileType(const std::string& path)
+{
+    const std::string extension = boost::algorithm::to_lower_copy(bfs::path(path).extension().string());
+    if(extension == ".avmesh")
+        return EMeshFileType::AVMESH;
+    if(extension == ".ply")
+        return EMeshFileType::PLY;
+    return EMeshFileType::OBJ;
+}
+
+void writeMeshFile(const std::string& path, const Mesh& mesh)
+{
+    const std::size_t nbPoints = mesh.pts.size();
+    const std::size_t nbTriangles = mesh.tris.size();
+    const bool hasUVs = !mesh.uvCoords.empty() && mesh.trisUvIds.size() == nbTriangles;
+    const bool hasNormals = !mesh.normals.empty() && mesh.trisNormalsIds.size() == nbTriangles;
+    const bool hasVisibilities = nbPoints > 0 && mesh.pointsVisibilities.size() == nbPoints;
+
+    std::vector<std::uint64_t> visibilitiesOffsets;
+    if(hasVisibilities)
+    {
+        visibilitiesOffsets.resize(nbPoints + 1, 0);
+        for(std::size_t i = 0; i < nbPoints; ++i)
+            visibilitiesOffsets[i + 1] = visibilitiesOffsets[i] + mesh.pointsVisibilities[i].size();
+    }
+
+    SectionEntry sections[NB_SECTIONS];
+    sections[POINTS].count = nbPoints;
+    sections[TRIANGLES].count = nbTriangles;
+    sections[COLORS].count = (mesh.colors().size() == nbPoints) ? nbPoints : 0;
+    sections[TRIANGLES_MATERIALS].count = (mesh.trisMtlIds().size() == nbTriangles) ? nbTriangles : 0;
+    sections[UV_COORDS].count = hasUVs ? mesh.uvCoords.size() : 0;
+    sections[TRIANGLES_UV_COORDS].count = hasUVs ? nbTriangles : 0;
+    sections[NORMALS].count = hasNormals ? mesh.normals.size() : 0;
+    sections[TRIANGLES_NORMALS].count = hasNormals ? nbTriangles : 0;
+    sections[VISIBILITIES_OFFSETS].count = visibilitiesOffsets.size();
+    sections[VISIBILITIES_CAMERAS].count = hasVisibilities ? visibilitiesOffsets.back() : 0;
+
+    std::size_t offset = alignOffset(meshFileHeaderSize);
+    for(int s = 0; s < NB_SECTIONS; ++s)
+    {
+        sections[s].offset = sections[s].count ? offset : 0;
+        offset = alignOffset(offset + sections[s].count * sectionElementSize[s]);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if(!file.is_open())
+        throw std::runtime_error("Can't write mesh file '" + path + "'.");
+
+    const std::int32_t nbMaterials = mesh.nmtls;
+    const std::uint32_t nbSections = NB_SECTIONS;
+    file.write(meshFileMagic, sizeof(meshFileMagic));
+    file.write(reinterpret_cast<const char*>(&meshFileVersion), sizeof(meshFileVersion));
+    file.write(reinterpret_cast<const char*>(&nbMaterials), sizeof(nbMaterials));
+    file.write(reinterpret_cast<const char*>(&nbSections), sizeof(nbSections));
+    file.write(reinterpret_cast<const char*>(sections), sizeof(sections));
+
+    std::size_t position = meshFileHeaderSize;
+    const auto startSection = [&](int s)
+    {
+        static const char padding[meshFileAlignment] = {};
+        file.write(padding, sections[s].offset - position);
+        position = sections[s].offset + sections[s].count * sectionElementSize[s];
+    };
+    const auto writeSection = [&](int s, const void* data)
+    {
+        if(sections[s].count == 0)
+            return;
+        startSection(s);
+        file.write(static_cast<const char*>(data), sections[s].count * sectionElementSize[s]);
+    };
+
+    writeSection(POINTS, mesh.pts.getData().data());
+    if(nbTriangles)
+    {
+        startSection(TRIANGLES);
+        writeConverted<std::int32_t>(file, nbTriangles, 3, [&](std::size_t i, std::int32_t* t)
+        {
+            std::copy(mesh.tris[i].v, mesh.tris[i].v + 3, t);
+        });
+    }
+    writeSection(COLORS, mesh.colors().data());
+    writeSection(TRIANGLES_MATERIALS, mesh.trisMtlIds().data());
+    writeSection(UV_COORDS, mesh.uvCoords.getData().data());
+    writeSection(TRIANGLES_UV_COORDS, mesh.trisUvIds.getData().data());
+    writeSection(NORMALS, mesh.normals.getData().data());
+    writeSection(TRIANGLES_NORMALS, mesh.trisNormalsIds.getData().data());
+    writeSection(VISIBILITIES_OFFSETS, visibilitiesOffsets.data());
+    if(sections[VISIBILITIES_CAMERAS].count)
+    {
+        startSection(VISIBILITIES_CAMERAS);
+        for(const PointVisibility& visibility : mesh.pointsVisibilities)
+            file.write(reinterpret_cast<const char*>(visibility.getData().data()), visibility.size() * sizeof(std::int32_t));
+    }
+
+    if(!file.good())
+        throw std::runtime_error("Failed to write mesh file '" + path + "'.");
+}
+
+void readMeshFile(const std::string& path, Mesh& mesh)
+{
+    ALICEVISION_LOG_INFO("Loading mesh from file: " << path);
+    const MeshFileReader reader(path);
+    reader.read(mesh);
+    ALICEVISION_LOG_INFO("Mesh loaded: \n\t- #points: " << mesh.pts.size() << "\n\t- # triangles: " << mesh.tris.size());
+}
+
+struct MeshFileReader::MappedFile : public MappedInputFile
+{
+    using MappedInputFile::MappedInputFile;
+};
+
+MeshFileReader::MeshFileReader(const std::string& path)
+    : _file(new MappedFile(path))
+    , _path(path)
+{
+    _data = reinterpret_cast<const unsigned char*>(_file->data());
+    _size = _file->size();
+
+    try
+    {
+        if(_size < 16 || std::memcmp(_data, meshFileMagic, sizeof(meshFileMagic)) != 0)
+            throw std::runtime_error("Not a mesh file.");
+
+        std::uint32_t version;
+        std::uint32_t nbSections;
+        std::int32_t nbMaterials;
+        std::memcpy(&version, _data + 4, sizeof(version));
+        std::memcpy(&nbMaterials, _data + 8, sizeof(nbMaterials));
+        std::memcpy(&nbSections, _data + 12, sizeof(nbSections));
+        if(version != meshFileVersion)
+            throw std::runtime_error("Unsupported mesh file version: " + std::to_string(version) + ".");
+        // newer files may have more sections, unknown to this reader
+        if(nbSections < NB_SECTIONS || _size < 16 + std::size_t(nbSections) * sizeof(SectionEntry))
+            throw std::runtime_error("Mesh file: invalid sections table.");
+        if(nbMaterials < 0)
+            throw std::runtime_error("Mesh file: invalid number of materials.");
+        _nbMaterials = nbMaterials;
+
+        _sections.resize(NB_SECTIONS);
+        std::memcpy(_sections.data(), _data + 16, NB_SECTIONS * sizeof(SectionEntry));
+        for(int s = 0; s < NB_SECTIONS; ++s)
+        {
+            const Section& section = _sections[s];
+            if(section.count == 0)
+                continue;
+            if(section.offset % meshFileAlignment != 0 || section.offset > _size ||
+               section.count > (_size - section.offset) / sectionElementSize[s])
+                throw std::runtime_error("Mesh file: invalid section " + std::to_string(s) + ".");
+        }
+
+        const std::uint64_t nbPoints = _sections[POINTS].count;
+        const std::uint64_t nbTriangles = _sections[TRIANGLES].count;
+        const auto checkCount = [&](int s, std::uint64_t expected)
+        {
+            if(_sections[s].count != 0 && _sections[s].count != expected)
+                throw std::runtime_error("Mesh file: invalid size of the section " + std::to_string(s) + ".");
+        };
+        checkCount(COLORS, nbPoints);
+        checkCount(TRIANGLES_MATERIALS, nbTriangles);
+        checkCount(TRIANGLES_UV_COORDS, nbTriangles);
+        checkCount(TRIANGLES_NORMALS, nbTriangles);
+        checkCount(VISIBILITIES_OFFSETS, nbPoints + 1);
+        if(getVisibilitiesOffsets() && getVisibilitiesOffsets()[nbPoints] != _sections[VISIBILITIES_CAMERAS].count)
+            throw std::runtime_error("Mesh file: invalid visibilities.");
+
+        // the triangles index the points, the uv coords and the normals:
+        // check the indices once here, the mesh conversions read them in place
+        const auto checkIndices = [&](int s, std::uint64_t nbElements)
+        {
+            const std::int32_t* indices = static_cast<const std::int32_t*>(getSection(s));
+            if(indices == nullptr)
+                return;
+            bool valid = true;
+            #pragma omp parallel for reduction(&& : valid)
+            for(int i = 0; i < static_cast<int>(nbTriangles); ++i)
+            {
+                for(int k = 0; k < 3; ++k)
+                    valid = valid && indices[3 * i + k] >= 0 && static_cast<std::uint64_t>(indices[3 * i + k]) < nbElements;
+            }
+            if(!valid)
+                throw std::runtime_error("Mesh file: invalid indices in the section " + std::to_string(s) + ".");
+        };
+        checkIndices(TRIANGLES, nbPoints);
+        checkIndices(TRIANGLES_UV_COORDS, _sections[UV_COORDS].count);
+        checkIndices(TRIANGLES_NORMALS, _sections[NORMALS].count);
+    }
+    catch(const std::exception& e)
+    {
+        throw std::runtime_error("Can't read mesh file '" + path + "': " + e.what());
+    }
+}
+
+MeshFileReader::~MeshFileReader() = default;
+
+const void* MeshFileReader::getSection(int section) const
+{
+    return _sections[section].count ? _data + _sections[section].offset : nullptr;
+}
+
+std::size_t MeshFileReader::getNbPoints() const { return _sections[POINTS].count; }
+std::size_t MeshFileReader::getNbTriangles() const { return _sections[TRIANGLES].count; }
+std::size_t MeshFileReader::getNbUVCoords() const { return _sections[UV_COORDS].count; }
+std::size_t MeshFileReader::getNbNormals() const { return _sections[NORMALS].count; }
+
+const double* MeshFileReader::getPoints() const { return static_cast<const double*>(getSection(POINTS)); }
+const std::int32_t* MeshFileReader::getTriangles() const { return static_cast<const std::int32_t*>(getSection(TRIANGLES)); }
+const std::uint8_t* MeshFileReader::getColors() const { return static_cast<const std::uint8_t*>(getSection(COLORS)); }
+const std::int32_t* MeshFileReader::getTrianglesMaterials() const { return static_cast<const std::int32_t*>(getSection(TRIANGLES_MATERIALS)); }
+const double* MeshFileReader::getUVCoords() const { return static_cast<const double*>(getSection(UV_COORDS)); }
+const std::int32_t* MeshFileReader::getTrianglesUVCoords() const { return static_cast<const std::int32_t*>(getSection(TRIANGLES_UV_COORDS)); }
+const double* MeshFileReader::getNormals() const { return static_cast<const double*>(getSection(NORMALS)); }
+const std::int32_t* MeshFileReader::getTrianglesNormals() const { return static_cast<const std::int32_t*>(getSection(TRIANGLES_NORMALS)); }
+const std::uint64_t* MeshFileReader::getVisibilitiesOffsets() const { return static_cast<const std::uint64_t*>(getSection(VISIBILITIES_OFFSETS)); }
+const std::int32_t* MeshFileReader::getVisibilitiesCameras() const { return static_cast<const std::int32_t*>(getSection(VISIBILITIES_CAMERAS)); }
+
+void MeshFileReader::read(Mesh& mesh) const
+{
+    const std::size_t nbPoints = getNbPoints();
+    const std::size_t nbTriangles = getNbTriangles();
+    resetMesh(mesh, nbPoints, nbTriangles);
+
+    // copy the arrays in place (same memory layout)
+    const auto copySection = [&](int s, void* dst)
+    {
+        if(_sections[s].count)
+            std::memcpy(dst, getSection(s), _sections[s].count * sectionElementSize[s]);
+    };
+
+    copySection(POINTS, mesh.pts.getDataWritable().data());
+
+    const std::int32_t* triangles = getTriangles();
+    #pragma omp parallel for
+    for(int i = 0; i < static_cast<int>(nbTriangles); ++i)
+        mesh.tris[i] = Mesh::triangle(triangles[3 * i], triangles[3 * i + 1], triangles[3 * i + 2]);
+
+    if(getColors())
+    {
+        mesh.colors().resize(nbPoints);
+        copySection(COLORS, mesh.colors().data());
+    }
+    copySection(TRIANGLES_MATERIALS, mesh.trisMtlIds().data());
+    mesh.nmtls = _nbMaterials;
+
+    mesh.uvCoords.resize(getNbUVCoords());
+    copySection(UV_COORDS, mesh.uvCoords.getDataWritable().data());
+    if(getTrianglesUVCoords())
+    {
+        mesh.trisUvIds.resize(nbTriangles);
+        copySection(TRIANGLES_UV_COORDS, mesh.trisUvIds.getDataWritable().data());
+    }
+
+    mesh.normals.resize(getNbNormals());
+    copySection(NORMALS, mesh.normals.getDataWritable().data());
+    if(getTrianglesNormals())
+    {
+        mesh.trisNormalsIds.resize(nbTriangles);
+        copySection(TRIANGLES_NORMALS, mesh.trisNormalsIds.getDataWritable().data());
+    }
+
+    const std::uint64_t* offsets = getVisibilitiesOffsets();
+    if(offsets)
+    {
+        const std::int32_t* cameras = getVisibilitiesCameras();
+        const std::uint64_t nbObservations = offsets[nbPoints];
+        bool valid = true;
+
+        mesh.pointsVisibilities.resize(nbPoints);
+        #pragma omp parallel for reduction(&& : valid)
+        for(int i = 0; i < static_cast<int>(nbPoints); ++i)
+        {
+            if(offsets[i] > offsets[i + 1] || offsets[i + 1] > nbObservations)
+            {
+                valid = false;
+                continue;
+            }
+            PointVisibility& visibility = mesh.pointsVisibilities[i];
+            visibility.resize(static_cast<int>(offsets[i + 1] - offsets[i]));
+            std::copy(cameras + offsets[i], cameras + offsets[i + 1], visibility.begin());
+        }
+        if(!valid)
+            throw std::runtime_error("Can't read mesh file '" + _path + "': invalid visibilities.");
+    }
+}
+
+bool readObjFile(const std::string& path, Mesh& mesh)
+{
+    ALICEVISION_LOG_INFO("Loading mesh from obj file: " << path);
+
+    const MappedInputFile file(path);
+    const char* data = file.data();
+    const std::vector<std::size_t> bounds = splitLines(data, file.size());
+    const int nbChunks = static_cast<int>(bounds.size()) - 1;
+    std::vector<ObjChunk> chunks(nbChunks);
+
+    // count the elements of each chunk
+    parallelForChunks(nbChunks, [&](int c)
+    {
+        ObjChunk& chunk = chunks[c];
+        forEachLine(data + bounds[c], data + bounds[c + 1], [&](const char* begin, const char* end)
+        {
+            LineTokenizer tokenizer(begin, end);
+            const char* keywordBegin;
+            const char* keywordEnd;
+            if(!tokenizer.next(keywordBegin, keywordEnd))
+                return;
+
+            if(tokenEquals(keywordBegin, keywordEnd, "v"))
+            {
+                if(chunk.firstPointNbValues < 0)
+                    chunk.firstPointNbValues = static_cast<int>(tokenizer.countTokens());
+                ++chunk.counts.points;
+            }
+            else if(tokenEquals(keywordBegin, keywordEnd, "vn"))
+            {
+                ++chunk.counts.normals;
+            }
+            else if(tokenEquals(keywordBegin, keywordEnd, "vt"))
+            {
+                ++chunk.counts.uvCoords;
+            }
+            else if(tokenEquals(keywordBegin, keywordEnd, "f"))
+            {
+                const char* vertexBegin;
+                const char* vertexEnd;
+                ObjFaceVertex vertex;
+                if(!tokenizer.next(vertexBegin, vertexEnd) || !parseObjFaceVertex(vertexBegin, vertexEnd, vertex))
+                    throw std::runtime_error("Mesh: Unrecognized facet syntax while reading obj file: " + path);
+                const std::size_t nbVertices = 1 + tokenizer.countTokens();
+                if(nbVertices < 3)
+                    throw std::runtime_error("Mesh: Unrecognized facet syntax while reading obj file: " + path);
+
+                chunk.counts.triangles += nbVertices - 2;
+                if(vertex.uvCoord != 0)
+                    chunk.counts.trianglesUV += nbVertices - 2;
+                if(vertex.normal != 0)
+                    chunk.counts.trianglesNormals += nbVertices - 2;
+            }
+            else if(tokenEquals(keywordBegin, keywordEnd, "usemtl"))
+            {
+                const char* nameBegin;
+                const char* nameEnd;
+                if(tokenizer.next(nameBegin, nameEnd))
+                    chunk.materials.emplace_back(nameBegin, nameEnd);
+            }
+        });
+    });
+
+    // offsets of the chunks, materials ids in the order of their first use
+    ObjCounts counts;
+    bool useColors = false;
+    bool firstPointFound = false;
+    std::map<std::string, int> materialsIds;
+    int mtlId = -1;
+    for(ObjChunk& chunk : chunks)
+    {
+        chunk.offsets = counts;
+        counts += chunk.counts;
+
+        if(!firstPointFound && chunk.firstPointNbValues >= 0)
+        {
+            useColors = (chunk.firstPointNbValues == 6);
+            firstPointFound = true;
+        }
+
+        chunk.firstMaterialId = mtlId;
+        for(const std::string& material : chunk.materials)
+        {
+            mtlId = materialsIds.emplace(material, static_cast<int>(materialsIds.size())).first->second;
+            chunk.materialsIds.push_back(mtlId);
+        }
+    }
+
+    ALICEVISION_LOG_INFO("\t- # vertices: " << counts.points << std::endl
+      << "\t- # normals: " << counts.normals << std::endl
+      << "\t- # uv coordinates: " << counts.uvCoords << std::endl
+      << "\t- # triangles: " << counts.triangles);
+
+    resetMesh(mesh, counts.points, counts.triangles);
+    mesh.nmtls = static_cast<int>(materialsIds.size());
+    mesh.normals.resize(counts.normals);
+    mesh.uvCoords.resize(counts.uvCoords);
+    mesh.trisUvIds.resize(counts.trianglesUV);
+    mesh.trisNormalsIds.resize(counts.trianglesNormals);
+    if(useColors)
+        mesh.colors().resize(counts.points);
+
+    // parse the chunks
+    parallelForChunks(nbChunks, [&](int c)
+    {
+        const ObjChunk& chunk = chunks[c];
+        ObjCounts cursors = chunk.offsets;
+        int mtlId = chunk.firstMaterialId;
+        std::size_t materialIndex = 0;
+        std::vector<ObjFaceVertex> faceVertices;
+        std::vector<int> polygon;
+
+        forEachLine(data + bounds[c], data + bounds[c + 1], [&](const char* begin, const char* end)
+        {
+            LineTokenizer tokenizer(begin, end);
+            const char* keywordBegin;
+            const char* keywordEnd;
+            if(!tokenizer.next(keywordBegin, keywordEnd))
+                return;
+
+            if(tokenEquals(keywordBegin, keywordEnd, "v"))
+            {
+                Point3d& pt = mesh.pts[cursors.points];
+                if(!tokenizer.nextDouble(pt.x) || !tokenizer.nextDouble(pt.y) || !tokenizer.nextDouble(pt.z))
+                    throw std::runtime_error("Mesh: Invalid vertex while reading obj file: " + path);
+                if(useColors)
+                {
+                    // convert float color data to uchar
+                    double r = 0.0, g = 0.0, b = 0.0;
+                    if(tokenizer.nextDouble(r) && tokenizer.nextDouble(g))
+                        tokenizer.nextDouble(b);
+                    mesh.colors()[cursors.points] = rgb(static_cast<unsigned char>(static_cast<float>(r) * 255.0f),
+                                                        static_cast<unsigned char>(static_cast<float>(g) * 255.0f),
+                                                        static_cast<unsigned char>(static_cast<float>(b) * 255.0f));
+                }
+                ++cursors.points;
+            }
+            else if(tokenEquals(keywordBegin, keywordEnd, "vn"))
+            {
+                Point3d& pt = mesh.normals[cursors.normals++];
+                if(!tokenizer.nextDouble(pt.x) || !tokenizer.nextDouble(pt.y) || !tokenizer.nextDouble(pt.z))
+                    throw std::runtime_error("Mesh: Invalid normal while reading obj file: " + path);
+            }
+            else if(tokenEquals(keywordBegin, keywordEnd, "vt"))
+            {
+                Point2d& pt = mesh.uvCoords[cursors.uvCoords++];
+                if(!tokenizer.nextDouble(pt.x) || !tokenizer.nextDouble(pt.y))
+                    throw std::runtime_error("Mesh: Invalid uv coordinate while reading obj file: " + path);
+            }
+            else if(tokenEquals(keywordBegin, keywordEnd, "f"))
+            {
+                faceVertices.clear();
+                const char* vertexBegin;
+                const char* vertexEnd;
+                while(tokenizer.next(vertexBegin, vertexEnd))
+                {
+                    faceVertices.emplace_back();
+                    if(!parseObjFaceVertex(vertexBegin, vertexEnd, faceVertices.back()) ||
+                       (faceVertices.back().uvCoord == 0) != (faceVertices.front().uvCoord == 0) ||
+                       (faceVertices.back().normal == 0) != (faceVertices.front().normal == 0))
+                        throw std::runtime_error("Mesh: Unrecognized facet syntax while reading obj file: " + path);
+                }
+                const std::size_t nbTriangles = faceVertices.size() - 2;
+
+                polygon.resize(faceVertices.size());
+                for(std::size_t i = 0; i < faceVertices.size(); ++i)
+                    polygon[i] = toObjIndex(faceVertices[i].point, cursors.points);
+                for(std::size_t i = 1; i + 1 < polygon.size(); ++i)
+                {
+                    mesh.tris[cursors.triangles + i - 1] = Mesh::triangle(polygon[0], polygon[i], polygon[i + 1]);
+                    mesh.trisMtlIds()[cursors.triangles + i - 1] = mtlId;
+                }
+                cursors.triangles += nbTriangles;
+
+                if(faceVertices.front().uvCoord != 0)
+                {
+                    for(std::size_t i = 0; i < faceVertices.size(); ++i)
+                        polygon[i] = toObjIndex(faceVertices[i].uvCoord, cursors.uvCoords);
+                    setTrianglesFan(polygon, cursors.trianglesUV, mesh.trisUvIds);
+                    cursors.trianglesUV += nbTriangles;
+                }
+                if(faceVertices.front().normal != 0)
+                {
+                    for(std::size_t i = 0; i < faceVertices.size(); ++i)
+                        polygon[i] = toObjIndex(faceVertices[i].normal, cursors.normals);
+                    setTrianglesFan(polygon, cursors.trianglesNormals, mesh.trisNormalsIds);
+                    cursors.trianglesNormals += nbTriangles;
+                }
+            }
+            else if(tokenEquals(keywordBegin, keywordEnd, "usemtl"))
+            {
+                const char* nameBegin;
+                const char* nameEnd;
+                if(tokenizer.next(nameBegin, nameEnd))
+                    mtlId = chunk.materialsIds[materialIndex++];
+            }
+        });
+    });
+
+    ALICEVISION_LOG_INFO("Mesh loaded: \n\t- #points: " << counts.points << "\n\t- # triangles: " << counts.triangles);
+    return counts.points != 0 && counts.triangles != 0;
+}
+
+void writeObjFile(const std::string& path, const Mesh& mesh)
+{
+    ALICEVISION_LOG_INFO("Save mesh to obj: " << path);
+    ALICEVISION_LOG_INFO("Nb points: " << mesh.pts.size());
+    ALICEVISION_LOG_INFO("Nb triangles: " << mesh.tris.size());
+
+    FILE* f = std::fopen(path.c_str(), "w");
+    if(f == nullptr)
+        throw std::runtime_error("Can't write obj file '" + path + "'.");
+
+    std::fprintf(f, "# \n");
+    std::fprintf(f, "# Wavefront OBJ file\n");
+    std::fprintf(f, "# Created with AliceVision\n");
+    std::fprintf(f, "# \n");
+    std::fprintf(f, "g Mesh\n");
+
+    const std::vector<rgb>& colors = mesh.colors();
+    if(colors.size() == mesh.pts.size())
+    {
+        writeFormattedLines(f, mesh.pts.size(), [&](std::size_t i, char* line, std::size_t size)
+        {
+            const Point3d& point = mesh.pts[i];
+            const rgb& col = colors[i];
+            return std::snprintf(line, size, "v %f %f %f %f %f %f\n", point.x, point.y, point.z, col.r/255.0f, col.g/255.0f, col.b/255.0f);
+        });
+    }
+    else
+    {
+        writeFormattedLines(f, mesh.pts.size(), [&](std::size_t i, char* line, std::size_t size)
+        {
+            const Point3d& point = mesh.pts[i];
+            return std::snprintf(line, size, "v %f %f %f\n", point.x, point.y, point.z);
+        });
+    }
+
+    writeFormattedLines(f, mesh.tris.size(), [&](std::size_t i, char* line, std::size_t size)
+    {
+        const Mesh::triangle& t = mesh.tris[i];
+        return std::snprintf(line, size, "f %i %i %i\n", t.v[0] + 1, t.v[1] + 1, t.v[2] + 1);
+    });
+
+    const bool failed = std::ferror(f) != 0;
+    if(std::fclose(f) != 0 || failed)
+        throw std::runtime_error("Failed to write obj file '" + path + "'.");
+    ALICEVISION_LOG_INFO("Save mesh to obj done.");
+}
+
+bool readPlyFile(const std::string& path, Mesh& mesh)
+{
+    ALICEVISION_LOG_INFO("Loading mesh from ply file: " << path);
+
+    const MappedInputFile file(path);
+    const char* data = file.data();
+    const std::size_t size = file.size();
+
+    // header
+    EPlyFormat format = EPlyFormat::ASCII;
+    std::vector<PlyElement> elements;
+    std::size_t bodyOffset = 0;
+    {
+        bool magicFound = false;
+        bool headerEnd = false;
+        std::size_t offset = 0;
+        while(!headerEnd && offset < size)
+        {
+            const char* eol = static_cast<const char*>(std::memchr(data + offset, '\n', size - offset));
+            if(eol == nullptr)
+                break;
+            std::istringstream line(std::string(data + offset, eol));
+            offset = eol - data + 1;
+
+            std::string keyword;
+            line >> keyword;
+            if(!magicFound)
+            {
+                if(keyword != "ply")
+                    throw std::runtime_error("Can't read ply file '" + path + "': not a PLY file.");
+                magicFound = true;
+            }
+            else if(keyword == "format")
+            {
+                std::string formatName;
+                line >> formatName;
+                if(formatName == "ascii")
+                    format = EPlyFormat::ASCII;
+                else if(formatName == "binary_little_endian")
+                    format = EPlyFormat::BINARY_LITTLE_ENDIAN;
+                else if(formatName == "binary_big_endian")
+                    format = EPlyFormat::BINARY_BIG_ENDIAN;
+                else
+                    throw std::runtime_error("Can't read ply file '" + path + "': unknown format " + formatName + ".");
+            }
+            else if(keyword == "element")
+            {
+                elements.emplace_back();
+                line >> elements.back().name >> elements.back().count;
+            }
+            else if(keyword == "property")
+            {
+                if(elements.empty())
+                    throw std::runtime_error("Can't read ply file '" + path + "': property without element.");
+                PlyElement& element = elements.back();
+                PlyProperty property;
+                std::string type;
+                line >> type;
+                if(type == "list")
+                {
+                    std::string countType;
+                    line >> countType >> type;
+                    property.isList = true;
+                    property.countType = EPlyType_stringToEnum(countType);
+                }
+                property.type = EPlyType_stringToEnum(type);
+                line >> property.name;
+
+                if(element.name == "vertex" && !property.isList)
+                {
+                    if(property.name == "x") property.role = EPlyRole::X;
+                    else if(property.name == "y") property.role = EPlyRole::Y;
+                    else if(property.name == "z") property.role = EPlyRole::Z;
+                    else if(property.name == "red") property.role = EPlyRole::RED;
+                    else if(property.name == "green") property.role = EPlyRole::GREEN;
+                    else if(property.name == "blue") property.role = EPlyRole::BLUE;
+                }
+                else if(element.name == "face" && property.isList &&
+                        (property.name == "vertex_indices" || property.name == "vertex_index") &&
+                        !element.hasRole(EPlyRole::INDICES))
+                {
+                    property.role = EPlyRole::INDICES;
+                }
+                element.properties.push_back(property);
+            }
+            else if(keyword == "end_header")
+            {
+                headerEnd = true;
+            }
+        }
+        if(!headerEnd)
+            throw std::runtime_error("Can't read ply file '" + path + "': invalid header.");
+        bodyOffset = offset;
+    }
+
+    const auto findElement = [&](const std::string& name) -> const PlyElement*
+    {
+        for(const PlyElement& element : elements)
+        {
+            if(element.name == name)
+                return &element;
+        }
+        return nullptr;
+    };
+    const PlyElement* vertexElement = findElement("vertex");
+    const PlyElement* faceElement = findElement("face");
+    if(vertexElement == nullptr || !vertexElement->hasRole(EPlyRole::X) || !vertexElement->hasRole(EPlyRole::Y) || !vertexElement->hasRole(EPlyRole::Z))
+        throw std::runtime_error("Can't read ply file '" + path + "': no vertex positions.");
+    if(faceElement != nullptr && !faceElement->hasRole(EPlyRole::INDICES))
+        faceElement = nullptr;
+
+    const bool hasColors = vertexElement->hasRole(EPlyRole::RED) && vertexElement->hasRole(EPlyRole::GREEN) && vertexElement->hasRole(EPlyRole::BLUE);
+    EPlyType colorType = EPlyType::UINT8;
+    for(const PlyProperty& property : vertexElement->properties)
+    {
+        if(property.role == EPlyRole::RED)
+            colorType = property.type;
+    }
+
+    // records blocks: the records are decoded in parallel by blocks,
+    // the offset of each block (in bytes or in lines) and its first triangle are found first
+    const std::size_t recordsPerBlock = 1 << 14;
+    const int nbElements = static_cast<int>(elements.size());
+    std::vector<std::vector<std::size_t>> blocksOffsets(nbElements);
+    std::vector<std::vector<std::size_t>> blocksTriangles(nbElements);
+    std::size_t nbTriangles = 0;
+
+    const bool swapBytes = (format == EPlyFormat::BINARY_BIG_ENDIAN);
+    std::vector<std::size_t> lineBounds;
+
+    try
+    {
+        if(format != EPlyFormat::ASCII)
+        {
+            const unsigned char* body = reinterpret_cast<const unsigned char*>(data) + bodyOffset;
+            const unsigned char* end = reinterpret_cast<const unsigned char*>(data) + size;
+            const unsigned char* current = body;
+            PlyRecord record;
+
+            for(int e = 0; e < nbElements; ++e)
+            {
+                const PlyElement& element = elements[e];
+                const std::size_t recordSize = element.getFixedRecordSize();
+                const bool isFace = (&element == faceElement);
+
+                if(recordSize != 0 && !isFace)
+                {
+                    if(element.count > static_cast<std::size_t>(end - current) / recordSize)
+                        throw std::runtime_error("PLY file: unexpected end of data.");
+                    for(std::size_t r = 0; r < element.count; r += recordsPerBlock)
+                        blocksOffsets[e].push_back(current - body + r * recordSize);
+                    current += element.count * recordSize;
+                    continue;
+                }
+                // records with lists
+                for(std::size_t r = 0; r < element.count; ++r)
+                {
+                    if(r % recordsPerBlock == 0)
+                    {
+                        blocksOffsets[e].push_back(current - body);
+                        blocksTriangles[e].push_back(nbTriangles);
+                    }
+                    decodePlyBinaryRecord(element, swapBytes, current, end, record);
+                    if(isFace && record.indices.size() >= 3)
+                        nbTriangles += record.indices.size() - 2;
+                }
+            }
+        }
+        else
+        {
+            // lines of the body, empty lines are ignored
+            const char* body = data + bodyOffset;
+            lineBounds = splitLines(body, size - bodyOffset);
+            const int nbChunks = static_cast<int>(lineBounds.size()) - 1;
+
+            std::vector<std::size_t> chunksLines(nbChunks + 1, 0);
+            parallelForChunks(nbChunks, [&](int c)
+            {
+                forEachLine(body + lineBounds[c], body + lineBounds[c + 1], [&](const char* begin, const char* end)
+                {
+                    if(begin != end)
+                        ++chunksLines[c + 1];
+                });
+            });
+            for(int c = 0; c < nbChunks; ++c)
+                chunksLines[c + 1] += chunksLines[c];
+
+            // first line of the face element
+            std::size_t faceFirstLine = 0;
+            std::size_t nbLines = 0;
+            for(const PlyElement& element : elements)
+            {
+                if(&element == faceElement)
+                    faceFirstLine = nbLines;
+                nbLines += element.count;
+            }
+            if(chunksLines.back() < nbLines)
+                throw std::runtime_error("PLY file: unexpected end of data.");
+
+            std::vector<std::size_t> chunksTriangles(nbChunks + 1, 0);
+            if(faceElement != nullptr)
+            {
+                parallelForChunks(nbChunks, [&](int c)
+                {
+                    std::size_t line = chunksLines[c];
+                    forEachLine(body + lineBounds[c], body + lineBounds[c + 1], [&](const char* begin, const char* end)
+                    {
+                        if(begin == end)
+                            return;
+                        if(line >= faceFirstLine && line < faceFirstLine + faceElement->count)
+                            chunksTriangles[c + 1] += getPlyAsciiNbTriangles(*faceElement, begin, end);
+                        ++line;
+                    });
+                });
+                for(int c = 0; c < nbChunks; ++c)
+                    chunksTriangles[c + 1] += chunksTriangles[c];
+            }
+            nbTriangles = chunksTriangles.back();
+
+            // the lines chunks are the blocks of all the elements
+            for(int e = 0; e < nbElements; ++e)
+            {
+                blocksOffsets[e] = chunksLines;
+                blocksTriangles[e] = chunksTriangles;
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        throw std::runtime_error("Can't read ply file '" + path + "': " + e.what());
+    }
+
+    ALICEVISION_LOG_INFO("\t- # vertices: " << vertexElement->count << std::endl
+      << "\t- # triangles: " << nbTriangles);
+
+    resetMesh(mesh, vertexElement->count, nbTriangles);
+    if(hasColors)
+        mesh.colors().resize(vertexElement->count);
+    PlyMeshFiller filler(mesh, hasColors, colorType);
+
+    try
+    {
+        if(format != EPlyFormat::ASCII)
+        {
+            const unsigned char* body = reinterpret_cast<const unsigned char*>(data) + bodyOffset;
+            const unsigned char* end = reinterpret_cast<const unsigned char*>(data) + size;
+
+            for(int e = 0; e < nbElements; ++e)
+            {
+                const PlyElement& element = elements[e];
+                const bool isVertex = (&element == vertexElement);
+                const bool isFace = (&element == faceElement);
+                if(!isVertex && !isFace)
+                    continue;
+
+                const std::vector<std::size_t>& offsets = blocksOffsets[e];
+                parallelForChunks(static_cast<int>(offsets.size()), [&](int b)
+                {
+                    const unsigned char* current = body + offsets[b];
+                    std::size_t triangle = isFace ? blocksTriangles[e][b] : 0;
+                    PlyRecord record;
+                    const std::size_t recordsEnd = std::min(element.count, (b + 1) * recordsPerBlock);
+                    for(std::size_t r = b * recordsPerBlock; r < recordsEnd; ++r)
+                    {
+                        decodePlyBinaryRecord(element, swapBytes, current, end, record);
+                        if(isVertex)
+                        {
+                            filler.setPoint(r, record);
+                        }
+                        else if(record.indices.size() >= 3)
+                        {
+                            filler.setTriangles(triangle, record);
+                            triangle += record.indices.size() - 2;
+                        }
+                    }
+                });
+            }
+        }
+        else
+        {
+            const char* body = data + bodyOffset;
+            const std::vector<std::size_t>& chunksLines = blocksOffsets.front();
+
+            // first line of each element
+            std::vector<std::size_t> elementsFirstLine(nbElements + 1, 0);
+            for(int e = 0; e < nbElements; ++e)
+                elementsFirstLine[e + 1] = elementsFirstLine[e] + elements[e].count;
+
+            parallelForChunks(static_cast<int>(lineBounds.size()) - 1, [&](int c)
+            {
+                std::size_t line = chunksLines[c];
+                std::size_t triangle = blocksTriangles.front()[c];
+                PlyRecord record;
+                int e = static_cast<int>(std::upper_bound(elementsFirstLine.begin(), elementsFirstLine.end(), line) - elementsFirstLine.begin()) - 1;
+
+                forEachLine(body + lineBounds[c], body + lineBounds[c + 1], [&](const char* begin, const char* end)
+                {
+                    if(begin == end)
+                        return;
+                    while(e < nbElements && line >= elementsFirstLine[e + 1])
+                        ++e;
+                    if(e < nbElements && &elements[e] == vertexElement)
+                    {
+                        decodePlyAsciiRecord(elements[e], begin, end, record);
+                        filler.setPoint(line - elementsFirstLine[e], record);
+                    }
+                    else if(e < nbElements && &elements[e] == faceElement)
+                    {
+                        decodePlyAsciiRecord(elements[e], begin, end, record);
+                        if(record.indices.size() >= 3)
+                        {
+                            filler.setTriangles(triangle, record);
+                            triangle += record.indices.size() - 2;
+                        }
+                    }
+                    ++line;
+                });
+            });
+        }
+    }
+    catch(const std::exception& e)
+    {
+        throw std::runtime_error("Can't read ply file '" + path + "': " + e.what());
+    }
+
+    ALICEVISION_LOG_INFO("Mesh loaded: \n\t- #points: " << mesh.pts.size() << "\n\t- # triangles: " << mesh.tris.size());
+    return !mesh.pts.empty() && !mesh.tris.empty();
+}
+
+void writePlyFile(const std::string& path, const Mesh& mesh)
+{
+    ALICEVISION_LOG_INFO("Save mesh to ply: " << path);
+
+    std::ofstream file(path, std::ios::binary);
+    if(!file.is_open())
+        throw std::runtime_error("Can't write ply file '" + path + "'.");
+
+    const std::vector<rgb>& colors = mesh.colors();
+    const bool hasColors = (colors.size() == mesh.pts.size());
+
+    file << "ply\n"
+         << "format binary_little_endian 1.0\n"
+         << "comment Created with AliceVision\n"
+         << "element vertex " << mesh.pts.size() << "\n"
+         << "property double x\n"
+         << "property double y\n"
+         << "property double z\n";
+    if(hasColors)
+    {
+        file << "property uchar red\n"
+             << "property uchar green\n"
+             << "property uchar blue\n";
+    }
+    file << "element face " << mesh.tris.size() << "\n"
+         << "property list uchar int vertex_indices\n"
+         << "end_header\n";
+
+    if(hasColors)
+    {
+        writeConverted<unsigned char>(file, mesh.pts.size(), sizeof(Point3d) + sizeof(rgb), [&](std::size_t i, unsigned char* record)
+        {
+            std::memcpy(record, mesh.pts[i].m, sizeof(Point3d));
+            std::memcpy(record + sizeof(Point3d), &colors[i], sizeof(rgb));
+        });
+    }
+    else
+    {
+        file.write(reinterpret_cast<const char*>(mesh.pts.getData().data()), mesh.pts.size() * sizeof(Point3d));
+    }
+
+    writeConverted<unsigned char>(file, mesh.tris.size(), 1 + 3 * sizeof(std::int32_t), [&](std::size_t i, unsigned char* record)
+    {
+        record[0] = 3;
+        std::memcpy(record + 1, mesh.tris[i].v, 3 * sizeof(std::int32_t));
+    });
+
+    if(!file.good())
+        throw std::runtime_error("Failed to write ply file '" + path + "'.");
+}
+
+} // namespace mesh
+} // namespace aliceVision
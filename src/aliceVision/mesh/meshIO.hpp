@@ -0,0 +1,168 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Mesh.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+ * @brief Mesh file formats
+ */
+enum class EMeshFileType
+{
+    /// Wavefront OBJ (text)
+    OBJ = 0,
+    /// Stanford PLY (text or binary)
+    PLY,
+    /// AliceVision binary mesh file
+    AVMESH
+};
+
+/**
+ * @brief Get the mesh file format from the file extension (.obj, .ply or .avmesh),
+ *        the files with another extension are considered as OBJ files.
+ * @param[in] path the mesh file path
+ * @return the mesh file format
+ */
+EMeshFileType getMeshFileType(const std::string& path);
+
+/**
+ * @brief Write a mesh in the AliceVision binary mesh file format (.avmesh)
+ *
+ * The arrays of the mesh (points, triangles, colors, materials, UV coordinates, normals and
+ * points visibilities) are stored raw and aligned on 64 bytes, so that they can be used
+ * in place from the mapped file (see MeshFileReader).
+ *
+ * @param[in] path the output file path
+ * @param[in] mesh the mesh to write, the points visibilities are written if there is one per point
+ */
+void writeMeshFile(const std::string& path, const Mesh& mesh);
+
+/**
+ * @brief Load an AliceVision binary mesh file (.avmesh)
+ * @param[in] path the file path
+ * @param[out] mesh the mesh, with the points visibilities stored in the file
+ */
+void readMeshFile(const std::string& path, Mesh& mesh);
+
+/**
+ * @brief Memory mapped reader of an AliceVision binary mesh file (.avmesh)
+ *
+ * The arrays are not copied: the pointers address the mapped file, they are valid as long as the reader exists.
+ * The optional arrays are null when they are not stored in the file.
+ */
+class MeshFileReader
+{
+public:
+    /**
+     * @brief Map the file, check its header and the indexes of the triangles
+     * @param[in] path the file path
+     */
+    explicit MeshFileReader(const std::string& path);
+    ~MeshFileReader();
+
+    MeshFileReader(const MeshFileReader&) = delete;
+    MeshFileReader& operator=(const MeshFileReader&) = delete;
+
+    std::size_t getNbPoints() const;
+    std::size_t getNbTriangles() const;
+    std::size_t getNbUVCoords() const;
+    std::size_t getNbNormals() const;
+    int getNbMaterials() const { return _nbMaterials; }
+
+    /// x, y, z of each point
+    const double* getPoints() const;
+    /// 3 points indexes per triangle, in [0, getNbPoints()[
+    const std::int32_t* getTriangles() const;
+    /// r, g, b of each point (optional)
+    const std::uint8_t* getColors() const;
+    /// material index of each triangle (optional)
+    const std::int32_t* getTrianglesMaterials() const;
+    /// u, v of each UV coordinate (optional)
+    const double* getUVCoords() const;
+    /// 3 UV coordinates indexes per triangle, in [0, getNbUVCoords()[ (optional)
+    const std::int32_t* getTrianglesUVCoords() const;
+    /// x, y, z of each normal (optional)
+    const double* getNormals() const;
+    /// 3 normals indexes per triangle, in [0, getNbNormals()[ (optional)
+    const std::int32_t* getTrianglesNormals() const;
+    /// cameras of the point i: getVisibilitiesCameras()[offsets[i]] to getVisibilitiesCameras()[offsets[i + 1] - 1] (optional)
+    const std::uint64_t* getVisibilitiesOffsets() const;
+    /// cameras indexes seeing the points (optional)
+    const std::int32_t* getVisibilitiesCameras() const;
+
+    /**
+     * @brief Copy the file content into a mesh
+     * @param[out] mesh the mesh
+     */
+    void read(Mesh& mesh) const;
+
+private:
+    struct MappedFile;
+    struct Section
+    {
+        std::uint64_t offset = 0;
+        std::uint64_t count = 0;
+    };
+
+    const void* getSection(int section) const;
+
+    std::unique_ptr<MappedFile> _file;
+    std::string _path;
+    const unsigned char* _data = nullptr;
+    std::size_t _size = 0;
+    int _nbMaterials = 0;
+    std::vector<Section> _sections;
+};
+
+/**
+ * @brief Load a Wavefront OBJ file
+ *
+ * The file is mapped in memory and parsed in parallel by chunks of lines.
+ * Polygons are split into triangles fans. The materials ids are given in the order of their first use.
+ *
+ * @param[in] path the file path
+ * @param[out] mesh the mesh
+ * @return false if the mesh has no point or no triangle
+ */
+bool readObjFile(const std::string& path, Mesh& mesh);
+
+/**
+ * @brief Write the points (and colors) and the triangles of a mesh in a Wavefront OBJ file,
+ *        the lines are formatted in parallel.
+ * @param[in] path the output file path
+ * @param[in] mesh the mesh to write
+ */
+void writeObjFile(const std::string& path, const Mesh& mesh);
+
+/**
+ * @brief Load the points (and colors) and the faces of a Stanford PLY file (ascii or binary)
+ *
+ * The file is mapped in memory and its elements are decoded in parallel. Polygons are split into triangles fans.
+ *
+ * @param[in] path the file path
+ * @param[out] mesh the mesh
+ * @return false if the mesh has no point or no triangle
+ */
+bool readPlyFile(const std::string& path, Mesh& mesh);
+
+/**
+ * @brief Write the points (and colors) and the triangles of a mesh in a binary little endian Stanford PLY file
+ * @param[in] path the output file path
+ * @param[in] mesh the mesh to write
+ */
+void writePlyFile(const std::string& path, const Mesh& mesh);
+
+} // namespace mesh
+} // namespace aliceVision
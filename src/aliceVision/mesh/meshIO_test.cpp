@@ -0,0 +1,332 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/meshIO.hpp>
+
+#define BOOST_TEST_MODULE meshIO
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+std::string getTemporaryPath(const std::string& extension)
+{
+    return (fs::temp_directory_path() / fs::unique_path("%%%%-%%%%" + extension)).string();
+}
+
+void writeText(const std::string& path, const std::string& text)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+}
+
+/// random mesh with all the optional data
+void generateMesh(int nbPoints, int nbTriangles, Mesh& mesh)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> position(-100.0, 100.0);
+    std::uniform_int_distribution<int> point(0, nbPoints - 1);
+    std::uniform_int_distribution<int> color(0, 255);
+    std::uniform_int_distribution<int> nbCameras(0, 5);
+
+    for(int i = 0; i < nbPoints; ++i)
+    {
+        mesh.pts.push_back(Point3d(position(generator), position(generator), position(generator)));
+        mesh.colors().emplace_back(color(generator), color(generator), color(generator));
+        PointVisibility visibility;
+        for(int c = nbCameras(generator); c > 0; --c)
+            visibility.push_back(point(generator));
+        mesh.pointsVisibilities.push_back(visibility);
+        mesh.normals.push_back(Point3d(position(generator), position(generator), position(generator)));
+        mesh.uvCoords.push_back(Point2d(position(generator), position(generator)));
+    }
+    for(int i = 0; i < nbTriangles; ++i)
+    {
+        mesh.tris.push_back(Mesh::triangle(point(generator), point(generator), point(generator)));
+        mesh.trisMtlIds().push_back(i % 3);
+        mesh.trisUvIds.push_back(Voxel(point(generator), point(generator), point(generator)));
+        mesh.trisNormalsIds.push_back(Voxel(point(generator), point(generator), point(generator)));
+    }
+    mesh.nmtls = 3;
+}
+
+bool sameColor(const rgb& a, const rgb& b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+void checkTriangles(const Mesh& mesh, const Mesh& expected)
+{
+    BOOST_REQUIRE_EQUAL(mesh.tris.size(), expected.tris.size());
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+            BOOST_CHECK_EQUAL(mesh.tris[i].v[k], expected.tris[i].v[k]);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(meshFile_writeRead)
+{
+    Mesh expected;
+    generateMesh(5000, 9000, expected);
+
+    const std::string path = getTemporaryPath(".avmesh");
+    expected.save(path);
+
+    Mesh mesh;
+    BOOST_CHECK(mesh.load(path));
+
+    BOOST_REQUIRE_EQUAL(mesh.pts.size(), expected.pts.size());
+    BOOST_REQUIRE_EQUAL(mesh.pointsVisibilities.size(), expected.pointsVisibilities.size());
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        BOOST_CHECK(mesh.pts[i] == expected.pts[i]);
+        BOOST_CHECK(sameColor(mesh.colors()[i], expected.colors()[i]));
+        BOOST_CHECK(mesh.pointsVisibilities[i].getData() == expected.pointsVisibilities[i].getData());
+    }
+    checkTriangles(mesh, expected);
+    BOOST_CHECK_EQUAL(mesh.nmtls, expected.nmtls);
+    BOOST_CHECK(mesh.trisMtlIds() == expected.trisMtlIds());
+    BOOST_REQUIRE_EQUAL(mesh.uvCoords.size(), expected.uvCoords.size());
+    BOOST_REQUIRE_EQUAL(mesh.normals.size(), expected.normals.size());
+    for(int i = 0; i < mesh.uvCoords.size(); ++i)
+    {
+        BOOST_CHECK(mesh.uvCoords[i].x == expected.uvCoords[i].x && mesh.uvCoords[i].y == expected.uvCoords[i].y);
+        BOOST_CHECK(mesh.normals[i] == expected.normals[i]);
+    }
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        BOOST_CHECK(mesh.trisUvIds[i] == expected.trisUvIds[i]);
+        BOOST_CHECK(mesh.trisNormalsIds[i] == expected.trisNormalsIds[i]);
+    }
+
+    // arrays used in place from the mapped file
+    {
+        const MeshFileReader reader(path);
+        BOOST_CHECK_EQUAL(reader.getNbPoints(), expected.pts.size());
+        BOOST_CHECK_EQUAL(reader.getNbTriangles(), expected.tris.size());
+        BOOST_CHECK_EQUAL(reader.getPoints()[3 * 10 + 2], expected.pts[10].z);
+        BOOST_CHECK_EQUAL(reader.getTriangles()[3 * 20 + 1], expected.tris[20].v[1]);
+        std::size_t nbObservations = 0;
+        for(const PointVisibility& visibility : expected.pointsVisibilities)
+            nbObservations += visibility.size();
+        BOOST_CHECK_EQUAL(reader.getVisibilitiesOffsets()[reader.getNbPoints()], nbObservations);
+    }
+
+    // optional data
+    Mesh minimal;
+    minimal.pts = expected.pts;
+    minimal.tris = expected.tris;
+    minimal.save(path);
+    {
+        const MeshFileReader reader(path);
+        BOOST_CHECK(reader.getColors() == nullptr);
+        BOOST_CHECK(reader.getUVCoords() == nullptr);
+        BOOST_CHECK(reader.getVisibilitiesOffsets() == nullptr);
+    }
+    BOOST_CHECK(mesh.load(path));
+    checkTriangles(mesh, expected);
+    BOOST_CHECK(mesh.colors().empty());
+    BOOST_CHECK(mesh.pointsVisibilities.empty());
+    BOOST_CHECK(mesh.uvCoords.empty());
+
+    // truncated file
+    fs::resize_file(path, fs::file_size(path) - 100);
+    BOOST_CHECK_THROW(MeshFileReader reader(path), std::runtime_error);
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(meshFile_invalidIndexes)
+{
+    Mesh valid;
+    generateMesh(500, 900, valid);
+    const std::string path = getTemporaryPath(".avmesh");
+
+    // an index out of range in each of the indexes arrays, and a negative number of materials
+    const std::vector<std::function<void(Mesh&)>> corruptions = {
+        [](Mesh& mesh) { mesh.tris[100].v[1] = mesh.pts.size(); },
+        [](Mesh& mesh) { mesh.tris.back().v[2] = -1; },
+        [](Mesh& mesh) { mesh.trisUvIds[899].z = mesh.uvCoords.size(); },
+        [](Mesh& mesh) { mesh.trisNormalsIds[0].x = -5; },
+        [](Mesh& mesh) { mesh.nmtls = -1; }};
+
+    for(const auto& corrupt : corruptions)
+    {
+        Mesh mesh = valid;
+        corrupt(mesh);
+        mesh.save(path);
+        BOOST_CHECK_THROW(MeshFileReader reader(path), std::runtime_error);
+    }
+
+    valid.save(path);
+    BOOST_CHECK_NO_THROW(MeshFileReader reader(path));
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(objFile_writeRead)
+{
+    Mesh expected;
+    generateMesh(50000, 90000, expected);
+    // points written with %f on longer lines than the formatting buffer
+    expected.pts[123] = Point3d(1e200, -3e199, 2e200);
+    expected.pts[40000] = Point3d(-1e300, 5.0, 1e300);
+
+    // large enough to be parsed by several chunks
+    const std::string path = getTemporaryPath(".obj");
+    expected.save(path);
+    BOOST_CHECK_GT(fs::file_size(path), 4 << 20);
+
+    Mesh mesh;
+    BOOST_CHECK(mesh.load(path));
+
+    BOOST_REQUIRE_EQUAL(mesh.pts.size(), expected.pts.size());
+    BOOST_REQUIRE_EQUAL(mesh.colors().size(), expected.colors().size());
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        BOOST_CHECK_SMALL((mesh.pts[i] - expected.pts[i]).size(), 1e-5 * std::max(1.0, expected.pts[i].size()));
+        BOOST_CHECK_LE(std::abs(mesh.colors()[i].r - expected.colors()[i].r), 1);
+        BOOST_CHECK_LE(std::abs(mesh.colors()[i].b - expected.colors()[i].b), 1);
+    }
+    checkTriangles(mesh, expected);
+    BOOST_CHECK_EQUAL(mesh.nmtls, 0);
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(objFile_syntax)
+{
+    const std::string path = getTemporaryPath(".obj");
+    writeText(path,
+              "# comment\r\n"
+              "mtllib mesh.mtl\r\n"
+              "v 0 0 0\r\n"
+              "v 1.0 0.0 0.0\n"
+              "v\t1.0\t1.0\t0.0\n"
+              "v 0.0 1.0 0.0\n"
+              "vt 0.0 0.0\n"
+              "vt 1.0 0.0\n"
+              "vt 1.0 1.0\n"
+              "vn 0.0 0.0 1.0\n"
+              "usemtl texture_1001\n"
+              "f 1/1 2/2 3/3\n"
+              "usemtl texture_1002\n"
+              "f 1/1/1 3/3/1 4/2/1\n"
+              "f 1//1 2//1 3//1 4//1\n"
+              "usemtl texture_1001\n"
+              "f -4 -3 -2\n");
+
+    Mesh mesh;
+    BOOST_CHECK(mesh.load(path));
+    BOOST_CHECK_EQUAL(mesh.pts.size(), 4);
+    BOOST_CHECK_EQUAL(mesh.pts[2].y, 1.0);
+    BOOST_CHECK_EQUAL(mesh.uvCoords.size(), 3);
+    BOOST_CHECK_EQUAL(mesh.normals.size(), 1);
+    BOOST_CHECK(mesh.colors().empty());
+
+    // the quad is split into 2 triangles
+    BOOST_REQUIRE_EQUAL(mesh.tris.size(), 5);
+    checkTriangles(mesh, [&]
+    {
+        Mesh expected;
+        expected.tris.push_back(Mesh::triangle(0, 1, 2));
+        expected.tris.push_back(Mesh::triangle(0, 2, 3));
+        expected.tris.push_back(Mesh::triangle(0, 1, 2));
+        expected.tris.push_back(Mesh::triangle(0, 2, 3));
+        expected.tris.push_back(Mesh::triangle(0, 1, 2));
+        return expected;
+    }());
+    BOOST_CHECK_EQUAL(mesh.nmtls, 2);
+    BOOST_CHECK(mesh.trisMtlIds() == std::vector<int>({0, 1, 1, 1, 0}));
+    BOOST_REQUIRE_EQUAL(mesh.trisUvIds.size(), 2);
+    BOOST_CHECK(mesh.trisUvIds[1] == Voxel(0, 2, 1));
+    BOOST_REQUIRE_EQUAL(mesh.trisNormalsIds.size(), 3);
+    BOOST_CHECK(mesh.trisNormalsIds[2] == Voxel(0, 0, 0));
+
+    writeText(path, "v 0 0 0\nv 1 0 0\nf 1 2\n");
+    BOOST_CHECK_THROW(mesh.load(path), std::runtime_error);
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(plyFile_writeRead)
+{
+    Mesh expected;
+    generateMesh(50000, 90000, expected);
+
+    const std::string path = getTemporaryPath(".ply");
+    expected.save(path);
+
+    Mesh mesh;
+    BOOST_CHECK(mesh.load(path));
+    BOOST_REQUIRE_EQUAL(mesh.pts.size(), expected.pts.size());
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        BOOST_CHECK(mesh.pts[i] == expected.pts[i]);
+        BOOST_CHECK(sameColor(mesh.colors()[i], expected.colors()[i]));
+    }
+    checkTriangles(mesh, expected);
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(plyFile_ascii)
+{
+    const std::string path = getTemporaryPath(".ply");
+    writeText(path,
+              "ply\n"
+              "format ascii 1.0\n"
+              "comment quad with a property before the positions\n"
+              "element vertex 4\n"
+              "property float confidence\n"
+              "property float x\n"
+              "property float y\n"
+              "property float z\n"
+              "property uchar red\n"
+              "property uchar green\n"
+              "property uchar blue\n"
+              "element face 2\n"
+              "property list uchar int vertex_indices\n"
+              "property uchar flags\n"
+              "end_header\n"
+              "0.5 0 0 0 255 0 0\n"
+              "0.5 1 0 0 0 255 0\n"
+              "0.5 1 1 0 0 0 255\n"
+              "0.5 0 1 0 10 20 30\n"
+              "4 0 1 2 3 7\n"
+              "3 3 2 1 7\n");
+
+    Mesh mesh;
+    BOOST_CHECK(mesh.load(path));
+    BOOST_REQUIRE_EQUAL(mesh.pts.size(), 4);
+    BOOST_CHECK_EQUAL(mesh.pts[2].x, 1.0);
+    BOOST_CHECK_EQUAL(mesh.pts[3].y, 1.0);
+    BOOST_CHECK(sameColor(mesh.colors()[3], rgb(10, 20, 30)));
+    checkTriangles(mesh, [&]
+    {
+        Mesh expected;
+        expected.tris.push_back(Mesh::triangle(0, 1, 2));
+        expected.tris.push_back(Mesh::triangle(0, 2, 3));
+        expected.tris.push_back(Mesh::triangle(3, 2, 1));
+        return expected;
+    }());
+
+    fs::remove(path);
+}
@@ -10,6 +10,7 @@
 #include <aliceVision/mvsData/Point3d.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mesh/MeshEnergyOpt.hpp>
+#include <aliceVision/mesh/meshVisibility.hpp>
 
 #include <boost/filesystem/operations.hpp>
 
@@ -136,6 +137,14 @@ void meshPostProcessing(Mesh*& inout_mesh, StaticVector<StaticVector<int>>& inou
         inout_mesh = new Mesh();
         inout_mesh->addMesh(meOpt);
     }
+
+    // the visibilities come from the reconstruction, not from the cleaned and smoothed surface
+    if(mp.userParams.get<bool>("meshPostProcessing.rayCastVisibility", false))
+    {
+        ALICEVISION_LOG_INFO("Ray casting visibility check.");
+        removeOccludedVisibilities(mp, *inout_mesh, inout_ptsCams,
+                                   mp.userParams.get<bool>("meshPostProcessing.backFaceCulling", false));
+    }
     mvsUtils::printfElapsedTime(timer, "Mesh post-processing ");
     ALICEVISION_LOG_INFO("Mesh post-processing done.");
 }
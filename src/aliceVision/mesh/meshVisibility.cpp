@@ -6,6 +6,7 @@
 
 #include "meshVisibility.hpp"
 #include "geoMesh.hpp"
+#include "MeshBVH.hpp"
 
 #include <aliceVision/system/Logger.hpp>
 
@@ -138,5 +139,15 @@ void remapMeshVisibilities_pushVerticesVisibilityToTriangles(const Mesh& refMesh
     ALICEVISION_LOG_INFO("remapMeshVisibility done.");
 }
 
+std::size_t removeOccludedVisibilities(const mvsUtils::MultiViewParams& mp, const Mesh& mesh, PointsVisibility& pointsVisibilities,
+                                       bool backFaceCulling)
+{
+    const MeshBVH bvh(mesh, backFaceCulling);
+    const std::size_t nbRemoved = bvh.filterPointsVisibilities(mp, pointsVisibilities);
+    ALICEVISION_LOG_INFO("Ray casting visibility check: " << nbRemoved << " visibilities removed"
+                         << (backFaceCulling ? " (with back-face culling)." : "."));
+    return nbRemoved;
+}
+
 } // namespace mesh
 } // namespace aliceVision
@@ -9,7 +9,14 @@
 #include <aliceVision/mesh/Mesh.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 
+#include <cstddef>
+
 namespace aliceVision {
+
+namespace mvsUtils {
+class MultiViewParams;
+}
+
 namespace mesh {
 
 /**
@@ -41,6 +48,19 @@ void remapMeshVisibilities_pullVerticesVisibility(const Mesh& refMesh, Mesh &mes
 */
 void remapMeshVisibilities_pushVerticesVisibilityToTriangles(const Mesh& refMesh, Mesh& mesh);
 
+/**
+ * @brief Remove the visibilities of the vertices that the cameras can't see, using ray casting on the mesh itself.
+ * A camera is removed from the visibility of a vertex if the vertex is behind it, outside of its image,
+ * occluded by the mesh or, with back-face culling, if the camera is behind the surface around the vertex.
+ *
+ * @param[in] mp the multi-view parameters
+ * @param[in] mesh input mesh
+ * @param[in,out] pointsVisibilities the camera indexes per vertex of the @p mesh
+ * @param[in] backFaceCulling remove the back-facing visibilities, the normals of the @p mesh must face the cameras
+ * @return the number of removed visibilities
+ */
+std::size_t removeOccludedVisibilities(const mvsUtils::MultiViewParams& mp, const Mesh& mesh, PointsVisibility& pointsVisibilities,
+                                       bool backFaceCulling = false);
 
 } // namespace mesh
 } // namespace aliceVision
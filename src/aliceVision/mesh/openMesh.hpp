@@ -0,0 +1,76 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mesh/meshIO.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace mesh {
+
+/**
+* @brief Create an OpenMesh triangle mesh from a mapped AliceVision mesh file,
+*        the points and the triangles are read in place from the file
+*        (their indexes are checked by the reader)
+*
+* @note only initialize vertices and faces
+* @param[in] the source mesh file
+* @param[out] the destination OpenMesh mesh (OpenMesh::TriMesh_ArrayKernelT or derived)
+*/
+template<typename OpenMeshT>
+void toOpenMesh(const MeshFileReader& src, OpenMeshT& dst)
+{
+    const std::size_t nbPoints = src.getNbPoints();
+    const std::size_t nbTriangles = src.getNbTriangles();
+    const double* points = src.getPoints();
+    const std::int32_t* triangles = src.getTriangles();
+
+    dst.clear();
+    dst.reserve(nbPoints, 3 * nbTriangles / 2, nbTriangles);
+
+    std::vector<typename OpenMeshT::VertexHandle> vertices(nbPoints);
+    for(std::size_t i = 0; i < nbPoints; ++i)
+        vertices[i] = dst.add_vertex(typename OpenMeshT::Point(points[3 * i], points[3 * i + 1], points[3 * i + 2]));
+
+    for(std::size_t i = 0; i < nbTriangles; ++i)
+        dst.add_face(vertices[triangles[3 * i]], vertices[triangles[3 * i + 1]], vertices[triangles[3 * i + 2]]);
+}
+
+/**
+* @brief Create an aliceVision::Mesh from an OpenMesh triangle mesh
+*
+* @note only initialize vertices and triangles, the OpenMesh mesh must not have deleted elements (see garbage_collection)
+* @param[in] the source OpenMesh mesh (OpenMesh::TriMesh_ArrayKernelT or derived)
+* @param[out] the destination aliceVision mesh
+*/
+template<typename OpenMeshT>
+void fromOpenMesh(const OpenMeshT& src, Mesh& dst)
+{
+    dst = Mesh();
+    dst.pts.reserve(src.n_vertices());
+    dst.tris.reserve(src.n_faces());
+
+    for(auto v = src.vertices_begin(); v != src.vertices_end(); ++v)
+    {
+        const auto& point = src.point(*v);
+        dst.pts.push_back(Point3d(point[0], point[1], point[2]));
+    }
+
+    for(auto f = src.faces_begin(); f != src.faces_end(); ++f)
+    {
+        int v[3];
+        int k = 0;
+        for(auto fv = src.cfv_iter(*f); fv.is_valid() && k < 3; ++fv)
+            v[k++] = fv->idx();
+        dst.tris.push_back(Mesh::triangle(v[0], v[1], v[2]));
+    }
+}
+
+}
+}
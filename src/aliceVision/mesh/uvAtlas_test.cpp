@@ -0,0 +1,316 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mesh/UVAtlas.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#define BOOST_TEST_MODULE uvAtlas
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::mesh;
+
+namespace {
+
+/// pinhole cameras of 200x200 pixels at z=0 looking toward +z
+void addCameras(sfmData::SfMData& sfmData)
+{
+    sfmData.intrinsics[0] = std::make_shared<camera::Pinhole>(200, 200, 200.0, 100.0, 100.0);
+
+    const std::vector<Vec3> centers = {Vec3(0.0, 0.0, 0.0), Vec3(1.0, 0.0, 0.0), Vec3(0.0, 1.0, 0.0), Vec3(-1.0, -0.5, 0.0)};
+    for(IndexT i = 0; i < centers.size(); ++i)
+    {
+        sfmData.views[i] = std::make_shared<sfmData::View>("", i, 0, i, 200, 200);
+        sfmData.setPose(*sfmData.views[i], sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), centers[i])));
+    }
+}
+
+/**
+ * @brief Disconnected bumpy grids at z=10, each one is a connected component of the mesh.
+ * The vertices are seen by random subsets of the cameras, to create charts of various sizes.
+ */
+Mesh createMesh(int nbCameras)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> bump(-0.05, 0.05);
+    std::uniform_int_distribution<int> camera(0, nbCameras - 1);
+
+    Mesh mesh;
+    const int nbGrids = 6;
+    const int gridSide = 20;
+    const double step = 0.1;
+    for(int g = 0; g < nbGrids; ++g)
+    {
+        const int first = mesh.pts.size();
+        const Point3d origin(-3.0 + (g % 3) * 2.1, -2.0 + (g / 3) * 2.1, 10.0);
+        for(int y = 0; y < gridSide; ++y)
+        {
+            for(int x = 0; x < gridSide; ++x)
+                mesh.pts.push_back(origin + Point3d(x * step, y * step, bump(generator)));
+        }
+        for(int y = 0; y < gridSide - 1; ++y)
+        {
+            for(int x = 0; x < gridSide - 1; ++x)
+            {
+                const int v = first + y * gridSide + x;
+                mesh.tris.push_back(Mesh::triangle(v, v + 1, v + gridSide + 1));
+                mesh.tris.push_back(Mesh::triangle(v, v + gridSide + 1, v + gridSide));
+            }
+        }
+    }
+
+    mesh.pointsVisibilities.resize(mesh.pts.size());
+    for(int i = 0; i < mesh.pts.size(); ++i)
+    {
+        PointVisibility& visibility = mesh.pointsVisibilities[i];
+        visibility.push_back(camera(generator));
+    }
+    return mesh;
+}
+
+/// guillotine packing node of the previous implementation, visiting the whole tree
+struct ReferenceRect
+{
+    UVAtlas::Chart* c = nullptr;
+    ReferenceRect* child[2] {nullptr, nullptr};
+    Pixel LU;
+    Pixel RD;
+
+    ~ReferenceRect()
+    {
+        delete child[0];
+        delete child[1];
+    }
+
+    ReferenceRect* insert(UVAtlas::Chart& chart, std::size_t gutter)
+    {
+        if(child[0] || child[1])
+        {
+            if(child[0])
+                if(ReferenceRect* rect = child[0]->insert(chart, gutter))
+                    return rect;
+            if(child[1])
+                if(ReferenceRect* rect = child[1]->insert(chart, gutter))
+                    return rect;
+            return nullptr;
+        }
+        const std::size_t chartWidth = chart.targetWidth() + gutter * 2;
+        const std::size_t chartHeight = chart.targetHeight() + gutter * 2;
+        if(c)
+            return nullptr;
+        if(chartWidth > (RD.x - LU.x) || chartHeight > (RD.y - LU.y))
+            return nullptr;
+        if(chartWidth >= chartHeight)
+        {
+            if(chartWidth < (RD.x - LU.x))
+                child[0] = create(LU.x + chartWidth, LU.y, RD.x, LU.y + chartHeight);
+            if(chartHeight < (RD.y - LU.y))
+                child[1] = create(LU.x, LU.y + chartHeight, RD.x, RD.y);
+        }
+        else
+        {
+            if(chartHeight < (RD.y - LU.y))
+                child[0] = create(LU.x, LU.y + chartHeight, LU.x + chartWidth, RD.y);
+            if(chartWidth < (RD.x - LU.x))
+                child[1] = create(LU.x + chartWidth, LU.y, RD.x, RD.y);
+        }
+        c = &chart;
+        return this;
+    }
+
+    static ReferenceRect* create(int luX, int luY, int rdX, int rdY)
+    {
+        ReferenceRect* rect = new ReferenceRect();
+        rect->LU = Pixel(luX, luY);
+        rect->RD = Pixel(rdX, rdY);
+        return rect;
+    }
+};
+
+/**
+ * @brief Sequential chart merging of the previous implementation: the shared edges are
+ * processed in vertex IDs order, over the whole mesh.
+ * @return the remaining charts, in the order of their root triangle
+ */
+std::vector<UVAtlas::Chart> referenceMergeCharts(const Mesh& mesh, const UVAtlas& atlas)
+{
+    std::vector<UVAtlas::Chart> charts(mesh.tris.size());
+    for(int i = 0; i < charts.size(); ++i)
+    {
+        charts[i].commonCameraIDs = atlas.visibleCameras(i);
+        charts[i].triangleIDs.push_back(i);
+    }
+
+    std::map<std::pair<int, int>, std::vector<int>> trianglesPerEdge;
+    for(int i = 0; i < mesh.tris.size(); ++i)
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            const int a = mesh.tris[i].v[k];
+            const int b = mesh.tris[i].v[(k + 1) % 3];
+            trianglesPerEdge[std::make_pair(std::min(a, b), std::max(a, b))].push_back(i);
+        }
+    }
+
+    const auto findChart = [&](int cid)
+    {
+        while(charts[cid].mergedWith >= 0)
+            cid = charts[cid].mergedWith;
+        return cid;
+    };
+
+    for(const auto& edge : trianglesPerEdge)
+    {
+        if(edge.second.size() != 2)
+            continue;
+        const int chartIDA = findChart(edge.second[0]);
+        const int chartIDB = findChart(edge.second[1]);
+        if(chartIDA == chartIDB)
+            continue;
+        UVAtlas::Chart& a = charts[chartIDA];
+        UVAtlas::Chart& b = charts[chartIDB];
+        std::vector<int> cameraIntersection;
+        std::set_intersection(a.commonCameraIDs.begin(), a.commonCameraIDs.end(),
+                              b.commonCameraIDs.begin(), b.commonCameraIDs.end(),
+                              std::back_inserter(cameraIntersection));
+        if(cameraIntersection.empty())
+            continue;
+        UVAtlas::Chart& target = (a.triangleIDs.size() > b.triangleIDs.size()) ? a : b;
+        UVAtlas::Chart& source = (a.triangleIDs.size() > b.triangleIDs.size()) ? b : a;
+        target.commonCameraIDs = cameraIntersection;
+        target.triangleIDs.insert(target.triangleIDs.end(), source.triangleIDs.begin(), source.triangleIDs.end());
+        source.mergedWith = (&target == &a) ? chartIDA : chartIDB;
+    }
+
+    charts.erase(std::remove_if(charts.begin(), charts.end(), [](const UVAtlas::Chart& c) { return c.mergedWith >= 0; }), charts.end());
+    for(UVAtlas::Chart& chart : charts)
+        std::sort(chart.triangleIDs.begin(), chart.triangleIDs.end());
+    return charts;
+}
+
+/// sequential packing of the previous implementation
+std::vector<std::vector<UVAtlas::Chart>> referencePackCharts(std::vector<UVAtlas::Chart> charts, int textureSide, int gutterSize)
+{
+    std::sort(charts.begin(), charts.end(), [](const UVAtlas::Chart& a, const UVAtlas::Chart& b)
+    {
+        if(a.targetWidth() == b.targetWidth())
+            return a.targetHeight() > b.targetHeight();
+        return a.targetWidth() > b.targetWidth();
+    });
+
+    std::vector<std::vector<UVAtlas::Chart>> atlases;
+    std::size_t i = 0;
+    std::size_t j = charts.size() - 1;
+    while(i <= j)
+    {
+        std::vector<UVAtlas::Chart> atlas;
+        ReferenceRect root;
+        root.RD = Pixel(textureSide - 1, textureSide - 1);
+
+        const auto insertChart = [&](std::size_t idx)
+        {
+            UVAtlas::Chart& chart = charts[idx];
+            const ReferenceRect* rect = root.insert(chart, gutterSize);
+            if(!rect)
+                return false;
+            chart.targetLU = Pixel(rect->LU.x + gutterSize, rect->LU.y + gutterSize);
+            atlas.push_back(chart);
+            return true;
+        };
+        while(i <= j && insertChart(i)) { ++i; }
+        while(j > i && insertChart(j)) { --j; }
+
+        BOOST_REQUIRE(!atlas.empty());
+        atlases.push_back(atlas);
+    }
+    return atlases;
+}
+
+/// the chart ID is its smallest triangle ID
+int getChartID(const UVAtlas::Chart& chart)
+{
+    return *std::min_element(chart.triangleIDs.begin(), chart.triangleIDs.end());
+}
+
+void checkSameAtlases(const std::vector<std::vector<UVAtlas::Chart>>& atlases, const std::vector<std::vector<UVAtlas::Chart>>& expectedAtlases)
+{
+    BOOST_REQUIRE_EQUAL(atlases.size(), expectedAtlases.size());
+    for(std::size_t t = 0; t < atlases.size(); ++t)
+    {
+        BOOST_REQUIRE_EQUAL(atlases[t].size(), expectedAtlases[t].size());
+        for(std::size_t c = 0; c < atlases[t].size(); ++c)
+        {
+            const UVAtlas::Chart& chart = atlases[t][c];
+            const UVAtlas::Chart& expected = expectedAtlases[t][c];
+            BOOST_CHECK_EQUAL(getChartID(chart), getChartID(expected));
+            BOOST_CHECK(chart.triangleIDs == expected.triangleIDs);
+            BOOST_CHECK(chart.commonCameraIDs == expected.commonCameraIDs);
+            BOOST_CHECK_EQUAL(chart.refCameraID, expected.refCameraID);
+            BOOST_CHECK_EQUAL(chart.targetLU.x, expected.targetLU.x);
+            BOOST_CHECK_EQUAL(chart.targetLU.y, expected.targetLU.y);
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(uvAtlas_sameAsSequential)
+{
+    sfmData::SfMData sfmData;
+    addCameras(sfmData);
+    mvsUtils::MultiViewParams mp(sfmData);
+    const Mesh mesh = createMesh(mp.ncams);
+
+    // small textures, so that the charts are spread over several atlases
+    const int textureSide = 128;
+    const int gutterSize = 2;
+
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    const UVAtlas sequentialAtlas(mesh, mp, textureSide, gutterSize);
+    omp_set_num_threads(std::max(maxThreads, 4));
+    const UVAtlas parallelAtlas(mesh, mp, textureSide, gutterSize);
+    omp_set_num_threads(maxThreads);
+
+    BOOST_CHECK_GT(sequentialAtlas.atlases().size(), 1);
+    checkSameAtlases(parallelAtlas.atlases(), sequentialAtlas.atlases());
+
+    // same charts as the previous implementation
+    std::vector<UVAtlas::Chart> expectedCharts = referenceMergeCharts(mesh, sequentialAtlas);
+    std::map<int, const UVAtlas::Chart*> chartPerID;
+    for(const std::vector<UVAtlas::Chart>& atlas : sequentialAtlas.atlases())
+    {
+        for(const UVAtlas::Chart& chart : atlas)
+            chartPerID[getChartID(chart)] = &chart;
+    }
+    BOOST_REQUIRE_EQUAL(chartPerID.size(), expectedCharts.size());
+    BOOST_CHECK_GT(expectedCharts.size(), 10);
+    for(UVAtlas::Chart& expected : expectedCharts)
+    {
+        const auto it = chartPerID.find(getChartID(expected));
+        BOOST_REQUIRE(it != chartPerID.end());
+        const UVAtlas::Chart& chart = *it->second;
+        BOOST_CHECK(chart.triangleIDs == expected.triangleIDs);
+        BOOST_CHECK(chart.commonCameraIDs == expected.commonCameraIDs);
+        // the size in the atlas does not depend on the packing
+        expected.refCameraID = chart.refCameraID;
+        expected.sourceLU = chart.sourceLU;
+        expected.sourceRD = chart.sourceRD;
+        expected.downscale = chart.downscale;
+    }
+
+    // same placement as the previous packing, which visits the whole tree
+    checkSameAtlases(sequentialAtlas.atlases(), referencePackCharts(expectedCharts, textureSide, gutterSize));
+}
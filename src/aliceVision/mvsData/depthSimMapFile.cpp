@@ -0,0 +1,724 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "depthSimMapFile.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <OpenEXR/half.h>
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace imageIO {
+
+namespace {
+
+// File layout (little endian):
+//  - header: magic, version, dimensions, encodings, statistics, size of the metadata block
+//  - metadata block: typed oiio attributes
+//  - tile table: for each tile (row major), its offset in the file and its number of valid pixels
+//  - tiles: validity bitmap, then the depth and the similarity of the valid pixels
+
+const char fileMagic[4] = {'A', 'V', 'D', 'M'};
+const std::uint32_t fileVersion = 1;
+const std::size_t headerSize = 56;
+const std::size_t tileTableEntrySize = sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+/// Append raw values to a byte buffer
+class ByteWriter
+{
+public:
+  explicit ByteWriter(std::vector<unsigned char>& buffer)
+    : _buffer(buffer)
+  {}
+
+  template<typename T>
+  void put(const T& value)
+  {
+    putBytes(&value, sizeof(T));
+  }
+
+  void putBytes(const void* data, std::size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    _buffer.insert(_buffer.end(), bytes, bytes + size);
+  }
+
+private:
+  std::vector<unsigned char>& _buffer;
+};
+
+/// Read raw values from a byte range, with bounds checking
+class ByteReader
+{
+public:
+  ByteReader(const unsigned char* data, std::size_t size)
+    : _data(data)
+    , _size(size)
+  {}
+
+  template<typename T>
+  T get()
+  {
+    T value;
+    getBytes(&value, sizeof(T));
+    return value;
+  }
+
+  void getBytes(void* data, std::size_t size)
+  {
+    std::memcpy(data, skip(size), size);
+  }
+
+  const unsigned char* skip(std::size_t size)
+  {
+    if(size > _size - _offset)
+      throw std::runtime_error("Depth/sim map file: unexpected end of data.");
+    const unsigned char* ptr = _data + _offset;
+    _offset += size;
+    return ptr;
+  }
+
+  std::size_t offset() const { return _offset; }
+
+private:
+  const unsigned char* _data;
+  std::size_t _size;
+  std::size_t _offset = 0;
+};
+
+std::size_t encodingSize(EDepthMapEncoding encoding)
+{
+  switch(encoding)
+  {
+    case EDepthMapEncoding::FLOAT32: return 4;
+    case EDepthMapEncoding::FLOAT16: return 2;
+    case EDepthMapEncoding::UINT16:  return 2;
+    case EDepthMapEncoding::UINT8:   return 1;
+  }
+  throw std::out_of_range("Invalid depth map encoding: " + std::to_string(int(encoding)));
+}
+
+/// Quantize a value of the [minValue, maxValue] range on the given number of levels
+template<typename T>
+T quantize(float value, float minValue, float maxValue)
+{
+  const float maxLevel = static_cast<float>(std::numeric_limits<T>::max());
+  if(maxValue <= minValue)
+    return 0;
+  const float level = std::round((value - minValue) / (maxValue - minValue) * maxLevel);
+  return static_cast<T>(std::min(std::max(level, 0.f), maxLevel));
+}
+
+template<typename T>
+float dequantize(T level, float minValue, float maxValue)
+{
+  return minValue + static_cast<float>(level) * (maxValue - minValue) / static_cast<float>(std::numeric_limits<T>::max());
+}
+
+void encodeValue(float value, EDepthMapEncoding encoding, float minValue, float maxValue, ByteWriter& writer)
+{
+  switch(encoding)
+  {
+    case EDepthMapEncoding::FLOAT32: writer.put(value); break;
+    case EDepthMapEncoding::FLOAT16: writer.put(half(value).bits()); break;
+    case EDepthMapEncoding::UINT16:  writer.put(quantize<std::uint16_t>(value, minValue, maxValue)); break;
+    case EDepthMapEncoding::UINT8:   writer.put(quantize<std::uint8_t>(value, minValue, maxValue)); break;
+  }
+}
+
+float decodeValue(const unsigned char* data, EDepthMapEncoding encoding, float minValue, float maxValue)
+{
+  switch(encoding)
+  {
+    case EDepthMapEncoding::FLOAT32:
+    {
+      float value;
+      std::memcpy(&value, data, sizeof(value));
+      return value;
+    }
+    case EDepthMapEncoding::FLOAT16:
+    {
+      std::uint16_t bits;
+      std::memcpy(&bits, data, sizeof(bits));
+      half value;
+      value.setBits(bits);
+      return static_cast<float>(value);
+    }
+    case EDepthMapEncoding::UINT16:
+    {
+      std::uint16_t level;
+      std::memcpy(&level, data, sizeof(level));
+      return dequantize(level, minValue, maxValue);
+    }
+    case EDepthMapEncoding::UINT8:
+      return dequantize(*data, minValue, maxValue);
+  }
+  throw std::out_of_range("Invalid depth map encoding: " + std::to_string(int(encoding)));
+}
+
+void writeMetadata(const oiio::ParamValueList& metadata, ByteWriter& writer)
+{
+  writer.put(static_cast<std::uint32_t>(metadata.size()));
+  for(const oiio::ParamValue& param : metadata)
+  {
+    const std::string& name = param.name().string();
+    const oiio::TypeDesc type = param.type();
+
+    writer.put(static_cast<std::uint32_t>(name.size()));
+    writer.putBytes(name.data(), name.size());
+    writer.put(type.basetype);
+    writer.put(type.aggregate);
+    writer.put(type.vecsemantics);
+    writer.put(static_cast<std::int32_t>(type.arraylen));
+    writer.put(static_cast<std::int32_t>(param.nvalues()));
+
+    if(type.basetype == oiio::TypeDesc::STRING)
+    {
+      // strings are stored by value, not as pointers
+      std::vector<unsigned char> strings;
+      ByteWriter stringsWriter(strings);
+      const oiio::ustring* values = static_cast<const oiio::ustring*>(param.data());
+      for(std::size_t k = 0; k < type.numelements() * param.nvalues(); ++k)
+      {
+        const std::string& value = values[k].string();
+        stringsWriter.put(static_cast<std::uint32_t>(value.size()));
+        stringsWriter.putBytes(value.data(), value.size());
+      }
+      writer.put(static_cast<std::uint32_t>(strings.size()));
+      writer.putBytes(strings.data(), strings.size());
+    }
+    else
+    {
+      const std::size_t size = type.size() * param.nvalues();
+      writer.put(static_cast<std::uint32_t>(size));
+      writer.putBytes(param.data(), size);
+    }
+  }
+}
+
+void readMetadata(ByteReader& reader, oiio::ParamValueList& metadata)
+{
+  const std::uint32_t nbParams = reader.get<std::uint32_t>();
+  metadata.clear();
+  metadata.reserve(nbParams);
+  for(std::uint32_t i = 0; i < nbParams; ++i)
+  {
+    std::string name(reader.get<std::uint32_t>(), '\0');
+    reader.getBytes(&name[0], name.size());
+    const unsigned char basetype = reader.get<unsigned char>();
+    const unsigned char aggregate = reader.get<unsigned char>();
+    const unsigned char vecsemantics = reader.get<unsigned char>();
+    const int arraylen = reader.get<std::int32_t>();
+    const int nvalues = reader.get<std::int32_t>();
+    const std::uint32_t size = reader.get<std::uint32_t>();
+    const unsigned char* data = reader.skip(size);
+
+    const oiio::TypeDesc type(oiio::TypeDesc::BASETYPE(basetype), oiio::TypeDesc::AGGREGATE(aggregate),
+                              oiio::TypeDesc::VECSEMANTICS(vecsemantics), arraylen);
+
+    if(basetype == oiio::TypeDesc::STRING)
+    {
+      ByteReader stringsReader(data, size);
+      std::vector<oiio::ustring> values(type.numelements() * nvalues);
+      for(oiio::ustring& value : values)
+      {
+        std::string str(stringsReader.get<std::uint32_t>(), '\0');
+        stringsReader.getBytes(&str[0], str.size());
+        value = oiio::ustring(str);
+      }
+      metadata.push_back(oiio::ParamValue(name, type, nvalues, values.data()));
+    }
+    else
+    {
+      if(type.size() * nvalues != size)
+        throw std::runtime_error("Depth/sim map file: invalid size of the metadata '" + name + "'.");
+      metadata.push_back(oiio::ParamValue(name, type, nvalues, data));
+    }
+  }
+}
+
+void writeHeader(const DepthSimMapFileHeader& header, std::uint64_t metadataSize, ByteWriter& writer)
+{
+  writer.putBytes(fileMagic, sizeof(fileMagic));
+  writer.put(fileVersion);
+  writer.put(static_cast<std::uint32_t>(header.width));
+  writer.put(static_cast<std::uint32_t>(header.height));
+  writer.put(static_cast<std::uint32_t>(header.tileSize));
+  writer.put(static_cast<std::uint8_t>(header.depthEncoding));
+  writer.put(static_cast<std::uint8_t>(header.simEncoding));
+  writer.put(static_cast<std::uint8_t>(header.hasSimMap));
+  writer.put(static_cast<std::uint8_t>(0));
+  writer.put(static_cast<std::uint64_t>(header.nbValidPixels));
+  writer.put(header.minDepth);
+  writer.put(header.maxDepth);
+  writer.put(header.minSim);
+  writer.put(header.maxSim);
+  writer.put(metadataSize);
+}
+
+/**
+ * @brief Read the file header
+ * @return the size of the metadata block that follows the header
+ */
+std::uint64_t readHeader(ByteReader& reader, DepthSimMapFileHeader& header)
+{
+  char magic[sizeof(fileMagic)];
+  reader.getBytes(magic, sizeof(magic));
+  if(std::memcmp(magic, fileMagic, sizeof(fileMagic)) != 0)
+    throw std::runtime_error("Not a depth/sim map file.");
+
+  const std::uint32_t version = reader.get<std::uint32_t>();
+  if(version != fileVersion)
+    throw std::runtime_error("Unsupported depth/sim map file version: " + std::to_string(version) + ".");
+
+  const std::uint32_t width = reader.get<std::uint32_t>();
+  const std::uint32_t height = reader.get<std::uint32_t>();
+  const std::uint32_t tileSize = reader.get<std::uint32_t>();
+  header.depthEncoding = static_cast<EDepthMapEncoding>(reader.get<std::uint8_t>());
+  header.simEncoding = static_cast<EDepthMapEncoding>(reader.get<std::uint8_t>());
+  header.hasSimMap = reader.get<std::uint8_t>() != 0;
+  reader.get<std::uint8_t>();
+  header.nbValidPixels = reader.get<std::uint64_t>();
+  header.minDepth = reader.get<float>();
+  header.maxDepth = reader.get<float>();
+  header.minSim = reader.get<float>();
+  header.maxSim = reader.get<float>();
+
+  // the dimensions are stored in int, and the tiles and the pixels of a tile are indexed with int
+  const std::uint64_t maxInt = std::numeric_limits<int>::max();
+  if(width == 0 || height == 0 || width > maxInt || height > maxInt)
+    throw std::runtime_error("Depth/sim map file: invalid map dimensions.");
+  if(tileSize == 0 || tileSize > maxInt)
+    throw std::runtime_error("Depth/sim map file: invalid tile size.");
+
+  const std::uint64_t nbTiles = static_cast<std::uint64_t>((width + tileSize - 1) / tileSize) * ((height + tileSize - 1) / tileSize);
+  const std::uint64_t nbTilePixels = static_cast<std::uint64_t>(std::min(tileSize, width)) * std::min(tileSize, height);
+  if(nbTiles > maxInt || nbTilePixels > maxInt)
+    throw std::runtime_error("Depth/sim map file: invalid tile size.");
+
+  header.width = static_cast<int>(width);
+  header.height = static_cast<int>(height);
+  header.tileSize = static_cast<int>(tileSize);
+
+  // check encodings
+  encodingSize(header.depthEncoding);
+  encodingSize(header.simEncoding);
+
+  return reader.get<std::uint64_t>();
+}
+
+/// Count the valid pixels of the validity bitmap of a tile
+std::size_t countValidPixels(const unsigned char* bitmap, int nbPixels)
+{
+  std::size_t nbValid = 0;
+  for(int i = 0; i < nbPixels / 8; ++i)
+    nbValid += std::bitset<8>(bitmap[i]).count();
+  // ignore the padding bits of the last byte
+  if(nbPixels % 8 != 0)
+    nbValid += std::bitset<8>(bitmap[nbPixels / 8] & ((1 << (nbPixels % 8)) - 1)).count();
+  return nbValid;
+}
+
+/// Encode a tile: validity bitmap, then depths and similarities of the valid pixels
+std::uint32_t encodeTile(const DepthSimMapFileHeader& header, int tileX, int tileY,
+                         const std::vector<float>& depthMap, const std::vector<float>& simMap,
+                         std::vector<unsigned char>& buffer)
+{
+  const int x0 = tileX * header.tileSize;
+  const int y0 = tileY * header.tileSize;
+  const int tileWidth = std::min(header.tileSize, header.width - x0);
+  const int tileHeight = std::min(header.tileSize, header.height - y0);
+
+  std::vector<unsigned char> bitmap((tileWidth * tileHeight + 7) / 8, 0);
+  std::uint32_t nbValid = 0;
+
+  for(int y = 0; y < tileHeight; ++y)
+  {
+    for(int x = 0; x < tileWidth; ++x)
+    {
+      if(depthMap[(y0 + y) * header.width + x0 + x] > 0.0f)
+      {
+        const int i = y * tileWidth + x;
+        bitmap[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+        ++nbValid;
+      }
+    }
+  }
+
+  buffer.clear();
+  if(nbValid == 0)
+    return 0;
+
+  ByteWriter writer(buffer);
+  writer.putBytes(bitmap.data(), bitmap.size());
+
+  for(int y = 0; y < tileHeight; ++y)
+    for(int x = 0; x < tileWidth; ++x)
+    {
+      const float depth = depthMap[(y0 + y) * header.width + x0 + x];
+      if(depth > 0.0f)
+        encodeValue(depth, header.depthEncoding, header.minDepth, header.maxDepth, writer);
+    }
+
+  if(header.hasSimMap)
+  {
+    for(int y = 0; y < tileHeight; ++y)
+      for(int x = 0; x < tileWidth; ++x)
+      {
+        const int i = (y0 + y) * header.width + x0 + x;
+        if(depthMap[i] > 0.0f)
+          encodeValue(simMap[i], header.simEncoding, header.minSim, header.maxSim, writer);
+      }
+  }
+  return nbValid;
+}
+
+} // namespace
+
+std::string EDepthMapEncoding_informations()
+{
+  return "Depth map encoding:\n"
+         "* float32: lossless\n"
+         "* float16: half float\n"
+         "* uint16: quantized on 16 bits relative to the range of the map\n"
+         "* uint8: quantized on 8 bits relative to the range of the map";
+}
+
+EDepthMapEncoding EDepthMapEncoding_stringToEnum(const std::string& encoding)
+{
+  std::string type = encoding;
+  boost::to_lower(type);
+
+  if(type == "float32") return EDepthMapEncoding::FLOAT32;
+  if(type == "float16") return EDepthMapEncoding::FLOAT16;
+  if(type == "uint16")  return EDepthMapEncoding::UINT16;
+  if(type == "uint8")   return EDepthMapEncoding::UINT8;
+
+  throw std::out_of_range("Invalid depth map encoding: " + encoding);
+}
+
+std::string EDepthMapEncoding_enumToString(EDepthMapEncoding encoding)
+{
+  switch(encoding)
+  {
+    case EDepthMapEncoding::FLOAT32: return "float32";
+    case EDepthMapEncoding::FLOAT16: return "float16";
+    case EDepthMapEncoding::UINT16:  return "uint16";
+    case EDepthMapEncoding::UINT8:   return "uint8";
+  }
+  throw std::out_of_range("Invalid EDepthMapEncoding enum: " + std::to_string(int(encoding)));
+}
+
+std::ostream& operator<<(std::ostream& os, EDepthMapEncoding encoding)
+{
+  return os << EDepthMapEncoding_enumToString(encoding);
+}
+
+std::istream& operator>>(std::istream& in, EDepthMapEncoding& encoding)
+{
+  std::string token;
+  in >> token;
+  encoding = EDepthMapEncoding_stringToEnum(token);
+  return in;
+}
+
+void writeDepthSimMapFile(const std::string& path, int width, int height,
+                          const std::vector<float>& depthMap, const std::vector<float>& simMap,
+                          const DepthSimMapFileOptions& options, const oiio::ParamValueList& metadata)
+{
+  const std::size_t nbPixels = static_cast<std::size_t>(width) * height;
+
+  if(width <= 0 || height <= 0 || depthMap.size() != nbPixels || (!simMap.empty() && simMap.size() != nbPixels))
+    throw std::invalid_argument("Can't write depth/sim map file '" + path + "': invalid map dimensions.");
+  if(options.tileSize <= 0)
+    throw std::invalid_argument("Can't write depth/sim map file '" + path + "': invalid tile size.");
+
+  DepthSimMapFileHeader header;
+  header.width = width;
+  header.height = height;
+  header.tileSize = options.tileSize;
+  header.depthEncoding = options.depthEncoding;
+  header.simEncoding = options.simEncoding;
+  header.hasSimMap = !simMap.empty();
+
+  // statistics of the valid pixels, also used as quantization ranges
+  header.minDepth = header.minSim = std::numeric_limits<float>::max();
+  header.maxDepth = header.maxSim = std::numeric_limits<float>::lowest();
+  for(std::size_t i = 0; i < nbPixels; ++i)
+  {
+    if(depthMap[i] <= 0.0f)
+      continue;
+    ++header.nbValidPixels;
+    header.minDepth = std::min(header.minDepth, depthMap[i]);
+    header.maxDepth = std::max(header.maxDepth, depthMap[i]);
+    if(header.hasSimMap)
+    {
+      header.minSim = std::min(header.minSim, simMap[i]);
+      header.maxSim = std::max(header.maxSim, simMap[i]);
+    }
+  }
+  if(header.nbValidPixels == 0)
+    header.minDepth = header.maxDepth = 0.f;
+  if(!header.hasSimMap || header.nbValidPixels == 0)
+    header.minSim = header.maxSim = 0.f;
+
+  // encode the tiles
+  const int nbTiles = header.getNbTilesX() * header.getNbTilesY();
+  std::vector<std::vector<unsigned char>> tiles(nbTiles);
+  std::vector<std::uint32_t> tilesNbValid(nbTiles);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int t = 0; t < nbTiles; ++t)
+    tilesNbValid[t] = encodeTile(header, t % header.getNbTilesX(), t / header.getNbTilesX(), depthMap, simMap, tiles[t]);
+
+  std::vector<unsigned char> metadataBuffer;
+  {
+    ByteWriter writer(metadataBuffer);
+    writeMetadata(metadata, writer);
+  }
+
+  std::vector<unsigned char> buffer;
+  ByteWriter writer(buffer);
+  writeHeader(header, metadataBuffer.size(), writer);
+  writer.putBytes(metadataBuffer.data(), metadataBuffer.size());
+
+  std::uint64_t tileOffset = buffer.size() + nbTiles * tileTableEntrySize;
+  for(int t = 0; t < nbTiles; ++t)
+  {
+    writer.put(tileOffset);
+    writer.put(tilesNbValid[t]);
+    tileOffset += tiles[t].size();
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  if(!file.is_open())
+    throw std::runtime_error("Can't write depth/sim map file '" + path + "'.");
+
+  file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  for(const std::vector<unsigned char>& tile : tiles)
+    file.write(reinterpret_cast<const char*>(tile.data()), tile.size());
+
+  if(!file.good())
+    throw std::runtime_error("Failed to write depth/sim map file '" + path + "'.");
+}
+
+DepthSimMapFileHeader readDepthSimMapFileHeader(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if(!file.is_open())
+    throw std::runtime_error("Can't read depth/sim map file '" + path + "'.");
+
+  // fixed size part of the header
+  std::vector<unsigned char> buffer(headerSize);
+  file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+  buffer.resize(file.gcount());
+
+  DepthSimMapFileHeader header;
+  ByteReader reader(buffer.data(), buffer.size());
+  try
+  {
+    readHeader(reader, header);
+  }
+  catch(const std::exception& e)
+  {
+    throw std::runtime_error("Can't read depth/sim map file '" + path + "': " + e.what());
+  }
+  return header;
+}
+
+struct DepthSimMapFileReader::MappedFile
+{
+  boost::interprocess::file_mapping mapping;
+  boost::interprocess::mapped_region region;
+};
+
+DepthSimMapFileReader::DepthSimMapFileReader(const std::string& path)
+{
+  namespace bip = boost::interprocess;
+
+  try
+  {
+    _file.reset(new MappedFile);
+    _file->mapping = bip::file_mapping(path.c_str(), bip::read_only);
+    _file->region = bip::mapped_region(_file->mapping, bip::read_only);
+  }
+  catch(const bip::interprocess_exception& e)
+  {
+    throw std::runtime_error("Can't map depth/sim map file '" + path + "': " + e.what());
+  }
+
+  _data = static_cast<const unsigned char*>(_file->region.get_address());
+  _size = _file->region.get_size();
+
+  try
+  {
+    ByteReader reader(_data, _size);
+    const std::uint64_t metadataSize = readHeader(reader, _header);
+    ByteReader metadataReader(reader.skip(metadataSize), metadataSize);
+    readMetadata(metadataReader, _metadata);
+
+    _tileTableOffset = reader.offset();
+    const std::size_t nbTiles = static_cast<std::size_t>(_header.getNbTilesX()) * _header.getNbTilesY();
+    reader.skip(nbTiles * tileTableEntrySize);
+  }
+  catch(const std::exception& e)
+  {
+    throw std::runtime_error("Can't read depth/sim map file '" + path + "': " + e.what());
+  }
+}
+
+DepthSimMapFileReader::~DepthSimMapFileReader() = default;
+
+std::size_t DepthSimMapFileReader::getTileNbValidPixels(int tileX, int tileY) const
+{
+  if(tileX < 0 || tileY < 0 || tileX >= _header.getNbTilesX() || tileY >= _header.getNbTilesY())
+    throw std::out_of_range("Invalid depth/sim map tile.");
+
+  std::uint32_t nbValid;
+  const std::size_t entry = _tileTableOffset + (tileY * _header.getNbTilesX() + tileX) * tileTableEntrySize;
+  std::memcpy(&nbValid, _data + entry + sizeof(std::uint64_t), sizeof(nbValid));
+  return nbValid;
+}
+
+void DepthSimMapFileReader::read(std::vector<float>& depthMap, std::vector<float>* simMap) const
+{
+  readRegion(0, 0, _header.width, _header.height, depthMap, simMap);
+}
+
+void DepthSimMapFileReader::readRegion(int x, int y, int width, int height, std::vector<float>& depthMap, std::vector<float>* simMap) const
+{
+  if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > _header.width || y + height > _header.height)
+    throw std::out_of_range("Invalid depth/sim map region.");
+
+  const std::size_t nbPixels = static_cast<std::size_t>(width) * height;
+  depthMap.assign(nbPixels, -1.f);
+  if(simMap != nullptr)
+    simMap->assign(nbPixels, 1.f);
+
+  if(nbPixels == 0)
+    return;
+
+  const int tileSize = _header.tileSize;
+  const std::size_t depthSize = encodingSize(_header.depthEncoding);
+  const std::size_t simSize = encodingSize(_header.simEncoding);
+  const bool readSim = (simMap != nullptr) && _header.hasSimMap;
+
+  for(int tileY = y / tileSize; tileY <= (y + height - 1) / tileSize; ++tileY)
+  {
+    for(int tileX = x / tileSize; tileX <= (x + width - 1) / tileSize; ++tileX)
+    {
+      const std::size_t entry = _tileTableOffset + (tileY * _header.getNbTilesX() + tileX) * tileTableEntrySize;
+      std::uint64_t offset;
+      std::uint32_t nbValid;
+      std::memcpy(&offset, _data + entry, sizeof(offset));
+      std::memcpy(&nbValid, _data + entry + sizeof(offset), sizeof(nbValid));
+
+      if(nbValid == 0)
+        continue;
+
+      const int x0 = tileX * tileSize;
+      const int y0 = tileY * tileSize;
+      const int tileWidth = std::min(tileSize, _header.width - x0);
+      const int tileHeight = std::min(tileSize, _header.height - y0);
+      const std::size_t bitmapSize = (static_cast<std::size_t>(tileWidth) * tileHeight + 7) / 8;
+      const std::size_t tileDataSize = bitmapSize + nbValid * (depthSize + (_header.hasSimMap ? simSize : 0));
+
+      if(offset > _size || tileDataSize > _size - offset)
+        throw std::runtime_error("Depth/sim map file: invalid tile offset.");
+
+      const unsigned char* bitmap = _data + offset;
+      if(countValidPixels(bitmap, tileWidth * tileHeight) != nbValid)
+        throw std::runtime_error("Depth/sim map file: the number of valid pixels of a tile does not match its bitmap.");
+
+      const unsigned char* depths = bitmap + bitmapSize;
+      const unsigned char* sims = depths + nbValid * depthSize;
+
+      // intersection of the tile and the region
+      const int beginX = std::max(x, x0);
+      const int endX = std::min(x + width, x0 + tileWidth);
+      const int beginY = std::max(y, y0);
+      const int endY = std::min(y + height, y0 + tileHeight);
+
+      std::size_t validIndex = 0;
+      for(int ty = 0; ty < tileHeight; ++ty)
+      {
+        const int py = y0 + ty;
+        for(int tx = 0; tx < tileWidth; ++tx)
+        {
+          const int i = ty * tileWidth + tx;
+          if(!(bitmap[i / 8] & (1 << (i % 8))))
+            continue;
+
+          const int px = x0 + tx;
+          if(py >= beginY && py < endY && px >= beginX && px < endX)
+          {
+            const std::size_t outIndex = static_cast<std::size_t>(py - y) * width + (px - x);
+            depthMap[outIndex] = decodeValue(depths + validIndex * depthSize, _header.depthEncoding, _header.minDepth, _header.maxDepth);
+            if(readSim)
+              (*simMap)[outIndex] = decodeValue(sims + validIndex * simSize, _header.simEncoding, _header.minSim, _header.maxSim);
+          }
+          ++validIndex;
+        }
+      }
+    }
+  }
+}
+
+void convertDepthSimMapFromEXR(const std::string& depthMapPath, const std::string& simMapPath,
+                               const std::string& outputPath, const DepthSimMapFileOptions& options)
+{
+  int width, height;
+  std::vector<float> depthMap;
+  std::vector<float> simMap;
+
+  readImage(depthMapPath, width, height, depthMap, EImageColorSpace::NO_CONVERSION);
+
+  if(!simMapPath.empty())
+  {
+    int simWidth, simHeight;
+    readImage(simMapPath, simWidth, simHeight, simMap, EImageColorSpace::NO_CONVERSION);
+    if(simWidth != width || simHeight != height)
+      throw std::runtime_error("Depth map '" + depthMapPath + "' and sim map '" + simMapPath + "' have different dimensions.");
+  }
+
+  oiio::ParamValueList metadata;
+  readImageMetadata(depthMapPath, metadata);
+
+  writeDepthSimMapFile(outputPath, width, height, depthMap, simMap, options, metadata);
+}
+
+void convertDepthSimMapToEXR(const std::string& inputPath, const std::string& depthMapPath, const std::string& simMapPath)
+{
+  const DepthSimMapFileReader reader(inputPath);
+  const DepthSimMapFileHeader& header = reader.getHeader();
+
+  if(!simMapPath.empty() && !header.hasSimMap)
+    throw std::runtime_error("Depth/sim map file '" + inputPath + "' has no similarity map.");
+
+  std::vector<float> depthMap;
+  std::vector<float> simMap;
+  reader.read(depthMap, simMapPath.empty() ? nullptr : &simMap);
+
+  OutputFileColorSpace colorspace(EImageColorSpace::NO_CONVERSION);
+  writeImage(depthMapPath, header.width, header.height, depthMap, EImageQuality::LOSSLESS, colorspace, reader.getMetadata());
+  if(!simMapPath.empty())
+    writeImage(simMapPath, header.width, header.height, simMap, EImageQuality::OPTIMIZED, colorspace, reader.getMetadata());
+}
+
+} // namespace imageIO
+} // namespace aliceVision
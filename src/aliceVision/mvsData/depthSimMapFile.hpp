@@ -0,0 +1,201 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/imageIO.hpp>
+
+#include <OpenImageIO/paramlist.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace imageIO {
+
+/**
+ * @brief Storage of the values of a depth or similarity channel
+ *
+ * Quantized encodings are relative to the range of the valid values of the channel,
+ * stored in the file header.
+ */
+enum class EDepthMapEncoding
+{
+  FLOAT32 = 0,
+  FLOAT16,
+  UINT16,
+  UINT8
+};
+
+/**
+ * @brief get informations about each depth map encoding
+ * @return String
+ */
+std::string EDepthMapEncoding_informations();
+
+/**
+ * @brief returns the EDepthMapEncoding enum from a string.
+ * @param[in] encoding the input string.
+ * @return the associated EDepthMapEncoding enum.
+ */
+EDepthMapEncoding EDepthMapEncoding_stringToEnum(const std::string& encoding);
+
+/**
+ * @brief converts an EDepthMapEncoding enum to a string.
+ * @param[in] encoding the EDepthMapEncoding enum to convert.
+ * @return the string associated to the EDepthMapEncoding enum.
+ */
+std::string EDepthMapEncoding_enumToString(EDepthMapEncoding encoding);
+
+std::ostream& operator<<(std::ostream& os, EDepthMapEncoding encoding);
+std::istream& operator>>(std::istream& in, EDepthMapEncoding& encoding);
+
+/**
+ * @brief Depth/sim map file writing options
+ */
+struct DepthSimMapFileOptions
+{
+  /// depth channel encoding, quantized relative to the [minDepth, maxDepth] range of the map
+  EDepthMapEncoding depthEncoding = EDepthMapEncoding::UINT16;
+  /// similarity channel encoding, quantized relative to the [minSim, maxSim] range of the map
+  EDepthMapEncoding simEncoding = EDepthMapEncoding::UINT8;
+  /// tile width and height in pixels
+  int tileSize = 64;
+};
+
+/**
+ * @brief Depth/sim map file header, readable without decoding any pixel
+ */
+struct DepthSimMapFileHeader
+{
+  int width = 0;
+  int height = 0;
+  int tileSize = 0;
+  EDepthMapEncoding depthEncoding = EDepthMapEncoding::FLOAT32;
+  EDepthMapEncoding simEncoding = EDepthMapEncoding::FLOAT32;
+  bool hasSimMap = false;
+  /// number of pixels with a valid depth (> 0)
+  std::size_t nbValidPixels = 0;
+  /// range of the valid depths
+  float minDepth = 0.f;
+  float maxDepth = 0.f;
+  /// range of the similarities of the valid pixels
+  float minSim = 0.f;
+  float maxSim = 0.f;
+
+  int getNbTilesX() const { return width / tileSize + (width % tileSize != 0); }
+  int getNbTilesY() const { return height / tileSize + (height % tileSize != 0); }
+};
+
+/**
+ * @brief Write a depth map and its similarity map in the AliceVision depth/sim map file format (.avdm)
+ *
+ * The map is split in square tiles. Each tile stores a validity bitmap, then the depth and
+ * similarity of its valid pixels only: empty tiles take no space and a region can be decoded
+ * without reading the whole file. Pixels with a depth <= 0 are invalid.
+ *
+ * @param[in] path the output file path
+ * @param[in] width the map width
+ * @param[in] height the map height
+ * @param[in] depthMap the depth map (row major)
+ * @param[in] simMap the similarity map (row major), may be empty
+ * @param[in] options the channels encoding and tile size
+ * @param[in] metadata the metadata stored in the file (same as the EXR header)
+ */
+void writeDepthSimMapFile(const std::string& path, int width, int height,
+                          const std::vector<float>& depthMap, const std::vector<float>& simMap,
+                          const DepthSimMapFileOptions& options = DepthSimMapFileOptions(),
+                          const oiio::ParamValueList& metadata = oiio::ParamValueList());
+
+/**
+ * @brief Read the header of a depth/sim map file only
+ * @param[in] path the file path
+ * @return the file header
+ */
+DepthSimMapFileHeader readDepthSimMapFileHeader(const std::string& path);
+
+/**
+ * @brief Memory mapped reader of a depth/sim map file
+ *
+ * The file is mapped once, regions are decoded on demand. Decoding is const and can be
+ * done concurrently from several threads.
+ * Invalid pixels are decoded with a depth of -1 and a similarity of 1.
+ */
+class DepthSimMapFileReader
+{
+public:
+  /**
+   * @brief Map the file and read its header and metadata
+   * @param[in] path the file path
+   */
+  explicit DepthSimMapFileReader(const std::string& path);
+  ~DepthSimMapFileReader();
+
+  DepthSimMapFileReader(const DepthSimMapFileReader&) = delete;
+  DepthSimMapFileReader& operator=(const DepthSimMapFileReader&) = delete;
+
+  const DepthSimMapFileHeader& getHeader() const { return _header; }
+  const oiio::ParamValueList& getMetadata() const { return _metadata; }
+
+  /**
+   * @brief Get the number of valid pixels of a tile
+   * @param[in] tileX the tile column
+   * @param[in] tileY the tile row
+   */
+  std::size_t getTileNbValidPixels(int tileX, int tileY) const;
+
+  /**
+   * @brief Decode the full maps
+   * @param[out] depthMap the depth map (row major)
+   * @param[out] simMap the similarity map (row major), optional
+   */
+  void read(std::vector<float>& depthMap, std::vector<float>* simMap = nullptr) const;
+
+  /**
+   * @brief Decode a region of interest, only the tiles intersecting the region are read
+   * @param[in] x the region left column
+   * @param[in] y the region top row
+   * @param[in] width the region width
+   * @param[in] height the region height
+   * @param[out] depthMap the region depth map (row major, width x height)
+   * @param[out] simMap the region similarity map (row major, width x height), optional
+   */
+  void readRegion(int x, int y, int width, int height, std::vector<float>& depthMap, std::vector<float>* simMap = nullptr) const;
+
+private:
+  struct MappedFile;
+
+  std::unique_ptr<MappedFile> _file;
+  DepthSimMapFileHeader _header;
+  oiio::ParamValueList _metadata;
+  const unsigned char* _data = nullptr;
+  std::size_t _size = 0;
+  std::size_t _tileTableOffset = 0;
+};
+
+/**
+ * @brief Convert EXR depth and similarity maps into a depth/sim map file
+ * @param[in] depthMapPath the input EXR depth map
+ * @param[in] simMapPath the input EXR similarity map, may be empty
+ * @param[in] outputPath the output depth/sim map file
+ * @param[in] options the channels encoding and tile size
+ */
+void convertDepthSimMapFromEXR(const std::string& depthMapPath, const std::string& simMapPath,
+                               const std::string& outputPath, const DepthSimMapFileOptions& options = DepthSimMapFileOptions());
+
+/**
+ * @brief Convert a depth/sim map file into EXR depth and similarity maps, with the same metadata
+ * @param[in] inputPath the input depth/sim map file
+ * @param[in] depthMapPath the output EXR depth map
+ * @param[in] simMapPath the output EXR similarity map, may be empty
+ */
+void convertDepthSimMapToEXR(const std::string& inputPath, const std::string& depthMapPath, const std::string& simMapPath);
+
+} // namespace imageIO
+} // namespace aliceVision
@@ -0,0 +1,242 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsData/depthSimMapFile.hpp>
+
+#define BOOST_TEST_MODULE depthSimMapFile
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::imageIO;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// random depth map with an invalid area, and its similarity map
+void generateDepthSimMap(int width, int height, std::vector<float>& depthMap, std::vector<float>& simMap)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> depth(1.f, 50.f);
+  std::uniform_real_distribution<float> sim(-1.f, 1.f);
+  std::bernoulli_distribution invalid(0.2);
+
+  depthMap.resize(width * height);
+  simMap.resize(width * height);
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const int i = y * width + x;
+      // empty top left corner
+      const bool isValid = (x >= width / 3 || y >= height / 3) && !invalid(generator);
+      depthMap[i] = isValid ? depth(generator) : -1.f;
+      simMap[i] = isValid ? sim(generator) : 1.f;
+    }
+  }
+}
+
+std::vector<char> readFile(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::vector<char>& bytes)
+{
+  std::ofstream file(path, std::ios::binary);
+  file.write(bytes.data(), bytes.size());
+}
+
+/// write the file with a value replaced at the given offset
+template<typename T>
+void writeModifiedFile(const std::string& path, std::vector<char> bytes, std::size_t offset, T value)
+{
+  std::memcpy(bytes.data() + offset, &value, sizeof(T));
+  writeFile(path, bytes);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(depthSimMapFile_losslessRoundTrip)
+{
+  const int width = 301;
+  const int height = 197;
+  std::vector<float> depthMap, simMap;
+  generateDepthSimMap(width, height, depthMap, simMap);
+
+  const double matrixP[16] = {1., 2., 3., 4., 5., 6., 7., 8., 9., 10., 11., 12., 0., 0., 0., 1.};
+  oiio::ParamValueList metadata;
+  metadata.push_back(oiio::ParamValue("AliceVision:downscale", 2));
+  metadata.push_back(oiio::ParamValue("AliceVision:P", oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44), 1, matrixP));
+  metadata.push_back(oiio::ParamValue("AliceVision:comment", "depth map"));
+
+  DepthSimMapFileOptions options;
+  options.depthEncoding = EDepthMapEncoding::FLOAT32;
+  options.simEncoding = EDepthMapEncoding::FLOAT32;
+  options.tileSize = 32;
+
+  const std::string path = (fs::temp_directory_path() / fs::unique_path("%%%%-%%%%.avdm")).string();
+  writeDepthSimMapFile(path, width, height, depthMap, simMap, options, metadata);
+
+  const DepthSimMapFileReader reader(path);
+  const DepthSimMapFileHeader& header = reader.getHeader();
+
+  BOOST_CHECK_EQUAL(header.width, width);
+  BOOST_CHECK_EQUAL(header.height, height);
+  BOOST_CHECK(header.hasSimMap);
+  BOOST_CHECK_EQUAL(header.nbValidPixels, std::count_if(depthMap.begin(), depthMap.end(), [](float d) { return d > 0.f; }));
+  BOOST_CHECK_EQUAL(readDepthSimMapFileHeader(path).nbValidPixels, header.nbValidPixels);
+
+  // the top left corner is empty
+  BOOST_CHECK_EQUAL(reader.getTileNbValidPixels(0, 0), 0);
+  BOOST_CHECK(reader.getTileNbValidPixels(header.getNbTilesX() - 1, header.getNbTilesY() - 1) > 0);
+
+  std::vector<float> readDepthMap, readSimMap;
+  reader.read(readDepthMap, &readSimMap);
+  BOOST_CHECK(readDepthMap == depthMap);
+  BOOST_CHECK(readSimMap == simMap);
+
+  // metadata types are preserved
+  const oiio::ParamValueList& readMetadata = reader.getMetadata();
+  BOOST_CHECK_EQUAL(readMetadata.get_int("AliceVision:downscale"), 2);
+  BOOST_CHECK_EQUAL(readMetadata.get_string("AliceVision:comment"), "depth map");
+  const auto pIt = readMetadata.find("AliceVision:P");
+  BOOST_REQUIRE(pIt != readMetadata.end());
+  BOOST_CHECK(pIt->type() == oiio::TypeDesc(oiio::TypeDesc::DOUBLE, oiio::TypeDesc::MATRIX44));
+  for(int i = 0; i < 16; ++i)
+    BOOST_CHECK_EQUAL(static_cast<const double*>(pIt->data())[i], matrixP[i]);
+
+  fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(depthSimMapFile_quantizedRegion)
+{
+  const int width = 250;
+  const int height = 130;
+  std::vector<float> depthMap, simMap;
+  generateDepthSimMap(width, height, depthMap, simMap);
+
+  DepthSimMapFileOptions options;
+  options.depthEncoding = EDepthMapEncoding::UINT16;
+  options.simEncoding = EDepthMapEncoding::UINT8;
+  options.tileSize = 64;
+
+  const std::string path = (fs::temp_directory_path() / fs::unique_path("%%%%-%%%%.avdm")).string();
+  writeDepthSimMapFile(path, width, height, depthMap, simMap, options);
+
+  const DepthSimMapFileReader reader(path);
+  const DepthSimMapFileHeader& header = reader.getHeader();
+  const float depthStep = (header.maxDepth - header.minDepth) / 65535.f;
+  const float simStep = (header.maxSim - header.minSim) / 255.f;
+
+  // region overlapping several tiles
+  const int x0 = 50, y0 = 20, w = 151, h = 97;
+  std::vector<float> regionDepthMap, regionSimMap;
+  reader.readRegion(x0, y0, w, h, regionDepthMap, &regionSimMap);
+
+  for(int y = 0; y < h; ++y)
+  {
+    for(int x = 0; x < w; ++x)
+    {
+      const int i = (y0 + y) * width + x0 + x;
+      const int j = y * w + x;
+      if(depthMap[i] > 0.f)
+      {
+        BOOST_CHECK_SMALL(regionDepthMap[j] - depthMap[i], 0.51f * depthStep + 1e-5f);
+        BOOST_CHECK_SMALL(regionSimMap[j] - simMap[i], 0.51f * simStep + 1e-5f);
+      }
+      else
+      {
+        BOOST_CHECK_EQUAL(regionDepthMap[j], -1.f);
+      }
+    }
+  }
+
+  BOOST_CHECK_THROW(reader.readRegion(200, 0, 51, 10, regionDepthMap), std::out_of_range);
+
+  // compact file: less than 3 bytes per valid pixel, plus the validity bitmap
+  BOOST_CHECK(fs::file_size(path) < header.nbValidPixels * 3 + width * height / 8 + 1024);
+
+  fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(depthSimMapFile_invalidFile)
+{
+  const int width = 40;
+  const int height = 30;
+  std::vector<float> depthMap(width * height, 2.f);
+  std::vector<float> simMap(width * height, 0.5f);
+  depthMap[3] = -1.f;
+
+  DepthSimMapFileOptions options;
+  options.depthEncoding = EDepthMapEncoding::FLOAT32;
+  options.simEncoding = EDepthMapEncoding::FLOAT32;
+  options.tileSize = 16;
+
+  const std::string path = (fs::temp_directory_path() / fs::unique_path("%%%%-%%%%.avdm")).string();
+  writeDepthSimMapFile(path, width, height, depthMap, simMap, options);
+  const std::vector<char> bytes = readFile(path);
+
+  // header: magic, version, width, height, tile size, ..., size of the metadata block at the end of the 56 bytes
+  const std::size_t widthOffset = 8;
+  const std::size_t heightOffset = 12;
+  const std::size_t tileSizeOffset = 16;
+  std::uint64_t metadataSize;
+  std::memcpy(&metadataSize, bytes.data() + 48, sizeof(metadataSize));
+
+  // negative or overflowing dimensions and tile sizes
+  const std::vector<std::pair<std::size_t, std::uint32_t>> invalidHeaders = {
+    {widthOffset, 0}, {widthOffset, 0x80000000}, {heightOffset, 0xFFFFFFFF},
+    {tileSizeOffset, 0}, {tileSizeOffset, 0x80000000}};
+  for(const auto& invalidHeader : invalidHeaders)
+  {
+    writeModifiedFile(path, bytes, invalidHeader.first, invalidHeader.second);
+    BOOST_CHECK_THROW(readDepthSimMapFileHeader(path), std::runtime_error);
+    BOOST_CHECK_THROW(DepthSimMapFileReader reader(path), std::runtime_error);
+  }
+
+  // too many tiles, and too many pixels in a tile
+  const std::uint32_t largeSize = 100000;
+  std::vector<char> largeBytes = bytes;
+  std::memcpy(largeBytes.data() + widthOffset, &largeSize, sizeof(largeSize));
+  std::memcpy(largeBytes.data() + heightOffset, &largeSize, sizeof(largeSize));
+  writeModifiedFile(path, largeBytes, tileSizeOffset, std::uint32_t(1));
+  BOOST_CHECK_THROW(DepthSimMapFileReader reader(path), std::runtime_error);
+  writeModifiedFile(path, largeBytes, tileSizeOffset, largeSize);
+  BOOST_CHECK_THROW(DepthSimMapFileReader reader(path), std::runtime_error);
+
+  // number of valid pixels of the first tile, after its offset in the tile table
+  const std::size_t nbValidOffset = 56 + metadataSize + sizeof(std::uint64_t);
+  std::uint32_t nbValid;
+  std::memcpy(&nbValid, bytes.data() + nbValidOffset, sizeof(nbValid));
+  BOOST_REQUIRE_EQUAL(nbValid, 16 * 16 - 1);
+
+  std::vector<float> readDepthMap;
+  for(const std::uint32_t invalidNbValid : {nbValid - 1, nbValid + 1})
+  {
+    writeModifiedFile(path, bytes, nbValidOffset, invalidNbValid);
+    const DepthSimMapFileReader reader(path);
+    BOOST_CHECK_THROW(reader.read(readDepthMap), std::runtime_error);
+    // the other tiles can still be read
+    reader.readRegion(16, 16, 24, 14, readDepthMap);
+  }
+
+  writeFile(path, bytes);
+  DepthSimMapFileReader(path).read(readDepthMap);
+  BOOST_CHECK(readDepthMap == depthMap);
+
+  fs::remove(path);
+}
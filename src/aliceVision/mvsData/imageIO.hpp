@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include <OpenImageIO/paramlist.h>
 
@@ -0,0 +1,203 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DepthSimMapsCache.hpp"
+#include <aliceVision/mvsData/imageIO.hpp>
+#include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+DepthSimMapsCache::DepthSimMapsCache(const MultiViewParams* mp, std::size_t maxBytes)
+    : _mp(mp)
+    , _maxBytes(maxBytes)
+{}
+
+DepthSimMapsCache::~DepthSimMapsCache()
+{
+    ALICEVISION_LOG_INFO("Depth/sim maps cache: " << _hits << " hits, " << _misses << " misses, "
+                         << _usedBytes / (1024 * 1024) << " MB used on " << _maxBytes / (1024 * 1024) << " MB.");
+}
+
+std::size_t DepthSimMapsCache::getDefaultMaxMemory(const MultiViewParams* mp)
+{
+    const std::size_t maxmbCPU = mp->userParams.get<int>("depthSimMapsCache.maxmbCPU", 4000);
+    return std::min(maxmbCPU * 1024 * 1024, system::MemoryBudget::get().getMaxMemory());
+}
+
+bool DepthSimMapsCache::publish(int rc, int scale, MapsSharedPtr maps)
+{
+    const Key key(rc, scale);
+    const std::size_t bytes = maps->getBytes();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // maps previously read from disk are outdated
+        auto it = _entries.find(key);
+        if(it != _entries.end() && it->second.maps != nullptr)
+            eraseLocked(it);
+
+        evictLocked(bytes);
+        if(_usedBytes + bytes > _maxBytes)
+            return false;
+
+        // a reader may be loading the outdated maps: it is given the new ones
+        Entry& entry = _entries[key];
+        entry.maps = maps;
+        entry.published = true;
+        entry.lruIt = _lru.end();
+        _usedBytes += bytes;
+        _memoryReservation.grow(bytes);
+    }
+    _loaded.notify_all();
+    return true;
+}
+
+DepthSimMapsCache::MapsSharedPtr DepthSimMapsCache::get(int rc, int scale, bool withSimMap)
+{
+    const Key key(rc, scale);
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for(;;)
+        {
+            auto it = _entries.find(key);
+            if(it == _entries.end())
+                break;
+            Entry& entry = it->second;
+            if(entry.maps == nullptr)
+            {
+                // another thread is loading the same maps
+                _loaded.wait(lock);
+                continue;
+            }
+            if(withSimMap && entry.maps->simMap.empty() && !entry.published)
+            {
+                // only the depth map has been read, read both maps again
+                eraseLocked(it);
+                break;
+            }
+            if(!entry.published)
+                _lru.splice(_lru.begin(), _lru, entry.lruIt);
+            ++_hits;
+            return entry.maps;
+        }
+        // placeholder until the maps are loaded, only removed by this thread
+        _entries[key].lruIt = _lru.end();
+    }
+    ++_misses;
+
+    MapsSharedPtr maps;
+    try
+    {
+        maps = load(rc, scale, withSimMap);
+    }
+    catch(...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find(key);
+            if(it != _entries.end() && it->second.maps == nullptr)
+                _entries.erase(it);
+        }
+        _loaded.notify_all();
+        throw;
+    }
+
+    const std::size_t bytes = maps->getBytes();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(key);
+        if(it->second.maps != nullptr)
+        {
+            // the maps have been published while loading
+            maps = it->second.maps;
+        }
+        else
+        {
+            evictLocked(bytes);
+            if(_usedBytes + bytes <= _maxBytes)
+            {
+                Entry& entry = it->second;
+                entry.maps = maps;
+                _lru.push_front(key);
+                entry.lruIt = _lru.begin();
+                _usedBytes += bytes;
+                _memoryReservation.grow(bytes);
+            }
+            else
+            {
+                // no room left: the caller is the only owner of the maps
+                _entries.erase(it);
+            }
+        }
+    }
+    _loaded.notify_all();
+    return maps;
+}
+
+bool DepthSimMapsCache::isPublished(int rc, int scale) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _entries.find(Key(rc, scale));
+    return it != _entries.end() && it->second.published;
+}
+
+std::size_t DepthSimMapsCache::getUsedMemory() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _usedBytes;
+}
+
+DepthSimMapsCache::MapsSharedPtr DepthSimMapsCache::load(int rc, int scale, bool withSimMap) const
+{
+    std::shared_ptr<DepthSimMaps> maps = std::make_shared<DepthSimMaps>();
+
+    imageIO::readImage(getFileNameFromIndex(_mp, rc, EFileType::depthMap, scale), maps->width, maps->height, maps->depthMap, imageIO::EImageColorSpace::NO_CONVERSION);
+    if(withSimMap)
+    {
+        int width, height;
+        imageIO::readImage(getFileNameFromIndex(_mp, rc, EFileType::simMap, scale), width, height, maps->simMap, imageIO::EImageColorSpace::NO_CONVERSION);
+        if(width != maps->width || height != maps->height)
+            throw std::runtime_error("Depth and sim maps of camera " + std::to_string(_mp->getViewId(rc)) + " have different dimensions.");
+    }
+    return maps;
+}
+
+void DepthSimMapsCache::evictLocked(std::size_t bytesToAdd)
+{
+    auto lruIt = _lru.end();
+    while(_usedBytes + bytesToAdd > _maxBytes && lruIt != _lru.begin())
+    {
+        --lruIt;
+        auto it = _entries.find(*lruIt);
+        // the maps are pinned if a caller still holds them
+        if(it->second.maps.use_count() > 1)
+            continue;
+        // the list iterator is invalidated by the removal
+        lruIt = std::next(lruIt);
+        eraseLocked(it);
+    }
+}
+
+void DepthSimMapsCache::eraseLocked(std::map<Key, Entry>::iterator it)
+{
+    Entry& entry = it->second;
+    if(entry.maps != nullptr)
+    {
+        _usedBytes -= entry.maps->getBytes();
+        _memoryReservation.shrink(entry.maps->getBytes());
+    }
+    if(entry.lruIt != _lru.end())
+        _lru.erase(entry.lruIt);
+    _entries.erase(it);
+}
+
+} // namespace mvsUtils
+} // namespace aliceVision
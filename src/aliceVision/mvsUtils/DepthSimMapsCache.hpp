@@ -0,0 +1,131 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+/**
+ * @brief Thread-safe in-memory store of depth and similarity maps, limited by a memory budget in bytes.
+ *
+ * The depth map estimation publishes its results in the store, so that the filtering running in the
+ * same process reads them without a round trip through the disk. Published maps are never evicted,
+ * the maps that do not fit in the budget are not published and have to be written to disk by the caller.
+ * The other maps are read from the depth maps files on request and kept in least recently used order
+ * within the remaining budget, so that the maps of neighbor cameras are decoded once.
+ */
+class DepthSimMapsCache
+{
+public:
+    /**
+     * @brief Depth and similarity maps of a camera (row major)
+     */
+    struct DepthSimMaps
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<float> depthMap;
+        /// may be empty if the similarity has not been requested
+        std::vector<float> simMap;
+
+        std::size_t getBytes() const { return (depthMap.size() + simMap.size()) * sizeof(float); }
+    };
+
+    typedef std::shared_ptr<const DepthSimMaps> MapsSharedPtr;
+
+    /**
+     * @param[in] mp the multi-view parameters, to find the depth maps files
+     * @param[in] maxBytes the memory budget in bytes
+     */
+    DepthSimMapsCache(const MultiViewParams* mp, std::size_t maxBytes);
+    ~DepthSimMapsCache();
+
+    DepthSimMapsCache(const DepthSimMapsCache&) = delete;
+    DepthSimMapsCache& operator=(const DepthSimMapsCache&) = delete;
+
+    /**
+     * @brief Default memory budget: the "depthSimMapsCache.maxmbCPU" user parameter (4000 MB by default),
+     * limited by the process memory budget
+     */
+    static std::size_t getDefaultMaxMemory(const MultiViewParams* mp);
+
+    /**
+     * @brief Keep maps computed in this process in memory, they are never evicted.
+     * @param[in] rc the camera index
+     * @param[in] scale the maps scale, as in getFileNameFromIndex
+     * @param[in] maps the depth and similarity maps
+     * @return false if the maps do not fit in the budget: they are not kept and have to be written to disk
+     */
+    bool publish(int rc, int scale, MapsSharedPtr maps);
+
+    /**
+     * @brief Get the maps of a camera, read them from the depth maps files if they are not in memory.
+     * @param[in] rc the camera index
+     * @param[in] scale the maps scale, as in getFileNameFromIndex
+     * @param[in] withSimMap false if only the depth map is needed
+     * @return the maps, valid as long as the returned pointer is alive
+     */
+    MapsSharedPtr get(int rc, int scale, bool withSimMap = true);
+
+    /// @return true if the maps of the camera have been published in this process
+    bool isPublished(int rc, int scale) const;
+
+    std::size_t getMaxMemory() const { return _maxBytes; }
+    std::size_t getUsedMemory() const;
+
+private:
+    typedef std::pair<int, int> Key;
+
+    struct Entry
+    {
+        /// nullptr while the maps are loading
+        MapsSharedPtr maps;
+        bool published = false;
+        /// position in the least recently used list, for the maps read from disk
+        std::list<Key>::iterator lruIt;
+    };
+
+    /// read the maps from the depth maps files
+    MapsSharedPtr load(int rc, int scale, bool withSimMap) const;
+
+    /// remove the least recently used maps read from disk until bytesToAdd fit in the budget, with the lock held
+    void evictLocked(std::size_t bytesToAdd);
+
+    /// remove an entry and its memory, with the lock held
+    void eraseLocked(std::map<Key, Entry>::iterator it);
+
+    const MultiViewParams* _mp;
+    const std::size_t _maxBytes;
+
+    mutable std::mutex _mutex;
+    /// notified when maps have been loaded (or failed to load)
+    std::condition_variable _loaded;
+    std::map<Key, Entry> _entries;
+    /// maps read from disk, from the most to the least recently used
+    std::list<Key> _lru;
+    std::size_t _usedBytes = 0;
+    /// memory used by the maps, accounted in the process memory budget
+    system::MemoryReservation _memoryReservation{"depthSimMapsCache"};
+
+    std::atomic<std::size_t> _hits{0};
+    std::atomic<std::size_t> _misses{0};
+};
+
+} // namespace mvsUtils
+} // namespace aliceVision
@@ -8,7 +8,8 @@
 #include <aliceVision/mvsUtils/common.hpp>
 #include <aliceVision/mvsUtils/fileIO.hpp>
 
-#include <future>
+#include <algorithm>
+#include <limits>
 
 namespace aliceVision {
 namespace mvsUtils {
@@ -47,93 +48,267 @@ ImagesCache::ImagesCache(const MultiViewParams* mp, imageIO::EImageColorSpace co
     initIC( imagesNames );
 }
 
+ImagesCache::~ImagesCache()
+{
+    if(_prefetchQueue)
+        _prefetchQueue->close();
+    for(std::thread& thread : _prefetchThreads)
+        thread.join();
+
+    logStats();
+}
+
 void ImagesCache::initIC( std::vector<std::string>& imagesNames )
 {
-    float oneimagemb = (sizeof(Color) * _mp->getMaxImageWidth() * _mp->getMaxImageHeight()) / 1024.f / 1024.f;
-    float maxmbCPU = (float)_mp->userParams.get<int>("images_cache.maxmbCPU", 5000);
-    int npreload = std::max((int)(maxmbCPU / oneimagemb), 5); // image cache has a minimum size of 5
-    npreload = std::min(_mp->ncams, npreload);
+    const std::size_t oneImageBytes = sizeof(Color) * std::size_t(_mp->getMaxImageWidth()) * _mp->getMaxImageHeight();
+    const std::size_t maxmbCPU = _mp->userParams.get<int>("images_cache.maxmbCPU", 5000);
+    const int nbShards = std::max(1, _mp->userParams.get<int>("images_cache.nbShards", 16));
+    _nbPrefetchThreads = _mp->userParams.get<int>("images_cache.nbPrefetchThreads", 2);
+
+    // image cache is limited by the process memory budget, with a minimum size of 5 images
+    _maxBytes = std::max(std::min(maxmbCPU * 1024 * 1024, system::MemoryBudget::get().getMaxMemory()), 5 * oneImageBytes);
 
     for(int rc = 0; rc < _mp->ncams; rc++)
     {
         _imagesNames.push_back(imagesNames[rc]);
     }
 
-    _camIdMapId.resize( _mp->ncams, -1 );
-    setCacheSize(npreload);
-
-    {
-        // Cannot resize the vector<mutex> directly, as mutex class is not move-constructible.
-        // imagesMutexes.resize(mp->ncams); // cannot compile
-        // So, we do the same with a new vector and swap.
-        std::vector<std::mutex> imagesMutexesTmp(_mp->ncams);
-        _imagesMutexes.swap(imagesMutexesTmp);
-    }
+    for(int i = 0; i < nbShards; ++i)
+        _shards.emplace_back(new Shard());
+}
 
+void ImagesCache::setCacheSize(int nbPreload)
+{
+    const std::size_t oneImageBytes = sizeof(Color) * std::size_t(_mp->getMaxImageWidth()) * _mp->getMaxImageHeight();
+    setMaxMemory(std::max(nbPreload, 1) * oneImageBytes);
+}
 
+void ImagesCache::setMaxMemory(std::size_t maxBytes)
+{
+    _maxBytes = maxBytes;
+    evict(0);
 }
 
-void ImagesCache::setCacheSize(int nbPreload)
+std::size_t ImagesCache::estimateImageBytes(int camId) const
 {
-    _N_PRELOADED_IMAGES = nbPreload;
-    _imgs.resize(_N_PRELOADED_IMAGES);
-    _mapIdCamId.resize( _N_PRELOADED_IMAGES, -1 );
-    _mapIdClock.resize( _N_PRELOADED_IMAGES, clock() );
+    const int processScale = std::max(1, _mp->getProcessDownscale());
+    return sizeof(Color) * std::size_t(_mp->getOriginalWidth(camId) / processScale) * (_mp->getOriginalHeight(camId) / processScale);
 }
 
-void ImagesCache::refreshData(int camId)
+ImagesCache::ImgSharedPtr ImagesCache::getImg(int camId, bool prefetch)
 {
-    // printf("camId %i\n",camId);
-    // test if the image is in the memory
-    if(_camIdMapId[camId] == -1)
+    Shard& shard = getShard(camId);
     {
-        // remove the oldest one
-        int mapId = _mapIdClock.minValId();
-        int oldCamId = _mapIdCamId[mapId];
-        if(oldCamId>=0)
-            _camIdMapId[oldCamId] = -1;
-            // TODO: oldCamId should be protected if already used
-
-        // replace with new new
-        _camIdMapId[camId] = mapId;
-        _mapIdCamId[mapId] = camId;
-        _mapIdClock[mapId] = clock();
-
-        // reload data from files
-        long t1 = clock();
-        if (_imgs[mapId] == nullptr)
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        while(true)
         {
-            const int maxWidth = _mp->getMaxImageWidth();
-            const int maxHeight = _mp->getMaxImageHeight();
-            _imgs[mapId] = std::make_shared<Image>(maxWidth, maxHeight);
-        }
+            auto it = shard.entries.find(camId);
+            if(it == shard.entries.end())
+                break;
+
+            Entry& entry = it->second;
+            if(entry.img == nullptr)
+            {
+                // the image is being loaded by another thread
+                shard.loaded.wait(lock);
+                continue;
+            }
 
-        const std::string imagePath = _imagesNames.at(camId);
-        loadImage(imagePath, _mp, camId, *(_imgs[mapId]), _colorspace, _correctEV);
+            if(!prefetch)
+            {
+                ++_hits;
+                // move to the front of the least recently used list
+                entry.accessTime = ++_accessClock;
+                shard.lru.splice(shard.lru.begin(), shard.lru, entry.lruIt);
+                ALICEVISION_LOG_DEBUG("Reuse " << _imagesNames.at(camId) << " from image cache. ");
+            }
+            return entry.img;
+        }
 
-        ALICEVISION_LOG_DEBUG("Add " << imagePath << " to image cache. " << formatElapsedTime(t1));
+        // reserve the entry, the other threads requesting this image wait for it
+        shard.entries[camId];
     }
+
+    if(prefetch)
+        ++_prefetches;
     else
+        ++_misses;
+
+    // make room before loading to stay within the budget
+    evict(estimateImageBytes(camId));
+
+    // load in a new image, the evicted ones may still be used by other threads
+    ImgSharedPtr img = std::make_shared<Image>();
+    const std::string imagePath = _imagesNames.at(camId);
+    long t1 = clock();
+    try
+    {
+        loadImage(imagePath, _mp, camId, *img, _colorspace, _correctEV);
+    }
+    catch(...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.erase(camId);
+        }
+        shard.loaded.notify_all();
+        throw;
+    }
+
+    const std::size_t bytes = sizeof(Color) * std::size_t(img->width()) * img->height();
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry& entry = shard.entries.at(camId);
+        entry.img = img;
+        entry.bytes = bytes;
+        entry.accessTime = ++_accessClock;
+        shard.lru.push_front(camId);
+        entry.lruIt = shard.lru.begin();
+        _usedBytes += bytes;
+        _memoryReservation.grow(bytes);
+    }
+    shard.loaded.notify_all();
+
+    ALICEVISION_LOG_DEBUG((prefetch ? "Prefetch " : "Add ") << imagePath << " to image cache. " << formatElapsedTime(t1));
+    return img;
+}
+
+void ImagesCache::evict(std::size_t bytesToAdd)
+{
+    std::lock_guard<std::mutex> evictionLock(_evictionMutex);
+
+    while(_usedBytes + bytesToAdd > _maxBytes)
     {
-      ALICEVISION_LOG_DEBUG("Reuse " << _imagesNames.at(camId) << " from image cache. ");
+        // find the least recently used image not pinned, over all the shards
+        Shard* oldestShard = nullptr;
+        int oldestCamId = -1;
+        std::uint64_t oldestAccessTime = std::numeric_limits<std::uint64_t>::max();
+
+        for(const auto& shardPtr : _shards)
+        {
+            Shard& shard = *shardPtr;
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for(auto it = shard.lru.rbegin(); it != shard.lru.rend(); ++it)
+            {
+                const Entry& entry = shard.entries.at(*it);
+                // the image is pinned if a caller still holds it
+                if(entry.img.use_count() > 1)
+                    continue;
+                if(entry.accessTime < oldestAccessTime)
+                {
+                    oldestShard = &shard;
+                    oldestCamId = *it;
+                    oldestAccessTime = entry.accessTime;
+                }
+                break;
+            }
+        }
+
+        if(oldestShard == nullptr)
+        {
+            ALICEVISION_LOG_DEBUG("Image cache budget exceeded by pinned images.");
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(oldestShard->mutex);
+        auto it = oldestShard->entries.find(oldestCamId);
+        // the image may have been pinned since the search
+        if(it == oldestShard->entries.end() || it->second.img.use_count() > 1)
+            continue;
+
+        _usedBytes -= it->second.bytes;
+        _memoryReservation.shrink(it->second.bytes);
+        oldestShard->lru.erase(it->second.lruIt);
+        oldestShard->entries.erase(it);
+        ++_evictions;
+        ALICEVISION_LOG_DEBUG("Remove " << _imagesNames.at(oldestCamId) << " from image cache.");
     }
 }
+
 void ImagesCache::refreshData_sync(int camId)
 {
-  std::lock_guard<std::mutex> lock(_imagesMutexes[camId]);
-  refreshData(camId);
+    getImg(camId, false);
+}
+
+void ImagesCache::startPrefetchThreads()
+{
+    const int nbThreads = std::max(1, _nbPrefetchThreads);
+    _prefetchQueue.reset(new system::BoundedQueue<int>(std::max(1, _mp->userParams.get<int>("images_cache.prefetchQueueSize", 32))));
+
+    for(int i = 0; i < nbThreads; ++i)
+    {
+        _prefetchThreads.emplace_back([this]()
+        {
+            int camId;
+            while(_prefetchQueue->pop(camId))
+            {
+                try
+                {
+                    getImg(camId, true);
+                }
+                catch(const std::exception& e)
+                {
+                    // the error is raised again when the image is requested
+                    ALICEVISION_LOG_WARNING("Cannot prefetch image " << _imagesNames.at(camId) << ": " << e.what());
+                }
+            }
+        });
+    }
+}
+
+void ImagesCache::prefetch(int camId)
+{
+    if(_nbPrefetchThreads <= 0)
+        return;
+
+    std::call_once(_prefetchThreadsStarted, &ImagesCache::startPrefetchThreads, this);
+
+    {
+        // nothing to do if the image is already cached or loading
+        Shard& shard = getShard(camId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if(shard.entries.count(camId))
+            return;
+    }
+
+    if(!_prefetchQueue->tryPush(camId))
+        ++_droppedPrefetches;
+}
+
+void ImagesCache::prefetch(const std::vector<int>& camIds)
+{
+    for(int camId : camIds)
+        prefetch(camId);
+}
+
+ImagesCache::Stats ImagesCache::getStats() const
+{
+    Stats stats;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    stats.evictions = _evictions;
+    stats.prefetches = _prefetches;
+    stats.droppedPrefetches = _droppedPrefetches;
+    stats.usedBytes = _usedBytes;
+    stats.maxBytes = _maxBytes;
+    return stats;
 }
 
-std::future<void> ImagesCache::refreshData_async(int camId)
+void ImagesCache::logStats() const
 {
-    return std::async(&ImagesCache::refreshData_sync, this, camId);
+    const Stats stats = getStats();
+    ALICEVISION_LOG_DEBUG("Image cache:" << std::endl
+                          << "\t- hits: " << stats.hits << std::endl
+                          << "\t- misses: " << stats.misses << std::endl
+                          << "\t- evictions: " << stats.evictions << std::endl
+                          << "\t- prefetches: " << stats.prefetches << " (dropped: " << stats.droppedPrefetches << ")" << std::endl
+                          << "\t- memory: " << stats.usedBytes / (1024 * 1024) << " / " << stats.maxBytes / (1024 * 1024) << " MB");
 }
 
 Color ImagesCache::getPixelValueInterpolated(const Point2d* pix, int camId)
 {
-    // get the image index in the memory
-    const int i = _camIdMapId[camId];
-    const ImgSharedPtr& img = _imgs[i];
+    // get the image from the cache, pinned during the interpolation
+    const ImgSharedPtr img = getImg_sync(camId);
     
     const int xp = static_cast<int>(pix->x);
     const int yp = static_cast<int>(pix->y);
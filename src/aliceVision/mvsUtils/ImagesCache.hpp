@@ -13,13 +13,33 @@
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/mvsData/imageIO.hpp>
 #include <aliceVision/mvsData/Image.hpp>
-
-#include <future>
+#include <aliceVision/system/BoundedQueue.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 namespace aliceVision {
 namespace mvsUtils {
 
+/**
+ * @brief Thread-safe cache of the input images, limited by a memory budget in bytes.
+ *
+ * The images are evicted in least recently used order when the budget is exceeded.
+ * An image returned by getImg_sync is pinned as long as the returned shared pointer
+ * is alive: it is never evicted nor overwritten while a caller is using it.
+ * The cached images are split in shards with their own lock, so that threads loading
+ * or reading different images do not wait for each other.
+ * Images expected to be used soon can be loaded in advance by a small pool of prefetch
+ * threads, with prefetch().
+ */
 class ImagesCache
 {
 public:
@@ -34,43 +54,163 @@ public:
 
     typedef std::shared_ptr<Image> ImgSharedPtr;
 
+    /**
+     * @brief Cache usage counters, since the creation of the cache
+     */
+    struct Stats
+    {
+        /// number of images found in the cache
+        std::size_t hits = 0;
+        /// number of images loaded on request
+        std::size_t misses = 0;
+        /// number of images removed from the cache
+        std::size_t evictions = 0;
+        /// number of images loaded by the prefetch threads
+        std::size_t prefetches = 0;
+        /// number of prefetch requests dropped because the prefetch queue was full
+        std::size_t droppedPrefetches = 0;
+        /// memory used by the cached images in bytes
+        std::size_t usedBytes = 0;
+        /// memory budget in bytes
+        std::size_t maxBytes = 0;
+    };
+
 private:
     ImagesCache(const ImagesCache&) = delete;
 
-    const MultiViewParams* _mp;
+    /**
+     * @brief Cached image of a camera
+     */
+    struct Entry
+    {
+        /// nullptr while the image is loading
+        ImgSharedPtr img;
+        /// memory used by the image in bytes
+        std::size_t bytes = 0;
+        /// logical time of the last access
+        std::uint64_t accessTime = 0;
+        /// position in the shard least recently used list
+        std::list<int>::iterator lruIt;
+    };
 
-    int _N_PRELOADED_IMAGES;
-    std::vector<ImgSharedPtr> _imgs;
+    /**
+     * @brief Part of the cache with its own lock, cameras are spread over the shards
+     */
+    struct Shard
+    {
+        std::mutex mutex;
+        /// notified when an image has been loaded (or failed to load)
+        std::condition_variable loaded;
+        std::map<int, Entry> entries;
+        /// loaded camera ids, from the most to the least recently used
+        std::list<int> lru;
+    };
 
-    std::vector<int> _camIdMapId;
-    std::vector<int> _mapIdCamId;
-    StaticVector<long> _mapIdClock;
+    const MultiViewParams* _mp;
 
-    std::vector<std::mutex> _imagesMutexes;
     std::vector<std::string> _imagesNames;
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    /// memory budget in bytes
+    std::atomic<std::size_t> _maxBytes{0};
+    /// memory used by the cached images in bytes
+    std::atomic<std::size_t> _usedBytes{0};
+    /// memory used by the cached images, accounted in the process memory budget
+    system::MemoryReservation _memoryReservation{"imagesCache"};
+    /// logical clock for the least recently used order between shards
+    std::atomic<std::uint64_t> _accessClock{0};
+    /// serialize the evictions, which look at all the shards
+    std::mutex _evictionMutex;
+
+    std::atomic<std::size_t> _hits{0};
+    std::atomic<std::size_t> _misses{0};
+    std::atomic<std::size_t> _evictions{0};
+    std::atomic<std::size_t> _prefetches{0};
+    std::atomic<std::size_t> _droppedPrefetches{0};
+
+    /// camera ids to prefetch, the threads are started on the first request
+    std::unique_ptr<system::BoundedQueue<int>> _prefetchQueue;
+    std::vector<std::thread> _prefetchThreads;
+    std::once_flag _prefetchThreadsStarted;
+    int _nbPrefetchThreads = 2;
 
     imageIO::EImageColorSpace _colorspace{imageIO::EImageColorSpace::AUTO};
     ECorrectEV _correctEV{ECorrectEV::NO_CORRECTION};
 
+    Shard& getShard(int camId) { return *_shards[camId % _shards.size()]; }
+
+    /**
+     * @brief Get the image from the cache or load it
+     * @param[in] camId the camera index
+     * @param[in] prefetch true if called by a prefetch thread, only for the counters
+     */
+    ImgSharedPtr getImg(int camId, bool prefetch);
+
+    /**
+     * @brief Remove the least recently used images not pinned, until the given number of bytes
+     * can be added within the budget.
+     */
+    void evict(std::size_t bytesToAdd);
+
+    /// expected memory size of an image once loaded
+    std::size_t estimateImageBytes(int camId) const;
+
+    void startPrefetchThreads();
+
 public:
     ImagesCache( const MultiViewParams* mp, imageIO::EImageColorSpace colorspace, ECorrectEV correctEV = ECorrectEV::NO_CORRECTION);
     ImagesCache( const MultiViewParams* mp, imageIO::EImageColorSpace colorspace, std::vector<std::string>& imagesNames, ECorrectEV correctEV = ECorrectEV::NO_CORRECTION);
     void initIC( std::vector<std::string>& imagesNames );
+    ~ImagesCache();
+
+    /**
+     * @brief Set the memory budget as a number of images of the maximum resolution
+     * @param[in] nbPreload the number of images
+     */
     void setCacheSize(int nbPreload);
+
+    /**
+     * @brief Set the memory budget in bytes, pinned images may exceed it
+     * @param[in] maxBytes the memory budget in bytes
+     */
+    void setMaxMemory(std::size_t maxBytes);
+    std::size_t getMaxMemory() const { return _maxBytes; }
+
     void setCorrectEV(const ECorrectEV correctEV) { _correctEV = correctEV; }
-    ~ImagesCache() = default;
 
+    /**
+     * @brief Get an image, load it if needed.
+     * @param[in] camId the camera index
+     * @return the image, pinned in the cache while the returned pointer is alive
+     */
     inline ImgSharedPtr getImg_sync( int camId )
     {
-        refreshData_sync(camId);
-        const int imageId = _camIdMapId[camId];
-        return _imgs[imageId];
+        return getImg(camId, false);
     }
 
-    void refreshData(int camId);
+    /**
+     * @brief Load an image in the cache if needed.
+     * @param[in] camId the camera index
+     */
     void refreshData_sync(int camId);
 
-    std::future<void> refreshData_async(int camId);
+    /**
+     * @brief Hint that an image will be used soon, it is loaded in the background by
+     * the prefetch threads. The hint is dropped if too many are already waiting.
+     * @param[in] camId the camera index
+     */
+    void prefetch(int camId);
+
+    /**
+     * @brief Hint that several images will be used soon, in this order.
+     * @param[in] camIds the camera indexes
+     */
+    void prefetch(const std::vector<int>& camIds);
+
+    Stats getStats() const;
+
+    /// log the cache usage counters
+    void logStats() const;
 
     Color getPixelValueInterpolated(const Point2d* pix, int camId);
 };
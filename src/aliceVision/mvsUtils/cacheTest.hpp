@@ -0,0 +1,93 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/imageIO.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace mvsUtils {
+
+/// scene shared by the images and depth/sim maps caches tests
+namespace cacheTest {
+
+const int nbCameras = 6;
+const int width = 16;
+const int height = 12;
+const std::size_t nbPixels = width * height;
+
+/// value of the files of a camera
+inline float getCameraValue(int camId)
+{
+    return camId + 1.f;
+}
+
+/// true if the nbPixels values getValue(i) are all equal to value
+template <typename GetValue>
+bool isFilledWith(float value, GetValue getValue)
+{
+    for(std::size_t i = 0; i < nbPixels; ++i)
+    {
+        if(std::abs(getValue(i) - value) > 1e-4f)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Pinhole cameras of width x height pixels, the camera i at (i, 0, 0), with their
+ * images in a temporary folder. The images are not written, the folder is removed at
+ * the end of the test.
+ */
+struct Scene
+{
+    boost::filesystem::path folder;
+    sfmData::SfMData sfmData;
+
+    /// @param[in] name The prefix of the temporary folder
+    explicit Scene(const std::string& name)
+    {
+        folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path(name + "_%%%%-%%%%");
+        boost::filesystem::create_directories(folder);
+
+        sfmData.intrinsics[0] = std::make_shared<camera::Pinhole>(width, height, 20.0, width / 2.0, height / 2.0);
+        for(int i = 0; i < nbCameras; ++i)
+        {
+            sfmData.views[i] = std::make_shared<sfmData::View>((folder / (std::to_string(i) + ".exr")).string(), i, 0, i, width, height);
+            sfmData.setPose(*sfmData.views[i], sfmData::CameraPose(geometry::Pose3(Mat3::Identity(), Vec3(i, 0.0, 0.0))));
+        }
+    }
+
+    ~Scene()
+    {
+        boost::filesystem::remove_all(folder);
+    }
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    /// write a lossless image of width x height pixels
+    template <typename T>
+    static void writeImage(const std::string& path, const std::vector<T>& buffer)
+    {
+        imageIO::OutputFileColorSpace colorspace(imageIO::EImageColorSpace::NO_CONVERSION);
+        imageIO::writeImage(path, width, height, buffer, imageIO::EImageQuality::LOSSLESS, colorspace);
+    }
+};
+
+} // namespace cacheTest
+} // namespace mvsUtils
+} // namespace aliceVision
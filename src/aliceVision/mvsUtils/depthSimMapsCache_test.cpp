@@ -0,0 +1,298 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsUtils/DepthSimMapsCache.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/fileIO.hpp>
+#include <aliceVision/mvsUtils/cacheTest.hpp>
+
+#define BOOST_TEST_MODULE depthSimMapsCache
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::mvsUtils;
+using namespace aliceVision::mvsUtils::cacheTest;
+
+namespace {
+
+typedef DepthSimMapsCache::DepthSimMaps DepthSimMaps;
+typedef DepthSimMapsCache::MapsSharedPtr MapsSharedPtr;
+
+/// the last camera has no depth maps files
+const int nbCamerasOnDisk = nbCameras - 1;
+const int scale = 1;
+const std::size_t mapBytes = sizeof(float) * nbPixels;
+const std::size_t mapsBytes = 2 * mapBytes;
+
+/**
+ * @brief Depth maps files of the cameras, the depth map filled with the value of the camera
+ * and the similarity map with its opposite.
+ */
+struct DepthMapsScene : public Scene
+{
+    std::unique_ptr<MultiViewParams> mp;
+
+    DepthMapsScene()
+        : Scene("depthSimMapsCache")
+    {
+        mp.reset(new MultiViewParams(sfmData, "", folder.string(), folder.string()));
+
+        for(int rc = 0; rc < nbCamerasOnDisk; ++rc)
+        {
+            writeImage(getFileNameFromIndex(mp.get(), rc, EFileType::depthMap, scale), std::vector<float>(nbPixels, getCameraValue(rc)));
+            writeImage(getFileNameFromIndex(mp.get(), rc, EFileType::simMap, scale), std::vector<float>(nbPixels, -getCameraValue(rc)));
+        }
+    }
+};
+
+/// maps computed in the process for a camera, different from the maps on disk
+MapsSharedPtr createMaps(int rc)
+{
+    std::shared_ptr<DepthSimMaps> maps = std::make_shared<DepthSimMaps>();
+    maps->width = width;
+    maps->height = height;
+    maps->depthMap.assign(nbPixels, 100.f + rc);
+    maps->simMap.assign(nbPixels, -(100.f + rc));
+    return maps;
+}
+
+/// true if the maps have the size and the values of the camera, read from disk or computed in the process
+bool isCameraMaps(const DepthSimMaps& maps, int rc, bool computed, bool withSimMap = true)
+{
+    const float depth = computed ? 100.f + rc : getCameraValue(rc);
+    if(maps.width != width || maps.height != height || maps.depthMap.size() != nbPixels)
+        return false;
+    if(!isFilledWith(depth, [&](std::size_t i) { return maps.depthMap[i]; }))
+        return false;
+    if(maps.simMap.empty())
+        return !withSimMap;
+    return maps.simMap.size() == nbPixels && isFilledWith(-depth, [&](std::size_t i) { return maps.simMap[i]; });
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(depthSimMapsCache_publishBeforeGet)
+{
+    DepthMapsScene scene;
+    DepthSimMapsCache cache(scene.mp.get(), 3 * mapsBytes);
+
+    // the published maps are given back without reading the files, even if there is none
+    const MapsSharedPtr maps0 = createMaps(0);
+    const MapsSharedPtr maps5 = createMaps(5);
+    BOOST_CHECK(cache.publish(0, scale, maps0));
+    BOOST_CHECK(cache.publish(5, scale, maps5));
+    BOOST_CHECK(cache.isPublished(0, scale));
+    BOOST_CHECK(cache.isPublished(5, scale));
+    BOOST_CHECK(!cache.isPublished(1, scale));
+    BOOST_CHECK(!cache.isPublished(0, 0));
+    BOOST_CHECK_EQUAL(cache.get(0, scale).get(), maps0.get());
+    BOOST_CHECK_EQUAL(cache.get(0, scale, false).get(), maps0.get());
+    BOOST_CHECK_EQUAL(cache.get(5, scale).get(), maps5.get());
+    BOOST_CHECK_EQUAL(cache.getUsedMemory(), 2 * mapsBytes);
+
+    // maps read from disk are replaced by the published ones
+    {
+        const MapsSharedPtr diskMaps1 = cache.get(1, scale);
+        BOOST_CHECK(isCameraMaps(*diskMaps1, 1, false));
+        const MapsSharedPtr maps1 = createMaps(1);
+        BOOST_CHECK(cache.publish(1, scale, maps1));
+        BOOST_CHECK_EQUAL(cache.get(1, scale).get(), maps1.get());
+        BOOST_CHECK(isCameraMaps(*diskMaps1, 1, false));
+        BOOST_CHECK_EQUAL(cache.getUsedMemory(), 3 * mapsBytes);
+    }
+
+    // published maps are never evicted: the maps that do not fit are not published,
+    // the maps read from disk are not kept
+    BOOST_CHECK(!cache.publish(2, scale, createMaps(2)));
+    BOOST_CHECK(!cache.isPublished(2, scale));
+    std::weak_ptr<const DepthSimMaps> diskMaps2 = cache.get(2, scale);
+    BOOST_CHECK(diskMaps2.expired());
+    BOOST_CHECK_EQUAL(cache.getUsedMemory(), 3 * mapsBytes);
+    BOOST_CHECK(isCameraMaps(*cache.get(2, scale), 2, false));
+    BOOST_CHECK(isCameraMaps(*cache.get(0, scale), 0, true));
+}
+
+BOOST_AUTO_TEST_CASE(depthSimMapsCache_eviction)
+{
+    DepthMapsScene scene;
+    DepthSimMapsCache cache(scene.mp.get(), 2 * mapsBytes);
+
+    // the least recently used maps are evicted to stay within the budget
+    std::vector<std::weak_ptr<const DepthSimMaps>> maps(nbCamerasOnDisk);
+    for(int rc = 0; rc < 3; ++rc)
+    {
+        const MapsSharedPtr rcMaps = cache.get(rc, scale);
+        BOOST_CHECK(isCameraMaps(*rcMaps, rc, false));
+        maps[rc] = rcMaps;
+        BOOST_CHECK_LE(cache.getUsedMemory(), 2 * mapsBytes);
+    }
+    BOOST_CHECK(maps[0].expired());
+    BOOST_CHECK(!maps[1].expired());
+    BOOST_CHECK(!maps[2].expired());
+
+    // 2 is the least recently used maps once 1 is requested again
+    BOOST_CHECK_EQUAL(cache.get(1, scale).get(), maps[1].lock().get());
+    maps[3] = cache.get(3, scale);
+    BOOST_CHECK(!maps[1].expired());
+    BOOST_CHECK(maps[2].expired());
+    BOOST_CHECK(!maps[3].expired());
+    BOOST_CHECK_EQUAL(cache.getUsedMemory(), 2 * mapsBytes);
+
+    // pinned maps are not evicted: the next maps are read but not kept
+    {
+        const MapsSharedPtr pinned1 = cache.get(1, scale);
+        const MapsSharedPtr pinned3 = cache.get(3, scale);
+        const MapsSharedPtr maps4 = cache.get(4, scale);
+        BOOST_CHECK(isCameraMaps(*maps4, 4, false));
+        maps[4] = maps4;
+        BOOST_CHECK_EQUAL(cache.getUsedMemory(), 2 * mapsBytes);
+    }
+    BOOST_CHECK(maps[4].expired());
+    BOOST_CHECK(!maps[1].expired());
+    BOOST_CHECK(!maps[3].expired());
+
+    // a depth map alone is read again when the similarity is requested
+    {
+        DepthSimMapsCache depthCache(scene.mp.get(), 2 * mapsBytes);
+        const MapsSharedPtr depthMaps = depthCache.get(0, scale, false);
+        BOOST_CHECK(isCameraMaps(*depthMaps, 0, false, false));
+        BOOST_CHECK(depthMaps->simMap.empty());
+        BOOST_CHECK_EQUAL(depthCache.getUsedMemory(), mapBytes);
+        BOOST_CHECK_EQUAL(depthCache.get(0, scale, false).get(), depthMaps.get());
+
+        const MapsSharedPtr depthSimMaps = depthCache.get(0, scale);
+        BOOST_CHECK(isCameraMaps(*depthSimMaps, 0, false));
+        BOOST_CHECK_EQUAL(depthCache.getUsedMemory(), mapsBytes);
+        BOOST_CHECK_EQUAL(depthCache.get(0, scale, false).get(), depthSimMaps.get());
+    }
+
+    // the published maps take the place of the least recently used maps read from disk
+    BOOST_CHECK(cache.publish(0, scale, createMaps(0)));
+    BOOST_CHECK(maps[1].expired());
+    BOOST_CHECK(!maps[3].expired());
+    BOOST_CHECK_EQUAL(cache.getUsedMemory(), 2 * mapsBytes);
+
+    // a failed read is not kept
+    BOOST_CHECK_THROW(cache.get(5, scale), std::exception);
+    BOOST_CHECK_EQUAL(cache.getUsedMemory(), 2 * mapsBytes);
+}
+
+BOOST_AUTO_TEST_CASE(depthSimMapsCache_concurrentGet)
+{
+    DepthMapsScene scene;
+    DepthSimMapsCache cache(scene.mp.get(), nbCameras * mapsBytes);
+
+    // all the threads request the same maps at the same time: they wait for a single read
+    const int nbThreads = 8;
+    std::vector<MapsSharedPtr> maps(nbThreads);
+    std::atomic<int> nbErrors(0);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < nbThreads; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            while(!start)
+                std::this_thread::yield();
+            maps[t] = cache.get(2, scale);
+
+            // the threads waiting for a failed read do not wait forever
+            try
+            {
+                cache.get(5, scale);
+            }
+            catch(const std::exception&)
+            {
+                ++nbErrors;
+            }
+        });
+    }
+    start = true;
+    for(std::thread& thread : threads)
+        thread.join();
+
+    for(int t = 0; t < nbThreads; ++t)
+    {
+        BOOST_REQUIRE(maps[t] != nullptr);
+        BOOST_CHECK_EQUAL(maps[t].get(), maps[0].get());
+    }
+    BOOST_CHECK(isCameraMaps(*maps[0], 2, false));
+    BOOST_CHECK_EQUAL(nbErrors, nbThreads);
+    BOOST_CHECK_EQUAL(cache.getUsedMemory(), mapsBytes);
+}
+
+BOOST_AUTO_TEST_CASE(depthSimMapsCache_concurrentPublish)
+{
+    DepthMapsScene scene;
+    const int nbPublished = 3;
+    // the maps read from disk are evicted to make room for the published ones,
+    // the maps pinned by the threads can make a publication fail
+    const std::size_t maxBytes = (nbPublished + 1) * mapsBytes;
+    DepthSimMapsCache cache(scene.mp.get(), maxBytes);
+
+    // the threads read random maps while the first ones are published:
+    // they get the maps from disk before the publication and the published ones after
+    const int nbThreads = 4;
+    const int nbRequests = 300;
+    std::atomic<bool> stop(false);
+    std::atomic<int> nbWrongMaps(0);
+    std::atomic<int> nbOverBudget(0);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < nbThreads; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 generator(t);
+            std::uniform_int_distribution<int> camera(0, nbCamerasOnDisk - 1);
+            MapsSharedPtr previous;
+            for(int r = 0; r < nbRequests || !stop; ++r)
+            {
+                const int rc = camera(generator);
+                const bool published = cache.isPublished(rc, scale);
+                const MapsSharedPtr maps = cache.get(rc, scale);
+                if(!isCameraMaps(*maps, rc, true) && (published || !isCameraMaps(*maps, rc, false)))
+                    ++nbWrongMaps;
+                if(cache.getUsedMemory() > maxBytes)
+                    ++nbOverBudget;
+                // the previous maps stay pinned while the next ones are read
+                previous = maps;
+            }
+        });
+    }
+
+    std::vector<MapsSharedPtr> publishedMaps;
+    std::vector<bool> isPublished;
+    for(int rc = 0; rc < nbPublished; ++rc)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        publishedMaps.push_back(createMaps(rc));
+        isPublished.push_back(cache.publish(rc, scale, publishedMaps.back()));
+    }
+    stop = true;
+    for(std::thread& thread : threads)
+        thread.join();
+
+    BOOST_CHECK_EQUAL(nbWrongMaps, 0);
+    BOOST_CHECK_EQUAL(nbOverBudget, 0);
+    for(int rc = 0; rc < nbPublished; ++rc)
+    {
+        BOOST_CHECK_EQUAL(cache.isPublished(rc, scale), isPublished[rc]);
+        if(isPublished[rc])
+            BOOST_CHECK_EQUAL(cache.get(rc, scale).get(), publishedMaps[rc].get());
+        else
+            BOOST_CHECK(isCameraMaps(*cache.get(rc, scale), rc, false));
+    }
+    BOOST_CHECK_LE(cache.getUsedMemory(), maxBytes);
+}
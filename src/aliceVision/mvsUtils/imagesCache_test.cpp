@@ -0,0 +1,190 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/cacheTest.hpp>
+
+#define BOOST_TEST_MODULE imagesCache
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::mvsUtils;
+using namespace aliceVision::mvsUtils::cacheTest;
+
+namespace {
+
+const std::size_t imageBytes = sizeof(Color) * nbPixels;
+
+/// images of the cameras on disk, filled with the value of their camera
+struct CachedScene : public Scene
+{
+    CachedScene()
+        : Scene("imagesCache")
+    {
+        for(int i = 0; i < nbCameras; ++i)
+        {
+            const float value = getCameraValue(i);
+            writeImage(sfmData.getView(i).getImagePath(), std::vector<Color>(nbPixels, Color(value, value, value)));
+        }
+    }
+};
+
+/// true if the image has the size and the value of the camera
+bool isCameraImage(const Image& img, int camId)
+{
+    return img.width() == width && img.height() == height &&
+           isFilledWith(getCameraValue(camId), [&](std::size_t i) { return img[i].r; });
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(imagesCache_evictionUnderBudget)
+{
+    CachedScene scene;
+    MultiViewParams mp(scene.sfmData);
+    BOOST_REQUIRE_EQUAL(mp.getNbCameras(), nbCameras);
+
+    ImagesCache cache(&mp, imageIO::EImageColorSpace::LINEAR);
+    cache.setMaxMemory(3 * imageBytes);
+
+    // the least recently used images are evicted to stay within the budget
+    for(int camId = 0; camId < nbCameras; ++camId)
+    {
+        BOOST_CHECK(isCameraImage(*cache.getImg_sync(camId), camId));
+        BOOST_CHECK_LE(cache.getStats().usedBytes, 3 * imageBytes);
+    }
+    ImagesCache::Stats stats = cache.getStats();
+    BOOST_CHECK_EQUAL(stats.misses, nbCameras);
+    BOOST_CHECK_EQUAL(stats.hits, 0);
+    BOOST_CHECK_EQUAL(stats.evictions, nbCameras - 3);
+    BOOST_CHECK_EQUAL(stats.usedBytes, 3 * imageBytes);
+
+    // the last 3 images are cached, the first ones have been evicted
+    cache.getImg_sync(3);
+    cache.getImg_sync(5);
+    BOOST_CHECK_EQUAL(cache.getStats().hits, 2);
+    cache.getImg_sync(0);
+    BOOST_CHECK_EQUAL(cache.getStats().misses, nbCameras + 1);
+
+    // 4 was the least recently used image, evicted for 0
+    cache.getImg_sync(4);
+    BOOST_CHECK_EQUAL(cache.getStats().misses, nbCameras + 2);
+
+    // pinned images are not evicted, even beyond the budget
+    {
+        std::vector<ImagesCache::ImgSharedPtr> pinned;
+        for(int camId = 0; camId < 4; ++camId)
+            pinned.push_back(cache.getImg_sync(camId));
+        BOOST_CHECK_EQUAL(cache.getStats().usedBytes, 4 * imageBytes);
+
+        // the same buffers are given back while they are pinned
+        for(int camId = 0; camId < 4; ++camId)
+        {
+            BOOST_CHECK_EQUAL(cache.getImg_sync(camId).get(), pinned[camId].get());
+            BOOST_CHECK(isCameraImage(*pinned[camId], camId));
+        }
+    }
+
+    // back within the budget once the images are released
+    cache.setMaxMemory(2 * imageBytes);
+    BOOST_CHECK_EQUAL(cache.getStats().usedBytes, 2 * imageBytes);
+    cache.setCacheSize(1);
+    BOOST_CHECK_EQUAL(cache.getStats().usedBytes, imageBytes);
+}
+
+BOOST_AUTO_TEST_CASE(imagesCache_concurrentSameImage)
+{
+    CachedScene scene;
+    MultiViewParams mp(scene.sfmData);
+    ImagesCache cache(&mp, imageIO::EImageColorSpace::LINEAR);
+    cache.setMaxMemory(nbCameras * imageBytes);
+
+    // all the threads request the same image at the same time: it is loaded once
+    const int nbThreads = 8;
+    std::vector<ImagesCache::ImgSharedPtr> images(nbThreads);
+    std::atomic<bool> start(false);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < nbThreads; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            while(!start)
+                std::this_thread::yield();
+            images[t] = cache.getImg_sync(2);
+        });
+    }
+    start = true;
+    for(std::thread& thread : threads)
+        thread.join();
+
+    for(int t = 0; t < nbThreads; ++t)
+    {
+        BOOST_REQUIRE(images[t] != nullptr);
+        BOOST_CHECK_EQUAL(images[t].get(), images[0].get());
+    }
+    BOOST_CHECK(isCameraImage(*images[0], 2));
+
+    const ImagesCache::Stats stats = cache.getStats();
+    BOOST_CHECK_EQUAL(stats.misses, 1);
+    BOOST_CHECK_EQUAL(stats.hits, nbThreads - 1);
+    BOOST_CHECK_EQUAL(stats.usedBytes, imageBytes);
+}
+
+BOOST_AUTO_TEST_CASE(imagesCache_concurrentEviction)
+{
+    CachedScene scene;
+    MultiViewParams mp(scene.sfmData);
+    ImagesCache cache(&mp, imageIO::EImageColorSpace::LINEAR);
+    cache.setMaxMemory(2 * imageBytes);
+
+    // threads read random images with a budget smaller than the images in use:
+    // an image is never evicted nor overwritten while a thread holds it
+    const int nbThreads = 4;
+    const int nbRequests = 200;
+    std::atomic<int> nbWrongImages(0);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < nbThreads; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 generator(t);
+            std::uniform_int_distribution<int> camera(0, nbCameras - 1);
+            ImagesCache::ImgSharedPtr previous;
+            int previousCamId = -1;
+            for(int r = 0; r < nbRequests; ++r)
+            {
+                const int camId = camera(generator);
+                ImagesCache::ImgSharedPtr img = cache.getImg_sync(camId);
+                if(!isCameraImage(*img, camId))
+                    ++nbWrongImages;
+                // the previous image is still pinned while the next one is loaded
+                if(previous != nullptr && !isCameraImage(*previous, previousCamId))
+                    ++nbWrongImages;
+                previous = img;
+                previousCamId = camId;
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+        thread.join();
+
+    BOOST_CHECK_EQUAL(nbWrongImages, 0);
+
+    const ImagesCache::Stats stats = cache.getStats();
+    BOOST_CHECK_EQUAL(stats.hits + stats.misses, nbThreads * nbRequests);
+    BOOST_CHECK_EQUAL(stats.usedBytes, (stats.misses - stats.evictions) * imageBytes);
+
+    // nothing is pinned anymore, the cache goes back within its budget
+    cache.setMaxMemory(2 * imageBytes);
+    BOOST_CHECK_LE(cache.getStats().usedBytes, 2 * imageBytes);
+}
@@ -13,6 +13,7 @@
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/config.hpp>
 #include <aliceVision/camera/Equidistant.hpp>
+#include <aliceVision/system/Tracer.hpp>
 
 #include <boost/filesystem.hpp>
 
@@ -532,11 +533,51 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
   // note: set it to NULL if you don't want use a lossFunction.
   ceres::LossFunction* lossFunction = _ceresOptions.lossFunction.get();
 
+  // the landmarks positions of the table are the parameters blocks
+  _landmarksTable.build(sfmData.getLandmarks());
+  Mat3X& positions = _landmarksTable.getPositions();
+
+  // blocks of each observed view, found once per view instead of once per observation
+  struct ViewBlocks
+  {
+    const sfmData::View* view = nullptr;
+    const IntrinsicBase* intrinsic = nullptr;
+    double* poseBlockPtr = nullptr;
+    double* intrinsicBlockPtr = nullptr;
+    double* rigBlockPtr = nullptr;
+    bool isRigSubPose = false;
+  };
+
+  std::vector<ViewBlocks> viewsBlocks(_landmarksTable.getNbViews());
+  for(std::size_t v = 0; v < viewsBlocks.size(); ++v)
+  {
+    ViewBlocks& viewBlocks = viewsBlocks[v];
+    const sfmData::View& view = sfmData.getView(_landmarksTable.getViewIds()[v]);
+    viewBlocks.view = &view;
+    viewBlocks.intrinsic = sfmData.getIntrinsicPtr(view.getIntrinsicId());
+
+    // the blocks of the views only observed by ignored landmarks may not exist
+    const auto poseBlockIt = _posesBlocks.find(view.getPoseId());
+    if(poseBlockIt != _posesBlocks.end())
+      viewBlocks.poseBlockPtr = poseBlockIt->second.data();
+    const auto intrinsicBlockIt = _intrinsicsBlocks.find(view.getIntrinsicId());
+    if(intrinsicBlockIt != _intrinsicsBlocks.end())
+      viewBlocks.intrinsicBlockPtr = intrinsicBlockIt->second.data();
+    viewBlocks.isRigSubPose = view.isPartOfRig() && !view.isPoseIndependant();
+    if(viewBlocks.isRigSubPose)
+    {
+      const auto rigBlockIt = _rigBlocks.find(view.getRigId());
+      if(rigBlockIt != _rigBlocks.end() && rigBlockIt->second.count(view.getSubPoseId()))
+        viewBlocks.rigBlockPtr = rigBlockIt->second.at(view.getSubPoseId()).data();
+    }
+  }
+
+  const std::vector<IndexT>& obsViewIndexes = _landmarksTable.getObservationViewIndexes();
+
   // build the residual blocks corresponding to the track observations
-  for(const auto& landmarkPair: sfmData.getLandmarks())
+  for(std::size_t landmarkIndex = 0; landmarkIndex < _landmarksTable.getNbLandmarks(); ++landmarkIndex)
   {
-    const IndexT landmarkId = landmarkPair.first;
-    const sfmData::Landmark& landmark = landmarkPair.second;
+    const IndexT landmarkId = _landmarksTable.getLandmarkIds()[landmarkIndex];
 
     // do not create a residual block if the landmark
     // have been set as Ignored by the Local BA strategy
@@ -546,20 +587,17 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
       continue;
     }
 
-    std::array<double,3>& landmarkBlock = _landmarksBlocks[landmarkId];
-    for(std::size_t i = 0; i < 3; ++i)
-      landmarkBlock.at(i) = landmark.X(Eigen::Index(i));
-
-    double* landmarkBlockPtr = landmarkBlock.data();
+    double* landmarkBlockPtr = positions.col(landmarkIndex).data();
 
     // add landmark parameter to the all parameters blocks pointers list
     _allParametersBlocks.push_back(landmarkBlockPtr);
 
     // iterate over 2D observation associated to the 3D landmark
-    for(const auto& observationPair: landmark.observations)
+    for(std::size_t obsIndex = _landmarksTable.getObservationsBegin(landmarkIndex); obsIndex < _landmarksTable.getObservationsEnd(landmarkIndex); ++obsIndex)
     {
-      const sfmData::View& view = sfmData.getView(observationPair.first);
-      const sfmData::Observation& observation = observationPair.second;
+      const ViewBlocks& viewBlocks = viewsBlocks[obsViewIndexes[obsIndex]];
+      const sfmData::View& view = *viewBlocks.view;
+      const sfmData::Observation observation = _landmarksTable.getObservation(obsIndex);
 
       // each residual block takes a point and a camera as input and outputs a 2
       // dimensional residual. Internally, the cost function stores the observed
@@ -569,8 +607,11 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
       assert(getIntrinsicState(view.getIntrinsicId()) != EParameterState::IGNORED);
 
       // needed parameters to create a residual block (K, pose)
-      double* poseBlockPtr = _posesBlocks.at(view.getPoseId()).data();
-      double* intrinsicBlockPtr = _intrinsicsBlocks.at(view.getIntrinsicId()).data();
+      if(viewBlocks.poseBlockPtr == nullptr || viewBlocks.intrinsicBlockPtr == nullptr || (viewBlocks.isRigSubPose && viewBlocks.rigBlockPtr == nullptr))
+        throw std::out_of_range("Bundle adjustment: missing pose, rig or intrinsic of the view " + std::to_string(view.getViewId()) + " observing the landmark " + std::to_string(landmarkId));
+
+      double* poseBlockPtr = viewBlocks.poseBlockPtr;
+      double* intrinsicBlockPtr = viewBlocks.intrinsicBlockPtr;
 
       // apply a specific parameter ordering:
       if(_ceresOptions.useParametersOrdering)
@@ -580,11 +621,11 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
         _linearSolverOrdering.AddElementToGroup(intrinsicBlockPtr, 2);
       }
 
-      if(view.isPartOfRig() && !view.isPoseIndependant())
+      if(viewBlocks.isRigSubPose)
       {
-        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+        ceres::CostFunction* costFunction = createRigCostFunctionFromIntrinsics(viewBlocks.intrinsic, observation);
 
-        double* rigBlockPtr = _rigBlocks.at(view.getRigId()).at(view.getSubPoseId()).data();
+        double* rigBlockPtr = viewBlocks.rigBlockPtr;
         _linearSolverOrdering.AddElementToGroup(rigBlockPtr, 1);
 
         problem.AddResidualBlock(costFunction,
@@ -596,7 +637,7 @@ void BundleAdjustmentCeres::addLandmarksToProblem(const sfmData::SfMData& sfmDat
       }
       else
       {
-        ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(sfmData.getIntrinsicPtr(view.getIntrinsicId()), observation);
+        ceres::CostFunction* costFunction = createCostFunctionFromIntrinsics(viewBlocks.intrinsic, observation);
 
         problem.AddResidualBlock(costFunction,
             lossFunction,
@@ -675,6 +716,7 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
                                           ERefineOptions refineOptions,
                                           ceres::Problem& problem)
 {
+  ALICEVISION_TRACE_ZONE("ba::createProblem");
   // clear previously computed data
   resetProblem();
 
@@ -705,7 +747,7 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
   _allParametersBlocks.clear();
   _posesBlocks.clear();
   _intrinsicsBlocks.clear();
-  _landmarksBlocks.clear();
+  _landmarksTable.clear();
   _rigBlocks.clear();
 
   _linearSolverOrdering.Clear();
@@ -713,6 +755,7 @@ void BundleAdjustmentCeres::createProblem(const sfmData::SfMData& sfmData,
 
 void BundleAdjustmentCeres::updateFromSolution(sfmData::SfMData& sfmData, ERefineOptions refineOptions) const
 {
+  ALICEVISION_TRACE_ZONE("ba::updateFromSolution");
   const bool refinePoses = (refineOptions & REFINE_ROTATION) || (refineOptions & REFINE_TRANSLATION);
   const bool refineIntrinsicsOpticalCenter = (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_ALWAYS) || (refineOptions & REFINE_INTRINSICS_OPTICALCENTER_IF_ENOUGH_DATA);
   const bool refineIntrinsics = (refineOptions & REFINE_INTRINSICS_FOCAL) || (refineOptions & REFINE_INTRINSICS_DISTORTION) || refineIntrinsicsOpticalCenter;
@@ -778,17 +821,16 @@ void BundleAdjustmentCeres::updateFromSolution(sfmData::SfMData& sfmData, ERefin
   // update landmarks
   if(refineStructure)
   {
-    for(const auto& landmarksBlockPair: _landmarksBlocks)
+    const Mat3X& positions = _landmarksTable.getPositions();
+    for(std::size_t landmarkIndex = 0; landmarkIndex < _landmarksTable.getNbLandmarks(); ++landmarkIndex)
     {
-      const IndexT landmarkId = landmarksBlockPair.first;
-      sfmData::Landmark& landmark = sfmData.getLandmarks().at(landmarkId);
+      const IndexT landmarkId = _landmarksTable.getLandmarkIds()[landmarkIndex];
 
       // do not update a camera pose set as Ignored or Constant in the Local strategy
       if(getLandmarkState(landmarkId) != EParameterState::REFINED)
         continue;
 
-      for(std::size_t i = 0; i < 3; ++i)
-        landmark.X(Eigen::Index(i))= landmarksBlockPair.second.at(i);
+      sfmData.getLandmarks().at(landmarkId).X = positions.col(landmarkIndex);
     }
   }
 }
@@ -816,6 +858,7 @@ void BundleAdjustmentCeres::createJacobian(const sfmData::SfMData& sfmData,
 
 bool BundleAdjustmentCeres::adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions)
 {
+  ALICEVISION_TRACE_ZONE("ba::adjust");
   // create problem
   ceres::Problem::Options problemOptions;
   problemOptions.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
@@ -11,6 +11,7 @@
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 #include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+#include <aliceVision/sfmData/LandmarksTable.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 
 #include <ceres/ceres.h>
@@ -289,9 +290,9 @@ private:
   /// intrinsics blocks wrapper
   /// block: intrinsics params
   HashMap<IndexT, std::vector<double>> _intrinsicsBlocks;
-  /// landmarks blocks wrapper
-  /// block: 3d position(3)
-  HashMap<IndexT, std::array<double,3>> _landmarksBlocks;
+  /// landmarks and observations in contiguous columns
+  /// block: 3d position(3), one column of the table positions per landmark
+  sfmData::LandmarksTable _landmarksTable;
   /// rig sub-poses blocks wrapper
   /// block: ceres angleAxis(3) + translation(3)
   HashMap<IndexT, HashMap<IndexT, std::array<double,6>>> _rigBlocks;
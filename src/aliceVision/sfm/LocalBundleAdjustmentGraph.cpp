@@ -9,10 +9,9 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <boost/filesystem.hpp>
 
-#include <lemon/bfs.h>
-
 #include <fstream>
 #include <algorithm>
+#include <unordered_set>
 
 namespace fs = boost::filesystem;
 
@@ -47,6 +46,11 @@ std::map<int, std::size_t> LocalBundleAdjustmentGraph::getDistancesHistogram() c
     else
       histogram.at(x.second)++;
   }
+
+  // views further than the distance limit + 1 are not reached by the BFS
+  if(!_distancePerViewId.empty() && _nodePerViewId.size() > _distancePerViewId.size())
+    histogram[-1] += _nodePerViewId.size() - _distancePerViewId.size();
+
   return histogram;
 }
 
@@ -57,6 +61,9 @@ void LocalBundleAdjustmentGraph::setAllParametersToRefine(const sfmData::SfMData
   _statePerPoseId.clear();
   _statePerIntrinsicId.clear();
   _statePerLandmarkId.clear();
+
+  _nbPoses = sfmData.getPoses().size();
+  _nbLandmarks = sfmData.structure.size();
   
   // poses
   for(sfmData::Poses::const_iterator itPose = sfmData.getPoses().begin(); itPose != sfmData.getPoses().end(); ++itPose)
@@ -137,7 +144,7 @@ void LocalBundleAdjustmentGraph::exportIntrinsicsHistory(const std::string& fold
 bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, const std::set<IndexT>& removedViewsId)
 {
   std::size_t numRemovedNode = 0;
-  std::map<IndexT, std::vector<int>> removedEdgesByIntrinsic;
+  std::vector<int> removedEdges;
 
   for(const IndexT& viewId : removedViewsId)
   {
@@ -148,74 +155,136 @@ bool LocalBundleAdjustmentGraph::removeViews(const sfmData::SfMData& sfmData, co
       continue;
     }
 
-    // keep track of node incident edges that are going to be removed
-    // in order to update _intrinsicEdgesId accordingly
-    { 
-      const IndexT intrinsicId = sfmData.getView(viewId).getIntrinsicId();
-      const auto intrinsicIt = _intrinsicEdgesId.find(intrinsicId);
-      if(intrinsicIt != _intrinsicEdgesId.end())
-      {
-        // store incident edge ids before removal
-        for(lemon::ListGraph::IncEdgeIt e(_graph, it->second); e != lemon::INVALID; ++e)
-        {
-          removedEdgesByIntrinsic[intrinsicId].push_back(_graph.id(lemon::ListGraph::Edge(e)));
-        }
-      }
-    }
-    
-    _graph.erase(it->second); // this function erase a node with its incident arcs
-    _viewIdPerNode.erase(it->second);
-    _nodePerViewId.erase(it->first); // warning: invalidates the iterator "it", so it can not be used after this line
+    // keep track of node incident edges that are removed
+    // in order to update _intrinsicEdgesId and _rigEdgesId accordingly
+    const std::vector<int> nodeRemovedEdges = removeNode(it->second);
+    removedEdges.insert(removedEdges.end(), nodeRemovedEdges.begin(), nodeRemovedEdges.end());
+    _nodePerViewId.erase(it); // warning: invalidates the iterator "it", so it can not be used after this line
 
     ++numRemovedNode;
     ALICEVISION_LOG_DEBUG("The view #" << viewId << " has been successfully removed to the distance graph.");
   }
 
-  // remove erased edges from _intrinsicsEdgesId
-  for(auto& edgesIt : removedEdgesByIntrinsic)
+  // remove erased edges from _intrinsicsEdgesId and _rigEdgesId, their ids can be reused
+  if(!removedEdges.empty())
   {
-    const IndexT intrinsicId =  edgesIt.first;
-    std::vector<int>& edgeIds = _intrinsicEdgesId[intrinsicId];
-    std::vector<int>& removedEdges = edgesIt.second;
-
-    std::vector<int> newEdgeIds;
     // sort before using set_difference
-    std::sort(edgeIds.begin(), edgeIds.end());
     std::sort(removedEdges.begin(), removedEdges.end());
 
-    std::set_difference(
-      edgeIds.begin(), edgeIds.end(), 
-      removedEdges.begin(), removedEdges.end(), 
-      std::back_inserter(newEdgeIds)
-    );
-    std::swap(edgeIds, newEdgeIds);
-
-    if(edgeIds.empty())
+    for(std::map<IndexT, std::vector<int>>* edgesIdPerKey : {&_intrinsicEdgesId, &_rigEdgesId})
     {
-      _intrinsicEdgesId.erase(intrinsicId);
+      for(auto edgesIt = edgesIdPerKey->begin(); edgesIt != edgesIdPerKey->end();)
+      {
+        std::vector<int>& edgeIds = edgesIt->second;
+        std::vector<int> newEdgeIds;
+        std::sort(edgeIds.begin(), edgeIds.end());
+
+        std::set_difference(
+          edgeIds.begin(), edgeIds.end(),
+          removedEdges.begin(), removedEdges.end(),
+          std::back_inserter(newEdgeIds)
+        );
+        std::swap(edgeIds, newEdgeIds);
+
+        if(edgeIds.empty())
+          edgesIt = edgesIdPerKey->erase(edgesIt);
+        else
+          ++edgesIt;
+      }
     }
   }
   return numRemovedNode == removedViewsId.size();
 }
 
-int LocalBundleAdjustmentGraph::getPoseDistance(const IndexT poseId) const
+int LocalBundleAdjustmentGraph::addNode(IndexT viewId)
 {
-  if(_distancePerPoseId.find(poseId) == _distancePerPoseId.end())
+  int node;
+  if(!_freeNodes.empty())
   {
-    ALICEVISION_LOG_DEBUG("The pose #" << poseId << " does not exist in the '_mapDistancePerPoseId' (map size: " << _distancePerPoseId.size() << ") \n");
-    return -1;
+    node = _freeNodes.back();
+    _freeNodes.pop_back();
+    _viewIdPerNode[node] = viewId;
+  }
+  else
+  {
+    node = _viewIdPerNode.size();
+    _viewIdPerNode.push_back(viewId);
+    _adjacencyPerNode.emplace_back();
   }
-  return _distancePerPoseId.at(poseId);
+  return node;
 }
 
-int LocalBundleAdjustmentGraph::getViewDistance(const IndexT viewId) const
+std::vector<int> LocalBundleAdjustmentGraph::removeNode(int node)
+{
+  std::vector<int> removedEdges;
+  removedEdges.reserve(_adjacencyPerNode[node].size());
+  for(const auto& neighborEdge : _adjacencyPerNode[node])
+    removedEdges.push_back(neighborEdge.second);
+
+  for(const int edgeId : removedEdges)
+    removeEdge(edgeId);
+
+  _viewIdPerNode[node] = UndefinedIndexT;
+  _freeNodes.push_back(node);
+  return removedEdges;
+}
+
+int LocalBundleAdjustmentGraph::addEdge(int nodeA, int nodeB)
 {
-  if(_distancePerViewId.find(viewId) == _distancePerViewId.end())
+  int edgeId;
+  if(!_freeEdges.empty())
   {
-    ALICEVISION_LOG_DEBUG("Cannot get the graph-distance of the view #" << viewId << ": does not exist in the '_mapDistancePerViewId':\n");
-    return -1;
+    edgeId = _freeEdges.back();
+    _freeEdges.pop_back();
+    _nodesPerEdge[edgeId] = std::make_pair(nodeA, nodeB);
+  }
+  else
+  {
+    edgeId = _nodesPerEdge.size();
+    _nodesPerEdge.emplace_back(nodeA, nodeB);
   }
-  return _distancePerViewId.at(viewId);
+
+  _adjacencyPerNode[nodeA].emplace_back(nodeB, edgeId);
+  if(nodeB != nodeA)
+    _adjacencyPerNode[nodeB].emplace_back(nodeA, edgeId);
+  ++_nbEdges;
+  return edgeId;
+}
+
+void LocalBundleAdjustmentGraph::removeEdge(int edgeId)
+{
+  const std::pair<int, int> nodes = _nodesPerEdge.at(edgeId);
+  assert(nodes.first >= 0);
+
+  for(const int node : {nodes.first, nodes.second})
+  {
+    std::vector<std::pair<int, int>>& adjacency = _adjacencyPerNode[node];
+    adjacency.erase(std::remove_if(adjacency.begin(), adjacency.end(),
+                                   [edgeId](const std::pair<int, int>& neighborEdge) { return neighborEdge.second == edgeId; }),
+                    adjacency.end());
+  }
+
+  _nodesPerEdge[edgeId] = std::make_pair(-1, -1);
+  _freeEdges.push_back(edgeId);
+  --_nbEdges;
+}
+
+int LocalBundleAdjustmentGraph::getPoseDistance(const IndexT poseId) const
+{
+  // poses further than the distance limit + 1 are not reached
+  const auto it = _distancePerPoseId.find(poseId);
+  if(it == _distancePerPoseId.end())
+    return -1;
+  return it->second;
+}
+
+int LocalBundleAdjustmentGraph::getViewDistance(const IndexT viewId) const
+{
+  // views further than the distance limit + 1 are not reached
+  const auto it = _distancePerViewId.find(viewId);
+  if(it == _distancePerViewId.end())
+    return -1;
+  return it->second;
 }
 
 BundleAdjustment::EParameterState LocalBundleAdjustmentGraph::getStateFromDistance(int distance) const
@@ -247,7 +316,7 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
   // identify the views we need to add to the graph:
   std::set<IndexT> addedViewsId;
   
-  if(_graph.maxNodeId() + 1 == 0) // the graph is empty: add all the poses of the scene
+  if(_viewIdPerNode.empty()) // the graph is empty: add all the poses of the scene
   {
     ALICEVISION_LOG_DEBUG("The graph is empty: initial pair & new view(s) added.");
     for(const auto & x : sfmData.getViews())
@@ -278,9 +347,7 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
       continue;
     }
      
-    lemon::ListGraph::Node newNode = _graph.addNode();
-    _nodePerViewId[viewId] = newNode;
-    _viewIdPerNode[newNode] = viewId;
+    _nodePerViewId[viewId] = addNode(viewId);
     ++nbAddedNodes;
   }
 
@@ -295,13 +362,13 @@ void LocalBundleAdjustmentGraph::updateGraphWithNewViews(
     numAddedEdges = newEdges.size();
 
     for(const Pair& edge: newEdges)
-      _graph.addEdge(_nodePerViewId.at(edge.first), _nodePerViewId.at(edge.second));
+      addEdge(_nodePerViewId.at(edge.first), _nodePerViewId.at(edge.second));
 
     numAddedEdges += addIntrinsicEdgesToTheGraph(sfmData, addedViewsId);
   }
   
   ALICEVISION_LOG_DEBUG("The distances graph has been completed with " << nbAddedNodes<< " nodes & " << numAddedEdges << " edges.");
-  ALICEVISION_LOG_DEBUG("It contains " << _graph.maxNodeId() + 1 << " nodes & " << _graph.maxEdgeId() + 1 << " edges");
+  ALICEVISION_LOG_DEBUG("It contains " << countNodes() << " nodes & " << countEdges() << " edges");
 }
 
 void LocalBundleAdjustmentGraph::computeGraphDistances(const sfmData::SfMData& sfmData, const std::set<IndexT>& newReconstructedViews)
@@ -312,35 +379,49 @@ void LocalBundleAdjustmentGraph::computeGraphDistances(const sfmData::SfMData& s
   _distancePerViewId.clear();
   _distancePerPoseId.clear();
   
-  // setup Breadth First Search using Lemon
-  lemon::Bfs<lemon::ListGraph> bfs(_graph);
-  bfs.init();
-  
-  // add source views for the bfs visit of the _graph
+  // the views further than the distance limit + 1 are ignored by the local BA:
+  // the Breadth First Search stops there, so its cost depends on the local neighborhood only
+  const int maxDistance = static_cast<int>(_graphDistanceLimit) + 1;
+
+  // all the nodes are at distance -1 between two searches
+  _distancePerNode.resize(_viewIdPerNode.size(), -1);
+  std::vector<int> queue;
+
+  // add source views for the bfs visit of the graph
   for(const IndexT viewId: newReconstructedViews)
   {
     auto it = _nodePerViewId.find(viewId);
     if(it == _nodePerViewId.end())
       ALICEVISION_LOG_WARNING("The reconstructed view #" << viewId << " cannot be added as source for the BFS: does not exist in the graph.");
-    else
-      bfs.addSource(it->second);
+    else if(_distancePerNode[it->second] != 0)
+    {
+      _distancePerNode[it->second] = 0;
+      queue.push_back(it->second);
+    }
   }
-  bfs.start();
-  
-  // handle bfs results (distances)
-  for(const auto& x : _nodePerViewId) // each node in the graph
+
+  for(std::size_t i = 0; i < queue.size(); ++i)
   {
-    auto& node = x.second;
-    int d = -1; 
-    
-    if(bfs.reached(node))
+    const int node = queue[i];
+    const int d = _distancePerNode[node];
+    _distancePerViewId[_viewIdPerNode[node]] = d;
+
+    if(d == maxDistance)
+      continue;
+
+    for(const auto& neighborEdge : _adjacencyPerNode[node])
     {
-      d = bfs.dist(node);
-      // dist(): "If node v is not reached from the root(s), then the return value of this function is undefined."
-      // this is why the distance is previously set to -1.
+      if(_distancePerNode[neighborEdge.first] == -1)
+      {
+        _distancePerNode[neighborEdge.first] = d + 1;
+        queue.push_back(neighborEdge.first);
+      }
     }
-    _distancePerViewId[x.first] = d;
   }
+
+  // reset the reached nodes for the next search
+  for(const int node : queue)
+    _distancePerNode[node] = -1;
   
   // re-mapping from <ViewId, distance> to <PoseId, distance>:
   for(auto x: _distancePerViewId)
@@ -357,12 +438,15 @@ void LocalBundleAdjustmentGraph::computeGraphDistances(const sfmData::SfMData& s
   } 
 }
 
-void LocalBundleAdjustmentGraph::convertDistancesToStates(const sfmData::SfMData& sfmData)
+void LocalBundleAdjustmentGraph::convertDistancesToStates(const sfmData::SfMData& sfmData, const track::TracksPerView& tracksPerView)
 {
-  // reset the maps
+  // reset the maps, they only contain the states of the previous local region
   _statePerPoseId.clear();
   _statePerIntrinsicId.clear();
   _statePerLandmarkId.clear();
+
+  _nbPoses = sfmData.getPoses().size();
+  _nbLandmarks = sfmData.structure.size();
   
   const std::size_t kWindowSize = 25;   //< nb of the last value in which compute the variation
   const double kStdevPercentage = 1.0;  //< limit percentage of the Std deviation according to the range of all the parameters (e.i. focal)
@@ -381,16 +465,13 @@ void LocalBundleAdjustmentGraph::convertDistancesToStates(const sfmData::SfMData
   //  - a landmarks is set to:
   //    - Ignored by default
   //    - Refined <=> its connected to a refined camera
+  //
+  //  Only the poses reached by the bounded BFS and the landmarks of the refined views are stored,
+  //  the parameters that are not stored are ignored.
 
   // poses
-  for(const auto& posePair : sfmData.getPoses())
-  {
-    const IndexT poseId = posePair.first;
-    const int distance = getPoseDistance(poseId);
-    const BundleAdjustment::EParameterState state = getStateFromDistance(distance);
-
-    _statePerPoseId[poseId] = state;
-  }
+  for(const auto& posePair : _distancePerPoseId)
+    _statePerPoseId[posePair.first] = getStateFromDistance(posePair.second);
   
   // instrinsics
   checkFocalLengthsConsistency(kWindowSize, kStdevPercentage); 
@@ -404,32 +485,48 @@ void LocalBundleAdjustmentGraph::convertDistancesToStates(const sfmData::SfMData
   }
   
   // landmarks
-  for(const auto& itLandmark: sfmData.structure)
+  // a refined landmark is seen by a refined view: the track ids of the refined views are the only candidates
+  const sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+  std::unordered_set<IndexT> visitedLandmarkIds;
+
+  for(const auto& viewPair : _distancePerViewId)
   {
-    const IndexT landmarkId = itLandmark.first;
-    const sfmData::Observations& observations = itLandmark.second.observations;
-    
-    assert(observations.size() >= 2);
+    if(getStateFromDistance(viewPair.second) != BundleAdjustment::EParameterState::REFINED)
+      continue;
+
+    const auto tracksIt = tracksPerView.find(viewPair.first);
+    if(tracksIt == tracksPerView.end())
+      continue;
 
-    std::array<bool, 3> states = {false, false, false};
-    for(const auto& observationIt: observations)
+    for(const std::size_t trackId : tracksIt->second)
     {
-      const int distance = getViewDistance(observationIt.first);
-      const BundleAdjustment::EParameterState viewState = getStateFromDistance(distance);
-      states.at(static_cast<std::size_t>(viewState)) = true;
-    }
+      const IndexT landmarkId = static_cast<IndexT>(trackId);
+      const auto landmarkIt = landmarks.find(landmarkId);
+      if(landmarkIt == landmarks.end() || !visitedLandmarkIds.insert(landmarkId).second)
+        continue;
 
-    // in the general case, a landmark can NOT have observations from refined AND ignored cameras.
-    // in pratice, there is a minimal number of common points to declare the connection between images.
-    // so we can have some points that are not declared in the graph of cameras connections.
-    // for these particular cases, we can have landmarks with refined AND ignored cameras.
-    // in this particular case, we prefer to ignore the landmark to avoid wrong/unconstraint refinements.
+      const sfmData::Observations& observations = landmarkIt->second.observations;
 
-    if(!states.at(static_cast<std::size_t>(BundleAdjustment::EParameterState::REFINED)) ||
-        states.at(static_cast<std::size_t>(BundleAdjustment::EParameterState::IGNORED)))
-      _statePerLandmarkId[landmarkId] = BundleAdjustment::EParameterState::IGNORED;
-    else
-      _statePerLandmarkId[landmarkId] = BundleAdjustment::EParameterState::REFINED;
+      assert(observations.size() >= 2);
+
+      std::array<bool, 3> states = {false, false, false};
+      for(const auto& observationIt: observations)
+      {
+        const int distance = getViewDistance(observationIt.first);
+        const BundleAdjustment::EParameterState viewState = getStateFromDistance(distance);
+        states.at(static_cast<std::size_t>(viewState)) = true;
+      }
+
+      // in the general case, a landmark can NOT have observations from refined AND ignored cameras.
+      // in pratice, there is a minimal number of common points to declare the connection between images.
+      // so we can have some points that are not declared in the graph of cameras connections.
+      // for these particular cases, we can have landmarks with refined AND ignored cameras.
+      // in this particular case, we prefer to ignore the landmark to avoid wrong/unconstraint refinements.
+
+      if(states.at(static_cast<std::size_t>(BundleAdjustment::EParameterState::REFINED)) &&
+         !states.at(static_cast<std::size_t>(BundleAdjustment::EParameterState::IGNORED)))
+        _statePerLandmarkId[landmarkId] = BundleAdjustment::EParameterState::REFINED;
+    }
   }
 }
 
@@ -441,44 +538,31 @@ std::vector<Pair> LocalBundleAdjustmentGraph::getNewEdges(
     const std::size_t minNbOfEdgesPerView)
 {
   std::vector<Pair> newEdges;
-  
-  // get landmarks id. of all the reconstructed 3D points (: landmarks)
-  // TODO: avoid copy and use boost::transform_iterator
-  std::set<IndexT> landmarkIds;
-  std::transform(sfmData.getLandmarks().begin(), sfmData.getLandmarks().end(),
-                 std::inserter(landmarkIds, landmarkIds.begin()),
-                 stl::RetrieveKey());
-  
+  const sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+
   for(IndexT viewId: newViewsId)
   {
-    std::map<IndexT, std::size_t> sharedLandmarksPerView;
+    HashMap<IndexT, std::size_t> sharedLandmarksPerView;
 
     // get all the tracks of the new added view
     const aliceVision::track::TrackIdSet& newViewTrackIds = tracksPerView.at(viewId);
-    
-    // keep the reconstructed tracks (with an associated landmark)
-    std::vector<IndexT> newViewLandmarks; // all landmarks (already reconstructed) visible from the new view
-    
-    newViewLandmarks.reserve(newViewTrackIds.size());
-    std::set_intersection(newViewTrackIds.begin(), newViewTrackIds.end(),
-                          landmarkIds.begin(), landmarkIds.end(),
-                          std::back_inserter(newViewLandmarks));
-    
+
+    // keep the reconstructed tracks (with an associated landmark) and
     // retrieve the common track Ids
-    for(IndexT landmarkId: newViewLandmarks)
+    for(IndexT trackId: newViewTrackIds)
     {
-      for(const auto& observations: sfmData.getLandmarks().at(landmarkId).observations)
+      const auto landmarkIt = landmarks.find(trackId);
+      if(landmarkIt == landmarks.end())
+        continue;
+
+      for(const auto& observations: landmarkIt->second.observations)
       {
         if(observations.first == viewId)
           continue; // do not compare an observation with itself
-        
+
         // increment the number of common landmarks between the new view and the already
         // reconstructed cameras (observations).
-        auto it = sharedLandmarksPerView.find(observations.first);
-        if(it == sharedLandmarksPerView.end())  // the first common landmark
-          sharedLandmarksPerView[observations.first] = 1;
-        else
-          ++it->second;
+        ++sharedLandmarksPerView[observations.first];
       }
     }
 
@@ -489,7 +573,10 @@ std::vector<Pair> LocalBundleAdjustmentGraph::getNewEdges(
     for(const auto& sharedLandmarkPair: sharedLandmarksPerView)
       sharedLandmarksPerViewSorted.push_back(sharedLandmarkPair);
 
-    std::sort(sharedLandmarksPerViewSorted.begin(), sharedLandmarksPerViewSorted.end(), [](const ViewNbLandmarks& a, const ViewNbLandmarks& b){ return (a.second > b.second); });
+    // most shared landmarks first, then by view id
+    std::sort(sharedLandmarksPerViewSorted.begin(), sharedLandmarksPerViewSorted.end(), [](const ViewNbLandmarks& a, const ViewNbLandmarks& b){
+      return (a.second > b.second) || (a.second == b.second && a.first < b.first);
+    });
 
     std::size_t nbEdgesPerView = 0;
     for(const ViewNbLandmarks& sharedLandmarkPair : sharedLandmarksPerViewSorted)
@@ -610,26 +697,29 @@ void LocalBundleAdjustmentGraph::drawGraph(const sfmData::SfMData& sfmData, cons
   
   // node
   dotStream << "  node [ shape=ellipse, penwidth=5.0, fontname=Helvetica, fontsize=40 ];" << "\n";
-  for(lemon::ListGraph::NodeIt n(_graph); n!=lemon::INVALID; ++n)
+  for(const auto& viewNode : _nodePerViewId)
   {
-    const IndexT viewId = _viewIdPerNode[n];
-    const int viewDist = _distancePerViewId[viewId];
+    const IndexT viewId = viewNode.first;
+    const int viewDist = getViewDistance(viewId);
     
     std::string color = ", color=";
     if(viewDist == 0) color += "red";
     else if(viewDist == 1 ) color += "green";
     else if(viewDist == 2 ) color += "blue";
     else color += "black";
-    dotStream << "  n" << _graph.id(n)
+    dotStream << "  n" << viewNode.second
               << " [ label=\"" << viewId << ": D" << viewDist << " K" << sfmData.getViews().at(viewId)->getIntrinsicId() << "\"" << color << "]; " << "\n";
   }
   
   // edge
   dotStream << "  edge [ shape=ellipse, fontname=Helvetica, fontsize=5, color=black ];" << "\n";
-  for(lemon::ListGraph::EdgeIt e(_graph); e!=lemon::INVALID; ++e)
+  for(int edgeId = 0; edgeId < _nodesPerEdge.size(); ++edgeId)
   {
-    dotStream << "  n" << _graph.id(_graph.u(e)) << " -> " << " n" << _graph.id(_graph.v(e));
-    if(_intrinsicEdgesId.find(static_cast<IndexT>(_graph.id(e))) != _intrinsicEdgesId.end())
+    const std::pair<int, int>& nodes = _nodesPerEdge[edgeId];
+    if(nodes.first < 0)
+      continue;
+    dotStream << "  n" << nodes.first << " -> " << " n" << nodes.second;
+    if(_intrinsicEdgesId.find(static_cast<IndexT>(edgeId)) != _intrinsicEdgesId.end())
       dotStream << " [color=red]\n";
     else
       dotStream << "\n";
@@ -673,12 +763,12 @@ std::size_t LocalBundleAdjustmentGraph::addIntrinsicEdgesToTheGraph(const sfmDat
     }
   }
 
-  // create registered intrinsic edges in lemon graph 
+  // create registered intrinsic edges in the graph
   // and update _intrinsicEdgesId accordingly
   for(const auto& newEdge : newIntrinsicEdges)
   {
-    const lemon::ListGraph::Edge edge = _graph.addEdge(_nodePerViewId[newEdge.first.first], _nodePerViewId[newEdge.first.second]);
-    _intrinsicEdgesId[newEdge.second].push_back(_graph.id(edge));
+    const int edgeId = addEdge(_nodePerViewId.at(newEdge.first.first), _nodePerViewId.at(newEdge.first.second));
+    _intrinsicEdgesId[newEdge.second].push_back(edgeId);
   }
   return newIntrinsicEdges.size();
 }
@@ -688,11 +778,7 @@ void LocalBundleAdjustmentGraph::removeIntrinsicEdgesFromTheGraph(IndexT intrins
   if(_intrinsicEdgesId.count(intrinsicId) == 0)
     return;
   for(const int edgeId : _intrinsicEdgesId.at(intrinsicId))
-  {
-    const auto& edge = _graph.edgeFromId(edgeId);
-    assert(_graph.valid(edge));
-    _graph.erase(edge);
-  }
+    removeEdge(edgeId);
   _intrinsicEdgesId.erase(intrinsicId);
 }
 
@@ -705,11 +791,7 @@ std::size_t LocalBundleAdjustmentGraph::updateRigEdgesToTheGraph(const sfmData::
   for(auto& edgesPerRid: _rigEdgesId)
   {
     for(const int edgeId : edgesPerRid.second)
-    {
-      const auto& edge = _graph.edgeFromId(edgeId);
-      assert(_graph.valid(edge));
-      _graph.erase(edge);
-    }
+      removeEdge(edgeId);
   }
   _rigEdgesId.clear();
 
@@ -737,8 +819,8 @@ std::size_t LocalBundleAdjustmentGraph::updateRigEdgesToTheGraph(const sfmData::
     {
       for(int j = i; j < views.size(); ++j)
       {
-        lemon::ListGraph::Edge edge = _graph.addEdge(_nodePerViewId[views[i]], _nodePerViewId[views[j]]);
-        _rigEdgesId[rigId].push_back(_graph.id(edge));
+        const int edgeId = addEdge(_nodePerViewId.at(views[i]), _nodePerViewId.at(views[j]));
+        _rigEdgesId[rigId].push_back(edgeId);
         numAddedEdges++;
       }
     }
@@ -747,21 +829,5 @@ std::size_t LocalBundleAdjustmentGraph::updateRigEdgesToTheGraph(const sfmData::
   return numAddedEdges;
 }
 
-unsigned int LocalBundleAdjustmentGraph::countNodes() const
-{
-  unsigned int count = 0;
-  for(lemon::ListGraph::NodeIt n(_graph); n != lemon::INVALID; ++n)
-    ++count;
-  return count;
-}
-
-unsigned int LocalBundleAdjustmentGraph::countEdges() const
-{
-  unsigned int count = 0;
-  for(lemon::ListGraph::EdgeIt e(_graph); e != lemon::INVALID; ++e)
-    ++count;
-  return count;
-}
-
 } // namespace sfm
 } // namespace aliceVision
@@ -10,8 +10,8 @@
 #include <aliceVision/track/TracksBuilder.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 
-#include <lemon/list_graph.h>
-
+#include <map>
+#include <vector>
 
 namespace aliceVision {
 
@@ -34,18 +34,19 @@ public:
 
   /**
    * @brief Return the number of posed views for each graph-distance
-   * @return map<distance, numViews>
+   * @return map<distance, numViews>, distance -1 for the views not reached by the bounded BFS
    */
   std::map<int, std::size_t> getDistancesHistogram() const;
     
   /**
    * @brief Return the BundleAdjustment::EParameterState for a specific pose.
    * @param[in] poseId The given pose Id
-   * @return BundleAdjustment::EParameterState
+   * @return BundleAdjustment::EParameterState, \a Ignored for the poses out of the local region
    */
   inline BundleAdjustment::EParameterState getPoseState(const IndexT poseId) const
   {
-    return _statePerPoseId.at(poseId);
+    const auto it = _statePerPoseId.find(poseId);
+    return (it != _statePerPoseId.end()) ? it->second : BundleAdjustment::EParameterState::IGNORED;
   }
  
   /**
@@ -55,17 +56,19 @@ public:
    */
   inline BundleAdjustment::EParameterState getIntrinsicState(const IndexT intrinsicId) const
   {
-    return _statePerIntrinsicId.at(intrinsicId);
+    const auto it = _statePerIntrinsicId.find(intrinsicId);
+    return (it != _statePerIntrinsicId.end()) ? it->second : BundleAdjustment::EParameterState::IGNORED;
   }
 
   /**
    * @brief Return the BundleAdjustment::EParameterState for a specific landmark.
    * @param[in] landmarkId The given landmark Id
-   * @return BundleAdjustment::EParameterState
+   * @return BundleAdjustment::EParameterState, \a Ignored for the landmarks out of the local region
    */
   inline BundleAdjustment::EParameterState getLandmarkState(const IndexT landmarkId) const
   {
-    return _statePerLandmarkId.at(landmarkId);
+    const auto it = _statePerLandmarkId.find(landmarkId);
+    return (it != _statePerLandmarkId.end()) ? it->second : BundleAdjustment::EParameterState::IGNORED;
   }
 
   /**
@@ -79,6 +82,9 @@ public:
     for(const auto& poseStatePair : _statePerPoseId)
       if(poseStatePair.second == state)
         ++nb;
+    // the poses that are not stored are ignored
+    if(state == BundleAdjustment::EParameterState::IGNORED)
+      nb += _nbPoses - _statePerPoseId.size();
     return nb;
   }
 
@@ -107,6 +113,9 @@ public:
     for(const auto& landmarkStatePair : _statePerLandmarkId)
       if(landmarkStatePair.second == state)
         ++nb;
+    // the landmarks that are not stored are ignored
+    if(state == BundleAdjustment::EParameterState::IGNORED)
+      nb += _nbLandmarks - _statePerLandmarkId.size();
     return nb;
   }
 
@@ -169,8 +178,9 @@ public:
       const std::size_t kMinNbOfMatches = 50);
   
   /**
-   * @brief Compute the intragraph-distance between all the nodes of the graph (posed views) and the newly resected views.
-   * @details The graph-distances are computed using a Breadth-first Search (BFS) method.
+   * @brief Compute the intragraph-distance between the nodes of the graph (posed views) and the newly resected views.
+   * @details The graph-distances are computed using a Breadth-first Search (BFS) method, stopped at the distance
+   * limit + 1: the further views are ignored by the local BA, they are not reached (distance -1).
    * @param[in] sfmData contains all the information about the reconstruction, notably the posed views
    * @param[in] newReconstructedViews The list of the newly resected views used (used as source in the BFS algorithm)
    */
@@ -195,9 +205,11 @@ public:
    *     - a Landmarks is set to:
    *        - \a Ignored by default
    *        - \a Refined <=> its connected to a refined camera
+   * Only the poses reached by the bounded BFS and the landmarks seen by the refined views are visited.
    * @param[in] sfmData contains all the information about the reconstruction
+   * @param[in] tracksPerView A map giving the tracks for each view, the landmark Id of a reconstructed track is its TrackID
    */
-  void convertDistancesToStates(const sfmData::SfMData& sfmData);
+  void convertDistancesToStates(const sfmData::SfMData& sfmData, const track::TracksPerView& tracksPerView);
 
   /**
    * @brief Update rigs edges.
@@ -207,19 +219,51 @@ public:
   std::size_t updateRigEdgesToTheGraph(const sfmData::SfMData& sfmData);
 
   /**
-   * @brief Count and return the number of nodes in the underlying lemon graph.
+   * @brief Return the number of nodes in the graph.
    * @return The number of nodes in the graph.
    */
-  unsigned int countNodes() const;
+  unsigned int countNodes() const
+  {
+    return _nodePerViewId.size();
+  }
 
   /**
-   * @brief Count and return the number of edges in the underlying lemon graph.
+   * @brief Return the number of edges in the graph.
    * @return The number of edges in the graph.
    */
-  unsigned int countEdges() const;
+  unsigned int countEdges() const
+  {
+    return _nbEdges;
+  }
 
 private:
-  
+
+  /**
+   * @brief Add a node for a view in the graph, reusing a removed node index if any.
+   * @param[in] viewId The view of the node
+   * @return The node index
+   */
+  int addNode(IndexT viewId);
+
+  /**
+   * @brief Remove a node and all its incident edges from the graph.
+   * @param[in] node The node index
+   * @return The ids of the removed edges
+   */
+  std::vector<int> removeNode(int node);
+
+  /**
+   * @brief Add an edge between two nodes, reusing a removed edge id if any.
+   * @return The edge id
+   */
+  int addEdge(int nodeA, int nodeB);
+
+  /**
+   * @brief Remove an edge from the graph.
+   * @param[in] edgeId The edge id
+   */
+  void removeEdge(int edgeId);
+
   /**
    * @brief Return the distance between a specific pose and the new posed views.
    * @param[in] poseId is the index of the poseId
@@ -316,24 +360,41 @@ private:
   // - Local BA needs to know the distance of all the old posed views to the new resected views.
   // - The bundle adjustment will be processed on the closest poses only.
 
-  /// A graph where nodes are poses and an edge exists when 2 poses shared at least 'kMinNbOfMatches' matches.
-  lemon::ListGraph _graph; 
+  // A graph where nodes are posed views and an edge exists when 2 views shared at least 'kMinNbOfMatches' matches
+  // (or a non constant intrinsic, or a rig). Parallel edges are allowed.
+  // It is stored in adjacency lists indexed by node, the indexes of the removed nodes and edges are reused.
+
+  /// Associates each node to its corresponding view (UndefinedIndexT for a removed node).
+  std::vector<IndexT> _viewIdPerNode;
+  /// Incident edges of each node: <neighbor node, edge id>
+  std::vector<std::vector<std::pair<int, int>>> _adjacencyPerNode;
+  /// Nodes of each edge (-1 for a removed edge)
+  std::vector<std::pair<int, int>> _nodesPerEdge;
+  /// Removed nodes indexes
+  std::vector<int> _freeNodes;
+  /// Removed edges ids
+  std::vector<int> _freeEdges;
+  /// Number of edges in the graph
+  std::size_t _nbEdges = 0;
+  /// Graph-distance of each node during the bounded BFS (-1 if not reached)
+  std::vector<int> _distancePerNode;
   /// The graph-distance limit setting the Active region (default value: 1)
   std::size_t _graphDistanceLimit = 1;
   /// Associates each view (indexed by its viewId) to its corresponding node in the graph.
-  std::map<IndexT, lemon::ListGraph::Node> _nodePerViewId;
-  /// Associates each node (in the graph) to its corresponding view.
-  std::map<lemon::ListGraph::Node, IndexT> _viewIdPerNode;
-  /// Store the graph-distances from the new views (0: is a new view, -1: is not connected to the new views)
+  std::map<IndexT, int> _nodePerViewId;
+  /// Store the graph-distances from the new views of the reached views (0: is a new view, missing: further than the distance limit + 1)
   std::map<IndexT, int> _distancePerViewId;
-  /// Store the graph-distances from the new poses (0: is a new pose, -1: is not connected to the new poses)
+  /// Store the graph-distances from the new poses of the reached poses (0: is a new pose, missing: further than the distance limit + 1)
   std::map<IndexT, int> _distancePerPoseId;
   /// Store the \c EParameterState of each pose in the scene.
   std::map<IndexT, BundleAdjustment::EParameterState> _statePerPoseId;
   /// Store the \c EParameterState of each intrinsic in the scene.
   std::map<IndexT, BundleAdjustment::EParameterState> _statePerIntrinsicId;
   /// Store the \c EParameterState of each landmark in the scene.
-  std::map<IndexT, BundleAdjustment::EParameterState> _statePerLandmarkId;
+  HashMap<IndexT, BundleAdjustment::EParameterState> _statePerLandmarkId;
+  /// number of poses and landmarks of the scene when the states were computed
+  std::size_t _nbPoses = 0;
+  std::size_t _nbLandmarks = 0;
   
   // Intrinsics data
   // - Local BA needs to know the evolution of all the intrinsics parameters.
@@ -368,13 +429,13 @@ private:
   std::map<IndexT, bool> _mapFocalIsConstant;
 
   /**
-   * @brief Store the Lemon index of the edges added for the intrinsic links "the intrinsic-edges"
+   * @brief Store the id of the edges added for the intrinsic links "the intrinsic-edges"
    * <IntrinsicId, [edgeId]>
    */
   std::map<IndexT, std::vector<int>> _intrinsicEdgesId;
 
   /**
-   * @brief Store the Lemon index of the edges added for the rig links "the intrinsic-edges"
+   * @brief Store the id of the edges added for the rig links "the rig-edges"
    * <rigId, [edgeId]>
    */
   std::map<IndexT, std::vector<int>> _rigEdgesId;
@@ -163,7 +163,7 @@ struct ResidualErrorFunctor_Pinhole
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (a copy: the cost function may outlive the observation it was created from)
 };
 
 /**
@@ -317,7 +317,7 @@ struct ResidualErrorFunctor_PinholeRadialK1
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (a copy: the cost function may outlive the observation it was created from)
 };
 
 /**
@@ -471,7 +471,7 @@ struct ResidualErrorFunctor_PinholeRadialK3
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (a copy: the cost function may outlive the observation it was created from)
 };
 
 /**
@@ -637,7 +637,7 @@ struct ResidualErrorFunctor_PinholeBrownT2
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (a copy: the cost function may outlive the observation it was created from)
 };
 
 
@@ -805,7 +805,7 @@ struct ResidualErrorFunctor_PinholeFisheye
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (a copy: the cost function may outlive the observation it was created from)
 };
 
 /**
@@ -959,7 +959,7 @@ struct ResidualErrorFunctor_PinholeFisheye1
     return true;
   }
 
-  const sfmData::Observation& _obs; // The 2D observation
+  const sfmData::Observation _obs; // The 2D observation (a copy: the cost function may outlive the observation it was created from)
 };
 
 
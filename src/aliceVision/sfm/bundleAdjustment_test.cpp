@@ -137,6 +137,57 @@ BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_EffectiveMinimization_PinholeFisheye)
   BOOST_CHECK(dResidual_before > dResidual_after);
 }
 
+// Test summary:
+// - Create a SfMData scene with exact 2d observations and move the 3D points away from their true position
+// - Check that the Bundle Adjustment converges back to zero residuals for every observation.
+//   Each residual block must compare the reprojection against its own observation,
+//   the observations are not modified by the Bundle Adjustment.
+
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_Convergence_ObservationsResiduals)
+{
+  const int nviews = 5;
+  const int npoints = 30;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  // Translate the input dataset to a SfMData scene with exact observations
+  SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA_RADIAL3);
+  for(auto& landmarkPair : sfmData.structure)
+  {
+    for(auto& obsPair : landmarkPair.second.observations)
+      obsPair.second.x = d._x[obsPair.first].col(landmarkPair.first);
+  }
+  const SfMData sfmDataReference = sfmData;
+
+  // move the 3D points, the poses and the intrinsics are exact
+  for(auto& landmarkPair : sfmData.structure)
+  {
+    const double offset = 0.05 * (static_cast<int>(landmarkPair.first % 5) - 2);
+    landmarkPair.second.X += Vec3(offset, -offset, 0.5 * offset);
+  }
+
+  const double dResidual_before = RMSE(sfmData);
+  BOOST_CHECK_GT(dResidual_before, 0.1);
+
+  std::shared_ptr<BundleAdjustment> ba_object = std::make_shared<BundleAdjustmentCeres>();
+  BOOST_CHECK( ba_object->adjust(sfmData, BundleAdjustment::REFINE_ROTATION | BundleAdjustment::REFINE_TRANSLATION | BundleAdjustment::REFINE_STRUCTURE) );
+
+  const double dResidual_after = RMSE(sfmData);
+  BOOST_CHECK_SMALL(dResidual_after, 1e-4);
+
+  for(const auto& landmarkPair : sfmData.getLandmarks())
+  {
+    const Landmark& landmarkReference = sfmDataReference.getLandmarks().at(landmarkPair.first);
+    for(const auto& obsPair : landmarkPair.second.observations)
+    {
+      const View& view = sfmData.getView(obsPair.first);
+      const Vec2 residual = sfmData.getIntrinsics().at(view.getIntrinsicId())->residual(sfmData.getPose(view).getTransform(), landmarkPair.second.X, obsPair.second.x);
+      BOOST_CHECK_SMALL(residual.norm(), 1e-3);
+      BOOST_CHECK(obsPair.second == landmarkReference.observations.at(obsPair.first));
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(LOCAL_BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole_CamerasRing)
 {
   const int nviews = 4;
@@ -207,7 +258,7 @@ BOOST_AUTO_TEST_CASE(LOCAL_BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole_Camer
   // 2. Compute the graph-distance between each newly reconstructed views and all the reconstructed views
   localBAGraph->computeGraphDistances(sfmData, newReconstructedViews);
   // 3. Use the graph-distances to assign a LBA state (Refine, Constant & Ignore) for each parameter (poses, intrinsics & landmarks)
-  localBAGraph->convertDistancesToStates(sfmData);
+  localBAGraph->convertDistancesToStates(sfmData, tracksPerView);
 
   BOOST_CHECK_EQUAL(localBAGraph->countNodes(), 4); // 4 views => 4 nodes
   BOOST_CHECK_EQUAL(localBAGraph->countEdges(), 6); // landmarks connections: 6 edges created (see scheme)
@@ -0,0 +1,347 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+
+#include <lemon/list_graph.h>
+#include <lemon/bfs.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+#define BOOST_TEST_MODULE localBundleAdjustmentGraph
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+namespace {
+
+const IndexT nbViews = 40;
+/// views posed after the first local BA
+const IndexT nbInitialViews = 32;
+/// views sharing the only intrinsic that is not locked, linked by intrinsic-edges
+const std::set<IndexT> sharedIntrinsicViews = {5, 20, 33};
+
+/**
+ * @brief Synthetic scene: the views are linked by the landmarks they share:
+ *  - the views [0, 23] and [24, 31] form two chains, with a few shortcuts in the first one,
+ *  - the views [32, 39] are posed later, they join the two chains and form a third one.
+ * Each view shares landmarks with less than 10 views, so that each shared landmark makes an edge.
+ */
+SfMData createScene()
+{
+  SfMData sfmData;
+  for(IndexT viewId = 0; viewId < nbViews; ++viewId)
+  {
+    const IndexT intrinsicId = sharedIntrinsicViews.count(viewId) ? 0 : viewId + 1;
+    std::shared_ptr<camera::Pinhole> intrinsic = std::make_shared<camera::Pinhole>(100, 80, 50.0 + viewId, 50.0, 40.0);
+    if(intrinsicId != 0)
+      intrinsic->lock();
+    sfmData.intrinsics[intrinsicId] = intrinsic;
+    sfmData.views[viewId] = std::make_shared<View>("", viewId, intrinsicId, viewId, 100, 80);
+  }
+  return sfmData;
+}
+
+void addLandmark(SfMData& sfmData, const std::vector<IndexT>& viewIds)
+{
+  // the landmark ids are not contiguous once views have been removed
+  IndexT landmarkId = 0;
+  for(const auto& landmarkPair : sfmData.structure)
+    landmarkId = std::max(landmarkId, landmarkPair.first + 1);
+
+  Landmark landmark(Vec3::Zero());
+  for(const IndexT viewId : viewIds)
+    landmark.observations[viewId] = Observation(Vec2::Zero(), landmarkId, 1.0);
+  sfmData.structure[landmarkId] = landmark;
+}
+
+/// pose the views and add the landmarks between them and the posed views
+void poseViews(SfMData& sfmData, IndexT firstViewId, IndexT lastViewId)
+{
+  for(IndexT viewId = firstViewId; viewId <= lastViewId; ++viewId)
+    sfmData.setPose(*sfmData.views.at(viewId), CameraPose());
+
+  if(firstViewId == 0)
+  {
+    for(IndexT viewId = 0; viewId + 1 < nbInitialViews; ++viewId)
+    {
+      if(viewId == 23)
+        continue;
+      for(IndexT i = 0; i <= viewId % 3; ++i)
+        addLandmark(sfmData, {viewId, viewId + 1});
+    }
+    addLandmark(sfmData, {0, 10});
+    addLandmark(sfmData, {3, 17});
+    addLandmark(sfmData, {12, 22});
+    addLandmark(sfmData, {7, 8, 9});
+  }
+  else
+  {
+    addLandmark(sfmData, {23, 32});
+    addLandmark(sfmData, {32, 25});
+    for(IndexT viewId = 33; viewId < nbViews; ++viewId)
+      addLandmark(sfmData, {viewId - 1, viewId});
+    addLandmark(sfmData, {36, 2, 14});
+  }
+}
+
+/// remove the views from the scene, as the reconstruction does
+void removeViews(SfMData& sfmData, const std::set<IndexT>& viewIds)
+{
+  for(const IndexT viewId : viewIds)
+    sfmData.erasePose(viewId);
+
+  for(auto it = sfmData.structure.begin(); it != sfmData.structure.end();)
+  {
+    for(const IndexT viewId : viewIds)
+      it->second.observations.erase(viewId);
+    if(it->second.observations.size() < 2)
+      it = sfmData.structure.erase(it);
+    else
+      ++it;
+  }
+}
+
+track::TracksPerView getTracksPerView(const SfMData& sfmData)
+{
+  track::TracksPerView tracksPerView;
+  for(const auto& landmarkPair : sfmData.structure)
+  {
+    for(const auto& observationPair : landmarkPair.second.observations)
+      tracksPerView[observationPair.first].push_back(landmarkPair.first);
+  }
+  for(auto& tracksPair : tracksPerView)
+    std::sort(tracksPair.second.begin(), tracksPair.second.end());
+  return tracksPerView;
+}
+
+/**
+ * @brief Distances graph as it was built before the adjacency lists: a lemon::ListGraph
+ * with parallel edges, and distances from an unbounded lemon::Bfs (-1 if not connected).
+ */
+struct ReferenceGraph
+{
+  lemon::ListGraph graph;
+  std::map<IndexT, lemon::ListGraph::Node> nodePerViewId;
+
+  /// add the views that are not in the graph yet, and the edges of all the given views
+  void addViews(const SfMData& sfmData, const std::set<IndexT>& viewIds)
+  {
+    for(const IndexT viewId : viewIds)
+    {
+      if(nodePerViewId.count(viewId) == 0)
+        nodePerViewId[viewId] = graph.addNode();
+    }
+
+    // an edge per new view and view sharing landmarks
+    for(const IndexT viewId : viewIds)
+    {
+      std::set<IndexT> linkedViewIds;
+      for(const auto& landmarkPair : sfmData.structure)
+      {
+        const Observations& observations = landmarkPair.second.observations;
+        if(observations.count(viewId) == 0)
+          continue;
+        for(const auto& observationPair : observations)
+        {
+          if(observationPair.first != viewId)
+            linkedViewIds.insert(observationPair.first);
+        }
+      }
+      for(const IndexT linkedViewId : linkedViewIds)
+        graph.addEdge(nodePerViewId.at(viewId), nodePerViewId.at(linkedViewId));
+    }
+
+    // an edge per pair of views sharing the intrinsic that is not locked
+    std::set<Pair> intrinsicEdges;
+    for(const IndexT viewId : viewIds)
+    {
+      if(sharedIntrinsicViews.count(viewId) == 0)
+        continue;
+      for(const auto& nodePair : nodePerViewId)
+      {
+        if(nodePair.first != viewId && sharedIntrinsicViews.count(nodePair.first))
+          intrinsicEdges.insert(std::minmax(viewId, nodePair.first));
+      }
+    }
+    for(const Pair& edge : intrinsicEdges)
+      graph.addEdge(nodePerViewId.at(edge.first), nodePerViewId.at(edge.second));
+  }
+
+  void removeViews(const std::set<IndexT>& viewIds)
+  {
+    for(const IndexT viewId : viewIds)
+    {
+      graph.erase(nodePerViewId.at(viewId));
+      nodePerViewId.erase(viewId);
+    }
+  }
+
+  std::map<IndexT, int> getDistances(const std::set<IndexT>& sourceViewIds) const
+  {
+    lemon::Bfs<lemon::ListGraph> bfs(graph);
+    bfs.init();
+    for(const IndexT viewId : sourceViewIds)
+      bfs.addSource(nodePerViewId.at(viewId));
+    bfs.start();
+
+    std::map<IndexT, int> distancePerViewId;
+    for(const auto& nodePair : nodePerViewId)
+      distancePerViewId[nodePair.first] = bfs.reached(nodePair.second) ? bfs.dist(nodePair.second) : -1;
+    return distancePerViewId;
+  }
+};
+
+BundleAdjustment::EParameterState getReferenceState(int distance, int distanceLimit)
+{
+  if(distance >= 0 && distance <= distanceLimit)
+    return BundleAdjustment::EParameterState::REFINED;
+  if(distance == distanceLimit + 1)
+    return BundleAdjustment::EParameterState::CONSTANT;
+  return BundleAdjustment::EParameterState::IGNORED;
+}
+
+/**
+ * @brief Check the graph size, and the histogram and states of the bounded BFS against the distances
+ * of the reference graph for several distance limits: the views further than the limit + 1 are not reached.
+ */
+void checkSameDistances(LocalBundleAdjustmentGraph& graph, const ReferenceGraph& reference,
+                        const SfMData& sfmData, const std::set<IndexT>& sourceViewIds)
+{
+  BOOST_CHECK_EQUAL(graph.countNodes(), lemon::countNodes(reference.graph));
+  BOOST_CHECK_EQUAL(graph.countEdges(), lemon::countEdges(reference.graph));
+
+  const std::map<IndexT, int> distancePerViewId = reference.getDistances(sourceViewIds);
+  int maxDistance = 0;
+  for(const auto& distancePair : distancePerViewId)
+    maxDistance = std::max(maxDistance, distancePair.second);
+  BOOST_CHECK_GE(maxDistance, 4);
+
+  for(int distanceLimit = 0; distanceLimit <= maxDistance; ++distanceLimit)
+  {
+    graph.setGraphDistanceLimit(distanceLimit);
+    graph.computeGraphDistances(sfmData, sourceViewIds);
+    graph.convertDistancesToStates(sfmData, getTracksPerView(sfmData));
+
+    std::map<int, std::size_t> histogram;
+    std::map<BundleAdjustment::EParameterState, std::size_t> nbPosesPerState;
+    for(const auto& distancePair : distancePerViewId)
+    {
+      const int distance = (distancePair.second <= distanceLimit + 1) ? distancePair.second : -1;
+      ++histogram[distance];
+
+      // one pose per view, with the same id
+      const BundleAdjustment::EParameterState state = getReferenceState(distancePair.second, distanceLimit);
+      ++nbPosesPerState[state];
+      BOOST_CHECK(graph.getPoseState(distancePair.first) == state);
+    }
+    for(const auto state : {BundleAdjustment::EParameterState::REFINED, BundleAdjustment::EParameterState::CONSTANT, BundleAdjustment::EParameterState::IGNORED})
+      BOOST_CHECK_EQUAL(graph.getNbPosesPerState(state), nbPosesPerState[state]);
+
+    const std::map<int, std::size_t> graphHistogram = graph.getDistancesHistogram();
+    BOOST_REQUIRE_EQUAL(graphHistogram.size(), histogram.size());
+    for(const auto& histogramPair : histogram)
+      BOOST_CHECK_EQUAL(graphHistogram.at(histogramPair.first), histogramPair.second);
+
+    // a landmark is refined if it is seen by a refined view and by no ignored view
+    std::size_t nbRefinedLandmarks = 0;
+    for(const auto& landmarkPair : sfmData.structure)
+    {
+      bool hasRefinedView = false;
+      bool hasIgnoredView = false;
+      for(const auto& observationPair : landmarkPair.second.observations)
+      {
+        const BundleAdjustment::EParameterState state = getReferenceState(distancePerViewId.at(observationPair.first), distanceLimit);
+        hasRefinedView = hasRefinedView || (state == BundleAdjustment::EParameterState::REFINED);
+        hasIgnoredView = hasIgnoredView || (state == BundleAdjustment::EParameterState::IGNORED);
+      }
+      const BundleAdjustment::EParameterState state = (hasRefinedView && !hasIgnoredView) ?
+            BundleAdjustment::EParameterState::REFINED : BundleAdjustment::EParameterState::IGNORED;
+      nbRefinedLandmarks += (state == BundleAdjustment::EParameterState::REFINED);
+      BOOST_CHECK(graph.getLandmarkState(landmarkPair.first) == state);
+    }
+    BOOST_CHECK_EQUAL(graph.getNbLandmarksPerState(BundleAdjustment::EParameterState::REFINED), nbRefinedLandmarks);
+    BOOST_CHECK_EQUAL(graph.getNbLandmarksPerState(BundleAdjustment::EParameterState::IGNORED), sfmData.structure.size() - nbRefinedLandmarks);
+  }
+}
+
+std::set<IndexT> getViewIds(IndexT firstViewId, IndexT lastViewId)
+{
+  std::set<IndexT> viewIds;
+  for(IndexT viewId = firstViewId; viewId <= lastViewId; ++viewId)
+    viewIds.insert(viewId);
+  return viewIds;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(localBundleAdjustmentGraph_distances)
+{
+  SfMData sfmData = createScene();
+  LocalBundleAdjustmentGraph graph(sfmData);
+  poseViews(sfmData, 0, nbInitialViews - 1);
+
+  // the first update adds all the posed views
+  graph.updateGraphWithNewViews(sfmData, getTracksPerView(sfmData), {0});
+  ReferenceGraph reference;
+  reference.addViews(sfmData, getViewIds(0, nbInitialViews - 1));
+
+  checkSameDistances(graph, reference, sfmData, {0});
+  checkSameDistances(graph, reference, sfmData, {31});
+  checkSameDistances(graph, reference, sfmData, {12, 27});
+
+  // a second update with views of the graph adds their edges again, as parallel edges
+  graph.updateGraphWithNewViews(sfmData, getTracksPerView(sfmData), {0, 20});
+  reference.addViews(sfmData, {0, 20});
+  checkSameDistances(graph, reference, sfmData, {0});
+}
+
+BOOST_AUTO_TEST_CASE(localBundleAdjustmentGraph_removeAndAddViews)
+{
+  SfMData sfmData = createScene();
+  LocalBundleAdjustmentGraph graph(sfmData);
+  poseViews(sfmData, 0, nbInitialViews - 1);
+  graph.updateGraphWithNewViews(sfmData, getTracksPerView(sfmData), {0});
+  ReferenceGraph reference;
+  reference.addViews(sfmData, getViewIds(0, nbInitialViews - 1));
+
+  // a view that is not in the graph cannot be removed
+  BOOST_CHECK(!graph.removeViews(sfmData, {nbViews - 1}));
+  checkSameDistances(graph, reference, sfmData, {0});
+
+  // the removed views take their edges with them, intrinsic-edges included
+  const std::set<IndexT> removedViewIds = {5, 9, 24};
+  BOOST_CHECK(graph.removeViews(sfmData, removedViewIds));
+  removeViews(sfmData, removedViewIds);
+  reference.removeViews(removedViewIds);
+  checkSameDistances(graph, reference, sfmData, {0});
+  checkSameDistances(graph, reference, sfmData, {25});
+
+  // the new views reuse the removed nodes and edges
+  poseViews(sfmData, nbInitialViews, nbViews - 1);
+  const std::set<IndexT> newViewIds = getViewIds(nbInitialViews, nbViews - 1);
+  graph.updateGraphWithNewViews(sfmData, getTracksPerView(sfmData), newViewIds);
+  reference.addViews(sfmData, newViewIds);
+  checkSameDistances(graph, reference, sfmData, newViewIds);
+  checkSameDistances(graph, reference, sfmData, {0});
+  checkSameDistances(graph, reference, sfmData, {39});
+
+  // remove a new view and a view linked to new ones
+  const std::set<IndexT> otherRemovedViewIds = {14, 33};
+  BOOST_CHECK(graph.removeViews(sfmData, otherRemovedViewIds));
+  removeViews(sfmData, otherRemovedViewIds);
+  reference.removeViews(otherRemovedViewIds);
+  checkSameDistances(graph, reference, sfmData, {0});
+  checkSameDistances(graph, reference, sfmData, {32, 39});
+}
@@ -447,19 +447,27 @@ void ReconstructionEngine_globalSfM::Compute_Relative_Rotations(rotationAveragin
     poseWiseMatches[Pair(v1->getPoseId(), v2->getPoseId())].insert(pair);
   }
 
+  // Random access to the pose pairs, avoid to walk the map in each iteration
+  std::vector<PoseWiseMatches::const_iterator> poseWiseMatchesIterators;
+  poseWiseMatchesIterators.reserve(poseWiseMatches.size());
+  for (auto iter = poseWiseMatches.cbegin(); iter != poseWiseMatches.cend(); ++iter)
+    poseWiseMatchesIterators.push_back(iter);
+
+  // One slot per pose pair: the relative rotations are collected without lock, in the pose pairs order
+  std::vector<rotationAveraging::RelativeRotation> relativesR(poseWiseMatchesIterators.size());
+  std::vector<unsigned char> isRelativeRValid(poseWiseMatchesIterators.size(), 0);
+
   boost::progress_display progressBar( poseWiseMatches.size(), std::cout, "\n- Relative pose computation -\n" );
   #pragma omp parallel for schedule(dynamic)
   // Compute the relative pose from pairwise point matches:
-  for (int i = 0; i < poseWiseMatches.size(); ++i)
+  for (int i = 0; i < poseWiseMatchesIterators.size(); ++i)
   {
     #pragma omp critical
     {
       ++progressBar;
     }
     {
-      PoseWiseMatches::const_iterator iter (poseWiseMatches.begin());
-      std::advance(iter, i);
-      const auto& relative_pose_iterator(*iter);
+      const auto& relative_pose_iterator(*poseWiseMatchesIterators[i]);
       const Pair relative_pose_pair = relative_pose_iterator.first;
       const PairSet& match_pairs = relative_pose_iterator.second;
 
@@ -481,8 +489,8 @@ void ReconstructionEngine_globalSfM::Compute_Relative_Rotations(rotationAveragin
       const IndexT I = pairIterator.first;
       const IndexT J = pairIterator.second;
 
-      const View* view_I = _sfmData.views[I].get();
-      const View* view_J = _sfmData.views[J].get();
+      const View* view_I = _sfmData.getViews().at(I).get();
+      const View* view_J = _sfmData.getViews().at(J).get();
 
       // Check that valid cameras are existing for the pair of view
       if (_sfmData.getIntrinsics().count(view_I->getIntrinsicId()) == 0 ||
@@ -617,17 +625,20 @@ void ReconstructionEngine_globalSfM::Compute_Relative_Rotations(rotationAveragin
           relativePose_info.relativePose = Pose3(Rrel, -Rrel.transpose() * trel);
         }
       }
-      #pragma omp critical
-      {
-        // Add the relative rotation to the relative 'rotation' pose graph
-        using namespace aliceVision::rotationAveraging;
-          vec_relatives_R.emplace_back(
+      // Add the relative rotation to the relative 'rotation' pose graph
+      relativesR[i] = rotationAveraging::RelativeRotation(
             relative_pose_pair.first, relative_pose_pair.second,
             relativePose_info.relativePose.rotation(), relativePose_info.vec_inliers.size());
-      }
+      isRelativeRValid[i] = 1;
     }
   } // for all relative pose
 
+  for (std::size_t i = 0; i < relativesR.size(); ++i)
+  {
+    if (isRelativeRValid[i])
+      vec_relatives_R.push_back(relativesR[i]);
+  }
+
   // Re-weight rotation in [0,1]
   if (vec_relatives_R.size() > 1)
   {
@@ -12,6 +12,7 @@
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
 #include <aliceVision/sfm/sfmFilters.hpp>
+#include <aliceVision/sfm/sfmResiduals.hpp>
 #include <aliceVision/sfm/sfmStatistics.hpp>
 
 #include <aliceVision/feature/FeaturesPerView.hpp>
@@ -27,6 +28,7 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/cpu.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
 #include <aliceVision/track/tracksUtils.hpp>
 
@@ -160,6 +162,7 @@ ReconstructionEngine_sequentialSfM::ReconstructionEngine_sequentialSfM(
 
 bool ReconstructionEngine_sequentialSfM::process()
 {
+  ALICEVISION_TRACE_ZONE("sfm::process");
   initializePyramidScoring();
 
   if(fuseMatchesIntoTracks() == 0)
@@ -229,6 +232,7 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
 
 std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
 {
+  ALICEVISION_TRACE_ZONE("sfm::fuseMatchesIntoTracks");
   // compute tracks from matches
   track::TracksBuilder tracksBuilder;
 
@@ -307,6 +311,7 @@ std::vector<Pair> ReconstructionEngine_sequentialSfM::getInitialImagePairsCandid
 
 void ReconstructionEngine_sequentialSfM::createInitialReconstruction(const std::vector<Pair>& initialImagePairCandidates)
 {
+  ALICEVISION_TRACE_ZONE("sfm::createInitialReconstruction");
   // initial pair Essential Matrix and [R|t] estimation.
   for(const auto& initialPairCandidate: initialImagePairCandidates)
   {
@@ -436,6 +441,7 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
     // compute robust resection of remaining images
     while(findNextBestViews(bestViewCandidates, remainingViewIds))
     {
+      ALICEVISION_TRACE_ZONE("sfm::iteration");
       ALICEVISION_LOG_INFO("Update Reconstruction:" << std::endl
         << "\t- resection id: " << resectionId << std::endl
         << "\t- # images in the resection group: " << bestViewCandidates.size() << std::endl
@@ -506,6 +512,7 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
                                                                 const std::set<IndexT>& prevReconstructedViews,
                                                                 std::set<IndexT>& remainingViewIds)
 {
+  ALICEVISION_TRACE_ZONE("sfm::resection");
   auto chrono_start = std::chrono::steady_clock::now();
 
   // add images to the 3D reconstruction
@@ -594,6 +601,7 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
 
 void ReconstructionEngine_sequentialSfM::triangulate(const std::set<IndexT>& prevReconstructedViews, const std::set<IndexT>& newReconstructedViews)
 {
+  ALICEVISION_TRACE_ZONE("sfm::triangulate");
   auto chrono_start = std::chrono::steady_clock::now();
 
   // allow to use to the old triangulatation algorithm (using 2 views only)
@@ -607,6 +615,7 @@ void ReconstructionEngine_sequentialSfM::triangulate(const std::set<IndexT>& pre
 
 bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newReconstructedViews, bool isInitialPair)
 {
+  ALICEVISION_TRACE_ZONE("sfm::bundleAdjustment");
   ALICEVISION_LOG_INFO("Bundle adjustment start.");
   auto chronoStart = std::chrono::steady_clock::now();
 
@@ -644,7 +653,7 @@ bool ReconstructionEngine_sequentialSfM::bundleAdjustment(std::set<IndexT>& newR
     _localStrategyGraph->computeGraphDistances(_sfmData, newReconstructedViews);
 
     // use the graph-distances to assign a state (Refine, Constant & Ignore) for each parameter (poses, intrinsics & landmarks)
-    _localStrategyGraph->convertDistancesToStates(_sfmData);
+    _localStrategyGraph->convertDistancesToStates(_sfmData, _map_tracksPerView);
 
     const std::size_t nbRefinedPoses = _localStrategyGraph->getNbPosesPerState(BundleAdjustment::EParameterState::REFINED);
     const std::size_t nbConstantPoses = _localStrategyGraph->getNbPosesPerState(BundleAdjustment::EParameterState::CONSTANT);
@@ -736,11 +745,14 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
     ALICEVISION_LOG_INFO(" - # " << EImageDescriberType_enumToString(d.first) << ": " << d.second);
   }
 
+  // landmarks table shared by the statistics below
+  const sfmData::LandmarksTable landmarksTable(_sfmData.getLandmarks());
+
   // residual histogram
   utils::Histogram<double> residualHistogram;
   {
       BoxStats<double> residualStats;
-      computeResidualsHistogram(_sfmData, residualStats, &residualHistogram);
+      computeResidualsHistogram(_sfmData, landmarksTable, residualStats, &residualHistogram);
       ALICEVISION_LOG_DEBUG(
         "\t- # Landmarks: " << _sfmData.getLandmarks().size() << std::endl <<
         "\t- Residual min: " << residualStats.min << std::endl <<
@@ -757,7 +769,7 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
   {
       BoxStats<double> observationsLengthStats;
       int overallNbObservations = 0;
-      computeObservationsLengthsHistogram(_sfmData, observationsLengthStats, overallNbObservations, &observationsLengthHistogram);
+      computeObservationsLengthsHistogram(landmarksTable, observationsLengthStats, overallNbObservations, &observationsLengthHistogram);
       ALICEVISION_LOG_INFO("# landmarks: " << _sfmData.getLandmarks().size());
       ALICEVISION_LOG_INFO("# overall observations: " << overallNbObservations);
       ALICEVISION_LOG_INFO("Landmarks observations length min: " << observationsLengthStats.min << ", mean: " << observationsLengthStats.mean << ", median: " << observationsLengthStats.median << ", max: "  << observationsLengthStats.max);
@@ -768,7 +780,7 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
   utils::Histogram<double> landmarksPerViewHistogram;
   {
       BoxStats<double> landmarksPerViewStats;
-      computeLandmarksPerViewHistogram(_sfmData, landmarksPerViewStats, &landmarksPerViewHistogram);
+      computeLandmarksPerViewHistogram(landmarksTable, landmarksPerViewStats, &landmarksPerViewHistogram);
       ALICEVISION_LOG_INFO("Landmarks per view min: " << landmarksPerViewStats.min << ", mean: " << landmarksPerViewStats.mean << ", median: " << landmarksPerViewStats.median << ", max: " << landmarksPerViewStats.max);
       ALICEVISION_LOG_INFO("Histogram of nb landmarks per view:" << landmarksPerViewHistogram.ToString<int>("", 3));
   }
@@ -938,6 +950,7 @@ bool ReconstructionEngine_sequentialSfM::findNextBestViews(
   std::vector<IndexT> & out_selectedViewIds,
   const std::set<IndexT>& remainingViewIds) const
 {
+  ALICEVISION_TRACE_ZONE("sfm::findNextBestViews");
   out_selectedViewIds.clear();
   auto chrono_start = std::chrono::steady_clock::now();
   std::vector<ViewConnectionScore> vec_viewsScore;
@@ -2006,8 +2019,21 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene, cons
 
 std::size_t ReconstructionEngine_sequentialSfM::removeOutliers()
 {
-  const std::size_t nbOutliersResidualErr = RemoveOutliers_PixelResidualError(_sfmData, _params.featureConstraint, _params.maxReprojectionError, 2);
-  const std::size_t nbOutliersAngleErr = RemoveOutliers_AngleError(_sfmData, _params.minAngleForLandmark);
+  ALICEVISION_TRACE_ZONE("sfm::removeOutliers");
+
+  // evaluate all the observations once, for the statistics and both filters
+  const sfmData::LandmarksTable landmarksTable(_sfmData.getLandmarks());
+  const ObservationsResiduals residuals(_sfmData, landmarksTable);
+  {
+    BoxStats<double> residualStats;
+    computeResidualsHistogram(residuals, residualStats, nullptr);
+    ALICEVISION_LOG_DEBUG("Residuals before outliers removal: min: " << residualStats.min << ", mean: " << residualStats.mean << ", median: " << residualStats.median << ", max: " << residualStats.max);
+  }
+
+  OutliersMask outliers(landmarksTable);
+  const std::size_t nbOutliersResidualErr = findOutliers_PixelResidualError(residuals, _params.featureConstraint, _params.maxReprojectionError, 2, outliers);
+  const std::size_t nbOutliersAngleErr = findOutliers_AngleError(residuals, _params.minAngleForLandmark, outliers);
+  eraseOutliers(_sfmData, landmarksTable, outliers);
 
   ALICEVISION_LOG_INFO("Remove outliers: " << std::endl
                         << "\t- # outliers residual error: " << nbOutliersResidualErr << std::endl
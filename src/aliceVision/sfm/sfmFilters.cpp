@@ -7,81 +7,110 @@
 
 #include "sfmFilters.hpp"
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksTable.hpp>
 #include <aliceVision/stl/stl.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
+#include <aliceVision/sfm/sfmResiduals.hpp>
 
+#include <algorithm>
 #include <iterator>
+#include <stdexcept>
 
 namespace aliceVision {
 namespace sfm {
 
-IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
-                                         EFeatureConstraint featureConstraint,
-                                         const double dThresholdPixel,
-                                         const unsigned int minTrackLength)
+OutliersMask::OutliersMask(const sfmData::LandmarksTable& landmarksTable)
+  : observations(landmarksTable.getNbObservations(), 0)
+  , landmarks(landmarksTable.getNbLandmarks(), 0)
+{}
+
+IndexT findOutliers_PixelResidualError(const ObservationsResiduals& residuals,
+                                       EFeatureConstraint featureConstraint,
+                                       const double dThresholdPixel,
+                                       const unsigned int minTrackLength,
+                                       OutliersMask& outliers)
 {
-  IndexT outlier_count = 0;
-  sfmData::Landmarks::iterator iterTracks = sfmData.structure.begin();
+  if(!residuals.hasColumns(ObservationsResiduals::RESIDUALS | ObservationsResiduals::DEPTHS))
+    throw std::invalid_argument("findOutliers_PixelResidualError: the residuals and the depths of the observations are required.");
 
+  const sfmData::LandmarksTable& landmarksTable = residuals.getLandmarksTable();
+  const std::vector<double>& obsResiduals = residuals.getResiduals();
+  const std::vector<double>& obsDepths = residuals.getDepths();
+  const std::vector<double>& obsScales = landmarksTable.getObservationScales();
+
+  IndexT outlier_count = 0;
 
-  while(iterTracks != sfmData.structure.end())
+  #pragma omp parallel for reduction(+:outlier_count)
+  for(int landmarkIndex = 0; landmarkIndex < landmarksTable.getNbLandmarks(); ++landmarkIndex)
   {
-    sfmData::Observations & observations = iterTracks->second.observations;
-    sfmData::Observations::iterator itObs = observations.begin();
+    if(outliers.landmarks[landmarkIndex])
+      continue;
 
-    while(itObs != observations.end())
+    std::size_t nbInliers = 0;
+    for(std::size_t obsIndex = landmarksTable.getObservationsBegin(landmarkIndex); obsIndex < landmarksTable.getObservationsEnd(landmarkIndex); ++obsIndex)
     {
-      const sfmData::View * view = sfmData.views.at(itObs->first).get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const camera::IntrinsicBase * intrinsic = sfmData.intrinsics.at(view->getIntrinsicId()).get();
+      if(outliers.observations[obsIndex])
+        continue;
 
-      Vec2 residual = intrinsic->residual(pose, iterTracks->second.X, itObs->second.x);
-      if(featureConstraint == EFeatureConstraint::SCALE && itObs->second.scale > 0.0)
+      double residual = obsResiduals[obsIndex];
+      if(featureConstraint == EFeatureConstraint::SCALE && obsScales[obsIndex] > 0.0)
       {
           // Apply the scale of the feature to get a residual value
           // relative to the feature precision.
-          residual /= itObs->second.scale;
+          residual /= obsScales[obsIndex];
       }
 
-      if((pose.depth(iterTracks->second.X) < 0) || (residual.norm() > dThresholdPixel))
+      if((obsDepths[obsIndex] < 0) || (residual > dThresholdPixel))
       {
         ++outlier_count;
-        itObs = observations.erase(itObs);
+        outliers.observations[obsIndex] = 1;
       }
       else
-        ++itObs;
+        ++nbInliers;
     }
 
-    if (observations.empty() || observations.size() < minTrackLength)
-      iterTracks = sfmData.structure.erase(iterTracks);
-    else
-      ++iterTracks;
+    if(nbInliers == 0 || nbInliers < minTrackLength)
+      outliers.landmarks[landmarkIndex] = 1;
   }
   return outlier_count;
 }
 
-IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle)
+IndexT findOutliers_AngleError(const ObservationsResiduals& residuals, const double dMinAcceptedAngle, OutliersMask& outliers)
 {
   // note that smallest accepted angle => largest accepted cos(angle)
   const double dMaxAcceptedCosAngle = std::cos(degreeToRadian(dMinAcceptedAngle));
 
-  using LandmarksKeysVec = std::vector<sfmData::Landmarks::key_type>;
-  LandmarksKeysVec v_keys; v_keys.reserve(sfmData.structure.size());
-  std::transform(sfmData.structure.cbegin(), sfmData.structure.cend(), std::back_inserter(v_keys), stl::RetrieveKey());
+  if(!residuals.hasColumns(ObservationsResiduals::BEARING_VECTORS))
+    throw std::invalid_argument("findOutliers_AngleError: the bearing vectors of the observations are required.");
 
-  LandmarksKeysVec toErase;
+  const sfmData::LandmarksTable& landmarksTable = residuals.getLandmarksTable();
+  const Mat3X& bearingVectors = residuals.getBearingVectors();
 
-  #pragma omp parallel for
-  for (int landmarkIndex = 0; landmarkIndex < v_keys.size(); ++landmarkIndex)
+  IndexT outlier_count = 0;
+
+  #pragma omp parallel for reduction(+:outlier_count)
+  for (int landmarkIndex = 0; landmarkIndex < landmarksTable.getNbLandmarks(); ++landmarkIndex)
   {
-    const sfmData::Observations &observations = sfmData.structure.at(v_keys[landmarkIndex]).observations;
+    if(outliers.landmarks[landmarkIndex])
+      continue;
+
+    const std::size_t obsBegin = landmarksTable.getObservationsBegin(landmarkIndex);
+    const std::size_t obsEnd = landmarksTable.getObservationsEnd(landmarkIndex);
 
     // create matrix for observation directions from camera to point
-    Mat3X viewDirections(3, observations.size());
-    Mat3X::Index i;
-    sfmData::Observations::const_iterator itObs;
-    
+    Mat3X viewDirections(3, obsEnd - obsBegin);
+    Mat3X::Index i = 0;
+    for(std::size_t obsIndex = obsBegin; obsIndex < obsEnd; ++obsIndex)
+    {
+      if(!outliers.observations[obsIndex])
+        viewDirections.col(i++) = bearingVectors.col(obsIndex);
+    }
+    const Mat3X::Index nbDirections = i;
+
+    if(nbDirections == 0)
+      continue;
+
     // Greedy algorithm almost always finds an acceptable angle in 1-5 iterations (if it exists).
     // It works by greedily chasing the first larger view angle found from the current greedy index.
     // View angles have a spatial distribution, so greedily jumping over larger and larger angles
@@ -89,16 +118,9 @@ IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcc
     double dGreedyCos = 1.1;
     Mat3X::Index greedyI = 0;
 
-
-    // fill matrix, optimistically checking each new entry against col(greedyI)
-    for(itObs = observations.begin(), i = 0; itObs != observations.end(); ++itObs, ++i)
+    // optimistically check each entry against col(greedyI)
+    for(i = 0; i < nbDirections; ++i)
     {
-      const sfmData::View * view = sfmData.views.at(itObs->first).get();
-      const geometry::Pose3 pose = sfmData.getPose(*view).getTransform();
-      const camera::IntrinsicBase * intrinsic = sfmData.intrinsics.at(view->getIntrinsicId()).get();
-
-      viewDirections.col(i) = applyIntrinsicExtrinsic(pose, intrinsic, itObs->second.x);
-
       double dCosAngle = viewDirections.col(i).transpose() * viewDirections.col(greedyI);
       if (dCosAngle < dMaxAcceptedCosAngle)
       {
@@ -112,7 +134,7 @@ IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcc
     }
 
     // early exit, acceptable angle found
-    if (itObs != observations.end())
+    if (i != nbDirections)
     {
       continue;
     }
@@ -126,7 +148,7 @@ IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcc
     //     all view directions as considered as early as possible,
     //     making it difficult for a small angle to hide between views.
     //
-    for(i = viewDirections.cols() - 1; i > 0; i -= 1)
+    for(i = nbDirections - 1; i > 0; i -= 1)
     {
       // Compute and find minimum cosAngle between viewDirections[i] and all viewDirections[0:i].
       // Single statement can allow Eigen optimizations
@@ -139,23 +161,79 @@ IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcc
     // acceptable angle not found
     if (i == 0)
     {
-      #pragma omp critical
-      toErase.push_back(v_keys[landmarkIndex]);
+      outliers.landmarks[landmarkIndex] = 1;
+      ++outlier_count;
     }
   }
 
-  for (IndexT key : toErase)
+  return outlier_count;
+}
+
+void eraseOutliers(sfmData::SfMData& sfmData, const sfmData::LandmarksTable& landmarksTable, const OutliersMask& outliers)
+{
+  const std::vector<IndexT>& landmarkIds = landmarksTable.getLandmarkIds();
+  const std::vector<IndexT>& obsViewIds = landmarksTable.getObservationViewIds();
+
+  // kept landmarks with outlier observations
+  std::vector<std::pair<std::size_t, sfmData::Landmark*>> landmarksToCompact;
+  for(std::size_t landmarkIndex = 0; landmarkIndex < landmarkIds.size(); ++landmarkIndex)
+  {
+    if(outliers.landmarks[landmarkIndex])
+      continue;
+    const auto obsBegin = outliers.observations.begin() + landmarksTable.getObservationsBegin(landmarkIndex);
+    const auto obsEnd = outliers.observations.begin() + landmarksTable.getObservationsEnd(landmarkIndex);
+    if(std::find(obsBegin, obsEnd, 1) != obsEnd)
+      landmarksToCompact.emplace_back(landmarkIndex, &sfmData.structure.at(landmarkIds[landmarkIndex]));
+  }
+
+  // each landmark has its own observations, they are compacted in parallel
+  #pragma omp parallel for
+  for(int i = 0; i < landmarksToCompact.size(); ++i)
   {
-    sfmData.structure.erase(key);
+    const std::size_t landmarkIndex = landmarksToCompact[i].first;
+    sfmData::Observations& observations = landmarksToCompact[i].second->observations;
+    for(std::size_t obsIndex = landmarksTable.getObservationsBegin(landmarkIndex); obsIndex < landmarksTable.getObservationsEnd(landmarkIndex); ++obsIndex)
+    {
+      if(outliers.observations[obsIndex])
+        observations.erase(obsViewIds[obsIndex]);
+    }
   }
 
-  return toErase.size();
+  for(std::size_t landmarkIndex = 0; landmarkIndex < landmarkIds.size(); ++landmarkIndex)
+  {
+    if(outliers.landmarks[landmarkIndex])
+      sfmData.structure.erase(landmarkIds[landmarkIndex]);
+  }
+}
+
+IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
+                                         EFeatureConstraint featureConstraint,
+                                         const double dThresholdPixel,
+                                         const unsigned int minTrackLength)
+{
+  const sfmData::LandmarksTable landmarksTable(sfmData.structure);
+  const ObservationsResiduals residuals(sfmData, landmarksTable, ObservationsResiduals::RESIDUALS | ObservationsResiduals::DEPTHS);
+  OutliersMask outliers(landmarksTable);
+
+  const IndexT outlier_count = findOutliers_PixelResidualError(residuals, featureConstraint, dThresholdPixel, minTrackLength, outliers);
+  eraseOutliers(sfmData, landmarksTable, outliers);
+  return outlier_count;
+}
+
+IndexT RemoveOutliers_AngleError(sfmData::SfMData& sfmData, const double dMinAcceptedAngle)
+{
+  const sfmData::LandmarksTable landmarksTable(sfmData.structure);
+  const ObservationsResiduals residuals(sfmData, landmarksTable, ObservationsResiduals::BEARING_VECTORS);
+  OutliersMask outliers(landmarksTable);
+
+  const IndexT outlier_count = findOutliers_AngleError(residuals, dMinAcceptedAngle, outliers);
+  eraseOutliers(sfmData, landmarksTable, outliers);
+  return outlier_count;
 }
 
 bool eraseUnstablePoses(sfmData::SfMData& sfmData, const IndexT min_points_per_pose, std::set<IndexT>* outRemovedViewsId)
 {
   IndexT removed_elements = 0;
-  const sfmData::Landmarks & landmarks = sfmData.structure;
 
   // Count the observation poses occurrence
   HashMap<IndexT, IndexT> posesCount;
@@ -164,22 +242,24 @@ bool eraseUnstablePoses(sfmData::SfMData& sfmData, const IndexT min_points_per_p
   for(sfmData::Poses::const_iterator itPoses = sfmData.getPoses().begin(); itPoses != sfmData.getPoses().end(); ++itPoses)
     posesCount[itPoses->first] = 0;
 
-  // Count occurrence of the poses in the Landmark observations
-  for(sfmData::Landmarks::const_iterator itLandmarks = landmarks.begin(); itLandmarks != landmarks.end(); ++itLandmarks)
+  // Count the observations of each view, then the occurrence of the poses in the Landmark observations
+  HashMap<IndexT, IndexT> viewsCount;
+  for(const auto& landmarkPair : sfmData.structure)
   {
-    const sfmData::Observations & observations = itLandmarks->second.observations;
-    for(sfmData::Observations::const_iterator itObs = observations.begin(); itObs != observations.end(); ++itObs)
-    {
-      const IndexT viewId = itObs->first;
-      const sfmData::View * v = sfmData.getViews().at(viewId).get();
-      const auto poseInfoIt = posesCount.find(v->getPoseId());
-
-      if(poseInfoIt != posesCount.end())
-        poseInfoIt->second++;
-      else // all pose should be defined in map_PoseId_Count
-        throw std::runtime_error(std::string("eraseUnstablePoses: found unknown pose id referenced by a view.\n\t- view id: ")
-                                 + std::to_string(v->getViewId()) + std::string("\n\t- pose id: ") + std::to_string(v->getPoseId()));
-    }
+    for(const auto& observationPair : landmarkPair.second.observations)
+      ++viewsCount[observationPair.first];
+  }
+
+  for(const auto& viewCount : viewsCount)
+  {
+    const sfmData::View * v = sfmData.getViews().at(viewCount.first).get();
+    const auto poseInfoIt = posesCount.find(v->getPoseId());
+
+    if(poseInfoIt != posesCount.end())
+      poseInfoIt->second += viewCount.second;
+    else // all pose should be defined in map_PoseId_Count
+      throw std::runtime_error(std::string("eraseUnstablePoses: found unknown pose id referenced by a view.\n\t- view id: ")
+                               + std::to_string(v->getViewId()) + std::string("\n\t- pose id: ") + std::to_string(v->getPoseId()));
   }
 
   // If usage count is smaller than the threshold, remove the Pose
@@ -10,14 +10,19 @@
 #include <aliceVision/types.hpp>
 #include <aliceVision/sfm/BundleAdjustment.hpp>
 
+#include <vector>
+
 namespace aliceVision {
 
 namespace sfmData {
 class SfMData;
+class LandmarksTable;
 } // namespace sfmData
 
 namespace sfm {
 
+class ObservationsResiduals;
+
 /// Filter a list of pair: Keep only the pair that are defined in index list
 template <typename IterablePairs, typename IterableIndex>
 inline PairSet Pair_filter(const IterablePairs& pairs, const IterableIndex& index)
@@ -31,6 +36,36 @@ inline PairSet Pair_filter(const IterablePairs& pairs, const IterableIndex& inde
   return kept_pairs;
 }
 
+/// Observations and landmarks of a landmarks table to remove from the scene
+struct OutliersMask
+{
+  explicit OutliersMask(const sfmData::LandmarksTable& landmarksTable);
+
+  /// non zero for the observations to remove, indexed by observation index in the table
+  std::vector<char> observations;
+  /// non zero for the landmarks to remove, indexed by landmark index in the table
+  std::vector<char> landmarks;
+};
+
+/// Mark the observations with too large reprojection error or behind the camera,
+/// and the landmarks left with less than minTrackLength observations.
+/// The residuals need the RESIDUALS and DEPTHS columns.
+/// Return the number of outlier observations.
+IndexT findOutliers_PixelResidualError(const ObservationsResiduals& residuals,
+                                       EFeatureConstraint featureConstraint,
+                                       const double dThresholdPixel,
+                                       const unsigned int minTrackLength,
+                                       OutliersMask& outliers);
+
+/// Mark the landmarks whose remaining observations have a small angle.
+/// The residuals need the BEARING_VECTORS column.
+/// Return the number of outlier landmarks.
+IndexT findOutliers_AngleError(const ObservationsResiduals& residuals, const double dMinAcceptedAngle, OutliersMask& outliers);
+
+/// Erase the outliers from the scene in one batch.
+/// The landmarks table has to be built from the current landmarks of the scene.
+void eraseOutliers(sfmData::SfMData& sfmData, const sfmData::LandmarksTable& landmarksTable, const OutliersMask& outliers);
+
 /// Remove observations with too large reprojection error.
 /// Return the number of removed tracks.
 IndexT RemoveOutliers_PixelResidualError(sfmData::SfMData& sfmData,
@@ -0,0 +1,292 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/sfmFilters.hpp>
+#include <aliceVision/sfm/sfmResiduals.hpp>
+#include <aliceVision/sfmData/LandmarksTable.hpp>
+#include <aliceVision/camera/cameraCommon.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+#define BOOST_TEST_MODULE sfmFilters
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::camera;
+using namespace aliceVision::geometry;
+using namespace aliceVision::sfm;
+using namespace aliceVision::sfmData;
+
+namespace {
+
+/**
+ * @brief Synthetic scene with outliers:
+ *  - observations with a large reprojection error,
+ *  - landmarks with only one valid observation,
+ *  - observations of landmarks behind the camera,
+ *  - far landmarks seen with a small angle.
+ * The landmark ids are not contiguous.
+ */
+SfMData getSceneWithOutliers()
+{
+  const int nviews = 6;
+  const int npoints = 300;
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+  SfMData sfmData;
+  for(int i = 0; i < nviews; ++i)
+  {
+    sfmData.views[i] = std::make_shared<View>("", i, 0, i, config._cx * 2, config._cy * 2);
+    sfmData.setPose(*sfmData.views.at(i), CameraPose(Pose3(d._R[i], d._C[i])));
+  }
+  sfmData.intrinsics[0] = createIntrinsic(EINTRINSIC::PINHOLE_CAMERA_RADIAL3, config._cx * 2, config._cy * 2, config._fx, config._cx, config._cy);
+  const IntrinsicBase* intrinsic = sfmData.intrinsics.at(0).get();
+
+  for(int i = 0; i < npoints; ++i)
+  {
+    Landmark landmark;
+    landmark.X = d._X.col(i);
+    for(int j = 0; j < nviews; ++j)
+    {
+      Vec2 pt = d._x[j].col(i);
+      // small deterministic noise, and the scales of the features
+      pt(0) += 0.3 * std::sin(i + j);
+      pt(1) += 0.3 * std::cos(i * j);
+      const double scale = (i % 4 == 0) ? 0.0 : 1.0 + (i + j) % 3;
+
+      if(i % 5 == 0 && j == i % nviews)
+        pt(0) += 10.0 + i % 7; // one outlier observation
+      if(i % 11 == 0 && j != 0)
+        pt(1) += 20.0;         // a single valid observation
+      landmark.observations[j] = Observation(pt, i, scale);
+    }
+    sfmData.structure[3 * i + 1] = landmark;
+  }
+
+  // landmarks behind a camera, with a perfect projection in this camera
+  for(int i = 0; i < 10; ++i)
+  {
+    const Pose3 pose = sfmData.getPose(*sfmData.views.at(i % nviews)).getTransform();
+    Landmark landmark;
+    landmark.X = pose.center() - pose.rotation().transpose() * Vec3(0.1 * i, -0.05 * i, 2.0);
+    for(int j = 0; j < nviews; ++j)
+    {
+      const Pose3 viewPose = sfmData.getPose(*sfmData.views.at(j)).getTransform();
+      landmark.observations[j] = Observation(intrinsic->project(viewPose, landmark.X), 1000 + i, 1.0);
+    }
+    sfmData.structure[10000 + i] = landmark;
+  }
+
+  // far landmarks, seen by a few close views with a small angle
+  for(int i = 0; i < 20; ++i)
+  {
+    const Pose3 pose = sfmData.getPose(*sfmData.views.at(0)).getTransform();
+    Landmark landmark;
+    landmark.X = pose.center() + pose.rotation().transpose() * Vec3(0.02 * i, 0.01 * i, 1000.0 * (i + 1));
+    for(int j = 0; j < 2 + i % 3; ++j)
+    {
+      const Pose3 viewPose = sfmData.getPose(*sfmData.views.at(j)).getTransform();
+      landmark.observations[j] = Observation(intrinsic->project(viewPose, landmark.X), 2000 + i, 1.0);
+    }
+    sfmData.structure[20000 + i] = landmark;
+  }
+  return sfmData;
+}
+
+/// previous pixel residual filter, one landmark after the other
+IndexT referencePixelResidualError(SfMData& sfmData, EFeatureConstraint featureConstraint, double dThresholdPixel, unsigned int minTrackLength)
+{
+  IndexT outlier_count = 0;
+  Landmarks::iterator iterTracks = sfmData.structure.begin();
+  while(iterTracks != sfmData.structure.end())
+  {
+    Observations& observations = iterTracks->second.observations;
+    Observations::iterator itObs = observations.begin();
+    while(itObs != observations.end())
+    {
+      const View* view = sfmData.views.at(itObs->first).get();
+      const Pose3 pose = sfmData.getPose(*view).getTransform();
+      const IntrinsicBase* intrinsic = sfmData.intrinsics.at(view->getIntrinsicId()).get();
+
+      Vec2 residual = intrinsic->residual(pose, iterTracks->second.X, itObs->second.x);
+      if(featureConstraint == EFeatureConstraint::SCALE && itObs->second.scale > 0.0)
+        residual /= itObs->second.scale;
+
+      if((pose.depth(iterTracks->second.X) < 0) || (residual.norm() > dThresholdPixel))
+      {
+        ++outlier_count;
+        itObs = observations.erase(itObs);
+      }
+      else
+        ++itObs;
+    }
+
+    if(observations.empty() || observations.size() < minTrackLength)
+      iterTracks = sfmData.structure.erase(iterTracks);
+    else
+      ++iterTracks;
+  }
+  return outlier_count;
+}
+
+/// previous angle filter, exhaustive search on each landmark
+IndexT referenceAngleError(SfMData& sfmData, double dMinAcceptedAngle)
+{
+  const double dMaxAcceptedCosAngle = std::cos(degreeToRadian(dMinAcceptedAngle));
+  std::vector<IndexT> toErase;
+  for(const auto& landmarkPair : sfmData.structure)
+  {
+    const Observations& observations = landmarkPair.second.observations;
+    std::vector<Vec3> viewDirections;
+    for(const auto& obsPair : observations)
+    {
+      const View* view = sfmData.views.at(obsPair.first).get();
+      const Pose3 pose = sfmData.getPose(*view).getTransform();
+      const IntrinsicBase* intrinsic = sfmData.intrinsics.at(view->getIntrinsicId()).get();
+      viewDirections.push_back(applyIntrinsicExtrinsic(pose, intrinsic, obsPair.second.x));
+    }
+
+    bool acceptableAngle = false;
+    for(std::size_t i = 0; i < viewDirections.size() && !acceptableAngle; ++i)
+      for(std::size_t j = 0; j < i && !acceptableAngle; ++j)
+        acceptableAngle = viewDirections[i].dot(viewDirections[j]) < dMaxAcceptedCosAngle;
+
+    if(!acceptableAngle)
+      toErase.push_back(landmarkPair.first);
+  }
+  for(IndexT landmarkId : toErase)
+    sfmData.structure.erase(landmarkId);
+  return toErase.size();
+}
+
+void checkSameStructure(const SfMData& a, const SfMData& b)
+{
+  BOOST_REQUIRE_EQUAL(a.structure.size(), b.structure.size());
+  for(const auto& landmarkPair : a.structure)
+  {
+    BOOST_REQUIRE(b.structure.count(landmarkPair.first));
+    const Landmark& landmarkB = b.structure.at(landmarkPair.first);
+    BOOST_CHECK(landmarkPair.second.X == landmarkB.X);
+    BOOST_REQUIRE_EQUAL(landmarkPair.second.observations.size(), landmarkB.observations.size());
+    for(const auto& obsPair : landmarkPair.second.observations)
+    {
+      BOOST_REQUIRE(landmarkB.observations.count(obsPair.first));
+      BOOST_CHECK(obsPair.second == landmarkB.observations.at(obsPair.first));
+    }
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(sfmFilters_pixelResidualError)
+{
+  const SfMData scene = getSceneWithOutliers();
+
+  for(EFeatureConstraint featureConstraint : {EFeatureConstraint::BASIC, EFeatureConstraint::SCALE})
+  {
+    for(unsigned int minTrackLength : {2, 3})
+    {
+      SfMData sfmReference = scene;
+      const IndexT nbOutliersReference = referencePixelResidualError(sfmReference, featureConstraint, 4.0, minTrackLength);
+      BOOST_CHECK_GT(nbOutliersReference, 0);
+      BOOST_CHECK_LT(sfmReference.structure.size(), scene.structure.size());
+
+      SfMData sfmRemoved = scene;
+      BOOST_CHECK_EQUAL(RemoveOutliers_PixelResidualError(sfmRemoved, featureConstraint, 4.0, minTrackLength), nbOutliersReference);
+      checkSameStructure(sfmRemoved, sfmReference);
+
+      // the masks, with only the needed columns
+      SfMData sfmMasked = scene;
+      const LandmarksTable landmarksTable(sfmMasked.structure);
+      const ObservationsResiduals residuals(sfmMasked, landmarksTable, ObservationsResiduals::RESIDUALS | ObservationsResiduals::DEPTHS);
+      OutliersMask outliers(landmarksTable);
+      BOOST_CHECK_EQUAL(findOutliers_PixelResidualError(residuals, featureConstraint, 4.0, minTrackLength, outliers), nbOutliersReference);
+
+      // the masked landmarks are the ones erased by the previous filter
+      for(std::size_t landmarkIndex = 0; landmarkIndex < landmarksTable.getNbLandmarks(); ++landmarkIndex)
+        BOOST_CHECK_EQUAL(outliers.landmarks[landmarkIndex] != 0, sfmReference.structure.count(landmarksTable.getLandmarkIds()[landmarkIndex]) == 0);
+
+      eraseOutliers(sfmMasked, landmarksTable, outliers);
+      checkSameStructure(sfmMasked, sfmReference);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sfmFilters_angleError)
+{
+  const SfMData scene = getSceneWithOutliers();
+
+  for(double minAngle : {0.5, 2.0, 10.0})
+  {
+    SfMData sfmReference = scene;
+    const IndexT nbOutliersReference = referenceAngleError(sfmReference, minAngle);
+    BOOST_CHECK_GT(nbOutliersReference, 0);
+
+    SfMData sfmRemoved = scene;
+    BOOST_CHECK_EQUAL(RemoveOutliers_AngleError(sfmRemoved, minAngle), nbOutliersReference);
+    checkSameStructure(sfmRemoved, sfmReference);
+
+    SfMData sfmMasked = scene;
+    const LandmarksTable landmarksTable(sfmMasked.structure);
+    const ObservationsResiduals residuals(sfmMasked, landmarksTable, ObservationsResiduals::BEARING_VECTORS);
+    OutliersMask outliers(landmarksTable);
+    BOOST_CHECK_EQUAL(findOutliers_AngleError(residuals, minAngle, outliers), nbOutliersReference);
+    eraseOutliers(sfmMasked, landmarksTable, outliers);
+    checkSameStructure(sfmMasked, sfmReference);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sfmFilters_pixelThenAngleError)
+{
+  // one table for both filters, as in the sequential reconstruction:
+  // the angle filter only considers the observations kept by the pixel filter
+  const SfMData scene = getSceneWithOutliers();
+
+  SfMData sfmReference = scene;
+  const IndexT nbPixelOutliers = referencePixelResidualError(sfmReference, EFeatureConstraint::BASIC, 4.0, 2);
+  const IndexT nbAngleOutliers = referenceAngleError(sfmReference, 2.0);
+  BOOST_CHECK_GT(nbAngleOutliers, 0);
+
+  SfMData sfmMasked = scene;
+  const LandmarksTable landmarksTable(sfmMasked.structure);
+  const ObservationsResiduals residuals(sfmMasked, landmarksTable);
+  OutliersMask outliers(landmarksTable);
+  BOOST_CHECK_EQUAL(findOutliers_PixelResidualError(residuals, EFeatureConstraint::BASIC, 4.0, 2, outliers), nbPixelOutliers);
+  BOOST_CHECK_EQUAL(findOutliers_AngleError(residuals, 2.0, outliers), nbAngleOutliers);
+  eraseOutliers(sfmMasked, landmarksTable, outliers);
+  checkSameStructure(sfmMasked, sfmReference);
+}
+
+BOOST_AUTO_TEST_CASE(sfmFilters_residualsColumns)
+{
+  const SfMData scene = getSceneWithOutliers();
+  const LandmarksTable landmarksTable(scene.structure);
+
+  const ObservationsResiduals allColumns(scene, landmarksTable);
+  const ObservationsResiduals residualsOnly(scene, landmarksTable, ObservationsResiduals::RESIDUALS);
+  const ObservationsResiduals bearingVectorsOnly(scene, landmarksTable, ObservationsResiduals::BEARING_VECTORS);
+
+  BOOST_CHECK(allColumns.hasColumns(ObservationsResiduals::ALL_COLUMNS));
+  BOOST_CHECK(residualsOnly.hasColumns(ObservationsResiduals::RESIDUALS));
+  BOOST_CHECK(!residualsOnly.hasColumns(ObservationsResiduals::RESIDUALS | ObservationsResiduals::DEPTHS));
+
+  // the columns which are not requested are not computed
+  BOOST_CHECK(residualsOnly.getDepths().empty());
+  BOOST_CHECK_EQUAL(residualsOnly.getBearingVectors().cols(), 0);
+  BOOST_CHECK(bearingVectorsOnly.getResiduals().empty());
+  BOOST_CHECK(residualsOnly.getResiduals() == allColumns.getResiduals());
+  BOOST_CHECK(bearingVectorsOnly.getBearingVectors() == allColumns.getBearingVectors());
+
+  // the filters refuse residuals without the columns they need
+  OutliersMask outliers(landmarksTable);
+  BOOST_CHECK_THROW(findOutliers_PixelResidualError(residualsOnly, EFeatureConstraint::BASIC, 4.0, 2, outliers), std::invalid_argument);
+  BOOST_CHECK_THROW(findOutliers_AngleError(residualsOnly, 2.0, outliers), std::invalid_argument);
+  BOOST_CHECK_THROW(findOutliers_PixelResidualError(bearingVectorsOnly, EFeatureConstraint::BASIC, 4.0, 2, outliers), std::invalid_argument);
+}
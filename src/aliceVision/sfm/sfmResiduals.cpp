@@ -0,0 +1,68 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "sfmResiduals.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Tracer.hpp>
+
+namespace aliceVision {
+namespace sfm {
+
+ObservationsResiduals::ObservationsResiduals(const sfmData::SfMData& sfmData, const sfmData::LandmarksTable& landmarksTable, int columns)
+  : _landmarksTable(landmarksTable)
+  , _columns(columns)
+{
+  ALICEVISION_TRACE_ZONE("sfm::ObservationsResiduals");
+
+  // pose and intrinsic of each view, found once per view
+  const std::vector<IndexT>& viewIds = landmarksTable.getViewIds();
+  std::vector<geometry::Pose3> viewsPoses(viewIds.size());
+  std::vector<const camera::IntrinsicBase*> viewsIntrinsics(viewIds.size());
+
+  for(std::size_t viewIndex = 0; viewIndex < viewIds.size(); ++viewIndex)
+  {
+    const sfmData::View& view = sfmData.getView(viewIds[viewIndex]);
+    viewsPoses[viewIndex] = sfmData.getPose(view).getTransform();
+    viewsIntrinsics[viewIndex] = sfmData.getIntrinsics().at(view.getIntrinsicId()).get();
+  }
+
+  const std::size_t nbObservations = landmarksTable.getNbObservations();
+  const std::vector<IndexT>& obsViewIndexes = landmarksTable.getObservationViewIndexes();
+  const std::vector<IndexT>& obsLandmarkIndexes = landmarksTable.getObservationLandmarkIndexes();
+  const Mat3X& positions = landmarksTable.getPositions();
+  const Mat2X& obsPoints = landmarksTable.getObservationPoints();
+
+  const bool computeResiduals = hasColumns(RESIDUALS);
+  const bool computeDepths = hasColumns(DEPTHS);
+  const bool computeBearingVectors = hasColumns(BEARING_VECTORS);
+
+  if(computeResiduals)
+    _residuals.resize(nbObservations);
+  if(computeDepths)
+    _depths.resize(nbObservations);
+  if(computeBearingVectors)
+    _bearingVectors.resize(3, nbObservations);
+
+  #pragma omp parallel for
+  for(int obsIndex = 0; obsIndex < nbObservations; ++obsIndex)
+  {
+    const geometry::Pose3& pose = viewsPoses[obsViewIndexes[obsIndex]];
+    const camera::IntrinsicBase* intrinsic = viewsIntrinsics[obsViewIndexes[obsIndex]];
+    const Vec3 X = positions.col(obsLandmarkIndexes[obsIndex]);
+    const Vec2 x = obsPoints.col(obsIndex);
+
+    if(computeResiduals)
+      _residuals[obsIndex] = intrinsic->residual(pose, X, x).norm();
+    if(computeDepths)
+      _depths[obsIndex] = pose.depth(X);
+    // the bearing vector needs the undistortion of the observation, the most expensive column
+    if(computeBearingVectors)
+      _bearingVectors.col(obsIndex) = camera::applyIntrinsicExtrinsic(pose, intrinsic, x);
+  }
+}
+
+} // namespace sfm
+} // namespace aliceVision
@@ -0,0 +1,68 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksTable.hpp>
+#include <aliceVision/camera/IntrinsicBase.hpp>
+#include <aliceVision/geometry/Pose3.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Residuals of all the observations of a scene, evaluated in one parallel pass.
+ *
+ * The pose and the intrinsic of each view are looked up once, then the requested columns
+ * (reprojection error, depth and/or bearing vector) of each observation of the landmarks table are computed.
+ * The outliers filters and the statistics read these columns instead of reprojecting the landmarks again.
+ */
+class ObservationsResiduals
+{
+public:
+  /// columns of the residuals, to combine as flags
+  enum EColumns
+  {
+    RESIDUALS = 1,
+    DEPTHS = 2,
+    BEARING_VECTORS = 4,
+    ALL_COLUMNS = RESIDUALS | DEPTHS | BEARING_VECTORS
+  };
+
+  /**
+   * @brief Evaluate the residuals of all the observations of the table
+   * @param[in] sfmData the scene, with the poses and the intrinsics of the observing views
+   * @param[in] landmarksTable the landmarks of the scene, it has to outlive this object
+   * @param[in] columns the columns to compute (EColumns flags), the other ones are left empty
+   */
+  ObservationsResiduals(const sfmData::SfMData& sfmData, const sfmData::LandmarksTable& landmarksTable, int columns = ALL_COLUMNS);
+
+  const sfmData::LandmarksTable& getLandmarksTable() const { return _landmarksTable; }
+
+  /// true if all the given columns (EColumns flags) have been computed
+  bool hasColumns(int columns) const { return (_columns & columns) == columns; }
+
+  /// reprojection error norm of each observation, in pixels
+  const std::vector<double>& getResiduals() const { return _residuals; }
+  /// depth of the landmark in the camera of each observation
+  const std::vector<double>& getDepths() const { return _depths; }
+  /// unit vector from the camera center to the observation in world coordinates, one column per observation
+  const Mat3X& getBearingVectors() const { return _bearingVectors; }
+
+private:
+  const sfmData::LandmarksTable& _landmarksTable;
+  const int _columns;
+  std::vector<double> _residuals;
+  std::vector<double> _depths;
+  Mat3X _bearingVectors;
+};
+
+} // namespace sfm
+} // namespace aliceVision
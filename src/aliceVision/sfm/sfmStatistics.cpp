@@ -12,11 +12,41 @@
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
 
+#include <algorithm>
+
 
 namespace aliceVision {
 namespace sfm {
 
+namespace {
+
+/// true for the views of the landmarks table in specificViews, or for all the views if specificViews is empty
+std::vector<char> getViewsMask(const sfmData::LandmarksTable& landmarksTable, const std::set<IndexT>& specificViews)
+{
+  std::vector<char> viewsMask(landmarksTable.getNbViews(), 1);
+  if(!specificViews.empty())
+  {
+    for(std::size_t v = 0; v < viewsMask.size(); ++v)
+      viewsMask[v] = specificViews.count(landmarksTable.getViewIds()[v]);
+  }
+  return viewsMask;
+}
+
+} // namespace
+
 void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+{
+  const sfmData::LandmarksTable landmarksTable(sfmData.getLandmarks());
+  computeResidualsHistogram(sfmData, landmarksTable, out_stats, out_histogram, specificViews);
+}
+
+void computeResidualsHistogram(const sfmData::SfMData& sfmData, const sfmData::LandmarksTable& landmarksTable, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+{
+  const ObservationsResiduals residuals(sfmData, landmarksTable, ObservationsResiduals::RESIDUALS);
+  computeResidualsHistogram(residuals, out_stats, out_histogram, specificViews);
+}
+
+void computeResidualsHistogram(const ObservationsResiduals& residuals, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
 {
   {
     // Init output params
@@ -26,34 +56,28 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
       *out_histogram = utils::Histogram<double>();
     }
   }
-  if (sfmData.getLandmarks().empty())
+  const sfmData::LandmarksTable& landmarksTable = residuals.getLandmarksTable();
+  if (landmarksTable.getNbLandmarks() == 0)
     return;
 
   // Collect residuals for each observation
   std::vector<double> vec_residuals;
-  vec_residuals.reserve(sfmData.structure.size());
-
-  for(const auto &track : sfmData.getLandmarks())
+  if(specificViews.empty())
   {
-    const aliceVision::sfmData::Observations & observations = track.second.observations;
-    for(const auto& obs: observations)
+    vec_residuals = residuals.getResiduals();
+  }
+  else
+  {
+    const std::vector<char> viewsMask = getViewsMask(landmarksTable, specificViews);
+    const std::vector<IndexT>& obsViewIndexes = landmarksTable.getObservationViewIndexes();
+    vec_residuals.reserve(residuals.getResiduals().size());
+    for(std::size_t obsIndex = 0; obsIndex < obsViewIndexes.size(); ++obsIndex)
     {
-      if(!specificViews.empty())
-      {
-          if(specificViews.count(obs.first) == 0)
-              continue;
-      }
-      const sfmData::View& view = sfmData.getView(obs.first);
-      const aliceVision::geometry::Pose3 pose = sfmData.getPose(view).getTransform();
-      const std::shared_ptr<aliceVision::camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().find(view.getIntrinsicId())->second;
-      const Vec2 residual = intrinsic->residual(pose, track.second.X, obs.second.x);
-      vec_residuals.push_back(residual.norm());
-      //ALICEVISION_LOG_INFO("[AliceVision] sfmtstatistics::computeResidualsHistogram track: " << track.first << ", residual: " << residual.norm());
+      if(viewsMask[obsViewIndexes[obsIndex]])
+        vec_residuals.push_back(residuals.getResiduals()[obsIndex]);
     }
   }
 
- // ALICEVISION_LOG_INFO("[AliceVision] sfmtstatistics::computeResidualsHistogram vec_residuals.size(): " << vec_residuals.size());
-
   if(vec_residuals.empty())
       return;
 
@@ -66,8 +90,13 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
   }
 }
 
-
 void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, int& overallNbObservations, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+{
+  const sfmData::LandmarksTable landmarksTable(sfmData.getLandmarks());
+  computeObservationsLengthsHistogram(landmarksTable, out_stats, overallNbObservations, out_histogram, specificViews);
+}
+
+void computeObservationsLengthsHistogram(const sfmData::LandmarksTable& landmarksTable, BoxStats<double>& out_stats, int& overallNbObservations, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
 {
   {
     // Init output params
@@ -77,36 +106,25 @@ void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxSta
       *out_histogram = utils::Histogram<double>();
     }
   }
-  if (sfmData.getLandmarks().empty())
+  if (landmarksTable.getNbLandmarks() == 0)
     return;
 
+  const std::vector<char> viewsMask = getViewsMask(landmarksTable, specificViews);
+  const std::vector<IndexT>& obsViewIndexes = landmarksTable.getObservationViewIndexes();
+
   // Collect tracks size: number of 2D observations per 3D points
   std::vector<int> nbObservations;
-  nbObservations.reserve(sfmData.getLandmarks().size());
+  nbObservations.reserve(landmarksTable.getNbLandmarks());
 
-  for(const auto& landmark : sfmData.getLandmarks())
+  for(std::size_t landmarkIndex = 0; landmarkIndex < landmarksTable.getNbLandmarks(); ++landmarkIndex)
   {
-    const aliceVision::sfmData::Observations & observations = landmark.second.observations;
-    if (!specificViews.empty())
-    {
-        int nbObsSpecificViews = 0;
-        for(const auto& obs: observations)
-        {
-            if(specificViews.count(obs.first) == 1)
-            {
-                ++nbObsSpecificViews;
-            }
-        }
-        if(nbObsSpecificViews > 0)
-        {
-            nbObservations.push_back(observations.size());
-        }
-    }
-    else
-    {
-        nbObservations.push_back(observations.size());
-    }
-    overallNbObservations += observations.size();
+    const std::size_t obsBegin = landmarksTable.getObservationsBegin(landmarkIndex);
+    const std::size_t obsEnd = landmarksTable.getObservationsEnd(landmarkIndex);
+    const bool isInSpecificViews = std::any_of(obsViewIndexes.begin() + obsBegin, obsViewIndexes.begin() + obsEnd,
+                                               [&](IndexT viewIndex) { return viewsMask[viewIndex] != 0; });
+    if(specificViews.empty() || isInSpecificViews)
+        nbObservations.push_back(obsEnd - obsBegin);
+    overallNbObservations += obsEnd - obsBegin;
   }
 
   if(nbObservations.empty())
@@ -122,6 +140,12 @@ void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxSta
 }
 
 void computeLandmarksPerViewHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram)
+{
+    const sfmData::LandmarksTable landmarksTable(sfmData.getLandmarks());
+    computeLandmarksPerViewHistogram(landmarksTable, out_stats, out_histogram);
+}
+
+void computeLandmarksPerViewHistogram(const sfmData::LandmarksTable& landmarksTable, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram)
 {
     {
         // Init output params
@@ -131,30 +155,13 @@ void computeLandmarksPerViewHistogram(const sfmData::SfMData& sfmData, BoxStats<
             *out_histogram = utils::Histogram<double>();
         }
     }
-    if(sfmData.getLandmarks().empty())
+    if(landmarksTable.getNbViews() == 0)
         return;
 
-    std::map<IndexT, int> nbLandmarksPerView;
-
-    for(const auto& landmark: sfmData.getLandmarks())
-    {
-        for(const auto& obsIt: landmark.second.observations)
-        {
-            const auto& viewId = obsIt.first;
-            auto it = nbLandmarksPerView.find(viewId);
-            if(it != nbLandmarksPerView.end())
-                ++(it->second);
-            else
-                it->second = 1;
-        }
-    }
-    if(nbLandmarksPerView.empty())
-        return;
-
-    // Collect tracks size: number of 2D observations per 3D points
-    std::vector<int> nbLandmarksPerViewVec;
-    for(const auto& it: nbLandmarksPerView)
-        nbLandmarksPerViewVec.push_back(it.second);
+    // number of observations of each view, from the views index
+    std::vector<int> nbLandmarksPerViewVec(landmarksTable.getNbViews());
+    for(std::size_t v = 0; v < nbLandmarksPerViewVec.size(); ++v)
+        nbLandmarksPerViewVec[v] = landmarksTable.getViewObservationsEnd(v) - landmarksTable.getViewObservationsBegin(v);
 
     out_stats = BoxStats<double>(nbLandmarksPerViewVec.begin(), nbLandmarksPerViewVec.end());
 
@@ -175,31 +182,19 @@ void computeLandmarksPerView(const sfmData::SfMData& sfmData, std::vector<int>&
     if(sfmData.getLandmarks().empty())
         return;
 
-    std::map<IndexT, int> nbLandmarksPerView;
-
+    const sfmData::LandmarksTable landmarksTable(sfmData.getLandmarks());
+    const std::vector<IndexT>& viewIds = landmarksTable.getViewIds();
 
-    for(const auto& landmark : sfmData.getLandmarks())
-    {
-        const aliceVision::sfmData::Observations & observations = landmark.second.observations;
-        for(const auto& obs: observations)
-        {
-            auto it = nbLandmarksPerView.find(obs.first);
-            if(it != nbLandmarksPerView.end())
-                ++(it->second);
-            else
-                nbLandmarksPerView[obs.first] = 1;
-        }
-    }
-    if(nbLandmarksPerView.empty())
-        return;
-
-    out_nbLandmarksPerView.reserve(nbLandmarksPerView.size());
+    out_nbLandmarksPerView.reserve(sfmData.getViews().size());
     for(const auto& viewIt: sfmData.getViews())
     {
-        const auto it = nbLandmarksPerView.find(viewIt.first);
+        const auto it = std::lower_bound(viewIds.begin(), viewIds.end(), viewIt.first);
         int nbLandmarks = 0;
-        if(it != nbLandmarksPerView.end())
-            nbLandmarks = it->second;
+        if(it != viewIds.end() && *it == viewIt.first)
+        {
+            const std::size_t viewIndex = it - viewIds.begin();
+            nbLandmarks = landmarksTable.getViewObservationsEnd(viewIndex) - landmarksTable.getViewObservationsBegin(viewIndex);
+        }
         out_nbLandmarksPerView.push_back(nbLandmarks);
     }
 }
@@ -259,6 +254,12 @@ void computeFeatMatchPerView(const sfmData::SfMData& sfmData, std::vector<std::s
 }
 
 void computeScaleHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
+{
+    const sfmData::LandmarksTable landmarksTable(sfmData.getLandmarks());
+    computeScaleHistogram(landmarksTable, out_stats, out_histogram, specificViews);
+}
+
+void computeScaleHistogram(const sfmData::LandmarksTable& landmarksTable, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews)
 {
     {
       // Init output params
@@ -268,24 +269,26 @@ void computeScaleHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& ou
           *out_histogram = utils::Histogram<double>();
       }
     }
-    if(sfmData.getLandmarks().empty())
+    if(landmarksTable.getNbLandmarks() == 0)
       return;
 
-    // Collect tracks size: number of 2D observations per 3D points
+    const std::vector<char> viewsMask = getViewsMask(landmarksTable, specificViews);
+    const std::vector<IndexT>& obsViewIndexes = landmarksTable.getObservationViewIndexes();
+    const std::vector<double>& obsScales = landmarksTable.getObservationScales();
+
+    // Collect the scale of the observations
     std::vector<double> vec_scaleObservations;
-    vec_scaleObservations.reserve(sfmData.getLandmarks().size());
-    for(const auto& landmark: sfmData.getLandmarks())
+    if(specificViews.empty())
     {
-        const aliceVision::sfmData::Observations & observations = landmark.second.observations;
-
-        for(const auto& obs: observations)
+        vec_scaleObservations = obsScales;
+    }
+    else
+    {
+        vec_scaleObservations.reserve(obsScales.size());
+        for(std::size_t obsIndex = 0; obsIndex < obsScales.size(); ++obsIndex)
         {
-            if(!specificViews.empty())
-            {
-                if(specificViews.count(obs.first) == 0)
-                    continue;
-            }
-            vec_scaleObservations.push_back(obs.second.scale);
+            if(viewsMask[obsViewIndexes[obsIndex]])
+                vec_scaleObservations.push_back(obsScales[obsIndex]);
         }
     }
 
@@ -318,21 +321,9 @@ void computeResidualsPerView(const sfmData::SfMData& sfmData, int& nbViews, std:
     nbResidualsPerViewFirstQuartile.resize(nbViews);
     nbResidualsPerViewThirdQuartile.resize(nbViews);
 
-    // Collect residuals (number of residuals per 3D points) of all landmarks visible in each view
-    std::map<IndexT, std::vector<double>> residualsPerView;
-
-    for(const auto &landmark : sfmData.getLandmarks())
-    {
-      const aliceVision::sfmData::Observations & observations = landmark.second.observations;
-      for(const auto& obs: observations)
-      {
-        const sfmData::View& view = sfmData.getView(obs.first);
-        const aliceVision::geometry::Pose3 pose = sfmData.getPose(view).getTransform();
-        const std::shared_ptr<aliceVision::camera::IntrinsicBase> intrinsic = sfmData.getIntrinsics().find(view.getIntrinsicId())->second;
-        const Vec2 residual = intrinsic->residual(pose, landmark.second.X, obs.second.x);
-        residualsPerView[obs.first].push_back(residual.norm());
-      }
-    }
+    const sfmData::LandmarksTable landmarksTable(sfmData.getLandmarks());
+    const ObservationsResiduals observationsResiduals(sfmData, landmarksTable, ObservationsResiduals::RESIDUALS);
+    const std::vector<IndexT>& tableViewIds = landmarksTable.getViewIds();
 
     std::vector<IndexT> viewKeys;
     for(const auto& v: sfmData.getViews())
@@ -343,10 +334,16 @@ void computeResidualsPerView(const sfmData::SfMData& sfmData, int& nbViews, std:
     {
         const IndexT viewId = viewKeys[viewIdx];
 
-        const auto it = residualsPerView.find(viewId);
-        if(it == residualsPerView.end())
+        const auto it = std::lower_bound(tableViewIds.begin(), tableViewIds.end(), viewId);
+        if(it == tableViewIds.end() || *it != viewId)
             continue;
-        const std::vector<double>& residuals = it->second;
+        const std::size_t viewIndex = it - tableViewIds.begin();
+
+        // residuals of all landmarks visible in the view
+        std::vector<double> residuals;
+        residuals.reserve(landmarksTable.getViewObservationsEnd(viewIndex) - landmarksTable.getViewObservationsBegin(viewIndex));
+        for(std::size_t k = landmarksTable.getViewObservationsBegin(viewIndex); k < landmarksTable.getViewObservationsEnd(viewIndex); ++k)
+            residuals.push_back(observationsResiduals.getResiduals()[landmarksTable.getViewObservations()[k]]);
         BoxStats<double> residualStats(residuals.begin(), residuals.end());
         utils::Histogram<double> residual_histogram = utils::Histogram<double>(residualStats.min, residualStats.max+1, residualStats.max - residualStats.min +1);
         residual_histogram.Add(residuals.begin(), residuals.end());
@@ -377,17 +374,9 @@ void computeObservationsLengthsPerView(const sfmData::SfMData& sfmData, int& nbV
     nbObservationsLengthsPerViewFirstQuartile.resize(nbViews);
     nbObservationsLengthsPerViewThirdQuartile.resize(nbViews);
 
-    // Collect observations length (number of 2D observations per 3D points) of all landmarks visible in each view
-    std::map<IndexT, std::vector<int>> observationLengthsPerView;
-
-    for(const auto& landmark : sfmData.getLandmarks())
-    {
-        const aliceVision::sfmData::Observations & observations = landmark.second.observations;
-        for(const auto& obs: observations)
-        {
-            observationLengthsPerView[obs.first].push_back(observations.size());
-        }
-    }
+    const sfmData::LandmarksTable landmarksTable(sfmData.getLandmarks());
+    const std::vector<IndexT>& tableViewIds = landmarksTable.getViewIds();
+    const std::vector<IndexT>& obsLandmarkIndexes = landmarksTable.getObservationLandmarkIndexes();
 
     std::vector<IndexT> viewKeys;
     for(const auto& v: sfmData.getViews())
@@ -397,7 +386,16 @@ void computeObservationsLengthsPerView(const sfmData::SfMData& sfmData, int& nbV
     for(int viewIdx = 0; viewIdx < nbViews; ++viewIdx)
     {
         const IndexT viewId = viewKeys[viewIdx];
-        const std::vector<int>& nbObservations = observationLengthsPerView[viewId];
+
+        // observations length (number of 2D observations per 3D points) of all landmarks visible in the view
+        std::vector<int> nbObservations;
+        const auto it = std::lower_bound(tableViewIds.begin(), tableViewIds.end(), viewId);
+        if(it != tableViewIds.end() && *it == viewId)
+        {
+            const std::size_t viewIndex = it - tableViewIds.begin();
+            for(std::size_t k = landmarksTable.getViewObservationsBegin(viewIndex); k < landmarksTable.getViewObservationsEnd(viewIndex); ++k)
+                nbObservations.push_back(landmarksTable.getNbObservations(obsLandmarkIndexes[landmarksTable.getViewObservations()[k]]));
+        }
         BoxStats<double> observationsLengthsStats(nbObservations.begin(), nbObservations.end());
         utils::Histogram<double> observationsLengths_histogram(observationsLengthsStats.min, observationsLengthsStats.max + 1, observationsLengthsStats.max - observationsLengthsStats.min + 1);
         observationsLengths_histogram.Add(nbObservations.begin(), nbObservations.end());
@@ -7,6 +7,8 @@
 #pragma once
 
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksTable.hpp>
+#include <aliceVision/sfm/sfmResiduals.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/track/Track.hpp>
 #include <aliceVision/track/tracksUtils.hpp>
@@ -27,6 +29,16 @@ namespace sfm {
  */
 void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
 
+/**
+ * @brief Same as above, with the landmarks of the scene already in a table (to compute several statistics)
+ */
+void computeResidualsHistogram(const sfmData::SfMData& sfmData, const sfmData::LandmarksTable& landmarksTable, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
+
+/**
+ * @brief Same as above, with the residuals already evaluated (to share them with the outliers filters)
+ */
+void computeResidualsHistogram(const ObservationsResiduals& residuals, BoxStats<double>& out_stats, utils::Histogram<double>* out_histogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
+
 /**
  * @brief Compute histogram of observations lengths
  * @param[in] sfmData: containing the observations
@@ -36,6 +48,11 @@ void computeResidualsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>
  */
 void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, int& overallNbObservations, utils::Histogram<double>* observationsLengthHistogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
 
+/**
+ * @brief Same as above, with the landmarks of the scene already in a table
+ */
+void computeObservationsLengthsHistogram(const sfmData::LandmarksTable& landmarksTable, BoxStats<double>& out_stats, int& overallNbObservations, utils::Histogram<double>* observationsLengthHistogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
+
 /**
  * @brief Compute histogram of the number of landmarks per view
  * @param[in] sfmData: scene containing the views and the landmarks
@@ -44,6 +61,11 @@ void computeObservationsLengthsHistogram(const sfmData::SfMData& sfmData, BoxSta
  */
 void computeLandmarksPerViewHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, utils::Histogram<double>* landmarksPerViewHistogram);
 
+/**
+ * @brief Same as above, with the landmarks of the scene already in a table
+ */
+void computeLandmarksPerViewHistogram(const sfmData::LandmarksTable& landmarksTable, BoxStats<double>& out_stats, utils::Histogram<double>* landmarksPerViewHistogram);
+
 /**
  * @brief Compute landmarks per view
  * @param[in] sfmData: scene containing the views and the landmarks
@@ -68,6 +90,11 @@ void computeFeatMatchPerView(const sfmData::SfMData& sfmData, std::vector<size_t
  */
 void computeScaleHistogram(const sfmData::SfMData& sfmData, BoxStats<double>& out_stats, utils::Histogram<double>* scaleHistogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
 
+/**
+ * @brief Same as above, with the landmarks of the scene already in a table
+ */
+void computeScaleHistogram(const sfmData::LandmarksTable& landmarksTable, BoxStats<double>& out_stats, utils::Histogram<double>* scaleHistogram, const std::set<IndexT>& specificViews = std::set<IndexT>());
+
 /**
  * @brief Compute different stats of residuals per view
  * @param[in] sfmData: scene containing the views and the landmarks
@@ -0,0 +1,160 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "LandmarksTable.hpp"
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace aliceVision {
+namespace sfmData {
+
+void LandmarksTable::build(const Landmarks& landmarks)
+{
+  clear();
+
+  // landmarks sorted by id
+  std::vector<std::pair<IndexT, const Landmark*>> sortedLandmarks;
+  sortedLandmarks.reserve(landmarks.size());
+  for(const auto& landmarkPair : landmarks)
+    sortedLandmarks.emplace_back(landmarkPair.first, &landmarkPair.second);
+  std::sort(sortedLandmarks.begin(), sortedLandmarks.end(),
+            [](const std::pair<IndexT, const Landmark*>& a, const std::pair<IndexT, const Landmark*>& b) { return a.first < b.first; });
+
+  const std::size_t nbLandmarks = sortedLandmarks.size();
+  _landmarkIds.resize(nbLandmarks);
+  _positions.resize(3, nbLandmarks);
+  _colors.resize(nbLandmarks);
+  _descTypes.resize(nbLandmarks);
+  _obsOffsets.resize(nbLandmarks + 1);
+  _obsOffsets[0] = 0;
+
+  for(std::size_t i = 0; i < nbLandmarks; ++i)
+    _obsOffsets[i + 1] = _obsOffsets[i] + sortedLandmarks[i].second->observations.size();
+
+  const std::size_t nbObservations = _obsOffsets.back();
+  _obsViewIds.resize(nbObservations);
+  _obsViewIndexes.resize(nbObservations);
+  _obsLandmarkIndexes.resize(nbObservations);
+  _obsFeatureIds.resize(nbObservations);
+  _obsPoints.resize(2, nbObservations);
+  _obsScales.resize(nbObservations);
+
+  // each landmark fills its own range of observations
+  #pragma omp parallel for
+  for(int i = 0; i < nbLandmarks; ++i)
+  {
+    const Landmark& landmark = *sortedLandmarks[i].second;
+    _landmarkIds[i] = sortedLandmarks[i].first;
+    _positions.col(i) = landmark.X;
+    _colors[i] = landmark.rgb;
+    _descTypes[i] = landmark.descType;
+
+    // observations are sorted by view id in the flat map
+    std::size_t obsIndex = _obsOffsets[i];
+    for(const auto& observationPair : landmark.observations)
+    {
+      _obsViewIds[obsIndex] = observationPair.first;
+      _obsLandmarkIndexes[obsIndex] = static_cast<IndexT>(i);
+      _obsFeatureIds[obsIndex] = observationPair.second.id_feat;
+      _obsPoints.col(obsIndex) = observationPair.second.x;
+      _obsScales[obsIndex] = observationPair.second.scale;
+      ++obsIndex;
+    }
+  }
+
+  // views index: only the unique view ids are sorted
+  HashMap<IndexT, IndexT> viewIndexes;
+  for(const IndexT viewId : _obsViewIds)
+    viewIndexes.emplace(viewId, UndefinedIndexT);
+
+  _viewIds.reserve(viewIndexes.size());
+  for(const auto& viewIndexPair : viewIndexes)
+    _viewIds.push_back(viewIndexPair.first);
+  std::sort(_viewIds.begin(), _viewIds.end());
+
+  for(std::size_t v = 0; v < _viewIds.size(); ++v)
+    viewIndexes.at(_viewIds[v]) = static_cast<IndexT>(v);
+
+  #pragma omp parallel for
+  for(int obsIndex = 0; obsIndex < nbObservations; ++obsIndex)
+    _obsViewIndexes[obsIndex] = viewIndexes.at(_obsViewIds[obsIndex]);
+
+  _viewOffsets.assign(_viewIds.size() + 1, 0);
+  for(const IndexT viewIndex : _obsViewIndexes)
+    ++_viewOffsets[viewIndex + 1];
+  for(std::size_t v = 0; v < _viewIds.size(); ++v)
+    _viewOffsets[v + 1] += _viewOffsets[v];
+
+  // observations are visited by landmark: they are sorted by landmark in each view
+  _viewObservations.resize(nbObservations);
+  std::vector<std::size_t> viewCursors(_viewOffsets.begin(), _viewOffsets.end() - 1);
+  for(std::size_t obsIndex = 0; obsIndex < nbObservations; ++obsIndex)
+    _viewObservations[viewCursors[_obsViewIndexes[obsIndex]]++] = obsIndex;
+}
+
+void LandmarksTable::clear()
+{
+  _landmarkIds.clear();
+  _positions.resize(3, 0);
+  _colors.clear();
+  _descTypes.clear();
+
+  _obsOffsets.assign(1, 0);
+  _obsViewIds.clear();
+  _obsViewIndexes.clear();
+  _obsLandmarkIndexes.clear();
+  _obsFeatureIds.clear();
+  _obsPoints.resize(2, 0);
+  _obsScales.clear();
+
+  _viewIds.clear();
+  _viewOffsets.assign(1, 0);
+  _viewObservations.clear();
+}
+
+std::size_t LandmarksTable::getLandmarkIndex(IndexT landmarkId) const
+{
+  const auto it = std::lower_bound(_landmarkIds.begin(), _landmarkIds.end(), landmarkId);
+  if(it == _landmarkIds.end() || *it != landmarkId)
+    throw std::out_of_range("LandmarksTable: unknown landmark id " + std::to_string(landmarkId));
+  return it - _landmarkIds.begin();
+}
+
+std::size_t LandmarksTable::getViewIndex(IndexT viewId) const
+{
+  const auto it = std::lower_bound(_viewIds.begin(), _viewIds.end(), viewId);
+  if(it == _viewIds.end() || *it != viewId)
+    throw std::out_of_range("LandmarksTable: no observation in view " + std::to_string(viewId));
+  return it - _viewIds.begin();
+}
+
+Landmark LandmarksTable::getLandmark(std::size_t landmarkIndex) const
+{
+  Landmark landmark(_positions.col(landmarkIndex), _descTypes[landmarkIndex], Observations(), _colors[landmarkIndex]);
+  landmark.observations.reserve(getNbObservations(landmarkIndex));
+  for(std::size_t obsIndex = getObservationsBegin(landmarkIndex); obsIndex < getObservationsEnd(landmarkIndex); ++obsIndex)
+    landmark.observations.emplace_hint(landmark.observations.end(), _obsViewIds[obsIndex], getObservation(obsIndex));
+  return landmark;
+}
+
+void LandmarksTable::updatePositions(Landmarks& landmarks) const
+{
+  for(std::size_t i = 0; i < _landmarkIds.size(); ++i)
+    landmarks.at(_landmarkIds[i]).X = _positions.col(i);
+}
+
+void LandmarksTable::updateColors(Landmarks& landmarks) const
+{
+  for(std::size_t i = 0; i < _landmarkIds.size(); ++i)
+    landmarks.at(_landmarkIds[i]).rgb = _colors[i];
+}
+
+} // namespace sfmData
+} // namespace aliceVision
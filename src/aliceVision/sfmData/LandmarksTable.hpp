@@ -0,0 +1,149 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/types.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace sfmData {
+
+/**
+ * @brief Columnar (structure of arrays) copy of the landmarks and their observations.
+ *
+ * The landmarks are sorted by id and their attributes are stored in contiguous arrays.
+ * Their observations are stored in compressed sparse rows, sorted by landmark then by view id,
+ * and a second index lists the observations of each view, sorted by landmark.
+ * The loops over all the observations (bundle adjustment setup, filters, statistics, colorization)
+ * read these arrays instead of the nodes of the Landmarks hash map and of each observations map.
+ *
+ * The table is a snapshot of the landmarks: it is not updated when they change, and the modified
+ * positions or colors are written back with updatePositions() and updateColors().
+ */
+class LandmarksTable
+{
+public:
+  LandmarksTable() { clear(); }
+  explicit LandmarksTable(const Landmarks& landmarks) { build(landmarks); }
+
+  /**
+   * @brief Fill the table with the given landmarks
+   * @param[in] landmarks the landmarks and their observations
+   */
+  void build(const Landmarks& landmarks);
+
+  void clear();
+
+  std::size_t getNbLandmarks() const { return _landmarkIds.size(); }
+  std::size_t getNbObservations() const { return _obsViewIds.size(); }
+  /// @return the number of views with at least one observation
+  std::size_t getNbViews() const { return _viewIds.size(); }
+
+  // landmarks columns, indexed by landmark index
+
+  /// landmarks ids, sorted
+  const std::vector<IndexT>& getLandmarkIds() const { return _landmarkIds; }
+  /// landmarks positions, one column per landmark
+  const Mat3X& getPositions() const { return _positions; }
+  Mat3X& getPositions() { return _positions; }
+  const std::vector<image::RGBColor>& getColors() const { return _colors; }
+  std::vector<image::RGBColor>& getColors() { return _colors; }
+  const std::vector<feature::EImageDescriberType>& getDescTypes() const { return _descTypes; }
+
+  /**
+   * @brief Get the index of a landmark in the columns
+   * @param[in] landmarkId the landmark id
+   * @return the landmark index, throws std::out_of_range if there is no such landmark
+   */
+  std::size_t getLandmarkIndex(IndexT landmarkId) const;
+
+  // observations columns, indexed by observation index
+
+  /// observations of a landmark: [getObservationsBegin(landmarkIndex), getObservationsEnd(landmarkIndex))
+  std::size_t getObservationsBegin(std::size_t landmarkIndex) const { return _obsOffsets[landmarkIndex]; }
+  std::size_t getObservationsEnd(std::size_t landmarkIndex) const { return _obsOffsets[landmarkIndex + 1]; }
+  std::size_t getNbObservations(std::size_t landmarkIndex) const { return _obsOffsets[landmarkIndex + 1] - _obsOffsets[landmarkIndex]; }
+
+  const std::vector<IndexT>& getObservationViewIds() const { return _obsViewIds; }
+  /// index of the view of each observation in getViewIds()
+  const std::vector<IndexT>& getObservationViewIndexes() const { return _obsViewIndexes; }
+  /// index of the landmark of each observation
+  const std::vector<IndexT>& getObservationLandmarkIndexes() const { return _obsLandmarkIndexes; }
+  const std::vector<IndexT>& getObservationFeatureIds() const { return _obsFeatureIds; }
+  /// observations 2D points, one column per observation
+  const Mat2X& getObservationPoints() const { return _obsPoints; }
+  const std::vector<double>& getObservationScales() const { return _obsScales; }
+
+  /// @return a copy of an observation, for the code working with sfmData::Observation
+  Observation getObservation(std::size_t obsIndex) const
+  {
+    return Observation(_obsPoints.col(obsIndex), _obsFeatureIds[obsIndex], _obsScales[obsIndex]);
+  }
+
+  // views index, indexed by view index
+
+  /// ids of the views with at least one observation, sorted
+  const std::vector<IndexT>& getViewIds() const { return _viewIds; }
+
+  /**
+   * @brief Get the index of a view in the views index
+   * @param[in] viewId the view id
+   * @return the view index, throws std::out_of_range if the view has no observation
+   */
+  std::size_t getViewIndex(IndexT viewId) const;
+
+  /// observations of a view: getViewObservations()[getViewObservationsBegin(viewIndex) ... getViewObservationsEnd(viewIndex)[
+  std::size_t getViewObservationsBegin(std::size_t viewIndex) const { return _viewOffsets[viewIndex]; }
+  std::size_t getViewObservationsEnd(std::size_t viewIndex) const { return _viewOffsets[viewIndex + 1]; }
+  /// observations indexes grouped by view, sorted by landmark in each view
+  const std::vector<std::size_t>& getViewObservations() const { return _viewObservations; }
+
+  // compatibility with the Landmarks container
+
+  /// @return a copy of a landmark with its observations
+  Landmark getLandmark(std::size_t landmarkIndex) const;
+
+  /**
+   * @brief Write the positions of the table back to the landmarks with the same ids
+   * @param[in,out] landmarks the landmarks the table has been built from
+   */
+  void updatePositions(Landmarks& landmarks) const;
+
+  /**
+   * @brief Write the colors of the table back to the landmarks with the same ids
+   * @param[in,out] landmarks the landmarks the table has been built from
+   */
+  void updateColors(Landmarks& landmarks) const;
+
+private:
+  // landmarks
+  std::vector<IndexT> _landmarkIds;
+  Mat3X _positions;
+  std::vector<image::RGBColor> _colors;
+  std::vector<feature::EImageDescriberType> _descTypes;
+
+  // observations, by landmark
+  std::vector<std::size_t> _obsOffsets;
+  std::vector<IndexT> _obsViewIds;
+  std::vector<IndexT> _obsViewIndexes;
+  std::vector<IndexT> _obsLandmarkIndexes;
+  std::vector<IndexT> _obsFeatureIds;
+  Mat2X _obsPoints;
+  std::vector<double> _obsScales;
+
+  // observations, by view
+  std::vector<IndexT> _viewIds;
+  std::vector<std::size_t> _viewOffsets;
+  std::vector<std::size_t> _viewObservations;
+};
+
+} // namespace sfmData
+} // namespace aliceVision
@@ -8,119 +8,173 @@
 #include "colorize.hpp"
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmData/LandmarksTable.hpp>
 #include <aliceVision/stl/indexedSort.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/image/io.hpp>
 
 #include <boost/progress.hpp>
 
-#include <map>
+#include <algorithm>
+#include <numeric>
 #include <vector>
-#include <functional>
 namespace aliceVision {
 namespace sfmData {
 
+/// number of image rows decoded at once per thread to sample the colors
+static const int colorizeStripHeight = 256;
+
 void colorizeTracks(SfMData& sfmData)
 {
   boost::progress_display progressBar(sfmData.getLandmarks().size(), std::cout, "\nCompute scene structure color\n");
 
-  std::vector<std::reference_wrapper<Landmark>> remainingLandmarksToColor;
-  remainingLandmarksToColor.reserve(sfmData.getLandmarks().size());
-
-  for(auto& landmarkPair : sfmData.getLandmarks())
-    remainingLandmarksToColor.push_back(landmarkPair.second);
+  LandmarksTable landmarksTable(sfmData.getLandmarks());
 
   struct ViewInfo
   {
-    ViewInfo(IndexT viewId, std::size_t cardinal)
-      : viewId(viewId)
+    ViewInfo(std::size_t viewIndex, std::size_t cardinal)
+      : viewIndex(viewIndex)
       , cardinal(cardinal)
     {}
 
-    IndexT viewId;
+    std::size_t viewIndex;
     std::size_t cardinal;
-    std::vector<std::reference_wrapper<Landmark>> landmarks;
+    /// observations of the landmarks colored from this view
+    std::vector<std::size_t> observations;
   };
 
   std::vector<ViewInfo> sortedViewsCardinal;
-  sortedViewsCardinal.reserve(sfmData.getViews().size());
+  sortedViewsCardinal.reserve(landmarksTable.getNbViews());
   {
-    // create cardinal per viewId map
-    std::map<IndexT, std::size_t> viewsCardinalMap; // <ViewId, Cardinal>
-    for(const auto& landmarkPair : sfmData.getLandmarks())
-    {
-      const Observations& observations = landmarkPair.second.observations;
-      for(const auto& observationPair : observations)
-        ++viewsCardinalMap[observationPair.first]; // TODO: 0
-    }
-
-    // copy key-value pairs from the map to the vector
-    for(const auto& cardinalPair : viewsCardinalMap)
-      sortedViewsCardinal.push_back(ViewInfo(cardinalPair.first, cardinalPair.second));
+    // cardinal of each view, from the views index of the table
+    for(std::size_t viewIndex = 0; viewIndex < landmarksTable.getNbViews(); ++viewIndex)
+      sortedViewsCardinal.push_back(ViewInfo(viewIndex, landmarksTable.getViewObservationsEnd(viewIndex) - landmarksTable.getViewObservationsBegin(viewIndex)));
 
     // sort the vector, biggest cardinality first
-    std::sort(sortedViewsCardinal.begin(),
-              sortedViewsCardinal.end(),
-              [] (const ViewInfo& l, const ViewInfo& r) { return l.cardinal > r.cardinal; });
+    std::stable_sort(sortedViewsCardinal.begin(),
+                     sortedViewsCardinal.end(),
+                     [] (const ViewInfo& l, const ViewInfo& r) { return l.cardinal > r.cardinal; });
   }
 
-  // assign each landmark to a view
-  for(ViewInfo& viewCardinal : sortedViewsCardinal)
+  // assign each landmark to the first view observing it, in one pass over the observations of each view
   {
-    std::vector<std::reference_wrapper<Landmark>> toKeep;
-    const IndexT viewId = viewCardinal.viewId;
+    const std::vector<IndexT>& obsLandmarkIndexes = landmarksTable.getObservationLandmarkIndexes();
+    const std::vector<std::size_t>& viewObservations = landmarksTable.getViewObservations();
+    std::vector<char> isAssigned(landmarksTable.getNbLandmarks(), 0);
+    std::size_t nbRemainingLandmarks = landmarksTable.getNbLandmarks();
 
-    for(int i = 0; i < remainingLandmarksToColor.size(); ++i)
+    for(ViewInfo& viewCardinal : sortedViewsCardinal)
     {
-      Landmark& landmark = remainingLandmarksToColor.at(i);
-      auto it = landmark.observations.find(viewId);
-      if(it != landmark.observations.end())
-      {
-        viewCardinal.landmarks.push_back(landmark);
-      }
-      else
+      if(nbRemainingLandmarks == 0)
+        break;
+
+      for(std::size_t k = landmarksTable.getViewObservationsBegin(viewCardinal.viewIndex); k < landmarksTable.getViewObservationsEnd(viewCardinal.viewIndex); ++k)
       {
-        toKeep.push_back(landmark);
+        const std::size_t obsIndex = viewObservations[k];
+        char& assigned = isAssigned[obsLandmarkIndexes[obsIndex]];
+        if(!assigned)
+        {
+          assigned = 1;
+          viewCardinal.observations.push_back(obsIndex);
+        }
       }
+      nbRemainingLandmarks -= viewCardinal.observations.size();
     }
-    std::swap(toKeep, remainingLandmarksToColor);
+  }
 
-    if(remainingLandmarksToColor.empty())
-      break;
+  // biggest views first, so that the last decoded images are the small ones
+  std::vector<int> viewsOrder;
+  viewsOrder.reserve(sortedViewsCardinal.size());
+  for(int i = 0; i < sortedViewsCardinal.size(); ++i)
+  {
+    if(!sortedViewsCardinal[i].observations.empty())
+      viewsOrder.push_back(i);
   }
+  std::stable_sort(viewsOrder.begin(), viewsOrder.end(), [&](int l, int r) {
+    return sortedViewsCardinal[l].observations.size() > sortedViewsCardinal[r].observations.size();
+  });
 
-  // create an unsorted index container
-  std::vector<int> unsortedIndexes(sortedViewsCardinal.size()) ;
-  std::iota(std::begin(unsortedIndexes), std::end(unsortedIndexes), 0);
-  std::random_shuffle(unsortedIndexes.begin(), unsortedIndexes.end());
+  const Mat2X& obsPoints = landmarksTable.getObservationPoints();
+  const std::vector<IndexT>& obsLandmarkIndexes = landmarksTable.getObservationLandmarkIndexes();
+  std::vector<image::RGBColor>& colors = landmarksTable.getColors();
 
-  // landmark colorization
-#pragma omp parallel for
-  for(int i = 0; i < unsortedIndexes.size(); ++i)
+  // landmark colorization, each thread decodes its own images
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < viewsOrder.size(); ++i)
   {
-    const ViewInfo& viewCardinal = sortedViewsCardinal.at(unsortedIndexes.at(i));
-    if(!viewCardinal.landmarks.empty())
+    const ViewInfo& viewCardinal = sortedViewsCardinal[viewsOrder[i]];
+    const View& view = sfmData.getView(landmarksTable.getViewIds()[viewCardinal.viewIndex]);
+
+    image::ImageStripReader reader(view.getImagePath(), image::EImageColorSpace::SRGB);
+    const int width = reader.width();
+    const int height = reader.height();
+
+    // observations sorted by row, to read the image strip by strip from top to bottom
+    std::vector<std::pair<Vec2, std::size_t>> points;
+    points.reserve(viewCardinal.observations.size());
+    for(const std::size_t obsIndex : viewCardinal.observations)
+    {
+      Vec2 pt = obsPoints.col(obsIndex);
+      // clamp the pixel position if the feature/marker center is outside the image.
+      pt.x() = clamp(pt.x(), 0.0, static_cast<double>(width - 1));
+      pt.y() = clamp(pt.y(), 0.0, static_cast<double>(height - 1));
+      points.emplace_back(pt, obsIndex);
+    }
+    std::sort(points.begin(), points.end(), [](const std::pair<Vec2, std::size_t>& l, const std::pair<Vec2, std::size_t>& r) {
+      return l.first.y() < r.first.y();
+    });
+
+    // rows [stripBegin, stripEnd) of the image, with one more row kept from the previous strip
+    // for the interpolation across strips; the rows after the last observation are never decoded
+    std::vector<image::RGBfColor> strip(static_cast<std::size_t>(width) * (colorizeStripHeight + 1));
+    int stripBegin = 0;
+    int stripEnd = 0;
+
+    for(const auto& point : points)
     {
-      const View& view = sfmData.getView(viewCardinal.viewId);
-      image::Image<image::RGBColor> image;
-      image::readImage(view.getImagePath(), image, image::EImageColorSpace::SRGB);
+      const Vec2& pt = point.first;
+      const int x0 = static_cast<int>(pt.x());
+      const int y0 = static_cast<int>(pt.y());
+      const int x1 = std::min(x0 + 1, width - 1);
+      const int y1 = std::min(y0 + 1, height - 1);
 
-      for(Landmark& landmark : viewCardinal.landmarks)
+      if(y1 >= stripEnd)
       {
-        // color the point
-        Vec2 pt = landmark.observations.at(view.getViewId()).x;
-        // clamp the pixel position if the feature/marker center is outside the image.
-        pt.x() = clamp(pt.x(), 0.0, static_cast<double>(image.Width() - 1));
-        pt.y() = clamp(pt.y(), 0.0, static_cast<double>(image.Height() - 1));
-        landmark.rgb = image(pt.y(), pt.x());
+        int nbKeptRows = 0;
+        if(y0 < stripEnd)
+        {
+          nbKeptRows = stripEnd - y0;
+          std::copy(strip.begin() + static_cast<std::size_t>(y0 - stripBegin) * width,
+                    strip.begin() + static_cast<std::size_t>(stripEnd - stripBegin) * width, strip.begin());
+        }
+        stripBegin = y0;
+        const int readBegin = y0 + nbKeptRows;
+        stripEnd = std::min(readBegin + colorizeStripHeight, height);
+        reader.read(readBegin, stripEnd, &strip[static_cast<std::size_t>(nbKeptRows) * width]);
       }
 
+      // bilinear interpolation of the 4 neighbor pixels
+      const float dx = static_cast<float>(pt.x() - x0);
+      const float dy = static_cast<float>(pt.y() - y0);
+      const image::RGBfColor* row0 = &strip[static_cast<std::size_t>(y0 - stripBegin) * width];
+      const image::RGBfColor* row1 = &strip[static_cast<std::size_t>(y1 - stripBegin) * width];
+      const Vec3f top = (1.f - dx) * row0[x0] + dx * row0[x1];
+      const Vec3f bottom = (1.f - dx) * row1[x0] + dx * row1[x1];
+      const Vec3f rgb = ((1.f - dy) * top + dy * bottom) * 255.f;
+
+      // color the point
+      colors[obsLandmarkIndexes[point.second]] = image::RGBColor(static_cast<unsigned char>(clamp(rgb(0) + 0.5f, 0.f, 255.f)),
+                                                                 static_cast<unsigned char>(clamp(rgb(1) + 0.5f, 0.f, 255.f)),
+                                                                 static_cast<unsigned char>(clamp(rgb(2) + 0.5f, 0.f, 255.f)));
+    }
+
 #pragma omp critical
-      {
-        progressBar += viewCardinal.landmarks.size();
-      }
+    {
+      progressBar += viewCardinal.observations.size();
     }
   }
+
+  landmarksTable.updateColors(sfmData.getLandmarks());
 }
 
 } // namespace sfm
@@ -16,6 +16,8 @@ class SfMData;
  * @brief colorizeTracks Add the associated color to each 3D point of
  * the sfmData, using the track to determine the best view from which
  * to get the color.
+ * Each landmark is colored from the view with the most observations among its observing views,
+ * the images are decoded in parallel by strips of rows and the colors are bilinearly interpolated.
  * @param[in,out] sfmData The container of the data
  */
 void colorizeTracks(SfMData& sfmData);
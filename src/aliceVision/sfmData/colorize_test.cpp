@@ -0,0 +1,141 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/colorize.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/image/all.hpp>
+
+#define BOOST_TEST_MODULE colorize
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace aliceVision;
+using namespace aliceVision::sfmData;
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+/// more than 2 strips of 256 rows
+const int width = 12;
+const int height = 600;
+
+/// image with different values in each pixel and in each view, not linear in x nor y
+image::Image<image::RGBfColor> createImage(int viewIndex)
+{
+  image::Image<image::RGBfColor> img(width, height);
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      img(y, x) = image::RGBfColor(((x * 37 + y * 11 + viewIndex * 13) % 97) / 96.f,
+                                   static_cast<float>(y) / (height - 1),
+                                   0.2f * viewIndex + 0.05f * (x % 5));
+    }
+  }
+  return img;
+}
+
+/// bilinear interpolation in the full image, with the position clamped in the image
+image::RGBColor sampleImage(const image::Image<image::RGBfColor>& img, const Vec2& point)
+{
+  const double px = clamp(point.x(), 0.0, static_cast<double>(img.Width() - 1));
+  const double py = clamp(point.y(), 0.0, static_cast<double>(img.Height() - 1));
+  const int x0 = static_cast<int>(px);
+  const int y0 = static_cast<int>(py);
+  const int x1 = std::min(x0 + 1, img.Width() - 1);
+  const int y1 = std::min(y0 + 1, img.Height() - 1);
+  const double dx = px - x0;
+  const double dy = py - y0;
+
+  image::RGBColor color;
+  for(int c = 0; c < 3; ++c)
+  {
+    const double top = (1.0 - dx) * img(y0, x0)(c) + dx * img(y0, x1)(c);
+    const double bottom = (1.0 - dx) * img(y1, x0)(c) + dx * img(y1, x1)(c);
+    color(c) = static_cast<unsigned char>(clamp(((1.0 - dy) * top + dy * bottom) * 255.0 + 0.5, 0.0, 255.0));
+  }
+  return color;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(colorize_stripsAndViews)
+{
+  const fs::path folder = fs::temp_directory_path() / fs::unique_path("colorize_%%%%-%%%%");
+  fs::create_directories(folder);
+
+  // view 20 observes more landmarks than view 10
+  SfMData sfmData;
+  const std::vector<IndexT> viewIds = {10, 20};
+  for(std::size_t i = 0; i < viewIds.size(); ++i)
+  {
+    const std::string path = (folder / (std::to_string(viewIds[i]) + ".exr")).string();
+    image::writeImage(path, createImage(i), image::EImageColorSpace::LINEAR);
+    sfmData.views[viewIds[i]] = std::make_shared<View>(path, viewIds[i], 0, i, width, height);
+  }
+
+  Landmarks& landmarks = sfmData.getLandmarks();
+  const auto addLandmark = [&](const std::map<IndexT, Vec2>& points) {
+    Landmark landmark(Vec3::Zero(), feature::EImageDescriberType::SIFT);
+    for(const auto& point : points)
+      landmark.observations[point.first] = Observation(point.second, landmarks.size(), 1.0);
+    const IndexT landmarkId = 2 * landmarks.size() + 1;
+    landmarks[landmarkId] = landmark;
+    return landmarkId;
+  };
+
+  // rows on the boundaries of the 256 rows strips: the strip starts at the first row of the
+  // first observation, and the row before a boundary is kept for the interpolation across it
+  for(double y : {0.0, 100.25, 255.0, 255.5, 256.0, 510.75, 511.0, 511.5, 512.0, 598.5, 599.0})
+    addLandmark({{20, Vec2(3.5, y)}});
+  // a single observation after a whole strip without observations
+  addLandmark({{10, Vec2(4.25, 0.5)}});
+  addLandmark({{10, Vec2(4.25, 420.75)}});
+  // image borders, the positions outside of the image are clamped
+  for(const Vec2& point : {Vec2(0.0, 300.0), Vec2(width - 1.0, 300.5), Vec2(-3.0, 10.5), Vec2(width + 5.0, 10.5),
+                           Vec2(6.5, -2.0), Vec2(6.5, height + 50.0), Vec2(-1.0, -1.0), Vec2(width - 0.5, height - 0.5)})
+    addLandmark({{20, point}});
+  // seen by both views, colored from the view 20 with the most observations
+  const std::vector<IndexT> sharedLandmarkIds = {addLandmark({{10, Vec2(2.5, 200.5)}, {20, Vec2(8.5, 256.5)}}),
+                                                 addLandmark({{10, Vec2(9.0, 50.0)}, {20, Vec2(1.25, 511.5)}})};
+
+  colorizeTracks(sfmData);
+
+  std::map<IndexT, image::Image<image::RGBfColor>> images;
+  for(const IndexT viewId : viewIds)
+    image::readImage(sfmData.getView(viewId).getImagePath(), images[viewId], image::EImageColorSpace::SRGB);
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    const Landmark& landmark = landmarkPair.second;
+    const IndexT viewId = landmark.observations.count(20) ? 20 : 10;
+    const image::RGBColor expected = sampleImage(images.at(viewId), landmark.observations.at(viewId).x);
+    for(int c = 0; c < 3; ++c)
+    {
+      BOOST_CHECK_MESSAGE(std::abs(landmark.rgb(c) - expected(c)) <= 1,
+                          "landmark " << landmarkPair.first << ", channel " << c << ": "
+                          << int(landmark.rgb(c)) << " instead of " << int(expected(c)));
+    }
+  }
+
+  // the colors of the two views differ for the landmarks seen by both
+  for(const IndexT landmarkId : sharedLandmarkIds)
+  {
+    const Landmark& shared = landmarks.at(landmarkId);
+    BOOST_CHECK(sampleImage(images.at(10), shared.observations.at(10).x) != sampleImage(images.at(20), shared.observations.at(20).x));
+  }
+
+  fs::remove_all(folder);
+}
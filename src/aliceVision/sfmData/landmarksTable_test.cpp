@@ -0,0 +1,117 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/LandmarksTable.hpp>
+
+#define BOOST_TEST_MODULE landmarksTable
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+
+using namespace aliceVision;
+using namespace aliceVision::sfmData;
+
+namespace {
+
+/// random landmarks with non contiguous ids, observed by a random subset of the views
+Landmarks generateLandmarks(std::size_t nbLandmarks, IndexT nbViews)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> coordinate(-10.0, 10.0);
+  std::uniform_int_distribution<IndexT> view(0, nbViews - 1);
+  std::uniform_int_distribution<int> nbObservations(0, 6);
+
+  Landmarks landmarks;
+  for(std::size_t i = 0; i < nbLandmarks; ++i)
+  {
+    Landmark landmark(Vec3(coordinate(generator), coordinate(generator), coordinate(generator)),
+                      feature::EImageDescriberType::SIFT, Observations(), image::RGBColor(i % 256, 0, 255));
+    const int nbObs = nbObservations(generator);
+    for(int o = 0; o < nbObs; ++o)
+      landmark.observations[view(generator) * 10] = Observation(Vec2(coordinate(generator), coordinate(generator)), o, 1.0 + o);
+    landmarks[IndexT(3 * i + 7)] = landmark;
+  }
+  return landmarks;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(LandmarksTable_build)
+{
+  const Landmarks landmarks = generateLandmarks(500, 20);
+  const LandmarksTable table(landmarks);
+
+  BOOST_REQUIRE_EQUAL(table.getNbLandmarks(), landmarks.size());
+
+  std::size_t nbObservations = 0;
+  for(std::size_t i = 0; i < table.getNbLandmarks(); ++i)
+  {
+    const IndexT landmarkId = table.getLandmarkIds()[i];
+    if(i > 0)
+      BOOST_CHECK(table.getLandmarkIds()[i - 1] < landmarkId);
+    BOOST_CHECK_EQUAL(table.getLandmarkIndex(landmarkId), i);
+
+    // compatibility view
+    BOOST_CHECK(table.getLandmark(i) == landmarks.at(landmarkId));
+    BOOST_CHECK(table.getColors()[i] == landmarks.at(landmarkId).rgb);
+
+    for(std::size_t obsIndex = table.getObservationsBegin(i); obsIndex < table.getObservationsEnd(i); ++obsIndex)
+    {
+      BOOST_CHECK_EQUAL(table.getObservationLandmarkIndexes()[obsIndex], i);
+      BOOST_CHECK_EQUAL(table.getViewIds()[table.getObservationViewIndexes()[obsIndex]], table.getObservationViewIds()[obsIndex]);
+    }
+    nbObservations += landmarks.at(landmarkId).observations.size();
+  }
+  BOOST_CHECK_EQUAL(table.getNbObservations(), nbObservations);
+  BOOST_CHECK_THROW(table.getLandmarkIndex(8), std::out_of_range);
+
+  // each observation is listed once in the views index, sorted by landmark
+  std::vector<int> nbListed(table.getNbObservations(), 0);
+  for(std::size_t v = 0; v < table.getNbViews(); ++v)
+  {
+    BOOST_CHECK_EQUAL(table.getViewIndex(table.getViewIds()[v]), v);
+    for(std::size_t k = table.getViewObservationsBegin(v); k < table.getViewObservationsEnd(v); ++k)
+    {
+      const std::size_t obsIndex = table.getViewObservations()[k];
+      ++nbListed[obsIndex];
+      BOOST_CHECK_EQUAL(table.getObservationViewIndexes()[obsIndex], v);
+      if(k > table.getViewObservationsBegin(v))
+        BOOST_CHECK(table.getObservationLandmarkIndexes()[table.getViewObservations()[k - 1]] < table.getObservationLandmarkIndexes()[obsIndex]);
+    }
+  }
+  BOOST_CHECK(std::all_of(nbListed.begin(), nbListed.end(), [](int n) { return n == 1; }));
+  BOOST_CHECK_THROW(table.getViewIndex(5), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(LandmarksTable_update)
+{
+  Landmarks landmarks = generateLandmarks(100, 5);
+  LandmarksTable table(landmarks);
+
+  table.getPositions().colwise() += Vec3(1.0, 2.0, 3.0);
+  for(image::RGBColor& color : table.getColors())
+    color = image::BLACK;
+
+  const Landmarks original = landmarks;
+  table.updatePositions(landmarks);
+  table.updateColors(landmarks);
+
+  for(const auto& landmarkPair : landmarks)
+  {
+    const Landmark& landmark = landmarkPair.second;
+    const Vec3 expected = original.at(landmarkPair.first).X + Vec3(1.0, 2.0, 3.0);
+    BOOST_CHECK(AreVecNearEqual(landmark.X, expected, 1e-9));
+    BOOST_CHECK(landmark.rgb == image::BLACK);
+    BOOST_CHECK(landmark.observations == original.at(landmarkPair.first).observations);
+  }
+
+  // empty table
+  table.build(Landmarks());
+  BOOST_CHECK_EQUAL(table.getNbLandmarks(), 0);
+  BOOST_CHECK_EQUAL(table.getNbObservations(), 0);
+  BOOST_CHECK_EQUAL(table.getNbViews(), 0);
+}
@@ -0,0 +1,69 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace stl
+{
+
+/**
+ * @brief Stable sort of a range with OpenMP.
+ * The range is split in chunks which are sorted concurrently, then merged pairwise.
+ * As both steps are stable, the result is the same as std::stable_sort whatever the number of threads.
+ * @param[in,out] first the beginning of the range
+ * @param[in,out] last the end of the range
+ * @param[in] comp the comparison function
+ */
+template <typename RandomIt, typename Compare>
+void parallel_stable_sort(RandomIt first, RandomIt last, Compare comp)
+{
+  // below this size per thread, the threads cost more than they bring
+  const std::ptrdiff_t minChunkSize = 1 << 14;
+  const std::ptrdiff_t size = last - first;
+  const int nbChunks = static_cast<int>(std::min<std::ptrdiff_t>(omp_get_max_threads(), size / minChunkSize));
+
+  if(nbChunks <= 1)
+  {
+    std::stable_sort(first, last, comp);
+    return;
+  }
+
+  std::vector<std::ptrdiff_t> bounds(nbChunks + 1);
+  for(int i = 0; i <= nbChunks; ++i)
+    bounds[i] = size * i / nbChunks;
+
+  #pragma omp parallel for
+  for(int i = 0; i < nbChunks; ++i)
+    std::stable_sort(first + bounds[i], first + bounds[i + 1], comp);
+
+  for(int width = 1; width < nbChunks; width *= 2)
+  {
+    #pragma omp parallel for
+    for(int i = 0; i < nbChunks; i += 2 * width)
+    {
+      if(i + width >= nbChunks)
+        continue;
+      std::inplace_merge(first + bounds[i], first + bounds[i + width], first + bounds[std::min(i + 2 * width, nbChunks)], comp);
+    }
+  }
+}
+
+/// @see parallel_stable_sort
+template <typename RandomIt>
+void parallel_stable_sort(RandomIt first, RandomIt last)
+{
+  parallel_stable_sort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+} // namespace stl
@@ -0,0 +1,37 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/stl/parallelSort.hpp>
+
+#define BOOST_TEST_MODULE parallelSort
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(parallelSort_sameAsStableSort)
+{
+  std::mt19937 generator(42);
+  // few distinct keys, to check the stability
+  std::uniform_int_distribution<int> distribution(0, 1000);
+
+  for(int size : {0, 1, 1000, 100000, 1000003})
+  {
+    std::vector<std::pair<int, int>> values(size);
+    for(int i = 0; i < size; ++i)
+      values[i] = std::make_pair(distribution(generator), i);
+
+    const auto compareKeys = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+
+    std::vector<std::pair<int, int>> expected = values;
+    std::stable_sort(expected.begin(), expected.end(), compareKeys);
+
+    stl::parallel_stable_sort(values.begin(), values.end(), compareKeys);
+    BOOST_CHECK(values == expected);
+  }
+}
@@ -0,0 +1,144 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Thread-safe FIFO queue with a maximum capacity, used to connect the stages of a pipeline.
+ *
+ * push() blocks while the queue is full and pop() blocks while it is empty.
+ * Once close() has been called, push() fails and pop() returns the remaining
+ * elements then fails, so that consumers know the producers are done.
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+  /**
+   * @param[in] capacity The maximum number of elements in the queue (> 0)
+   */
+  explicit BoundedQueue(std::size_t capacity)
+    : _capacity(capacity)
+  {
+    assert(_capacity > 0);
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  /**
+   * @brief Add an element, wait while the queue is full.
+   * @param[in] value The element to add
+   * @return false if the queue has been closed, the element is then dropped
+   */
+  bool push(T value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notFull.wait(lock, [this]{ return _closed || _queue.size() < _capacity; });
+    if(_closed)
+      return false;
+    _queue.push_back(std::move(value));
+    lock.unlock();
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Add an element if the queue is not full, without waiting.
+   * @param[in] value The element to add
+   * @return false if the queue is full or closed, the element is then dropped
+   */
+  bool tryPush(T value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if(_closed || _queue.size() >= _capacity)
+      return false;
+    _queue.push_back(std::move(value));
+    lock.unlock();
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Remove the first element, wait while the queue is empty and not closed.
+   * @param[out] value The removed element
+   * @return false if the queue is closed and empty
+   */
+  bool pop(T& value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notEmpty.wait(lock, [this]{ return _closed || !_queue.empty(); });
+    if(_queue.empty())
+      return false;
+    value = std::move(_queue.front());
+    _queue.pop_front();
+    lock.unlock();
+    _notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Remove the first element if there is one, without waiting.
+   * @param[out] value The removed element
+   * @return false if the queue is empty
+   */
+  bool tryPop(T& value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if(_queue.empty())
+      return false;
+    value = std::move(_queue.front());
+    _queue.pop_front();
+    lock.unlock();
+    _notFull.notify_one();
+    return true;
+  }
+
+  /// Stop accepting new elements and wake up all the waiting threads.
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+    }
+    _notFull.notify_all();
+    _notEmpty.notify_all();
+  }
+
+  bool isClosed() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _closed;
+  }
+
+  std::size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+  }
+
+  std::size_t capacity() const { return _capacity; }
+
+private:
+  const std::size_t _capacity;
+  std::deque<T> _queue;
+  bool _closed = false;
+  mutable std::mutex _mutex;
+  std::condition_variable _notFull;
+  std::condition_variable _notEmpty;
+};
+
+} // namespace system
+} // namespace aliceVision
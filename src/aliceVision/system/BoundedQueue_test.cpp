@@ -0,0 +1,90 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/BoundedQueue.hpp>
+
+#define BOOST_TEST_MODULE BoundedQueue
+
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace aliceVision::system;
+
+BOOST_AUTO_TEST_CASE(BoundedQueue_fifo)
+{
+  BoundedQueue<int> queue(3);
+  BOOST_CHECK(queue.push(1));
+  BOOST_CHECK(queue.push(2));
+  BOOST_CHECK_EQUAL(queue.size(), 2);
+
+  int value = 0;
+  BOOST_CHECK(queue.pop(value));
+  BOOST_CHECK_EQUAL(value, 1);
+  BOOST_CHECK(queue.tryPop(value));
+  BOOST_CHECK_EQUAL(value, 2);
+  BOOST_CHECK(!queue.tryPop(value));
+
+  BOOST_CHECK(queue.tryPush(5));
+  BOOST_CHECK(queue.tryPush(6));
+  BOOST_CHECK(queue.tryPush(7));
+  // full
+  BOOST_CHECK(!queue.tryPush(8));
+  BOOST_CHECK_EQUAL(queue.size(), 3);
+  for(int expected : {5, 6, 7})
+  {
+    BOOST_CHECK(queue.pop(value));
+    BOOST_CHECK_EQUAL(value, expected);
+  }
+
+  queue.push(3);
+  queue.close();
+  BOOST_CHECK(!queue.push(4));
+  // remaining elements are still returned after close
+  BOOST_CHECK(queue.pop(value));
+  BOOST_CHECK_EQUAL(value, 3);
+  BOOST_CHECK(!queue.pop(value));
+}
+
+BOOST_AUTO_TEST_CASE(BoundedQueue_producersConsumers)
+{
+  const int nbProducers = 4;
+  const int nbValues = 1000;
+
+  BoundedQueue<int> queue(8);
+  std::vector<long long> sums(nbProducers, 0);
+
+  std::vector<std::thread> consumers;
+  for(int c = 0; c < nbProducers; ++c)
+  {
+    consumers.emplace_back([&queue, &sums, c]{
+      int value;
+      while(queue.pop(value))
+        sums[c] += value;
+    });
+  }
+
+  std::vector<std::thread> producers;
+  for(int p = 0; p < nbProducers; ++p)
+  {
+    producers.emplace_back([&queue]{
+      for(int i = 1; i <= nbValues; ++i)
+        queue.push(i);
+    });
+  }
+
+  for(std::thread& producer : producers)
+    producer.join();
+  queue.close();
+  for(std::thread& consumer : consumers)
+    consumer.join();
+
+  long long total = 0;
+  for(long long sum : sums)
+    total += sum;
+  BOOST_CHECK_EQUAL(total, static_cast<long long>(nbProducers) * nbValues * (nbValues + 1) / 2);
+}
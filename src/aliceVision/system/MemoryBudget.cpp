@@ -0,0 +1,294 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "MemoryBudget.hpp"
+
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace aliceVision {
+namespace system {
+
+MemoryBudget& MemoryBudget::get()
+{
+  static MemoryBudget budget;
+  return budget;
+}
+
+void MemoryBudget::setMaxMemory(std::size_t maxBytes)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maxBytes = maxBytes;
+  }
+  _released.notify_all();
+}
+
+void MemoryBudget::initMaxMemory() const
+{
+  if(_maxBytes != 0)
+    return;
+
+  const MemoryInfo memoryInformation = getMemoryInfo();
+  if(memoryInformation.freeRam == 0)
+  {
+    ALICEVISION_LOG_WARNING("Cannot find available system memory, this can be due to OS limitations.\n"
+                            "The memory budget is not limited, use --maxMemory to set it.");
+    _maxBytes = std::numeric_limits<std::size_t>::max();
+  }
+  else
+  {
+    _maxBytes = static_cast<std::size_t>(0.9 * memoryInformation.freeRam);
+  }
+}
+
+std::size_t MemoryBudget::getMaxMemory() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  initMaxMemory();
+  return _maxBytes;
+}
+
+bool MemoryBudget::isLimited() const
+{
+  return getMaxMemory() != std::numeric_limits<std::size_t>::max();
+}
+
+std::size_t MemoryBudget::getUsedMemory() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _usedBytes;
+}
+
+std::size_t MemoryBudget::getAvailableMemory() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  initMaxMemory();
+  return (_usedBytes < _maxBytes) ? _maxBytes - _usedBytes : 0;
+}
+
+MemoryReservation MemoryBudget::reserve(const std::string& stage, std::size_t bytes)
+{
+  const auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(_mutex);
+  initMaxMemory();
+  _released.wait(lock, [&]{ return _usedBytes + bytes <= _maxBytes || _nbReservations == 0; });
+
+  Stage& s = _stages[stage];
+  s.report.waitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  ++s.report.nbReservations;
+  if(_usedBytes + bytes > _maxBytes)
+  {
+    ++s.report.nbOversized;
+    ALICEVISION_LOG_WARNING("Memory reservation of " << (bytes >> 20) << " MB for " << stage
+                            << " exceeds the memory budget of " << (_maxBytes >> 20) << " MB.");
+  }
+  ++_nbReservations;
+  addLocked(stage, bytes);
+  return MemoryReservation(stage, bytes);
+}
+
+bool MemoryBudget::tryReserve(const std::string& stage, std::size_t bytes, MemoryReservation& reservation)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  initMaxMemory();
+  if(_usedBytes + bytes > _maxBytes && _nbReservations != 0)
+    return false;
+
+  Stage& s = _stages[stage];
+  ++s.report.nbReservations;
+  if(_usedBytes + bytes > _maxBytes)
+    ++s.report.nbOversized;
+  ++_nbReservations;
+  addLocked(stage, bytes);
+  lock.unlock();
+
+  // releases the previous reservation, which needs the lock
+  reservation = MemoryReservation(stage, bytes);
+  return true;
+}
+
+std::size_t MemoryBudget::getMaxParallelJobs(std::size_t bytesPerJob, std::size_t maxJobs) const
+{
+  if(maxJobs == 0)
+    return 1;
+  if(bytesPerJob == 0)
+    return maxJobs;
+  return std::max<std::size_t>(1, std::min(maxJobs, getAvailableMemory() / bytesPerJob));
+}
+
+void MemoryBudget::add(const std::string& stage, std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  addLocked(stage, bytes);
+}
+
+void MemoryBudget::addLocked(const std::string& stage, std::size_t bytes)
+{
+  Stage& s = _stages[stage];
+  s.usedBytes += bytes;
+  s.report.peakBytes = std::max(s.report.peakBytes, s.usedBytes);
+  _usedBytes += bytes;
+  _peakBytes = std::max(_peakBytes, _usedBytes);
+}
+
+void MemoryBudget::remove(const std::string& stage, std::size_t bytes, bool endReservation)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(endReservation)
+      --_nbReservations;
+    Stage& s = _stages[stage];
+    s.usedBytes -= std::min(s.usedBytes, bytes);
+    _usedBytes -= std::min(_usedBytes, bytes);
+  }
+  _released.notify_all();
+}
+
+std::vector<MemoryBudget::StageReport> MemoryBudget::getReport() const
+{
+  std::vector<StageReport> report;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(const auto& stage : _stages)
+    {
+      report.push_back(stage.second.report);
+      report.back().name = stage.first;
+    }
+  }
+  std::stable_sort(report.begin(), report.end(), [](const StageReport& a, const StageReport& b) {
+    return a.peakBytes > b.peakBytes;
+  });
+  return report;
+}
+
+void MemoryBudget::logReport() const
+{
+  const std::vector<StageReport> report = getReport();
+  if(report.empty())
+    return;
+
+  const double toMB = 1.0 / (1024.0 * 1024.0);
+  std::ostringstream os;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    os << "Memory budget: " << std::fixed << std::setprecision(1) << _maxBytes * toMB
+       << " MB, peak reserved: " << _peakBytes * toMB << " MB" << std::endl;
+  }
+  os << std::left << std::setw(32) << "stage" << std::right
+     << std::setw(16) << "peak (MB)"
+     << std::setw(16) << "reservations"
+     << std::setw(16) << "wait (ms)"
+     << std::setw(16) << "oversized" << std::endl;
+  for(const StageReport& stage : report)
+  {
+    os << std::left << std::setw(32) << stage.name << std::right
+       << std::setw(16) << stage.peakBytes * toMB
+       << std::setw(16) << stage.nbReservations
+       << std::setw(16) << stage.waitMs
+       << std::setw(16) << stage.nbOversized << std::endl;
+  }
+  ALICEVISION_LOG_INFO(os.str());
+}
+
+MemoryReservation::MemoryReservation(const std::string& stage)
+  : _stage(stage)
+{}
+
+MemoryReservation::MemoryReservation(MemoryReservation&& other)
+  : _stage(std::move(other._stage))
+  , _bytes(other._bytes)
+  , _reserved(other._reserved)
+{
+  other._bytes = 0;
+  other._reserved = false;
+}
+
+MemoryReservation& MemoryReservation::operator=(MemoryReservation&& other)
+{
+  if(this != &other)
+  {
+    release();
+    _stage = std::move(other._stage);
+    _bytes = other._bytes;
+    _reserved = other._reserved;
+    other._bytes = 0;
+    other._reserved = false;
+  }
+  return *this;
+}
+
+MemoryReservation::~MemoryReservation()
+{
+  release();
+}
+
+void MemoryReservation::grow(std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _bytes += bytes;
+  MemoryBudget::get().add(_stage, bytes);
+}
+
+void MemoryReservation::shrink(std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  bytes = std::min(bytes, _bytes);
+  _bytes -= bytes;
+  MemoryBudget::get().remove(_stage, bytes, false);
+}
+
+void MemoryReservation::release()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  if(_bytes == 0 && !_reserved)
+    return;
+  MemoryBudget::get().remove(_stage, _bytes, _reserved);
+  _bytes = 0;
+  _reserved = false;
+}
+
+std::size_t extractMaxMemoryOption(int& argc, char* argv[])
+{
+  std::string maxMemory;
+  if(!extractCommandLineOption(argc, argv, "--maxMemory", maxMemory))
+  {
+    const char* envMaxMemory = std::getenv("ALICEVISION_MAX_MEMORY");
+    if(envMaxMemory == nullptr)
+      return 0;
+    maxMemory = envMaxMemory;
+  }
+
+  const std::invalid_argument invalidValue("Invalid value for the maximum memory: '" + maxMemory + "', it should be a number of MB.");
+
+  // in MB, std::stoull accepts a sign and wraps the negative values
+  if(maxMemory.empty() || maxMemory.find_first_not_of("0123456789") != std::string::npos)
+    throw invalidValue;
+
+  unsigned long long maxMemoryMB = 0;
+  try
+  {
+    maxMemoryMB = std::stoull(maxMemory);
+  }
+  catch(const std::exception&)
+  {
+    throw invalidValue;
+  }
+  if(maxMemoryMB > std::numeric_limits<std::size_t>::max() / (1024 * 1024))
+    throw invalidValue;
+  return static_cast<std::size_t>(maxMemoryMB) * 1024 * 1024;
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,179 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+class MemoryReservation;
+
+/**
+ * @brief Process-wide memory budget shared by the memory-hungry stages.
+ *
+ * The stages reserve the memory they are about to use under a stage name, and release
+ * it when done (see MemoryReservation). The sum of the reservations stays below the
+ * maximum memory: reserve() waits for other reservations to be released, tryReserve()
+ * fails immediately so the caller can back off.
+ * Long-lived memory (caches, buffers kept during a whole stage) is accounted with
+ * MemoryReservation::grow() and shrink(): it reduces the memory available to the others,
+ * but reserve() does not wait for it to be released, as it may never be.
+ * The maximum memory is set by the user (--maxMemory option of the programs, see main.hpp),
+ * otherwise it is 90% of the free RAM when the budget is first used.
+ */
+class MemoryBudget
+{
+public:
+  /// peak usage of a stage
+  struct StageReport
+  {
+    std::string name;
+    std::size_t peakBytes = 0;
+    std::size_t nbReservations = 0;
+    /// time spent waiting in reserve()
+    double waitMs = 0.0;
+    /// number of reservations granted beyond the budget
+    std::size_t nbOversized = 0;
+  };
+
+  static MemoryBudget& get();
+
+  /**
+   * @brief Set the maximum memory of the process
+   * @param[in] maxBytes The maximum memory in bytes, 0 to use 90% of the free RAM
+   */
+  void setMaxMemory(std::size_t maxBytes);
+  std::size_t getMaxMemory() const;
+
+  /// @return false if the free RAM is unknown and the maximum memory has not been set
+  bool isLimited() const;
+
+  /// @return the memory reserved by all the stages
+  std::size_t getUsedMemory() const;
+
+  /// @return the memory that can still be reserved
+  std::size_t getAvailableMemory() const;
+
+  /**
+   * @brief Reserve memory, wait until it is available.
+   * The reservation is granted anyway when no other reservation from reserve() or
+   * tryReserve() is held, so it cannot wait forever (for instance if it is larger
+   * than the whole budget).
+   * @param[in] stage The stage name, used for the report
+   * @param[in] bytes The memory to reserve
+   */
+  MemoryReservation reserve(const std::string& stage, std::size_t bytes);
+
+  /**
+   * @brief Reserve memory if it is available, without waiting
+   * @return true if the memory has been reserved in reservation
+   */
+  bool tryReserve(const std::string& stage, std::size_t bytes, MemoryReservation& reservation);
+
+  /**
+   * @brief Number of jobs of the given size that can run in parallel within the available memory
+   * @param[in] bytesPerJob The memory used by one job
+   * @param[in] maxJobs The maximum number of jobs
+   * @return a number of jobs between 1 and maxJobs
+   */
+  std::size_t getMaxParallelJobs(std::size_t bytesPerJob, std::size_t maxJobs) const;
+
+  /// @return the peak usage per stage, sorted by decreasing peak
+  std::vector<StageReport> getReport() const;
+
+  /// log the peak usage per stage, if any memory has been reserved
+  void logReport() const;
+
+private:
+  friend class MemoryReservation;
+
+  struct Stage
+  {
+    std::size_t usedBytes = 0;
+    StageReport report;
+  };
+
+  MemoryBudget() = default;
+
+  /// initialize the maximum memory from the free RAM if not set, with the lock held
+  void initMaxMemory() const;
+  void add(const std::string& stage, std::size_t bytes);
+  /// same as add, with the lock held
+  void addLocked(const std::string& stage, std::size_t bytes);
+  void remove(const std::string& stage, std::size_t bytes, bool endReservation);
+
+  mutable std::mutex _mutex;
+  std::condition_variable _released;
+  mutable std::size_t _maxBytes = 0;
+  std::size_t _usedBytes = 0;
+  std::size_t _peakBytes = 0;
+  /// number of reservations from reserve() and tryReserve() currently held
+  std::size_t _nbReservations = 0;
+  std::map<std::string, Stage> _stages;
+};
+
+/**
+ * @brief Memory reserved in the MemoryBudget by a stage, released on destruction.
+ */
+class MemoryReservation
+{
+public:
+  MemoryReservation() = default;
+  MemoryReservation(MemoryReservation&& other);
+  MemoryReservation& operator=(MemoryReservation&& other);
+  MemoryReservation(const MemoryReservation&) = delete;
+  MemoryReservation& operator=(const MemoryReservation&) = delete;
+  ~MemoryReservation();
+
+  /**
+   * @brief Create an empty reservation for a stage, to be adjusted with grow() and shrink()
+   * by a component regulating its own memory usage (like a cache)
+   */
+  explicit MemoryReservation(const std::string& stage);
+
+  std::size_t getBytes() const { return _bytes; }
+
+  /// add memory to the reservation without waiting, it can exceed the budget
+  void grow(std::size_t bytes);
+  void shrink(std::size_t bytes);
+
+  /// release all the reserved memory
+  void release();
+
+private:
+  friend class MemoryBudget;
+
+  MemoryReservation(const std::string& stage, std::size_t bytes)
+    : _stage(stage)
+    , _bytes(bytes)
+    , _reserved(true)
+  {}
+
+  std::string _stage;
+  std::size_t _bytes = 0;
+  /// true if obtained from reserve() or tryReserve() and not released
+  bool _reserved = false;
+  std::mutex _mutex;
+};
+
+/**
+ * @brief Remove the memory option (--maxMemory <MB> or --maxMemory=<MB>) from the command
+ * line arguments. If the option is not set, use the ALICEVISION_MAX_MEMORY environment variable.
+ * @param[in,out] argc The number of arguments
+ * @param[in,out] argv The arguments
+ * @return the maximum memory in bytes, 0 if not set
+ */
+std::size_t extractMaxMemoryOption(int& argc, char* argv[]);
+
+} // namespace system
+} // namespace aliceVision
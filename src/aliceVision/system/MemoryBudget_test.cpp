@@ -0,0 +1,148 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/MemoryBudget.hpp>
+
+#define BOOST_TEST_MODULE MemoryBudget
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aliceVision::system;
+
+BOOST_AUTO_TEST_CASE(MemoryBudget_reserve)
+{
+  MemoryBudget& budget = MemoryBudget::get();
+  budget.setMaxMemory(1000);
+
+  {
+    MemoryReservation a = budget.reserve("a", 600);
+    BOOST_CHECK_EQUAL(budget.getUsedMemory(), 600);
+    BOOST_CHECK_EQUAL(budget.getAvailableMemory(), 400);
+    BOOST_CHECK_EQUAL(budget.getMaxParallelJobs(100, 10), 4);
+    BOOST_CHECK_EQUAL(budget.getMaxParallelJobs(500, 10), 1);
+
+    // back-off
+    MemoryReservation b;
+    BOOST_CHECK(!budget.tryReserve("b", 500, b));
+    BOOST_CHECK(budget.tryReserve("b", 400, b));
+    BOOST_CHECK_EQUAL(b.getBytes(), 400);
+    BOOST_CHECK_EQUAL(budget.getAvailableMemory(), 0);
+
+    b.release();
+    BOOST_CHECK_EQUAL(budget.getUsedMemory(), 600);
+
+    // moved reservations are released once
+    MemoryReservation c = std::move(a);
+    BOOST_CHECK_EQUAL(a.getBytes(), 0);
+    BOOST_CHECK_EQUAL(c.getBytes(), 600);
+  }
+  BOOST_CHECK_EQUAL(budget.getUsedMemory(), 0);
+
+  // larger than the budget: granted when nothing else is reserved
+  {
+    MemoryReservation big = budget.reserve("big", 2000);
+    BOOST_CHECK_EQUAL(budget.getUsedMemory(), 2000);
+  }
+
+  // a component regulating its own memory
+  {
+    MemoryReservation cache("cache");
+    cache.grow(300);
+    cache.grow(300);
+    cache.shrink(100);
+    BOOST_CHECK_EQUAL(budget.getUsedMemory(), 500);
+
+    // long-lived memory does not block the reservations forever
+    MemoryReservation job = budget.reserve("job", 600);
+    BOOST_CHECK_EQUAL(budget.getUsedMemory(), 1100);
+    MemoryReservation otherJob;
+    BOOST_CHECK(!budget.tryReserve("job", 100, otherJob));
+  }
+  BOOST_CHECK_EQUAL(budget.getUsedMemory(), 0);
+
+  const std::vector<MemoryBudget::StageReport> report = budget.getReport();
+  const auto findStage = [&](const std::string& name) {
+    return *std::find_if(report.begin(), report.end(), [&](const MemoryBudget::StageReport& s) { return s.name == name; });
+  };
+  BOOST_CHECK_EQUAL(findStage("a").peakBytes, 600);
+  BOOST_CHECK_EQUAL(findStage("b").peakBytes, 400);
+  BOOST_CHECK_EQUAL(findStage("b").nbReservations, 1);
+  BOOST_CHECK_EQUAL(findStage("big").nbOversized, 1);
+  BOOST_CHECK_EQUAL(findStage("cache").peakBytes, 600);
+  BOOST_CHECK_EQUAL(findStage("cache").nbReservations, 0);
+  BOOST_CHECK_EQUAL(findStage("job").nbOversized, 1);
+  BOOST_CHECK_EQUAL(report.front().name, "big");
+}
+
+BOOST_AUTO_TEST_CASE(MemoryBudget_parallelWorkers)
+{
+  MemoryBudget& budget = MemoryBudget::get();
+  budget.setMaxMemory(1000);
+
+  const int nbThreads = 8;
+  std::atomic<std::size_t> maxUsed(0);
+  std::vector<std::thread> threads;
+  for(int t = 0; t < nbThreads; ++t)
+  {
+    threads.emplace_back([&]{
+      for(int i = 0; i < 50; ++i)
+      {
+        MemoryReservation reservation = budget.reserve("worker", 300);
+        const std::size_t used = budget.getUsedMemory();
+        std::size_t expected = maxUsed.load();
+        while(used > expected && !maxUsed.compare_exchange_weak(expected, used))
+          ;
+        std::this_thread::yield();
+      }
+    });
+  }
+  for(std::thread& thread : threads)
+    thread.join();
+
+  // at most 3 workers at the same time
+  BOOST_CHECK_LE(maxUsed.load(), 900);
+  BOOST_CHECK_EQUAL(budget.getUsedMemory(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MemoryBudget_commandLine)
+{
+  char arg0[] = "program";
+  char arg1[] = "--maxMemory=2048";
+  char arg2[] = "-v";
+  char* argv[] = {arg0, arg1, arg2, nullptr};
+  int argc = 3;
+
+  BOOST_CHECK_EQUAL(extractMaxMemoryOption(argc, argv), 2048ull * 1024 * 1024);
+  BOOST_CHECK_EQUAL(argc, 2);
+
+  char arg3[] = "--maxMemory";
+  char arg4[] = "a lot";
+  char* argv2[] = {arg0, arg3, arg4, nullptr};
+  argc = 3;
+  BOOST_CHECK_THROW(extractMaxMemoryOption(argc, argv2), std::invalid_argument);
+
+  // negative, partial and overflowing values
+  for(std::string value : {"-1", "+1", " 1", "12MB", "", "17592186044416", "99999999999999999999999"})
+  {
+    std::string option = "--maxMemory=" + value;
+    char* argv3[] = {arg0, &option[0], nullptr};
+    argc = 2;
+    BOOST_CHECK_THROW(extractMaxMemoryOption(argc, argv3), std::invalid_argument);
+  }
+
+  // the largest value in bytes
+  std::string option = "--maxMemory=" + std::to_string(std::numeric_limits<std::size_t>::max() / (1024 * 1024));
+  char* argv4[] = {arg0, &option[0], nullptr};
+  argc = 2;
+  BOOST_CHECK_EQUAL(extractMaxMemoryOption(argc, argv4), (std::numeric_limits<std::size_t>::max() >> 20) << 20);
+}
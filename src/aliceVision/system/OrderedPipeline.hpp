@@ -0,0 +1,219 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/BoundedQueue.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Gather the elements processed concurrently and give them back in index order.
+ * An element is only accepted if it is at most window elements ahead of the next element to
+ * give back, which bounds the memory used by the elements processed out of order.
+ */
+template<class T>
+class OrderedBuffer
+{
+public:
+  /**
+   * @param[in] window The maximum distance between the index of a pushed element and the next index to pop
+   */
+  explicit OrderedBuffer(std::size_t window)
+    : _window(std::max<std::size_t>(window, 1))
+  {}
+
+  OrderedBuffer(const OrderedBuffer&) = delete;
+  OrderedBuffer& operator=(const OrderedBuffer&) = delete;
+
+  /**
+   * @brief Add the element of the given index, wait while it is too far ahead.
+   * @return false if the buffer has been closed
+   */
+  bool push(std::size_t index, T value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _canPush.wait(lock, [&]{ return _closed || index < _next + _window; });
+    if(_closed)
+      return false;
+    _elements.emplace(index, std::move(value));
+    lock.unlock();
+    _canPop.notify_all();
+    return true;
+  }
+
+  /**
+   * @brief Remove the next element in index order, wait until it is available.
+   * @return false if the buffer has been closed or if all the elements have been given back
+   */
+  bool pop(T& value)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _canPop.wait(lock, [&]{ return _closed || _next == _end || _elements.count(_next); });
+    if(_closed || _next == _end)
+      return false;
+    auto it = _elements.find(_next);
+    value = std::move(it->second);
+    _elements.erase(it);
+    ++_next;
+    lock.unlock();
+    _canPush.notify_all();
+    return true;
+  }
+
+  /// set the total number of elements, once known
+  void setEnd(std::size_t end)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _end = end;
+    }
+    _canPop.notify_all();
+  }
+
+  /// abort: wake up and release all the waiting threads
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+    }
+    _canPush.notify_all();
+    _canPop.notify_all();
+  }
+
+private:
+  const std::size_t _window;
+  std::size_t _next = 0;
+  std::size_t _end = std::numeric_limits<std::size_t>::max();
+  bool _closed = false;
+  std::map<std::size_t, T> _elements;
+  std::mutex _mutex;
+  std::condition_variable _canPush;
+  std::condition_variable _canPop;
+};
+
+/**
+ * @brief Run a 3 stages pipeline on a sequence of elements:
+ *  - a reader thread reads the elements one after the other: read(index, element) returns false at the end;
+ *  - nbWorkers threads process the elements concurrently: process(element, workerIndex);
+ *  - the calling thread receives the processed elements in the reading order: output(index, element).
+ * The stages are connected by bounded queues of queueSize elements.
+ *
+ * An exception thrown by any stage stops the pipeline, the first one is rethrown by this function.
+ *
+ * @return the number of elements given to output
+ */
+template<class T, class ReadFunc, class ProcessFunc, class OutputFunc>
+std::size_t runOrderedPipeline(std::size_t nbWorkers, std::size_t queueSize, ReadFunc read, ProcessFunc process, OutputFunc output)
+{
+  nbWorkers = std::max<std::size_t>(nbWorkers, 1);
+  queueSize = std::max<std::size_t>(queueSize, 1);
+
+  BoundedQueue<std::pair<std::size_t, T>> inputElements(queueSize);
+  OrderedBuffer<T> processedElements(queueSize + nbWorkers);
+
+  std::mutex errorMutex;
+  std::exception_ptr error;
+
+  // stop all the stages and keep the first error
+  const auto stopOnError = [&](std::exception_ptr e)
+  {
+    {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if(!error)
+        error = e;
+    }
+    inputElements.close();
+    processedElements.close();
+  };
+
+  std::thread reader([&]()
+  {
+    try
+    {
+      std::size_t nbElements = 0;
+      while(true)
+      {
+        T element;
+        if(!read(nbElements, element))
+          break;
+        if(!inputElements.push(std::make_pair(nbElements, std::move(element))))
+          break;
+        ++nbElements;
+      }
+      processedElements.setEnd(nbElements);
+      inputElements.close();
+    }
+    catch(...)
+    {
+      stopOnError(std::current_exception());
+    }
+  });
+
+  std::vector<std::thread> workers;
+  workers.reserve(nbWorkers);
+  for(std::size_t i = 0; i < nbWorkers; ++i)
+  {
+    workers.emplace_back([&, i]()
+    {
+      try
+      {
+        std::pair<std::size_t, T> element;
+        while(inputElements.pop(element))
+        {
+          process(element.second, i);
+          if(!processedElements.push(element.first, std::move(element.second)))
+            break;
+        }
+      }
+      catch(...)
+      {
+        stopOnError(std::current_exception());
+      }
+    });
+  }
+
+  // in-order stage, on the calling thread
+  std::size_t nbElements = 0;
+  try
+  {
+    T element;
+    while(processedElements.pop(element))
+    {
+      output(nbElements, element);
+      ++nbElements;
+    }
+  }
+  catch(...)
+  {
+    stopOnError(std::current_exception());
+  }
+
+  reader.join();
+  for(std::thread& worker : workers)
+    worker.join();
+
+  if(error)
+    std::rethrow_exception(error);
+
+  return nbElements;
+}
+
+} // namespace system
+} // namespace aliceVision
@@ -0,0 +1,224 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/OrderedPipeline.hpp>
+
+#define BOOST_TEST_MODULE OrderedPipeline
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aliceVision::system;
+
+namespace {
+
+/// fake feed of frames: each frame is its path, read and processed with small delays
+struct FakeFrame
+{
+  std::size_t id = 0;
+  std::string mediaPath;
+  int result = 0;
+};
+
+typedef std::unique_ptr<FakeFrame> FakeFramePtr;
+
+void waitMicroseconds(std::size_t us)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(OrderedBuffer_order)
+{
+  OrderedBuffer<int> buffer(4);
+  BOOST_CHECK(buffer.push(2, 20));
+  BOOST_CHECK(buffer.push(0, 0));
+  BOOST_CHECK(buffer.push(3, 30));
+  BOOST_CHECK(buffer.push(1, 10));
+  buffer.setEnd(4);
+
+  int value = -1;
+  for(int expected : {0, 10, 20, 30})
+  {
+    BOOST_CHECK(buffer.pop(value));
+    BOOST_CHECK_EQUAL(value, expected);
+  }
+  // all the elements have been given back
+  BOOST_CHECK(!buffer.pop(value));
+}
+
+BOOST_AUTO_TEST_CASE(OrderedBuffer_window)
+{
+  OrderedBuffer<int> buffer(2);
+  std::atomic<bool> pushed(false);
+  bool pushResult = false;
+
+  // the index 2 is too far ahead of the next index to pop (0)
+  std::thread producer([&]()
+  {
+    pushResult = buffer.push(2, 20);
+    pushed = true;
+  });
+
+  BOOST_CHECK(buffer.push(0, 0));
+  waitMicroseconds(20000);
+  BOOST_CHECK(!pushed);
+
+  int value = -1;
+  BOOST_CHECK(buffer.pop(value));
+  BOOST_CHECK_EQUAL(value, 0);
+  BOOST_CHECK(buffer.push(1, 10));
+  BOOST_CHECK(buffer.pop(value));
+  BOOST_CHECK_EQUAL(value, 10);
+  producer.join();
+  BOOST_CHECK(pushed);
+  BOOST_CHECK(pushResult);
+  BOOST_CHECK(buffer.pop(value));
+  BOOST_CHECK_EQUAL(value, 20);
+}
+
+BOOST_AUTO_TEST_CASE(OrderedBuffer_close)
+{
+  OrderedBuffer<int> buffer(1);
+  bool popResult = true;
+  std::thread consumer([&]()
+  {
+    int value = -1;
+    // nothing to pop: released by close
+    popResult = buffer.pop(value);
+  });
+  waitMicroseconds(10000);
+  buffer.close();
+  consumer.join();
+  BOOST_CHECK(!popResult);
+  BOOST_CHECK(!buffer.push(0, 0));
+}
+
+BOOST_AUTO_TEST_CASE(OrderedPipeline_inOrderCallbacks)
+{
+  const std::size_t nbFrames = 200;
+
+  for(std::size_t nbWorkers : {1, 2, 5})
+  {
+    std::vector<std::size_t> outputIds;
+    std::atomic<std::size_t> nbProcessed(0);
+    std::atomic<std::size_t> nbInvalidWorkers(0);
+
+    const std::size_t nbOutputs = runOrderedPipeline<FakeFramePtr>(nbWorkers, 2 * nbWorkers,
+      [&](std::size_t index, FakeFramePtr& frame)
+      {
+        if(index == nbFrames)
+          return false;
+        frame.reset(new FakeFrame());
+        frame->id = index;
+        frame->mediaPath = "frame_" + std::to_string(index) + ".jpg";
+        return true;
+      },
+      [&](FakeFramePtr& frame, std::size_t workerIndex)
+      {
+        if(workerIndex >= nbWorkers)
+          ++nbInvalidWorkers;
+        // uneven processing times, so that the frames end out of order
+        waitMicroseconds((frame->id * 7919) % 500);
+        frame->result = static_cast<int>(frame->id * 2);
+        ++nbProcessed;
+      },
+      [&](std::size_t index, FakeFramePtr& frame)
+      {
+        BOOST_CHECK_EQUAL(frame->id, index);
+        BOOST_CHECK_EQUAL(frame->mediaPath, "frame_" + std::to_string(index) + ".jpg");
+        BOOST_CHECK_EQUAL(frame->result, static_cast<int>(2 * index));
+        outputIds.push_back(frame->id);
+      });
+
+    BOOST_CHECK_EQUAL(nbOutputs, nbFrames);
+    BOOST_CHECK_EQUAL(nbProcessed, nbFrames);
+    BOOST_CHECK_EQUAL(nbInvalidWorkers, 0);
+    BOOST_REQUIRE_EQUAL(outputIds.size(), nbFrames);
+    for(std::size_t i = 0; i < nbFrames; ++i)
+      BOOST_CHECK_EQUAL(outputIds[i], i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(OrderedPipeline_emptyFeed)
+{
+  std::atomic<std::size_t> nbProcessed(0);
+  const std::size_t nbOutputs = runOrderedPipeline<FakeFramePtr>(3, 6,
+    [](std::size_t, FakeFramePtr&) { return false; },
+    [&](FakeFramePtr&, std::size_t) { ++nbProcessed; },
+    [](std::size_t, FakeFramePtr&) { BOOST_ERROR("no frame to output"); });
+  BOOST_CHECK_EQUAL(nbOutputs, 0);
+  BOOST_CHECK_EQUAL(nbProcessed, 0);
+}
+
+BOOST_AUTO_TEST_CASE(OrderedPipeline_exceptions)
+{
+  const std::size_t nbFrames = 100;
+  const auto readFrame = [&](std::size_t index, FakeFramePtr& frame)
+  {
+    if(index == nbFrames)
+      return false;
+    frame.reset(new FakeFrame());
+    frame->id = index;
+    return true;
+  };
+  const auto processFrame = [](FakeFramePtr& frame, std::size_t) { waitMicroseconds(frame->id % 50); };
+
+  // error while reading the feed
+  {
+    std::size_t nbOutputs = 0;
+    BOOST_CHECK_THROW(runOrderedPipeline<FakeFramePtr>(4, 8,
+      [&](std::size_t index, FakeFramePtr& frame)
+      {
+        if(index == 30)
+          throw std::runtime_error("Can't read frame");
+        return readFrame(index, frame);
+      },
+      processFrame,
+      [&](std::size_t, FakeFramePtr&) { ++nbOutputs; }), std::runtime_error);
+    BOOST_CHECK_LE(nbOutputs, 30);
+  }
+
+  // error while processing a frame: the frames after it are not given back
+  {
+    std::vector<std::size_t> outputIds;
+    BOOST_CHECK_THROW(runOrderedPipeline<FakeFramePtr>(4, 8,
+      readFrame,
+      [&](FakeFramePtr& frame, std::size_t workerIndex)
+      {
+        if(frame->id == 42)
+          throw std::invalid_argument("Can't describe frame");
+        processFrame(frame, workerIndex);
+      },
+      [&](std::size_t, FakeFramePtr& frame) { outputIds.push_back(frame->id); }), std::invalid_argument);
+    BOOST_CHECK_LE(outputIds.size(), 42);
+    for(std::size_t i = 0; i < outputIds.size(); ++i)
+      BOOST_CHECK_EQUAL(outputIds[i], i);
+  }
+
+  // error in the in-order callback: the pipeline stops
+  {
+    std::size_t nbOutputs = 0;
+    BOOST_CHECK_THROW(runOrderedPipeline<FakeFramePtr>(4, 8,
+      readFrame,
+      processFrame,
+      [&](std::size_t index, FakeFramePtr&)
+      {
+        if(index == 10)
+          throw std::logic_error("Can't write result");
+        ++nbOutputs;
+      }), std::logic_error);
+    BOOST_CHECK_EQUAL(nbOutputs, 10);
+  }
+}
@@ -0,0 +1,316 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Tracer.hpp"
+
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace aliceVision {
+namespace system {
+
+namespace {
+
+struct TraceEvent
+{
+  const char* name = nullptr;
+  /// since the clock epoch
+  std::int64_t startNs = 0;
+  std::int64_t durationNs = 0;
+  /// resident memory at the end of the zone
+  std::size_t residentMemory = 0;
+};
+
+struct ZoneStats
+{
+  std::size_t calls = 0;
+  std::int64_t totalNs = 0;
+  std::int64_t maxNs = 0;
+  std::size_t peakResidentMemory = 0;
+};
+
+void writeJsonString(std::ostream& os, const char* str)
+{
+  os << '"';
+  for(const char* c = str; *c != '\0'; ++c)
+  {
+    if(*c == '"' || *c == '\\')
+      os << '\\' << *c;
+    else if(static_cast<unsigned char>(*c) < 0x20)
+      os << ' ';
+    else
+      os << *c;
+  }
+  os << '"';
+}
+
+} // namespace
+
+struct Tracer::ThreadBuffer
+{
+  explicit ThreadBuffer(std::size_t threadIndex)
+    : threadIndex(threadIndex)
+  {}
+
+  std::mutex mutex;
+  const std::size_t threadIndex;
+  /// ring buffer of the zones
+  std::vector<TraceEvent> events;
+  /// total number of recorded zones, the next one goes at nbRecorded % events.size()
+  std::size_t nbRecorded = 0;
+  /// statistics per zone name pointer, merged by name in the summary
+  std::unordered_map<const char*, ZoneStats> stats;
+};
+
+std::atomic<bool> Tracer::_enabled(false);
+
+Tracer& Tracer::get()
+{
+  static Tracer tracer;
+  return tracer;
+}
+
+void Tracer::enable(std::size_t eventsPerThread)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _eventsPerThread = std::max<std::size_t>(eventsPerThread, 1);
+  }
+  clear();
+  _enabled.store(true);
+}
+
+void Tracer::disable()
+{
+  _enabled.store(false);
+}
+
+Tracer::ThreadBuffer& Tracer::getThreadBuffer()
+{
+  // the buffer is shared with the tracer, so it is still exported after the thread exits
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if(!buffer)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    buffer = std::make_shared<ThreadBuffer>(_buffers.size());
+    buffer->events.resize(_eventsPerThread);
+    _buffers.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void Tracer::record(const char* name, Clock::time_point start, Clock::time_point end)
+{
+  ThreadBuffer& buffer = getThreadBuffer();
+  const std::int64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  // the current resident memory, not the peak of the process which never decreases
+  const std::size_t residentMemory = getResidentMemory();
+
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+
+  TraceEvent& event = buffer.events[buffer.nbRecorded % buffer.events.size()];
+  event.name = name;
+  event.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+  event.durationNs = durationNs;
+  event.residentMemory = residentMemory;
+  ++buffer.nbRecorded;
+
+  ZoneStats& stats = buffer.stats[name];
+  ++stats.calls;
+  stats.totalNs += durationNs;
+  stats.maxNs = std::max(stats.maxNs, durationNs);
+  stats.peakResidentMemory = std::max(stats.peakResidentMemory, residentMemory);
+}
+
+void Tracer::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _origin = Clock::now();
+  for(const auto& buffer : _buffers)
+  {
+    std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+    buffer->events.assign(_eventsPerThread, TraceEvent());
+    buffer->nbRecorded = 0;
+    buffer->stats.clear();
+  }
+}
+
+std::size_t Tracer::getNbDroppedEvents() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::size_t nbDropped = 0;
+  for(const auto& buffer : _buffers)
+  {
+    std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+    if(buffer->nbRecorded > buffer->events.size())
+      nbDropped += buffer->nbRecorded - buffer->events.size();
+  }
+  return nbDropped;
+}
+
+std::vector<Tracer::ZoneSummary> Tracer::getSummary() const
+{
+  // the same name can have different pointers in different translation units
+  std::map<std::string, ZoneStats> statsPerName;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for(const auto& buffer : _buffers)
+    {
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+      for(const auto& zoneStats : buffer->stats)
+      {
+        ZoneStats& stats = statsPerName[zoneStats.first];
+        stats.calls += zoneStats.second.calls;
+        stats.totalNs += zoneStats.second.totalNs;
+        stats.maxNs = std::max(stats.maxNs, zoneStats.second.maxNs);
+        stats.peakResidentMemory = std::max(stats.peakResidentMemory, zoneStats.second.peakResidentMemory);
+      }
+    }
+  }
+
+  std::vector<ZoneSummary> summary;
+  summary.reserve(statsPerName.size());
+  for(const auto& zoneStats : statsPerName)
+  {
+    ZoneSummary zone;
+    zone.name = zoneStats.first;
+    zone.calls = zoneStats.second.calls;
+    zone.totalMs = zoneStats.second.totalNs * 1e-6;
+    zone.maxMs = zoneStats.second.maxNs * 1e-6;
+    zone.peakResidentMemory = zoneStats.second.peakResidentMemory;
+    summary.push_back(zone);
+  }
+
+  std::stable_sort(summary.begin(), summary.end(), [](const ZoneSummary& a, const ZoneSummary& b) {
+    return a.totalMs > b.totalMs;
+  });
+  return summary;
+}
+
+void Tracer::logSummary() const
+{
+  const std::vector<ZoneSummary> summary = getSummary();
+  const double toMB = 1.0 / (1024.0 * 1024.0);
+
+  std::ostringstream os;
+  os << "Tracing summary (cumulated time over all threads):" << std::endl;
+  os << std::left << std::setw(40) << "zone" << std::right
+     << std::setw(10) << "calls"
+     << std::setw(16) << "total (ms)"
+     << std::setw(16) << "mean (ms)"
+     << std::setw(16) << "max (ms)"
+     << std::setw(16) << "peak RSS (MB)" << std::endl;
+
+  for(const ZoneSummary& zone : summary)
+  {
+    os << std::left << std::setw(40) << zone.name << std::right
+       << std::setw(10) << zone.calls
+       << std::fixed << std::setprecision(3)
+       << std::setw(16) << zone.totalMs
+       << std::setw(16) << zone.totalMs / zone.calls
+       << std::setw(16) << zone.maxMs
+       << std::setprecision(1)
+       << std::setw(16) << zone.peakResidentMemory * toMB << std::endl;
+  }
+
+  os << "Peak resident memory: " << std::fixed << std::setprecision(1) << getPeakResidentMemory() * toMB << " MB" << std::endl;
+
+  const std::size_t nbDropped = getNbDroppedEvents();
+  if(nbDropped > 0)
+    os << nbDropped << " zone(s) have been overwritten in the trace, they are still counted in the summary." << std::endl;
+
+  ALICEVISION_LOG_INFO(os.str());
+}
+
+void Tracer::writeSummary(std::ostream& os) const
+{
+  os << "zone,calls,total_ms,mean_ms,max_ms,peak_rss_bytes" << std::endl;
+  for(const ZoneSummary& zone : getSummary())
+  {
+    os << zone.name << ","
+       << zone.calls << ","
+       << zone.totalMs << ","
+       << zone.totalMs / zone.calls << ","
+       << zone.maxMs << ","
+       << zone.peakResidentMemory << std::endl;
+  }
+}
+
+void Tracer::writeSummary(const std::string& path) const
+{
+  std::ofstream os(path);
+  if(!os.is_open())
+    throw std::runtime_error("Unable to write the tracing summary: " + path);
+  writeSummary(os);
+}
+
+void Tracer::writeChromeTrace(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  const std::int64_t originNs = std::chrono::duration_cast<std::chrono::nanoseconds>(_origin.time_since_epoch()).count();
+
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for(const auto& buffer : _buffers)
+  {
+    std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+
+    // thread name
+    os << (first ? "" : ",") << std::endl
+       << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->threadIndex
+       << ",\"args\":{\"name\":\"thread " << buffer->threadIndex << "\"}}";
+    first = false;
+
+    const std::size_t nbEvents = std::min(buffer->nbRecorded, buffer->events.size());
+    const std::size_t begin = buffer->nbRecorded - nbEvents;
+    for(std::size_t i = begin; i < buffer->nbRecorded; ++i)
+    {
+      const TraceEvent& event = buffer->events[i % buffer->events.size()];
+      os << "," << std::endl << "{\"name\":";
+      writeJsonString(os, event.name);
+      // timestamps in microseconds
+      os << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->threadIndex
+         << std::fixed << std::setprecision(3)
+         << ",\"ts\":" << (event.startNs - originNs) * 1e-3
+         << ",\"dur\":" << event.durationNs * 1e-3
+         << ",\"args\":{\"rss_bytes\":" << event.residentMemory << "}}";
+    }
+  }
+  os << std::endl << "]}" << std::endl;
+}
+
+void Tracer::writeChromeTrace(const std::string& path) const
+{
+  std::ofstream os(path);
+  if(!os.is_open())
+    throw std::runtime_error("Unable to write the trace file: " + path);
+  writeChromeTrace(os);
+}
+
+std::string extractTraceFileOption(int& argc, char* argv[])
+{
+  std::string traceFile;
+  if(!extractCommandLineOption(argc, argv, "--traceFile", traceFile))
+  {
+    const char* envTraceFile = std::getenv("ALICEVISION_TRACE_FILE");
+    if(envTraceFile != nullptr)
+      traceFile = envTraceFile;
+  }
+  return traceFile;
+}
+
+} // namespace system
+} // namespace aliceVision
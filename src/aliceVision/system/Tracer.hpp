@@ -0,0 +1,157 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/nvtx.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Record the time spent in named zones of the code, for all the threads.
+ * The resident memory of the process is also sampled at the end of each zone.
+ *
+ * Each thread records its zones in its own ring buffer, so recording does not
+ * contend with the other threads. When the buffer of a thread is full, its oldest
+ * zones are overwritten in the trace, but they are still counted in the summary.
+ * When the tracer is disabled (default), a zone only costs a relaxed atomic load.
+ *
+ * The trace can be exported in the Chrome trace event format, which can be opened
+ * in chrome://tracing or https://ui.perfetto.dev
+ */
+class Tracer
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /// statistics of all the zones with the same name
+  struct ZoneSummary
+  {
+    std::string name;
+    std::size_t calls = 0;
+    /// cumulated time over all the threads
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+    /// maximum resident memory of the process sampled at the end of the zones, 0 if unknown
+    std::size_t peakResidentMemory = 0;
+  };
+
+  static Tracer& get();
+
+  /**
+   * @brief Start recording the zones, remove the previously recorded ones
+   * @param[in] eventsPerThread The size of the ring buffer of each thread
+   */
+  void enable(std::size_t eventsPerThread = 1 << 16);
+
+  /// stop recording the zones, the recorded ones are kept
+  void disable();
+
+  static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Record a zone of the calling thread, with the current resident memory
+   * @param[in] name The zone name, it must outlive the tracer (string literal)
+   */
+  void record(const char* name, Clock::time_point start, Clock::time_point end);
+
+  /// remove all the recorded zones
+  void clear();
+
+  /// @return the number of zones overwritten in the ring buffers
+  std::size_t getNbDroppedEvents() const;
+
+  /// @return the statistics per zone name, sorted by decreasing total time
+  std::vector<ZoneSummary> getSummary() const;
+
+  /// log the statistics per zone name
+  void logSummary() const;
+
+  /// write the statistics per zone name as CSV
+  void writeSummary(std::ostream& os) const;
+  void writeSummary(const std::string& path) const;
+
+  /// write the recorded zones as Chrome trace event JSON
+  void writeChromeTrace(std::ostream& os) const;
+  void writeChromeTrace(const std::string& path) const;
+
+private:
+  struct ThreadBuffer;
+
+  Tracer() = default;
+  ThreadBuffer& getThreadBuffer();
+
+  static std::atomic<bool> _enabled;
+
+  mutable std::mutex _mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> _buffers;
+  std::size_t _eventsPerThread = 1 << 16;
+  Clock::time_point _origin = Clock::now();
+};
+
+/**
+ * @brief Record the lifetime of the object as a zone of the tracer.
+ * Also pushes a NVTX range when AliceVision is built with NVTX.
+ */
+class ScopedZone
+{
+public:
+  /// @param[in] name The zone name, it must outlive the tracer (string literal)
+  explicit ScopedZone(const char* name, const char* file = "", int line = 0)
+    : _name(name)
+    , _active(Tracer::isEnabled())
+  {
+    nvtxPushA(name, file, line);
+    if(_active)
+      _start = Tracer::Clock::now();
+  }
+
+  ~ScopedZone()
+  {
+    if(_active)
+      Tracer::get().record(_name, _start, Tracer::Clock::now());
+    nvtxPop(_name);
+  }
+
+  ScopedZone(const ScopedZone&) = delete;
+  ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+  const char* _name;
+  bool _active;
+  Tracer::Clock::time_point _start;
+};
+
+/**
+ * @brief Remove the tracing option (--traceFile <path> or --traceFile=<path>) from the
+ * command line arguments. If the option is not set, use the ALICEVISION_TRACE_FILE
+ * environment variable.
+ * @param[in,out] argc The number of arguments
+ * @param[in,out] argv The arguments
+ * @return the trace file path, empty if tracing is not requested
+ */
+std::string extractTraceFileOption(int& argc, char* argv[]);
+
+} // namespace system
+} // namespace aliceVision
+
+#define ALICEVISION_TRACE_CONCAT_IMPL(a, b) a##b
+#define ALICEVISION_TRACE_CONCAT(a, b) ALICEVISION_TRACE_CONCAT_IMPL(a, b)
+
+/// record the current scope as a zone of the tracer
+#define ALICEVISION_TRACE_ZONE(name) \
+  ::aliceVision::system::ScopedZone ALICEVISION_TRACE_CONCAT(aliceVisionTraceZone, __LINE__)(name, __FILE__, __LINE__)
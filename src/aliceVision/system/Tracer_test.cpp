@@ -0,0 +1,165 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/system/Tracer.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+
+#define BOOST_TEST_MODULE Tracer
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aliceVision::system;
+
+namespace {
+
+int countOccurrences(const std::string& str, const std::string& pattern)
+{
+  int count = 0;
+  for(std::size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + 1))
+    ++count;
+  return count;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(Tracer_disabled)
+{
+  Tracer& tracer = Tracer::get();
+  tracer.disable();
+  tracer.clear();
+  {
+    ALICEVISION_TRACE_ZONE("disabled");
+  }
+  BOOST_CHECK(tracer.getSummary().empty());
+}
+
+BOOST_AUTO_TEST_CASE(Tracer_zones)
+{
+  Tracer& tracer = Tracer::get();
+  // small ring buffers to check that the summary is complete anyway
+  tracer.enable(4);
+
+  const int nbThreads = 4;
+  const int nbZones = 10;
+  std::vector<std::thread> threads;
+  for(int t = 0; t < nbThreads; ++t)
+  {
+    threads.emplace_back([&]{
+      for(int i = 0; i < nbZones; ++i)
+      {
+        ALICEVISION_TRACE_ZONE("outer");
+        ALICEVISION_TRACE_ZONE("inner \"quoted\"");
+      }
+    });
+  }
+  for(std::thread& thread : threads)
+    thread.join();
+  tracer.disable();
+
+  const std::vector<Tracer::ZoneSummary> summary = tracer.getSummary();
+  BOOST_REQUIRE_EQUAL(summary.size(), 2);
+  for(const Tracer::ZoneSummary& zone : summary)
+  {
+    BOOST_CHECK_EQUAL(zone.calls, nbThreads * nbZones);
+    BOOST_CHECK_GE(zone.maxMs * zone.calls, zone.totalMs);
+  }
+  // the outer zones contain the inner ones
+  BOOST_CHECK_EQUAL(summary.front().name, "outer");
+
+  // each thread keeps its last 4 zones
+  BOOST_CHECK_EQUAL(tracer.getNbDroppedEvents(), nbThreads * (2 * nbZones - 4));
+
+  std::ostringstream trace;
+  tracer.writeChromeTrace(trace);
+  BOOST_CHECK_EQUAL(countOccurrences(trace.str(), "\"ph\":\"X\""), nbThreads * 4);
+  BOOST_CHECK_EQUAL(countOccurrences(trace.str(), "\"inner \\\"quoted\\\"\""), nbThreads * 2);
+
+  std::ostringstream csv;
+  tracer.writeSummary(csv);
+  BOOST_CHECK_EQUAL(countOccurrences(csv.str(), "\n"), 3);
+
+  tracer.clear();
+  BOOST_CHECK(tracer.getSummary().empty());
+}
+
+BOOST_AUTO_TEST_CASE(Tracer_residentMemory)
+{
+  if(getResidentMemory() == 0)
+  {
+    BOOST_TEST_MESSAGE("The resident memory is unknown on this system.");
+    return;
+  }
+
+  Tracer& tracer = Tracer::get();
+  tracer.enable();
+
+  const std::size_t allocatedSize = 256 * 1024 * 1024;
+  {
+    ALICEVISION_TRACE_ZONE("empty");
+  }
+  // the buffer is released after the end of the zone
+  std::vector<char> buffer;
+  {
+    ALICEVISION_TRACE_ZONE("allocating");
+    // touch the pages so that they are resident
+    buffer.assign(allocatedSize, 1);
+  }
+  buffer.clear();
+  buffer.shrink_to_fit();
+  tracer.disable();
+
+  const std::vector<Tracer::ZoneSummary> summary = tracer.getSummary();
+  BOOST_REQUIRE_EQUAL(summary.size(), 2);
+  const auto findZone = [&](const std::string& name) {
+    return *std::find_if(summary.begin(), summary.end(), [&](const Tracer::ZoneSummary& zone) { return zone.name == name; });
+  };
+  const Tracer::ZoneSummary emptyZone = findZone("empty");
+  const Tracer::ZoneSummary allocatingZone = findZone("allocating");
+  BOOST_CHECK_GT(emptyZone.peakResidentMemory, 0);
+  BOOST_CHECK_GE(allocatingZone.peakResidentMemory, emptyZone.peakResidentMemory + allocatedSize / 2);
+
+  std::ostringstream csv;
+  tracer.writeSummary(csv);
+  BOOST_CHECK_NE(csv.str().find("allocating,1,"), std::string::npos);
+  BOOST_CHECK_NE(csv.str().find("peak_rss_bytes"), std::string::npos);
+
+  std::ostringstream trace;
+  tracer.writeChromeTrace(trace);
+  BOOST_CHECK_EQUAL(countOccurrences(trace.str(), "\"rss_bytes\":"), 2);
+
+  tracer.clear();
+}
+
+BOOST_AUTO_TEST_CASE(Tracer_commandLine)
+{
+  char arg0[] = "program";
+  char arg1[] = "--input";
+  char arg2[] = "file";
+  char arg3[] = "--traceFile";
+  char arg4[] = "trace.json";
+  char arg5[] = "-v";
+  char* argv[] = {arg0, arg1, arg2, arg3, arg4, arg5, nullptr};
+  int argc = 6;
+
+  BOOST_CHECK_EQUAL(extractTraceFileOption(argc, argv), "trace.json");
+  BOOST_REQUIRE_EQUAL(argc, 4);
+  BOOST_CHECK_EQUAL(std::strcmp(argv[2], "file"), 0);
+  BOOST_CHECK_EQUAL(std::strcmp(argv[3], "-v"), 0);
+  BOOST_CHECK(argv[4] == nullptr);
+
+  char arg6[] = "--traceFile=other.json";
+  char* argv2[] = {arg0, arg6, nullptr};
+  argc = 2;
+  BOOST_CHECK_EQUAL(extractTraceFileOption(argc, argv2), "other.json");
+  BOOST_CHECK_EQUAL(argc, 1);
+}
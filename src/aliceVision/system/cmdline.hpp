@@ -10,6 +10,8 @@
 #include <boost/program_options/variables_map.hpp>
 #include <boost/program_options/option.hpp>
 #include <ostream>
+#include <stdexcept>
+#include <string>
 
 namespace boost {
 
@@ -113,3 +115,47 @@ inline std::ostream& operator<<(std::ostream& os, const variables_map& vm)
 
 }
 }
+
+namespace aliceVision {
+namespace system {
+
+/**
+ * @brief Remove an option and its value (--option <value> or --option=<value>) from the
+ * command line arguments, for the options common to all the programs which are handled
+ * before the program parses its own options.
+ * @param[in,out] argc The number of arguments
+ * @param[in,out] argv The arguments
+ * @param[in] option The option name, with the leading dashes
+ * @param[out] value The option value, unchanged if the option is not found
+ * @return true if the option has been found
+ */
+inline bool extractCommandLineOption(int& argc, char* argv[], const std::string& option, std::string& value)
+{
+    bool found = false;
+    int nbArgs = 0;
+    for(int i = 0; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        if(i > 0 && arg == option)
+        {
+            if(i + 1 >= argc)
+                throw std::invalid_argument("Missing value for the option " + option);
+            value = argv[++i];
+            found = true;
+            continue;
+        }
+        if(i > 0 && arg.compare(0, option.size() + 1, option + "=") == 0)
+        {
+            value = arg.substr(option.size() + 1);
+            found = true;
+            continue;
+        }
+        argv[nbArgs++] = argv[i];
+    }
+    argv[nbArgs] = nullptr;
+    argc = nbArgs;
+    return found;
+}
+
+}
+}
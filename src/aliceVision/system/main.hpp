@@ -14,9 +14,19 @@
  * To use this wrapper you need to change your source file containing \c main() as such:
  * 1. Include this header
  * 2. Rename \c main() to \c aliceVision_main()
+ *
+ * All the programs using this wrapper accept the \c --traceFile \c <path> option (or the
+ * \c ALICEVISION_TRACE_FILE environment variable): the zones of the code are traced
+ * (see Tracer.hpp), exported as Chrome trace JSON to \c <path>, with a summary per zone
+ * logged and written to \c <path>.csv
+ *
+ * They also accept the \c --maxMemory \c <MB> option (or the \c ALICEVISION_MAX_MEMORY
+ * environment variable) to set the memory budget of the process (see MemoryBudget.hpp).
  */
 
 #include "Logger.hpp"
+#include "MemoryBudget.hpp"
+#include "Tracer.hpp"
 
 #include <stdexcept>
 
@@ -32,9 +42,21 @@ int aliceVision_main(int argc, char* argv[]);
  * find out, something this main() function avoids. */
 int main(int argc, char* argv[])
 {
+    int status = EXIT_FAILURE;
+    std::string traceFile;
     try
     {
-        return aliceVision_main(argc, argv);
+        // common options, removed before the program parses its own options
+        traceFile = aliceVision::system::extractTraceFileOption(argc, argv);
+        if(!traceFile.empty())
+            aliceVision::system::Tracer::get().enable();
+
+        const std::size_t maxMemory = aliceVision::system::extractMaxMemoryOption(argc, argv);
+        if(maxMemory > 0)
+            aliceVision::system::MemoryBudget::get().setMaxMemory(maxMemory);
+
+        status = aliceVision_main(argc, argv);
+        aliceVision::system::MemoryBudget::get().logReport();
     }
     catch(const std::exception& e)
     {
@@ -44,5 +66,22 @@ int main(int argc, char* argv[])
     {
         ALICEVISION_LOG_FATAL("Unknown exception");
     }
-    return EXIT_FAILURE;
+
+    if(!traceFile.empty())
+    {
+        try
+        {
+            aliceVision::system::Tracer& tracer = aliceVision::system::Tracer::get();
+            tracer.disable();
+            tracer.logSummary();
+            tracer.writeChromeTrace(traceFile);
+            tracer.writeSummary(traceFile + ".csv");
+            ALICEVISION_LOG_INFO("Trace written to " << traceFile);
+        }
+        catch(const std::exception& e)
+        {
+            ALICEVISION_LOG_ERROR(e.what());
+        }
+    }
+    return status;
 }
@@ -35,13 +35,17 @@ public:
     this->setNodeCounts();
   }
 
+  using BaseClass::updateQuantizer;
+
   uint32_t nodes() const
   {
     return this->word_start_ + this->num_words_;
   }
 
+  /// Mutable access to the centers, call updateQuantizer() once they are final.
   std::vector<Feature, FeatureAllocator>& centers()
   {
+    this->quantizer_.clear();
     return this->centers_;
   }
 
@@ -52,6 +56,7 @@ public:
 
   std::vector<uint8_t>& validCenters()
   {
+    this->quantizer_.clear();
     return this->valid_centers_;
   }
 
@@ -0,0 +1,618 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include "MutableVocabularyTree.hpp"
+#include "SimpleKmeans.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace aliceVision {
+namespace voctree {
+
+/**
+ * @brief Class for building a new vocabulary by hierarchical mini-batch k-means on a stream
+ * of training features that does not need to fit in memory.
+ *
+ * The tree is built level by level. For each level:
+ *  - the stream is read once to route each feature to its parent node and to draw a bounded
+ *    reservoir of samples per node, clustered with SimpleKmeans to seed the k children centers;
+ *  - the stream is then read a few times, each chunk being assigned to the children centers
+ *    of its parent node and used as a mini-batch to update these centers (running mean with
+ *    per-center learning rate 1/count, Sculley 2010).
+ *
+ * Assignments use the triangle inequality on the distances between the children centers of a
+ * node to skip the centers that cannot be closer than the current best one. The distance functor
+ * is therefore expected to return squared Euclidean distances (as L2 does).
+ *
+ * The training state can be saved after each pass and reloaded to resume an interrupted build.
+ * The resulting tree has the same layout as the one of TreeBuilder.
+ *
+ * \c Stream must provide \c rewind() and \c bool read(std::vector<Feature>& chunk),
+ * see DescriptorFileStream.
+ */
+template<class Feature,
+         template<typename, typename> class DistanceT = L2,
+         class FeatureAllocator = typename DefaultAllocator<Feature>::type>
+class StreamingTreeBuilder
+{
+public:
+  typedef MutableVocabularyTree<Feature, DistanceT, FeatureAllocator> Tree;
+  typedef DistanceT<Feature, Feature> Distance;
+  typedef typename Distance::result_type squared_distance_type;
+  typedef std::vector<Feature, FeatureAllocator> FeatureVector;
+
+  /**
+   * @brief Constructor
+   *
+   * @param zero Object representing zero in the feature space
+   * @param d    Functor for calculating squared distance
+   */
+  StreamingTreeBuilder(const Feature& zero = Feature(), Distance d = Distance(), unsigned char verbose = 0)
+    : zero_(zero)
+    , distance_(d)
+    , verbose_(verbose)
+  {}
+
+  /// Set the maximum number of mini-batch passes over the stream for each level.
+  void setMaxPasses(std::size_t passes) { max_passes_ = passes; }
+  std::size_t getMaxPasses() const { return max_passes_; }
+
+  /// Set the maximum number of samples kept in memory over all nodes to seed a level.
+  void setMaxSeedSamples(std::size_t samples) { max_seed_samples_ = samples; }
+  std::size_t getMaxSeedSamples() const { return max_seed_samples_; }
+
+  /// Set the number of k-means restarts and iterations used to seed the centers on the sampled features.
+  void setSeedKmeans(std::size_t restarts, std::size_t iterations)
+  {
+    seed_restarts_ = restarts;
+    seed_iterations_ = iterations;
+  }
+
+  /// Set the random seed used for sampling and center initialization.
+  void setRandomSeed(unsigned int seed) { random_seed_ = seed; }
+
+  /// Set the file used to save the training state after each pass, and to resume from if it exists.
+  void setStatePath(const std::string& path) { state_path_ = path; }
+  const std::string& getStatePath() const { return state_path_; }
+
+  void setVerbose(unsigned char level) { verbose_ = level; }
+  unsigned char getVerbose() const { return verbose_; }
+
+  /// Get the built vocabulary tree.
+  const Tree& tree() const { return tree_; }
+
+  /**
+   * @brief Build a new vocabulary tree from a stream of features.
+   *
+   * If a state path is set and the file exists, the training is resumed from this state.
+   * The number of words in the resulting vocabulary is at most k ^ levels.
+   *
+   * @param stream The stream of training features.
+   * @param k      The branching factor, or max children of any node.
+   * @param levels The number of levels in the tree.
+   */
+  template<class Stream>
+  void build(Stream& stream, uint32_t k, uint32_t levels);
+
+  /**
+   * @brief Save the current training state.
+   * @param[in] path The state file path
+   */
+  void saveState(const std::string& path) const;
+
+  /**
+   * @brief Load a training state.
+   * @param[in] path The state file path
+   */
+  void loadState(const std::string& path);
+
+private:
+  static const uint32_t stateVersion = 1;
+
+  /// Index of the first center of a level in the tree centers.
+  std::size_t levelOffset(uint32_t level) const
+  {
+    std::size_t offset = 0;
+    std::size_t nbCenters = 1;
+    for(uint32_t l = 0; l < level; ++l)
+    {
+      nbCenters *= tree_.splits();
+      offset += nbCenters;
+    }
+    return offset;
+  }
+
+  /// Number of parent nodes of a level (the virtual root for the first level).
+  std::size_t nbParents(uint32_t level) const
+  {
+    std::size_t nb = 1;
+    for(uint32_t l = 0; l < level; ++l)
+      nb *= tree_.splits();
+    return nb;
+  }
+
+  /**
+   * @brief Compute, for the children of each parent node of a level, half the distance between each pair of centers.
+   */
+  void computeHalfCenterDistances(uint32_t level, std::vector<double>& halfDistances) const;
+
+  /**
+   * @brief Find the nearest valid child of a node, skipping centers with the triangle inequality.
+   * @param[in] firstChild index of the first child center
+   * @param[in] halfDistances k * k half distances between the children centers
+   * @param[in] feature the query feature
+   * @param[out] bestDistance the squared distance to the nearest center
+   * @return the child index in [0, k), or -1 if the node has no valid child
+   */
+  int nearestChild(std::size_t firstChild, const double* halfDistances, const Feature& feature, squared_distance_type& bestDistance) const;
+
+  /**
+   * @brief Route a feature through the already trained levels.
+   * @return the parent node index at the given level, or -1 if it cannot be routed
+   */
+  std::ptrdiff_t route(const Feature& feature, uint32_t level, const std::vector<std::vector<double> >& halfDistances) const;
+
+  template<class Stream>
+  void seedLevel(Stream& stream, uint32_t level, const std::vector<std::vector<double> >& halfDistances);
+
+  template<class Stream>
+  squared_distance_type updateLevel(Stream& stream, uint32_t level, const std::vector<std::vector<double> >& halfDistances);
+
+  typedef typename Feature::value_type value_type;
+
+  /// convert an updated center coordinate to the feature type, rounded to the nearest value for integer features
+  static value_type toFeatureValue(double value)
+  {
+    return toFeatureValue(value, std::is_integral<value_type>());
+  }
+
+  static value_type toFeatureValue(double value, std::true_type)
+  {
+    const double clamped = std::min<double>(std::max<double>(value, std::numeric_limits<value_type>::lowest()), std::numeric_limits<value_type>::max());
+    return static_cast<value_type>(std::lround(clamped));
+  }
+
+  static value_type toFeatureValue(double value, std::false_type)
+  {
+    return static_cast<value_type>(value);
+  }
+
+  void checkpoint() const
+  {
+    if(!state_path_.empty())
+      saveState(state_path_);
+  }
+
+  Tree tree_;
+  Feature zero_;
+  Distance distance_;
+  /// number of features assigned to each center of the level being trained
+  std::vector<uint64_t> counts_;
+  /// level being trained
+  uint32_t level_ = 0;
+  /// number of update passes done on the current level, -1 if the level is not seeded yet
+  int32_t pass_ = -1;
+
+  std::size_t max_passes_ = 5;
+  std::size_t max_seed_samples_ = 1000000;
+  std::size_t seed_restarts_ = 3;
+  std::size_t seed_iterations_ = 20;
+  unsigned int random_seed_ = 0;
+  std::string state_path_;
+  unsigned char verbose_;
+};
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+void StreamingTreeBuilder<Feature, DistanceT, FeatureAllocator>::computeHalfCenterDistances(uint32_t level, std::vector<double>& halfDistances) const
+{
+  const std::size_t k = tree_.splits();
+  const std::size_t nbNodes = nbParents(level);
+  const std::size_t offset = levelOffset(level);
+  const FeatureVector& centers = tree_.centers();
+  const std::vector<uint8_t>& valid = tree_.validCenters();
+
+  halfDistances.assign(nbNodes * k * k, 0.0);
+
+  #pragma omp parallel for
+  for(std::ptrdiff_t node = 0; node < static_cast<std::ptrdiff_t>(nbNodes); ++node)
+  {
+    const std::size_t firstChild = offset + node * k;
+    double* nodeDistances = &halfDistances[node * k * k];
+    for(std::size_t i = 0; i < k && valid[firstChild + i]; ++i)
+    {
+      for(std::size_t j = i + 1; j < k && valid[firstChild + j]; ++j)
+      {
+        const double d = 0.5 * std::sqrt(static_cast<double>(distance_(centers[firstChild + i], centers[firstChild + j])));
+        nodeDistances[i * k + j] = d;
+        nodeDistances[j * k + i] = d;
+      }
+    }
+  }
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+int StreamingTreeBuilder<Feature, DistanceT, FeatureAllocator>::nearestChild(std::size_t firstChild, const double* halfDistances,
+                                                                             const Feature& feature, squared_distance_type& bestDistance) const
+{
+  const std::size_t k = tree_.splits();
+  const FeatureVector& centers = tree_.centers();
+  const std::vector<uint8_t>& valid = tree_.validCenters();
+
+  if(!valid[firstChild])
+    return -1;
+
+  int best = 0;
+  bestDistance = distance_(feature, centers[firstChild]);
+  double bestNorm = std::sqrt(static_cast<double>(bestDistance));
+
+  for(std::size_t c = 1; c < k && valid[firstChild + c]; ++c)
+  {
+    // d(x, c) >= d(best, c) - d(x, best) >= d(x, best) if d(best, c) / 2 >= d(x, best)
+    if(halfDistances[best * k + c] >= bestNorm)
+      continue;
+
+    const squared_distance_type d = distance_(feature, centers[firstChild + c]);
+    if(d < bestDistance)
+    {
+      best = static_cast<int>(c);
+      bestDistance = d;
+      bestNorm = std::sqrt(static_cast<double>(d));
+    }
+  }
+  return best;
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+std::ptrdiff_t StreamingTreeBuilder<Feature, DistanceT, FeatureAllocator>::route(const Feature& feature, uint32_t level,
+                                                                                 const std::vector<std::vector<double> >& halfDistances) const
+{
+  const std::size_t k = tree_.splits();
+  std::ptrdiff_t node = 0;
+  squared_distance_type distance;
+
+  for(uint32_t l = 0; l < level; ++l)
+  {
+    const int child = nearestChild(levelOffset(l) + node * k, &halfDistances[l][node * k * k], feature, distance);
+    if(child < 0)
+      return -1;
+    node = node * k + child;
+  }
+  return node;
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+template<class Stream>
+void StreamingTreeBuilder<Feature, DistanceT, FeatureAllocator>::seedLevel(Stream& stream, uint32_t level,
+                                                                           const std::vector<std::vector<double> >& halfDistances)
+{
+  const std::size_t k = tree_.splits();
+  const std::size_t nbNodes = nbParents(level);
+  const std::size_t offset = levelOffset(level);
+  const std::size_t reservoirSize = std::max(k + 1, max_seed_samples_ / nbNodes);
+
+  // reservoir sampling of the features of each parent node
+  std::vector<FeatureVector> reservoirs(nbNodes);
+  std::vector<uint64_t> nbSeen(nbNodes, 0);
+  std::mt19937 generator(random_seed_ + level);
+
+  FeatureVector chunk;
+  std::vector<std::ptrdiff_t> nodes;
+  stream.rewind();
+  while(stream.read(chunk))
+  {
+    nodes.resize(chunk.size());
+
+    #pragma omp parallel for
+    for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(chunk.size()); ++i)
+      nodes[i] = route(chunk[i], level, halfDistances);
+
+    for(std::size_t i = 0; i < chunk.size(); ++i)
+    {
+      if(nodes[i] < 0)
+        continue;
+      FeatureVector& reservoir = reservoirs[nodes[i]];
+      const uint64_t seen = nbSeen[nodes[i]]++;
+      if(reservoir.size() < reservoirSize)
+      {
+        reservoir.push_back(chunk[i]);
+      }
+      else
+      {
+        const uint64_t j = std::uniform_int_distribution<uint64_t>(0, seen)(generator);
+        if(j < reservoirSize)
+          reservoir[j] = chunk[i];
+      }
+    }
+  }
+
+  FeatureVector& centers = tree_.centers();
+  std::vector<uint8_t>& valid = tree_.validCenters();
+
+  // seed the children of each node
+  std::srand(random_seed_ + level);
+  SimpleKmeans<Feature, Distance, FeatureAllocator> kmeans(zero_, distance_);
+  kmeans.setRestarts(seed_restarts_);
+  kmeans.setMaxIterations(seed_iterations_);
+  for(std::size_t node = 0; node < nbNodes; ++node)
+  {
+    const std::size_t firstChild = offset + node * k;
+    FeatureVector& reservoir = reservoirs[node];
+
+    if(reservoir.size() <= k)
+    {
+      // the node has k or fewer features, just use those as the centers and mark the others as invalid
+      for(std::size_t c = 0; c < k; ++c)
+      {
+        centers[firstChild + c] = (c < reservoir.size()) ? reservoir[c] : zero_;
+        valid[firstChild + c] = (c < reservoir.size()) ? 1 : 0;
+      }
+    }
+    else
+    {
+      // cluster the samples to get robust seeds
+      FeatureVector seeds;
+      std::vector<unsigned int> membership(reservoir.size());
+      kmeans.cluster(reservoir, k, seeds, membership);
+      for(std::size_t c = 0; c < k; ++c)
+      {
+        centers[firstChild + c] = seeds[c];
+        valid[firstChild + c] = 1;
+      }
+    }
+    FeatureVector().swap(reservoir);
+  }
+
+  std::fill(counts_.begin(), counts_.end(), 0);
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+template<class Stream>
+typename StreamingTreeBuilder<Feature, DistanceT, FeatureAllocator>::squared_distance_type
+StreamingTreeBuilder<Feature, DistanceT, FeatureAllocator>::updateLevel(Stream& stream, uint32_t level,
+                                                                        const std::vector<std::vector<double> >& parentHalfDistances)
+{
+  const std::size_t k = tree_.splits();
+  const std::size_t offset = levelOffset(level);
+  const std::size_t dim = zero_.size();
+  FeatureVector& centers = tree_.centers();
+
+  // the half distances of the level being trained, updated after each mini-batch
+  std::vector<double> halfDistances;
+  computeHalfCenterDistances(level, halfDistances);
+
+  squared_distance_type sse = 0;
+  FeatureVector chunk;
+  std::vector<std::ptrdiff_t> assignments;
+  std::vector<std::size_t> updatedNodes;
+  stream.rewind();
+  while(stream.read(chunk))
+  {
+    assignments.resize(chunk.size());
+    squared_distance_type chunkSse = 0;
+
+    // assign each feature to the nearest child center of its parent node
+    #pragma omp parallel for reduction(+:chunkSse)
+    for(std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(chunk.size()); ++i)
+    {
+      assignments[i] = -1;
+      const std::ptrdiff_t node = route(chunk[i], level, parentHalfDistances);
+      if(node < 0)
+        continue;
+      squared_distance_type distance;
+      const int child = nearestChild(offset + node * k, &halfDistances[node * k * k], chunk[i], distance);
+      if(child < 0)
+        continue;
+      assignments[i] = offset + node * k + child;
+      chunkSse += distance;
+    }
+    sse += chunkSse;
+
+    // accumulate the mini-batch per center, in the chunk order to stay deterministic
+    std::map<std::size_t, std::pair<uint64_t, std::vector<double> > > batches;
+    for(std::size_t i = 0; i < chunk.size(); ++i)
+    {
+      if(assignments[i] < 0)
+        continue;
+      std::pair<uint64_t, std::vector<double> >& batch = batches[assignments[i]];
+      batch.second.resize(dim, 0.0);
+      ++batch.first;
+      for(std::size_t d = 0; d < dim; ++d)
+        batch.second[d] += chunk[i][d];
+    }
+
+    // move the centers toward the mini-batch means with a per-center learning rate
+    updatedNodes.clear();
+    for(const auto& batch : batches)
+    {
+      const std::size_t center = batch.first;
+      const double m = static_cast<double>(batch.second.first);
+      counts_[center] += batch.second.first;
+      const double n = static_cast<double>(counts_[center]);
+      for(std::size_t d = 0; d < dim; ++d)
+      {
+        const double value = centers[center][d];
+        // rounded rather than truncated: the truncation of integer features biases the centers toward zero
+        centers[center][d] = toFeatureValue(value + (batch.second.second[d] - m * value) / n);
+      }
+      updatedNodes.push_back((center - offset) / k);
+    }
+
+    // update the center distances of the modified nodes
+    updatedNodes.erase(std::unique(updatedNodes.begin(), updatedNodes.end()), updatedNodes.end());
+    const std::vector<uint8_t>& valid = tree_.validCenters();
+    #pragma omp parallel for
+    for(std::ptrdiff_t n = 0; n < static_cast<std::ptrdiff_t>(updatedNodes.size()); ++n)
+    {
+      const std::size_t firstChild = offset + updatedNodes[n] * k;
+      double* nodeDistances = &halfDistances[updatedNodes[n] * k * k];
+      for(std::size_t i = 0; i < k && valid[firstChild + i]; ++i)
+      {
+        for(std::size_t j = i + 1; j < k && valid[firstChild + j]; ++j)
+        {
+          const double d = 0.5 * std::sqrt(static_cast<double>(distance_(centers[firstChild + i], centers[firstChild + j])));
+          nodeDistances[i * k + j] = d;
+          nodeDistances[j * k + i] = d;
+        }
+      }
+    }
+  }
+  return sse;
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+template<class Stream>
+void StreamingTreeBuilder<Feature, DistanceT, FeatureAllocator>::build(Stream& stream, uint32_t k, uint32_t levels)
+{
+  if(!state_path_.empty() && boost::filesystem::exists(state_path_))
+  {
+    loadState(state_path_);
+    if(tree_.splits() != k || tree_.levels() != levels)
+      throw std::runtime_error("The training state '" + state_path_ + "' does not match the requested tree size.");
+    ALICEVISION_LOG_INFO("Resuming vocabulary tree training at level " << level_ << ", pass " << pass_);
+  }
+  else
+  {
+    // Initial setup and memory allocation for the tree
+    tree_.clear();
+    tree_.setSize(levels, k);
+    tree_.centers().assign(tree_.nodes(), zero_);
+    tree_.validCenters().assign(tree_.nodes(), 0);
+    counts_.assign(tree_.nodes(), 0);
+    level_ = 0;
+    pass_ = -1;
+  }
+
+  // half distances between the children centers of each node of the trained levels, used for routing
+  std::vector<std::vector<double> > halfDistances(levels);
+  for(uint32_t l = 0; l < level_; ++l)
+    computeHalfCenterDistances(l, halfDistances[l]);
+
+  for(; level_ < levels; ++level_)
+  {
+    if(verbose_) ALICEVISION_LOG_INFO("# Level " << level_);
+
+    if(pass_ < 0)
+    {
+      if(verbose_ > 1) ALICEVISION_LOG_INFO("#\tSeeding " << nbParents(level_) * k << " centers");
+      seedLevel(stream, level_, halfDistances);
+      pass_ = 0;
+      checkpoint();
+    }
+
+    squared_distance_type previousSse = std::numeric_limits<squared_distance_type>::max();
+    for(; pass_ < static_cast<int32_t>(max_passes_); ++pass_)
+    {
+      const squared_distance_type sse = updateLevel(stream, level_, halfDistances);
+      if(verbose_ > 1) ALICEVISION_LOG_INFO("#\tPass " << pass_ + 1 << "/" << max_passes_ << ", sum squared error: " << sse);
+
+      // stop when the mini-batches do not improve the clustering anymore
+      const bool converged = (previousSse != std::numeric_limits<squared_distance_type>::max()) &&
+                             (previousSse - sse <= 1e-4 * previousSse);
+      previousSse = sse;
+      if(converged)
+      {
+        pass_ = static_cast<int32_t>(max_passes_);
+        break;
+      }
+      checkpoint();
+    }
+
+    computeHalfCenterDistances(level_, halfDistances[level_]);
+    pass_ = -1;
+    if(level_ + 1 < levels)
+      checkpoint();
+  }
+
+  tree_.updateQuantizer();
+  checkpoint();
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+void StreamingTreeBuilder<Feature, DistanceT, FeatureAllocator>::saveState(const std::string& path) const
+{
+  // write in a temporary file first to never leave a truncated state
+  const std::string tmpPath = path + "." + boost::filesystem::unique_path().string();
+  {
+    std::ofstream out(tmpPath.c_str(), std::ios_base::binary);
+    if(!out.is_open())
+      throw std::runtime_error("Can't save vocabulary tree training state, can't open '" + tmpPath + "'.");
+
+    const uint32_t version = stateVersion;
+    const uint32_t k = tree_.splits();
+    const uint32_t levels = tree_.levels();
+    const uint32_t size = tree_.centers().size();
+
+    out.write((const char*) &version, sizeof(uint32_t));
+    out.write((const char*) &k, sizeof(uint32_t));
+    out.write((const char*) &levels, sizeof(uint32_t));
+    out.write((const char*) &level_, sizeof(uint32_t));
+    out.write((const char*) &pass_, sizeof(int32_t));
+    out.write((const char*) &size, sizeof(uint32_t));
+    out.write((const char*) tree_.centers().data(), size * sizeof(Feature));
+    out.write((const char*) tree_.validCenters().data(), size);
+    out.write((const char*) counts_.data(), size * sizeof(uint64_t));
+
+    if(!out.good())
+      throw std::runtime_error("Can't save vocabulary tree training state in '" + tmpPath + "'.");
+  }
+  boost::filesystem::rename(tmpPath, path);
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+void StreamingTreeBuilder<Feature, DistanceT, FeatureAllocator>::loadState(const std::string& path)
+{
+  std::ifstream in;
+  in.exceptions(std::ifstream::eofbit | std::ifstream::failbit | std::ifstream::badbit);
+
+  try
+  {
+    in.open(path.c_str(), std::ios_base::binary);
+
+    uint32_t version, k, levels, size;
+    in.read((char*) &version, sizeof(uint32_t));
+    if(version != stateVersion)
+      throw std::runtime_error("Unsupported vocabulary tree training state version in '" + path + "'.");
+    in.read((char*) &k, sizeof(uint32_t));
+    in.read((char*) &levels, sizeof(uint32_t));
+    in.read((char*) &level_, sizeof(uint32_t));
+    in.read((char*) &pass_, sizeof(int32_t));
+    in.read((char*) &size, sizeof(uint32_t));
+
+    tree_.clear();
+    tree_.setSize(levels, k);
+    if(size != tree_.nodes())
+      throw std::runtime_error("Invalid vocabulary tree training state '" + path + "'.");
+
+    tree_.centers().resize(size);
+    tree_.validCenters().resize(size);
+    counts_.resize(size);
+    in.read((char*) tree_.centers().data(), size * sizeof(Feature));
+    in.read((char*) tree_.validCenters().data(), size);
+    in.read((char*) counts_.data(), size * sizeof(uint64_t));
+  }
+  catch(std::ifstream::failure& e)
+  {
+    throw std::runtime_error("Failed to load vocabulary tree training state " + path);
+  }
+}
+
+}
+}
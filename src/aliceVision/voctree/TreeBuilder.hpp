@@ -170,6 +170,7 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
     }
     if(verbose_) printf("# centers so far = %lu\n", tree_.centers().size());
   }
+  tree_.updateQuantizer();
 }
 
 }
@@ -0,0 +1,233 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/feature/Descriptor.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace aliceVision {
+namespace voctree {
+
+/**
+ * @brief Accumulator used to evaluate the squared L2 distance on a given bin type.
+ *
+ * 8-bit bins are accumulated exactly in 32-bit integers (128 * 255^2 < 2^31), which gives
+ * the same value as the double accumulation done by L2. Other bin types are accumulated
+ * in double, bin after bin, exactly like L2 does, so distances are bit-identical.
+ */
+template<typename T, bool isByte = (std::is_integral<T>::value && sizeof(T) == 1)>
+struct TreeQuantizerAccumulator
+{
+  typedef double type;
+};
+
+template<typename T>
+struct TreeQuantizerAccumulator<T, true>
+{
+  typedef int32_t type;
+};
+
+/**
+ * @brief Vocabulary tree quantizer working on a node-major, SIMD-friendly copy of the tree centers.
+ *
+ * For each internal node, the centers of its k children are stored contiguously and transposed
+ * (bin-major: the i-th bin of all children, then the (i+1)-th bin, ...). The distances from a
+ * descriptor to all children of a node are then evaluated in one pass where the inner loop
+ * runs over the children, which the compiler vectorizes. As each child keeps its own accumulator
+ * and bins are summed in the same order as L2, the resulting words are exactly the same as
+ * the ones given by VocabularyTree::quantize.
+ *
+ * Only feature::Descriptor centers are supported, other feature types keep the generic path.
+ */
+template<class Feature>
+class TreeQuantizer
+{
+public:
+  static const bool supported = false;
+
+  template<class FeatureAllocator>
+  void build(const std::vector<Feature, FeatureAllocator>&, const std::vector<uint8_t>&, uint32_t, uint32_t) {}
+  void clear() {}
+  bool empty() const { return true; }
+  void quantize(const Feature*, std::size_t, int32_t*) const { assert(false); }
+};
+
+template<typename T, std::size_t N>
+class TreeQuantizer<feature::Descriptor<T, N> >
+{
+public:
+  typedef feature::Descriptor<T, N> Feature;
+  typedef typename TreeQuantizerAccumulator<T>::type accumulator_type;
+
+  static const bool supported = true;
+
+  /// Number of descriptors quantized together, level by level, in quantize()
+  static const std::size_t batchSize = 256;
+
+  TreeQuantizer()
+    : k_(0), levels_(0), word_start_(0)
+  {}
+
+  /**
+   * @brief Build the transposed node blocks from the vocabulary tree centers.
+   * @param[in] centers all the tree centers, stored level after level
+   * @param[in] validCenters the validity flag of each center
+   * @param[in] k the branching factor of the tree
+   * @param[in] levels the number of levels of the tree
+   */
+  template<class FeatureAllocator>
+  void build(const std::vector<Feature, FeatureAllocator>& centers, const std::vector<uint8_t>& validCenters, uint32_t k, uint32_t levels)
+  {
+    clear();
+    if(k == 0 || levels == 0 || centers.empty())
+      return;
+
+    // the internal nodes are the virtual root followed by all non-leaf nodes
+    const std::size_t nbNodes = centers.size() / k;
+    assert(nbNodes * k == centers.size());
+    assert(validCenters.size() == centers.size());
+
+    std::size_t nbWords = 1;
+    for(uint32_t level = 0; level < levels; ++level)
+      nbWords *= k;
+    assert(nbWords <= centers.size());
+
+    k_ = k;
+    levels_ = levels;
+    word_start_ = static_cast<uint32_t>(centers.size() - nbWords);
+    blocks_.resize(centers.size() * N);
+    num_valid_children_.resize(nbNodes);
+
+    #pragma omp parallel for
+    for(ptrdiff_t node = 0; node < static_cast<ptrdiff_t>(nbNodes); ++node)
+    {
+      const std::size_t firstChild = node * k;
+      T* block = &blocks_[firstChild * N];
+
+      // children are evaluated until the first invalid one, as in VocabularyTree::quantize
+      uint32_t nbValid = 0;
+      while(nbValid < k && validCenters[firstChild + nbValid])
+        ++nbValid;
+      num_valid_children_[node] = nbValid;
+
+      for(std::size_t c = 0; c < k; ++c)
+      {
+        const Feature& center = centers[firstChild + c];
+        for(std::size_t i = 0; i < N; ++i)
+          block[i * k + c] = center[i];
+      }
+    }
+  }
+
+  void clear()
+  {
+    blocks_.clear();
+    num_valid_children_.clear();
+    k_ = levels_ = word_start_ = 0;
+  }
+
+  bool empty() const
+  {
+    return blocks_.empty();
+  }
+
+  /**
+   * @brief Quantize a set of descriptors into visual words.
+   * Descriptors are processed by batches, each batch goes down the tree level by level
+   * so that the node blocks of a level are shared while they are hot in cache.
+   * @param[in] features the descriptors to quantize
+   * @param[in] count the number of descriptors
+   * @param[out] words the output visual words (of size count)
+   */
+  void quantize(const Feature* features, std::size_t count, int32_t* words) const
+  {
+    assert(!empty());
+    const std::ptrdiff_t nbBatches = static_cast<std::ptrdiff_t>((count + batchSize - 1) / batchSize);
+
+    #pragma omp parallel
+    {
+      std::vector<accumulator_type> distances(k_);
+      std::vector<int32_t> nodes(batchSize);
+
+      #pragma omp for
+      for(std::ptrdiff_t b = 0; b < nbBatches; ++b)
+      {
+        const std::size_t begin = b * batchSize;
+        const std::size_t end = std::min(count, begin + batchSize);
+
+        // -1 is the virtual root index, which has no associated center
+        std::fill(nodes.begin(), nodes.end(), -1);
+
+        for(uint32_t level = 0; level < levels_; ++level)
+        {
+          for(std::size_t f = begin; f < end; ++f)
+          {
+            int32_t& index = nodes[f - begin];
+            index = (index + 1) * k_ + bestChild(index + 1, features[f], distances);
+          }
+        }
+
+        for(std::size_t f = begin; f < end; ++f)
+          words[f] = nodes[f - begin] - word_start_;
+      }
+    }
+  }
+
+private:
+
+  /**
+   * @brief Evaluate all children of a node in one pass and return the closest one.
+   * @param[in] node the internal node index (virtual root is 0)
+   * @param[in] feature the query descriptor
+   * @param[in,out] distances scratch buffer of size k
+   * @return the index of the closest child in [0, k)
+   */
+  uint32_t bestChild(std::size_t node, const Feature& feature, std::vector<accumulator_type>& distances) const
+  {
+    const uint32_t nbValid = num_valid_children_[node];
+    const T* block = &blocks_[node * k_ * N];
+    accumulator_type* dist = distances.data();
+
+    std::fill(dist, dist + nbValid, accumulator_type(0));
+    for(std::size_t i = 0; i < N; ++i)
+    {
+      const accumulator_type value = static_cast<accumulator_type>(feature[i]);
+      const T* bin = block + i * k_;
+      for(uint32_t c = 0; c < nbValid; ++c)
+      {
+        const accumulator_type diff = value - static_cast<accumulator_type>(bin[c]);
+        dist[c] += diff * diff;
+      }
+    }
+
+    // keep the first minimum, as the sequential scan of VocabularyTree::quantize
+    uint32_t best = 0;
+    for(uint32_t c = 1; c < nbValid; ++c)
+    {
+      if(dist[c] < dist[best])
+        best = c;
+    }
+    return best;
+  }
+
+  uint32_t k_;
+  uint32_t levels_;
+  uint32_t word_start_;
+  /// transposed children centers, one block of k * N bins per internal node
+  std::vector<T> blocks_;
+  /// number of leading valid children per internal node
+  std::vector<uint32_t> num_valid_children_;
+};
+
+}
+}
@@ -9,6 +9,7 @@
 #include <aliceVision/config.hpp>
 #include "distance.hpp"
 #include "DefaultAllocator.hpp"
+#include "TreeQuantizer.hpp"
 
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/regionsFactory.hpp>
@@ -21,6 +22,7 @@
 #include <map>
 #include <cassert>
 #include <limits>
+#include <type_traits>
 #include <fstream>
 #include <stdexcept>
 #include <iostream>
@@ -117,7 +119,11 @@ public:
   template<class DescriptorT>
   Word quantize(const DescriptorT& feature) const;
 
-  /// Quantizes a set of features into visual words.
+  /**
+   * @brief Quantizes a set of features into visual words.
+   * When the tree centers are descriptors compared with L2, the features are quantized
+   * by batches on the transposed node blocks of TreeQuantizer, giving the same words.
+   */
   template<class DescriptorT>
   std::vector<Word> quantize(const std::vector<DescriptorT>& features) const;
 
@@ -159,6 +165,7 @@ public:
 protected:
   std::vector<Feature, FeatureAllocator> centers_;
   std::vector<uint8_t> valid_centers_; /// @todo Consider bit-vector
+  TreeQuantizer<Feature> quantizer_; /// node-major copy of the centers used for batch quantization
 
   uint32_t k_; // splits, or branching factor
   uint32_t levels_;
@@ -171,6 +178,30 @@ protected:
   }
 
   void setNodeCounts();
+
+  /// (Re)build the batch quantizer from the current centers if the tree supports it.
+  void updateQuantizer()
+  {
+    quantizer_.clear();
+    if(initialized() && std::is_same<Distance<Feature, Feature>, L2<Feature, Feature> >::value)
+      quantizer_.build(centers_, valid_centers_, k_, levels_);
+  }
+
+private:
+  bool quantizeBlocks(const std::vector<Feature>& features, std::vector<Word>& words) const
+  {
+    if(quantizer_.empty())
+      return false;
+    quantizer_.quantize(features.data(), features.size(), words.data());
+    return true;
+  }
+
+  template<class DescriptorT>
+  bool quantizeBlocks(const std::vector<DescriptorT>& features, std::vector<Word>& words) const
+  {
+    // descriptor type different from the centers type: use the generic path
+    return false;
+  }
 };
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -227,6 +258,9 @@ std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(
   // ALICEVISION_LOG_DEBUG("VocabularyTree quantize: " << features.size());
   std::vector<Word> imgVisualWords(features.size(), 0);
 
+  if(quantizeBlocks(features, imgVisualWords))
+    return imgVisualWords;
+
   // quantize the features
   #pragma omp parallel for
   for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(features.size()); ++j)
@@ -272,6 +306,7 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::clear()
 {
   centers_.clear();
   valid_centers_.clear();
+  quantizer_.clear();
   k_ = levels_ = num_words_ = word_start_ = 0;
 }
 
@@ -318,6 +353,7 @@ void VocabularyTree<Feature, Distance, FeatureAllocator>::load(const std::string
 
   setNodeCounts();
   assert(size == num_words_ + word_start_);
+  updateQuantizer();
 }
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
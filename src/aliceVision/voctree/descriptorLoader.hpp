@@ -11,7 +11,9 @@
 #include <aliceVision/voctree/Database.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 
+#include <fstream>
 #include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace voctree {
@@ -52,6 +54,45 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
                          std::vector<DescriptorT>& descriptors,
                          std::vector<std::size_t>& numFeatures);
 
+/**
+ * @brief Sequential reader of a list of .desc files by chunks of descriptors.
+ * It allows to go through descriptor sets that do not fit in memory, possibly several times.
+ * \p DescriptorT is the type of descriptor returned, \p FileDescriptorT the type stored in the files.
+ */
+template<class DescriptorT, class FileDescriptorT = DescriptorT>
+class DescriptorFileStream
+{
+public:
+  /**
+   * @param[in] descriptorsFiles The .desc files to read, in this order
+   * @param[in] chunkSize The maximum number of descriptors returned by each read()
+   */
+  DescriptorFileStream(const std::vector<std::string>& descriptorsFiles, std::size_t chunkSize);
+
+  /// Go back to the first descriptor of the first file
+  void rewind();
+
+  /**
+   * @brief Read the next chunk of descriptors.
+   * @param[out] chunk The descriptors read (at most chunkSize, cleared first)
+   * @return false if there is no more descriptor to read
+   */
+  bool read(std::vector<DescriptorT>& chunk);
+
+  /// Total number of descriptors in the files
+  std::size_t size() const { return _size; }
+
+private:
+  bool openNextFile();
+
+  std::vector<std::string> _files;
+  std::size_t _chunkSize;
+  std::size_t _size = 0;
+  std::size_t _nextFile = 0;
+  std::size_t _remainingInFile = 0;
+  std::ifstream _stream;
+};
+
 } // namespace voctree
 } // namespace aliceVision
 
@@ -89,5 +89,83 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
   return numDescriptors;
 }
 
+template<class DescriptorT, class FileDescriptorT>
+DescriptorFileStream<DescriptorT, FileDescriptorT>::DescriptorFileStream(const std::vector<std::string>& descriptorsFiles, std::size_t chunkSize)
+  : _files(descriptorsFiles)
+  , _chunkSize(chunkSize)
+{
+  assert(_chunkSize > 0);
+
+  // the first element of each file is the number of descriptors it contains
+  for(const std::string& file : _files)
+  {
+    std::ifstream stream(file.c_str(), std::ios::in | std::ios::binary);
+    if(!stream.is_open())
+      throw std::runtime_error("Can't load descriptor binary file, can't open '" + file + "' !");
+    std::size_t cardDesc = 0;
+    if(!stream.read((char*) &cardDesc, sizeof(std::size_t)))
+      throw std::runtime_error("Can't load descriptor binary file, '" + file + "' is incorrect !");
+    _size += cardDesc;
+  }
+}
+
+template<class DescriptorT, class FileDescriptorT>
+void DescriptorFileStream<DescriptorT, FileDescriptorT>::rewind()
+{
+  _stream.close();
+  _nextFile = 0;
+  _remainingInFile = 0;
+}
+
+template<class DescriptorT, class FileDescriptorT>
+bool DescriptorFileStream<DescriptorT, FileDescriptorT>::openNextFile()
+{
+  _stream.close();
+  while(_nextFile < _files.size())
+  {
+    const std::string& file = _files[_nextFile++];
+    _stream.clear();
+    _stream.open(file.c_str(), std::ios::in | std::ios::binary);
+    if(!_stream.is_open())
+      throw std::runtime_error("Can't load descriptor binary file, can't open '" + file + "' !");
+
+    _remainingInFile = 0;
+    if(!_stream.read((char*) &_remainingInFile, sizeof(std::size_t)))
+      throw std::runtime_error("Can't load descriptor binary file, '" + file + "' is incorrect !");
+    if(_remainingInFile > 0)
+      return true;
+    _stream.close();
+  }
+  return false;
+}
+
+template<class DescriptorT, class FileDescriptorT>
+bool DescriptorFileStream<DescriptorT, FileDescriptorT>::read(std::vector<DescriptorT>& chunk)
+{
+  constexpr std::size_t oneDescSize = FileDescriptorT::static_size * sizeof(typename FileDescriptorT::bin_type);
+
+  chunk.clear();
+  chunk.reserve(_chunkSize);
+
+  FileDescriptorT fileDescriptor;
+  while(chunk.size() < _chunkSize)
+  {
+    if(_remainingInFile == 0 && !openNextFile())
+      break;
+
+    const std::size_t nbToRead = std::min(_remainingInFile, _chunkSize - chunk.size());
+    for(std::size_t i = 0; i < nbToRead; ++i)
+    {
+      // fail() is also set by a file shorter than its number of descriptors
+      if(!_stream.read((char*) fileDescriptor.getData(), oneDescSize))
+        throw std::runtime_error("Can't load descriptor binary file, '" + _files[_nextFile - 1] + "' is incorrect !");
+      chunk.emplace_back();
+      feature::convertDesc<FileDescriptorT, DescriptorT>(fileDescriptor, chunk.back());
+    }
+    _remainingInFile -= nbToRead;
+  }
+  return !chunk.empty();
+}
+
 } // namespace voctree
 } // namespace aliceVision
@@ -0,0 +1,214 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/StreamingTreeBuilder.hpp>
+#include <aliceVision/voctree/descriptorLoader.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#define BOOST_TEST_MODULE voctreeStreamingTreeBuilder
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+typedef feature::Descriptor<float, 16> DescriptorFloat;
+typedef feature::Descriptor<unsigned char, 16> DescriptorUChar;
+
+/**
+ * @brief In-memory stream of features returned by chunks.
+ */
+template<class FeatureT>
+struct VectorStream
+{
+  VectorStream(const std::vector<FeatureT>& features, std::size_t chunkSize)
+    : features(features), chunkSize(chunkSize)
+  {}
+
+  void rewind() { position = 0; }
+
+  bool read(std::vector<FeatureT>& chunk)
+  {
+    const std::size_t end = std::min(features.size(), position + chunkSize);
+    chunk.assign(features.begin() + position, features.begin() + end);
+    position = end;
+    return !chunk.empty();
+  }
+
+  const std::vector<FeatureT>& features;
+  std::size_t chunkSize;
+  std::size_t position = 0;
+};
+
+/**
+ * @brief Generate well separated clusters of features, grouped by 4 in super clusters.
+ */
+std::vector<DescriptorFloat> generateClusters(std::size_t nbClusters, std::size_t nbFeatures)
+{
+  std::srand(0);
+  std::vector<DescriptorFloat> features;
+  for(std::size_t j = 0; j < nbFeatures; ++j)
+  {
+    for(std::size_t i = 0; i < nbClusters; ++i)
+    {
+      DescriptorFloat feature;
+      for(std::size_t d = 0; d < DescriptorFloat::static_size; ++d)
+        feature[d] = 100.f * (d % 4 == (i / 4) % 4) + 20.f * (d / 4 == i % 4) + 2.f * std::rand() / RAND_MAX;
+      features.push_back(feature);
+    }
+  }
+  return features;
+}
+
+BOOST_AUTO_TEST_CASE(streamingTreeBuilder_clusters)
+{
+  const std::size_t K = 4;
+  const std::size_t LEVELS = 2;
+  const std::size_t NBCLUSTERS = K * K;
+
+  const std::vector<DescriptorFloat> features = generateClusters(NBCLUSTERS, 100);
+  VectorStream<DescriptorFloat> stream(features, 128);
+
+  voctree::StreamingTreeBuilder<DescriptorFloat> builder(DescriptorFloat(0.f));
+  builder.setMaxPasses(10);
+  builder.build(stream, K, LEVELS);
+
+  // the centers should all be valid in this configuration
+  for(uint8_t valid : builder.tree().validCenters())
+    BOOST_CHECK(valid != 0);
+
+  // each cluster should be quantized into its own word
+  const std::vector<voctree::Word> words = builder.tree().quantize(features);
+  std::set<voctree::Word> clusterWords;
+  for(std::size_t i = 0; i < NBCLUSTERS; ++i)
+  {
+    for(std::size_t j = 1; j < features.size() / NBCLUSTERS; ++j)
+      BOOST_CHECK_EQUAL(words[i], words[j * NBCLUSTERS + i]);
+    clusterWords.insert(words[i]);
+  }
+  BOOST_CHECK_EQUAL(clusterWords.size(), NBCLUSTERS);
+}
+
+BOOST_AUTO_TEST_CASE(streamingTreeBuilder_resume)
+{
+  const std::string statePath = "streamingTreeBuilder.state";
+  boost::filesystem::remove(statePath);
+
+  const std::vector<DescriptorFloat> features = generateClusters(9, 50);
+  VectorStream<DescriptorFloat> stream(features, 100);
+
+  voctree::StreamingTreeBuilder<DescriptorFloat> builder(DescriptorFloat(0.f));
+  builder.setStatePath(statePath);
+  builder.build(stream, 3, 2);
+  BOOST_CHECK(boost::filesystem::exists(statePath));
+
+  // a new builder on the same state resumes a finished training
+  voctree::StreamingTreeBuilder<DescriptorFloat> resumedBuilder(DescriptorFloat(0.f));
+  resumedBuilder.setStatePath(statePath);
+  resumedBuilder.build(stream, 3, 2);
+  BOOST_CHECK(builder.tree() == resumedBuilder.tree());
+
+  // the state must match the requested tree size
+  voctree::StreamingTreeBuilder<DescriptorFloat> otherBuilder(DescriptorFloat(0.f));
+  otherBuilder.setStatePath(statePath);
+  BOOST_CHECK_THROW(otherBuilder.build(stream, 4, 2), std::runtime_error);
+
+  boost::filesystem::remove(statePath);
+}
+
+BOOST_AUTO_TEST_CASE(streamingTreeBuilder_integerCenters)
+{
+  // two clusters of integer features, the coordinates of each cluster alternate between two values
+  // so that their mean is not an integer: 100.75 and 30.25
+  std::vector<DescriptorUChar> features;
+  for(std::size_t i = 0; i < 400; ++i)
+  {
+    DescriptorUChar a;
+    DescriptorUChar b;
+    for(std::size_t d = 0; d < DescriptorUChar::static_size; ++d)
+    {
+      a[d] = (i % 4 == 0) ? 100 : 101;
+      b[d] = (i % 4 == 0) ? 31 : 30;
+    }
+    features.push_back(a);
+    features.push_back(b);
+  }
+  VectorStream<DescriptorUChar> stream(features, 64);
+
+  voctree::StreamingTreeBuilder<DescriptorUChar> builder(DescriptorUChar(0));
+  builder.setMaxPasses(5);
+  builder.build(stream, 2, 1);
+
+  // the centers are the rounded means, the truncation of the updates would pull them down to 100 and 30
+  std::set<int> centerValues;
+  for(const DescriptorUChar& center : builder.tree().centers())
+    for(std::size_t d = 0; d < DescriptorUChar::static_size; ++d)
+      centerValues.insert(center[d]);
+  BOOST_CHECK_EQUAL(centerValues.size(), 2);
+  BOOST_CHECK(centerValues.count(101));
+  BOOST_CHECK(centerValues.count(30));
+}
+
+BOOST_AUTO_TEST_CASE(descriptorFileStream)
+{
+  std::vector<std::string> files;
+  std::vector<DescriptorUChar> allDescriptors;
+
+  std::srand(0);
+  for(std::size_t f = 0; f < 3; ++f)
+  {
+    // the second file is empty
+    std::vector<DescriptorUChar> descriptors(f == 1 ? 0 : 70 + f);
+    for(DescriptorUChar& descriptor : descriptors)
+      for(std::size_t d = 0; d < DescriptorUChar::static_size; ++d)
+        descriptor[d] = static_cast<unsigned char>(std::rand() % 256);
+
+    files.push_back("descriptorFileStream_" + std::to_string(f) + ".desc");
+    feature::saveDescsToBinFile(files.back(), descriptors);
+    allDescriptors.insert(allDescriptors.end(), descriptors.begin(), descriptors.end());
+  }
+
+  voctree::DescriptorFileStream<DescriptorFloat, DescriptorUChar> stream(files, 32);
+  BOOST_CHECK_EQUAL(stream.size(), allDescriptors.size());
+
+  for(int pass = 0; pass < 2; ++pass)
+  {
+    std::vector<DescriptorFloat> chunk;
+    std::size_t nbRead = 0;
+    stream.rewind();
+    while(stream.read(chunk))
+    {
+      BOOST_CHECK(chunk.size() <= 32);
+      for(const DescriptorFloat& descriptor : chunk)
+      {
+        for(std::size_t d = 0; d < DescriptorFloat::static_size; ++d)
+          BOOST_CHECK_EQUAL(descriptor[d], static_cast<float>(allDescriptors[nbRead][d]));
+        ++nbRead;
+      }
+    }
+    BOOST_CHECK_EQUAL(nbRead, allDescriptors.size());
+  }
+
+  // a truncated file is not read as a complete one
+  boost::filesystem::resize_file(files.back(), boost::filesystem::file_size(files.back()) - DescriptorUChar::static_size / 2);
+  {
+    std::vector<DescriptorFloat> chunk;
+    stream.rewind();
+    BOOST_CHECK_THROW(while(stream.read(chunk)) {}, std::runtime_error);
+  }
+
+  // a file without its number of descriptors
+  boost::filesystem::resize_file(files.back(), sizeof(std::size_t) / 2);
+  BOOST_CHECK_THROW((voctree::DescriptorFileStream<DescriptorFloat, DescriptorUChar>(files, 32)), std::runtime_error);
+
+  for(const std::string& file : files)
+    boost::filesystem::remove(file);
+}
@@ -0,0 +1,99 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#define BOOST_TEST_MODULE voctreeTreeQuantizer
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+
+/**
+ * @brief Fill a tree with random centers, some nodes having less than k valid children.
+ */
+template<class DescriptorT>
+void makeRandomTree(voctree::MutableVocabularyTree<DescriptorT>& tree, uint32_t k, uint32_t levels, float maxValue)
+{
+  tree.setSize(levels, k);
+  std::vector<DescriptorT>& centers = tree.centers();
+  std::vector<uint8_t>& validCenters = tree.validCenters();
+  centers.resize(tree.nodes());
+  validCenters.resize(tree.nodes(), 1);
+
+  for(std::size_t i = 0; i < centers.size(); ++i)
+    for(std::size_t j = 0; j < DescriptorT::static_size; ++j)
+      centers[i][j] = static_cast<typename DescriptorT::bin_type>(maxValue * std::rand() / RAND_MAX);
+
+  // invalidate the last children of some nodes
+  for(std::size_t firstChild = k; firstChild < centers.size(); firstChild += 7 * k)
+    for(std::size_t c = 1 + firstChild % (k - 1); c < k; ++c)
+      validCenters[firstChild + c] = 0;
+
+  tree.updateQuantizer();
+}
+
+template<class DescriptorT>
+void checkBatchQuantization(uint32_t k, uint32_t levels, float maxValue)
+{
+  std::srand(0);
+
+  voctree::MutableVocabularyTree<DescriptorT> tree;
+  makeRandomTree(tree, k, levels, maxValue);
+
+  std::vector<DescriptorT> descriptors(1000);
+  for(DescriptorT& descriptor : descriptors)
+    for(std::size_t j = 0; j < DescriptorT::static_size; ++j)
+      descriptor[j] = static_cast<typename DescriptorT::bin_type>(maxValue * std::rand() / RAND_MAX);
+
+  // duplicate a center to check ties are resolved like the sequential quantization
+  descriptors.push_back(tree.centers()[k + 1]);
+  tree.updateQuantizer();
+
+  const std::vector<voctree::Word> words = tree.quantize(descriptors);
+  BOOST_CHECK_EQUAL(words.size(), descriptors.size());
+
+  for(std::size_t i = 0; i < descriptors.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(words[i], tree.quantize(descriptors[i]));
+    BOOST_CHECK(words[i] >= 0 && words[i] < static_cast<voctree::Word>(tree.words()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(treeQuantizer_uchar)
+{
+  checkBatchQuantization<feature::Descriptor<unsigned char, 128> >(10, 4, 255.f);
+}
+
+BOOST_AUTO_TEST_CASE(treeQuantizer_float)
+{
+  checkBatchQuantization<feature::Descriptor<float, 128> >(8, 3, 1.f);
+}
+
+BOOST_AUTO_TEST_CASE(treeQuantizer_saveLoad)
+{
+  typedef feature::Descriptor<unsigned char, 128> DescriptorT;
+  std::srand(0);
+
+  voctree::MutableVocabularyTree<DescriptorT> tree;
+  makeRandomTree(tree, 6, 3, 255.f);
+  tree.save("treeQuantizer.tree");
+
+  voctree::VocabularyTree<DescriptorT> loadedTree("treeQuantizer.tree");
+
+  std::vector<DescriptorT> descriptors(500);
+  for(DescriptorT& descriptor : descriptors)
+    for(std::size_t j = 0; j < DescriptorT::static_size; ++j)
+      descriptor[j] = static_cast<unsigned char>(std::rand() % 256);
+
+  const std::vector<voctree::Word> words = loadedTree.quantize(descriptors);
+  for(std::size_t i = 0; i < descriptors.size(); ++i)
+    BOOST_CHECK_EQUAL(words[i], loadedTree.quantize(descriptors[i]));
+}
@@ -0,0 +1,182 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/system/Timer.hpp>
+
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace benchmark {
+
+/**
+ * @brief Size of the synthetic problem solved by a benchmark.
+ */
+enum class EBenchmarkSize
+{
+  SMALL = 0,
+  MEDIUM,
+  LARGE
+};
+
+inline std::string EBenchmarkSize_enumToString(EBenchmarkSize size)
+{
+  switch(size)
+  {
+    case EBenchmarkSize::SMALL:  return "small";
+    case EBenchmarkSize::MEDIUM: return "medium";
+    case EBenchmarkSize::LARGE:  return "large";
+  }
+  throw std::out_of_range("Invalid benchmark size enum");
+}
+
+inline EBenchmarkSize EBenchmarkSize_stringToEnum(const std::string& size)
+{
+  if(size == "small")  return EBenchmarkSize::SMALL;
+  if(size == "medium") return EBenchmarkSize::MEDIUM;
+  if(size == "large")  return EBenchmarkSize::LARGE;
+  throw std::out_of_range("Invalid benchmark size: " + size);
+}
+
+/**
+ * @brief State of one benchmark run at a given size.
+ *
+ * A benchmark generates its input data with generator() or std::rand, which are seeded identically for every run,
+ * then calls measure() once with the code to time. The timed code is run a few times to warm up
+ * the caches and the allocators, then the requested number of times.
+ * std::srand is also reset before each repetition for the code relying on it.
+ */
+class BenchmarkState
+{
+public:
+  BenchmarkState(EBenchmarkSize size, unsigned int seed, int nbWarmups, int nbRepetitions)
+    : _size(size)
+    , _seed(seed)
+    , _nbWarmups(nbWarmups)
+    , _nbRepetitions(nbRepetitions)
+    , _generator(seed)
+  {
+    // for the data generators based on std::rand (NViewDataSet, Eigen::Random)
+    std::srand(seed);
+  }
+
+  EBenchmarkSize size() const { return _size; }
+
+  /// Select a problem dimension according to the benchmark size.
+  template<typename T>
+  T select(T small, T medium, T large) const
+  {
+    switch(_size)
+    {
+      case EBenchmarkSize::SMALL:  return small;
+      case EBenchmarkSize::MEDIUM: return medium;
+      case EBenchmarkSize::LARGE:  return large;
+    }
+    return small;
+  }
+
+  /// Random generator for the input data.
+  std::mt19937& generator() { return _generator; }
+
+  /// Describe the workload (number of points, views, ...).
+  void setParameter(const std::string& name, double value) { _parameters[name] = value; }
+
+  /// Store a value computed by the benchmark (number of inliers, residual, ...) to check the results are consistent between runs.
+  void setCounter(const std::string& name, double value) { _counters[name] = value; }
+
+  /**
+   * @brief Time a function.
+   * @param[in] run the code to time
+   */
+  template<typename RunFunction>
+  void measure(RunFunction run)
+  {
+    measure([](){}, run);
+  }
+
+  /**
+   * @brief Time a function which modifies its input.
+   * @param[in] setup the code preparing the input of each repetition, not timed
+   * @param[in] run the code to time
+   */
+  template<typename SetupFunction, typename RunFunction>
+  void measure(SetupFunction setup, RunFunction run)
+  {
+    _timesMs.clear();
+    for(int i = 0; i < _nbWarmups + _nbRepetitions; ++i)
+    {
+      setup();
+      std::srand(_seed);
+
+      const system::Timer timer;
+      run();
+      const double elapsedMs = timer.elapsedMs();
+
+      if(i >= _nbWarmups)
+        _timesMs.push_back(elapsedMs);
+    }
+  }
+
+  const std::vector<double>& getTimesMs() const { return _timesMs; }
+  const std::map<std::string, double>& getParameters() const { return _parameters; }
+  const std::map<std::string, double>& getCounters() const { return _counters; }
+
+private:
+  EBenchmarkSize _size;
+  unsigned int _seed;
+  int _nbWarmups;
+  int _nbRepetitions;
+  std::mt19937 _generator;
+  std::vector<double> _timesMs;
+  std::map<std::string, double> _parameters;
+  std::map<std::string, double> _counters;
+};
+
+/**
+ * @brief A named benchmark.
+ * Names are dot-separated, starting with the module name (e.g. "matching.cascadeHashing").
+ */
+struct Benchmark
+{
+  std::string name;
+  std::function<void(BenchmarkState&)> function;
+};
+
+/**
+ * @brief The list of the available benchmarks.
+ */
+class BenchmarkRegistry
+{
+public:
+  void add(const std::string& name, std::function<void(BenchmarkState&)> function)
+  {
+    _benchmarks.push_back({name, function});
+  }
+
+  const std::vector<Benchmark>& getBenchmarks() const { return _benchmarks; }
+
+private:
+  std::vector<Benchmark> _benchmarks;
+};
+
+void registerMatchingBenchmarks(BenchmarkRegistry& registry);
+void registerRobustEstimationBenchmarks(BenchmarkRegistry& registry);
+void registerTriangulationBenchmarks(BenchmarkRegistry& registry);
+void registerSfmBenchmarks(BenchmarkRegistry& registry);
+void registerVoctreeBenchmarks(BenchmarkRegistry& registry);
+#ifdef ALICEVISION_BENCHMARKS_MVS
+void registerFuseCutBenchmarks(BenchmarkRegistry& registry);
+#endif
+
+} // namespace benchmark
+} // namespace aliceVision
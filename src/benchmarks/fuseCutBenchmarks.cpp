@@ -0,0 +1,66 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/fuseCut/DelaunayGraphCut.hpp>
+#include <aliceVision/fuseCut/Fuser.hpp>
+#include <aliceVision/mesh/Mesh.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+
+#include <array>
+#include <memory>
+
+namespace aliceVision {
+namespace benchmark {
+
+void registerFuseCutBenchmarks(BenchmarkRegistry& registry)
+{
+  registry.add("fuseCut.delaunayGraphCut", [](BenchmarkState& state)
+  {
+    const int nbViews = state.select(8, 16, 32);
+    const int nbPoints = state.select(5000, 50000, 200000);
+    state.setParameter("nbViews", nbViews);
+    state.setParameter("nbPoints", nbPoints);
+
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints, config);
+    sfmData::SfMData sfmData = sfm::getInputScene(d, config, camera::EINTRINSIC::PINHOLE_CAMERA);
+
+    // move the landmarks on a sphere inside the ring of cameras, so that there is a surface to extract
+    std::normal_distribution<double> direction(0.0, 1.0);
+    for(auto& landmarkPair : sfmData.getLandmarks())
+    {
+      const Vec3 n(direction(state.generator()), direction(state.generator()), direction(state.generator()));
+      landmarkPair.second.X = 0.5 * n.normalized();
+    }
+
+    // the cameras are read from the SfMData, no image is needed
+    mvsUtils::MultiViewParams mp(sfmData);
+
+    std::array<Point3d, 8> hexah;
+    fuseCut::Fuser fuser(&mp);
+    fuser.divideSpaceFromSfM(sfmData, &hexah[0]);
+    const StaticVector<int> cams = mp.findCamsWhichIntersectsHexahedron(&hexah[0]);
+
+    std::size_t nbTriangles = 0;
+
+    state.measure([&]()
+    {
+      fuseCut::DelaunayGraphCut delaunayGC(&mp);
+      delaunayGC.createDensePointCloud(&hexah[0], cams, &sfmData, nullptr);
+      delaunayGC.createGraphCut(&hexah[0], cams, "", "", false);
+      delaunayGC.graphCutPostProcessing();
+      std::unique_ptr<mesh::Mesh> mesh(delaunayGC.createMesh());
+      nbTriangles = mesh->tris.size();
+    });
+    state.setCounter("nbTriangles", nbTriangles);
+  });
+}
+
+} // namespace benchmark
+} // namespace aliceVision
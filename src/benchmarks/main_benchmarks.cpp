@@ -0,0 +1,367 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/version.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/cpu.hpp>
+#include <aliceVision/system/main.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::benchmark;
+
+namespace po = boost::program_options;
+
+namespace {
+
+/**
+ * @brief Timings and results of a benchmark at a given size.
+ */
+struct BenchmarkResult
+{
+  std::string name;
+  std::string size;
+  /// empty if the benchmark succeeded
+  std::string error;
+  double medianMs = 0.0;
+  double minMs = 0.0;
+  double maxMs = 0.0;
+  double meanMs = 0.0;
+  std::vector<double> timesMs;
+  std::map<std::string, double> parameters;
+  std::map<std::string, double> counters;
+};
+
+// The JSON file is written directly: boost::property_tree writes all the values as strings.
+
+/// Write a JSON string, with the quotes, the backslashes and the control characters escaped.
+void writeJsonString(std::ostream& os, const std::string& value)
+{
+  os << '"';
+  for(const char c : value)
+  {
+    switch(c)
+    {
+      case '"':  os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n"; break;
+      case '\r': os << "\\r"; break;
+      case '\t': os << "\\t"; break;
+      default:
+        if(static_cast<unsigned char>(c) < 0x20)
+          os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+        else
+          os << c;
+    }
+  }
+  os << '"';
+}
+
+/// Write a JSON number, null if it is not finite.
+void writeJsonNumber(std::ostream& os, double value)
+{
+  if(std::isfinite(value))
+    os << value;
+  else
+    os << "null";
+}
+
+void writeJsonNumbers(std::ostream& os, const std::vector<double>& values)
+{
+  os << "[";
+  for(std::size_t i = 0; i < values.size(); ++i)
+  {
+    os << (i ? ", " : "");
+    writeJsonNumber(os, values[i]);
+  }
+  os << "]";
+}
+
+void writeJsonNumbers(std::ostream& os, const std::map<std::string, double>& values)
+{
+  os << "{";
+  for(auto it = values.begin(); it != values.end(); ++it)
+  {
+    os << (it != values.begin() ? ", " : "");
+    writeJsonString(os, it->first);
+    os << ": ";
+    writeJsonNumber(os, it->second);
+  }
+  os << "}";
+}
+
+void writeJsonResult(std::ostream& os, const BenchmarkResult& result)
+{
+  os << "        {\n";
+  os << "            \"name\": ";
+  writeJsonString(os, result.name);
+  os << ",\n            \"size\": ";
+  writeJsonString(os, result.size);
+  if(!result.error.empty())
+  {
+    os << ",\n            \"error\": ";
+    writeJsonString(os, result.error);
+  }
+  else
+  {
+    os << ",\n            \"medianMs\": ";
+    writeJsonNumber(os, result.medianMs);
+    os << ",\n            \"minMs\": ";
+    writeJsonNumber(os, result.minMs);
+    os << ",\n            \"maxMs\": ";
+    writeJsonNumber(os, result.maxMs);
+    os << ",\n            \"meanMs\": ";
+    writeJsonNumber(os, result.meanMs);
+    os << ",\n            \"timesMs\": ";
+    writeJsonNumbers(os, result.timesMs);
+    os << ",\n            \"parameters\": ";
+    writeJsonNumbers(os, result.parameters);
+    os << ",\n            \"counters\": ";
+    writeJsonNumbers(os, result.counters);
+  }
+  os << "\n        }";
+}
+
+std::string getCompiler()
+{
+  std::ostringstream compiler;
+#if defined(__clang__)
+  compiler << "clang " << __clang_major__ << "." << __clang_minor__ << "." << __clang_patchlevel__;
+#elif defined(__GNUC__)
+  compiler << "gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "." << __GNUC_PATCHLEVEL__;
+#elif defined(_MSC_VER)
+  compiler << "msvc " << _MSC_VER;
+#else
+  compiler << "unknown";
+#endif
+  return compiler.str();
+}
+
+} // namespace
+
+int aliceVision_main(int argc, char** argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string outputFilename;
+  std::string filter = ".*";
+  std::vector<std::string> sizes = {"small", "medium"};
+  int nbRepetitions = 5;
+  int nbWarmups = 1;
+  unsigned int seed = 42;
+  bool listOnly = false;
+
+  po::options_description allParams("AliceVision benchmarks\n"
+                                    "Time the main algorithms of the library on synthetic data generated with a fixed seed.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("help,h", "Print this message.")
+    ("output,o", po::value<std::string>(&outputFilename),
+      "Output JSON file with the timings of all the benchmarks.")
+    ("filter,f", po::value<std::string>(&filter)->default_value(filter),
+      "Regular expression selecting the benchmarks to run by name (e.g. 'matching\\..*').")
+    ("size,s", po::value<std::vector<std::string>>(&sizes)->default_value(sizes, "small medium")->multitoken(),
+      "Problem sizes to run: small, medium, large.")
+    ("repetitions,r", po::value<int>(&nbRepetitions)->default_value(nbRepetitions),
+      "Number of timed runs per benchmark and size.")
+    ("warmups", po::value<int>(&nbWarmups)->default_value(nbWarmups),
+      "Number of untimed runs before the timed ones.")
+    ("seed", po::value<unsigned int>(&seed)->default_value(seed),
+      "Seed of the synthetic data generators.")
+    ("list", po::bool_switch(&listOnly),
+      "List the benchmarks and exit.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal, error, warning, info, debug, trace).");
+
+  allParams.add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help"))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(nbRepetitions < 1 || nbWarmups < 0)
+  {
+    ALICEVISION_LOG_ERROR("Invalid number of repetitions or warmups.");
+    return EXIT_FAILURE;
+  }
+
+  std::vector<EBenchmarkSize> benchmarkSizes;
+  for(const std::string& size : sizes)
+    benchmarkSizes.push_back(EBenchmarkSize_stringToEnum(size));
+
+  BenchmarkRegistry registry;
+  registerMatchingBenchmarks(registry);
+  registerRobustEstimationBenchmarks(registry);
+  registerTriangulationBenchmarks(registry);
+  registerSfmBenchmarks(registry);
+  registerVoctreeBenchmarks(registry);
+#ifdef ALICEVISION_BENCHMARKS_MVS
+  registerFuseCutBenchmarks(registry);
+#endif
+
+  const std::regex filterRegex(filter);
+
+  if(listOnly)
+  {
+    for(const Benchmark& benchmark : registry.getBenchmarks())
+    {
+      if(std::regex_match(benchmark.name, filterRegex))
+        ALICEVISION_COUT(benchmark.name);
+    }
+    return EXIT_SUCCESS;
+  }
+
+  std::vector<BenchmarkResult> results;
+  bool hasFailed = false;
+
+  for(const Benchmark& benchmark : registry.getBenchmarks())
+  {
+    if(!std::regex_match(benchmark.name, filterRegex))
+      continue;
+
+    for(EBenchmarkSize size : benchmarkSizes)
+    {
+      const std::string sizeName = EBenchmarkSize_enumToString(size);
+      ALICEVISION_LOG_INFO("Run benchmark '" << benchmark.name << "' (" << sizeName << ").");
+
+      BenchmarkState state(size, seed, nbWarmups, nbRepetitions);
+
+      BenchmarkResult result;
+      result.name = benchmark.name;
+      result.size = sizeName;
+
+      try
+      {
+        benchmark.function(state);
+        if(state.getTimesMs().empty())
+          throw std::logic_error("Nothing has been measured.");
+      }
+      catch(const std::exception& e)
+      {
+        ALICEVISION_LOG_ERROR("Benchmark '" << benchmark.name << "' (" << sizeName << ") failed: " << e.what());
+        result.error = e.what();
+        results.push_back(result);
+        hasFailed = true;
+        continue;
+      }
+
+      std::vector<double> timesMs = state.getTimesMs();
+      std::sort(timesMs.begin(), timesMs.end());
+
+      result.minMs = timesMs.front();
+      result.maxMs = timesMs.back();
+      result.meanMs = std::accumulate(timesMs.begin(), timesMs.end(), 0.0) / timesMs.size();
+      result.medianMs = (timesMs.size() % 2) ? timesMs[timesMs.size() / 2]
+                                             : 0.5 * (timesMs[timesMs.size() / 2 - 1] + timesMs[timesMs.size() / 2]);
+
+      ALICEVISION_LOG_INFO(std::fixed << std::setprecision(3)
+                           << "\t- median: " << result.medianMs << " ms, min: " << result.minMs << " ms, max: " << result.maxMs << " ms");
+
+      result.timesMs = state.getTimesMs();
+      result.parameters = state.getParameters();
+      result.counters = state.getCounters();
+
+      results.push_back(result);
+    }
+  }
+
+  if(!outputFilename.empty())
+  {
+    std::ofstream os(outputFilename);
+    if(!os.is_open())
+    {
+      ALICEVISION_LOG_ERROR("Cannot open the output file '" << outputFilename << "'.");
+      return EXIT_FAILURE;
+    }
+    // the times are written without loss
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+    os << "{\n    \"version\": ";
+    writeJsonString(os, ALICEVISION_VERSION_STRING);
+    os << ",\n    \"compiler\": ";
+    writeJsonString(os, getCompiler());
+    os << ",\n    \"seed\": " << seed;
+    os << ",\n    \"repetitions\": " << nbRepetitions;
+    os << ",\n    \"warmups\": " << nbWarmups;
+    os << ",\n    \"hardware\": {\n";
+    os << "        \"cpu\": {\"freq\": " << system::cpu_clock_by_os() << ", \"cores\": " << system::get_total_cpus() << "},\n";
+    os << "        \"ram\": {\"size\": " << system::getMemoryInfo().totalRam << "},\n";
+    os << "        \"threads\": " << omp_get_max_threads() << "\n    }";
+    os << ",\n    \"benchmarks\": [";
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+      os << (i ? ",\n" : "\n");
+      writeJsonResult(os, results[i]);
+    }
+    os << "\n    ]\n}\n";
+
+    if(!os.good())
+    {
+      ALICEVISION_LOG_ERROR("Cannot write the output file '" << outputFilename << "'.");
+      return EXIT_FAILURE;
+    }
+    ALICEVISION_LOG_INFO("Benchmark results written to '" << outputFilename << "'.");
+  }
+
+  return hasFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,258 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/feature/metric.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+#include <aliceVision/matching/ArrayMatcher_bruteForce.hpp>
+#include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
+#include <aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp>
+#include <aliceVision/matching/guidedMatching.hpp>
+#include <aliceVision/multiview/relativePose/FundamentalError.hpp>
+#include <aliceVision/robustEstimation/ISolver.hpp>
+#include <aliceVision/matchingImageCollection/GeometricFilterMatrix_HGrowing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace aliceVision {
+namespace benchmark {
+
+namespace {
+
+const int descriptorDim = 128;
+
+/**
+ * @brief Generate SIFT-like descriptors for two images: the query descriptors are noisy copies
+ * of the dataset descriptors, so that the i-th query should be matched with the i-th descriptor.
+ */
+template<typename Scalar>
+void generateDescriptors(std::mt19937& generator, int nbDescriptors, float maxValue,
+                         std::vector<Scalar>& dataset, std::vector<Scalar>& query)
+{
+  std::uniform_real_distribution<float> value(0.f, maxValue);
+  std::normal_distribution<float> noise(0.f, maxValue * 0.02f);
+
+  dataset.resize(nbDescriptors * descriptorDim);
+  query.resize(nbDescriptors * descriptorDim);
+  for(std::size_t i = 0; i < dataset.size(); ++i)
+  {
+    const float v = value(generator);
+    dataset[i] = static_cast<Scalar>(v);
+    query[i] = static_cast<Scalar>(std::min(maxValue, std::max(0.f, v + noise(generator))));
+  }
+}
+
+/**
+ * @brief Build the matcher on the dataset and search the 2 nearest neighbors of the queries, as the ratio test does.
+ */
+template<typename MatcherT>
+void benchmarkMatcher(BenchmarkState& state, int nbDescriptors, float maxValue)
+{
+  using Scalar = typename MatcherT::ScalarT;
+
+  std::vector<Scalar> dataset;
+  std::vector<Scalar> query;
+  generateDescriptors(state.generator(), nbDescriptors, maxValue, dataset, query);
+
+  state.setParameter("nbDescriptors", nbDescriptors);
+  state.setParameter("dimension", descriptorDim);
+
+  matching::IndMatches matches;
+  std::vector<typename MatcherT::DistanceType> distances;
+
+  state.measure([&]()
+  {
+    MatcherT matcher;
+    matcher.Build(dataset.data(), nbDescriptors, descriptorDim);
+    matcher.SearchNeighbours(query.data(), nbDescriptors, &matches, &distances, 2);
+  });
+
+  std::size_t nbCorrect = 0;
+  for(std::size_t i = 0; i < matches.size(); i += 2)
+  {
+    if(matches[i]._i == matches[i]._j)
+      ++nbCorrect;
+  }
+  state.setCounter("nbCorrectMatches", nbCorrect);
+}
+
+/**
+ * @brief Filter the matches of an image pair seeing several planes with the homography growing.
+ * Each plane is seen with a different similarity and a little perspective, 20% of the matches are outliers.
+ */
+void benchmarkHGrowing(BenchmarkState& state, int nbMatches, int nbPlanes)
+{
+  std::mt19937& generator = state.generator();
+  std::uniform_real_distribution<float> coordinate(0.f, 1000.f);
+  std::uniform_real_distribution<float> scale(1.f, 5.f);
+  std::uniform_real_distribution<float> orientation(-3.f, 3.f);
+  std::uniform_real_distribution<double> angle(-0.3, 0.3);
+  std::uniform_real_distribution<double> translation(-50.0, 50.0);
+  std::uniform_int_distribution<int> plane(-1, 3 * nbPlanes);
+  std::normal_distribution<float> noise(0.f, 0.3f);
+
+  std::vector<Mat3> homographies(nbPlanes);
+  std::vector<double> angles(nbPlanes);
+  for(int p = 0; p < nbPlanes; ++p)
+  {
+    angles[p] = angle(generator);
+    homographies[p] << std::cos(angles[p]), -std::sin(angles[p]), translation(generator),
+                       std::sin(angles[p]),  std::cos(angles[p]), translation(generator),
+                       1e-5 * (p + 1), -1e-5 * p, 1.0;
+  }
+
+  std::vector<feature::PointFeature> featuresI;
+  std::vector<feature::PointFeature> featuresJ;
+  matching::IndMatches putativeMatches;
+  for(int i = 0; i < nbMatches; ++i)
+  {
+    // the planes are vertical bands of the first image
+    const int p = std::min(plane(generator) / 3, nbPlanes - 1);
+    const float s = scale(generator);
+    const float o = orientation(generator);
+    if(p < 0)
+    {
+      featuresI.emplace_back(coordinate(generator), coordinate(generator), s, o);
+      featuresJ.emplace_back(coordinate(generator), coordinate(generator), scale(generator), orientation(generator));
+    }
+    else
+    {
+      const Vec2 x((p + coordinate(generator) / 1000.f) * 1000.f / nbPlanes, coordinate(generator));
+      const Vec2 y = (homographies[p] * x.homogeneous()).hnormalized();
+      featuresI.emplace_back(x(0), x(1), s, o);
+      featuresJ.emplace_back(y(0) + noise(generator), y(1) + noise(generator), s, o + angles[p]);
+    }
+    putativeMatches.emplace_back(i, i);
+  }
+
+  state.setParameter("nbMatches", nbMatches);
+  state.setParameter("nbPlanes", nbPlanes);
+
+  std::vector<std::pair<Mat3, matching::IndMatches>> homographiesAndMatches;
+  matching::IndMatches geometricInliers;
+
+  state.measure([&]()
+  {
+    homographiesAndMatches.clear();
+    geometricInliers.clear();
+    matchingImageCollection::filterMatchesByHGrowing(featuresI, featuresJ, putativeMatches, homographiesAndMatches, geometricInliers,
+                                                     matchingImageCollection::HGrowingFilteringParam());
+  });
+
+  state.setCounter("nbHomographies", homographiesAndMatches.size());
+  state.setCounter("nbInliers", geometricInliers.size());
+}
+
+/**
+ * @brief Guided matching of an image pair with a fundamental matrix, the grids of the features are built once per view.
+ * Half of the features are seen in both images, on their epipolar line, with a noisy descriptor.
+ */
+void benchmarkGuidedMatching(BenchmarkState& state, int nbFeatures)
+{
+  using RegionsT = feature::SIFT_Regions;
+
+  std::mt19937& generator = state.generator();
+  std::uniform_real_distribution<float> x(0.f, 4000.f);
+  std::uniform_real_distribution<float> y(0.f, 3000.f);
+  std::uniform_real_distribution<double> t(-0.2, 0.2);
+  std::uniform_int_distribution<int> value(0, 255);
+  std::uniform_int_distribution<int> descNoise(-5, 5);
+  std::normal_distribution<float> noise(0.f, 0.3f);
+
+  // F = [e2]x.H: the transfer of x by H is on its epipolar line
+  Mat3 H;
+  H << 1.05, 0.02, 60.0,
+      -0.01, 0.98, -40.0,
+       5e-6, 1e-5, 1.0;
+  const Vec3 e2(-1000.0, 1400.0, 1.0);
+  const robustEstimation::Mat3Model model(CrossProductMatrix(e2) * H);
+
+  RegionsT lRegions, rRegions;
+  for(int i = 0; i < nbFeatures; ++i)
+  {
+    RegionsT::DescriptorT descriptor;
+    for(std::size_t d = 0; d < RegionsT::DescriptorT::static_size; ++d)
+      descriptor[d] = value(generator);
+    lRegions.Features().emplace_back(x(generator), y(generator), 1.f, 0.f);
+    lRegions.Descriptors().push_back(descriptor);
+
+    if(i % 2 == 0)
+    {
+      const Vec2 xH = (H * lRegions.GetRegionPosition(i).homogeneous()).hnormalized();
+      const Vec2 xR = xH + t(generator) * (xH - e2.head<2>());
+      for(std::size_t d = 0; d < RegionsT::DescriptorT::static_size; ++d)
+        descriptor[d] = std::min(255, std::max(0, descriptor[d] + descNoise(generator)));
+      rRegions.Features().emplace_back(xR(0) + noise(generator), xR(1) + noise(generator), 1.f, 0.f);
+    }
+    else
+    {
+      for(std::size_t d = 0; d < RegionsT::DescriptorT::static_size; ++d)
+        descriptor[d] = value(generator);
+      rRegions.Features().emplace_back(x(generator), y(generator), 1.f, 0.f);
+    }
+    rRegions.Descriptors().push_back(descriptor);
+  }
+
+  const matching::FeaturesGrid lGrid(nullptr, lRegions);
+  const matching::FeaturesGrid rGrid(nullptr, rRegions);
+
+  state.setParameter("nbFeatures", nbFeatures);
+
+  matching::IndMatches matches;
+
+  state.measure([&]()
+  {
+    matches.clear();
+    matching::guidedMatching<robustEstimation::Mat3Model, multiview::relativePose::FundamentalEpipolarDistanceError>(
+          model, lGrid, lRegions, rGrid, rRegions, Square(4.0), Square(0.8), matches);
+  });
+
+  state.setCounter("nbMatches", matches.size());
+}
+
+} // namespace
+
+void registerMatchingBenchmarks(BenchmarkRegistry& registry)
+{
+  registry.add("matching.bruteForce.uchar", [](BenchmarkState& state)
+  {
+    benchmarkMatcher<matching::ArrayMatcher_bruteForce<unsigned char, feature::L2_Vectorized<unsigned char>>>(state, state.select(1000, 4000, 10000), 255.f);
+  });
+  registry.add("matching.bruteForce.float", [](BenchmarkState& state)
+  {
+    benchmarkMatcher<matching::ArrayMatcher_bruteForce<float, feature::L2_Vectorized<float>>>(state, state.select(1000, 4000, 10000), 1.f);
+  });
+  registry.add("matching.kdtreeFlann.uchar", [](BenchmarkState& state)
+  {
+    benchmarkMatcher<matching::ArrayMatcher_kdtreeFlann<unsigned char>>(state, state.select(2000, 10000, 40000), 255.f);
+  });
+  registry.add("matching.kdtreeFlann.float", [](BenchmarkState& state)
+  {
+    benchmarkMatcher<matching::ArrayMatcher_kdtreeFlann<float>>(state, state.select(2000, 10000, 40000), 1.f);
+  });
+  registry.add("matching.cascadeHashing.uchar", [](BenchmarkState& state)
+  {
+    benchmarkMatcher<matching::ArrayMatcher_cascadeHashing<unsigned char, feature::L2_Vectorized<unsigned char>>>(state, state.select(2000, 10000, 40000), 255.f);
+  });
+  registry.add("matching.cascadeHashing.float", [](BenchmarkState& state)
+  {
+    benchmarkMatcher<matching::ArrayMatcher_cascadeHashing<float, feature::L2_Vectorized<float>>>(state, state.select(2000, 10000, 40000), 1.f);
+  });
+  registry.add("matching.guidedMatching.fundamental", [](BenchmarkState& state)
+  {
+    benchmarkGuidedMatching(state, state.select(2000, 10000, 40000));
+  });
+  registry.add("matchingImageCollection.hGrowing", [](BenchmarkState& state)
+  {
+    benchmarkHGrowing(state, state.select(500, 2000, 5000), state.select(2, 4, 8));
+  });
+}
+
+} // namespace benchmark
+} // namespace aliceVision
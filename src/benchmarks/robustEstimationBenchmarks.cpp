@@ -0,0 +1,149 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/multiview/ResectionKernel.hpp>
+#include <aliceVision/multiview/Unnormalizer.hpp>
+#include <aliceVision/multiview/resection/P3PSolver.hpp>
+#include <aliceVision/multiview/resection/ProjectionDistanceError.hpp>
+#include <aliceVision/multiview/resection/Resection6PSolver.hpp>
+#include <aliceVision/multiview/resection/ResectionKernel.hpp>
+#include <aliceVision/robustEstimation/ACRansac.hpp>
+#include <aliceVision/robustEstimation/LORansac.hpp>
+#include <aliceVision/robustEstimation/ScoreEvaluator.hpp>
+#include <aliceVision/sfm/pipeline/RelativePoseInfo.hpp>
+
+#include <limits>
+#include <vector>
+
+namespace aliceVision {
+namespace benchmark {
+
+namespace {
+
+/// ratio of the observations replaced by random points
+const double outliersRatio = 0.3;
+/// standard deviation of the noise added to the inliers, in pixels
+const double pixelNoise = 0.5;
+
+/**
+ * @brief Add noise to the observations and replace some of them by outliers.
+ */
+void corruptObservations(std::mt19937& generator, const NViewDatasetConfigurator& config, Mat2X& x)
+{
+  std::normal_distribution<double> noise(0.0, pixelNoise);
+  std::uniform_real_distribution<double> outlier(0.0, 1.0);
+  std::uniform_real_distribution<double> position(0.0, 2.0 * config._cx);
+
+  for(Mat2X::Index i = 0; i < x.cols(); ++i)
+  {
+    if(outlier(generator) < outliersRatio)
+      x.col(i) = Vec2(position(generator), position(generator));
+    else
+      x.col(i) += Vec2(noise(generator), noise(generator));
+  }
+}
+
+/// kernel used by the localization to estimate the pose of a calibrated camera
+template<typename SolverLsT = robustEstimation::UndefinedSolver<robustEstimation::Mat34Model>>
+using ResectionKernel = multiview::ResectionKernel_K<multiview::resection::P3PSolver,
+                                                     multiview::resection::ProjectionDistanceSquaredError,
+                                                     multiview::UnnormalizerResection,
+                                                     robustEstimation::Mat34Model,
+                                                     SolverLsT>;
+
+/**
+ * @brief Generate the 2D-3D correspondences of one camera of a synthetic scene.
+ */
+void generateResectionData(BenchmarkState& state, Mat& pt2D, Mat& pt3D, Mat3& K)
+{
+  const int nbPoints = state.select(200, 2000, 20000);
+  state.setParameter("nbPoints", nbPoints);
+  state.setParameter("outliersRatio", outliersRatio);
+
+  const NViewDatasetConfigurator config;
+  const NViewDataSet d = NRealisticCamerasRing(1, nbPoints, config);
+
+  Mat2X x = d._x[0];
+  corruptObservations(state.generator(), config, x);
+  pt2D = x;
+  pt3D = d._X;
+  K = d._K[0];
+}
+
+} // namespace
+
+void registerRobustEstimationBenchmarks(BenchmarkRegistry& registry)
+{
+  registry.add("robustEstimation.acransac.relativePose", [](BenchmarkState& state)
+  {
+    const int nbPoints = state.select(200, 2000, 20000);
+    state.setParameter("nbPoints", nbPoints);
+    state.setParameter("outliersRatio", outliersRatio);
+
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(2, nbPoints, config);
+
+    Mat2X x1 = d._x[0];
+    Mat2X x2 = d._x[1];
+    corruptObservations(state.generator(), config, x1);
+    corruptObservations(state.generator(), config, x2);
+
+    const std::pair<std::size_t, std::size_t> imageSize(2 * config._cx, 2 * config._cy);
+    sfm::RelativePoseInfo relativePoseInfo;
+
+    state.measure([&]()
+    {
+      relativePoseInfo = sfm::RelativePoseInfo();
+      sfm::robustRelativePose(d._K[0], d._K[1], x1, x2, relativePoseInfo, imageSize, imageSize, 4096);
+    });
+    state.setCounter("nbInliers", relativePoseInfo.vec_inliers.size());
+  });
+
+  registry.add("robustEstimation.acransac.resection", [](BenchmarkState& state)
+  {
+    Mat pt2D, pt3D;
+    Mat3 K;
+    generateResectionData(state, pt2D, pt3D, K);
+
+    const ResectionKernel<> kernel(pt2D, pt3D, K);
+    std::vector<std::size_t> inliers;
+
+    state.measure([&]()
+    {
+      robustEstimation::Mat34Model model;
+      robustEstimation::ACRANSAC(kernel, inliers, 4096, &model, std::numeric_limits<double>::infinity());
+    });
+    state.setCounter("nbInliers", inliers.size());
+  });
+
+  registry.add("robustEstimation.loransac.resection", [](BenchmarkState& state)
+  {
+    Mat pt2D, pt3D;
+    Mat3 K;
+    generateResectionData(state, pt2D, pt3D, K);
+
+    using KernelT = ResectionKernel<multiview::resection::Resection6PSolver>;
+    const KernelT kernel(pt2D, pt3D, K);
+
+    // the error is computed on the normalized points
+    const double maxError = 4.0;
+    const double threshold = maxError * maxError * (kernel.normalizer2()(0, 0) * kernel.normalizer2()(0, 0));
+    const robustEstimation::ScoreEvaluator<KernelT> scorer(threshold);
+    std::vector<std::size_t> inliers;
+
+    state.measure([&]()
+    {
+      robustEstimation::LO_RANSAC(kernel, scorer, &inliers);
+    });
+    state.setCounter("nbInliers", inliers.size());
+  });
+}
+
+} // namespace benchmark
+} // namespace aliceVision
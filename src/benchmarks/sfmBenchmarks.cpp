@@ -0,0 +1,85 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/sfm/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/track/TracksBuilder.hpp>
+
+namespace aliceVision {
+namespace benchmark {
+
+void registerSfmBenchmarks(BenchmarkRegistry& registry)
+{
+  registry.add("sfm.bundleAdjustmentCeres", [](BenchmarkState& state)
+  {
+    const int nbViews = state.select(8, 24, 64);
+    const int nbPoints = state.select(500, 4000, 20000);
+    state.setParameter("nbViews", nbViews);
+    state.setParameter("nbPoints", nbPoints);
+
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints, config);
+    sfmData::SfMData groundTruth = sfm::getInputScene(d, config, camera::EINTRINSIC::PINHOLE_CAMERA_RADIAL3);
+
+    // perturb the poses and the structure, the first pose is kept as reference
+    std::normal_distribution<double> noise(0.0, 0.01);
+    for(auto& posePair : groundTruth.getPoses())
+    {
+      if(posePair.first == 0)
+        continue;
+      geometry::Pose3 pose = posePair.second.getTransform();
+      pose.center() += Vec3(noise(state.generator()), noise(state.generator()), noise(state.generator()));
+      posePair.second.setTransform(pose);
+    }
+    for(auto& landmarkPair : groundTruth.getLandmarks())
+      landmarkPair.second.X += Vec3(noise(state.generator()), noise(state.generator()), noise(state.generator()));
+
+    sfmData::SfMData sfmData;
+    sfm::BundleAdjustmentCeres::CeresOptions options(false);
+    if(nbViews > 32)
+      options.setSparseBA();
+    sfm::BundleAdjustmentCeres bundleAdjustment(options);
+
+    state.measure(
+      [&]() { sfmData = groundTruth; },
+      [&]() { bundleAdjustment.adjust(sfmData); });
+
+    state.setCounter("RMSEinitial", bundleAdjustment.getStatistics().RMSEinitial);
+    state.setCounter("RMSEfinal", bundleAdjustment.getStatistics().RMSEfinal);
+  });
+
+  registry.add("track.tracksBuilder", [](BenchmarkState& state)
+  {
+    const int nbViews = state.select(10, 30, 60);
+    const int nbPoints = state.select(2000, 20000, 100000);
+    state.setParameter("nbViews", nbViews);
+    state.setParameter("nbPoints", nbPoints);
+
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints, config);
+    const sfmData::SfMData sfmData = sfm::getInputScene(d, config, camera::EINTRINSIC::PINHOLE_CAMERA);
+
+    matching::PairwiseMatches pairwiseMatches;
+    sfm::generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::SIFT);
+
+    track::TracksMap tracks;
+
+    state.measure([&]()
+    {
+      track::TracksBuilder tracksBuilder;
+      tracksBuilder.build(pairwiseMatches);
+      tracksBuilder.filter(true, 2);
+      tracks.clear();
+      tracksBuilder.exportToSTL(tracks);
+    });
+    state.setCounter("nbTracks", tracks.size());
+  });
+}
+
+} // namespace benchmark
+} // namespace aliceVision
@@ -0,0 +1,107 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/multiview/triangulation/Triangulation.hpp>
+#include <aliceVision/multiview/triangulation/triangulationDLT.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace benchmark {
+
+namespace {
+
+/**
+ * @brief Sum of the distances between the triangulated points and the ground truth.
+ */
+double computeError(const NViewDataSet& d, const std::vector<Vec3>& points)
+{
+  double error = 0.0;
+  for(std::size_t i = 0; i < points.size(); ++i)
+    error += (points[i] - d._X.col(i)).norm();
+  return error;
+}
+
+/**
+ * @brief Triangulate all the points of a synthetic scene seen by all the cameras.
+ * @param[in] nbPoints the number of points
+ * @param[in] triangulate the function triangulating one point from its observations
+ */
+template<typename TriangulateFunction>
+void benchmarkNViewTriangulation(BenchmarkState& state, int nbPoints, TriangulateFunction triangulate)
+{
+  const int nbViews = state.select(4, 8, 16);
+  state.setParameter("nbViews", nbViews);
+  state.setParameter("nbPoints", nbPoints);
+
+  const NViewDataSet d = NRealisticCamerasRing(nbViews, nbPoints);
+  std::vector<Mat34> Ps(nbViews);
+  for(int v = 0; v < nbViews; ++v)
+    Ps[v] = d.P(v);
+
+  std::vector<Vec3> points(nbPoints);
+
+  state.measure([&]()
+  {
+    Mat2X x(2, nbViews);
+    for(int i = 0; i < nbPoints; ++i)
+    {
+      for(int v = 0; v < nbViews; ++v)
+        x.col(v) = d._x[v].col(i);
+
+      Vec4 X;
+      triangulate(x, Ps, &X);
+      points[i] = X.hnormalized();
+    }
+  });
+  state.setCounter("error", computeError(d, points));
+}
+
+} // namespace
+
+void registerTriangulationBenchmarks(BenchmarkRegistry& registry)
+{
+  registry.add("multiview.triangulation.dlt", [](BenchmarkState& state)
+  {
+    const int nbPoints = state.select(10000, 100000, 1000000);
+    state.setParameter("nbPoints", nbPoints);
+
+    const NViewDataSet d = NRealisticCamerasRing(2, nbPoints);
+    const Mat34 P1 = d.P(0);
+    const Mat34 P2 = d.P(1);
+
+    std::vector<Vec3> points(nbPoints);
+
+    state.measure([&]()
+    {
+      for(int i = 0; i < nbPoints; ++i)
+        multiview::TriangulateDLT(P1, d._x[0].col(i), P2, d._x[1].col(i), &points[i]);
+    });
+    state.setCounter("error", computeError(d, points));
+  });
+
+  registry.add("multiview.triangulation.nview", [](BenchmarkState& state)
+  {
+    benchmarkNViewTriangulation(state, state.select(1000, 10000, 100000), [](const Mat2X& x, const std::vector<Mat34>& Ps, Vec4* X)
+    {
+      multiview::TriangulateNView(x, Ps, X);
+    });
+  });
+
+  registry.add("multiview.triangulation.nviewLORANSAC", [](BenchmarkState& state)
+  {
+    benchmarkNViewTriangulation(state, state.select(100, 1000, 10000), [](const Mat2X& x, const std::vector<Mat34>& Ps, Vec4* X)
+    {
+      multiview::TriangulateNViewLORANSAC(x, Ps, X);
+    });
+  });
+}
+
+} // namespace benchmark
+} // namespace aliceVision
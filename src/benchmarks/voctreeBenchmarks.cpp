@@ -0,0 +1,159 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "Benchmark.hpp"
+
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/voctree/TreeBuilder.hpp>
+
+#include <set>
+#include <vector>
+
+namespace aliceVision {
+namespace benchmark {
+
+namespace {
+
+using DescriptorUChar = feature::Descriptor<unsigned char, 128>;
+using DescriptorFloat = feature::Descriptor<float, 128>;
+
+template<class DescriptorT>
+void generateDescriptors(std::mt19937& generator, std::size_t nbDescriptors, float maxValue, std::vector<DescriptorT>& descriptors)
+{
+  std::uniform_real_distribution<float> value(0.f, maxValue);
+  descriptors.resize(nbDescriptors);
+  for(DescriptorT& descriptor : descriptors)
+    for(std::size_t j = 0; j < DescriptorT::static_size; ++j)
+      descriptor[j] = static_cast<typename DescriptorT::bin_type>(value(generator));
+}
+
+/**
+ * @brief Generate random documents and queries: the i-th query shares half of its words with the i-th document.
+ */
+void generateDocuments(std::mt19937& generator, std::size_t nbDocuments, std::size_t nbQueries, std::size_t nbWordsPerDocument,
+                       voctree::Word nbWords, std::vector<std::vector<voctree::Word>>& documents, std::vector<std::vector<voctree::Word>>& queries)
+{
+  std::uniform_int_distribution<voctree::Word> word(0, nbWords - 1);
+
+  documents.resize(nbDocuments);
+  for(std::vector<voctree::Word>& document : documents)
+  {
+    document.resize(nbWordsPerDocument);
+    for(voctree::Word& w : document)
+      w = word(generator);
+  }
+
+  queries.resize(nbQueries);
+  for(std::size_t i = 0; i < nbQueries; ++i)
+  {
+    queries[i] = documents[i];
+    for(std::size_t j = 0; j < nbWordsPerDocument; j += 2)
+      queries[i][j] = word(generator);
+  }
+}
+
+} // namespace
+
+void registerVoctreeBenchmarks(BenchmarkRegistry& registry)
+{
+  registry.add("voctree.build", [](BenchmarkState& state)
+  {
+    const std::size_t nbDescriptors = state.select(10000, 50000, 200000);
+    const uint32_t k = 10;
+    const uint32_t levels = state.select(2, 3, 3);
+    state.setParameter("nbDescriptors", nbDescriptors);
+    state.setParameter("k", k);
+    state.setParameter("levels", levels);
+
+    std::vector<DescriptorFloat> descriptors;
+    generateDescriptors(state.generator(), nbDescriptors, 1.f, descriptors);
+
+    std::size_t nbWords = 0;
+
+    state.measure([&]()
+    {
+      voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
+      builder.setVerbose(0);
+      builder.kmeans().setRestarts(1);
+      builder.kmeans().setMaxIterations(10);
+      builder.build(descriptors, k, levels);
+      nbWords = builder.tree().words();
+    });
+    state.setCounter("nbWords", nbWords);
+  });
+
+  registry.add("voctree.quantize", [](BenchmarkState& state)
+  {
+    const std::size_t nbDescriptors = state.select(10000, 50000, 200000);
+    const uint32_t k = 10;
+    const uint32_t levels = state.select(4, 5, 6);
+    state.setParameter("nbDescriptors", nbDescriptors);
+    state.setParameter("k", k);
+    state.setParameter("levels", levels);
+
+    // random centers: the quantization cost does not depend on the quality of the tree
+    voctree::MutableVocabularyTree<DescriptorUChar> tree;
+    tree.setSize(levels, k);
+    generateDescriptors(state.generator(), tree.nodes(), 255.f, tree.centers());
+    tree.validCenters().assign(tree.nodes(), 1);
+    tree.updateQuantizer();
+
+    std::vector<DescriptorUChar> descriptors;
+    generateDescriptors(state.generator(), nbDescriptors, 255.f, descriptors);
+
+    std::vector<voctree::Word> words;
+
+    state.measure([&]()
+    {
+      words = tree.quantize(descriptors);
+    });
+    state.setCounter("nbDistinctWords", std::set<voctree::Word>(words.begin(), words.end()).size());
+  });
+
+  registry.add("voctree.query", [](BenchmarkState& state)
+  {
+    const std::size_t nbDocuments = state.select(200, 2000, 10000);
+    const std::size_t nbQueries = 100;
+    const std::size_t nbWordsPerDocument = 2000;
+    const voctree::Word nbWords = 1000000;
+    state.setParameter("nbDocuments", nbDocuments);
+    state.setParameter("nbQueries", nbQueries);
+    state.setParameter("nbWordsPerDocument", nbWordsPerDocument);
+
+    std::vector<std::vector<voctree::Word>> documents;
+    std::vector<std::vector<voctree::Word>> queries;
+    generateDocuments(state.generator(), nbDocuments, nbQueries, nbWordsPerDocument, nbWords, documents, queries);
+
+    voctree::Database database(nbWords);
+    for(std::size_t i = 0; i < documents.size(); ++i)
+    {
+      voctree::SparseHistogram histogram;
+      voctree::computeSparseHistogram(documents[i], histogram);
+      database.insert(i, histogram);
+    }
+    database.computeTfIdfWeights();
+
+    std::size_t nbFound = 0;
+
+    state.measure([&]()
+    {
+      nbFound = 0;
+      std::vector<voctree::DocMatch> matches;
+      for(std::size_t i = 0; i < queries.size(); ++i)
+      {
+        database.find(queries[i], 10, matches);
+        if(!matches.empty() && matches.front().id == i)
+          ++nbFound;
+      }
+    });
+    state.setCounter("nbFound", nbFound);
+  });
+}
+
+} // namespace benchmark
+} // namespace aliceVision
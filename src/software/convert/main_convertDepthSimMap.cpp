@@ -0,0 +1,178 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2020 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/mvsData/depthSimMapFile.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace {
+
+const std::string depthMapSuffix = "_depthMap.exr";
+const std::string simMapSuffix = "_simMap.exr";
+const std::string depthSimMapSuffix = "_depthSimMap.avdm";
+
+/// List the names (without suffix) of the files of a folder ending with the given suffix
+std::vector<std::string> listFiles(const std::string& folder, const std::string& suffix)
+{
+  std::vector<std::string> names;
+  for(const fs::directory_entry& entry : fs::directory_iterator(folder))
+  {
+    const std::string filename = entry.path().filename().string();
+    if(fs::is_regular_file(entry.path()) && boost::algorithm::ends_with(filename, suffix))
+      names.push_back(filename.substr(0, filename.size() - suffix.size()));
+  }
+  return names;
+}
+
+} // namespace
+
+// convert depth/sim maps from EXR to the AliceVision depth/sim map file format, or back
+int aliceVision_main(int argc, char** argv)
+{
+  // command-line parameters
+
+  std::string verboseLevel = system::EVerboseLevel_enumToString(system::Logger::getDefaultVerboseLevel());
+  std::string inputFolder;
+  std::string outputFolder;
+
+  // user optional parameters
+
+  bool toEXR = false;
+  imageIO::DepthSimMapFileOptions options;
+
+  po::options_description allParams("AliceVision convertDepthSimMap\n"
+                                    "Convert EXR depth/sim maps (<viewId>_depthMap.exr, <viewId>_simMap.exr) into "
+                                    "compact tiled depth/sim map files (<viewId>_depthSimMap.avdm), or back.");
+
+  po::options_description requiredParams("Required parameters");
+  requiredParams.add_options()
+    ("input,i", po::value<std::string>(&inputFolder)->required(),
+      "Input depth maps folder.")
+    ("output,o", po::value<std::string>(&outputFolder)->required(),
+      "Output depth maps folder.");
+
+  po::options_description optionalParams("Optional parameters");
+  optionalParams.add_options()
+    ("toEXR", po::value<bool>(&toEXR)->default_value(toEXR),
+      "Convert depth/sim map files back to EXR depth and sim maps.")
+    ("depthEncoding", po::value<imageIO::EDepthMapEncoding>(&options.depthEncoding)->default_value(options.depthEncoding),
+      imageIO::EDepthMapEncoding_informations().c_str())
+    ("simEncoding", po::value<imageIO::EDepthMapEncoding>(&options.simEncoding)->default_value(options.simEncoding),
+      imageIO::EDepthMapEncoding_informations().c_str())
+    ("tileSize", po::value<int>(&options.tileSize)->default_value(options.tileSize),
+      "Tile width and height in pixels.");
+
+  po::options_description logParams("Log parameters");
+  logParams.add_options()
+    ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
+      "verbosity level (fatal,  error, warning, info, debug, trace).");
+
+  allParams.add(requiredParams).add(optionalParams).add(logParams);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::parse_command_line(argc, argv, allParams), vm);
+
+    if(vm.count("help") || (argc == 1))
+    {
+      ALICEVISION_COUT(allParams);
+      return EXIT_SUCCESS;
+    }
+    po::notify(vm);
+  }
+  catch(boost::program_options::required_option& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+  catch(boost::program_options::error& e)
+  {
+    ALICEVISION_CERR("ERROR: " << e.what());
+    ALICEVISION_COUT("Usage:\n\n" << allParams);
+    return EXIT_FAILURE;
+  }
+
+  ALICEVISION_COUT("Program called with the following parameters:");
+  ALICEVISION_COUT(vm);
+
+  // set verbose level
+  system::Logger::get()->setLogLevel(verboseLevel);
+
+  if(!fs::is_directory(inputFolder))
+  {
+    ALICEVISION_LOG_ERROR("Input folder '" << inputFolder << "' does not exist.");
+    return EXIT_FAILURE;
+  }
+
+  if(!fs::exists(outputFolder))
+    fs::create_directory(outputFolder);
+
+  const std::vector<std::string> names = listFiles(inputFolder, toEXR ? depthSimMapSuffix : depthMapSuffix);
+  ALICEVISION_LOG_INFO("Convert " << names.size() << " depth map(s).");
+
+  int nbErrors = 0;
+
+  #pragma omp parallel for schedule(dynamic) reduction(+:nbErrors)
+  for(int i = 0; i < names.size(); ++i)
+  {
+    const fs::path input(inputFolder);
+    const fs::path output(outputFolder);
+    const std::string& name = names[i];
+
+    try
+    {
+      if(toEXR)
+      {
+        const imageIO::DepthSimMapFileHeader header = imageIO::readDepthSimMapFileHeader((input / (name + depthSimMapSuffix)).string());
+        imageIO::convertDepthSimMapToEXR((input / (name + depthSimMapSuffix)).string(),
+                                         (output / (name + depthMapSuffix)).string(),
+                                         header.hasSimMap ? (output / (name + simMapSuffix)).string() : "");
+      }
+      else
+      {
+        const fs::path simMapPath = input / (name + simMapSuffix);
+        imageIO::convertDepthSimMapFromEXR((input / (name + depthMapSuffix)).string(),
+                                           fs::exists(simMapPath) ? simMapPath.string() : "",
+                                           (output / (name + depthSimMapSuffix)).string(),
+                                           options);
+      }
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_ERROR("Failed to convert depth map '" << name << "': " << e.what());
+      ++nbErrors;
+    }
+  }
+
+  if(nbErrors > 0)
+  {
+    ALICEVISION_LOG_ERROR(nbErrors << " depth map(s) could not be converted.");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -132,6 +132,8 @@ int aliceVision_main(int argc, char** argv)
   ALICEVISION_LOG_INFO("Build animated camera(s)...");
 
   image::Image<image::RGBfColor> image, image_ud;
+  // undistortion maps shared by the views of the same intrinsic
+  camera::UndistortMapCache undistortMapCache;
   boost::progress_display progressBar(sfmData.getViews().size());
 
   for(const auto& viewPair : sfmData.getViews())
@@ -162,7 +164,7 @@ int aliceVision_main(int argc, char** argv)
       if(cam->isValid() && cam->hasDistortion())
       {
         // undistort the image and save it
-        camera::UndistortImage(image, cam, image_ud, image::FBLACK, true); // correct principal point
+        camera::UndistortImage(image, cam, image_ud, image::FBLACK, undistortMapCache, true); // correct principal point
         image::writeImage(dstImage, image_ud, image::EImageColorSpace::LINEAR);
       }
       else // (no distortion)
@@ -28,7 +28,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 0
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 2
 
 using namespace aliceVision;
 
@@ -62,6 +62,8 @@ int aliceVision_main(int argc, char** argv)
 
     image::EStorageDataType storageDataType = image::EStorageDataType::Float;
 
+    int stripHeight = 256;
+
     int rangeStart = -1;
     int rangeSize = 1;
 
@@ -97,6 +99,9 @@ int aliceVision_main(int argc, char** argv)
          "full correction to maxLuminance.")
         ("storageDataType", po::value<image::EStorageDataType>(&storageDataType)->default_value(storageDataType),
          ("Storage data type: " + image::EStorageDataType_informations()).c_str())
+        ("stripHeight", po::value<int>(&stripHeight)->default_value(stripHeight),
+         "Number of rows merged at once when streaming the LDR images to the HDR image, "
+         "to keep the memory usage independent of the image size (0 to load the whole images).")
         ("rangeStart", po::value<int>(&rangeStart)->default_value(rangeStart),
           "Range image index start.")
         ("rangeSize", po::value<int>(&rangeSize)->default_value(rangeSize),
@@ -255,32 +260,51 @@ int aliceVision_main(int argc, char** argv)
     {
         const std::vector<std::shared_ptr<sfmData::View>>& group = groupedViews[g];
 
-        std::vector<image::Image<image::RGBfColor>> images(group.size());
         std::shared_ptr<sfmData::View> targetView = targetViews[g];
         std::vector<float> exposures(group.size(), 0.0f);
+        std::vector<std::string> filepaths(group.size());
 
-        // Load all images of the group
         for(std::size_t i = 0; i < group.size(); ++i)
         {
-            const std::string filepath = group[i]->getImagePath();
-            ALICEVISION_LOG_INFO("Load " << filepath);
-            image::readImage(filepath, images[i], image::EImageColorSpace::SRGB);
-
+            filepaths[i] = group[i]->getImagePath();
             exposures[i] = group[i]->getCameraExposureSetting(/*targetView->getMetadataISO(), targetView->getMetadataFNumber()*/);
         }
 
+        const std::string hdrImagePath = getHdrImagePath(outputPath, g);
+
+        // Write an image with parameters from the target view
+        oiio::ParamValueList targetMetadata = image::readImageMetadata(targetView->getImagePath());
+        targetMetadata.push_back(oiio::ParamValue("AliceVision:storageDataType", image::EStorageDataType_enumToString(storageDataType)));
+
+        const float targetCameraExposure = targetView->getCameraExposureSetting();
+
+        if(group.size() > 1 && stripHeight > 0)
+        {
+            // Merge HDR image strip by strip, without loading the whole images
+            hdr::hdrMerge merge;
+            ALICEVISION_LOG_INFO("[" << g - rangeStart << "/" << rangeSize << "] Merge " << group.size() << " LDR images " << g << "/" << groupedViews.size());
+            merge.processStreaming(filepaths, exposures, fusionWeight, response, hdrImagePath, targetMetadata,
+                                   targetCameraExposure, highlightCorrectionFactor, highlightTargetLux, stripHeight);
+            continue;
+        }
+
+        std::vector<image::Image<image::RGBfColor>> images(group.size());
+
+        // Load all images of the group
+        for(std::size_t i = 0; i < group.size(); ++i)
+        {
+            ALICEVISION_LOG_INFO("Load " << filepaths[i]);
+            image::readImage(filepaths[i], images[i], image::EImageColorSpace::SRGB);
+        }
+
         // Merge HDR images
         image::Image<image::RGBfColor> HDRimage;
         if(images.size() > 1)
         {
             hdr::hdrMerge merge;
-            float targetCameraExposure = targetView->getCameraExposureSetting();
             ALICEVISION_LOG_INFO("[" << g - rangeStart << "/" << rangeSize << "] Merge " << group.size() << " LDR images " << g << "/" << groupedViews.size());
             merge.process(images, exposures, fusionWeight, response, HDRimage, targetCameraExposure);
-            if(highlightCorrectionFactor > 0.0f)
-            {
-                merge.postProcessHighlight(images, exposures, fusionWeight, response, HDRimage, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux);
-            }
+            merge.postProcessHighlight(images, exposures, fusionWeight, response, HDRimage, targetCameraExposure, highlightCorrectionFactor, highlightTargetLux);
         }
         else if(images.size() == 1)
         {
@@ -288,12 +312,6 @@ int aliceVision_main(int argc, char** argv)
             HDRimage = images[0];
         }
 
-        const std::string hdrImagePath = getHdrImagePath(outputPath, g);
-
-        // Write an image with parameters from the target view
-        oiio::ParamValueList targetMetadata = image::readImageMetadata(targetView->getImagePath());
-        targetMetadata.push_back(oiio::ParamValue("AliceVision:storageDataType", image::EStorageDataType_enumToString(storageDataType)));
-
         image::writeImage(hdrImagePath, HDRimage, image::EImageColorSpace::AUTO, targetMetadata);
     }
 
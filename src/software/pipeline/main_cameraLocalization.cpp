@@ -7,6 +7,7 @@
 #include <aliceVision/config.hpp>
 #include <aliceVision/localization/ILocalizer.hpp>
 #include <aliceVision/localization/VoctreeLocalizer.hpp>
+#include <aliceVision/localization/LocalizationPipeline.hpp>
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
 #include <aliceVision/localization/CCTagLocalizer.hpp>
 #endif
@@ -46,7 +47,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -109,6 +110,8 @@ int aliceVision_main(int argc, char** argv)
   /// enable/disable the robust matching (geometric validation) when matching query image
   /// and databases images
   bool robustMatching = true;
+  /// number of frames localized concurrently (0 = number of cores, 1 = sequential)
+  std::size_t nbWorkers = 1;
   
   /// the Alembic export file
   std::string exportAlembicFile = "trackedcameras.abc";
@@ -196,6 +199,9 @@ int aliceVision_main(int argc, char** argv)
       ("robustMatching", po::value<bool>(&robustMatching)->default_value(robustMatching), 
           "[voctree] Enable/Disable the robust matching between query and database images, "
           "all putative matches will be considered.")
+      ("nbWorkers", po::value<std::size_t>(&nbWorkers)->default_value(nbWorkers),
+          "[voctree] Number of frames processed concurrently by the localization pipeline "
+          "(0 = number of cores, 1 = sequential localization).")
 // cctag specific options
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CCTAG)
       ("nNearestKeyFrames", po::value<size_t>(&nNearestKeyFrames)->default_value(nNearestKeyFrames), 
@@ -409,31 +415,16 @@ int aliceVision_main(int argc, char** argv)
   
   std::vector<localization::LocalizationResult> vec_localizationResults;
   
-  while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+  // save the localization result of a frame, in the order of the sequence
+  const auto saveResult = [&](const localization::LocalizationResult& localizationResult)
   {
-    ALICEVISION_COUT("******************************");
-    ALICEVISION_COUT("FRAME " << myToString(frameCounter,4));
-    ALICEVISION_COUT("******************************");
-    localization::LocalizationResult localizationResult;
-    auto detect_start = std::chrono::steady_clock::now();
-    localizer->localize(imageGrey, 
-                       param.get(),
-                       hasIntrinsics /*useInputIntrinsics*/,
-                       queryIntrinsics,
-                       localizationResult,
-                       currentImgName);
-    auto detect_end = std::chrono::steady_clock::now();
-    auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-    ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
-    stats(detect_elapsed.count());
-    
     vec_localizationResults.emplace_back(localizationResult);
 
     // save data
     if(localizationResult.isValid())
     {
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
-      exporter.addCameraKeyframe(localizationResult.getPose(), &queryIntrinsics, currentImgName, frameCounter, frameCounter);
+      exporter.addCameraKeyframe(localizationResult.getPose(), &localizationResult.getIntrinsics(), currentImgName, frameCounter, frameCounter);
 #endif
       
       goodFrameCounter++;
@@ -447,7 +438,53 @@ int aliceVision_main(int argc, char** argv)
 #endif
     }
     ++frameCounter;
-    feed.goToNextFrame();
+  };
+
+  if(useVoctreeLocalizer && nbWorkers != 1)
+  {
+    // frames are localized concurrently, the time is measured between two consecutive results
+    localization::LocalizationPipeline pipeline(*static_cast<localization::VoctreeLocalizer*>(localizer.get()),
+                                                *static_cast<const localization::VoctreeLocalizer::Parameters*>(param.get()),
+                                                nbWorkers);
+    auto detect_start = std::chrono::steady_clock::now();
+    pipeline.run(feed, [&](std::size_t frameId, const std::string& mediaPath, const localization::LocalizationResult& localizationResult)
+    {
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("FRAME " << myToString(frameId,4));
+      ALICEVISION_COUT("******************************");
+      auto detect_end = std::chrono::steady_clock::now();
+      auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+      detect_start = detect_end;
+      ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
+      stats(detect_elapsed.count());
+
+      currentImgName = mediaPath;
+      saveResult(localizationResult);
+    });
+  }
+  else
+  {
+    while(feed.readImage(imageGrey, queryIntrinsics, currentImgName, hasIntrinsics))
+    {
+      ALICEVISION_COUT("******************************");
+      ALICEVISION_COUT("FRAME " << myToString(frameCounter,4));
+      ALICEVISION_COUT("******************************");
+      localization::LocalizationResult localizationResult;
+      auto detect_start = std::chrono::steady_clock::now();
+      localizer->localize(imageGrey, 
+                         param.get(),
+                         hasIntrinsics /*useInputIntrinsics*/,
+                         queryIntrinsics,
+                         localizationResult,
+                         currentImgName);
+      auto detect_end = std::chrono::steady_clock::now();
+      auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+      ALICEVISION_COUT("\nLocalization took  " << detect_elapsed.count() << " [ms]");
+      stats(detect_elapsed.count());
+
+      saveResult(localizationResult);
+      feed.goToNextFrame();
+    }
   }
 
   if(wantsJsonOutput)
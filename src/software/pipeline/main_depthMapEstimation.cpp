@@ -8,8 +8,10 @@
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/depthMap/RefineRc.hpp>
 #include <aliceVision/depthMap/SemiGlobalMatchingRc.hpp>
+#include <aliceVision/fuseCut/Fuser.hpp>
 #include <aliceVision/mvsData/StaticVector.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
+#include <aliceVision/mvsUtils/DepthSimMapsCache.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/system/Logger.hpp>
@@ -23,7 +25,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -72,6 +74,14 @@ int aliceVision_main(int argc, char* argv[])
     // number of GPUs to use (0 means use all GPUs)
     int nbGPUs = 0;
 
+    // depth maps filtering in the same process
+    std::string filterOutputFolder;
+    int minNumOfConsistentCams = 3;
+    int minNumOfConsistentCamsWithLowSimilarity = 4;
+    int pixSizeBall = 0;
+    int pixSizeBallWithLowSimilarity = 0;
+    int nNearestCams = 10;
+
     po::options_description allParams("AliceVision depthMapEstimation\n"
                                       "Estimate depth map for each input image");
 
@@ -127,12 +137,29 @@ int aliceVision_main(int argc, char* argv[])
         ("nbGPUs", po::value<int>(&nbGPUs)->default_value(nbGPUs),
             "Number of GPUs to use (0 means use all GPUs).");
 
+    po::options_description filteringParams("Filtering parameters");
+    filteringParams.add_options()
+        ("filterOutput", po::value<std::string>(&filterOutputFolder)->default_value(filterOutputFolder),
+            "Output folder for filtered depth maps. If set, the depth maps are filtered in the same process, "
+            "the estimated depth maps are kept in memory instead of being written to disk and read back "
+            "(same as depthMapFiltering, all the cameras must be processed).")
+        ("minNumOfConsistentCams", po::value<int>(&minNumOfConsistentCams)->default_value(minNumOfConsistentCams),
+            "Minimal number of consistent cameras to consider the pixel.")
+        ("minNumOfConsistentCamsWithLowSimilarity", po::value<int>(&minNumOfConsistentCamsWithLowSimilarity)->default_value(minNumOfConsistentCamsWithLowSimilarity),
+            "Minimal number of consistent cameras to consider the pixel when the similarity is weak or ambiguous.")
+        ("pixSizeBall", po::value<int>(&pixSizeBall)->default_value(pixSizeBall),
+            "Filter ball size (in px).")
+        ("pixSizeBallWithLowSimilarity", po::value<int>(&pixSizeBallWithLowSimilarity)->default_value(pixSizeBallWithLowSimilarity),
+            "Filter ball size (in px) when the similarity is weak or ambiguous.")
+        ("nNearestCams", po::value<int>(&nNearestCams)->default_value(nNearestCams),
+            "Number of nearest cameras.");
+
     po::options_description logParams("Log parameters");
     logParams.add_options()
       ("verboseLevel,v", po::value<std::string>(&verboseLevel)->default_value(verboseLevel),
         "verbosity level (fatal, error, warning, info, debug, trace).");
 
-    allParams.add(requiredParams).add(optionalParams).add(logParams);
+    allParams.add(requiredParams).add(optionalParams).add(filteringParams).add(logParams);
 
     po::variables_map vm;
 
@@ -184,6 +211,15 @@ int aliceVision_main(int argc, char* argv[])
       return EXIT_FAILURE;
     }
 
+    const bool filterDepthMaps = !filterOutputFolder.empty();
+
+    // the filtering of a depth map needs the depth maps of its neighbors
+    if(filterDepthMaps && rangeSize != -1)
+    {
+      ALICEVISION_LOG_ERROR("The depth maps filtering in the same process needs all the cameras, it cannot be used with a sub-range.");
+      return EXIT_FAILURE;
+    }
+
     // read the input SfM scene
     sfmData::SfMData sfmData;
     if(!sfmDataIO::Load(sfmData, sfmDataFilename, sfmDataIO::ESfMData::ALL))
@@ -193,7 +229,7 @@ int aliceVision_main(int argc, char* argv[])
     }
 
     // initialization
-    mvsUtils::MultiViewParams mp(sfmData, imagesFolder, outputFolder, "", false, downscale);
+    mvsUtils::MultiViewParams mp(sfmData, imagesFolder, outputFolder, filterOutputFolder, false, downscale);
 
     mp.setMinViewAngle(minViewAngle);
     mp.setMaxViewAngle(maxViewAngle);
@@ -243,9 +279,29 @@ int aliceVision_main(int argc, char* argv[])
       }
     }
 
-    ALICEVISION_LOG_INFO("Create depth maps.");
+    if(!filterDepthMaps)
+    {
+      ALICEVISION_LOG_INFO("Create depth maps.");
+      depthMap::estimateAndRefineDepthMaps(&mp, cams, nbGPUs);
+    }
+    else
+    {
+      // the estimated depth maps are handed over to the filtering without a round trip through the disk
+      mvsUtils::DepthSimMapsCache depthSimMapsCache(&mp, mvsUtils::DepthSimMapsCache::getDefaultMaxMemory(&mp));
 
-    depthMap::estimateAndRefineDepthMaps(&mp, cams, nbGPUs);
+      ALICEVISION_LOG_INFO("Create depth maps.");
+      depthMap::estimateAndRefineDepthMaps(&mp, cams, nbGPUs, &depthSimMapsCache);
+
+      ALICEVISION_LOG_INFO("Filter depth maps.");
+      StaticVector<int> filterCams;
+      filterCams.reserve(cams.size());
+      for(int rc : cams)
+        filterCams.push_back(rc);
+
+      fuseCut::Fuser fs(&mp, &depthSimMapsCache);
+      fs.filterGroups(filterCams, pixSizeBall, pixSizeBallWithLowSimilarity, nNearestCams);
+      fs.filterDepthMaps(filterCams, minNumOfConsistentCams, minNumOfConsistentCamsWithLowSimilarity);
+    }
 
     ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
     return EXIT_SUCCESS;
@@ -16,9 +16,10 @@
 #include <aliceVision/gpu/gpu.hpp>
 #endif
 #include <aliceVision/image/all.hpp>
-#include <aliceVision/system/MemoryInfo.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Tracer.hpp>
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/cmdline.hpp>
 #include <aliceVision/config.hpp>
@@ -164,17 +165,17 @@ public:
 
     if(!_cpuJobs.empty())
     {
-      system::MemoryInfo memoryInformation = system::getMemoryInfo();
+      system::MemoryBudget& memoryBudget = system::MemoryBudget::get();
 
       ALICEVISION_LOG_DEBUG("Job max memory consumption: " << jobMaxMemoryConsuption << " B");
-      ALICEVISION_LOG_DEBUG("Memory information: " << std::endl <<memoryInformation);
+      ALICEVISION_LOG_DEBUG("Memory available: " << memoryBudget.getAvailableMemory() << " B");
 
       if(jobMaxMemoryConsuption == 0)
         throw std::runtime_error("Cannot compute feature extraction job max memory consumption.");
 
-      std::size_t nbThreads =  (0.9 * memoryInformation.freeRam) / jobMaxMemoryConsuption;
+      std::size_t nbThreads = memoryBudget.getMaxParallelJobs(jobMaxMemoryConsuption, _cpuJobs.size());
 
-      if(memoryInformation.freeRam == 0)
+      if(!memoryBudget.isLimited())
       {
         ALICEVISION_LOG_WARNING("Cannot find available system memory, this can be due to OS limitations.\n"
                                 "Use only one thread for CPU feature extraction.");
@@ -212,6 +213,9 @@ private:
 
   void computeViewJob(const ViewJob& job, bool useGPU = false)
   {
+    ALICEVISION_TRACE_ZONE("featureExtraction::view");
+    // wait for the memory used by the other jobs to be released
+    const system::MemoryReservation memoryReservation = system::MemoryBudget::get().reserve("featureExtraction", job.memoryConsuption);
     image::Image<float> imageGrayFloat;
     image::Image<unsigned char> imageGrayUChar;
 
@@ -228,6 +232,7 @@ private:
       // Compute features and descriptors and export them to files
       ALICEVISION_LOG_INFO("Extracting " << imageDescriberTypeName  << " features from view '" << job.view.getImagePath() << "' " << (useGPU ? "[gpu]" : "[cpu]"));
 
+      ALICEVISION_TRACE_ZONE("featureExtraction::describe");
       std::unique_ptr<feature::Regions> regions;
       if(imageDescriber->useFloatImage())
       {
@@ -9,6 +9,7 @@
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
+#include <aliceVision/mesh/openMesh.hpp>
 
 #include <OpenMesh/Core/IO/reader/OBJReader.hh>
 #include <OpenMesh/Core/IO/writer/OBJWriter.hh>
@@ -50,9 +51,9 @@ int aliceVision_main(int argc, char* argv[])
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
         ("input,i", po::value<std::string>(&inputMeshPath)->required(),
-            "Input Mesh (OBJ file format).")
+            "Input Mesh (OBJ, PLY or AVMESH file format).")
         ("output,o", po::value<std::string>(&outputMeshPath)->required(),
-            "Output mesh (OBJ file format).");
+            "Output mesh (OBJ, PLY or AVMESH file format).");
 
     po::options_description optionalParams("Optional parameters");
     optionalParams.add_options()
@@ -119,7 +120,12 @@ int aliceVision_main(int argc, char* argv[])
     typedef OpenMesh::Decimater::ModQuadricT< Mesh >::Handle HModQuadric;
 
     Mesh mesh;
-    if(!OpenMesh::IO::read_mesh(mesh, inputMeshPath.c_str()))
+    if(mesh::getMeshFileType(inputMeshPath) == mesh::EMeshFileType::AVMESH)
+    {
+        const mesh::MeshFileReader reader(inputMeshPath);
+        mesh::toOpenMesh(reader, mesh);
+    }
+    else if(!OpenMesh::IO::read_mesh(mesh, inputMeshPath.c_str()))
     {
         ALICEVISION_LOG_ERROR("Unable to read input mesh from the file: " << inputMeshPath);
         return EXIT_FAILURE;
@@ -187,7 +193,13 @@ int aliceVision_main(int argc, char* argv[])
 
     ALICEVISION_LOG_INFO("Save mesh.");
     // Save output mesh
-    if(!OpenMesh::IO::write_mesh(mesh, outputMeshPath))
+    if(mesh::getMeshFileType(outputMeshPath) == mesh::EMeshFileType::AVMESH)
+    {
+        mesh::Mesh outMesh;
+        mesh::fromOpenMesh(mesh, outMesh);
+        outMesh.save(outputMeshPath);
+    }
+    else if(!OpenMesh::IO::write_mesh(mesh, outputMeshPath))
     {
         ALICEVISION_LOG_ERROR("Failed to save mesh \"" << outputMeshPath << "\".");
         return EXIT_FAILURE;
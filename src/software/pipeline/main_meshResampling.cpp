@@ -9,6 +9,7 @@
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/mvsUtils/common.hpp>
+#include <aliceVision/mesh/geoMesh.hpp>
 
 #include <geogram/mesh/mesh.h>
 #include <geogram/mesh/mesh_io.h>
@@ -53,9 +54,9 @@ int aliceVision_main(int argc, char* argv[])
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
         ("input,i", po::value<std::string>(&inputMeshPath)->required(),
-            "Input Mesh (OBJ file format).")
+            "Input Mesh (OBJ, PLY or AVMESH file format).")
         ("output,o", po::value<std::string>(&outputMeshPath)->required(),
-            "Output mesh (OBJ file format).");
+            "Output mesh (OBJ, PLY or AVMESH file format).");
 
     po::options_description optionalParams("Optional parameters");
     optionalParams.add_options()
@@ -121,6 +122,12 @@ int aliceVision_main(int argc, char* argv[])
     ALICEVISION_LOG_INFO("Geogram initialized.");
 
     GEO::Mesh M_in, M_out;
+    if(mesh::getMeshFileType(inputMeshPath) == mesh::EMeshFileType::AVMESH)
+    {
+        const mesh::MeshFileReader reader(inputMeshPath);
+        mesh::toGeoMesh(reader, M_in);
+    }
+    else
     {
         if(!GEO::mesh_load(inputMeshPath, M_in))
         {
@@ -196,7 +203,13 @@ int aliceVision_main(int argc, char* argv[])
     }
 
     ALICEVISION_LOG_INFO("Save mesh.");
-    if(!GEO::mesh_save(M_out, outputMeshPath))
+    if(mesh::getMeshFileType(outputMeshPath) == mesh::EMeshFileType::AVMESH)
+    {
+        mesh::Mesh outMesh;
+        mesh::fromGeoMesh(M_out, outMesh);
+        outMesh.save(outputMeshPath);
+    }
+    else if(!GEO::mesh_save(M_out, outputMeshPath))
     {
         ALICEVISION_LOG_ERROR("Failed to save mesh file: \"" << outputMeshPath << "\".");
         return EXIT_FAILURE;
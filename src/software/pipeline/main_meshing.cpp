@@ -269,6 +269,8 @@ int aliceVision_main(int argc, char* argv[])
     bool colorizeOutput = false;
     float forceTEdgeDelta = 0.1f;
     unsigned int seed = 0;
+    bool rayCastVisibility = false;
+    bool rayCastBackFaceCulling = false;
     BoundingBox boundingBox;
 
     fuseCut::FuseParams fuseParams;
@@ -282,7 +284,7 @@ int aliceVision_main(int argc, char* argv[])
         ("output,o", po::value<std::string>(&outputDensePointCloud)->required(),
           "Output Dense SfMData file.")
         ("outputMesh,o", po::value<std::string>(&outputMesh)->required(),
-          "Output mesh (OBJ file format).");
+          "Output mesh (OBJ, PLY or AVMESH file format, the AVMESH file keeps the points visibilities).");
 
     po::options_description optionalParams("Optional parameters");
     optionalParams.add_options()
@@ -343,7 +345,11 @@ int aliceVision_main(int argc, char* argv[])
         ("forceTEdgeDelta", po::value<float>(&forceTEdgeDelta)->default_value(forceTEdgeDelta),
             "0 to disable force T edge in graphcut. Threshold for emptiness/fullness variation.")
         ("seed", po::value<unsigned int>(&seed)->default_value(seed),
-         "Seed used in random processes. (0 to use a random seed)."); 
+         "Seed used in random processes. (0 to use a random seed).")
+        ("rayCastVisibility", po::value<bool>(&rayCastVisibility)->default_value(rayCastVisibility),
+            "Check the visibilities of the output mesh against the occlusions by the mesh itself with ray casting.")
+        ("rayCastBackFaceCulling", po::value<bool>(&rayCastBackFaceCulling)->default_value(rayCastBackFaceCulling),
+            "With rayCastVisibility, also remove the visibilities of the cameras seeing the surface from behind.");
 
     po::options_description logParams("Log parameters");
     logParams.add_options()
@@ -417,6 +423,8 @@ int aliceVision_main(int argc, char* argv[])
     mp.userParams.put("LargeScale.universePercentile", universePercentile);
     mp.userParams.put("delaunaycut.forceTEdgeDelta", forceTEdgeDelta);
     mp.userParams.put("delaunaycut.seed", seed);
+    mp.userParams.put("meshPostProcessing.rayCastVisibility", rayCastVisibility);
+    mp.userParams.put("meshPostProcessing.backFaceCulling", rayCastBackFaceCulling);
 
     int ocTreeDim = mp.userParams.get<int>("LargeScale.gridLevel0", 1024);
     const auto baseDir = mp.userParams.get<std::string>("LargeScale.baseDirName", "root01024");
@@ -509,7 +517,7 @@ int aliceVision_main(int argc, char* argv[])
 
     // Generate output files: 
     // - dense point-cloud with observations as sfmData
-    // - mesh as .obj
+    // - mesh with the points visibilities
 
     if(mesh == nullptr || mesh->pts.empty() || mesh->tris.empty())
       throw std::runtime_error("No valid mesh was generated.");
@@ -539,8 +547,9 @@ int aliceVision_main(int argc, char* argv[])
     ALICEVISION_LOG_INFO("Save dense point cloud.");
     sfmDataIO::Save(densePointCloud, outputDensePointCloud, sfmDataIO::ESfMData::ALL_DENSE);
 
-    ALICEVISION_LOG_INFO("Save obj mesh file.");
-    mesh->saveToObj(outputMesh);
+    ALICEVISION_LOG_INFO("Save mesh file.");
+    mesh->pointsVisibilities.swap(ptsCams);
+    mesh->save(outputMesh);
     delete mesh;
 
 
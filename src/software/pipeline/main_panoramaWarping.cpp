@@ -14,6 +14,9 @@
 
 // Logging stuff
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryBudget.hpp>
+#include <aliceVision/system/Tracer.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 // Reading command line options
 #include <boost/program_options.hpp>
@@ -103,87 +106,123 @@ public:
      */
     size_t min_dim = std::min(_width_base, _height_base);
     size_t min_size = 32;
-    _scales = std::min(limit_scales, static_cast<size_t>(floor(log2(double(min_dim) / float(min_size)))));
-    
-
-    /**
-     * Create pyramid
-     **/
-    size_t new_width = _width_base;
-    size_t new_height = _height_base;
-    for (int i = 0; i < _scales; i++) {
-
-      _pyramid_color.push_back(image::Image<image::RGBfColor>(new_width, new_height, true, image::RGBfColor(0)));
-      _filter_buffer.push_back(image::Image<image::RGBfColor>(new_width, new_height, true, image::RGBfColor(0)));
-      new_height /= 2;
-      new_width /= 2;
-    }
+    const double max_scales = std::max(1.0, floor(log2(double(min_dim) / float(min_size))));
+    _scales = std::min(limit_scales, static_cast<size_t>(max_scales));
   }
 
+  /**
+   * Build the pyramid levels from the base image, which must outlive the pyramid.
+   * Each level is the previous one filtered by a 5x5 gaussian kernel and decimated by 2.
+   * The kernel is separable and only evaluated on the kept pixels.
+   */
   bool process(const image::Image<image::RGBfColor> & input) {
 
-    if (input.Height() != _pyramid_color[0].Height()) return false;
-    if (input.Width() != _pyramid_color[0].Width()) return false;
+    if (input.Height() != _height_base) return false;
+    if (input.Width() != _width_base) return false;
 
-    
     /**
      * Kernel
+     * The 1D weights are the sums of the columns of the 2D kernel
      */
     oiio::ImageBuf K;
     oiio::ImageBufAlgo::make_kernel(K, "gaussian", 5, 5);
 
+    float weights[5] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (int y = K.ybegin(); y < K.yend(); y++) {
+      for (int x = K.xbegin(); x < K.xend(); x++) {
+        weights[x - K.xbegin()] += K.getchannel(x, y, 0, 0);
+      }
+    }
+
     /** 
      * Build pyramid
     */
-    _pyramid_color[0] = input;
-    for (int lvl = 0; lvl < _scales - 1; lvl++) {
-      
-      const image::Image<image::RGBfColor> & source = _pyramid_color[lvl];
-      image::Image<image::RGBfColor> & dst = _filter_buffer[lvl];
-
-      oiio::ImageSpec spec(source.Width(), source.Height(), 3, oiio::TypeDesc::FLOAT);
-
-      const oiio::ImageBuf inBuf(spec, const_cast<image::RGBfColor*>(source.data()));
-      oiio::ImageBuf outBuf(spec, dst.data());    
-      oiio::ImageBufAlgo::convolve(outBuf, inBuf, K);
-
-      downscale(_pyramid_color[lvl + 1], _filter_buffer[lvl]);      
+    _base = &input;
+    _pyramid_color.resize(_scales - 1);
+    const image::Image<image::RGBfColor> * source = &input;
+    for (size_t lvl = 1; lvl < _scales; lvl++) {
+      reduce(_pyramid_color[lvl - 1], *source, weights);
+      source = &_pyramid_color[lvl - 1];
     }
 
     return true;
   }
 
+  /**
+   * Filter and decimate an image, pixels outside of the input are black.
+   * The vertical pass combines whole rows, so it is vectorized by the compiler.
+   */
+  static void reduce(image::Image<image::RGBfColor> & output, const image::Image<image::RGBfColor> & input, const float weights[5]) {
+
+    const int width = input.Width();
+    const int height = input.Height();
+    const int output_width = width / 2;
+    const int output_height = height / 2;
+
+    /* Horizontal pass on the kept columns */
+    image::Image<image::RGBfColor> horizontal(output_width, height);
+
+    #pragma omp parallel for
+    for (int i = 0; i < height; i++) {
+      const float * src = reinterpret_cast<const float *>(input.data() + size_t(i) * width);
+      float * dst = reinterpret_cast<float *>(horizontal.data() + size_t(i) * output_width);
+
+      for (int j = 0; j < output_width; j++) {
+        float sum[3] = {0.0f, 0.0f, 0.0f};
+        for (int k = 0; k < 5; k++) {
+          const int x = 2 * j + k - 2;
+          if (x < 0 || x >= width) continue;
+          for (int c = 0; c < 3; c++) {
+            sum[c] += weights[k] * src[3 * x + c];
+          }
+        }
+        for (int c = 0; c < 3; c++) {
+          dst[3 * j + c] = sum[c];
+        }
+      }
+    }
 
-  bool downscale(image::Image<image::RGBfColor> & output, const image::Image<image::RGBfColor> & input) {
+    /* Vertical pass on the kept rows */
+    output = image::Image<image::RGBfColor>(output_width, output_height);
+    const int row_size = 3 * output_width;
 
-    for (int i = 0; i < output.Height(); i++) {
-      int ui = i * 2;
+    #pragma omp parallel for
+    for (int i = 0; i < output_height; i++) {
+      float * dst = reinterpret_cast<float *>(output.data() + size_t(i) * output_width);
+      std::fill(dst, dst + row_size, 0.0f);
 
-      for (int j = 0; j < output.Width(); j++) {
-        int uj = j * 2;
+      for (int k = 0; k < 5; k++) {
+        const int y = 2 * i + k - 2;
+        if (y < 0 || y >= height) continue;
 
-        output(i, j) = input(ui, uj);
+        const float * src = reinterpret_cast<const float *>(horizontal.data() + size_t(y) * output_width);
+        const float weight = weights[k];
+        for (int j = 0; j < row_size; j++) {
+          dst[j] += weight * src[j];
+        }
       }
     }
-
-    return true;
   }
 
   const size_t getScalesCount() const {
     return _scales;
   }
 
-  const std::vector<image::Image<image::RGBfColor>> & getPyramidColor() const {
-    return _pyramid_color;
+  /// @return the pyramid level, the level 0 being the base image
+  const image::Image<image::RGBfColor> & getLevel(size_t level) const {
+    return (level == 0) ? *_base : _pyramid_color[level - 1];
   }
 
-  std::vector<image::Image<image::RGBfColor>> & getPyramidColor() {
-    return _pyramid_color;
+  /// @return the memory used by the levels, for a base image of the given size
+  static size_t estimateMemorySize(size_t width_base, size_t height_base) {
+    /* The levels above the base one use a third of the base size, and a temporary of half the previous level */
+    return width_base * height_base * sizeof(image::RGBfColor) * 5 / 6;
   }
 
 protected:
+  const image::Image<image::RGBfColor> * _base = nullptr;
+  /// the levels above the base one
   std::vector<image::Image<image::RGBfColor>> _pyramid_color;
-  std::vector<image::Image<image::RGBfColor>> _filter_buffer;
   size_t _width_base;
   size_t _height_base;
   size_t _scales;
@@ -214,7 +253,7 @@ public:
 
     
     /* Effectively compute the warping map */
-    aliceVision::image::Image<Eigen::Vector2d> buffer_coordinates(coarse_bbox.width, coarse_bbox.height, false);
+    aliceVision::image::Image<Eigen::Vector2f> buffer_coordinates(coarse_bbox.width, coarse_bbox.height, true, Eigen::Vector2f::Zero());
     aliceVision::image::Image<unsigned char> buffer_mask(coarse_bbox.width, coarse_bbox.height, true, 0);
 
     size_t max_x = 0;
@@ -237,6 +276,13 @@ public:
       size_t row_min_x = panoramaSize.first;
       size_t row_min_y = panoramaSize.second;
 
+      /**
+       * Gather the rays of the row which should be visible.
+       * This test is camera type dependent
+       */
+      Mat3X rays(3, coarse_bbox.width);
+      std::vector<size_t> rays_x;
+      rays_x.reserve(coarse_bbox.width);
 
       for (size_t x = 0; x < coarse_bbox.width; x++) {
 
@@ -244,28 +290,38 @@ public:
 
         Vec3 ray = SphericalMapping::fromEquirectangular(Vec2(cx, cy), panoramaSize.first, panoramaSize.second);
 
-        /**
-        * Check that this ray should be visible.
-        * This test is camera type dependent
-        */
         Vec3 transformedRay = pose(ray);
         if (!intrinsics.isVisibleRay(transformedRay)) {
           continue;
         }
 
-        /**
-         * Project this ray to camera pixel coordinates
-         */
-        const Vec2 pix_disto = intrinsics.project(pose, ray, true);
+        rays.col(rays_x.size()) = ray;
+        rays_x.push_back(x);
+      }
+
+      if (rays_x.empty()) {
+        continue;
+      }
+
+      /**
+       * Project the rays of the row to camera pixel coordinates
+       */
+      rays.conservativeResize(3, rays_x.size());
+      Mat2X pix_disto;
+      intrinsics.projectPoints(pose, rays, pix_disto, true);
+
+      for (size_t i = 0; i < rays_x.size(); i++) {
+
+        const size_t x = rays_x[i];
 
         /**
          * Ignore invalid coordinates
          */
-        if (!intrinsics.isVisible(pix_disto)) {
+        if (!intrinsics.isVisible(pix_disto.col(i))) {
           continue;
         }
 
-        buffer_coordinates(y, x) = pix_disto;
+        buffer_coordinates(y, x) = pix_disto.col(i).cast<float>();
         buffer_mask(y, x) = 1;
   
         row_min_x = std::min(x, row_min_x);
@@ -292,7 +348,7 @@ public:
     size_t real_height = max_y - min_y + 1;
 
       /* Resize buffers */
-    _coordinates = aliceVision::image::Image<Eigen::Vector2d>(real_width, real_height, false);
+    _coordinates = aliceVision::image::Image<Eigen::Vector2f>(real_width, real_height, false);
     _mask = aliceVision::image::Image<unsigned char>(real_width, real_height, true, 0);
 
     _coordinates.block(0, 0, real_height, real_width) =  buffer_coordinates.block(min_y, min_x, real_height, real_width);
@@ -344,7 +400,7 @@ public:
     return _offset_y;
   }
 
-  const aliceVision::image::Image<Eigen::Vector2d> & getCoordinates() const {
+  const aliceVision::image::Image<Eigen::Vector2f> & getCoordinates() const {
     return _coordinates;
   }
 
@@ -740,7 +796,8 @@ private:
   size_t _offset_x = 0;
   size_t _offset_y = 0;
 
-  aliceVision::image::Image<Eigen::Vector2d> _coordinates;
+  /// distorted pixel coordinates in the source image, in single precision to halve the map size
+  aliceVision::image::Image<Eigen::Vector2f> _coordinates;
   aliceVision::image::Image<unsigned char> _mask;
 };
 
@@ -754,11 +811,12 @@ public:
     float cy = h / 2.0f;
     
 
-    const aliceVision::image::Image<Eigen::Vector2d> & coordinates = map.getCoordinates();
+    const aliceVision::image::Image<Eigen::Vector2f> & coordinates = map.getCoordinates();
     const aliceVision::image::Image<unsigned char> & mask = map.getMask();
 
     _weights = aliceVision::image::Image<float>(coordinates.Width(), coordinates.Height());
 
+    #pragma omp parallel for
     for (int i = 0; i < _weights.Height(); i++) {
       for (int j = 0; j < _weights.Width(); j++) {
         
@@ -769,7 +827,7 @@ public:
           continue;
         }
 
-        const Vec2 & coords = coordinates(i, j);
+        const Eigen::Vector2f & coords = coordinates(i, j);
 
         float x = coords(0);
         float y = coords(1);
@@ -792,6 +850,37 @@ private:
   aliceVision::image::Image<float> _weights;
 };
 
+/**
+ * Bilinear sampling, same as image::Sampler2d<image::SamplerLinear>.
+ * The pixels whose four neighbors are inside the image, which are nearly all of them,
+ * are interpolated directly in single precision.
+ */
+inline image::RGBfColor sampleLinear(const image::Image<image::RGBfColor> & source, float y, float x) {
+
+  const int grid_x = static_cast<int>(floor(x));
+  const int grid_y = static_cast<int>(floor(y));
+
+  if (grid_x < 0 || grid_y < 0 || grid_x + 1 >= source.Width() || grid_y + 1 >= source.Height()) {
+    const image::Sampler2d<image::SamplerLinear> sampler;
+    return sampler(source, y, x);
+  }
+
+  const float dx = x - static_cast<float>(grid_x);
+  const float dy = y - static_cast<float>(grid_y);
+
+  const float * top = source(grid_y, grid_x).data();
+  const float * bottom = source(grid_y + 1, grid_x).data();
+
+  image::RGBfColor result;
+  for (int c = 0; c < 3; c++) {
+    const float t = top[c] + dx * (top[c + 3] - top[c]);
+    const float b = bottom[c] + dx * (bottom[c + 3] - bottom[c]);
+    result(c) = t + dy * (b - t);
+  }
+
+  return result;
+}
+
 class Warper {
 public:
   virtual bool warp(const CoordinatesMap & map, const aliceVision::image::Image<image::RGBfColor> & source) {
@@ -803,8 +892,7 @@ public:
     _offset_y = map.getOffsetY();
     _mask = map.getMask();
 
-    const image::Sampler2d<image::SamplerLinear> sampler;
-    const aliceVision::image::Image<Eigen::Vector2d> & coordinates = map.getCoordinates();
+    const aliceVision::image::Image<Eigen::Vector2f> & coordinates = map.getCoordinates();
 
     /**
      * Create buffer
@@ -815,18 +903,17 @@ public:
     /**
      * Simple warp
      */
-    for (size_t i = 0; i < _color.Height(); i++) {
-      for (size_t j = 0; j < _color.Width(); j++) {
+    #pragma omp parallel for
+    for (int i = 0; i < _color.Height(); i++) {
+      for (int j = 0; j < _color.Width(); j++) {
 
         bool valid = _mask(i, j);
         if (!valid) {
           continue;
         }
 
-        const Eigen::Vector2d & coord = coordinates(i, j);
-        const image::RGBfColor pixel = sampler(source, coord(1), coord(0));
-
-        _color(i, j) = pixel;
+        const Eigen::Vector2f & coord = coordinates(i, j);
+        _color(i, j) = sampleLinear(source, coord(1), coord(0));
       }
     }
 
@@ -869,66 +956,86 @@ public:
     _offset_y = map.getOffsetY();
     _mask = map.getMask();
 
-    const image::Sampler2d<image::SamplerLinear> sampler;
-    const aliceVision::image::Image<Eigen::Vector2d> & coordinates = map.getCoordinates();
+    const aliceVision::image::Image<Eigen::Vector2f> & coordinates = map.getCoordinates();
 
     /**
      * Create a pyramid for input
      */
     GaussianPyramidNoMask pyramid(source.Width(), source.Height());
     pyramid.process(source);
-    const std::vector<image::Image<image::RGBfColor>> & mlsource = pyramid.getPyramidColor();
-    size_t max_level = pyramid.getScalesCount() - 1; 
+    const int max_level = static_cast<int>(pyramid.getScalesCount()) - 1;
 
     /**
      * Create buffer
      */
     _color = aliceVision::image::Image<image::RGBfColor>(coordinates.Width(), coordinates.Height(), true, image::RGBfColor(1.0, 0.0, 0.0));
     
+    const int width = _color.Width();
+    const int height = _color.Height();
 
     /**
-     * Multi level warp
+     * Multi level warp, row by row
+     * The level of each pixel is computed for the whole row first, in a loop without branches
+     * which is vectorized by the compiler.
      */
-    for (size_t i = 0; i < _color.Height(); i++) {
-      for (size_t j = 0; j < _color.Width(); j++) {
+    #pragma omp parallel
+    {
+      std::vector<float> levels(width);
 
-        bool valid = _mask(i, j);
-        if (!valid) {
-          continue;
-        }
+      #pragma omp for schedule(dynamic, 16)
+      for (int i = 0; i < height; i++) {
 
-        if (i == _color.Height() - 1 || j == _color.Width() - 1 || !_mask(i + 1, j) || !_mask(i, j + 1)) {
-          const Eigen::Vector2d & coord = coordinates(i, j);
-          const image::RGBfColor pixel = sampler(source, coord(1), coord(0));
-          _color(i, j) = pixel;
-          continue;
-        }
+        if (i < height - 1) {
+          for (int j = 0; j < width - 1; j++) {
+            const Eigen::Vector2f & coord_mm = coordinates(i, j);
+            const Eigen::Vector2f & coord_mp = coordinates(i, j + 1);
+            const Eigen::Vector2f & coord_pm = coordinates(i + 1, j);
 
-        const Eigen::Vector2d & coord_mm = coordinates(i, j);
-        const Eigen::Vector2d & coord_mp = coordinates(i, j + 1);
-        const Eigen::Vector2d & coord_pm = coordinates(i + 1, j);
-        
-        double dxx = coord_pm(0) - coord_mm(0);
-        double dxy = coord_mp(0) - coord_mm(0);
-        double dyx = coord_pm(1) - coord_mm(1);
-        double dyy = coord_mp(1) - coord_mm(1);
-        double det = std::abs(dxx*dyy - dxy*dyx);
-        double scale = sqrt(det);
-
-        double flevel = std::max(0.0, log2(scale));
-        size_t blevel = std::min(max_level, size_t(floor(flevel)));        
-
-        double dscale, x, y;
-        dscale = 1.0 / pow(2.0, blevel);
-        x = coord_mm(0) * dscale;
-        y = coord_mm(1) * dscale;
-        /*Fallback to first level if outside*/
-        if (x >= mlsource[blevel].Width() - 1 || y >= mlsource[blevel].Height() - 1) {
-          _color(i, j) = sampler(mlsource[0], coord_mm(1), coord_mm(0));
-          continue;
+            const float dxx = coord_pm(0) - coord_mm(0);
+            const float dxy = coord_mp(0) - coord_mm(0);
+            const float dyx = coord_pm(1) - coord_mm(1);
+            const float dyy = coord_mp(1) - coord_mm(1);
+
+            /* log2(sqrt(det)) */
+            levels[j] = 0.5f * std::log2(std::abs(dxx * dyy - dxy * dyx));
+          }
         }
 
-        _color(i, j) = sampler(mlsource[blevel], y, x);
+        for (int j = 0; j < width; j++) {
+
+          bool valid = _mask(i, j);
+          if (!valid) {
+            continue;
+          }
+
+          const Eigen::Vector2f & coord_mm = coordinates(i, j);
+
+          if (i == height - 1 || j == width - 1 || !_mask(i + 1, j) || !_mask(i, j + 1)) {
+            _color(i, j) = sampleLinear(source, coord_mm(1), coord_mm(0));
+            continue;
+          }
+
+          const float flevel = std::max(0.0f, levels[j]);
+          const int blevel = std::min(max_level, static_cast<int>(floor(flevel)));
+
+          if (blevel == 0) {
+            _color(i, j) = sampleLinear(source, coord_mm(1), coord_mm(0));
+            continue;
+          }
+
+          const image::Image<image::RGBfColor> & level = pyramid.getLevel(blevel);
+          const float dscale = std::ldexp(1.0f, -blevel);
+          const float x = coord_mm(0) * dscale;
+          const float y = coord_mm(1) * dscale;
+
+          /*Fallback to first level if outside*/
+          if (x >= level.Width() - 1 || y >= level.Height() - 1) {
+            _color(i, j) = sampleLinear(source, coord_mm(1), coord_mm(0));
+            continue;
+          }
+
+          _color(i, j) = sampleLinear(level, y, x);
+        }
       }
     }
 
@@ -1146,9 +1253,33 @@ int aliceVision_main(int argc, char **argv)
   }
   ALICEVISION_LOG_DEBUG("Range to compute: rangeStart=" << rangeStart << ", rangeSize=" << rangeSize);
 
-  // Preprocessing per view
+  // Views processed in parallel, as many as the memory allows
+  std::size_t maxViewPixels = 0;
   for(std::size_t i = std::size_t(rangeStart); i < std::size_t(rangeStart + rangeSize); ++i)
   {
+    const sfmData::View& view = *viewsOrderedByName[i];
+    if (!sfmData.isPoseAndIntrinsicDefined(&view))
+    {
+      continue;
+    }
+    const camera::IntrinsicBase& intrinsic = *sfmData.getIntrinsicPtr(view.getIntrinsicId());
+    maxViewPixels = std::max(maxViewPixels, std::size_t(intrinsic.w()) * std::size_t(intrinsic.h()));
+  }
+
+  // the warped image has about the same resolution as the source image
+  const std::size_t maxViewMemory = maxViewPixels * (2 * sizeof(image::RGBfColor) + sizeof(float) + 2 * sizeof(Eigen::Vector2f) + 2) +
+                                    GaussianPyramidNoMask::estimateMemorySize(maxViewPixels, 1);
+  const int nbThreads = int(std::min(system::MemoryBudget::get().getMaxParallelJobs(std::max(maxViewMemory, std::size_t(1)), std::size_t(omp_get_max_threads())),
+                                     std::size_t(std::max(rangeSize, 1))));
+  ALICEVISION_LOG_DEBUG("# views processed in parallel: " << nbThreads);
+
+  bool hasFailed = false;
+
+  // Preprocessing per view
+  #pragma omp parallel for num_threads(nbThreads) schedule(dynamic)
+  for(int i = rangeStart; i < rangeStart + rangeSize; ++i)
+  {
+    ALICEVISION_TRACE_ZONE("panoramaWarping::view");
     const std::shared_ptr<sfmData::View> & viewIt = viewsOrderedByName[i];
 
     // Retrieve view
@@ -1160,71 +1291,86 @@ int aliceVision_main(int argc, char **argv)
 
     ALICEVISION_LOG_INFO("[" << int(i) + 1 - rangeStart << "/" << rangeSize << "] Processing view " << view.getViewId() << " (" << i + 1 << "/" << viewsOrderedByName.size() << ")");
 
-    // Get intrinsics and extrinsics
-    geometry::Pose3 camPose = sfmData.getPose(view).getTransform();
-    std::shared_ptr<camera::IntrinsicBase> intrinsic = sfmData.getIntrinsicsharedPtr(view.getIntrinsicId());
-    std::shared_ptr<camera::EquiDistant> casted = std::dynamic_pointer_cast<camera::EquiDistant>(intrinsic);    
-
-    // Prepare coordinates map
-    CoordinatesMap map;
-    map.build(panoramaSize, camPose, *(intrinsic.get()));
-
-    // Load image and convert it to linear colorspace
-    std::string imagePath = view.getImagePath();
-    ALICEVISION_LOG_INFO("Load image with path " << imagePath);
-    image::Image<image::RGBfColor> source;
-    image::readImage(imagePath, source, image::EImageColorSpace::LINEAR);
-
-    // Warp image
-    GaussianWarper warper;
-    warper.warp(map, source);
-
-    // Alpha mask
-    AlphaBuilder alphabuilder;
-    alphabuilder.build(map, *(intrinsic.get()));
-
-    // Export mask and image
+    try
     {
-        const std::string viewIdStr = std::to_string(view.getViewId());
+      // Get intrinsics and extrinsics
+      geometry::Pose3 camPose = sfmData.getPose(view).getTransform();
+      std::shared_ptr<camera::IntrinsicBase> intrinsic = sfmData.getIntrinsicsharedPtr(view.getIntrinsicId());
+
+      // Prepare coordinates map
+      CoordinatesMap map;
+      map.build(panoramaSize, camPose, *(intrinsic.get()));
+
+      // wait for the memory used by the other views to be released
+      const std::size_t sourcePixels = std::size_t(intrinsic->w()) * std::size_t(intrinsic->h());
+      const std::size_t warpedPixels = std::size_t(map.getCoordinates().size());
+      const system::MemoryReservation memoryReservation = system::MemoryBudget::get().reserve("panoramaWarping",
+        sourcePixels * sizeof(image::RGBfColor) + GaussianPyramidNoMask::estimateMemorySize(intrinsic->w(), intrinsic->h()) +
+        warpedPixels * (2 * sizeof(image::RGBfColor) + sizeof(float) + 1));
+
+      // Load image and convert it to linear colorspace
+      std::string imagePath = view.getImagePath();
+      ALICEVISION_LOG_INFO("Load image with path " << imagePath);
+      image::Image<image::RGBfColor> source;
+      image::readImage(imagePath, source, image::EImageColorSpace::LINEAR);
+
+      // Warp image
+      GaussianWarper warper;
+      warper.warp(map, source);
+
+      // Alpha mask
+      AlphaBuilder alphabuilder;
+      alphabuilder.build(map, *(intrinsic.get()));
+
+      // Export mask and image
+      {
+          const std::string viewIdStr = std::to_string(view.getViewId());
 
-        oiio::ParamValueList metadata = image::readImageMetadata(imagePath);
-        const int offsetX = int(warper.getOffsetX());
-        const int offsetY = int(warper.getOffsetY());
-        metadata.push_back(oiio::ParamValue("AliceVision:offsetX", offsetX));
-        metadata.push_back(oiio::ParamValue("AliceVision:offsetY", offsetY));
-        metadata.push_back(oiio::ParamValue("AliceVision:panoramaWidth", panoramaSize.first));
-        metadata.push_back(oiio::ParamValue("AliceVision:panoramaHeight", panoramaSize.second));
+          oiio::ParamValueList metadata = image::readImageMetadata(imagePath);
+          const int offsetX = int(warper.getOffsetX());
+          const int offsetY = int(warper.getOffsetY());
+          metadata.push_back(oiio::ParamValue("AliceVision:offsetX", offsetX));
+          metadata.push_back(oiio::ParamValue("AliceVision:offsetY", offsetY));
+          metadata.push_back(oiio::ParamValue("AliceVision:panoramaWidth", panoramaSize.first));
+          metadata.push_back(oiio::ParamValue("AliceVision:panoramaHeight", panoramaSize.second));
 
-        // Images will be converted in Panorama coordinate system, so there will be no more extra orientation.
-        metadata.remove("Orientation");
-        metadata.remove("orientation");
+          // Images will be converted in Panorama coordinate system, so there will be no more extra orientation.
+          metadata.remove("Orientation");
+          metadata.remove("orientation");
 
-        {
-            const aliceVision::image::Image<image::RGBfColor> & cam = warper.getColor();
+          {
+              const aliceVision::image::Image<image::RGBfColor> & cam = warper.getColor();
 
-            oiio::ParamValueList viewMetadata = metadata;
-            viewMetadata.push_back(oiio::ParamValue("AliceVision:storageDataType", image::EStorageDataType_enumToString(storageDataType)));
+              oiio::ParamValueList viewMetadata = metadata;
+              viewMetadata.push_back(oiio::ParamValue("AliceVision:storageDataType", image::EStorageDataType_enumToString(storageDataType)));
 
-            const std::string viewFilepath = (fs::path(outputDirectory) / (viewIdStr + ".exr")).string();
-            ALICEVISION_LOG_INFO("Store view " << i << " with path " << viewFilepath);
-            image::writeImage(viewFilepath, cam, image::EImageColorSpace::AUTO, viewMetadata);
-        }
-        {
-            const aliceVision::image::Image<unsigned char> & mask = warper.getMask();
+              const std::string viewFilepath = (fs::path(outputDirectory) / (viewIdStr + ".exr")).string();
+              ALICEVISION_LOG_INFO("Store view " << i << " with path " << viewFilepath);
+              image::writeImage(viewFilepath, cam, image::EImageColorSpace::AUTO, viewMetadata);
+          }
+          {
+              const aliceVision::image::Image<unsigned char> & mask = warper.getMask();
 
-            const std::string maskFilepath = (fs::path(outputDirectory) / (viewIdStr + "_mask.exr")).string();
-            ALICEVISION_LOG_INFO("Store mask " << i << " with path " << maskFilepath);
-            image::writeImage(maskFilepath, mask, image::EImageColorSpace::NO_CONVERSION, metadata);
-        }
-        {
-            const aliceVision::image::Image<float> & weights = alphabuilder.getWeights();
+              const std::string maskFilepath = (fs::path(outputDirectory) / (viewIdStr + "_mask.exr")).string();
+              ALICEVISION_LOG_INFO("Store mask " << i << " with path " << maskFilepath);
+              image::writeImage(maskFilepath, mask, image::EImageColorSpace::NO_CONVERSION, metadata);
+          }
+          {
+              const aliceVision::image::Image<float> & weights = alphabuilder.getWeights();
 
-            const std::string weightFilepath = (fs::path(outputDirectory) / (viewIdStr + "_weight.exr")).string();
-            ALICEVISION_LOG_INFO("Store weightmap " << i << " with path " << weightFilepath);
-            image::writeImage(weightFilepath, weights, image::EImageColorSpace::AUTO, metadata);
-        }
+              const std::string weightFilepath = (fs::path(outputDirectory) / (viewIdStr + "_weight.exr")).string();
+              ALICEVISION_LOG_INFO("Store weightmap " << i << " with path " << weightFilepath);
+              image::writeImage(weightFilepath, weights, image::EImageColorSpace::AUTO, metadata);
+          }
+      }
+    }
+    catch(const std::exception& e)
+    {
+      ALICEVISION_LOG_ERROR("Failed to warp view " << view.getViewId() << ": " << e.what());
+      #pragma omp critical
+      hasFailed = true;
     }
   }
 
-  return EXIT_SUCCESS;
+  return hasFailed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
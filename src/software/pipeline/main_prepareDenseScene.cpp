@@ -84,6 +84,9 @@ bool prepareDenseScene(const SfMData& sfmData,
   const float medianCameraExposure = sfmData.getMedianCameraExposureSetting();
   ALICEVISION_LOG_INFO("Median Camera Exposure: " << medianCameraExposure << ", Median EV: " << std::log2(1.0f/medianCameraExposure));
 
+  // undistortion maps shared by the views of the same intrinsic
+  camera::UndistortMapCache undistortMapCache;
+
 #pragma omp parallel for num_threads(3)
   for(int i = 0; i < viewIds.size(); ++i)
   {
@@ -219,7 +222,7 @@ bool prepareDenseScene(const SfMData& sfmData,
       if(cam->isValid() && cam->hasDistortion())
       {
         // undistort the image and save it
-        UndistortImage(image, cam, image_ud, FBLACK);
+        UndistortImage(image, cam, image_ud, FBLACK, undistortMapCache);
         writeImage(dstColorImage, image_ud, image::EImageColorSpace::AUTO, metadata);
       }
       else
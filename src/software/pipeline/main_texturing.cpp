@@ -62,7 +62,7 @@ int aliceVision_main(int argc, char* argv[])
         ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
           "Dense point cloud SfMData file.")
         ("inputMesh", po::value<std::string>(&inputMeshFilepath)->required(),
-            "Input mesh to texture.")
+            "Input mesh to texture (OBJ, PLY or AVMESH file format).")
         ("output,o", po::value<std::string>(&outputFolder)->required(),
             "Folder for output mesh: OBJ, material and texture files.");
 
@@ -111,6 +111,10 @@ int aliceVision_main(int argc, char* argv[])
             " * Pull: For each vertex of the input mesh, pull the visibilities from the closest vertex in the reconstruction.\n"
             " * Push: For each vertex of the reconstruction, push the visibilities to the closest triangle in the input mesh.\n"
             " * PullPush: Combine results from Pull and Push results.'")
+        ("rayCastVisibility", po::value<bool>(&texParams.rayCastVisibility)->default_value(texParams.rayCastVisibility),
+            "Check the visibilities against the occlusions by the mesh itself with ray casting.")
+        ("rayCastBackFaceCulling", po::value<bool>(&texParams.rayCastBackFaceCulling)->default_value(texParams.rayCastBackFaceCulling),
+            "With rayCastVisibility, also remove the visibilities of the cameras seeing the surface from behind (see flipNormals).")
         ("subdivisionTargetRatio", po::value<float>(&texParams.subdivisionTargetRatio)->default_value(texParams.subdivisionTargetRatio),
             "Percentage of the density of the reconstruction as the target for the subdivision (0: disable subdivision, 0.5: half density of the reconstruction, 1: full density of the reconstruction).");
 
@@ -213,6 +217,8 @@ int aliceVision_main(int argc, char* argv[])
     {
         // Need visibilities to compute unwrap
         mesh.remapVisibilities(texParams.visibilityRemappingMethod, refMesh);
+        if(texParams.rayCastVisibility)
+            mesh.removeOccludedVisibilities(mp);
         ALICEVISION_LOG_INFO("Input mesh has no UV coordinates, start unwrapping (" + unwrapMethod +")");
         mesh.unwrap(mp, mesh::EUnwrapMethod_stringToEnum(unwrapMethod));
         ALICEVISION_LOG_INFO("Unwrapping done.");
@@ -232,6 +238,8 @@ int aliceVision_main(int argc, char* argv[])
         // remap visibilities
         mesh.mesh->pointsVisibilities.clear();
         mesh.remapVisibilities(texParams.visibilityRemappingMethod, refMesh);
+        if(texParams.rayCastVisibility)
+            mesh.removeOccludedVisibilities(mp);
 
         // DEBUG: export subdivided mesh
         // mesh.saveAsOBJ(outputFolder, "subdividedMesh", outputTextureFileType);
@@ -18,7 +18,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision::keyframe;
 
@@ -49,6 +49,7 @@ int aliceVision_main(int argc, char** argv)
   unsigned int minFrameStep = 12;
   unsigned int maxFrameStep = 36;
   unsigned int maxNbOutFrame = 0;
+  unsigned int nbWorkers = 0;
 
   po::options_description allParams("This program is used to extract keyframes from single camera or a camera rig");
 
@@ -94,7 +95,9 @@ int aliceVision_main(int argc, char** argv)
       ("maxFrameStep", po::value<unsigned int>(&maxFrameStep)->default_value(maxFrameStep), 
         "maximum number of frames after which a keyframe can be taken")
       ("maxNbOutFrame", po::value<unsigned int>(&maxNbOutFrame)->default_value(maxNbOutFrame), 
-        "maximum number of output frames (0 = no limit)");
+        "maximum number of output frames (0 = no limit)")
+      ("nbWorkers", po::value<unsigned int>(&nbWorkers)->default_value(nbWorkers),
+        "number of threads scoring the frames (0 = number of cores)");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -224,6 +227,7 @@ int aliceVision_main(int argc, char** argv)
   selector.setMinFrameStep(minFrameStep);
   selector.setMaxFrameStep(maxFrameStep);
   selector.setMaxOutFrame(maxNbOutFrame);
+  selector.setNbWorkers(nbWorkers);
   
   // process
   selector.process();        
@@ -7,6 +7,7 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/voctree/TreeBuilder.hpp>
+#include <aliceVision/voctree/StreamingTreeBuilder.hpp>
 #include <aliceVision/voctree/Database.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 #include <aliceVision/voctree/descriptorLoader.hpp>
@@ -27,7 +28,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 static const int DIMENSION = 128;
 
@@ -55,6 +56,9 @@ int aliceVision_main(int argc, char** argv)
   std::uint32_t restart = 5;
   std::uint32_t LEVELS = 6;
   bool sanityCheck = true;
+  std::size_t chunkSize = 0;
+  std::uint32_t passes = 5;
+  std::string trainingStateFilename;
 
   po::options_description allParams("This program is used to load the sift descriptors from a SfMData file and create a vocabulary tree\n"
                                     "It takes as input either a list.txt file containing the a simple list of images (bundler format and older AliceVision version format)\n"
@@ -74,7 +78,14 @@ int aliceVision_main(int argc, char** argv)
     (",k", po::value<uint32_t>(&K)->default_value(10), "The branching factor of the tree")
     ("restart,r", po::value<uint32_t>(&restart)->default_value(5), "Number of times that the kmean is launched for each cluster, the best solution is kept")
     (",L", po::value<uint32_t>(&LEVELS)->default_value(6), "Number of levels of the tree")
-    ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree");
+    ("sanitycheck,s", po::value<bool>(&sanityCheck)->default_value(sanityCheck), "Perform a sanity check at the end of the creation of the vocabulary tree. The sanity check is a query to the database with the same documents/images useed to train the vocabulary tree")
+    ("chunkSize", po::value<std::size_t>(&chunkSize)->default_value(chunkSize),
+      "If > 0, the descriptors are streamed from the files by chunks of this size and the tree is trained with mini-batch k-means, "
+      "instead of loading all the descriptors in memory.")
+    ("passes", po::value<uint32_t>(&passes)->default_value(passes),
+      "Streaming mode: maximum number of mini-batch passes over the descriptors for each level of the tree.")
+    ("trainingState", po::value<std::string>(&trainingStateFilename)->default_value(trainingStateFilename),
+      "Streaming mode: file used to save the training state after each pass, the training is resumed from it if it exists.");
 
   po::options_description logParams("Log parameters");
   logParams.add_options()
@@ -123,66 +134,103 @@ int aliceVision_main(int argc, char** argv)
     return EXIT_FAILURE;
   }
 
-  std::vector<DescriptorFloat> descriptors;
+  typedef aliceVision::voctree::MutableVocabularyTree<DescriptorFloat> Tree;
 
+  std::vector<DescriptorFloat> descriptors;
   std::vector<size_t> descRead;
-  ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
+  std::vector<std::string> descriptorsFiles;
+
+  aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
+  aliceVision::voctree::StreamingTreeBuilder<DescriptorFloat> streamingBuilder(DescriptorFloat(0));
+  const bool streaming = (chunkSize > 0);
+  const Tree& tree = streaming ? streamingBuilder.tree() : builder.tree();
+
   auto detect_start = std::chrono::steady_clock::now();
-  size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
   auto detect_end = std::chrono::steady_clock::now();
   auto detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
-  if(descriptors.size() == 0)
+
+  if(streaming)
   {
-    ALICEVISION_CERR("No descriptors loaded!!");
-    return EXIT_FAILURE;
+    std::map<IndexT, std::string> descriptorsFilesPerView;
+    aliceVision::voctree::getListOfDescriptorFiles(sfmData, featuresFolders, descriptorsFilesPerView);
+    for(const auto& descriptorsFile : descriptorsFilesPerView)
+      descriptorsFiles.push_back(descriptorsFile.second);
+
+    aliceVision::voctree::DescriptorFileStream<DescriptorFloat, DescriptorUChar> stream(descriptorsFiles, chunkSize);
+    if(stream.size() == 0)
+    {
+      ALICEVISION_CERR("No descriptors found!!");
+      return EXIT_FAILURE;
+    }
+    ALICEVISION_COUT("Streaming " << stream.size() << " descriptors from " << descriptorsFiles.size() << " files by chunks of " << chunkSize);
+
+    // Create tree
+    streamingBuilder.setVerbose(tbVerbosity);
+    streamingBuilder.setMaxPasses(passes);
+    streamingBuilder.setSeedKmeans(restart, 20);
+    streamingBuilder.setStatePath(trainingStateFilename);
+    ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
+    detect_start = std::chrono::steady_clock::now();
+    streamingBuilder.build(stream, K, LEVELS);
+    detect_end = std::chrono::steady_clock::now();
   }
+  else
+  {
+    ALICEVISION_COUT("Reading descriptors from " << sfmDataFilename);
+    detect_start = std::chrono::steady_clock::now();
+    size_t numTotDescriptors = aliceVision::voctree::readDescFromFiles<DescriptorFloat, DescriptorUChar>(sfmData, featuresFolders, descriptors, descRead);
+    detect_end = std::chrono::steady_clock::now();
+    detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
+    if(descriptors.size() == 0)
+    {
+      ALICEVISION_CERR("No descriptors loaded!!");
+      return EXIT_FAILURE;
+    }
 
-  ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
-  ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
+    ALICEVISION_COUT("Done! " << descRead.size() << " sets of descriptors read for a total of " << numTotDescriptors << " features");
+    ALICEVISION_COUT("Reading took " << detect_elapsed.count() << " sec");
 
-  // Create tree
-  aliceVision::voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
-  builder.setVerbose(tbVerbosity);
-  builder.kmeans().setRestarts(restart);
-  ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
-  detect_start = std::chrono::steady_clock::now();
-  builder.build(descriptors, K, LEVELS);
-  detect_end = std::chrono::steady_clock::now();
+    // Create tree
+    builder.setVerbose(tbVerbosity);
+    builder.kmeans().setRestarts(restart);
+    ALICEVISION_COUT("Building a tree of L=" << LEVELS << " levels with a branching factor of k=" << K);
+    detect_start = std::chrono::steady_clock::now();
+    builder.build(descriptors, K, LEVELS);
+    detect_end = std::chrono::steady_clock::now();
+  }
   detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
   ALICEVISION_COUT("Tree created in " << ((float) detect_elapsed.count()) / 1000 << " sec");
-  ALICEVISION_COUT(builder.tree().centers().size() << " centers");
+  ALICEVISION_COUT(tree.centers().size() << " centers");
   ALICEVISION_COUT("Saving vocabulary tree as " << treeName);
-  builder.tree().save(treeName);
+  tree.save(treeName);
 
   aliceVision::voctree::SparseHistogramPerImage allSparseHistograms;
-  // temporary vector used to save all the visual word for each image before adding them to documents
-  std::vector<aliceVision::voctree::Word> imgVisualWords;
   ALICEVISION_COUT("Quantizing the features");
   size_t offset = 0; ///< this is used to align to the features of a given image in 'feature'
   detect_start = std::chrono::steady_clock::now();
   // pass each feature through the vocabulary tree to get the associated visual word
-  // for each read images, recover the number of features in it from descRead and loop over the features
-  for(size_t i = 0; i < descRead.size(); ++i)
+  // for each image, get its features either from the loaded descriptors (using descRead) or from its file
+  const size_t numImages = streaming ? descriptorsFiles.size() : descRead.size();
+  std::vector<DescriptorFloat> imgDescriptors;
+  for(size_t i = 0; i < numImages; ++i)
   {
-    // for each image:
-    // clear the temporary vector used to save all the visual word and allocate the proper size
-    imgVisualWords.clear();
-    // allocate as many visual words as the number of the features in the image
-    imgVisualWords.resize(descRead[i], 0);
-
-    #pragma omp parallel for
-    for(ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(descRead[i]); ++j)
+    if(streaming)
     {
-      //	store the visual word associated to the feature in the temporary list
-      imgVisualWords[j] = builder.tree().quantize(descriptors[ j + offset ]);
+      aliceVision::feature::loadDescsFromBinFile<DescriptorFloat, DescriptorUChar>(descriptorsFiles[i], imgDescriptors);
     }
+    else
+    {
+      imgDescriptors.assign(descriptors.begin() + offset, descriptors.begin() + offset + descRead[i]);
+      // update the offset
+      offset += descRead[i];
+    }
+
+    // get the visual words of all the features of the image
+    const std::vector<aliceVision::voctree::Word> imgVisualWords = tree.quantize(imgDescriptors);
     aliceVision::voctree::SparseHistogram histo;
     aliceVision::voctree::computeSparseHistogram(imgVisualWords, histo);
     // add the vector to the documents
     allSparseHistograms[i] = histo;
-
-    // update the offset
-    offset += descRead[i];
   }
   detect_end = std::chrono::steady_clock::now();
   detect_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(detect_end - detect_start);
@@ -191,7 +239,7 @@ int aliceVision_main(int argc, char** argv)
 
   ALICEVISION_COUT("Creating the database...");
   // Add each object (document) to the database
-  aliceVision::voctree::Database db(builder.tree().words());
+  aliceVision::voctree::Database db(tree.words());
   ALICEVISION_COUT("\tfound " << allSparseHistograms.size() << " documents");
   for(const auto &doc : allSparseHistograms)
   {